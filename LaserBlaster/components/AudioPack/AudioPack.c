@@ -0,0 +1,258 @@
+/**
+ * @file AudioPack.c
+ *
+ * @brief Index of audio clips packed into a single image.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "AudioPack.h"
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define AUDIOPACK_MAGIC_OFFSET 0U        /* Offset of the magic number in the header */
+#define AUDIOPACK_VERSION_OFFSET 4U      /* Offset of the version in the header */
+#define AUDIOPACK_CLIP_COUNT_OFFSET 6U   /* Offset of the number of clips in the header */
+#define AUDIOPACK_SAMPLE_RATE_OFFSET 8U  /* Offset of the sample rate in the header */
+#define AUDIOPACK_RESERVED_OFFSET 12U    /* Offset of the reserved word in the header */
+#define AUDIOPACK_OFFSET_OFFSET 0U       /* Offset of the offset of the samples in an entry */
+#define AUDIOPACK_SAMPLE_COUNT_OFFSET 4U /* Offset of the number of samples in an entry */
+#define AUDIOPACK_SAMPLE_SIZE 2U         /* Size of a sample in bytes */
+#define AUDIOPACK_BITS_PER_BYTE 8U       /* Number of bits in a byte */
+#define AUDIOPACK_BYTE_MASK 0xFFU        /* Mask of a byte */
+
+/* Size of the header and the index entries of a number of clips, which is also the offset of the entry of a clip */
+#define AUDIOPACK_INDEX_SIZE(clipCount) (AUDIOPACK_HEADER_SIZE + ((clipCount) * AUDIOPACK_ENTRY_SIZE))
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static uint32_t AudioPack_ReadU16(const uint8_t *const bytes);
+static uint32_t AudioPack_ReadU32(const uint8_t *const bytes);
+static void AudioPack_WriteU16(uint8_t *const bytes, const uint32_t value);
+static void AudioPack_WriteU32(uint8_t *const bytes, const uint32_t value);
+static bool AudioPack_IsClipValid(const AudioPack_t *const pack, const uint32_t index);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Open an image mapped into memory, checking its header and that every
+ * clip lies within the image.  Clips are not copied, so the image must stay
+ * mapped while the pack is used.
+ *
+ * @param[out] pack Pack to open
+ * @param[in]  base Start of the image in memory
+ * @param[in]  size Size of the image in bytes
+ *
+ * @return Whether the image is valid or not
+ *
+ * @retval true The image is valid and the pack was opened
+ * @retval false The image is not valid
+ ******************************************************************************/
+bool AudioPack_Open(AudioPack_t *const pack, const void *const base, const uint32_t size)
+{
+    const uint8_t *bytes = (const uint8_t *)base;
+    bool opened = false;
+
+    if (pack != NULL && bytes != NULL && size >= AUDIOPACK_HEADER_SIZE && AudioPack_ReadU32(&bytes[AUDIOPACK_MAGIC_OFFSET]) == AUDIOPACK_MAGIC && AudioPack_ReadU16(&bytes[AUDIOPACK_VERSION_OFFSET]) == AUDIOPACK_VERSION)
+    {
+        pack->Base = bytes;
+        pack->Size = size;
+        pack->ClipCount = AudioPack_ReadU16(&bytes[AUDIOPACK_CLIP_COUNT_OFFSET]);
+        pack->SampleRate = AudioPack_ReadU32(&bytes[AUDIOPACK_SAMPLE_RATE_OFFSET]);
+
+        opened = pack->SampleRate > 0U && AUDIOPACK_INDEX_SIZE(pack->ClipCount) <= size;
+        for (uint32_t clipIndex = 0U; opened && clipIndex < pack->ClipCount; clipIndex++)
+        {
+            opened = AudioPack_IsClipValid(pack, clipIndex);
+        }
+
+        if (!opened)
+        {
+            pack->ClipCount = 0U;
+        }
+    }
+
+    return opened;
+}
+
+/**
+ * @brief Get a clip of an opened pack.
+ *
+ * @param[in]  pack  Pack to get the clip from
+ * @param[in]  index Index of the clip
+ * @param[out] clip  Clip, only written if index is valid
+ *
+ * @return Whether the clip exists or not
+ ******************************************************************************/
+bool AudioPack_GetClip(const AudioPack_t *const pack, const uint32_t index, AudioPack_Clip_t *const clip)
+{
+    const uint8_t *entry;
+    bool found = false;
+
+    if (pack != NULL && clip != NULL && index < pack->ClipCount)
+    {
+        entry = &pack->Base[AUDIOPACK_INDEX_SIZE(index)];
+        clip->Samples = (const int16_t *)(const void *)&pack->Base[AudioPack_ReadU32(&entry[AUDIOPACK_OFFSET_OFFSET])];
+        clip->SampleCount = AudioPack_ReadU32(&entry[AUDIOPACK_SAMPLE_COUNT_OFFSET]);
+        found = true;
+    }
+
+    return found;
+}
+
+/**
+ * @brief Start streaming a clip from its first sample.
+ *
+ * @param[out] stream Stream to start
+ * @param[in]  clip   Clip to stream
+ ******************************************************************************/
+void AudioPack_StreamStart(AudioPack_Stream_t *const stream, const AudioPack_Clip_t *const clip)
+{
+    if (stream != NULL && clip != NULL)
+    {
+        stream->Clip = *clip;
+        stream->Position = 0U;
+    }
+}
+
+/**
+ * @brief Get the next chunk of a clip being streamed.  The chunk points into
+ * the image, so it can be handed straight to a DMA driver.
+ *
+ * @param[in,out] stream     Stream to get the chunk from
+ * @param[in]     maxSamples Most samples in the chunk
+ * @param[out]    samples    First sample of the chunk, only written if the
+ * chunk is not empty
+ *
+ * @return Number of samples in the chunk, 0 once the whole clip was streamed
+ ******************************************************************************/
+uint32_t AudioPack_StreamNext(AudioPack_Stream_t *const stream, const uint32_t maxSamples, const int16_t **const samples)
+{
+    uint32_t sampleCount = 0U;
+
+    if (stream != NULL && samples != NULL && stream->Position < stream->Clip.SampleCount)
+    {
+        sampleCount = stream->Clip.SampleCount - stream->Position;
+        if (sampleCount > maxSamples)
+        {
+            sampleCount = maxSamples;
+        }
+
+        *samples = &stream->Clip.Samples[stream->Position];
+        stream->Position += sampleCount;
+    }
+
+    return sampleCount;
+}
+
+/**
+ * @brief Write the header and index of an image.  Samples of the clips are
+ * placed one after another right after the index, in the order of the clips.
+ *
+ * @param[out] index        Buffer for the header and index, at least
+ * AUDIOPACK_HEADER_SIZE + clipCount * AUDIOPACK_ENTRY_SIZE bytes
+ * @param[in]  sampleRate   Sample rate of every clip in Hz
+ * @param[in]  clipCount    Number of clips, at most AUDIOPACK_MAX_CLIPS
+ * @param[in]  sampleCounts Number of samples of each clip
+ *
+ * @return Size of the whole image in bytes, 0 if the arguments are not valid
+ * or the image would not fit in 4 GiB
+ ******************************************************************************/
+uint32_t AudioPack_WriteIndex(uint8_t *const index, const uint32_t sampleRate, const uint32_t clipCount, const uint32_t *const sampleCounts)
+{
+    uint64_t offset = AUDIOPACK_INDEX_SIZE((uint64_t)clipCount);
+    uint8_t *entry;
+    uint32_t size = 0U;
+
+    if (index != NULL && sampleRate > 0U && clipCount <= AUDIOPACK_MAX_CLIPS && (clipCount == 0U || sampleCounts != NULL))
+    {
+        AudioPack_WriteU32(&index[AUDIOPACK_MAGIC_OFFSET], AUDIOPACK_MAGIC);
+        AudioPack_WriteU16(&index[AUDIOPACK_VERSION_OFFSET], AUDIOPACK_VERSION);
+        AudioPack_WriteU16(&index[AUDIOPACK_CLIP_COUNT_OFFSET], clipCount);
+        AudioPack_WriteU32(&index[AUDIOPACK_SAMPLE_RATE_OFFSET], sampleRate);
+        AudioPack_WriteU32(&index[AUDIOPACK_RESERVED_OFFSET], 0U);
+
+        for (uint32_t clipIndex = 0U; clipIndex < clipCount && offset <= UINT32_MAX; clipIndex++)
+        {
+            entry = &index[AUDIOPACK_INDEX_SIZE(clipIndex)];
+            AudioPack_WriteU32(&entry[AUDIOPACK_OFFSET_OFFSET], (uint32_t)offset);
+            AudioPack_WriteU32(&entry[AUDIOPACK_SAMPLE_COUNT_OFFSET], sampleCounts[clipIndex]);
+            offset += (uint64_t)sampleCounts[clipIndex] * AUDIOPACK_SAMPLE_SIZE;
+        }
+
+        size = (offset <= UINT32_MAX) ? (uint32_t)offset : 0U;
+    }
+
+    return size;
+}
+
+/**
+ * @brief Read a little-endian 16 bit field.
+ *
+ * @param[in] bytes First byte of the field
+ *
+ * @return Value of the field
+ ******************************************************************************/
+static uint32_t AudioPack_ReadU16(const uint8_t *const bytes)
+{
+    return (uint32_t)bytes[0U] | ((uint32_t)bytes[1U] << AUDIOPACK_BITS_PER_BYTE);
+}
+
+/**
+ * @brief Read a little-endian 32 bit field.
+ *
+ * @param[in] bytes First byte of the field
+ *
+ * @return Value of the field
+ ******************************************************************************/
+static uint32_t AudioPack_ReadU32(const uint8_t *const bytes)
+{
+    return AudioPack_ReadU16(bytes) | (AudioPack_ReadU16(&bytes[2U]) << (2U * AUDIOPACK_BITS_PER_BYTE));
+}
+
+/**
+ * @brief Write a little-endian 16 bit field.
+ *
+ * @param[out] bytes First byte of the field
+ * @param[in]  value Value of the field, truncated to 16 bits
+ ******************************************************************************/
+static void AudioPack_WriteU16(uint8_t *const bytes, const uint32_t value)
+{
+    bytes[0U] = (uint8_t)(value & AUDIOPACK_BYTE_MASK);
+    bytes[1U] = (uint8_t)((value >> AUDIOPACK_BITS_PER_BYTE) & AUDIOPACK_BYTE_MASK);
+}
+
+/**
+ * @brief Write a little-endian 32 bit field.
+ *
+ * @param[out] bytes First byte of the field
+ * @param[in]  value Value of the field
+ ******************************************************************************/
+static void AudioPack_WriteU32(uint8_t *const bytes, const uint32_t value)
+{
+    AudioPack_WriteU16(bytes, value);
+    AudioPack_WriteU16(&bytes[2U], value >> (2U * AUDIOPACK_BITS_PER_BYTE));
+}
+
+/**
+ * @brief Check that the samples of a clip are aligned and lie after the index
+ * and within the image.
+ *
+ * @param[in] pack  Pack with its size and number of clips set
+ * @param[in] index Index of the clip, less than the number of clips
+ *
+ * @return Whether the clip is valid or not
+ ******************************************************************************/
+static bool AudioPack_IsClipValid(const AudioPack_t *const pack, const uint32_t index)
+{
+    const uint8_t *entry = &pack->Base[AUDIOPACK_INDEX_SIZE(index)];
+    uint32_t offset = AudioPack_ReadU32(&entry[AUDIOPACK_OFFSET_OFFSET]);
+    uint64_t end = (uint64_t)offset + ((uint64_t)AudioPack_ReadU32(&entry[AUDIOPACK_SAMPLE_COUNT_OFFSET]) * AUDIOPACK_SAMPLE_SIZE);
+
+    return (offset % AUDIOPACK_SAMPLE_SIZE) == 0U && offset >= AUDIOPACK_INDEX_SIZE(pack->ClipCount) && end <= pack->Size;
+}
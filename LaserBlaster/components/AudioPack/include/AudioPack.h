@@ -0,0 +1,74 @@
+/**
+ * @file AudioPack.h
+ *
+ * @brief Index of audio clips packed into a single image, such as a flash
+ * partition or a file.  Clips are read in place from the image, which is
+ * mapped into memory, so playing a clip never copies it into RAM.
+ *
+ * The image starts with a header followed by an index entry per clip, and
+ * then the samples of every clip.  All fields are little-endian:
+ *
+ *   Header  Magic u32 ("LTAP"), Version u16, ClipCount u16, SampleRate u32,
+ *           Reserved u32
+ *   Entry   Offset u32 (bytes from the start of the image, even), SampleCount
+ *           u32
+ *   Samples Signed 16 bit mono PCM
+ *
+ * Samples are handed out as pointers into the image, so they are in the byte
+ * order of the image, which matches both the ESP32 and x86 hosts.
+ *
+ ******************************************************************************/
+
+#ifndef AUDIO_PACK_H
+#define AUDIO_PACK_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define AUDIOPACK_MAGIC 0x5041544CUL /* "LTAP" read as a little-endian u32 */
+#define AUDIOPACK_VERSION 1U         /* Version of the image layout */
+#define AUDIOPACK_HEADER_SIZE 16U    /* Size of the header in bytes */
+#define AUDIOPACK_ENTRY_SIZE 8U      /* Size of an index entry in bytes */
+#define AUDIOPACK_MAX_CLIPS 0xFFFFU  /* Most clips an image can hold */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Clip in an image */
+typedef struct
+{
+    const int16_t *Samples; /* Samples of the clip, in place in the image */
+    uint32_t SampleCount;   /* Number of samples of the clip */
+} AudioPack_Clip_t;
+
+/* Image of clips, validated when opened */
+typedef struct
+{
+    const uint8_t *Base; /* Start of the image in memory */
+    uint32_t Size;       /* Size of the image in bytes */
+    uint32_t ClipCount;  /* Number of clips in the image */
+    uint32_t SampleRate; /* Sample rate of every clip in Hz */
+} AudioPack_t;
+
+/* Position in a clip being streamed */
+typedef struct
+{
+    AudioPack_Clip_t Clip; /* Clip being streamed */
+    uint32_t Position;     /* Number of samples of the clip streamed so far */
+} AudioPack_Stream_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+bool AudioPack_Open(AudioPack_t *const pack, const void *const base, const uint32_t size);
+bool AudioPack_GetClip(const AudioPack_t *const pack, const uint32_t index, AudioPack_Clip_t *const clip);
+void AudioPack_StreamStart(AudioPack_Stream_t *const stream, const AudioPack_Clip_t *const clip);
+uint32_t AudioPack_StreamNext(AudioPack_Stream_t *const stream, const uint32_t maxSamples, const int16_t **const samples);
+uint32_t AudioPack_WriteIndex(uint8_t *const index, const uint32_t sampleRate, const uint32_t clipCount, const uint32_t *const sampleCounts);
+
+#endif
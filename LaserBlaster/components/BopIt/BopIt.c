@@ -8,41 +8,121 @@
 /* Includes
  ******************************************************************************/
 #include "BopIt.h"
+#include <inttypes.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdio.h>
-#include <stdlib.h>
-#include <time.h>
 
 /* Defines
  ******************************************************************************/
 
-#define BOPIT_LOG_BUFFER_SIZE 1024U                                                                        /* Size of buffer for storing messages to be logged */
-#define BOPIT_MAX_SCORE 99U                                                                                /* Maximum game score, game is over after player reaches this score */
-#define BOPIT_INIT_LIVES 3U                                                                                /* Starting player lives */
-#define BOPIT_MAX_WAIT_TIME_MS 5000U                                                                       /* Maximum time in milliseconds to complete a command */
-#define BOPIT_MIN_WAIT_TIME_MS 500U                                                                        /* Minimum time in milliseconds to complete a command */
-#define BOPIT_WAIT_TIME_DECREMENT_MS (BOPIT_MAX_WAIT_TIME_MS - BOPIT_MIN_WAIT_TIME_MS) / (BOPIT_MAX_SCORE) /* Numer of milliseconds to decrease time to complete a command */
+#define BOPIT_LOG_BUFFER_SIZE 128U                                             /* Size of buffer for storing messages to be logged */
+#define BOPIT_LOG_ISSUING_NAME "Issuing command %s"                            /* Format of BOPIT_LOGID_ISSUING with the index resolved to the command's name */
+#define BOPIT_PERCENTILE 95U                                                   /* Percentile of reaction times reported */
+#define BOPIT_PERCENT 100U                                                     /* Divisor for percentages */
+#define BOPIT_INIT_LIVES 3U                                                    /* Starting player lives */
+#define BOPIT_NO_COMMAND_INDEX UINT32_MAX                                      /* Index of the previous command before the first command of a game is issued */
+#define BOPIT_PRNG_SEQUENCE 0U                                                 /* Sequence of every game's generator, games are distinguished by their seeds */
+#define BOPIT_CURVE_SCORES (BOPIT_MAX_SCORE - 1U)                              /* Score of the last command of a game, when the linear and stepped curves reach the minimum time */
+#define BOPIT_CURVE_RANGE_US (BOPIT_MAX_WAIT_TIME_US - BOPIT_MIN_WAIT_TIME_US) /* Range of times to complete a command */
+#define BOPIT_CURVE_STEP_SCORE 10U                                             /* Number of completed commands between steps of the stepped curve */
+#define BOPIT_CURVE_ONE 65536U                                                 /* 1.0 in the 16.16 fixed point used by the exponential curve */
+#define BOPIT_ADAPTIVE_AVERAGE_SHIFT 2U                                        /* Weight of the newest reaction time in the moving average is 1 / 2^shift */
+#define BOPIT_ADAPTIVE_FRACTION_SHIFT 4U                                       /* Number of fractional bits of the moving average */
+#define BOPIT_ADAPTIVE_MARGIN_PERCENT 150U                                     /* Time to complete a command as a percentage of the moving average */
+#define BOPIT_US_PER_MS 1000U                                                  /* Microseconds per millisecond */
+#define BOPIT_INPUTS_ALL UINT64_MAX                                            /* Inputs traced for a failed pattern, judged wrong for any command when replayed */
+
+/* Time to complete a command at a score for each curve, integer constant expressions so the tables are built at compile time */
+#define BOPIT_CURVE_LINEAR_US(score) (BOPIT_MAX_WAIT_TIME_US - ((BOPIT_CURVE_RANGE_US * (((score) < BOPIT_CURVE_SCORES) ? (score) : BOPIT_CURVE_SCORES)) / BOPIT_CURVE_SCORES))
+#define BOPIT_CURVE_STEPPED_US(score) (BOPIT_MAX_WAIT_TIME_US - ((BOPIT_CURVE_RANGE_US * ((score) / BOPIT_CURVE_STEP_SCORE)) / (BOPIT_CURVE_SCORES / BOPIT_CURVE_STEP_SCORE)))
+#define BOPIT_CURVE_EXPONENTIAL_US(score) (BOPIT_MIN_WAIT_TIME_US + (uint32_t)((BOPIT_CURVE_RANGE_US * BOPIT_CURVE_DECAY(score)) >> 16U))
+
+/* 0.96^score in 16.16 fixed point for scores below 128, the product of 0.96^(2^bit) for each bit set in the score */
+#define BOPIT_CURVE_DECAY_BIT(score, bit, factor) (((score) & (1U << (bit))) ? (uint64_t)(factor) : (uint64_t)BOPIT_CURVE_ONE)
+#define BOPIT_CURVE_DECAY_MULTIPLY(product, score, bit, factor) (((product) * BOPIT_CURVE_DECAY_BIT(score, bit, factor)) >> 16U)
+#define BOPIT_CURVE_DECAY(score)                                                                                                   \
+    BOPIT_CURVE_DECAY_MULTIPLY(BOPIT_CURVE_DECAY_MULTIPLY(BOPIT_CURVE_DECAY_MULTIPLY(BOPIT_CURVE_DECAY_MULTIPLY(                   \
+                                   BOPIT_CURVE_DECAY_MULTIPLY(BOPIT_CURVE_DECAY_MULTIPLY(BOPIT_CURVE_DECAY_BIT(score, 0U, 62915U), \
+                                                                                         score, 1U, 60398U),                       \
+                                                              score, 2U, 55663U),                                                  \
+                                   score, 3U, 47277U),                                                                             \
+                               score, 4U, 34105U),                                                                                 \
+                               score, 5U, 17748U),                                                                                 \
+                               score, 6U, 4807U)
+
+/* Table of a curve with an entry for each score from 0 to 99 */
+#define BOPIT_CURVE_ROW(curve, tens)                                                                    \
+    curve((tens) + 0U), curve((tens) + 1U), curve((tens) + 2U), curve((tens) + 3U), curve((tens) + 4U), \
+        curve((tens) + 5U), curve((tens) + 6U), curve((tens) + 7U), curve((tens) + 8U), curve((tens) + 9U)
+#define BOPIT_CURVE_TABLE(curve)                                                                                           \
+    {                                                                                                                      \
+        BOPIT_CURVE_ROW(curve, 0U), BOPIT_CURVE_ROW(curve, 10U), BOPIT_CURVE_ROW(curve, 20U), BOPIT_CURVE_ROW(curve, 30U), \
+            BOPIT_CURVE_ROW(curve, 40U), BOPIT_CURVE_ROW(curve, 50U), BOPIT_CURVE_ROW(curve, 60U),                         \
+            BOPIT_CURVE_ROW(curve, 70U), BOPIT_CURVE_ROW(curve, 80U), BOPIT_CURVE_ROW(curve, 90U)                          \
+    }
 
 /* Globals
  ******************************************************************************/
 
-static char BopIt_LogBuffer[BOPIT_LOG_BUFFER_SIZE]; /* Buffer for storing messages to be logged */
-
-static void (*BopIt_Logger)(const char *const message) = NULL; /* Client-specified logging function, not be called directly */
-static BopIt_TimeMs_t (*BopIt_Time)(void) = NULL;              /* Client-specified function to get current time in milliseconds, not be called directly */
+/* Format strings of messages logged by BopIt, all arguments are uint32_t */
+static const char *const BopIt_LogFormats[BOPIT_LOGID_COUNT] = {
+    [BOPIT_LOGID_STARTING_GAME] = "Starting game",
+    [BOPIT_LOGID_NO_COMMANDS] = "No commands, ending game.",
+    [BOPIT_LOGID_STATUS] = "Score: %" PRIu32 ", Lives: %" PRIu32 ", Time to Complete Command: %" PRIu32 "ms",
+    [BOPIT_LOGID_ISSUING] = "Issuing command %" PRIu32,
+    [BOPIT_LOGID_WAITING] = "Waiting for player action",
+    [BOPIT_LOGID_OUT_OF_TIME] = "Out of time",
+    [BOPIT_LOGID_SUCCESS] = "Player action success",
+    [BOPIT_LOGID_FAIL] = "Player action fail",
+    [BOPIT_LOGID_GAME_OVER] = "Game over",
+    [BOPIT_LOGID_FINAL_SCORE] = "Score: %" PRIu32 ", Lives: %" PRIu32,
+};
+
+/* Number of arguments of messages logged by BopIt */
+static const uint8_t BopIt_LogArgCounts[BOPIT_LOGID_COUNT] = {
+    [BOPIT_LOGID_STATUS] = 3U,
+    [BOPIT_LOGID_ISSUING] = 1U,
+    [BOPIT_LOGID_FINAL_SCORE] = 2U,
+};
+
+/* Time to complete a command at each score for each curve, in microseconds, the adaptive curve is bounded by the linear curve */
+static const uint32_t BopIt_LinearCurve[] = BOPIT_CURVE_TABLE(BOPIT_CURVE_LINEAR_US);
+static const uint32_t BopIt_ExponentialCurve[] = BOPIT_CURVE_TABLE(BOPIT_CURVE_EXPONENTIAL_US);
+static const uint32_t BopIt_SteppedCurve[] = BOPIT_CURVE_TABLE(BOPIT_CURVE_STEPPED_US);
+static const uint32_t *const BopIt_Curves[BOPIT_CURVE_COUNT] = {
+    [BOPIT_CURVE_LINEAR] = BopIt_LinearCurve,
+    [BOPIT_CURVE_EXPONENTIAL] = BopIt_ExponentialCurve,
+    [BOPIT_CURVE_STEPPED] = BopIt_SteppedCurve,
+    [BOPIT_CURVE_ADAPTIVE] = BopIt_LinearCurve,
+};
+
+_Static_assert((sizeof(BopIt_LinearCurve) / sizeof(BopIt_LinearCurve[0U])) == (BOPIT_MAX_SCORE + 1U), "Curve tables need an entry for each score");
+
+/* Number of arguments of trace records written by BopIt */
+static const uint8_t BopIt_TraceArgCounts[BOPIT_TRACEID_COUNT] = {
+    [BOPIT_TRACEID_GAME_START] = 4U,
+    [BOPIT_TRACEID_COMMAND] = 1U,
+    [BOPIT_TRACEID_WAIT_END] = 3U,
+    [BOPIT_TRACEID_STATE] = 3U,
+};
 
 /* Function Prototypes
  ******************************************************************************/
 
-static void BopIt_Log(const char *const format, ...);
-static BopIt_TimeMs_t BopIt_GetTime(void);
-static BopIt_TimeMs_t BopIt_GetElapsedTime(const BopIt_TimeMs_t startTime);
-static BopIt_Command_t *BopIt_GetRandomCommand(const BopIt_Command_t *const *const commands, const uint32_t commandCount);
+static void BopIt_Log(const BopIt_GameContext_t *const gameContext, const BopIt_LogId_t logId, ...);
+static void BopIt_Trace(const BopIt_GameContext_t *const gameContext, const BopIt_TraceId_t traceId, const BopIt_TimeUs_t time, ...);
+static BopIt_TimeUs_t BopIt_GetTime(const BopIt_GameContext_t *const gameContext);
+static BopIt_TimeUs_t BopIt_GetElapsedTime(const BopIt_GameContext_t *const gameContext, const BopIt_TimeUs_t startTime);
+static BopIt_TimeUs_t BopIt_ClampTime(const BopIt_TimeUs_t inputTime, const BopIt_TimeUs_t minTime, const BopIt_TimeUs_t maxTime);
+static uint32_t BopIt_GetRandomCommandIndex(BopIt_GameContext_t *const gameContext);
 static void BopIt_HandleStart(BopIt_GameContext_t *const gameContext);
 static void BopIt_HandleCommand(BopIt_GameContext_t *const gameContext);
 static void BopIt_HandleWait(BopIt_GameContext_t *const gameContext);
+static BopIt_GameState_t BopIt_JudgeInput(const BopIt_GameContext_t *const gameContext, const bool correct, const BopIt_TimeUs_t inputTime, const BopIt_TimeUs_t currentTime, BopIt_TimeUs_t *const reactionTime);
 static void BopIt_HandleSuccess(BopIt_GameContext_t *const gameContext);
+static void BopIt_RecordReaction(BopIt_GameContext_t *const gameContext, const BopIt_TimeUs_t reactionTime);
+static BopIt_TimeUs_t BopIt_GetAdaptiveWaitTime(const BopIt_GameContext_t *const gameContext);
 static void BopIt_HandleFail(BopIt_GameContext_t *const gameContext);
 static void BopIt_HandleEnd(BopIt_GameContext_t *const gameContext);
 
@@ -50,48 +130,41 @@ static void BopIt_HandleEnd(BopIt_GameContext_t *const gameContext);
  ******************************************************************************/
 
 /**
- * @brief Register a function for logging.
+ * @brief Initialize a BopIt game.  Sets initial game state, player score and
+ * lives, and time to complete a command.  The game's generator for selecting
+ * commands is left as is, so a game continues its sequence of commands unless
+ * it is seeded again with BopIt_Seed.
  *
- * @param[in] logger Logging function
+ * @param[in,out] gameContext Context for a BopIt game
  ******************************************************************************/
-void BopIt_RegisterLogger(void (*logger)(const char *const message))
+void BopIt_Init(BopIt_GameContext_t *const gameContext)
 {
-    if (logger != NULL)
+    if (gameContext != NULL)
     {
-        BopIt_Logger = logger;
+        gameContext->GameState = BOPIT_GAMESTATE_START;
+        gameContext->Score = 0U;
+        gameContext->Lives = BOPIT_INIT_LIVES;
+        gameContext->WaitTime = BOPIT_MAX_WAIT_TIME_US;
+        gameContext->ReactionCount = 0U;
+        gameContext->ReactionAverage = 0U;
+        gameContext->CurrentCommandIndex = BOPIT_NO_COMMAND_INDEX;
     }
 }
 
 /**
- * @brief Register a function for getting the current time in milliseconds.
- *
- * @param[in] time Function to get current time in milliseconds
- ******************************************************************************/
-void BopIt_RegisterTime(BopIt_TimeMs_t (*time)(void))
-{
-    if (time != NULL)
-    {
-        BopIt_Time = time;
-    }
-}
-
-/**
- * @brief Initialize a BopIt game.  Sets initial game state, player score and
- * lives, and time to complete a command.  Also seeds rand for selecting a
- * random command to issue.
+ * @brief Seed the generator a BopIt game uses to select commands.  Games
+ * seeded with the same seed issue the same sequence of commands, so the seed
+ * should come from a source of entropy unless the game is to be reproduced.
+ * A game that is never seeded uses a fixed sequence.
  *
  * @param[in,out] gameContext Context for a BopIt game
+ * @param[in]     seed        Seed for the generator
  ******************************************************************************/
-void BopIt_Init(BopIt_GameContext_t *const gameContext)
+void BopIt_Seed(BopIt_GameContext_t *const gameContext, const uint64_t seed)
 {
     if (gameContext != NULL)
     {
-        gameContext->GameState = BOPIT_GAMESTATE_START;
-        gameContext->Score = 0U;
-        gameContext->Lives = BOPIT_INIT_LIVES;
-        gameContext->WaitTime = BOPIT_MAX_WAIT_TIME_MS;
-
-        srand(time(NULL));
+        Prng_Seed(&gameContext->Prng, seed, BOPIT_PRNG_SEQUENCE);
     }
 }
 
@@ -103,8 +176,12 @@ void BopIt_Init(BopIt_GameContext_t *const gameContext)
  ******************************************************************************/
 void BopIt_Run(BopIt_GameContext_t *const gameContext)
 {
+    BopIt_GameState_t previousState;
+
     if (gameContext != NULL)
     {
+        previousState = gameContext->GameState;
+
         switch (gameContext->GameState)
         {
         case BOPIT_GAMESTATE_START:
@@ -128,93 +205,419 @@ void BopIt_Run(BopIt_GameContext_t *const gameContext)
         default:
             break;
         }
+
+        if (gameContext->TraceRing != NULL && gameContext->GameState != previousState)
+        {
+            BopIt_Trace(gameContext, BOPIT_TRACEID_STATE, 0U, (uint32_t)gameContext->GameState, (uint32_t)gameContext->Score, (uint32_t)gameContext->Lives);
+        }
+    }
+}
+
+/**
+ * @brief Handle the current state of each running game of an array of games.
+ * Games that end are also handled in the end state in the same call and are
+ * removed from the caller's list of running games, so each game's end is
+ * handled exactly once and passing the count returned to the next call runs
+ * only the games still running, without touching the contexts of the others.
+ * Only the list is changed, the contexts never move, so clients may keep
+ * pointers or indexes to them.  Games must not share any hooks that are not
+ * reentrant.
+ *
+ * @param[in,out] gameContexts Array of contexts for BopIt games
+ * @param[in,out] running      Indexes in gameContexts of the games to run,
+ * compacted in order so the games still running come first
+ * @param[in]     runningCount Number of indexes in running
+ *
+ * @return Number of games still running, the first indexes of running
+ ******************************************************************************/
+uint32_t BopIt_RunBatch(BopIt_GameContext_t *const gameContexts, uint32_t *const running, const uint32_t runningCount)
+{
+    BopIt_GameContext_t *gameContext;
+    uint32_t stillRunning = 0U;
+
+    if (gameContexts != NULL && running != NULL)
+    {
+        for (uint32_t listIndex = 0U; listIndex < runningCount; listIndex++)
+        {
+            gameContext = gameContexts + running[listIndex];
+
+            if (gameContext->GameState != BOPIT_GAMESTATE_END)
+            {
+                BopIt_Run(gameContext);
+
+                if (gameContext->GameState == BOPIT_GAMESTATE_END)
+                {
+                    BopIt_Run(gameContext);
+                }
+            }
+
+            /* Compacting in order keeps the contexts visited in ascending addresses */
+            if (gameContext->GameState != BOPIT_GAMESTATE_END)
+            {
+                running[stillRunning++] = running[listIndex];
+            }
+        }
+    }
+
+    return stillRunning;
+}
+
+/**
+ * @brief Get the time until BopIt_Run must be called again if no input is
+ * made.  Allows the game to block until either an input arrives or the next
+ * deadline expires instead of polling.  Returns 0 if the game is in a state
+ * that must be handled immediately, the time remaining for the player to
+ * complete the issued command if waiting for input, or until the pattern of
+ * the command can next change without an event if sooner, and
+ * BOPIT_RUN_DELAY_INFINITE if the game is over.
+ *
+ * @param[in] gameContext Context for a BopIt game
+ *
+ * @return Time in microseconds until BopIt_Run must be called again
+ ******************************************************************************/
+BopIt_TimeUs_t BopIt_GetRunDelay(const BopIt_GameContext_t *const gameContext)
+{
+    BopIt_TimeUs_t delay = BOPIT_RUN_DELAY_INFINITE;
+    BopIt_TimeUs_t elapsedTime;
+    BopIt_TimeUs_t patternDeadline;
+    BopIt_TimeUs_t currentTime;
+
+    if (gameContext != NULL)
+    {
+        switch (gameContext->GameState)
+        {
+        case BOPIT_GAMESTATE_WAIT:
+            elapsedTime = BopIt_GetElapsedTime(gameContext, gameContext->WaitStart);
+            delay = (elapsedTime < gameContext->WaitTime) ? (gameContext->WaitTime - elapsedTime) : 0U;
+
+            patternDeadline = (gameContext->Matcher.Pattern != NULL) ? Combo_GetDeadline(&gameContext->Matcher) : COMBO_NO_DEADLINE;
+            if (patternDeadline != COMBO_NO_DEADLINE)
+            {
+                currentTime = BopIt_GetTime(gameContext);
+                patternDeadline = (patternDeadline > currentTime) ? (patternDeadline - currentTime) : 0U;
+                delay = (patternDeadline < delay) ? patternDeadline : delay;
+            }
+            break;
+        case BOPIT_GAMESTATE_END:
+            break;
+        default:
+            delay = 0U;
+            break;
+        }
+    }
+
+    return delay;
+}
+
+/**
+ * @brief Get the time to complete a command at a score on a curve.  Times are
+ * looked up in tables built at compile time.
+ *
+ * @param[in] curve Curve, linear if not valid
+ * @param[in] score Score, the last score if greater
+ *
+ * @return Time to complete a command in microseconds, between
+ * BOPIT_MIN_WAIT_TIME_US and BOPIT_MAX_WAIT_TIME_US, the upper bound of the
+ * adaptive curve for BOPIT_CURVE_ADAPTIVE
+ ******************************************************************************/
+BopIt_TimeUs_t BopIt_GetCurveWaitTime(const BopIt_Curve_t curve, const uint8_t score)
+{
+    const uint32_t *table = BopIt_LinearCurve;
+
+    if ((uint32_t)curve < BOPIT_CURVE_COUNT)
+    {
+        table = BopIt_Curves[curve];
+    }
+
+    return table[(score <= BOPIT_MAX_SCORE) ? score : BOPIT_MAX_SCORE];
+}
+
+/**
+ * @brief Get the format string for a message logged by BopIt.  All arguments
+ * of the format strings are uint32_t.
+ *
+ * @param[in] logId Log ID of the message, the format ID of a deferred log
+ * record
+ *
+ * @return Format string for the message, NULL if the log ID is not valid
+ ******************************************************************************/
+const char *BopIt_GetLogFormat(const uint16_t logId)
+{
+    const char *format = NULL;
+
+    if (logId < BOPIT_LOGID_COUNT)
+    {
+        format = BopIt_LogFormats[logId];
+    }
+
+    return format;
+}
+
+/**
+ * @brief Format a message logged by BopIt.  The index of an issued command is
+ * resolved to the command's name if the game has the command, otherwise the
+ * index is formatted as is.
+ *
+ * @param[in]  gameContext Context for the BopIt game that logged the message,
+ * may be NULL when formatting without the game
+ * @param[in]  record      Message to format, a deferred log record
+ * @param[out] buffer      Buffer to write the message to
+ * @param[in]  size        Size of buffer
+ *
+ * @return Length of the message as returned by snprintf, negative if the
+ * record's format ID is not valid
+ ******************************************************************************/
+int BopIt_FormatLog(const BopIt_GameContext_t *const gameContext, const LogRing_Record_t *const record, char *const buffer, const size_t size)
+{
+    int length = -1;
+
+    if (record != NULL && buffer != NULL)
+    {
+        if (record->FormatId == BOPIT_LOGID_ISSUING && gameContext != NULL && gameContext->Commands != NULL && record->Args[0U] < gameContext->CommandCount)
+        {
+            length = snprintf(buffer, size, BOPIT_LOG_ISSUING_NAME, (*(gameContext->Commands + record->Args[0U]))->Name);
+        }
+        else
+        {
+            length = LogRing_Format(record, BopIt_GetLogFormat(record->FormatId), buffer, size);
+        }
+    }
+
+    return length;
+}
+
+/**
+ * @brief Get statistics of the reaction times measured for successfully
+ * completed commands in the current game.  Reaction times are only kept if the
+ * game has a buffer for them.
+ *
+ * @param[in]  gameContext   Context for a BopIt game
+ * @param[in]  command       Command to get reaction times for, NULL for all
+ * commands
+ * @param[out] reactionTimes Reaction time statistics
+ *
+ * @return Whether any reaction times were measured or not
+ *
+ * @retval true Reaction time statistics were written
+ * @retval false No reaction times were kept for the command
+ ******************************************************************************/
+bool BopIt_GetReactionTimes(const BopIt_GameContext_t *const gameContext, const BopIt_Command_t *const command, BopIt_ReactionTimes_t *const reactionTimes)
+{
+    BopIt_TimeUs_t times[BOPIT_MAX_SCORE];
+    BopIt_TimeUs_t reactionTime;
+    uint32_t count = 0U;
+    uint64_t sum = 0U;
+    uint32_t sortIndex;
+
+    if (gameContext != NULL && gameContext->Reactions != NULL && reactionTimes != NULL)
+    {
+        /* Gather reaction times for the command, insertion sorted */
+        for (uint32_t reactionIndex = 0U; reactionIndex < gameContext->ReactionCount && reactionIndex < BOPIT_MAX_SCORE; reactionIndex++)
+        {
+            if (command == NULL || *(gameContext->Commands + gameContext->Reactions[reactionIndex].CommandIndex) == command)
+            {
+                reactionTime = gameContext->Reactions[reactionIndex].Time;
+                sum += reactionTime;
+
+                for (sortIndex = count; sortIndex > 0U && times[sortIndex - 1U] > reactionTime; sortIndex--)
+                {
+                    times[sortIndex] = times[sortIndex - 1U];
+                }
+                times[sortIndex] = reactionTime;
+                count++;
+            }
+        }
+
+        if (count > 0U)
+        {
+            reactionTimes->Count = count;
+            reactionTimes->Min = times[0U];
+            reactionTimes->Mean = (BopIt_TimeUs_t)(sum / count);
+            reactionTimes->P95 = times[(((count * BOPIT_PERCENTILE) + BOPIT_PERCENT - 1U) / BOPIT_PERCENT) - 1U]; /* Nearest rank */
+        }
     }
+
+    return count > 0U;
 }
 
 /**
- * @brief Log a message using registered logging function.  Calls printf if no
- * logging function is registered.
+ * @brief Log a message.  Writes a deferred log record if the game has a log
+ * ring, otherwise formats the record with BopIt_FormatLog and passes it to the
+ * game's logging function.  Calls printf if the game has no logging function.
  *
- * @param[in] format Message format string
- * @param[in] ...    Arguments for message format string
+ * @param[in] gameContext Context for a BopIt game
+ * @param[in] logId       Log ID of the message
+ * @param[in] ...         uint32_t arguments for the message format string
  ******************************************************************************/
-static void BopIt_Log(const char *const format, ...)
+static void BopIt_Log(const BopIt_GameContext_t *const gameContext, const BopIt_LogId_t logId, ...)
 {
     va_list args;
+    char buffer[BOPIT_LOG_BUFFER_SIZE];
+    LogRing_Record_t record = {0};
 
-    if (format != NULL)
+    if (gameContext != NULL && logId < BOPIT_LOGID_COUNT)
     {
-        va_start(args, format);
-        vsnprintf(BopIt_LogBuffer, BOPIT_LOG_BUFFER_SIZE, format, args);
+        va_start(args, logId);
+        record.FormatId = (uint16_t)logId;
+        record.ArgCount = BopIt_LogArgCounts[logId];
+        for (uint8_t arg = 0U; arg < record.ArgCount; arg++)
+        {
+            record.Args[arg] = va_arg(args, uint32_t);
+        }
         va_end(args);
 
-        if (BopIt_Logger == NULL)
+        if (gameContext->LogRing != NULL)
         {
-            printf("%s", BopIt_LogBuffer);
+            /* Defer formatting to the client, only copy the raw arguments */
+            record.Time = (uint32_t)BopIt_GetTime(gameContext);
+            (void)LogRing_Write(gameContext->LogRing, &record);
         }
-        else
+        else if (BopIt_FormatLog(gameContext, &record, buffer, BOPIT_LOG_BUFFER_SIZE) >= 0)
         {
-            (*BopIt_Logger)(BopIt_LogBuffer);
+            if (gameContext->Logger == NULL)
+            {
+                printf("%s", buffer);
+            }
+            else
+            {
+                (*gameContext->Logger)(gameContext, buffer);
+            }
         }
     }
 }
 
 /**
- * @brief Get the current time in milliseconds.  Returns 0 if no function to
- * get the current time in milliseconds is registered.
+ * @brief Write a trace record to the game's trace ring, if it has one.
  *
- * @return Current time in milliseconds
+ * @param[in] gameContext Context for a BopIt game
+ * @param[in] traceId     Trace ID of the record
+ * @param[in] time        Time of the record, truncated to its low 32 bits
+ * @param[in] ...         uint32_t arguments of the record
  ******************************************************************************/
-static BopIt_TimeMs_t BopIt_GetTime(void)
+static void BopIt_Trace(const BopIt_GameContext_t *const gameContext, const BopIt_TraceId_t traceId, const BopIt_TimeUs_t time, ...)
 {
-    BopIt_TimeMs_t time = 0U;
+    va_list args;
+    LogRing_Record_t record = {0};
 
-    if (BopIt_Time != NULL)
+    if (gameContext->TraceRing != NULL)
     {
-        time = (*BopIt_Time)();
+        va_start(args, time);
+
+        record.Time = (uint32_t)time;
+        record.FormatId = (uint16_t)traceId;
+        record.ArgCount = BopIt_TraceArgCounts[traceId];
+        for (uint8_t arg = 0U; arg < record.ArgCount; arg++)
+        {
+            record.Args[arg] = va_arg(args, uint32_t);
+        }
+        (void)LogRing_Write(gameContext->TraceRing, &record);
+
+        va_end(args);
+    }
+}
+
+/**
+ * @brief Get the current time in microseconds.  Returns 0 if the game has no
+ * function to get the current time.
+ *
+ * @param[in] gameContext Context for a BopIt game
+ *
+ * @return Current time in microseconds
+ ******************************************************************************/
+static BopIt_TimeUs_t BopIt_GetTime(const BopIt_GameContext_t *const gameContext)
+{
+    BopIt_TimeUs_t time = 0U;
+
+    if (gameContext->Time != NULL)
+    {
+        time = (*gameContext->Time)(gameContext);
     }
 
     return time;
 }
 
 /**
- * @brief Get the elapsed time from the start time in milliseconds.
+ * @brief Get the elapsed time from the start time in microseconds.  Without a
+ * function to get the current time, time cannot be measured, so it is taken
+ * to have run out rather than to stand still, which would leave the game
+ * waiting forever.
  *
- * @param[in] startTime Start time in milliseconds from which to get the
+ * @param[in] gameContext Context for a BopIt game
+ * @param[in] startTime   Start time in microseconds from which to get the
  * elapsed time
  *
- * @return Elapsed time in milliseconds
+ * @return Elapsed time in microseconds, BOPIT_RUN_DELAY_INFINITE if the game
+ * has no function to get the current time
  ******************************************************************************/
-static BopIt_TimeMs_t BopIt_GetElapsedTime(const BopIt_TimeMs_t startTime)
+static BopIt_TimeUs_t BopIt_GetElapsedTime(const BopIt_GameContext_t *const gameContext, const BopIt_TimeUs_t startTime)
 {
-    BopIt_TimeMs_t time = 0U;
+    BopIt_TimeUs_t time = BOPIT_RUN_DELAY_INFINITE;
 
-    if (BopIt_Time != NULL)
+    if (gameContext->Time != NULL)
     {
-        time = (*BopIt_Time)() - startTime;
+        time = (*gameContext->Time)(gameContext) - startTime;
     }
 
     return time;
 }
 
 /**
- * @brief Get a command randomly selected from a list of commands.
+ * @brief Clamp a time to a window of time.
+ *
+ * @param[in] inputTime Time to clamp
+ * @param[in] minTime   Start of the window
+ * @param[in] maxTime   End of the window
+ *
+ * @return Time clamped to the window
+ ******************************************************************************/
+static BopIt_TimeUs_t BopIt_ClampTime(const BopIt_TimeUs_t inputTime, const BopIt_TimeUs_t minTime, const BopIt_TimeUs_t maxTime)
+{
+    BopIt_TimeUs_t clampedTime = inputTime;
+
+    if (inputTime < minTime)
+    {
+        clampedTime = minTime;
+    }
+    else if (inputTime > maxTime)
+    {
+        clampedTime = maxTime;
+    }
+
+    return clampedTime;
+}
+
+/**
+ * @brief Get the index of a command randomly selected from a list of commands
+ * according to the game's selection mode.  Takes constant time in every mode.
  *
- * @param[in] commands     Pointer to list of command pointers
- * @param[in] commandCount Number of commands in list
+ * @param[in,out] gameContext Context for a BopIt game
  *
- * @return Pointer to a randomly selected command
+ * @return Index of a randomly selected command
  ******************************************************************************/
-static BopIt_Command_t *BopIt_GetRandomCommand(const BopIt_Command_t *const *const commands, const uint32_t commandCount)
+static uint32_t BopIt_GetRandomCommandIndex(BopIt_GameContext_t *const gameContext)
 {
-    BopIt_Command_t *command = NULL;
+    uint32_t previous = gameContext->CurrentCommandIndex;
+    uint32_t commandIndex;
 
-    if (commands != NULL)
+    if (gameContext->Selection == BOPIT_SELECTION_WEIGHTED && gameContext->CommandWeights != NULL && gameContext->CommandWeights->Count == gameContext->CommandCount)
     {
-        command = *(BopIt_Command_t **)(commands + (rand() % commandCount));
+        commandIndex = Prng_AliasDraw(&gameContext->Prng, gameContext->CommandWeights);
+    }
+    else if (gameContext->Selection == BOPIT_SELECTION_NO_REPEAT && gameContext->CommandCount > 1U && previous < gameContext->CommandCount)
+    {
+        /* Draw from the other commands and skip over the previous one */
+        commandIndex = Prng_Bounded(&gameContext->Prng, gameContext->CommandCount - 1U);
+        if (commandIndex >= previous)
+        {
+            commandIndex++;
+        }
+    }
+    else
+    {
+        commandIndex = Prng_Bounded(&gameContext->Prng, gameContext->CommandCount);
     }
 
-    return command;
+    return commandIndex;
 }
 
 /**
@@ -226,7 +629,8 @@ static void BopIt_HandleStart(BopIt_GameContext_t *const gameContext)
 {
     if (gameContext != NULL)
     {
-        BopIt_Log("Starting game");
+        BopIt_Log(gameContext, BOPIT_LOGID_STARTING_GAME);
+        BopIt_Trace(gameContext, BOPIT_TRACEID_GAME_START, 0U, (uint32_t)gameContext->Prng.State, (uint32_t)(gameContext->Prng.State >> 32U), gameContext->CommandCount, (uint32_t)gameContext->Selection | ((uint32_t)gameContext->Curve << 16U));
 
         if (gameContext->OnGameStart != NULL)
         {
@@ -239,7 +643,7 @@ static void BopIt_HandleStart(BopIt_GameContext_t *const gameContext)
         }
         else
         {
-            BopIt_Log("No commands, ending game.");
+            BopIt_Log(gameContext, BOPIT_LOGID_NO_COMMANDS);
             gameContext->GameState = BOPIT_GAMESTATE_END;
         }
     }
@@ -255,17 +659,27 @@ static void BopIt_HandleCommand(BopIt_GameContext_t *const gameContext)
 {
     if (gameContext != NULL)
     {
-        BopIt_Log("Score: %d, Lives: %d, Time to Complete Command: %ldms", gameContext->Score, gameContext->Lives, gameContext->WaitTime);
+        BopIt_Log(gameContext, BOPIT_LOGID_STATUS, (uint32_t)gameContext->Score, (uint32_t)gameContext->Lives, (uint32_t)(gameContext->WaitTime / BOPIT_US_PER_MS));
 
-        gameContext->CurrentCommand = BopIt_GetRandomCommand((const BopIt_Command_t *const *const)(gameContext->Commands), gameContext->CommandCount);
+        gameContext->CurrentCommandIndex = BopIt_GetRandomCommandIndex(gameContext);
+        gameContext->CurrentCommand = *(gameContext->Commands + gameContext->CurrentCommandIndex);
         if (gameContext->CurrentCommand != NULL)
         {
-            BopIt_Log("Issuing command %s", gameContext->CurrentCommand->Name);
+            BopIt_Log(gameContext, BOPIT_LOGID_ISSUING, gameContext->CurrentCommandIndex);
             gameContext->CurrentCommand->IssueCommand();
         }
 
-        BopIt_Log("Waiting for player action");
-        gameContext->WaitStart = BopIt_GetTime();
+        BopIt_Log(gameContext, BOPIT_LOGID_WAITING);
+        gameContext->WaitStart = BopIt_GetTime(gameContext);
+        BopIt_Trace(gameContext, BOPIT_TRACEID_COMMAND, gameContext->WaitStart, gameContext->CurrentCommandIndex);
+
+        /* A command with a pattern is only matched from events if the outcome can be traced as inputs, and is judged by its input otherwise */
+        gameContext->Matcher.Pattern = NULL;
+        if (gameContext->CurrentCommand != NULL && gameContext->CurrentCommand->Pattern != NULL && gameContext->GetEvent != NULL && gameContext->CommandCount <= BOPIT_MAX_INPUTS)
+        {
+            (void)Combo_Start(&gameContext->Matcher, gameContext->CurrentCommand->Pattern, gameContext->CurrentCommand->PatternSize, gameContext->WaitStart);
+        }
+
         gameContext->GameState = BOPIT_GAMESTATE_WAIT;
     }
 }
@@ -273,7 +687,14 @@ static void BopIt_HandleCommand(BopIt_GameContext_t *const gameContext)
 /**
  * @brief Handle the wait state of a BopIt game.  Waits for the player to
  * complete the issued command in a given amount of time and checks if the
- * correct input was made by the player.
+ * correct input was made by the player.  Inputs are judged by the time at
+ * which they were made, which may be earlier than when they are checked.
+ *
+ * If the issued command has a pattern, the game's input events are fed to its
+ * matcher until the pattern is matched or failed, and the command is judged at
+ * the time it was.  Events after that are left for the next command.
+ * Otherwise, if the game has an input provider, all inputs are checked with a
+ * single call to it, otherwise the input of each command is checked in turn.
  *
  * @param[in,out] gameContext Context for a BopIt game
  ******************************************************************************/
@@ -281,38 +702,125 @@ static void BopIt_HandleWait(BopIt_GameContext_t *const gameContext)
 {
     BopIt_Command_t *command;
     uint32_t commandIndex = 0U;
+    BopIt_Inputs_t inputs = 0U;
+    BopIt_TimeUs_t currentTime;
+    BopIt_TimeUs_t inputTime;
+    BopIt_TimeUs_t traceTime;
+    BopIt_TimeUs_t reactionTime = 0U;
+    Combo_Event_t event;
+    Combo_Result_t result = COMBO_RESULT_PENDING;
 
     if (gameContext != NULL)
     {
-        /* Check if the player is out of time to complete the issued command */
-        if (BopIt_GetElapsedTime(gameContext->WaitStart) > gameContext->WaitTime)
-        {
-            BopIt_Log("Out of time");
-            gameContext->GameState = BOPIT_GAMESTATE_FAIL;
-        }
+        currentTime = BopIt_GetTime(gameContext);
+        traceTime = currentTime;
 
-        /* Check if the player made the correct input and no other inputs */
-        while (commandIndex < gameContext->CommandCount && gameContext->GameState != BOPIT_GAMESTATE_FAIL)
+        if (gameContext->Matcher.Pattern != NULL)
         {
-            command = *(BopIt_Command_t **)(gameContext->Commands + commandIndex);
+            while (result == COMBO_RESULT_PENDING && (*gameContext->GetEvent)(gameContext, &event))
+            {
+                result = Combo_Feed(&gameContext->Matcher, &event);
+            }
+            result = Combo_Poll(&gameContext->Matcher, currentTime);
 
-            if ((*command->GetInput)())
+            if (result != COMBO_RESULT_PENDING)
             {
-                if (command == gameContext->CurrentCommand)
-                {
-                    gameContext->GameState = BOPIT_GAMESTATE_SUCCESS;
-                }
-                else
+                /* Traced as the inputs that replay to the same judgement */
+                inputTime = gameContext->Matcher.EndTime;
+                traceTime = inputTime;
+                inputs = (result == COMBO_RESULT_MATCHED) ? ((BopIt_Inputs_t)1U << gameContext->CurrentCommandIndex) : BOPIT_INPUTS_ALL;
+                gameContext->GameState = BopIt_JudgeInput(gameContext, result == COMBO_RESULT_MATCHED, inputTime, currentTime, &reactionTime);
+            }
+        }
+        else if (gameContext->GetInputs != NULL && gameContext->CommandCount <= BOPIT_MAX_INPUTS)
+        {
+            /* Correct input and no other inputs is a single compare against the mask of the issued command */
+            inputTime = currentTime;
+            inputs = (*gameContext->GetInputs)(gameContext, &inputTime);
+            traceTime = inputTime;
+            if (inputs != 0U)
+            {
+                gameContext->GameState = BopIt_JudgeInput(gameContext, inputs == ((BopIt_Inputs_t)1U << gameContext->CurrentCommandIndex), inputTime, currentTime, &reactionTime);
+            }
+        }
+        else
+        {
+            /* Check if the player made the correct input and no other inputs in time */
+            while (commandIndex < gameContext->CommandCount && gameContext->GameState != BOPIT_GAMESTATE_FAIL)
+            {
+                command = *(BopIt_Command_t **)(gameContext->Commands + commandIndex);
+                inputTime = currentTime;
+
+                if ((*command->GetInput)(&inputTime))
                 {
-                    gameContext->GameState = BOPIT_GAMESTATE_FAIL;
+                    gameContext->GameState = BopIt_JudgeInput(gameContext, command == gameContext->CurrentCommand, inputTime, currentTime, &reactionTime);
+
+                    /* Traced as if an input provider reported the inputs, only the first input's time is kept */
+                    if (inputs == 0U)
+                    {
+                        traceTime = inputTime;
+                    }
+                    if (commandIndex < BOPIT_MAX_INPUTS)
+                    {
+                        inputs |= (BopIt_Inputs_t)1U << commandIndex;
+                    }
                 }
+
+                commandIndex++;
             }
+        }
 
-            commandIndex++;
+        if (gameContext->GameState == BOPIT_GAMESTATE_SUCCESS)
+        {
+            BopIt_RecordReaction(gameContext, reactionTime);
+        }
+        /* Check if the player is out of time to complete the issued command */
+        else if (gameContext->GameState == BOPIT_GAMESTATE_WAIT && (gameContext->Time == NULL || (currentTime - gameContext->WaitStart) >= gameContext->WaitTime))
+        {
+            BopIt_Log(gameContext, BOPIT_LOGID_OUT_OF_TIME);
+            gameContext->GameState = BOPIT_GAMESTATE_FAIL;
+        }
+
+        if (gameContext->GameState != BOPIT_GAMESTATE_WAIT)
+        {
+            BopIt_Trace(gameContext, BOPIT_TRACEID_WAIT_END, currentTime, (uint32_t)inputs, (uint32_t)(inputs >> 32U), (uint32_t)traceTime);
         }
     }
 }
 
+/**
+ * @brief Judge an input made by the player while waiting for the issued
+ * command to be completed.
+ *
+ * @param[in]  gameContext  Context for a BopIt game
+ * @param[in]  correct      Whether the input was the correct input for the
+ * issued command and no other inputs were made
+ * @param[in]  inputTime    Time at which the input was made
+ * @param[in]  currentTime  Time at which the input was checked
+ * @param[out] reactionTime Time from issuing the command to the input, only
+ * written if the command was completed
+ *
+ * @return Game state after the input, BOPIT_GAMESTATE_SUCCESS if the command
+ * was completed, BOPIT_GAMESTATE_FAIL otherwise
+ ******************************************************************************/
+static BopIt_GameState_t BopIt_JudgeInput(const BopIt_GameContext_t *const gameContext, const bool correct, const BopIt_TimeUs_t inputTime, const BopIt_TimeUs_t currentTime, BopIt_TimeUs_t *const reactionTime)
+{
+    BopIt_GameState_t gameState = BOPIT_GAMESTATE_FAIL;
+    BopIt_TimeUs_t clampedTime = BopIt_ClampTime(inputTime, gameContext->WaitStart, currentTime);
+
+    if ((clampedTime - gameContext->WaitStart) >= gameContext->WaitTime)
+    {
+        BopIt_Log(gameContext, BOPIT_LOGID_OUT_OF_TIME);
+    }
+    else if (correct)
+    {
+        *reactionTime = clampedTime - gameContext->WaitStart;
+        gameState = BOPIT_GAMESTATE_SUCCESS;
+    }
+
+    return gameState;
+}
+
 /**
  * @brief Handle the success state of a BopIt game.  Calls function to provide
  * feedback for successfully completing the command, increments the player
@@ -324,12 +832,19 @@ static void BopIt_HandleSuccess(BopIt_GameContext_t *const gameContext)
 {
     if (gameContext != NULL)
     {
-        BopIt_Log("Player action success");
+        BopIt_Log(gameContext, BOPIT_LOGID_SUCCESS);
         gameContext->CurrentCommand->SuccessFeedback();
         gameContext->Score++;
         if (gameContext->Score < BOPIT_MAX_SCORE)
         {
-            gameContext->WaitTime -= BOPIT_WAIT_TIME_DECREMENT_MS;
+            if (gameContext->Curve == BOPIT_CURVE_ADAPTIVE)
+            {
+                gameContext->WaitTime = BopIt_GetAdaptiveWaitTime(gameContext);
+            }
+            else
+            {
+                gameContext->WaitTime = BopIt_GetCurveWaitTime(gameContext->Curve, gameContext->Score);
+            }
             gameContext->GameState = BOPIT_GAMESTATE_COMMAND;
         }
         else
@@ -339,6 +854,72 @@ static void BopIt_HandleSuccess(BopIt_GameContext_t *const gameContext)
     }
 }
 
+/**
+ * @brief Record the reaction time of a successfully completed command.  Keeps
+ * it in the game's buffer of reaction times if it has one, and updates the
+ * moving average of reaction times, in constant time, for the adaptive curve.
+ *
+ * @param[in,out] gameContext  Context for a BopIt game
+ * @param[in]     reactionTime Time from issuing the command to the input
+ ******************************************************************************/
+static void BopIt_RecordReaction(BopIt_GameContext_t *const gameContext, const BopIt_TimeUs_t reactionTime)
+{
+    uint32_t averagedTime;
+
+    if (gameContext->ReactionCount < BOPIT_MAX_SCORE)
+    {
+        if (gameContext->Reactions != NULL)
+        {
+            gameContext->Reactions[gameContext->ReactionCount].CommandIndex = gameContext->CurrentCommandIndex;
+            gameContext->Reactions[gameContext->ReactionCount].Time = reactionTime;
+        }
+        gameContext->ReactionCount++;
+
+        if (gameContext->Curve == BOPIT_CURVE_ADAPTIVE)
+        {
+            averagedTime = (uint32_t)reactionTime << BOPIT_ADAPTIVE_FRACTION_SHIFT;
+            if (gameContext->ReactionCount == 1U)
+            {
+                gameContext->ReactionAverage = averagedTime;
+            }
+            else
+            {
+                gameContext->ReactionAverage += (averagedTime >> BOPIT_ADAPTIVE_AVERAGE_SHIFT) - (gameContext->ReactionAverage >> BOPIT_ADAPTIVE_AVERAGE_SHIFT);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Get the time to complete the next command on the adaptive curve.
+ * Allows a margin over the moving average of reaction times, bounded by the
+ * minimum time and the linear curve.
+ *
+ * @param[in] gameContext Context for a BopIt game
+ *
+ * @return Time to complete the next command in microseconds
+ ******************************************************************************/
+static BopIt_TimeUs_t BopIt_GetAdaptiveWaitTime(const BopIt_GameContext_t *const gameContext)
+{
+    BopIt_TimeUs_t waitTime = BopIt_GetCurveWaitTime(BOPIT_CURVE_LINEAR, gameContext->Score);
+    BopIt_TimeUs_t adaptiveTime;
+
+    if (gameContext->ReactionCount > 0U)
+    {
+        adaptiveTime = ((gameContext->ReactionAverage >> BOPIT_ADAPTIVE_FRACTION_SHIFT) * BOPIT_ADAPTIVE_MARGIN_PERCENT) / BOPIT_PERCENT;
+        if (adaptiveTime < BOPIT_MIN_WAIT_TIME_US)
+        {
+            adaptiveTime = BOPIT_MIN_WAIT_TIME_US;
+        }
+        if (adaptiveTime < waitTime)
+        {
+            waitTime = adaptiveTime;
+        }
+    }
+
+    return waitTime;
+}
+
 /**
  * @brief Handle the success state of a BopIt game.  Calls function to provide
  * feedback for failing to complete the command and decreases player lives.
@@ -349,7 +930,7 @@ static void BopIt_HandleFail(BopIt_GameContext_t *const gameContext)
 {
     if (gameContext != NULL)
     {
-        BopIt_Log("Player action fail");
+        BopIt_Log(gameContext, BOPIT_LOGID_FAIL);
         gameContext->CurrentCommand->FailFeedback();
         gameContext->Lives--;
         if (gameContext->Lives == 0U)
@@ -372,8 +953,8 @@ static void BopIt_HandleEnd(BopIt_GameContext_t *const gameContext)
 {
     if (gameContext != NULL)
     {
-        BopIt_Log("Game over");
-        BopIt_Log("Score: %d, Lives: %d", gameContext->Score, gameContext->Lives);
+        BopIt_Log(gameContext, BOPIT_LOGID_GAME_OVER);
+        BopIt_Log(gameContext, BOPIT_LOGID_FINAL_SCORE, (uint32_t)gameContext->Score, (uint32_t)gameContext->Lives);
 
         if (gameContext->OnGameEnd != NULL)
         {
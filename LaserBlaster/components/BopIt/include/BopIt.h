@@ -10,13 +10,52 @@
 
 /* Includes
  ******************************************************************************/
+#include "Combo.h"
+#include "LogRing.h"
+#include "Prng.h"
 #include <stdbool.h>
 #include <stdint.h>
 
+/* Defines
+ ******************************************************************************/
+
+#define BOPIT_RUN_DELAY_INFINITE UINT64_MAX /* BopIt_Run does not need to be called again unless there is input */
+#define BOPIT_MAX_SCORE 99U                 /* Maximum game score, game is over after player reaches this score */
+#define BOPIT_MAX_INPUTS 64U                /* Maximum number of commands an input provider can report, one per bit of BopIt_Inputs_t */
+#define BOPIT_MAX_WAIT_TIME_US 5000000U     /* Maximum time in microseconds to complete a command */
+#define BOPIT_MIN_WAIT_TIME_US 500000U      /* Minimum time in microseconds to complete a command */
+
 /* Typedefs
  ******************************************************************************/
 
-typedef uint32_t BopIt_TimeMs_t; /* Time in milliseconds */
+typedef uint64_t BopIt_TimeUs_t; /* Time in microseconds from a monotonic clock, 64 bits so it never wraps */
+typedef uint64_t BopIt_Inputs_t; /* Bitmask of inputs, bit n is set if the input of the command at index n was made */
+
+/* IDs of messages logged by BopIt, used as format IDs of deferred log records */
+typedef enum
+{
+    BOPIT_LOGID_STARTING_GAME, /* Game started */
+    BOPIT_LOGID_NO_COMMANDS,   /* Game ended because there are no commands */
+    BOPIT_LOGID_STATUS,        /* Score, lives and time in milliseconds to complete the next command */
+    BOPIT_LOGID_ISSUING,       /* Index of the command issued */
+    BOPIT_LOGID_WAITING,       /* Waiting for the player */
+    BOPIT_LOGID_OUT_OF_TIME,   /* Player ran out of time */
+    BOPIT_LOGID_SUCCESS,       /* Player completed the command */
+    BOPIT_LOGID_FAIL,          /* Player failed the command */
+    BOPIT_LOGID_GAME_OVER,     /* Game ended */
+    BOPIT_LOGID_FINAL_SCORE,   /* Final score and lives */
+    BOPIT_LOGID_COUNT,         /* Number of log IDs */
+} BopIt_LogId_t;
+
+/* IDs of trace records written by BopIt, used as format IDs of records in a game's trace ring.  Times in trace records are the low 32 bits of the game's time in microseconds */
+typedef enum
+{
+    BOPIT_TRACEID_GAME_START, /* Game started, arguments are the low and high words of the state of the game's generator, the number of commands, and the selection mode and curve in the low and high half words */
+    BOPIT_TRACEID_COMMAND,    /* Command issued, time is when the wait started, argument is the index of the command */
+    BOPIT_TRACEID_WAIT_END,   /* Wait ended by input or running out of time, time is when inputs were checked, arguments are the low and high words of the inputs and the time of the inputs, the inputs of a command with a pattern are the command's own input if the pattern was matched and every input if it failed */
+    BOPIT_TRACEID_STATE,      /* Game state changed, time is 0, arguments are the new state, score and lives */
+    BOPIT_TRACEID_COUNT,      /* Number of trace IDs */
+} BopIt_TraceId_t;
 
 /* BopIt game states */
 typedef enum
@@ -29,37 +68,99 @@ typedef enum
     BOPIT_GAMESTATE_END,     /* Game is over */
 } BopIt_GameState_t;
 
+/* How the next command is selected */
+typedef enum
+{
+    BOPIT_SELECTION_UNIFORM,   /* Every command is equally likely */
+    BOPIT_SELECTION_NO_REPEAT, /* Every command other than the previous one is equally likely */
+    BOPIT_SELECTION_WEIGHTED,  /* Commands are selected in proportion to their weights in the game's alias table */
+} BopIt_Selection_t;
+
+/* How the time to complete a command decreases as the score increases */
+typedef enum
+{
+    BOPIT_CURVE_LINEAR,      /* Decreases by the same time after every completed command, reaching the minimum on the last command */
+    BOPIT_CURVE_EXPONENTIAL, /* Decreases by the same fraction of the time above the minimum after every completed command */
+    BOPIT_CURVE_STEPPED,     /* Decreases by the same time after every ten completed commands */
+    BOPIT_CURVE_ADAPTIVE,    /* Follows a moving average of the player's reaction times, never longer than the linear curve */
+    BOPIT_CURVE_COUNT,       /* Number of curves */
+} BopIt_Curve_t;
+
 /* Command for player */
 typedef struct
 {
-    const char *Name;              /* Name of the command */
-    void (*IssueCommand)(void);    /* Perform all tasks needed to issue the command */
-    void (*SuccessFeedback)(void); /* Provide feedback for successfully completing the command */
-    void (*FailFeedback)(void);    /* Provide feedback for failing to complete the command */
-    bool (*GetInput)(void);        /* Check if the player made the input corresponding to the command */
+    const char *Name;                                  /* Name of the command */
+    void (*IssueCommand)(void);                        /* Perform all tasks needed to issue the command */
+    void (*SuccessFeedback)(void);                     /* Provide feedback for successfully completing the command */
+    void (*FailFeedback)(void);                        /* Provide feedback for failing to complete the command */
+    bool (*GetInput)(BopIt_TimeUs_t *const inputTime); /* Check if the player made the input corresponding to the command, optionally setting the time at which it was made, may be NULL if the game's input provider reports every command */
+    const uint8_t *Pattern;                            /* Optional Combo pattern the player must complete instead of making the input, matched from the game's input events */
+    uint32_t PatternSize;                              /* Size of the pattern in bytes */
 } BopIt_Command_t;
 
+/* Reaction time for a successfully completed command */
+typedef struct
+{
+    uint32_t CommandIndex; /* Index of the completed command in the game's list of commands */
+    BopIt_TimeUs_t Time;   /* Time from issuing the command to the player making the input */
+} BopIt_Reaction_t;
+
+/* Reaction time statistics */
+typedef struct
+{
+    uint32_t Count;      /* Number of reaction times measured */
+    BopIt_TimeUs_t Min;  /* Fastest reaction time */
+    BopIt_TimeUs_t Mean; /* Mean reaction time */
+    BopIt_TimeUs_t P95;  /* 95th percentile reaction time */
+} BopIt_ReactionTimes_t;
+
 typedef struct BopIt_GameContext BopIt_GameContext_t; /* Context for a BopIt game, manages game state */
 struct BopIt_GameContext
 {
-    BopIt_GameState_t GameState;                                 /* State of BopIt game */
-    uint8_t Score;                                               /* Player score */
-    uint8_t Lives;                                               /* Remaining player lives */
-    BopIt_Command_t **Commands;                                  /* List of possible commands the game can issue to player */
-    uint32_t CommandCount;                                       /* Number of possible game commands */
-    BopIt_Command_t *CurrentCommand;                             /* Command currently issued to player */
-    BopIt_TimeMs_t WaitTime;                                     /* Time player has to complete command currently issued */
-    BopIt_TimeMs_t WaitStart;                                    /* Time at which the current command was issued */
-    void (*OnGameStart)(BopIt_GameContext_t *const gameContext); /* Callback executed on game start */
-    void (*OnGameEnd)(BopIt_GameContext_t *const gameContext);   /* Callback executed on game end */
+    /* Game state, accessed on every call to BopIt_Run */
+    BopIt_GameState_t GameState;     /* State of BopIt game */
+    uint8_t Score;                   /* Player score */
+    uint8_t Lives;                   /* Remaining player lives */
+    uint8_t ReactionCount;           /* Number of reaction times measured in the current game, whether kept or not */
+    uint32_t CurrentCommandIndex;    /* Index of the command currently issued to player */
+    BopIt_TimeUs_t WaitTime;         /* Time player has to complete command currently issued */
+    BopIt_TimeUs_t WaitStart;        /* Time at which the current command was issued */
+    BopIt_Command_t *CurrentCommand; /* Command currently issued to player */
+    Prng_t Prng;                     /* Generator for selecting commands, seeded with BopIt_Seed */
+    uint32_t ReactionAverage;        /* Exponentially weighted moving average of reaction times in 1/16 us for BOPIT_CURVE_ADAPTIVE, 0 before the first reaction */
+
+    /* Configuration set by the client */
+    BopIt_Command_t **Commands;                                                                           /* List of possible commands the game can issue to player */
+    uint32_t CommandCount;                                                                                /* Number of possible game commands */
+    BopIt_Inputs_t (*GetInputs)(BopIt_GameContext_t *const gameContext, BopIt_TimeUs_t *const inputTime); /* Optional input provider returning all inputs made since the last call and optionally setting the time of the earliest, replaces calling GetInput of each command */
+    bool (*GetEvent)(BopIt_GameContext_t *const gameContext, Combo_Event_t *const event);                 /* Optional source of input events in order of time, returning false when there are none left, commands with a pattern are matched from its events when set */
+    BopIt_TimeUs_t (*Time)(const BopIt_GameContext_t *const gameContext);                                 /* Function to get the current time in microseconds, every wait runs out of time as soon as it starts if NULL */
+    BopIt_Selection_t Selection;                                                                          /* How commands are selected */
+    BopIt_Curve_t Curve;                                                                                  /* How the time to complete a command decreases, linear if not valid */
+    const Prng_AliasTable_t *CommandWeights;                                                              /* Alias table with one weight per command for BOPIT_SELECTION_WEIGHTED, built with Prng_AliasInit, commands are selected uniformly if NULL */
+    void (*Logger)(const BopIt_GameContext_t *const gameContext, const char *const message);              /* Logging function, printf is used if NULL */
+    LogRing_t *LogRing;                                                                                   /* Optional ring for deferred logging, messages are formatted by the client instead of logged when set */
+    LogRing_t *TraceRing;                                                                                 /* Optional ring for trace records of the game's inputs and state changes, written when set so the game can be replayed */
+    BopIt_Reaction_t *Reactions;                                                                          /* Optional buffer of BOPIT_MAX_SCORE reaction times owned by the client, filled with one per successfully completed command in the current game when set */
+    void *UserData;                                                                                       /* Data for the client's hooks and callbacks, not used by BopIt */
+    void (*OnGameStart)(BopIt_GameContext_t *const gameContext);                                          /* Callback executed on game start */
+    void (*OnGameEnd)(BopIt_GameContext_t *const gameContext);                                            /* Callback executed on game end */
+
+    /* Pattern matching, only accessed while waiting on a command with a pattern */
+    Combo_Matcher_t Matcher; /* Matcher of the pattern of the issued command, its pattern is NULL if the command is not matched from events */
 };
 
 /* Function Prototypes
  ******************************************************************************/
 
-void BopIt_RegisterLogger(void (*logger)(const char *const message));
-void BopIt_RegisterTime(BopIt_TimeMs_t (*time)(void));
 void BopIt_Init(BopIt_GameContext_t *const gameContext);
+void BopIt_Seed(BopIt_GameContext_t *const gameContext, const uint64_t seed);
 void BopIt_Run(BopIt_GameContext_t *const gameContext);
+uint32_t BopIt_RunBatch(BopIt_GameContext_t *const gameContexts, uint32_t *const running, const uint32_t runningCount);
+BopIt_TimeUs_t BopIt_GetRunDelay(const BopIt_GameContext_t *const gameContext);
+BopIt_TimeUs_t BopIt_GetCurveWaitTime(const BopIt_Curve_t curve, const uint8_t score);
+const char *BopIt_GetLogFormat(const uint16_t logId);
+int BopIt_FormatLog(const BopIt_GameContext_t *const gameContext, const LogRing_Record_t *const record, char *const buffer, const size_t size);
+bool BopIt_GetReactionTimes(const BopIt_GameContext_t *const gameContext, const BopIt_Command_t *const command, BopIt_ReactionTimes_t *const reactionTimes);
 
 #endif
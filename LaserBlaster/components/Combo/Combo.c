@@ -0,0 +1,355 @@
+/**
+ * @file Combo.c
+ *
+ * @brief Compact patterns of input events and a fixed-size matcher for them.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Combo.h"
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define COMBO_US_PER_MS 1000U /* Microseconds in a millisecond, the unit of a pattern's times */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static uint16_t Combo_ReadU16(const uint8_t *const bytes);
+static void Combo_LoadStep(Combo_Matcher_t *const matcher);
+static void Combo_End(Combo_Matcher_t *const matcher, const Combo_Result_t result, const Combo_TimeUs_t time);
+static Combo_TimeUs_t Combo_GetFailTime(const Combo_Matcher_t *const matcher);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Check that a pattern is well formed: every instruction is known and
+ * complete, inputs are in range, chords have between one and COMBO_MAX_CHORD
+ * inputs, every WITHIN is followed by a step, and the pattern ends with
+ * COMBO_OP_END as its last byte.
+ *
+ * @param[in] pattern Pattern to check
+ * @param[in] size    Size of the pattern in bytes
+ *
+ * @return Whether the pattern is well formed or not
+ ******************************************************************************/
+bool Combo_Validate(const uint8_t *const pattern, const uint32_t size)
+{
+    bool valid = false;
+    bool done = false;
+    bool within = false;
+    uint32_t offset = 0U;
+    uint8_t count;
+
+    if (pattern != NULL)
+    {
+        valid = true;
+        while (valid && !done && offset < size)
+        {
+            switch (pattern[offset])
+            {
+            case COMBO_OP_END:
+                valid = !within && (offset + 1U == size);
+                done = true;
+                break;
+            case COMBO_OP_PRESS:
+                valid = (size - offset > 1U) && (pattern[offset + 1U] < COMBO_MAX_INPUTS);
+                offset += 2U;
+                within = false;
+                break;
+            case COMBO_OP_CHORD:
+                valid = (size - offset > 3U);
+                if (valid)
+                {
+                    count = pattern[offset + 3U];
+                    valid = (count > 0U) && (count <= COMBO_MAX_CHORD) && (size - offset > 3U + (uint32_t)count);
+                    for (uint8_t i = 0U; valid && i < count; i++)
+                    {
+                        valid = (pattern[offset + 4U + i] < COMBO_MAX_INPUTS);
+                    }
+                    offset += 4U + (uint32_t)count;
+                }
+                within = false;
+                break;
+            case COMBO_OP_HOLD:
+                valid = (size - offset > 3U) && (pattern[offset + 1U] < COMBO_MAX_INPUTS);
+                offset += 4U;
+                within = false;
+                break;
+            case COMBO_OP_WITHIN:
+                valid = !within && (size - offset > 2U);
+                offset += 3U;
+                within = true;
+                break;
+            default:
+                valid = false;
+                break;
+            }
+        }
+        valid = valid && done;
+    }
+
+    return valid;
+}
+
+/**
+ * @brief Start matching a pattern, discarding any match in progress.
+ *
+ * @param[out] matcher Matcher to start
+ * @param[in]  pattern Pattern to match, must stay valid until the match ends
+ * @param[in]  size    Size of the pattern in bytes
+ * @param[in]  start   Time the match starts, from which the deadline of the
+ *                     first step counts
+ *
+ * @return Whether the pattern is well formed and the match was started or not
+ ******************************************************************************/
+bool Combo_Start(Combo_Matcher_t *const matcher, const uint8_t *const pattern, const uint32_t size, const Combo_TimeUs_t start)
+{
+    bool started = false;
+
+    if (matcher != NULL && Combo_Validate(pattern, size))
+    {
+        matcher->Pattern = pattern;
+        matcher->Size = size;
+        matcher->Next = 0U;
+        matcher->Result = COMBO_RESULT_PENDING;
+        matcher->StepStart = start;
+        matcher->EndTime = start;
+        Combo_LoadStep(matcher);
+        started = true;
+    }
+
+    return started;
+}
+
+/**
+ * @brief Advance a match with an input event.  The match is first polled up
+ * to the time of the event, and events from before the current step started
+ * are taken to have happened when it started.
+ *
+ * @param[in,out] matcher Matcher to advance
+ * @param[in]     event   Input event, events must be fed in order of time
+ *
+ * @return State of the match after the event
+ ******************************************************************************/
+Combo_Result_t Combo_Feed(Combo_Matcher_t *const matcher, const Combo_Event_t *const event)
+{
+    Combo_Result_t result = COMBO_RESULT_FAILED;
+    Combo_TimeUs_t time;
+    uint64_t input;
+
+    if (matcher != NULL && event != NULL)
+    {
+        result = Combo_Poll(matcher, event->Time);
+        if (result == COMBO_RESULT_PENDING)
+        {
+            time = (event->Time > matcher->StepStart) ? event->Time : matcher->StepStart;
+            input = (event->Input < COMBO_MAX_INPUTS) ? (1ULL << event->Input) : 0U;
+
+            if (event->Released)
+            {
+                /* Letting go of the held input before its hold is over is the only release that counts */
+                if (matcher->Op == COMBO_OP_HOLD && input == matcher->StepInputs && matcher->HoldEnd != COMBO_NO_DEADLINE)
+                {
+                    Combo_End(matcher, COMBO_RESULT_FAILED, time);
+                }
+            }
+            else if ((input & matcher->StepInputs) == 0U)
+            {
+                Combo_End(matcher, COMBO_RESULT_FAILED, time);
+            }
+            else if (matcher->Op == COMBO_OP_PRESS)
+            {
+                matcher->StepStart = time;
+                Combo_LoadStep(matcher);
+            }
+            else if (matcher->Op == COMBO_OP_CHORD)
+            {
+                if (matcher->Pressed == 0U)
+                {
+                    matcher->ChordStart = time;
+                }
+                matcher->Pressed |= input;
+                if (matcher->Pressed == matcher->StepInputs)
+                {
+                    matcher->StepStart = time;
+                    Combo_LoadStep(matcher);
+                }
+            }
+            else if (matcher->HoldEnd == COMBO_NO_DEADLINE)
+            {
+                matcher->HoldEnd = time + matcher->StepTimeUs;
+            }
+
+            result = matcher->Result;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Advance a match to a time without an input event, completing a hold
+ * that is over or failing a step whose deadline or chord window has passed.
+ *
+ * @param[in,out] matcher Matcher to advance
+ * @param[in]     now     Current time
+ *
+ * @return State of the match at the time
+ ******************************************************************************/
+Combo_Result_t Combo_Poll(Combo_Matcher_t *const matcher, const Combo_TimeUs_t now)
+{
+    Combo_Result_t result = COMBO_RESULT_FAILED;
+    Combo_TimeUs_t failTime;
+
+    if (matcher != NULL)
+    {
+        if (matcher->Result == COMBO_RESULT_PENDING && matcher->Op == COMBO_OP_HOLD && matcher->HoldEnd <= now && matcher->HoldEnd < matcher->Deadline)
+        {
+            matcher->StepStart = matcher->HoldEnd;
+            Combo_LoadStep(matcher);
+        }
+
+        /* A step just loaded has nothing pressed yet, so only its deadline can have passed */
+        if (matcher->Result == COMBO_RESULT_PENDING)
+        {
+            failTime = Combo_GetFailTime(matcher);
+            if (failTime <= now)
+            {
+                Combo_End(matcher, COMBO_RESULT_FAILED, failTime);
+            }
+        }
+
+        result = matcher->Result;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Get the next time at which the match changes without an input event,
+ * by a hold being over or a deadline passing.  Clients without a stream of
+ * events poll the matcher at this time.
+ *
+ * @param[in] matcher Matcher to get the deadline of
+ *
+ * @return Time of the next change, COMBO_NO_DEADLINE if the match has ended or
+ * waits on input events only
+ ******************************************************************************/
+Combo_TimeUs_t Combo_GetDeadline(const Combo_Matcher_t *const matcher)
+{
+    Combo_TimeUs_t deadline = COMBO_NO_DEADLINE;
+
+    if (matcher != NULL && matcher->Result == COMBO_RESULT_PENDING)
+    {
+        deadline = Combo_GetFailTime(matcher);
+        if (matcher->Op == COMBO_OP_HOLD && matcher->HoldEnd < deadline)
+        {
+            deadline = matcher->HoldEnd;
+        }
+    }
+
+    return deadline;
+}
+
+/**
+ * @brief Read a little-endian 16-bit operand.
+ *
+ * @param[in] bytes Bytes of the operand
+ *
+ * @return Value of the operand
+ ******************************************************************************/
+static uint16_t Combo_ReadU16(const uint8_t *const bytes)
+{
+    return (uint16_t)((uint16_t)bytes[0U] | ((uint16_t)bytes[1U] << 8U));
+}
+
+/**
+ * @brief Load the step at the matcher's next instruction, along with the
+ * deadline before it if any, or end the match as matched at the end of the
+ * pattern.  The pattern must be well formed.
+ *
+ * @param[in,out] matcher Matcher to load the next step of
+ ******************************************************************************/
+static void Combo_LoadStep(Combo_Matcher_t *const matcher)
+{
+    const uint8_t *instruction = &matcher->Pattern[matcher->Next];
+    uint8_t count;
+
+    matcher->Deadline = COMBO_NO_DEADLINE;
+    if (instruction[0U] == COMBO_OP_WITHIN)
+    {
+        matcher->Deadline = matcher->StepStart + ((Combo_TimeUs_t)Combo_ReadU16(&instruction[1U]) * COMBO_US_PER_MS);
+        instruction += 3U;
+    }
+
+    matcher->Op = instruction[0U];
+    matcher->Pressed = 0U;
+    matcher->HoldEnd = COMBO_NO_DEADLINE;
+
+    switch (matcher->Op)
+    {
+    case COMBO_OP_PRESS:
+        matcher->StepInputs = 1ULL << instruction[1U];
+        instruction += 2U;
+        break;
+    case COMBO_OP_CHORD:
+        matcher->StepTimeUs = (Combo_TimeUs_t)Combo_ReadU16(&instruction[1U]) * COMBO_US_PER_MS;
+        count = instruction[3U];
+        matcher->StepInputs = 0U;
+        for (uint8_t i = 0U; i < count; i++)
+        {
+            matcher->StepInputs |= 1ULL << instruction[4U + i];
+        }
+        instruction += 4U + (uint32_t)count;
+        break;
+    case COMBO_OP_HOLD:
+        matcher->StepInputs = 1ULL << instruction[1U];
+        matcher->StepTimeUs = (Combo_TimeUs_t)Combo_ReadU16(&instruction[2U]) * COMBO_US_PER_MS;
+        instruction += 4U;
+        break;
+    default:
+        matcher->StepInputs = 0U;
+        Combo_End(matcher, COMBO_RESULT_MATCHED, matcher->StepStart);
+        break;
+    }
+
+    matcher->Next = (uint32_t)(instruction - matcher->Pattern);
+}
+
+/**
+ * @brief End a match.
+ *
+ * @param[in,out] matcher Matcher to end
+ * @param[in]     result  Result of the match
+ * @param[in]     time    Time the match ended
+ ******************************************************************************/
+static void Combo_End(Combo_Matcher_t *const matcher, const Combo_Result_t result, const Combo_TimeUs_t time)
+{
+    matcher->Result = result;
+    matcher->EndTime = time;
+}
+
+/**
+ * @brief Get the time at which the current step fails if it is not completed,
+ * by its deadline passing or by the window of a chord started closing.
+ *
+ * @param[in] matcher Matcher to get the fail time of
+ *
+ * @return Time the current step fails, COMBO_NO_DEADLINE if never
+ ******************************************************************************/
+static Combo_TimeUs_t Combo_GetFailTime(const Combo_Matcher_t *const matcher)
+{
+    Combo_TimeUs_t failTime = matcher->Deadline;
+
+    if (matcher->Op == COMBO_OP_CHORD && matcher->Pressed != 0U && matcher->ChordStart + matcher->StepTimeUs < failTime)
+    {
+        failTime = matcher->ChordStart + matcher->StepTimeUs;
+    }
+
+    return failTime;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file Combo.h
+ *
+ * @brief Compact patterns of input events, such as sequences, chords and
+ * holds, and a fixed-size matcher advancing a pattern one input event at a
+ * time.  Matching an event costs the same whatever the length of the pattern,
+ * and the matcher never allocates.
+ *
+ * A pattern is a bytecode of steps, each completed before the next, ending
+ * with COMBO_OP_END.  Times are in milliseconds, little-endian:
+ *
+ *   END                               Pattern is complete
+ *   PRESS input                       Press the input
+ *   CHORD windowMs u16, count, inputs Press every input, in any order, the
+ *                                     last within the window of the first
+ *   HOLD input, durationMs u16        Press the input and keep it down for
+ *                                     the duration
+ *   WITHIN timeMs u16                 Complete the next step within the time
+ *                                     of completing the previous one, or of
+ *                                     the start for the first step
+ *
+ * Pressing an input that is not part of the current step fails the pattern,
+ * as does releasing an input being held before its hold is over.  Other
+ * releases are ignored.  Patterns are written with the COMBO_ macros, e.g.
+ * input 0 then input 2 within 300 ms:
+ *
+ *   static const uint8_t pattern[] = {COMBO_PRESS(0U), COMBO_WITHIN(300U), COMBO_PRESS(2U), COMBO_END};
+ *
+ ******************************************************************************/
+
+#ifndef COMBO_H
+#define COMBO_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define COMBO_MAX_INPUTS 64U                                                            /* Number of inputs a pattern can refer to, one per bit of a step's mask */
+#define COMBO_MAX_CHORD 8U                                                              /* Largest number of inputs of a chord, bounds the cost of loading a step */
+#define COMBO_NO_DEADLINE UINT64_MAX                                                    /* Deadline of a matcher that only advances on input events */
+#define COMBO_U16(value) (uint8_t)((value) & 0xFFU), (uint8_t)(((value) >> 8U) & 0xFFU) /* Little-endian bytes of a 16-bit operand */
+
+#define COMBO_PRESS(input) COMBO_OP_PRESS, (uint8_t)(input)                                  /* Step pressing an input */
+#define COMBO_CHORD(windowMs, count) COMBO_OP_CHORD, COMBO_U16(windowMs), (uint8_t)(count)   /* Step pressing a chord, followed by the count inputs of the chord */
+#define COMBO_HOLD(input, durationMs) COMBO_OP_HOLD, (uint8_t)(input), COMBO_U16(durationMs) /* Step holding an input down */
+#define COMBO_WITHIN(timeMs) COMBO_OP_WITHIN, COMBO_U16(timeMs)                              /* Deadline of the next step */
+#define COMBO_END COMBO_OP_END                                                               /* End of a pattern */
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef uint64_t Combo_TimeUs_t; /* Time in microseconds from a monotonic clock */
+
+/* Instructions of a pattern */
+typedef enum
+{
+    COMBO_OP_END,    /* Pattern is complete */
+    COMBO_OP_PRESS,  /* Press an input */
+    COMBO_OP_CHORD,  /* Press several inputs together */
+    COMBO_OP_HOLD,   /* Press an input and keep it down */
+    COMBO_OP_WITHIN, /* Deadline of the next step */
+    COMBO_OP_COUNT,  /* Number of instructions */
+} Combo_Op_t;
+
+/* State of a match */
+typedef enum
+{
+    COMBO_RESULT_PENDING, /* Pattern is not complete yet */
+    COMBO_RESULT_MATCHED, /* Every step of the pattern was completed */
+    COMBO_RESULT_FAILED,  /* Pattern can no longer be completed */
+} Combo_Result_t;
+
+/* Input event */
+typedef struct
+{
+    Combo_TimeUs_t Time; /* Time the event occurred */
+    uint8_t Input;       /* Index of the input */
+    bool Released;       /* Whether the input was released, pressed otherwise */
+} Combo_Event_t;
+
+/* Matcher of a pattern */
+typedef struct
+{
+    const uint8_t *Pattern;    /* Pattern being matched */
+    uint32_t Size;             /* Size of the pattern in bytes */
+    uint32_t Next;             /* Offset of the instruction after the current step */
+    uint8_t Op;                /* Instruction of the current step */
+    Combo_Result_t Result;     /* State of the match */
+    Combo_TimeUs_t StepStart;  /* Time the previous step was completed, or the match started */
+    Combo_TimeUs_t Deadline;   /* Latest time the current step can be completed, COMBO_NO_DEADLINE if none */
+    Combo_TimeUs_t EndTime;    /* Time the pattern was matched or failed */
+    uint64_t StepInputs;       /* Mask of the inputs of the current step */
+    uint64_t Pressed;          /* Mask of the inputs of the current chord pressed so far */
+    Combo_TimeUs_t ChordStart; /* Time the first input of the current chord was pressed */
+    Combo_TimeUs_t StepTimeUs; /* Window of the current chord or duration of the current hold */
+    Combo_TimeUs_t HoldEnd;    /* Time the current hold is over, COMBO_NO_DEADLINE until the input is pressed */
+} Combo_Matcher_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+bool Combo_Validate(const uint8_t *const pattern, const uint32_t size);
+bool Combo_Start(Combo_Matcher_t *const matcher, const uint8_t *const pattern, const uint32_t size, const Combo_TimeUs_t start);
+Combo_Result_t Combo_Feed(Combo_Matcher_t *const matcher, const Combo_Event_t *const event);
+Combo_Result_t Combo_Poll(Combo_Matcher_t *const matcher, const Combo_TimeUs_t now);
+Combo_TimeUs_t Combo_GetDeadline(const Combo_Matcher_t *const matcher);
+
+#endif
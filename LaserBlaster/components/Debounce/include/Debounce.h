@@ -0,0 +1,152 @@
+/**
+ * @file Debounce.h
+ *
+ * @brief Debouncing of mechanical inputs from their edges.  Each input keeps a
+ * small state machine that accepts the first edge of a press or release
+ * immediately, so debouncing adds no latency, and then rejects every edge in a
+ * lockout window long enough for the contacts to stop bouncing.
+ *
+ * Functions are inline so they can be called from ISRs placed in IRAM.  An
+ * input's state must only be updated by a single ISR, statistics may be read
+ * from any task.
+ *
+ ******************************************************************************/
+
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef int64_t Debounce_TimeUs_t; /* Time in microseconds, does not wrap around */
+
+/* Event produced by an edge of an input */
+typedef enum
+{
+    DEBOUNCE_EVENT_NONE,    /* Edge was a bounce and was rejected */
+    DEBOUNCE_EVENT_PRESS,   /* Input was pressed */
+    DEBOUNCE_EVENT_RELEASE, /* Input was released */
+} Debounce_Event_t;
+
+/* Lockout windows of an input */
+typedef struct
+{
+    Debounce_TimeUs_t PressLockoutUs;   /* Time after a press during which edges are rejected */
+    Debounce_TimeUs_t ReleaseLockoutUs; /* Time after a release during which edges are rejected */
+} Debounce_Config_t;
+
+/* Statistics of an input */
+typedef struct
+{
+    uint32_t Presses;  /* Number of presses accepted */
+    uint32_t Releases; /* Number of releases accepted */
+    uint32_t Bounces;  /* Number of edges rejected */
+} Debounce_Stats_t;
+
+/* State of an input */
+typedef struct
+{
+    bool Pressed;                 /* Whether the input was last accepted as pressed */
+    bool Level;                   /* Whether the input read as pressed at the last edge, including rejected edges */
+    Debounce_TimeUs_t LockoutEnd; /* Time before which edges are rejected */
+    _Atomic uint32_t Presses;     /* Number of presses accepted */
+    _Atomic uint32_t Releases;    /* Number of releases accepted */
+    _Atomic uint32_t Bounces;     /* Number of edges rejected */
+} Debounce_Input_t;
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize an input as released with no lockout.
+ *
+ * @param[out] input Input to initialize
+ ******************************************************************************/
+static inline void Debounce_Init(Debounce_Input_t *const input)
+{
+    input->Pressed = false;
+    input->Level = false;
+    input->LockoutEnd = INT64_MIN;
+    atomic_init(&input->Presses, 0U);
+    atomic_init(&input->Releases, 0U);
+    atomic_init(&input->Bounces, 0U);
+}
+
+/**
+ * @brief Debounce an edge of an input.  Edges inside the lockout window of the
+ * last accepted press or release are rejected.  After the window, the level of
+ * the input read in the ISR decides the event.  A press is also accepted while
+ * the input is pressed if the last edge read as released, since the release
+ * ended inside a lockout window and was never accepted.  Safe to call from an
+ * ISR.
+ *
+ * @param[in,out] input   Input the edge belongs to
+ * @param[in]     config  Lockout windows of the input
+ * @param[in]     pressed Whether the input reads as pressed after the edge
+ * @param[in]     timeUs  Time of the edge, never earlier than the previous edge
+ *
+ * @return Event produced by the edge, DEBOUNCE_EVENT_NONE if it was rejected
+ ******************************************************************************/
+static inline Debounce_Event_t Debounce_Edge(Debounce_Input_t *const input, const Debounce_Config_t *const config, const bool pressed, const Debounce_TimeUs_t timeUs)
+{
+    Debounce_Event_t event = DEBOUNCE_EVENT_NONE;
+
+    if (timeUs < input->LockoutEnd)
+    {
+        /* Contacts are still bouncing */
+    }
+    else if (pressed && (!input->Pressed || !input->Level))
+    {
+        input->Pressed = true;
+        input->LockoutEnd = timeUs + config->PressLockoutUs;
+        event = DEBOUNCE_EVENT_PRESS;
+    }
+    else if (input->Pressed)
+    {
+        input->Pressed = false;
+        input->LockoutEnd = timeUs + config->ReleaseLockoutUs;
+        event = DEBOUNCE_EVENT_RELEASE;
+    }
+    else
+    {
+        /* Level did not change, a glitch or a bounce read late by the ISR */
+    }
+
+    input->Level = pressed;
+
+    switch (event)
+    {
+    case DEBOUNCE_EVENT_PRESS:
+        atomic_fetch_add_explicit(&input->Presses, 1U, memory_order_relaxed);
+        break;
+    case DEBOUNCE_EVENT_RELEASE:
+        atomic_fetch_add_explicit(&input->Releases, 1U, memory_order_relaxed);
+        break;
+    default:
+        atomic_fetch_add_explicit(&input->Bounces, 1U, memory_order_relaxed);
+        break;
+    }
+
+    return event;
+}
+
+/**
+ * @brief Get the statistics of an input.  Safe to call from any task.
+ *
+ * @param[in]  input Input to get the statistics of
+ * @param[out] stats Statistics of the input
+ ******************************************************************************/
+static inline void Debounce_GetStats(Debounce_Input_t *const input, Debounce_Stats_t *const stats)
+{
+    stats->Presses = atomic_load_explicit(&input->Presses, memory_order_relaxed);
+    stats->Releases = atomic_load_explicit(&input->Releases, memory_order_relaxed);
+    stats->Bounces = atomic_load_explicit(&input->Bounces, memory_order_relaxed);
+}
+
+#endif
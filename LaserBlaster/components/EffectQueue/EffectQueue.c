@@ -0,0 +1,219 @@
+/**
+ * @file EffectQueue.c
+ *
+ * @brief Fixed-size priority queue of feedback effects.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "EffectQueue.h"
+#include <stddef.h>
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static bool EffectQueue_IsBefore(const EffectQueue_Entry_t *const a, const EffectQueue_Entry_t *const b);
+static void EffectQueue_SiftUp(EffectQueue_t *const queue, uint32_t index, const EffectQueue_Entry_t *const entry);
+static void EffectQueue_SiftDown(EffectQueue_t *const queue, const EffectQueue_Entry_t *const entry);
+static uint32_t EffectQueue_FirstChild(const EffectQueue_t *const queue, const uint32_t index);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize an empty queue.
+ *
+ * @param[out] queue Queue to initialize
+ ******************************************************************************/
+void EffectQueue_Init(EffectQueue_t *const queue)
+{
+    if (queue != NULL)
+    {
+        queue->Count = 0U;
+        queue->NextSequence = 0U;
+        queue->Stats.Posted = 0U;
+        queue->Stats.Dropped = 0U;
+        queue->Stats.Taken = 0U;
+    }
+}
+
+/**
+ * @brief Post an effect to be played.  If the queue is full, the effect
+ * replaces the lowest priority, most recently posted effect queued if it
+ * outranks it, and is dropped otherwise.
+ *
+ * @param[in,out] queue  Queue to post the effect to
+ * @param[in]     effect Effect to post, copied into the queue
+ *
+ * @return Whether the effect was queued or not
+ *
+ * @retval true The effect was queued
+ * @retval false The effect was dropped or was not valid
+ ******************************************************************************/
+bool EffectQueue_Post(EffectQueue_t *const queue, const EffectQueue_Effect_t *const effect)
+{
+    bool posted = false;
+    EffectQueue_Entry_t entry;
+    uint32_t index;
+
+    if (queue != NULL && effect != NULL && effect->Priority > EFFECTQUEUE_PRIORITY_NONE)
+    {
+        entry.Effect = *effect;
+        entry.Sequence = queue->NextSequence++;
+        queue->Stats.Posted++;
+
+        if (queue->Count < EFFECTQUEUE_CAPACITY)
+        {
+            index = queue->Count++;
+            posted = true;
+        }
+        else
+        {
+            /* The last effect to be taken is always a leaf, in the second half of the heap */
+            index = EFFECTQUEUE_CAPACITY / 2U;
+            for (uint32_t leafIndex = index + 1U; leafIndex < EFFECTQUEUE_CAPACITY; leafIndex++)
+            {
+                if (EffectQueue_IsBefore(&queue->Entries[index], &queue->Entries[leafIndex]))
+                {
+                    index = leafIndex;
+                }
+            }
+
+            posted = EffectQueue_IsBefore(&entry, &queue->Entries[index]);
+            queue->Stats.Dropped++;
+        }
+
+        if (posted)
+        {
+            EffectQueue_SiftUp(queue, index, &entry);
+        }
+    }
+
+    return posted;
+}
+
+/**
+ * @brief Take the next effect to play if it outranks a priority, typically
+ * the priority of the effect being played.
+ *
+ * @param[in,out] queue         Queue to take the effect from
+ * @param[in]     abovePriority Priority the effect must be above to be taken,
+ * EFFECTQUEUE_PRIORITY_NONE to take any effect
+ * @param[out]    effect        Effect taken, only written if one was taken
+ *
+ * @return Whether an effect was taken or not
+ *
+ * @retval true An effect was taken
+ * @retval false The queue is empty or the next effect does not outrank the
+ * priority
+ ******************************************************************************/
+bool EffectQueue_Take(EffectQueue_t *const queue, const uint8_t abovePriority, EffectQueue_Effect_t *const effect)
+{
+    bool taken = false;
+
+    if (queue != NULL && effect != NULL && queue->Count > 0U && queue->Entries[0U].Effect.Priority > abovePriority)
+    {
+        *effect = queue->Entries[0U].Effect;
+        queue->Count--;
+        queue->Stats.Taken++;
+
+        if (queue->Count > 0U)
+        {
+            EffectQueue_SiftDown(queue, &queue->Entries[queue->Count]);
+        }
+
+        taken = true;
+    }
+
+    return taken;
+}
+
+/**
+ * @brief Check if an entry is to be taken before another, by priority and
+ * then by the order in which they were posted.
+ *
+ * @param[in] a Entry to check
+ * @param[in] b Entry to check against
+ *
+ * @return Whether a is taken before b or not
+ ******************************************************************************/
+static bool EffectQueue_IsBefore(const EffectQueue_Entry_t *const a, const EffectQueue_Entry_t *const b)
+{
+    bool before = a->Effect.Priority > b->Effect.Priority;
+
+    if (a->Effect.Priority == b->Effect.Priority)
+    {
+        /* Sequences wrap, so compare their difference */
+        before = (int32_t)(a->Sequence - b->Sequence) < 0;
+    }
+
+    return before;
+}
+
+/**
+ * @brief Place an entry at an index with no children, moving it towards the
+ * root past every entry it is taken before.
+ *
+ * @param[in,out] queue Queue to place the entry in
+ * @param[in]     index Index of the free slot
+ * @param[in]     entry Entry to place
+ ******************************************************************************/
+static void EffectQueue_SiftUp(EffectQueue_t *const queue, uint32_t index, const EffectQueue_Entry_t *const entry)
+{
+    uint32_t parentIndex = (index - 1U) / 2U;
+
+    while (index > 0U && EffectQueue_IsBefore(entry, &queue->Entries[parentIndex]))
+    {
+        queue->Entries[index] = queue->Entries[parentIndex];
+        index = parentIndex;
+        parentIndex = (index - 1U) / 2U;
+    }
+
+    queue->Entries[index] = *entry;
+}
+
+/**
+ * @brief Place an entry at the root after the root was taken, moving it away
+ * from the root past every entry taken before it.
+ *
+ * @param[in,out] queue Queue to place the entry in, with Count already
+ * excluding the slot the entry came from
+ * @param[in]     entry Entry to place, the last entry of the heap
+ ******************************************************************************/
+static void EffectQueue_SiftDown(EffectQueue_t *const queue, const EffectQueue_Entry_t *const entry)
+{
+    EffectQueue_Entry_t last = *entry;
+    uint32_t index = 0U;
+    uint32_t childIndex = EffectQueue_FirstChild(queue, index);
+
+    while (childIndex < queue->Count && EffectQueue_IsBefore(&queue->Entries[childIndex], &last))
+    {
+        queue->Entries[index] = queue->Entries[childIndex];
+        index = childIndex;
+        childIndex = EffectQueue_FirstChild(queue, index);
+    }
+
+    queue->Entries[index] = last;
+}
+
+/**
+ * @brief Get the child of an entry that is taken first.
+ *
+ * @param[in] queue Queue holding the entry
+ * @param[in] index Index of the entry
+ *
+ * @return Index of the child taken first, at least the number of entries
+ * queued if the entry has no children
+ ******************************************************************************/
+static uint32_t EffectQueue_FirstChild(const EffectQueue_t *const queue, const uint32_t index)
+{
+    uint32_t childIndex = (2U * index) + 1U;
+
+    if ((childIndex + 1U) < queue->Count && EffectQueue_IsBefore(&queue->Entries[childIndex + 1U], &queue->Entries[childIndex]))
+    {
+        childIndex++;
+    }
+
+    return childIndex;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file EffectQueue.h
+ *
+ * @brief Fixed-size priority queue of feedback effects, such as tones,
+ * vibration and lights.  Game callbacks post small effect descriptors that a
+ * player takes and plays out, so feedback never blocks the game.  Posting and
+ * taking are O(log n) in the capacity of the queue and never allocate, which
+ * bounds the cost of a feedback callback.
+ *
+ * The highest priority effect is taken first, and effects of equal priority
+ * are taken in the order they were posted.  A player can take an effect only
+ * if it outranks the one it is playing, which lets an urgent effect cut short
+ * a less urgent one.  When the queue is full, a new effect replaces the lowest
+ * priority effect queued if it outranks it and is dropped otherwise.
+ *
+ * The queue is not thread safe.  Clients posting and taking from different
+ * tasks must hold a lock around each call.
+ *
+ ******************************************************************************/
+
+#ifndef EFFECT_QUEUE_H
+#define EFFECT_QUEUE_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define EFFECTQUEUE_CAPACITY 8U      /* Number of effects that can be queued */
+#define EFFECTQUEUE_PRIORITY_NONE 0U /* Priority below every effect, for taking an effect when nothing is playing */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Effect to play */
+typedef struct
+{
+    uint8_t Id;          /* Kind of effect, chosen by the client */
+    uint8_t Priority;    /* Priority of the effect, higher is more urgent, must be above EFFECTQUEUE_PRIORITY_NONE */
+    uint16_t DurationMs; /* Time the effect plays for */
+    uint32_t Param;      /* Parameter of the effect, chosen by the client */
+    uint32_t PostTime;   /* Time the effect was posted, in units chosen by the client, for measuring latency */
+} EffectQueue_Effect_t;
+
+/* Queued effect */
+typedef struct
+{
+    EffectQueue_Effect_t Effect; /* Effect to play */
+    uint32_t Sequence;           /* Order in which the effect was posted */
+} EffectQueue_Entry_t;
+
+/* Effects posted to a queue */
+typedef struct
+{
+    uint32_t Posted;  /* Number of effects posted */
+    uint32_t Dropped; /* Number of effects dropped or replaced because the queue was full */
+    uint32_t Taken;   /* Number of effects taken to be played */
+} EffectQueue_Stats_t;
+
+/* Priority queue of effects */
+typedef struct
+{
+    EffectQueue_Entry_t Entries[EFFECTQUEUE_CAPACITY]; /* Binary heap of queued effects, the next effect to play first */
+    uint32_t Count;                                    /* Number of effects queued */
+    uint32_t NextSequence;                             /* Sequence of the next effect posted */
+    EffectQueue_Stats_t Stats;                         /* Effects posted to the queue */
+} EffectQueue_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void EffectQueue_Init(EffectQueue_t *const queue);
+bool EffectQueue_Post(EffectQueue_t *const queue, const EffectQueue_Effect_t *const effect);
+bool EffectQueue_Take(EffectQueue_t *const queue, const uint8_t abovePriority, EffectQueue_Effect_t *const effect);
+
+#endif
@@ -0,0 +1,269 @@
+/**
+ * @file EventBus.h
+ *
+ * @brief Statically sized bus of typed input events with multiple
+ * subscribers.  Each subscriber subscribes to one type of event and owns a
+ * lock-free single-producer single-consumer ring the bus copies every event of
+ * that type into, so any number of modules can observe the same events without
+ * the publisher knowing about them.  Publishing never blocks: an event that
+ * does not fit in a subscriber's ring is dropped for that subscriber alone and
+ * counted, so a slow subscriber never delays the publisher or the others.
+ *
+ * Each type of event must be published from a single context, e.g. button
+ * events only from the GPIO ISR, as that context is the single producer of the
+ * rings of its subscribers.  Each subscriber must be received from by a single
+ * task.  Subscribers are added from a single task, and may be added while
+ * events are published.
+ *
+ * Functions are inline so they can be called from ISRs placed in IRAM.
+ *
+ ******************************************************************************/
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define EVENTBUS_MAX_SUBSCRIBERS 16U                 /* Number of subscribers each type of event can have */
+#define EVENTBUS_RING_SIZE 32U                       /* Number of events a subscriber can hold before events are dropped, a power of two */
+#define EVENTBUS_RING_MASK (EVENTBUS_RING_SIZE - 1U) /* Mask of the index of an event in a ring */
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef int64_t EventBus_TimeUs_t; /* Time in microseconds since boot */
+
+/* Type of an event */
+typedef enum
+{
+    EVENTBUS_TYPE_BUTTON,  /* Debounced button press, published from the GPIO ISR */
+    EVENTBUS_TYPE_HIT,     /* Shot received from another blaster, published from the IR receive task */
+    EVENTBUS_TYPE_GESTURE, /* Gesture recognized, published from the IMU task */
+    EVENTBUS_TYPE_TRIGGER, /* Debounced trigger pull, published from the GPIO ISR */
+    EVENTBUS_TYPE_COUNT,   /* Number of types of events */
+} EventBus_Type_t;
+
+/* Payload of EVENTBUS_TYPE_BUTTON and EVENTBUS_TYPE_TRIGGER */
+typedef struct
+{
+    uint32_t GpioNum; /* GPIO number of the button or trigger pressed */
+} EventBus_Button_t;
+
+/* Payload of EVENTBUS_TYPE_HIT */
+typedef struct
+{
+    uint32_t GpioNum; /* GPIO number of the IR receiver that received the shot */
+} EventBus_Hit_t;
+
+/* Payload of EVENTBUS_TYPE_GESTURE */
+typedef struct
+{
+    uint32_t Gesture; /* Gesture recognized, a Gesture_Gesture_t */
+} EventBus_Gesture_t;
+
+/* Event published on the bus */
+typedef struct
+{
+    EventBus_Type_t Type;     /* Type of the event */
+    EventBus_TimeUs_t TimeUs; /* Time at which the event occurred */
+    union
+    {
+        EventBus_Button_t Button;   /* Payload of EVENTBUS_TYPE_BUTTON and EVENTBUS_TYPE_TRIGGER */
+        EventBus_Hit_t Hit;         /* Payload of EVENTBUS_TYPE_HIT */
+        EventBus_Gesture_t Gesture; /* Payload of EVENTBUS_TYPE_GESTURE */
+    };
+} EventBus_Event_t;
+
+typedef void (*EventBus_Notify_t)(void *const context); /* Called from the publisher's context after an event is added to a subscriber's ring, must not block and must be placed in IRAM for events published from an ISR */
+
+/* Subscriber to one type of event, owned by the client */
+typedef struct
+{
+    _Atomic uint32_t Head;                       /* Number of events added to the ring, only written by the publisher */
+    _Atomic uint32_t Tail;                       /* Number of events received from the ring, only written by the subscriber */
+    _Atomic uint32_t Drops;                      /* Number of events dropped because the ring was full, only written by the publisher */
+    EventBus_Notify_t Notify;                    /* Optional function waking the subscriber */
+    void *Context;                               /* Context passed to Notify */
+    EventBus_Event_t Events[EVENTBUS_RING_SIZE]; /* Ring of events not yet received */
+} EventBus_Subscriber_t;
+
+/* Bus of events */
+typedef struct
+{
+    EventBus_Subscriber_t *Subscribers[EVENTBUS_TYPE_COUNT][EVENTBUS_MAX_SUBSCRIBERS]; /* Subscribers to each type of event */
+    _Atomic uint32_t SubscriberCounts[EVENTBUS_TYPE_COUNT];                            /* Number of subscribers to each type of event */
+} EventBus_t;
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize a bus with no subscribers.
+ *
+ * @param[out] bus Bus to initialize
+ ******************************************************************************/
+static inline void EventBus_Init(EventBus_t *const bus)
+{
+    for (uint32_t type = 0U; type < EVENTBUS_TYPE_COUNT; type++)
+    {
+        atomic_init(&bus->SubscriberCounts[type], 0U);
+    }
+}
+
+/**
+ * @brief Subscribe to a type of event.  The subscriber receives every event of
+ * the type published from then on.
+ *
+ * @param[in,out] bus        Bus to subscribe to
+ * @param[in]     type       Type of event to subscribe to
+ * @param[out]    subscriber Subscriber to initialize, must stay valid as long
+ * as the bus is used
+ * @param[in]     notify     Optional function waking the subscriber, called
+ * from the publisher's context after each event is added to its ring
+ * @param[in]     context    Context passed to notify
+ *
+ * @return Whether the subscriber was added or not, false if the type already
+ * has EVENTBUS_MAX_SUBSCRIBERS subscribers
+ ******************************************************************************/
+static inline bool EventBus_Subscribe(EventBus_t *const bus, const EventBus_Type_t type, EventBus_Subscriber_t *const subscriber, EventBus_Notify_t notify, void *const context)
+{
+    bool subscribed = false;
+    uint32_t count;
+
+    if (bus != NULL && subscriber != NULL && type < EVENTBUS_TYPE_COUNT)
+    {
+        count = atomic_load_explicit(&bus->SubscriberCounts[type], memory_order_relaxed);
+        if (count < EVENTBUS_MAX_SUBSCRIBERS)
+        {
+            atomic_init(&subscriber->Head, 0U);
+            atomic_init(&subscriber->Tail, 0U);
+            atomic_init(&subscriber->Drops, 0U);
+            subscriber->Notify = notify;
+            subscriber->Context = context;
+            bus->Subscribers[type][count] = subscriber;
+
+            /* Publish the subscriber after it is initialized so the publisher never sees it half initialized */
+            atomic_store_explicit(&bus->SubscriberCounts[type], count + 1U, memory_order_release);
+            subscribed = true;
+        }
+    }
+
+    return subscribed;
+}
+
+/**
+ * @brief Publish an event to every subscriber to its type.  Never blocks, the
+ * event is dropped for subscribers whose ring is full.  Safe to call from an
+ * ISR, but only one context may publish a given type.
+ *
+ * @param[in,out] bus   Bus to publish the event on
+ * @param[in]     event Event to publish
+ *
+ * @return Number of subscribers the event was added to
+ ******************************************************************************/
+static inline uint32_t EventBus_Publish(EventBus_t *const bus, const EventBus_Event_t *const event)
+{
+    EventBus_Subscriber_t *subscriber;
+    uint32_t count;
+    uint32_t head;
+    uint32_t delivered = 0U;
+
+    if (event->Type < EVENTBUS_TYPE_COUNT)
+    {
+        count = atomic_load_explicit(&bus->SubscriberCounts[event->Type], memory_order_acquire);
+        for (uint32_t index = 0U; index < count; index++)
+        {
+            subscriber = bus->Subscribers[event->Type][index];
+            head = atomic_load_explicit(&subscriber->Head, memory_order_relaxed);
+
+            /* Counters wrap around, so the difference is the number of events in the ring */
+            if (head - atomic_load_explicit(&subscriber->Tail, memory_order_acquire) < EVENTBUS_RING_SIZE)
+            {
+                subscriber->Events[head & EVENTBUS_RING_MASK] = *event;
+                atomic_store_explicit(&subscriber->Head, head + 1U, memory_order_release);
+                delivered++;
+
+                if (subscriber->Notify != NULL)
+                {
+                    (*subscriber->Notify)(subscriber->Context);
+                }
+            }
+            else
+            {
+                atomic_store_explicit(&subscriber->Drops, atomic_load_explicit(&subscriber->Drops, memory_order_relaxed) + 1U, memory_order_relaxed);
+            }
+        }
+    }
+
+    return delivered;
+}
+
+/**
+ * @brief Get the oldest event of a subscriber's ring without receiving it, so
+ * a subscriber to several types can receive their events in order of time.
+ *
+ * @param[in]  subscriber Subscriber to get the event of
+ * @param[out] event      Oldest event, only written if there was one
+ *
+ * @return Whether the ring had an event or not
+ ******************************************************************************/
+static inline bool EventBus_Peek(const EventBus_Subscriber_t *const subscriber, EventBus_Event_t *const event)
+{
+    uint32_t tail = atomic_load_explicit(&subscriber->Tail, memory_order_relaxed);
+    bool peeked = tail != atomic_load_explicit(&subscriber->Head, memory_order_acquire);
+
+    if (peeked)
+    {
+        /* The slot is not released, so the publisher cannot overwrite it until the event is received */
+        *event = subscriber->Events[tail & EVENTBUS_RING_MASK];
+    }
+
+    return peeked;
+}
+
+/**
+ * @brief Receive the oldest event from a subscriber's ring.
+ *
+ * @param[in,out] subscriber Subscriber to receive the event of
+ * @param[out]    event      Event received, only written if there was one
+ *
+ * @return Whether an event was received or not
+ ******************************************************************************/
+static inline bool EventBus_Receive(EventBus_Subscriber_t *const subscriber, EventBus_Event_t *const event)
+{
+    uint32_t tail = atomic_load_explicit(&subscriber->Tail, memory_order_relaxed);
+    bool received = tail != atomic_load_explicit(&subscriber->Head, memory_order_acquire);
+
+    if (received)
+    {
+        *event = subscriber->Events[tail & EVENTBUS_RING_MASK];
+
+        /* Release the slot only after the event is copied out so the publisher never overwrites it while it is read */
+        atomic_store_explicit(&subscriber->Tail, tail + 1U, memory_order_release);
+    }
+
+    return received;
+}
+
+/**
+ * @brief Get the number of events dropped for a subscriber because its ring
+ * was full.  Safe to call from any task.
+ *
+ * @param[in] subscriber Subscriber to get the drops of
+ *
+ * @return Number of events dropped
+ ******************************************************************************/
+static inline uint32_t EventBus_GetDrops(EventBus_Subscriber_t *const subscriber)
+{
+    return atomic_load_explicit(&subscriber->Drops, memory_order_relaxed);
+}
+
+#endif
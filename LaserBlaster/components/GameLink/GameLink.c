@@ -0,0 +1,632 @@
+/**
+ * @file GameLink.c
+ *
+ * @brief Compact binary protocol for sharing game state between blasters.
+ *
+ * The offset of a peer's clock is estimated like NTP.  The local blaster sends
+ * a request at T1, the peer receives it at T2 and sends its response at T3,
+ * which is received at T4, T1 and T4 on the local clock and T2 and T3 on the
+ * peer's.  The offset is ((T2 - T1) + (T3 - T4)) / 2 and the round trip delay
+ * (T4 - T1) - (T3 - T2).  T1 and T3 are the send times of the frames carrying
+ * the request and the response, so both are stamped when the frame is sent
+ * and time spent batching does not skew the estimate.  The offset is off by
+ * at most half the delay, so the exchange with the shortest recent delay is
+ * kept, as the NTP clock filter does.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "GameLink.h"
+#include <stddef.h>
+#include <string.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define GAMELINK_MAGIC 0xB1U                    /* First byte of every frame */
+#define GAMELINK_VERSION 1U                     /* Version of the frame layout */
+#define GAMELINK_HEADER_SIZE 10U                /* Size of the frame header in bytes */
+#define GAMELINK_MAGIC_OFFSET 0U                /* Offset of the magic number in the header */
+#define GAMELINK_VERSION_OFFSET 1U              /* Offset of the version in the header */
+#define GAMELINK_SENDER_OFFSET 2U               /* Offset of the ID of the sender in the header */
+#define GAMELINK_COUNT_OFFSET 3U                /* Offset of the number of messages in the header */
+#define GAMELINK_SEQUENCE_OFFSET 4U             /* Offset of the sequence in the header */
+#define GAMELINK_SEND_TIME_OFFSET 6U            /* Offset of the send time in the header */
+#define GAMELINK_MAX_MESSAGES 0xFFU             /* Most messages in a frame */
+#define GAMELINK_TYPE_SIZE 1U                   /* Size of the type of a message in bytes */
+#define GAMELINK_SYNC_REQUEST_SIZE 1U           /* Size of the payload of a sync request */
+#define GAMELINK_SYNC_RESPONSE_SIZE 9U          /* Size of the payload of a sync response */
+#define GAMELINK_STATE_SIZE 3U                  /* Size of the payload of a state message */
+#define GAMELINK_COMMAND_SIZE 7U                /* Size of the payload of a command message */
+#define GAMELINK_RESULT_SIZE 4U                 /* Size of the payload of a result message */
+#define GAMELINK_MAX_PAYLOAD_SIZE 9U            /* Size of the largest payload */
+#define GAMELINK_MAX_SYNC_ROUND_TRIP_US 500000U /* Longest round trip of an exchange of timestamps that is used */
+#define GAMELINK_SEQUENCE_WINDOW 0x8000U        /* Gaps in sequence at least this large are taken as the peer restarting */
+#define GAMELINK_BITS_PER_BYTE 8U               /* Number of bits in a byte */
+#define GAMELINK_BYTE_MASK 0xFFU                /* Mask of a byte */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Types of messages in a frame */
+typedef enum
+{
+    GAMELINK_WIRE_SYNC_REQUEST,  /* Request for the time of the target */
+    GAMELINK_WIRE_SYNC_RESPONSE, /* Response to a request for the time of the sender */
+    GAMELINK_WIRE_STATE,         /* GAMELINK_MESSAGE_STATE */
+    GAMELINK_WIRE_COMMAND,       /* GAMELINK_MESSAGE_COMMAND */
+    GAMELINK_WIRE_RESULT,        /* GAMELINK_MESSAGE_RESULT */
+    GAMELINK_WIRE_COUNT,         /* Number of types of messages */
+} GameLink_WireType_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void GameLink_Append(GameLink_t *const link, const GameLink_WireType_t type, const uint8_t *const payload, const GameLink_TimeUs_t now);
+static GameLink_Peer_t *GameLink_FindPeer(GameLink_t *const link, const uint8_t id);
+static void GameLink_ReceiveSequence(GameLink_Peer_t *const peer, const uint16_t sequence);
+static bool GameLink_ReceiveMessage(GameLink_t *const link, GameLink_Peer_t *const peer, const uint8_t *const message, const GameLink_TimeUs_t sendTime, const GameLink_TimeUs_t now);
+static void GameLink_AddSyncSample(GameLink_Peer_t *const peer, const GameLink_TimeUs_t t1, const GameLink_TimeUs_t t2, const GameLink_TimeUs_t t3, const GameLink_TimeUs_t t4);
+static uint32_t GameLink_ReadU16(const uint8_t *const bytes);
+static uint32_t GameLink_ReadU32(const uint8_t *const bytes);
+static void GameLink_WriteU16(uint8_t *const bytes, const uint32_t value);
+static void GameLink_WriteU32(uint8_t *const bytes, const uint32_t value);
+
+/* Globals
+ ******************************************************************************/
+
+/* Size of the payload of each type of message */
+static const uint8_t GameLink_PayloadSizes[GAMELINK_WIRE_COUNT] = {
+    [GAMELINK_WIRE_SYNC_REQUEST] = GAMELINK_SYNC_REQUEST_SIZE,
+    [GAMELINK_WIRE_SYNC_RESPONSE] = GAMELINK_SYNC_RESPONSE_SIZE,
+    [GAMELINK_WIRE_STATE] = GAMELINK_STATE_SIZE,
+    [GAMELINK_WIRE_COMMAND] = GAMELINK_COMMAND_SIZE,
+    [GAMELINK_WIRE_RESULT] = GAMELINK_RESULT_SIZE,
+};
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize a link.  Peers are asked for their time once the first
+ * sync period has passed.
+ *
+ * @param[out] link   Link to initialize
+ * @param[in]  config Configuration of the link, copied into it
+ * @param[in]  now    Current time
+ *
+ * @return Whether the link was initialized or not
+ *
+ * @retval true The link was initialized
+ * @retval false The configuration has no transport
+ ******************************************************************************/
+bool GameLink_Init(GameLink_t *const link, const GameLink_Config_t *const config, const GameLink_TimeUs_t now)
+{
+    bool initialized = false;
+
+    if (link != NULL && config != NULL && config->Transport.Send != NULL)
+    {
+        memset(link, 0, sizeof(*link));
+        link->Config = *config;
+        link->LastSync = now;
+        initialized = true;
+    }
+
+    return initialized;
+}
+
+/**
+ * @brief Send a message to every peer.  The message is batched with others
+ * and sent by GameLink_Poll or GameLink_Flush, or straight away if the frame
+ * is full.
+ *
+ * @param[in,out] link    Link to send the message through
+ * @param[in]     message Message to send, its sender is ignored
+ * @param[in]     now     Current time
+ *
+ * @return Whether the message was batched or not
+ *
+ * @retval true The message was batched
+ * @retval false The message has an unknown type
+ ******************************************************************************/
+bool GameLink_Send(GameLink_t *const link, const GameLink_Message_t *const message, const GameLink_TimeUs_t now)
+{
+    uint8_t payload[GAMELINK_MAX_PAYLOAD_SIZE];
+    GameLink_WireType_t type = GAMELINK_WIRE_COUNT;
+    bool sent = false;
+
+    if (link != NULL && message != NULL)
+    {
+        switch (message->Type)
+        {
+        case GAMELINK_MESSAGE_STATE:
+            type = GAMELINK_WIRE_STATE;
+            payload[0U] = message->State.GameState;
+            payload[1U] = message->State.Score;
+            payload[2U] = message->State.Lives;
+            break;
+        case GAMELINK_MESSAGE_COMMAND:
+            type = GAMELINK_WIRE_COMMAND;
+            payload[0U] = message->Command.CommandIndex;
+            GameLink_WriteU16(&payload[1U], message->Command.WaitTimeMs);
+            GameLink_WriteU32(&payload[3U], message->Command.IssueTime);
+            break;
+        case GAMELINK_MESSAGE_RESULT:
+            type = GAMELINK_WIRE_RESULT;
+            payload[0U] = message->Result.CommandIndex;
+            payload[1U] = message->Result.Success ? 1U : 0U;
+            payload[2U] = message->Result.Score;
+            payload[3U] = message->Result.Lives;
+            break;
+        default:
+            break;
+        }
+
+        if (type != GAMELINK_WIRE_COUNT)
+        {
+            GameLink_Append(link, type, payload, now);
+            sent = true;
+        }
+    }
+
+    return sent;
+}
+
+/**
+ * @brief Receive a frame from the transport.  Answers requests for the local
+ * time, updates the offset of the sender's clock from responses and passes
+ * every other message to the client's OnMessage.  Frames sent by the link
+ * itself are ignored, so transports may loop broadcasts back.
+ *
+ * @param[in,out] link  Link the frame was received on
+ * @param[in]     frame Frame received
+ * @param[in]     size  Size of the frame in bytes
+ * @param[in]     now   Time the frame was received
+ ******************************************************************************/
+void GameLink_Receive(GameLink_t *const link, const uint8_t *const frame, const uint32_t size, const GameLink_TimeUs_t now)
+{
+    GameLink_Peer_t *peer;
+    GameLink_TimeUs_t sendTime;
+    uint32_t messageCount;
+    uint32_t offset = GAMELINK_HEADER_SIZE;
+    bool valid = true;
+
+    if (link == NULL || frame == NULL || size < GAMELINK_HEADER_SIZE || frame[GAMELINK_MAGIC_OFFSET] != GAMELINK_MAGIC || frame[GAMELINK_VERSION_OFFSET] != GAMELINK_VERSION)
+    {
+        if (link != NULL)
+        {
+            link->Stats.FramesInvalid++;
+        }
+    }
+    else if (frame[GAMELINK_SENDER_OFFSET] != link->Config.Id)
+    {
+        peer = GameLink_FindPeer(link, frame[GAMELINK_SENDER_OFFSET]);
+        if (peer == NULL)
+        {
+            link->Stats.PeersDropped++;
+        }
+        else
+        {
+            link->Stats.FramesReceived++;
+            GameLink_ReceiveSequence(peer, (uint16_t)GameLink_ReadU16(&frame[GAMELINK_SEQUENCE_OFFSET]));
+            sendTime = GameLink_ReadU32(&frame[GAMELINK_SEND_TIME_OFFSET]);
+            messageCount = frame[GAMELINK_COUNT_OFFSET];
+
+            for (uint32_t messageIndex = 0U; messageIndex < messageCount && valid; messageIndex++)
+            {
+                valid = offset < size && frame[offset] < GAMELINK_WIRE_COUNT && (offset + GAMELINK_TYPE_SIZE + GameLink_PayloadSizes[frame[offset]]) <= size;
+                if (valid)
+                {
+                    valid = GameLink_ReceiveMessage(link, peer, &frame[offset], sendTime, now);
+                    offset += GAMELINK_TYPE_SIZE + GameLink_PayloadSizes[frame[offset]];
+                }
+            }
+
+            if (!valid)
+            {
+                link->Stats.FramesInvalid++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Send the frame being batched once its oldest message has waited for
+ * the batch window, and ask the next peer for its time once the sync period
+ * has passed.  Must be called at least every GameLink_GetPollDelay.
+ *
+ * @param[in,out] link Link to poll
+ * @param[in]     now  Current time
+ ******************************************************************************/
+void GameLink_Poll(GameLink_t *const link, const GameLink_TimeUs_t now)
+{
+    uint8_t target = 0U;
+    bool found = false;
+
+    if (link != NULL)
+    {
+        if ((now - link->LastSync) >= link->Config.SyncPeriodUs)
+        {
+            link->LastSync = now;
+            for (uint32_t count = 0U; count < GAMELINK_MAX_PEERS && !found; count++)
+            {
+                found = link->Peers[link->NextSyncPeer].Active;
+                target = link->Peers[link->NextSyncPeer].Id;
+                link->NextSyncPeer = (link->NextSyncPeer + 1U) % GAMELINK_MAX_PEERS;
+            }
+
+            if (found)
+            {
+                GameLink_Append(link, GAMELINK_WIRE_SYNC_REQUEST, &target, now);
+            }
+        }
+
+        if (link->FrameMessages > 0U && (now - link->FrameStart) >= link->Config.BatchWindowUs)
+        {
+            GameLink_Flush(link, now);
+        }
+    }
+}
+
+/**
+ * @brief Send the frame being batched straight away, stamped with the current
+ * time.
+ *
+ * @param[in,out] link Link to flush
+ * @param[in]     now  Current time
+ ******************************************************************************/
+void GameLink_Flush(GameLink_t *const link, const GameLink_TimeUs_t now)
+{
+    if (link != NULL && link->FrameMessages > 0U)
+    {
+        link->Frame[GAMELINK_MAGIC_OFFSET] = GAMELINK_MAGIC;
+        link->Frame[GAMELINK_VERSION_OFFSET] = GAMELINK_VERSION;
+        link->Frame[GAMELINK_SENDER_OFFSET] = link->Config.Id;
+        link->Frame[GAMELINK_COUNT_OFFSET] = (uint8_t)link->FrameMessages;
+        GameLink_WriteU16(&link->Frame[GAMELINK_SEQUENCE_OFFSET], link->Sequence);
+        GameLink_WriteU32(&link->Frame[GAMELINK_SEND_TIME_OFFSET], now);
+
+        if (link->Config.Transport.Send(link->Config.Transport.Context, link->Frame, link->FrameSize))
+        {
+            link->Stats.FramesSent++;
+            link->Stats.MessagesSent += link->FrameMessages;
+        }
+        else
+        {
+            link->Stats.SendFailures++;
+        }
+
+        link->Sequence++;
+        link->FrameSize = 0U;
+        link->FrameMessages = 0U;
+    }
+}
+
+/**
+ * @brief Get a peer heard from.
+ *
+ * @param[in] link Link the peer was heard on
+ * @param[in] id   ID of the peer
+ *
+ * @return Peer, NULL if it was not heard from
+ ******************************************************************************/
+const GameLink_Peer_t *GameLink_GetPeer(const GameLink_t *const link, const uint8_t id)
+{
+    const GameLink_Peer_t *peer = NULL;
+
+    if (link != NULL)
+    {
+        for (uint32_t peerIndex = 0U; peerIndex < GAMELINK_MAX_PEERS && peer == NULL; peerIndex++)
+        {
+            if (link->Peers[peerIndex].Active && link->Peers[peerIndex].Id == id)
+            {
+                peer = &link->Peers[peerIndex];
+            }
+        }
+    }
+
+    return peer;
+}
+
+/**
+ * @brief Convert a time on a peer's clock to the local clock.
+ *
+ * @param[in]  link      Link the peer was heard on
+ * @param[in]  id        ID of the peer
+ * @param[in]  peerTime  Time on the peer's clock
+ * @param[out] localTime Time on the local clock, only written if converted
+ *
+ * @return Whether the time was converted or not
+ *
+ * @retval true The time was converted
+ * @retval false No exchange of timestamps with the peer completed yet
+ ******************************************************************************/
+bool GameLink_ToLocalTime(const GameLink_t *const link, const uint8_t id, const GameLink_TimeUs_t peerTime, GameLink_TimeUs_t *const localTime)
+{
+    const GameLink_Peer_t *peer = GameLink_GetPeer(link, id);
+    bool converted = false;
+
+    if (peer != NULL && localTime != NULL && peer->SampleCount > 0U)
+    {
+        *localTime = peerTime - (GameLink_TimeUs_t)peer->OffsetUs;
+        converted = true;
+    }
+
+    return converted;
+}
+
+/**
+ * @brief Get the time until the link next needs to be polled, for the batch
+ * window of the frame being batched or the sync period to end.
+ *
+ * @param[in] link Link to poll
+ * @param[in] now  Current time
+ *
+ * @return Time until GameLink_Poll must be called, 0 if it is due
+ ******************************************************************************/
+GameLink_TimeUs_t GameLink_GetPollDelay(const GameLink_t *const link, const GameLink_TimeUs_t now)
+{
+    GameLink_TimeUs_t delay = 0U;
+    GameLink_TimeUs_t elapsed;
+
+    if (link != NULL)
+    {
+        elapsed = now - link->LastSync;
+        delay = (elapsed < link->Config.SyncPeriodUs) ? (link->Config.SyncPeriodUs - elapsed) : 0U;
+
+        if (link->FrameMessages > 0U)
+        {
+            elapsed = now - link->FrameStart;
+            if (elapsed >= link->Config.BatchWindowUs)
+            {
+                delay = 0U;
+            }
+            else if ((link->Config.BatchWindowUs - elapsed) < delay)
+            {
+                delay = link->Config.BatchWindowUs - elapsed;
+            }
+        }
+    }
+
+    return delay;
+}
+
+/**
+ * @brief Append a message to the frame being batched, sending the frame first
+ * if the message does not fit.
+ *
+ * @param[in,out] link    Link to batch the message on
+ * @param[in]     type    Type of the message
+ * @param[in]     payload Payload of the message, of the size of its type
+ * @param[in]     now     Current time
+ ******************************************************************************/
+static void GameLink_Append(GameLink_t *const link, const GameLink_WireType_t type, const uint8_t *const payload, const GameLink_TimeUs_t now)
+{
+    uint32_t messageSize = GAMELINK_TYPE_SIZE + GameLink_PayloadSizes[type];
+
+    if ((link->FrameSize + messageSize) > GAMELINK_MAX_FRAME_SIZE || link->FrameMessages == GAMELINK_MAX_MESSAGES)
+    {
+        GameLink_Flush(link, now);
+    }
+
+    if (link->FrameMessages == 0U)
+    {
+        link->FrameSize = GAMELINK_HEADER_SIZE;
+        link->FrameStart = now;
+    }
+
+    link->Frame[link->FrameSize] = (uint8_t)type;
+    memcpy(&link->Frame[link->FrameSize + GAMELINK_TYPE_SIZE], payload, GameLink_PayloadSizes[type]);
+    link->FrameSize += messageSize;
+    link->FrameMessages++;
+}
+
+/**
+ * @brief Find a peer, adding it if it was not heard from before.
+ *
+ * @param[in,out] link Link the peer was heard on
+ * @param[in]     id   ID of the peer
+ *
+ * @return Peer, NULL if it is new and the table of peers is full
+ ******************************************************************************/
+static GameLink_Peer_t *GameLink_FindPeer(GameLink_t *const link, const uint8_t id)
+{
+    GameLink_Peer_t *peer = (GameLink_Peer_t *)GameLink_GetPeer(link, id);
+
+    for (uint32_t peerIndex = 0U; peerIndex < GAMELINK_MAX_PEERS && peer == NULL; peerIndex++)
+    {
+        if (!link->Peers[peerIndex].Active)
+        {
+            peer = &link->Peers[peerIndex];
+            memset(peer, 0, sizeof(*peer));
+            peer->Id = id;
+        }
+    }
+
+    return peer;
+}
+
+/**
+ * @brief Count the frames missed from a peer from the sequence of a frame
+ * received from it.
+ *
+ * @param[in,out] peer     Peer the frame was received from
+ * @param[in]     sequence Sequence of the frame
+ ******************************************************************************/
+static void GameLink_ReceiveSequence(GameLink_Peer_t *const peer, const uint16_t sequence)
+{
+    uint16_t gap = (uint16_t)(sequence - peer->NextSequence);
+
+    if (peer->Active && gap < GAMELINK_SEQUENCE_WINDOW)
+    {
+        peer->FramesLost += gap;
+    }
+
+    peer->Active = true;
+    peer->NextSequence = (uint16_t)(sequence + 1U);
+}
+
+/**
+ * @brief Handle a message of a frame received from a peer.
+ *
+ * @param[in,out] link     Link the frame was received on
+ * @param[in,out] peer     Peer the frame was received from
+ * @param[in]     message  Type and payload of the message, known to be valid
+ * @param[in]     sendTime Time the frame was sent on the peer's clock
+ * @param[in]     now      Time the frame was received
+ *
+ * @return Whether the message was handled or not, false if a field is out of
+ * range
+ ******************************************************************************/
+static bool GameLink_ReceiveMessage(GameLink_t *const link, GameLink_Peer_t *const peer, const uint8_t *const message, const GameLink_TimeUs_t sendTime, const GameLink_TimeUs_t now)
+{
+    const uint8_t *payload = &message[GAMELINK_TYPE_SIZE];
+    uint8_t response[GAMELINK_SYNC_RESPONSE_SIZE];
+    GameLink_Message_t received = {.Sender = peer->Id};
+    bool deliver = true;
+    bool valid = true;
+
+    link->Stats.MessagesReceived++;
+
+    switch ((GameLink_WireType_t)message[0U])
+    {
+    case GAMELINK_WIRE_SYNC_REQUEST:
+        deliver = false;
+        if (payload[0U] == link->Config.Id)
+        {
+            /* The send time of the frame carrying the response completes the exchange */
+            response[0U] = peer->Id;
+            GameLink_WriteU32(&response[1U], sendTime);
+            GameLink_WriteU32(&response[5U], now);
+            GameLink_Append(link, GAMELINK_WIRE_SYNC_RESPONSE, response, now);
+        }
+        break;
+    case GAMELINK_WIRE_SYNC_RESPONSE:
+        deliver = false;
+        if (payload[0U] == link->Config.Id)
+        {
+            GameLink_AddSyncSample(peer, GameLink_ReadU32(&payload[1U]), GameLink_ReadU32(&payload[5U]), sendTime, now);
+        }
+        break;
+    case GAMELINK_WIRE_STATE:
+        received.Type = GAMELINK_MESSAGE_STATE;
+        received.State.GameState = payload[0U];
+        received.State.Score = payload[1U];
+        received.State.Lives = payload[2U];
+        break;
+    case GAMELINK_WIRE_COMMAND:
+        received.Type = GAMELINK_MESSAGE_COMMAND;
+        received.Command.CommandIndex = payload[0U];
+        received.Command.WaitTimeMs = (uint16_t)GameLink_ReadU16(&payload[1U]);
+        received.Command.IssueTime = GameLink_ReadU32(&payload[3U]);
+        break;
+    case GAMELINK_WIRE_RESULT:
+        received.Type = GAMELINK_MESSAGE_RESULT;
+        received.Result.CommandIndex = payload[0U];
+        received.Result.Success = payload[1U] != 0U;
+        received.Result.Score = payload[2U];
+        received.Result.Lives = payload[3U];
+        valid = payload[1U] <= 1U;
+        break;
+    default:
+        deliver = false;
+        valid = false;
+        break;
+    }
+
+    if (deliver && valid && link->Config.OnMessage != NULL)
+    {
+        link->Config.OnMessage(link->Config.Context, &received);
+    }
+
+    return valid;
+}
+
+/**
+ * @brief Add an exchange of timestamps with a peer and take the offset of the
+ * exchange with the shortest delay among the most recent ones.  Exchanges
+ * with a negative delay or a round trip too long for the request to be recent
+ * are discarded.
+ *
+ * @param[in,out] peer Peer the timestamps were exchanged with
+ * @param[in]     t1   Time the request was sent on the local clock
+ * @param[in]     t2   Time the request was received on the peer's clock
+ * @param[in]     t3   Time the response was sent on the peer's clock
+ * @param[in]     t4   Time the response was received on the local clock
+ ******************************************************************************/
+static void GameLink_AddSyncSample(GameLink_Peer_t *const peer, const GameLink_TimeUs_t t1, const GameLink_TimeUs_t t2, const GameLink_TimeUs_t t3, const GameLink_TimeUs_t t4)
+{
+    /* Differences of times on the same clock are small, so they are taken as signed, while the offset may be any value modulo 2^32 */
+    int32_t delay = (int32_t)((t4 - t1) - (t3 - t2));
+    GameLink_SyncSample_t *sample;
+    uint32_t sampleCount;
+
+    if (delay >= 0 && (t4 - t1) <= GAMELINK_MAX_SYNC_ROUND_TRIP_US)
+    {
+        sample = &peer->Samples[peer->SampleCount % GAMELINK_SYNC_SAMPLES];
+        sample->OffsetUs = (int32_t)((t2 - t1) + (uint32_t)(-(delay / 2)));
+        sample->DelayUs = (uint32_t)delay;
+        peer->SampleCount++;
+
+        sampleCount = (peer->SampleCount < GAMELINK_SYNC_SAMPLES) ? peer->SampleCount : GAMELINK_SYNC_SAMPLES;
+        peer->OffsetUs = peer->Samples[0U].OffsetUs;
+        peer->DelayUs = peer->Samples[0U].DelayUs;
+        for (uint32_t sampleIndex = 1U; sampleIndex < sampleCount; sampleIndex++)
+        {
+            if (peer->Samples[sampleIndex].DelayUs < peer->DelayUs)
+            {
+                peer->OffsetUs = peer->Samples[sampleIndex].OffsetUs;
+                peer->DelayUs = peer->Samples[sampleIndex].DelayUs;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Read a little-endian 16 bit field.
+ *
+ * @param[in] bytes First byte of the field
+ *
+ * @return Value of the field
+ ******************************************************************************/
+static uint32_t GameLink_ReadU16(const uint8_t *const bytes)
+{
+    return (uint32_t)bytes[0U] | ((uint32_t)bytes[1U] << GAMELINK_BITS_PER_BYTE);
+}
+
+/**
+ * @brief Read a little-endian 32 bit field.
+ *
+ * @param[in] bytes First byte of the field
+ *
+ * @return Value of the field
+ ******************************************************************************/
+static uint32_t GameLink_ReadU32(const uint8_t *const bytes)
+{
+    return GameLink_ReadU16(bytes) | (GameLink_ReadU16(&bytes[2U]) << (2U * GAMELINK_BITS_PER_BYTE));
+}
+
+/**
+ * @brief Write a little-endian 16 bit field.
+ *
+ * @param[out] bytes First byte of the field
+ * @param[in]  value Value of the field, truncated to 16 bits
+ ******************************************************************************/
+static void GameLink_WriteU16(uint8_t *const bytes, const uint32_t value)
+{
+    bytes[0U] = (uint8_t)(value & GAMELINK_BYTE_MASK);
+    bytes[1U] = (uint8_t)((value >> GAMELINK_BITS_PER_BYTE) & GAMELINK_BYTE_MASK);
+}
+
+/**
+ * @brief Write a little-endian 32 bit field.
+ *
+ * @param[out] bytes First byte of the field
+ * @param[in]  value Value of the field
+ ******************************************************************************/
+static void GameLink_WriteU32(uint8_t *const bytes, const uint32_t value)
+{
+    GameLink_WriteU16(bytes, value);
+    GameLink_WriteU16(&bytes[2U], value >> (2U * GAMELINK_BITS_PER_BYTE));
+}
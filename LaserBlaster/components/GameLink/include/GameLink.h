@@ -0,0 +1,176 @@
+/**
+ * @file GameLink.h
+ *
+ * @brief Compact binary protocol for sharing game state, issued commands and
+ * results between blasters, over any transport that broadcasts frames, such as
+ * ESP-NOW or UDP.
+ *
+ * Messages are batched into frames, which are sent when they are full or when
+ * the oldest message in them has waited for the batch window.  Every frame is
+ * stamped with its sender's clock when sent.  Blasters take turns asking each
+ * peer for its time, NTP style, and estimate the offset of each peer's clock
+ * from their own from the four timestamps of each exchange, so times in
+ * messages from any peer can be converted to the local clock.
+ *
+ * A frame is a header followed by messages, each a type and a payload of a
+ * size fixed by its type.  All fields are little-endian:
+ *
+ *   Header        Magic u8, Version u8, Sender u8, MessageCount u8,
+ *                 Sequence u16, SendTime u32
+ *   SyncRequest   Type u8, Target u8
+ *   SyncResponse  Type u8, Target u8, RequestSendTime u32, RequestReceiveTime
+ *                 u32
+ *   State         Type u8, GameState u8, Score u8, Lives u8
+ *   Command       Type u8, CommandIndex u8, WaitTimeMs u16, IssueTime u32
+ *   Result        Type u8, CommandIndex u8, Success u8, Score u8, Lives u8
+ *
+ * A link is not thread safe and never allocates.  The client passes in the
+ * current time, in microseconds on its own clock, taken as close as possible
+ * to when each frame is received.
+ *
+ ******************************************************************************/
+
+#ifndef GAME_LINK_H
+#define GAME_LINK_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define GAMELINK_MAX_FRAME_SIZE 250U /* Largest frame, the largest ESP-NOW payload */
+#define GAMELINK_MAX_PEERS 15U       /* Number of peers a link keeps clock offsets and statistics of */
+#define GAMELINK_SYNC_SAMPLES 4U     /* Number of recent exchanges the offset of a peer's clock is chosen from */
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef uint32_t GameLink_TimeUs_t; /* Time in microseconds on a blaster's clock, wraps around */
+
+/* Types of messages delivered to the client, clock synchronization is handled by the link */
+typedef enum
+{
+    GAMELINK_MESSAGE_STATE,   /* State of a peer's game */
+    GAMELINK_MESSAGE_COMMAND, /* Command issued by a peer's game */
+    GAMELINK_MESSAGE_RESULT,  /* Result of a command of a peer's game */
+} GameLink_MessageType_t;
+
+/* State of a game */
+typedef struct
+{
+    uint8_t GameState; /* BopIt_GameState_t of the game */
+    uint8_t Score;     /* Score of the player */
+    uint8_t Lives;     /* Remaining lives of the player */
+} GameLink_State_t;
+
+/* Command issued by a game */
+typedef struct
+{
+    uint8_t CommandIndex;        /* Index of the command in the game's list of commands */
+    uint16_t WaitTimeMs;         /* Time the player has to complete the command */
+    GameLink_TimeUs_t IssueTime; /* Time the command was issued on the sender's clock */
+} GameLink_Command_t;
+
+/* Result of a command */
+typedef struct
+{
+    uint8_t CommandIndex; /* Index of the command in the game's list of commands */
+    bool Success;         /* Whether the player completed the command or not */
+    uint8_t Score;        /* Score of the player after the command */
+    uint8_t Lives;        /* Remaining lives of the player after the command */
+} GameLink_Result_t;
+
+/* Message sent to every peer */
+typedef struct
+{
+    GameLink_MessageType_t Type; /* Type of the message */
+    uint8_t Sender;              /* ID of the sender, set by the link */
+    union
+    {
+        GameLink_State_t State;     /* Payload of GAMELINK_MESSAGE_STATE */
+        GameLink_Command_t Command; /* Payload of GAMELINK_MESSAGE_COMMAND */
+        GameLink_Result_t Result;   /* Payload of GAMELINK_MESSAGE_RESULT */
+    };
+} GameLink_Message_t;
+
+/* Transport broadcasting frames to every peer */
+typedef struct
+{
+    bool (*Send)(void *const context, const uint8_t *const frame, const uint32_t size); /* Send a frame, returns whether it was sent */
+    void *Context;                                                                      /* Context passed to Send */
+} GameLink_Transport_t;
+
+/* Configuration of a link */
+typedef struct
+{
+    uint8_t Id;                                                                      /* ID of this blaster, unique among the blasters playing together */
+    GameLink_Transport_t Transport;                                                  /* Transport frames are sent through */
+    void (*OnMessage)(void *const context, const GameLink_Message_t *const message); /* Called for every message received from a peer, can be NULL */
+    void *Context;                                                                   /* Context passed to OnMessage */
+    GameLink_TimeUs_t BatchWindowUs;                                                 /* Longest time a message waits in a frame before it is sent */
+    GameLink_TimeUs_t SyncPeriodUs;                                                  /* Time between asking peers for their time, one peer at a time */
+} GameLink_Config_t;
+
+/* Exchange of timestamps with a peer */
+typedef struct
+{
+    int32_t OffsetUs; /* Offset of the peer's clock from the local clock */
+    uint32_t DelayUs; /* Round trip delay of the exchange, excluding the time the peer held the request */
+} GameLink_SyncSample_t;
+
+/* Peer heard from */
+typedef struct
+{
+    bool Active;                                          /* Whether a frame was received from the peer */
+    uint8_t Id;                                           /* ID of the peer */
+    uint16_t NextSequence;                                /* Sequence expected of the next frame from the peer */
+    uint32_t FramesLost;                                  /* Number of frames from the peer missed, from gaps in their sequence */
+    GameLink_SyncSample_t Samples[GAMELINK_SYNC_SAMPLES]; /* Most recent exchanges of timestamps */
+    uint32_t SampleCount;                                 /* Number of exchanges completed */
+    int32_t OffsetUs;                                     /* Estimated offset of the peer's clock from the local clock, that of the exchange with the shortest delay */
+    uint32_t DelayUs;                                     /* Round trip delay of the exchange the offset was taken from */
+} GameLink_Peer_t;
+
+/* Frames and messages sent and received */
+typedef struct
+{
+    uint32_t FramesSent;       /* Number of frames sent */
+    uint32_t MessagesSent;     /* Number of messages sent, including clock synchronization */
+    uint32_t SendFailures;     /* Number of frames the transport failed to send */
+    uint32_t FramesReceived;   /* Number of valid frames received from peers */
+    uint32_t MessagesReceived; /* Number of messages received, including clock synchronization */
+    uint32_t FramesInvalid;    /* Number of frames dropped as malformed or from an unknown protocol */
+    uint32_t PeersDropped;     /* Number of frames dropped because the table of peers was full */
+} GameLink_Stats_t;
+
+/* Link to the other blasters */
+typedef struct
+{
+    GameLink_Config_t Config;                  /* Configuration of the link */
+    uint8_t Frame[GAMELINK_MAX_FRAME_SIZE];    /* Frame being batched */
+    uint32_t FrameSize;                        /* Size of the frame being batched, 0 if it holds no messages */
+    uint32_t FrameMessages;                    /* Number of messages in the frame being batched */
+    GameLink_TimeUs_t FrameStart;              /* Time the first message was added to the frame being batched */
+    uint16_t Sequence;                         /* Sequence of the next frame sent */
+    GameLink_TimeUs_t LastSync;                /* Time peers were last asked for their time */
+    uint32_t NextSyncPeer;                     /* Index of the next peer to ask for its time */
+    GameLink_Peer_t Peers[GAMELINK_MAX_PEERS]; /* Peers heard from */
+    GameLink_Stats_t Stats;                    /* Frames and messages sent and received */
+} GameLink_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+bool GameLink_Init(GameLink_t *const link, const GameLink_Config_t *const config, const GameLink_TimeUs_t now);
+bool GameLink_Send(GameLink_t *const link, const GameLink_Message_t *const message, const GameLink_TimeUs_t now);
+void GameLink_Receive(GameLink_t *const link, const uint8_t *const frame, const uint32_t size, const GameLink_TimeUs_t now);
+void GameLink_Poll(GameLink_t *const link, const GameLink_TimeUs_t now);
+void GameLink_Flush(GameLink_t *const link, const GameLink_TimeUs_t now);
+const GameLink_Peer_t *GameLink_GetPeer(const GameLink_t *const link, const uint8_t id);
+bool GameLink_ToLocalTime(const GameLink_t *const link, const uint8_t id, const GameLink_TimeUs_t peerTime, GameLink_TimeUs_t *const localTime);
+GameLink_TimeUs_t GameLink_GetPollDelay(const GameLink_t *const link, const GameLink_TimeUs_t now);
+
+#endif
@@ -0,0 +1,415 @@
+/**
+ * @file Gesture.c
+ *
+ * @brief Streaming fixed-point gesture recognition from accelerometer and
+ * gyroscope samples.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Gesture.h"
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define GESTURE_SCALE_SHIFT 16U                        /* Number of fractional bits of the unit conversion scales */
+#define GESTURE_MG_PER_G 1000U                         /* Milli-g per g */
+#define GESTURE_CDEG_DIVISOR 10U                       /* Counts per 1000 degrees per second times this over the sample period in microseconds is counts per centidegree */
+#define GESTURE_WEIGHT_ONE (1 << GESTURE_WEIGHT_SHIFT) /* Weight of 1.0 */
+
+/* Globals
+ ******************************************************************************/
+
+/* Model for twists of about 40 degrees or more within the window, pulls
+ * peaking at about 0.6 g or more and shakes changing acceleration by about 9 g
+ * or more within the window, each penalized by the features of the others so
+ * a motion is recognized as the one gesture it is most like */
+const Gesture_Model_t Gesture_DefaultModel = {
+    .Weights = {
+        [GESTURE_NONE] = {0, 0, 0, 0},
+        [GESTURE_TWIST] = {GESTURE_WEIGHT_ONE / 4, -GESTURE_WEIGHT_ONE / 4, -GESTURE_WEIGHT_ONE / 4, -GESTURE_WEIGHT_ONE / 16},
+        [GESTURE_PULL] = {0, 0, GESTURE_WEIGHT_ONE, -GESTURE_WEIGHT_ONE / 32},
+        [GESTURE_SHAKE] = {0, 0, -GESTURE_WEIGHT_ONE / 4, GESTURE_WEIGHT_ONE / 8},
+    },
+    .Biases = {
+        [GESTURE_NONE] = 0,
+        [GESTURE_TWIST] = -1000,
+        [GESTURE_PULL] = -600,
+        [GESTURE_SHAKE] = -1100,
+    },
+};
+
+static const char *const Gesture_Names[GESTURE_COUNT] = {"None", "Twist", "Pull", "Shake"}; /* Name of each gesture */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static Gesture_Gesture_t Gesture_EndBlock(Gesture_Pipeline_t *const pipeline, int32_t *const score);
+static void Gesture_ExtractFeatures(Gesture_Pipeline_t *const pipeline);
+static Gesture_Gesture_t Gesture_Classify(const Gesture_Pipeline_t *const pipeline, int32_t *const score);
+static void Gesture_ClearWindow(Gesture_Pipeline_t *const pipeline);
+static void Gesture_ClearBlock(Gesture_Pipeline_t *const pipeline);
+static int32_t Gesture_Abs(const int32_t value);
+static int32_t Gesture_Scale(const int64_t value, const uint32_t scale);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize a pipeline with an empty window.  Gravity is taken from
+ * the first block of samples, so the blaster should be held still for the
+ * first GESTURE_BLOCK_SAMPLES samples.
+ *
+ * @param[out] pipeline Pipeline to initialize
+ * @param[in]  config   Configuration of the sensor
+ * @param[in]  model    Classifier, Gesture_DefaultModel if NULL, must stay
+ *                      valid while the pipeline is used
+ *
+ * @return Whether the configuration is valid and the pipeline was initialized
+ * or not
+ ******************************************************************************/
+bool Gesture_Init(Gesture_Pipeline_t *const pipeline, const Gesture_Config_t *const config, const Gesture_Model_t *const model)
+{
+    bool initialized = false;
+
+    if (pipeline != NULL && config != NULL && config->SamplePeriodUs > 0U && config->AccelLsbPerG > 0U && config->GyroLsbPerKdps > 0U)
+    {
+        pipeline->Model = (model != NULL) ? model : &Gesture_DefaultModel;
+        pipeline->SamplePeriodUs = config->SamplePeriodUs;
+        pipeline->AccelScale = (uint32_t)(((uint64_t)GESTURE_MG_PER_G << GESTURE_SCALE_SHIFT) / config->AccelLsbPerG);
+        pipeline->GyroScale = (uint32_t)(((uint64_t)config->SamplePeriodUs << GESTURE_SCALE_SHIFT) / ((uint64_t)config->GyroLsbPerKdps * GESTURE_CDEG_DIVISOR));
+        pipeline->BaselineValid = false;
+        pipeline->Refractory = 0U;
+        pipeline->Stats = (Gesture_Stats_t){0};
+
+        for (uint32_t feature = 0U; feature < GESTURE_FEATURE_COUNT; feature++)
+        {
+            pipeline->Features[feature] = 0;
+        }
+        Gesture_ClearWindow(pipeline);
+        Gesture_ClearBlock(pipeline);
+        initialized = true;
+    }
+
+    return initialized;
+}
+
+/**
+ * @brief Process a burst of consecutive samples, reporting every gesture
+ * recognized.  The cost is a few integer operations per sample plus the
+ * feature extraction and classification of each block completed, which do not
+ * depend on the window.
+ *
+ * @param[in,out] pipeline      Pipeline to process the samples with
+ * @param[in]     samples       Samples, oldest first
+ * @param[in]     count         Number of samples
+ * @param[in]     lastTime      Time of the last sample, from which the times
+ *                              of the others are derived
+ * @param[out]    detections    Gestures recognized, in order of time
+ * @param[in]     maxDetections Number of gestures that fit in detections,
+ *                              others are counted as dropped
+ *
+ * @return Number of gestures written to detections
+ ******************************************************************************/
+uint32_t Gesture_Process(Gesture_Pipeline_t *const pipeline, const Gesture_Sample_t *const samples, const uint32_t count, const Gesture_TimeUs_t lastTime, Gesture_Detection_t *const detections,
+                         const uint32_t maxDetections)
+{
+    uint32_t detectionCount = 0U;
+    Gesture_Gesture_t gesture;
+    int32_t score;
+    int32_t pull;
+
+    if (pipeline != NULL && samples != NULL)
+    {
+        for (uint32_t index = 0U; index < count; index++)
+        {
+            for (uint32_t axis = 0U; axis < GESTURE_AXES; axis++)
+            {
+                pipeline->AccelSum[axis] += samples[index].Accel[axis];
+                pipeline->GyroSum[axis] += samples[index].Gyro[axis];
+            }
+
+            pull = (int32_t)samples[index].Accel[0U] - pipeline->Baseline[0U];
+            if (pull < pipeline->PullPeak)
+            {
+                pipeline->PullPeak = pull;
+            }
+
+            pipeline->BlockSamples++;
+            if (pipeline->BlockSamples == GESTURE_BLOCK_SAMPLES)
+            {
+                gesture = Gesture_EndBlock(pipeline, &score);
+                if (gesture != GESTURE_NONE)
+                {
+                    if (detections != NULL && detectionCount < maxDetections)
+                    {
+                        detections[detectionCount].Gesture = gesture;
+                        detections[detectionCount].Time = lastTime - (Gesture_TimeUs_t)(count - 1U - index) * pipeline->SamplePeriodUs;
+                        detections[detectionCount].Score = score;
+                        detectionCount++;
+                    }
+                    else
+                    {
+                        pipeline->Stats.Dropped++;
+                    }
+                }
+            }
+        }
+
+        pipeline->Stats.Samples += count;
+    }
+
+    return detectionCount;
+}
+
+/**
+ * @brief Unpack samples read from the sensor's FIFO, each
+ * GESTURE_FIFO_SAMPLE_SIZE bytes of big-endian accelerometer X, Y and Z
+ * followed by gyroscope X, Y and Z.  Bytes of an incomplete sample at the end
+ * are ignored.
+ *
+ * @param[in]  bytes   Bytes read from the FIFO
+ * @param[in]  size    Number of bytes
+ * @param[out] samples Samples unpacked, size / GESTURE_FIFO_SAMPLE_SIZE of
+ *                     them
+ *
+ * @return Number of samples unpacked
+ ******************************************************************************/
+uint32_t Gesture_UnpackFifo(const uint8_t *const bytes, const uint32_t size, Gesture_Sample_t *const samples)
+{
+    uint32_t count = 0U;
+    const uint8_t *sample;
+
+    if (bytes != NULL && samples != NULL)
+    {
+        count = size / GESTURE_FIFO_SAMPLE_SIZE;
+        for (uint32_t index = 0U; index < count; index++)
+        {
+            sample = &bytes[index * GESTURE_FIFO_SAMPLE_SIZE];
+            for (uint32_t axis = 0U; axis < GESTURE_AXES; axis++)
+            {
+                samples[index].Accel[axis] = (int16_t)(((uint16_t)sample[2U * axis] << 8U) | sample[2U * axis + 1U]);
+                samples[index].Gyro[axis] = (int16_t)(((uint16_t)sample[2U * (axis + GESTURE_AXES)] << 8U) | sample[2U * (axis + GESTURE_AXES) + 1U]);
+            }
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Get the name of a gesture.
+ *
+ * @param[in] gesture Gesture
+ *
+ * @return Name of the gesture, "Unknown" if not valid
+ ******************************************************************************/
+const char *Gesture_GetName(const Gesture_Gesture_t gesture)
+{
+    return (gesture < GESTURE_COUNT) ? Gesture_Names[gesture] : "Unknown";
+}
+
+/**
+ * @brief End the current block.  The first block only sets the baseline.
+ * Every other block replaces the oldest block of the window, updates the
+ * baseline and has the window classified, unless a gesture was recognized
+ * recently.
+ *
+ * @param[in,out] pipeline Pipeline whose block is complete
+ * @param[out]    score    Score of the gesture recognized, only written if one
+ *                         was
+ *
+ * @return Gesture recognized, GESTURE_NONE if none
+ ******************************************************************************/
+static Gesture_Gesture_t Gesture_EndBlock(Gesture_Pipeline_t *const pipeline, int32_t *const score)
+{
+    Gesture_Gesture_t gesture = GESTURE_NONE;
+    const uint32_t head = pipeline->WindowHead;
+    uint32_t variation = 0U;
+    int32_t mean;
+
+    for (uint32_t axis = 0U; axis < GESTURE_AXES; axis++)
+    {
+        mean = pipeline->AccelSum[axis] / (int32_t)GESTURE_BLOCK_SAMPLES;
+        if (pipeline->BaselineValid)
+        {
+            pipeline->Baseline[axis] += (mean - pipeline->Baseline[axis]) / (1 << GESTURE_BASELINE_SHIFT);
+            variation += (uint32_t)Gesture_Abs(mean - pipeline->BlockMean[axis]);
+        }
+        else
+        {
+            pipeline->Baseline[axis] = mean;
+        }
+        pipeline->BlockMean[axis] = mean;
+    }
+
+    if (pipeline->BaselineValid)
+    {
+        /* Running sums of the window are updated with the difference between the newest and oldest block */
+        for (uint32_t axis = 0U; axis < GESTURE_AXES; axis++)
+        {
+            pipeline->GyroTotal[axis] += pipeline->GyroSum[axis] - pipeline->WindowGyro[head][axis];
+            pipeline->WindowGyro[head][axis] = pipeline->GyroSum[axis];
+        }
+        pipeline->VariationTotal += variation - pipeline->WindowVariation[head];
+        pipeline->WindowVariation[head] = variation;
+        pipeline->WindowPull[head] = pipeline->PullPeak;
+        pipeline->WindowHead = (head + 1U) & (GESTURE_WINDOW_BLOCKS - 1U);
+        pipeline->Stats.Blocks++;
+
+        Gesture_ExtractFeatures(pipeline);
+        if (pipeline->Refractory > 0U)
+        {
+            pipeline->Refractory--;
+        }
+        else
+        {
+            gesture = Gesture_Classify(pipeline, score);
+            if (gesture != GESTURE_NONE)
+            {
+                pipeline->Stats.Gestures[gesture]++;
+                pipeline->Refractory = GESTURE_REFRACTORY_BLOCKS;
+                Gesture_ClearWindow(pipeline);
+            }
+        }
+    }
+    pipeline->BaselineValid = true;
+
+    Gesture_ClearBlock(pipeline);
+
+    return gesture;
+}
+
+/**
+ * @brief Extract the features of the window, converted to physical units.
+ *
+ * @param[in,out] pipeline Pipeline to extract the features of
+ ******************************************************************************/
+static void Gesture_ExtractFeatures(Gesture_Pipeline_t *const pipeline)
+{
+    int32_t pullPeak = 0;
+
+    for (uint32_t block = 0U; block < GESTURE_WINDOW_BLOCKS; block++)
+    {
+        if (pipeline->WindowPull[block] < pullPeak)
+        {
+            pullPeak = pipeline->WindowPull[block];
+        }
+    }
+
+    pipeline->Features[GESTURE_FEATURE_TWIST] = Gesture_Scale(Gesture_Abs(pipeline->GyroTotal[0U]), pipeline->GyroScale);
+    pipeline->Features[GESTURE_FEATURE_TILT] = Gesture_Scale((int64_t)Gesture_Abs(pipeline->GyroTotal[1U]) + Gesture_Abs(pipeline->GyroTotal[2U]), pipeline->GyroScale);
+    pipeline->Features[GESTURE_FEATURE_PULL] = Gesture_Scale(-(int64_t)pullPeak, pipeline->AccelScale);
+    pipeline->Features[GESTURE_FEATURE_SHAKE] = Gesture_Scale(pipeline->VariationTotal, pipeline->AccelScale);
+}
+
+/**
+ * @brief Score every gesture on the features of the window.
+ *
+ * @param[in]  pipeline Pipeline to classify the window of
+ * @param[out] score    Score of the gesture recognized, only written if one
+ *                      was
+ *
+ * @return Gesture with the highest score, GESTURE_NONE if no gesture scores
+ * above it
+ ******************************************************************************/
+static Gesture_Gesture_t Gesture_Classify(const Gesture_Pipeline_t *const pipeline, int32_t *const score)
+{
+    Gesture_Gesture_t gesture = GESTURE_NONE;
+    int64_t bestScore = pipeline->Model->Biases[GESTURE_NONE];
+    int64_t gestureScore;
+
+    for (uint32_t candidate = GESTURE_NONE + 1U; candidate < GESTURE_COUNT; candidate++)
+    {
+        gestureScore = 0;
+        for (uint32_t feature = 0U; feature < GESTURE_FEATURE_COUNT; feature++)
+        {
+            gestureScore += (int64_t)pipeline->Model->Weights[candidate][feature] * pipeline->Features[feature];
+        }
+        gestureScore = pipeline->Model->Biases[candidate] + gestureScore / GESTURE_WEIGHT_ONE;
+
+        if (gestureScore > bestScore)
+        {
+            bestScore = gestureScore;
+            gesture = (Gesture_Gesture_t)candidate;
+        }
+    }
+
+    if (gesture != GESTURE_NONE)
+    {
+        *score = (bestScore > INT32_MAX) ? INT32_MAX : (int32_t)bestScore;
+    }
+
+    return gesture;
+}
+
+/**
+ * @brief Empty the window, so the motion of a gesture recognized is not
+ * counted again.
+ *
+ * @param[in,out] pipeline Pipeline to empty the window of
+ ******************************************************************************/
+static void Gesture_ClearWindow(Gesture_Pipeline_t *const pipeline)
+{
+    for (uint32_t block = 0U; block < GESTURE_WINDOW_BLOCKS; block++)
+    {
+        for (uint32_t axis = 0U; axis < GESTURE_AXES; axis++)
+        {
+            pipeline->WindowGyro[block][axis] = 0;
+        }
+        pipeline->WindowVariation[block] = 0U;
+        pipeline->WindowPull[block] = 0;
+    }
+
+    for (uint32_t axis = 0U; axis < GESTURE_AXES; axis++)
+    {
+        pipeline->GyroTotal[axis] = 0;
+    }
+    pipeline->VariationTotal = 0U;
+    pipeline->WindowHead = 0U;
+}
+
+/**
+ * @brief Start a new block.
+ *
+ * @param[in,out] pipeline Pipeline to start a new block of
+ ******************************************************************************/
+static void Gesture_ClearBlock(Gesture_Pipeline_t *const pipeline)
+{
+    for (uint32_t axis = 0U; axis < GESTURE_AXES; axis++)
+    {
+        pipeline->AccelSum[axis] = 0;
+        pipeline->GyroSum[axis] = 0;
+    }
+    pipeline->PullPeak = 0;
+    pipeline->BlockSamples = 0U;
+}
+
+/**
+ * @brief Get the magnitude of a value.
+ *
+ * @param[in] value Value, greater than INT32_MIN
+ *
+ * @return Magnitude of the value
+ ******************************************************************************/
+static int32_t Gesture_Abs(const int32_t value)
+{
+    return (value < 0) ? -value : value;
+}
+
+/**
+ * @brief Convert a value to physical units.
+ *
+ * @param[in] value Non-negative value in sensor counts
+ * @param[in] scale Units per count, with GESTURE_SCALE_SHIFT fractional bits
+ *
+ * @return Value in physical units, saturated to INT32_MAX
+ ******************************************************************************/
+static int32_t Gesture_Scale(const int64_t value, const uint32_t scale)
+{
+    int64_t scaled = (value * (int64_t)scale) >> GESTURE_SCALE_SHIFT;
+
+    return (scaled > INT32_MAX) ? INT32_MAX : (int32_t)scaled;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file Gesture.h
+ *
+ * @brief Streaming fixed-point gesture recognition from accelerometer and
+ * gyroscope samples.  Samples are accumulated into blocks with a few integer
+ * adds per sample.  Once per block, the block is pushed into a sliding window
+ * of running sums, features of the window are extracted, and a linear
+ * classifier picks the gesture whose score is highest, if any.  The pipeline
+ * never allocates, and its cost per sample does not depend on the window.
+ *
+ * Axes are those of the blaster: X along the barrel, pointing out of the
+ * muzzle, Z up out of the top of the blaster and Y completing a right-handed
+ * frame.  A twist is a rotation about X, a pull a jerk of the blaster towards
+ * the player, along -X, and a shake is acceleration changing back and forth in
+ * any direction.
+ *
+ * Features are in physical units so a model does not depend on the sensor's
+ * range: rotations in centidegrees and accelerations in milli-g.  Gravity is
+ * removed from a pull by a slowly tracked baseline, and a shake is measured by
+ * the change of acceleration from block to block, which holding the blaster
+ * at any angle does not change.
+ *
+ ******************************************************************************/
+
+#ifndef GESTURE_H
+#define GESTURE_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define GESTURE_AXES 3U                                    /* Number of axes of each sensor */
+#define GESTURE_BLOCK_SHIFT 5U                             /* Log2 of the number of samples of a block */
+#define GESTURE_BLOCK_SAMPLES (1U << GESTURE_BLOCK_SHIFT)  /* Number of samples of a block, 32 ms at 1 kHz */
+#define GESTURE_WINDOW_SHIFT 3U                            /* Log2 of the number of blocks of the window */
+#define GESTURE_WINDOW_BLOCKS (1U << GESTURE_WINDOW_SHIFT) /* Number of blocks of the window features are extracted from, 256 ms at 1 kHz */
+#define GESTURE_REFRACTORY_BLOCKS 16U                      /* Number of blocks after a gesture during which no gesture is recognized, so one motion is one gesture */
+#define GESTURE_BASELINE_SHIFT 4U                          /* Weight of each block's mean acceleration in the gravity baseline is 1 / 2^shift */
+#define GESTURE_WEIGHT_SHIFT 8U                            /* Number of fractional bits of a model's weights */
+#define GESTURE_FIFO_SAMPLE_SIZE 12U                       /* Size of a sample in the sensor's FIFO, big-endian accelerometer X, Y, Z then gyroscope X, Y, Z */
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef uint64_t Gesture_TimeUs_t; /* Time in microseconds from a monotonic clock */
+
+/* Gestures, GESTURE_NONE when no gesture is recognized */
+typedef enum
+{
+    GESTURE_NONE,  /* No gesture */
+    GESTURE_TWIST, /* Rotation about the barrel */
+    GESTURE_PULL,  /* Jerk towards the player */
+    GESTURE_SHAKE, /* Repeated acceleration */
+    GESTURE_COUNT, /* Number of gestures, including GESTURE_NONE */
+} Gesture_Gesture_t;
+
+/* Features of the window the classifier scores */
+typedef enum
+{
+    GESTURE_FEATURE_TWIST, /* Rotation about X in centidegrees, either way */
+    GESTURE_FEATURE_TILT,  /* Rotation about Y and Z in centidegrees, either way */
+    GESTURE_FEATURE_PULL,  /* Peak acceleration along -X in milli-g */
+    GESTURE_FEATURE_SHAKE, /* Change of the mean acceleration from block to block in milli-g, summed over the axes and the window */
+    GESTURE_FEATURE_COUNT, /* Number of features */
+} Gesture_Feature_t;
+
+/* Raw sample of the sensor */
+typedef struct
+{
+    int16_t Accel[GESTURE_AXES]; /* Acceleration on each axis */
+    int16_t Gyro[GESTURE_AXES];  /* Angular rate about each axis */
+} Gesture_Sample_t;
+
+/* Configuration of the sensor */
+typedef struct
+{
+    uint32_t SamplePeriodUs; /* Time between samples */
+    uint32_t AccelLsbPerG;   /* Accelerometer counts per g */
+    uint32_t GyroLsbPerKdps; /* Gyroscope counts per 1000 degrees per second */
+} Gesture_Config_t;
+
+/* Linear classifier, the score of each gesture is its bias plus the sum of its weights times the features, and the gesture with the highest score is recognized */
+typedef struct
+{
+    int16_t Weights[GESTURE_COUNT][GESTURE_FEATURE_COUNT]; /* Weight of each feature for each gesture, with GESTURE_WEIGHT_SHIFT fractional bits */
+    int32_t Biases[GESTURE_COUNT];                         /* Bias of each gesture */
+} Gesture_Model_t;
+
+/* Gesture recognized */
+typedef struct
+{
+    Gesture_Gesture_t Gesture; /* Gesture recognized */
+    Gesture_TimeUs_t Time;     /* Time of the last sample of the block it was recognized in */
+    int32_t Score;             /* Score of the gesture */
+} Gesture_Detection_t;
+
+/* Samples processed and gestures recognized */
+typedef struct
+{
+    uint32_t Samples;                 /* Number of samples processed */
+    uint32_t Blocks;                  /* Number of blocks classified */
+    uint32_t Gestures[GESTURE_COUNT]; /* Number of times each gesture was recognized */
+    uint32_t Dropped;                 /* Number of gestures recognized with no room to report them */
+} Gesture_Stats_t;
+
+/* Gesture recognition pipeline */
+typedef struct
+{
+    const Gesture_Model_t *Model;                            /* Classifier */
+    uint32_t SamplePeriodUs;                                 /* Time between samples */
+    uint32_t AccelScale;                                     /* Milli-g per accelerometer count, with 16 fractional bits */
+    uint32_t GyroScale;                                      /* Centidegrees per gyroscope count summed over samples, with 16 fractional bits */
+    int32_t Baseline[GESTURE_AXES];                          /* Acceleration of gravity, the mean acceleration of recent blocks */
+    bool BaselineValid;                                      /* Whether the baseline was set from a first block or not */
+    uint32_t BlockSamples;                                   /* Number of samples in the current block */
+    int32_t AccelSum[GESTURE_AXES];                          /* Sum of the acceleration of the current block */
+    int32_t GyroSum[GESTURE_AXES];                           /* Sum of the angular rate of the current block */
+    int32_t PullPeak;                                        /* Lowest acceleration along X less gravity of the current block */
+    int32_t BlockMean[GESTURE_AXES];                         /* Mean acceleration of the last block */
+    int32_t WindowGyro[GESTURE_WINDOW_BLOCKS][GESTURE_AXES]; /* Sum of the angular rate of each block of the window */
+    uint32_t WindowVariation[GESTURE_WINDOW_BLOCKS];         /* Change of the mean acceleration from the block before of each block of the window */
+    int32_t WindowPull[GESTURE_WINDOW_BLOCKS];               /* Pull peak of each block of the window */
+    int32_t GyroTotal[GESTURE_AXES];                         /* Sum of the angular rate of the window */
+    uint32_t VariationTotal;                                 /* Change of the mean acceleration over the window */
+    uint32_t WindowHead;                                     /* Index of the oldest block of the window */
+    uint32_t Refractory;                                     /* Number of blocks until gestures are recognized again */
+    int32_t Features[GESTURE_FEATURE_COUNT];                 /* Features of the window of the last block */
+    Gesture_Stats_t Stats;                                   /* Samples processed and gestures recognized */
+} Gesture_Pipeline_t;
+
+/* Globals
+ ******************************************************************************/
+
+extern const Gesture_Model_t Gesture_DefaultModel;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+bool Gesture_Init(Gesture_Pipeline_t *const pipeline, const Gesture_Config_t *const config, const Gesture_Model_t *const model);
+uint32_t Gesture_Process(Gesture_Pipeline_t *const pipeline, const Gesture_Sample_t *const samples, const uint32_t count, const Gesture_TimeUs_t lastTime, Gesture_Detection_t *const detections,
+                         const uint32_t maxDetections);
+uint32_t Gesture_UnpackFifo(const uint8_t *const bytes, const uint32_t size, Gesture_Sample_t *const samples);
+const char *Gesture_GetName(const Gesture_Gesture_t gesture);
+
+#endif
@@ -0,0 +1,293 @@
+/**
+ * @file IrShot.c
+ *
+ * @brief Encoding and decoding of infrared laser tag shots.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "IrShot.h"
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define IRSHOT_MIN_US(nominal) ((nominal) - (((nominal) * IRSHOT_TOLERANCE_PERCENT) / 100U)) /* Shortest accepted duration of a pulse */
+#define IRSHOT_MAX_US(nominal) ((nominal) + (((nominal) * IRSHOT_TOLERANCE_PERCENT) / 100U)) /* Longest accepted duration of a pulse */
+#define IRSHOT_CRC_BITS 8U                                                                   /* Number of CRC bits at the end of a frame */
+#define IRSHOT_CRC_POLYNOMIAL 0x07U                                                          /* CRC-8 polynomial x^8 + x^2 + x + 1 */
+#define IRSHOT_DATA_BITS (IRSHOT_FRAME_BITS - IRSHOT_CRC_BITS)                               /* Number of data bits in a frame */
+#define IRSHOT_PLAYER_ID_SHIFT 8U                                                            /* Position of the player ID in the data bits */
+#define IRSHOT_TEAM_SHIFT 4U                                                                 /* Position of the team in the data bits */
+#define IRSHOT_DAMAGE_SHIFT 0U                                                               /* Position of the damage in the data bits */
+#define IRSHOT_NIBBLE_MASK 0x0FU                                                             /* Mask of a 4 bit field */
+#define IRSHOT_BYTE_MASK 0xFFU                                                               /* Mask of an 8 bit field */
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef enum
+{
+    IRSHOT_PULSE_OTHER,  /* Pulse is not a valid part of a frame */
+    IRSHOT_PULSE_HEADER, /* Header mark */
+    IRSHOT_PULSE_ONE,    /* Mark of a 1 bit */
+    IRSHOT_PULSE_ZERO,   /* Mark of a 0 bit */
+    IRSHOT_PULSE_SPACE,  /* Space after the header or a bit */
+} IrShot_PulseType_t;    /* Classification of a pulse */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static uint8_t IrShot_Crc(const uint32_t data);
+static IrShot_PulseType_t IrShot_Classify(const IrShot_Pulse_t *const pulse);
+static bool IrShot_DecodePulse(IrShot_Decoder_t *const decoder, const IrShot_Pulse_t *const pulse, IrShot_Shot_t *const shot);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Encode a shot into the pulses of a frame.
+ *
+ * @param[in]  shot      Shot to encode
+ * @param[out] pulses    Pulses of the frame, alternating marks and spaces
+ * starting with the header mark
+ * @param[in]  maxPulses Number of pulses that fit in pulses
+ *
+ * @return Number of pulses written, IRSHOT_FRAME_PULSES, or 0 if a field of
+ * the shot is out of range or the frame does not fit
+ ******************************************************************************/
+uint32_t IrShot_Encode(const IrShot_Shot_t *const shot, IrShot_Pulse_t *const pulses, const uint32_t maxPulses)
+{
+    uint32_t pulseCount = 0U;
+    uint32_t data;
+    uint32_t frame;
+
+    if (shot != NULL && pulses != NULL && maxPulses >= IRSHOT_FRAME_PULSES && shot->Team <= IRSHOT_MAX_TEAM && shot->Damage <= IRSHOT_MAX_DAMAGE)
+    {
+        data = ((uint32_t)shot->PlayerId << IRSHOT_PLAYER_ID_SHIFT) | ((uint32_t)shot->Team << IRSHOT_TEAM_SHIFT) | ((uint32_t)shot->Damage << IRSHOT_DAMAGE_SHIFT);
+        frame = (data << IRSHOT_CRC_BITS) | IrShot_Crc(data);
+
+        pulses[pulseCount++] = (IrShot_Pulse_t){.DurationUs = IRSHOT_HEADER_MARK_US, .Mark = true};
+        pulses[pulseCount++] = (IrShot_Pulse_t){.DurationUs = IRSHOT_SPACE_US, .Mark = false};
+
+        for (uint32_t bit = IRSHOT_FRAME_BITS; bit > 0U; bit--)
+        {
+            pulses[pulseCount++] = (IrShot_Pulse_t){.DurationUs = ((frame >> (bit - 1U)) & 1U) ? IRSHOT_ONE_MARK_US : IRSHOT_ZERO_MARK_US, .Mark = true};
+            pulses[pulseCount++] = (IrShot_Pulse_t){.DurationUs = IRSHOT_SPACE_US, .Mark = false};
+        }
+    }
+
+    return pulseCount;
+}
+
+/**
+ * @brief Initialize a decoder to wait for a header mark and clear its
+ * statistics.
+ *
+ * @param[out] decoder Decoder to initialize
+ ******************************************************************************/
+void IrShot_DecoderInit(IrShot_Decoder_t *const decoder)
+{
+    if (decoder != NULL)
+    {
+        decoder->State = IRSHOT_STATE_IDLE;
+        decoder->Bits = 0U;
+        decoder->BitCount = 0U;
+        decoder->Stats = (IrShot_Stats_t){0};
+    }
+}
+
+/**
+ * @brief Feed pulses to a decoder.  A frame is decoded as soon as the mark of
+ * its last bit is received, so the trailing space, which receivers usually
+ * report as the end of the signal, is not needed.  A pulse that breaks a frame
+ * abandons it, and is considered as the header mark of a new frame.
+ *
+ * @param[in,out] decoder    Decoder to feed the pulses to
+ * @param[in]     pulses     Pulses received
+ * @param[in]     pulseCount Number of pulses received
+ * @param[out]    shots      Shots decoded from the pulses
+ * @param[in]     maxShots   Number of shots that fit in shots, shots decoded
+ * after it is full are counted in the statistics but not written
+ *
+ * @return Number of shots written
+ ******************************************************************************/
+uint32_t IrShot_Decode(IrShot_Decoder_t *const decoder, const IrShot_Pulse_t *const pulses, const uint32_t pulseCount, IrShot_Shot_t *const shots, const uint32_t maxShots)
+{
+    IrShot_Shot_t shot;
+    uint32_t shotCount = 0U;
+
+    if (decoder != NULL && pulses != NULL && (shots != NULL || maxShots == 0U))
+    {
+        for (uint32_t pulseIndex = 0U; pulseIndex < pulseCount; pulseIndex++)
+        {
+            if (IrShot_DecodePulse(decoder, &pulses[pulseIndex], &shot) && shotCount < maxShots)
+            {
+                shots[shotCount++] = shot;
+            }
+        }
+    }
+
+    return shotCount;
+}
+
+/**
+ * @brief Check whether a decoded shot hits a player.  A blaster's receiver
+ * also sees its own shots reflected back, so a shot fired by the same player
+ * is not a hit.
+ *
+ * @param[in] shot     Shot decoded
+ * @param[in] playerId ID of the player receiving the shot
+ *
+ * @return Whether the shot hits the player or not
+ ******************************************************************************/
+bool IrShot_IsHit(const IrShot_Shot_t *const shot, const uint8_t playerId)
+{
+    return shot != NULL && shot->PlayerId != playerId;
+}
+
+/**
+ * @brief Calculate the CRC-8 of the data bits of a frame, most significant bit
+ * first with no initial value or final XOR.
+ *
+ * @param[in] data Data bits of the frame
+ *
+ * @return CRC of the data bits
+ ******************************************************************************/
+static uint8_t IrShot_Crc(const uint32_t data)
+{
+    uint32_t crc = 0U;
+
+    for (uint32_t bit = IRSHOT_DATA_BITS; bit > 0U; bit--)
+    {
+        crc ^= ((data >> (bit - 1U)) & 1U) << (IRSHOT_CRC_BITS - 1U);
+        crc = (crc & (1U << (IRSHOT_CRC_BITS - 1U))) ? ((crc << 1U) ^ IRSHOT_CRC_POLYNOMIAL) : (crc << 1U);
+    }
+
+    return (uint8_t)(crc & IRSHOT_BYTE_MASK);
+}
+
+/**
+ * @brief Classify a pulse by its level and duration.
+ *
+ * @param[in] pulse Pulse to classify
+ *
+ * @return Type of the pulse, IRSHOT_PULSE_OTHER if it is not within tolerance
+ * of any pulse of a frame
+ ******************************************************************************/
+static IrShot_PulseType_t IrShot_Classify(const IrShot_Pulse_t *const pulse)
+{
+    uint32_t duration = pulse->DurationUs;
+    IrShot_PulseType_t type = IRSHOT_PULSE_OTHER;
+
+    if (!pulse->Mark)
+    {
+        if (duration >= IRSHOT_MIN_US(IRSHOT_SPACE_US) && duration <= IRSHOT_MAX_US(IRSHOT_SPACE_US))
+        {
+            type = IRSHOT_PULSE_SPACE;
+        }
+    }
+    else if (duration >= IRSHOT_MIN_US(IRSHOT_ZERO_MARK_US) && duration <= IRSHOT_MAX_US(IRSHOT_ZERO_MARK_US))
+    {
+        type = IRSHOT_PULSE_ZERO;
+    }
+    else if (duration >= IRSHOT_MIN_US(IRSHOT_ONE_MARK_US) && duration <= IRSHOT_MAX_US(IRSHOT_ONE_MARK_US))
+    {
+        type = IRSHOT_PULSE_ONE;
+    }
+    else if (duration >= IRSHOT_MIN_US(IRSHOT_HEADER_MARK_US) && duration <= IRSHOT_MAX_US(IRSHOT_HEADER_MARK_US))
+    {
+        type = IRSHOT_PULSE_HEADER;
+    }
+
+    return type;
+}
+
+/**
+ * @brief Advance a decoder by a single pulse.
+ *
+ * @param[in,out] decoder Decoder to advance
+ * @param[in]     pulse   Pulse received
+ * @param[out]    shot    Shot decoded, only written if a frame was completed
+ * with a matching CRC
+ *
+ * @return Whether a shot was decoded or not
+ ******************************************************************************/
+static bool IrShot_DecodePulse(IrShot_Decoder_t *const decoder, const IrShot_Pulse_t *const pulse, IrShot_Shot_t *const shot)
+{
+    IrShot_PulseType_t type = IrShot_Classify(pulse);
+    uint32_t data;
+    bool decoded = false;
+
+    switch (decoder->State)
+    {
+    case IRSHOT_STATE_HEADER_SPACE:
+        if (type == IRSHOT_PULSE_SPACE)
+        {
+            decoder->Bits = 0U;
+            decoder->BitCount = 0U;
+            decoder->State = IRSHOT_STATE_BIT_MARK;
+        }
+        else
+        {
+            decoder->Stats.FramingErrors++;
+            decoder->State = IRSHOT_STATE_IDLE;
+        }
+        break;
+    case IRSHOT_STATE_BIT_MARK:
+        if (type == IRSHOT_PULSE_ONE || type == IRSHOT_PULSE_ZERO)
+        {
+            decoder->Bits = (decoder->Bits << 1U) | ((type == IRSHOT_PULSE_ONE) ? 1U : 0U);
+            decoder->BitCount++;
+            decoder->State = IRSHOT_STATE_BIT_SPACE;
+
+            if (decoder->BitCount == IRSHOT_FRAME_BITS)
+            {
+                data = decoder->Bits >> IRSHOT_CRC_BITS;
+                if (IrShot_Crc(data) == (decoder->Bits & IRSHOT_BYTE_MASK))
+                {
+                    shot->PlayerId = (uint8_t)((data >> IRSHOT_PLAYER_ID_SHIFT) & IRSHOT_BYTE_MASK);
+                    shot->Team = (uint8_t)((data >> IRSHOT_TEAM_SHIFT) & IRSHOT_NIBBLE_MASK);
+                    shot->Damage = (uint8_t)((data >> IRSHOT_DAMAGE_SHIFT) & IRSHOT_NIBBLE_MASK);
+                    decoder->Stats.Shots++;
+                    decoded = true;
+                }
+                else
+                {
+                    decoder->Stats.ChecksumErrors++;
+                }
+                decoder->State = IRSHOT_STATE_IDLE;
+            }
+        }
+        else
+        {
+            decoder->Stats.FramingErrors++;
+            decoder->State = IRSHOT_STATE_IDLE;
+        }
+        break;
+    case IRSHOT_STATE_BIT_SPACE:
+        if (type == IRSHOT_PULSE_SPACE)
+        {
+            decoder->State = IRSHOT_STATE_BIT_MARK;
+        }
+        else
+        {
+            decoder->Stats.FramingErrors++;
+            decoder->State = IRSHOT_STATE_IDLE;
+        }
+        break;
+    case IRSHOT_STATE_IDLE:
+    default:
+        decoder->State = IRSHOT_STATE_IDLE;
+        break;
+    }
+
+    /* A pulse that did not advance a frame may start a new one */
+    if (decoder->State == IRSHOT_STATE_IDLE && type == IRSHOT_PULSE_HEADER)
+    {
+        decoder->State = IRSHOT_STATE_HEADER_SPACE;
+    }
+
+    return decoded;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file IrShot.h
+ *
+ * @brief Encoding and decoding of infrared laser tag shots.  A shot carries
+ * the ID of the player that fired it, their team and the damage it deals,
+ * protected by a CRC-8.  Shots are sent as pulse width modulated frames: a
+ * header mark followed by 24 bits sent most significant bit first, each a
+ * long (1) or short (0) mark followed by a fixed space.
+ *
+ * The codec only deals in pulse durations, so it has no hardware dependencies.
+ * On the target the pulses are produced and captured by the RMT peripheral,
+ * and on the host they can be synthesized to exercise the decoder.  The
+ * decoder is a state machine that can be fed pulses in buffers of any size,
+ * including frames split across buffers.
+ *
+ ******************************************************************************/
+
+#ifndef IR_SHOT_H
+#define IR_SHOT_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define IRSHOT_HEADER_MARK_US 2400U                         /* Duration of the header mark */
+#define IRSHOT_ONE_MARK_US 1200U                            /* Duration of the mark of a 1 bit */
+#define IRSHOT_ZERO_MARK_US 600U                            /* Duration of the mark of a 0 bit */
+#define IRSHOT_SPACE_US 600U                                /* Duration of the space after the header and each bit */
+#define IRSHOT_TOLERANCE_PERCENT 25U                        /* Pulses are accepted within this percentage of their nominal duration */
+#define IRSHOT_FRAME_BITS 24U                               /* Number of bits in a frame, 16 data bits and 8 CRC bits */
+#define IRSHOT_FRAME_PULSES (2U + (2U * IRSHOT_FRAME_BITS)) /* Number of pulses in an encoded frame, including the trailing space */
+#define IRSHOT_MAX_PLAYER_ID 255U                           /* Maximum player ID */
+#define IRSHOT_MAX_TEAM 15U                                 /* Maximum team */
+#define IRSHOT_MAX_DAMAGE 15U                               /* Maximum damage of a shot */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Mark or space of an infrared signal */
+typedef struct
+{
+    uint16_t DurationUs; /* Duration of the pulse in microseconds */
+    bool Mark;           /* Whether the carrier is on during the pulse */
+} IrShot_Pulse_t;
+
+/* Shot fired by a blaster */
+typedef struct
+{
+    uint8_t PlayerId; /* ID of the player that fired the shot */
+    uint8_t Team;     /* Team of the player that fired the shot */
+    uint8_t Damage;   /* Damage dealt by the shot */
+} IrShot_Shot_t;
+
+typedef enum
+{
+    IRSHOT_STATE_IDLE,         /* Waiting for a header mark */
+    IRSHOT_STATE_HEADER_SPACE, /* Waiting for the space after the header mark */
+    IRSHOT_STATE_BIT_MARK,     /* Waiting for the mark of a bit */
+    IRSHOT_STATE_BIT_SPACE,    /* Waiting for the space after the mark of a bit */
+} IrShot_State_t;              /* State of a decoder */
+
+/* Frames seen by a decoder */
+typedef struct
+{
+    uint32_t Shots;          /* Number of frames decoded into shots */
+    uint32_t ChecksumErrors; /* Number of complete frames with a CRC mismatch */
+    uint32_t FramingErrors;  /* Number of frames abandoned after the header because of a pulse out of tolerance */
+} IrShot_Stats_t;
+
+/* Frame decoder */
+typedef struct
+{
+    IrShot_State_t State; /* State of the decoder */
+    uint32_t Bits;        /* Bits of the frame received so far */
+    uint32_t BitCount;    /* Number of bits of the frame received so far */
+    IrShot_Stats_t Stats; /* Frames seen by the decoder */
+} IrShot_Decoder_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+uint32_t IrShot_Encode(const IrShot_Shot_t *const shot, IrShot_Pulse_t *const pulses, const uint32_t maxPulses);
+void IrShot_DecoderInit(IrShot_Decoder_t *const decoder);
+uint32_t IrShot_Decode(IrShot_Decoder_t *const decoder, const IrShot_Pulse_t *const pulses, const uint32_t pulseCount, IrShot_Shot_t *const shots, const uint32_t maxShots);
+bool IrShot_IsHit(const IrShot_Shot_t *const shot, const uint8_t playerId);
+
+#endif
@@ -0,0 +1,186 @@
+/**
+ * @file LogRing.c
+ *
+ * @brief Lock-free ring buffer of binary log records.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "LogRing.h"
+#include <stdio.h>
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize an empty ring using the given storage for records.
+ *
+ * @param[out] ring    Ring to initialize
+ * @param[in]  records Storage for records
+ * @param[in]  size    Number of records in storage, must be a power of two
+ *
+ * @return Whether the ring was initialized or not
+ *
+ * @retval true The ring was initialized
+ * @retval false The storage was NULL or its size was not a power of two
+ ******************************************************************************/
+bool LogRing_Init(LogRing_t *const ring, LogRing_Record_t *const records, const uint32_t size)
+{
+    bool initialized = false;
+
+    if (ring != NULL && records != NULL && size > 0U && (size & (size - 1U)) == 0U)
+    {
+        ring->Records = records;
+        ring->Size = size;
+        atomic_init(&ring->Head, 0U);
+        atomic_init(&ring->Tail, 0U);
+        atomic_init(&ring->Dropped, 0U);
+        atomic_init(&ring->HighWater, 0U);
+        initialized = true;
+    }
+
+    return initialized;
+}
+
+/**
+ * @brief Write a record to a ring.  Never blocks, the record is dropped if the
+ * ring is full.  Must only be called by the producer of the ring.
+ *
+ * @param[in,out] ring   Ring to write the record to
+ * @param[in]     record Record to write
+ *
+ * @return Whether the record was written or not
+ *
+ * @retval true The record was written
+ * @retval false The ring was full and the record was dropped
+ ******************************************************************************/
+bool LogRing_Write(LogRing_t *const ring, const LogRing_Record_t *const record)
+{
+    bool written = false;
+    uint32_t head;
+    uint32_t count;
+
+    if (ring != NULL && record != NULL)
+    {
+        head = atomic_load_explicit(&ring->Head, memory_order_relaxed);
+
+        count = head - atomic_load_explicit(&ring->Tail, memory_order_acquire);
+        if (count < ring->Size)
+        {
+            ring->Records[head & (ring->Size - 1U)] = *record;
+
+            /* Publish the record to the consumer */
+            atomic_store_explicit(&ring->Head, head + 1U, memory_order_release);
+            written = true;
+
+            if ((count + 1U) > atomic_load_explicit(&ring->HighWater, memory_order_relaxed))
+            {
+                atomic_store_explicit(&ring->HighWater, count + 1U, memory_order_relaxed);
+            }
+        }
+        else
+        {
+            atomic_fetch_add_explicit(&ring->Dropped, 1U, memory_order_relaxed);
+        }
+    }
+
+    return written;
+}
+
+/**
+ * @brief Read the oldest record from a ring.  Must only be called by the
+ * consumer of the ring.
+ *
+ * @param[in,out] ring   Ring to read the record from
+ * @param[out]    record Record read
+ *
+ * @return Whether a record was read or not
+ *
+ * @retval true A record was read
+ * @retval false The ring was empty
+ ******************************************************************************/
+bool LogRing_Read(LogRing_t *const ring, LogRing_Record_t *const record)
+{
+    bool read = false;
+    uint32_t tail;
+
+    if (ring != NULL && record != NULL)
+    {
+        tail = atomic_load_explicit(&ring->Tail, memory_order_relaxed);
+
+        if (tail != atomic_load_explicit(&ring->Head, memory_order_acquire))
+        {
+            *record = ring->Records[tail & (ring->Size - 1U)];
+
+            /* Release the slot back to the producer */
+            atomic_store_explicit(&ring->Tail, tail + 1U, memory_order_release);
+            read = true;
+        }
+    }
+
+    return read;
+}
+
+/**
+ * @brief Get the number of records dropped because a ring was full.
+ *
+ * @param[in] ring Ring to get the number of dropped records of
+ *
+ * @return Number of dropped records
+ ******************************************************************************/
+uint32_t LogRing_GetDropped(LogRing_t *const ring)
+{
+    uint32_t dropped = 0U;
+
+    if (ring != NULL)
+    {
+        dropped = atomic_load_explicit(&ring->Dropped, memory_order_relaxed);
+    }
+
+    return dropped;
+}
+
+/**
+ * @brief Get the most records a ring held at once.
+ *
+ * @param[in] ring Ring to get the high water mark of
+ *
+ * @return Most records held at once, the size of the ring if it was ever full
+ ******************************************************************************/
+uint32_t LogRing_GetHighWater(LogRing_t *const ring)
+{
+    uint32_t highWater = 0U;
+
+    if (ring != NULL)
+    {
+        highWater = atomic_load_explicit(&ring->HighWater, memory_order_relaxed);
+    }
+
+    return highWater;
+}
+
+/**
+ * @brief Format a record as text.  All conversions in the format string must
+ * take a uint32_t argument.
+ *
+ * @param[in]  record Record to format
+ * @param[in]  format Format string for the record
+ * @param[out] buffer Buffer for the formatted text
+ * @param[in]  size   Size of the buffer
+ *
+ * @return Number of characters that would have been written for a large
+ * enough buffer, negative on error
+ ******************************************************************************/
+int LogRing_Format(const LogRing_Record_t *const record, const char *const format, char *const buffer, const size_t size)
+{
+    int length = -1;
+
+    if (record != NULL && format != NULL && buffer != NULL)
+    {
+        /* Unused arguments are ignored by snprintf */
+        length = snprintf(buffer, size, format, record->Args[0U], record->Args[1U], record->Args[2U], record->Args[3U]);
+    }
+
+    return length;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file LogRing.h
+ *
+ * @brief Lock-free ring buffer of binary log records.  A producer records a
+ * format ID and raw arguments instead of formatting text, and a consumer,
+ * typically a low priority task, formats the records later.  Records written
+ * while the ring is full are dropped and counted instead of blocking the
+ * producer.
+ *
+ * A ring has a single producer and a single consumer.
+ *
+ * Captured records can be saved as a sequence of LogRing_Record_t in host
+ * byte order and decoded back into text on a host.
+ *
+ ******************************************************************************/
+
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define LOGRING_MAX_ARGS 4U /* Maximum number of arguments in a record */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Binary log record */
+typedef struct
+{
+    uint32_t Time;                   /* Time at which the record was written, in units chosen by the producer */
+    uint16_t FormatId;               /* ID of the format string for the record, chosen by the producer */
+    uint8_t ArgCount;                /* Number of arguments used */
+    uint8_t Reserved;                /* Reserved, zero */
+    uint32_t Args[LOGRING_MAX_ARGS]; /* Raw arguments for the format string */
+} LogRing_Record_t;
+
+/* Ring buffer of log records */
+typedef struct
+{
+    LogRing_Record_t *Records;  /* Storage for records */
+    uint32_t Size;              /* Number of records in storage, a power of two */
+    _Atomic uint32_t Head;      /* Number of records written, only modified by the producer */
+    _Atomic uint32_t Tail;      /* Number of records read, only modified by the consumer */
+    _Atomic uint32_t Dropped;   /* Number of records dropped because the ring was full */
+    _Atomic uint32_t HighWater; /* Most records the ring held at once, only modified by the producer */
+} LogRing_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+bool LogRing_Init(LogRing_t *const ring, LogRing_Record_t *const records, const uint32_t size);
+bool LogRing_Write(LogRing_t *const ring, const LogRing_Record_t *const record);
+bool LogRing_Read(LogRing_t *const ring, LogRing_Record_t *const record);
+uint32_t LogRing_GetDropped(LogRing_t *const ring);
+uint32_t LogRing_GetHighWater(LogRing_t *const ring);
+int LogRing_Format(const LogRing_Record_t *const record, const char *const format, char *const buffer, const size_t size);
+
+#endif
@@ -0,0 +1,250 @@
+/**
+ * @file Prng.c
+ *
+ * @brief Small, fast pseudo random number generator with an explicit seed.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Prng.h"
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define PRNG_MULTIPLIER 6364136223846793005ULL /* Multiplier of the PCG32 LCG */
+#define PRNG_LIST_END UINT32_MAX               /* Marks the end of a work list while building an alias table */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static inline void Prng_Step(Prng_t *const prng);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Seed a generator.  Generators seeded with the same seed and sequence
+ * produce the same numbers.
+ *
+ * @param[out] prng     Generator to seed
+ * @param[in]  seed     Starting state of the generator
+ * @param[in]  sequence Selects the sequence of the generator, generators with
+ *                      different sequences are independent even if seeded
+ *                      with the same seed
+ ******************************************************************************/
+void Prng_Seed(Prng_t *const prng, const uint64_t seed, const uint64_t sequence)
+{
+    if (prng != NULL)
+    {
+        prng->State = 0U;
+        prng->Increment = (sequence << 1U) | 1U;
+        Prng_Step(prng);
+        prng->State += seed;
+        Prng_Step(prng);
+    }
+}
+
+/**
+ * @brief Get the next number from a generator.
+ *
+ * @param[in,out] prng Generator
+ *
+ * @return Uniformly distributed 32-bit number
+ ******************************************************************************/
+uint32_t Prng_Next(Prng_t *const prng)
+{
+    uint32_t random = 0U;
+    uint64_t state;
+    uint32_t xorShifted;
+    uint32_t rotation;
+
+    if (prng != NULL)
+    {
+        state = prng->State;
+        Prng_Step(prng);
+
+        xorShifted = (uint32_t)(((state >> 18U) ^ state) >> 27U);
+        rotation = (uint32_t)(state >> 59U);
+        random = (xorShifted >> rotation) | (xorShifted << ((32U - rotation) & 31U));
+    }
+
+    return random;
+}
+
+/**
+ * @brief Get a number from a generator uniformly distributed below a bound.
+ * Scales a 32-bit number by multiplication rather than taking the remainder,
+ * and only draws again in the rare case the scaled number would be biased.
+ *
+ * @param[in,out] prng  Generator
+ * @param[in]     bound Upper bound, exclusive
+ *
+ * @return Number in [0, bound), 0 if bound is 0
+ ******************************************************************************/
+uint32_t Prng_Bounded(Prng_t *const prng, const uint32_t bound)
+{
+    uint64_t product = 0U;
+    uint32_t threshold;
+
+    if (prng != NULL && bound > 0U)
+    {
+        product = (uint64_t)Prng_Next(prng) * bound;
+
+        if ((uint32_t)product < bound)
+        {
+            /* 2^32 mod bound, low halves below this would make some results more likely */
+            threshold = (uint32_t)(-bound) % bound;
+
+            while ((uint32_t)product < threshold)
+            {
+                product = (uint64_t)Prng_Next(prng) * bound;
+            }
+        }
+    }
+
+    return (uint32_t)(product >> 32U);
+}
+
+/**
+ * @brief Build an alias table from the weights of indices so that weighted
+ * indices can be drawn in constant time.  Uses Vose's method with integer
+ * arithmetic, so draws are exactly proportional to the weights.  The work
+ * lists are kept in the aliases of the entries, so no extra memory is needed.
+ *
+ * @param[out] table   Table to build
+ * @param[out] entries Storage for the entries of the table, one per index
+ * @param[in]  weights Weight of each index
+ * @param[in]  count   Number of indices
+ *
+ * @return Whether the table was built or not
+ *
+ * @retval true The table was built
+ * @retval false A pointer was NULL, count was 0, or the sum of the weights is
+ * 0 or does not fit in 32 bits when multiplied by count
+ ******************************************************************************/
+bool Prng_AliasInit(Prng_AliasTable_t *const table, Prng_AliasEntry_t *const entries, const uint32_t *const weights, const uint32_t count)
+{
+    bool initialized = false;
+    uint64_t totalWeight = 0U;
+    uint64_t scaledWeight;
+    uint32_t small = PRNG_LIST_END;
+    uint32_t large = PRNG_LIST_END;
+    uint32_t smallIndex;
+    uint32_t largeIndex;
+
+    if (table != NULL && entries != NULL && weights != NULL && count > 0U)
+    {
+        for (uint32_t index = 0U; index < count; index++)
+        {
+            totalWeight += weights[index];
+        }
+
+        if (totalWeight > 0U && totalWeight <= (UINT32_MAX / count))
+        {
+            /* Weights are scaled by count so the average weight is totalWeight, and
+               indices below the average are pushed to the small list, others to the
+               large list */
+            for (uint32_t index = 0U; index < count; index++)
+            {
+                scaledWeight = (uint64_t)weights[index] * count;
+                if (scaledWeight < totalWeight)
+                {
+                    entries[index].Threshold = (uint32_t)scaledWeight;
+                    entries[index].Alias = small;
+                    small = index;
+                }
+                else
+                {
+                    /* Excess over the average is kept in the threshold until the index leaves the large list */
+                    entries[index].Threshold = (uint32_t)(scaledWeight - totalWeight);
+                    entries[index].Alias = large;
+                    large = index;
+                }
+            }
+
+            /* Fill the remainder of each small index with a large index */
+            while (small != PRNG_LIST_END && large != PRNG_LIST_END)
+            {
+                smallIndex = small;
+                small = entries[smallIndex].Alias;
+                largeIndex = large;
+                large = entries[largeIndex].Alias;
+
+                entries[smallIndex].Alias = largeIndex;
+
+                scaledWeight = (uint64_t)entries[largeIndex].Threshold + entries[smallIndex].Threshold;
+                if (scaledWeight < totalWeight)
+                {
+                    entries[largeIndex].Threshold = (uint32_t)scaledWeight;
+                    entries[largeIndex].Alias = small;
+                    small = largeIndex;
+                }
+                else
+                {
+                    entries[largeIndex].Threshold = (uint32_t)(scaledWeight - totalWeight);
+                    entries[largeIndex].Alias = large;
+                    large = largeIndex;
+                }
+            }
+
+            /* Remaining indices are at the average, always drawn as themselves */
+            while (large != PRNG_LIST_END)
+            {
+                largeIndex = large;
+                large = entries[largeIndex].Alias;
+                entries[largeIndex].Threshold = (uint32_t)totalWeight;
+                entries[largeIndex].Alias = largeIndex;
+            }
+            while (small != PRNG_LIST_END)
+            {
+                smallIndex = small;
+                small = entries[smallIndex].Alias;
+                entries[smallIndex].Threshold = (uint32_t)totalWeight;
+                entries[smallIndex].Alias = smallIndex;
+            }
+
+            table->Entries = entries;
+            table->Count = count;
+            table->TotalWeight = (uint32_t)totalWeight;
+            initialized = true;
+        }
+    }
+
+    return initialized;
+}
+
+/**
+ * @brief Draw an index from an alias table with probability proportional to
+ * its weight.
+ *
+ * @param[in,out] prng  Generator
+ * @param[in]     table Alias table built with Prng_AliasInit
+ *
+ * @return Drawn index, 0 if the table is NULL or empty
+ ******************************************************************************/
+uint32_t Prng_AliasDraw(Prng_t *const prng, const Prng_AliasTable_t *const table)
+{
+    uint32_t index = 0U;
+    const Prng_AliasEntry_t *entry;
+
+    if (prng != NULL && table != NULL && table->Entries != NULL && table->Count > 0U)
+    {
+        entry = &table->Entries[Prng_Bounded(prng, table->Count)];
+        index = (Prng_Bounded(prng, table->TotalWeight) < entry->Threshold) ? (uint32_t)(entry - table->Entries) : entry->Alias;
+    }
+
+    return index;
+}
+
+/**
+ * @brief Advance the state of a generator.  The increment is forced odd so a
+ * zero initialized generator still has a full period.
+ *
+ * @param[in,out] prng Generator
+ ******************************************************************************/
+static inline void Prng_Step(Prng_t *const prng)
+{
+    prng->State = (prng->State * PRNG_MULTIPLIER) + (prng->Increment | 1U);
+}
@@ -0,0 +1,57 @@
+/**
+ * @file Prng.h
+ *
+ * @brief Small, fast pseudo random number generator with an explicit seed.
+ * Implements PCG32 (XSH-RR output of a 64-bit LCG), so each generator is 16
+ * bytes of state, is reproducible from its seed, and shares nothing with other
+ * generators.  A zero initialized generator is valid and produces a fixed
+ * sequence.
+ *
+ * Also provides unbiased bounded draws and alias tables for drawing weighted
+ * indices in constant time.
+ *
+ ******************************************************************************/
+
+#ifndef PRNG_H
+#define PRNG_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Pseudo random number generator */
+typedef struct
+{
+    uint64_t State;     /* Current state of the generator */
+    uint64_t Increment; /* Selects one of 2^63 sequences, always odd after seeding */
+} Prng_t;
+
+/* Entry of an alias table */
+typedef struct
+{
+    uint32_t Threshold; /* Index of the entry is drawn if a draw below the table's total weight is less than this, otherwise the alias is drawn */
+    uint32_t Alias;     /* Index drawn instead of the entry's own index */
+} Prng_AliasEntry_t;
+
+/* Alias table for drawing weighted indices */
+typedef struct
+{
+    Prng_AliasEntry_t *Entries; /* One entry per index */
+    uint32_t Count;             /* Number of indices */
+    uint32_t TotalWeight;       /* Sum of the weights of all indices */
+} Prng_AliasTable_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void Prng_Seed(Prng_t *const prng, const uint64_t seed, const uint64_t sequence);
+uint32_t Prng_Next(Prng_t *const prng);
+uint32_t Prng_Bounded(Prng_t *const prng, const uint32_t bound);
+bool Prng_AliasInit(Prng_AliasTable_t *const table, Prng_AliasEntry_t *const entries, const uint32_t *const weights, const uint32_t count);
+uint32_t Prng_AliasDraw(Prng_t *const prng, const Prng_AliasTable_t *const table);
+
+#endif
@@ -0,0 +1,399 @@
+/**
+ * @file TimerWheel.c
+ *
+ * @brief Hierarchical timing wheel for game deadlines and effect timers.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "TimerWheel.h"
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define TIMERWHEEL_SLOT_MASK (TIMERWHEEL_SLOTS - 1U)                    /* Mask of the slot of a level in a tick shifted down to the level */
+#define TIMERWHEEL_SPAN_BITS (TIMERWHEEL_LEVELS * TIMERWHEEL_SLOT_BITS) /* Number of bits of a tick covered by the levels */
+#define TIMERWHEEL_TICK_BITS 64U                                        /* Number of bits of a tick */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void TimerWheel_Place(TimerWheel_t *const wheel, TimerWheel_Timer_t *const timer);
+static void TimerWheel_Unlink(TimerWheel_t *const wheel, TimerWheel_Timer_t *const timer);
+static void TimerWheel_Replace(TimerWheel_t *const wheel, TimerWheel_Timer_t *timer);
+static uint64_t TimerWheel_GetNextTick(const TimerWheel_t *const wheel);
+static uint32_t TimerWheel_RunTick(TimerWheel_t *const wheel);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize an empty wheel.
+ *
+ * @param[out] wheel  Wheel to initialize
+ * @param[in]  tickUs Width of a tick, the resolution of the wheel's timers
+ * @param[in]  now    Current time
+ *
+ * @return Whether the wheel was initialized or not, false if the width of a
+ * tick is 0
+ ******************************************************************************/
+bool TimerWheel_Init(TimerWheel_t *const wheel, const uint32_t tickUs, const TimerWheel_TimeUs_t now)
+{
+    bool initialized = false;
+
+    if (wheel != NULL && tickUs > 0U)
+    {
+        for (uint32_t level = 0U; level < TIMERWHEEL_LEVELS; level++)
+        {
+            for (uint32_t slot = 0U; slot < TIMERWHEEL_SLOTS; slot++)
+            {
+                wheel->Slots[level][slot] = NULL;
+            }
+            wheel->Occupied[level] = 0U;
+        }
+        wheel->Overflow = NULL;
+        wheel->Tick = now / tickUs;
+        wheel->TickUs = tickUs;
+        wheel->Count = 0U;
+        wheel->Stats.Armed = 0U;
+        wheel->Stats.Cancelled = 0U;
+        wheel->Stats.Expired = 0U;
+        wheel->Stats.Cascaded = 0U;
+        initialized = true;
+    }
+
+    return initialized;
+}
+
+/**
+ * @brief Initialize a timer that is not armed.  Must be called once before
+ * the timer is armed for the first time.
+ *
+ * @param[out] timer    Timer to initialize
+ * @param[in]  callback Called from TimerWheel_Advance when the timer expires
+ * @param[in]  context  Context passed to the callback
+ ******************************************************************************/
+void TimerWheel_InitTimer(TimerWheel_Timer_t *const timer, void (*const callback)(void *const context), void *const context)
+{
+    if (timer != NULL)
+    {
+        timer->Next = NULL;
+        timer->Previous = NULL;
+        timer->Callback = callback;
+        timer->Context = context;
+        timer->ExpiryTick = 0U;
+        timer->Level = 0U;
+        timer->Slot = 0U;
+        timer->Armed = false;
+    }
+}
+
+/**
+ * @brief Arm a timer to expire at a time, rounded up to a tick.  A timer
+ * already armed is moved to the new time.  A time that has already passed
+ * expires in the next tick.
+ *
+ * @param[in,out] wheel  Wheel to arm the timer in
+ * @param[in,out] timer  Timer to arm, must stay valid until it expires or is
+ *                       cancelled
+ * @param[in]     expiry Time at which the timer expires
+ *
+ * @return Whether the timer was armed or not
+ ******************************************************************************/
+bool TimerWheel_Arm(TimerWheel_t *const wheel, TimerWheel_Timer_t *const timer, const TimerWheel_TimeUs_t expiry)
+{
+    bool armed = false;
+
+    if (wheel != NULL && timer != NULL)
+    {
+        if (timer->Armed)
+        {
+            TimerWheel_Unlink(wheel, timer);
+            wheel->Count--;
+            wheel->Stats.Cancelled++;
+        }
+
+        /* Round up so the timer never expires early */
+        timer->ExpiryTick = (expiry / wheel->TickUs) + (((expiry % wheel->TickUs) != 0U) ? 1U : 0U);
+        if (timer->ExpiryTick <= wheel->Tick)
+        {
+            timer->ExpiryTick = wheel->Tick + 1U;
+        }
+
+        TimerWheel_Place(wheel, timer);
+        timer->Armed = true;
+        wheel->Count++;
+        wheel->Stats.Armed++;
+        armed = true;
+    }
+
+    return armed;
+}
+
+/**
+ * @brief Cancel a timer so it does not expire.
+ *
+ * @param[in,out] wheel Wheel the timer is armed in
+ * @param[in,out] timer Timer to cancel
+ *
+ * @return Whether the timer was armed or not
+ ******************************************************************************/
+bool TimerWheel_Cancel(TimerWheel_t *const wheel, TimerWheel_Timer_t *const timer)
+{
+    bool cancelled = false;
+
+    if (wheel != NULL && timer != NULL && timer->Armed)
+    {
+        TimerWheel_Unlink(wheel, timer);
+        timer->Armed = false;
+        wheel->Count--;
+        wheel->Stats.Cancelled++;
+        cancelled = true;
+    }
+
+    return cancelled;
+}
+
+/**
+ * @brief Advance the wheel to the current time, calling the callback of every
+ * timer due by then, in order of their ticks.  Ticks in which no timer is due
+ * or moves down a level are skipped.
+ *
+ * @param[in,out] wheel Wheel to advance
+ * @param[in]     now   Current time
+ *
+ * @return Number of timers expired
+ ******************************************************************************/
+uint32_t TimerWheel_Advance(TimerWheel_t *const wheel, const TimerWheel_TimeUs_t now)
+{
+    uint64_t targetTick;
+    uint64_t nextTick;
+    uint32_t expired = 0U;
+
+    if (wheel != NULL)
+    {
+        targetTick = now / wheel->TickUs;
+
+        nextTick = TimerWheel_GetNextTick(wheel);
+        while (nextTick <= targetTick)
+        {
+            wheel->Tick = nextTick;
+            expired += TimerWheel_RunTick(wheel);
+            nextTick = TimerWheel_GetNextTick(wheel);
+        }
+
+        if (targetTick > wheel->Tick)
+        {
+            wheel->Tick = targetTick;
+        }
+    }
+
+    return expired;
+}
+
+/**
+ * @brief Get the time the wheel next needs to be advanced.  No timer expires
+ * before it, and one expires at it unless a timer only moves down a level
+ * then, so a client sleeping until then never misses a timer.
+ *
+ * @param[in] wheel Wheel to check
+ *
+ * @return Time the wheel next needs to be advanced, TIMERWHEEL_NEVER if no
+ * timers are armed
+ ******************************************************************************/
+TimerWheel_TimeUs_t TimerWheel_GetNextExpiry(const TimerWheel_t *const wheel)
+{
+    TimerWheel_TimeUs_t expiry = TIMERWHEEL_NEVER;
+
+    if (wheel != NULL && wheel->Count > 0U)
+    {
+        expiry = TimerWheel_GetNextTick(wheel) * wheel->TickUs;
+    }
+
+    return expiry;
+}
+
+/**
+ * @brief Put a timer in the slot of the highest level in which its expiry
+ * differs from the current tick, or in the overflow list if it differs above
+ * every level.  Its slot is always ahead of the current tick in that level.
+ *
+ * @param[in,out] wheel Wheel to put the timer in
+ * @param[in,out] timer Timer to put in the wheel, not in any slot
+ ******************************************************************************/
+static void TimerWheel_Place(TimerWheel_t *const wheel, TimerWheel_Timer_t *const timer)
+{
+    uint64_t difference = timer->ExpiryTick ^ wheel->Tick;
+    TimerWheel_Timer_t **first = &wheel->Overflow;
+    uint32_t level = TIMERWHEEL_LEVELS;
+
+    timer->Slot = 0U;
+    if ((difference >> TIMERWHEEL_SPAN_BITS) == 0U)
+    {
+        /* A timer due in the current tick goes in the lowest level, in the slot about to expire */
+        level = (difference == 0U) ? 0U : ((TIMERWHEEL_TICK_BITS - 1U - (uint32_t)__builtin_clzll(difference)) / TIMERWHEEL_SLOT_BITS);
+        timer->Slot = (uint8_t)((timer->ExpiryTick >> (level * TIMERWHEEL_SLOT_BITS)) & TIMERWHEEL_SLOT_MASK);
+        first = &wheel->Slots[level][timer->Slot];
+        wheel->Occupied[level] |= (1ULL << timer->Slot);
+    }
+
+    timer->Level = (uint8_t)level;
+    timer->Previous = NULL;
+    timer->Next = *first;
+    if (*first != NULL)
+    {
+        (*first)->Previous = timer;
+    }
+    *first = timer;
+}
+
+/**
+ * @brief Take a timer out of its slot.
+ *
+ * @param[in,out] wheel Wheel the timer is in
+ * @param[in,out] timer Timer to take out, in a slot of the wheel
+ ******************************************************************************/
+static void TimerWheel_Unlink(TimerWheel_t *const wheel, TimerWheel_Timer_t *const timer)
+{
+    TimerWheel_Timer_t **first = (timer->Level < TIMERWHEEL_LEVELS) ? &wheel->Slots[timer->Level][timer->Slot] : &wheel->Overflow;
+
+    if (timer->Previous != NULL)
+    {
+        timer->Previous->Next = timer->Next;
+    }
+    else
+    {
+        *first = timer->Next;
+    }
+    if (timer->Next != NULL)
+    {
+        timer->Next->Previous = timer->Previous;
+    }
+
+    if (*first == NULL && timer->Level < TIMERWHEEL_LEVELS)
+    {
+        wheel->Occupied[timer->Level] &= ~(1ULL << timer->Slot);
+    }
+
+    timer->Next = NULL;
+    timer->Previous = NULL;
+}
+
+/**
+ * @brief Put every timer of a list taken out of a slot back in the wheel,
+ * relative to the current tick, which moves them down at least a level.
+ *
+ * @param[in,out] wheel Wheel to put the timers in
+ * @param[in]     timer First timer of the list, NULL if empty
+ ******************************************************************************/
+static void TimerWheel_Replace(TimerWheel_t *const wheel, TimerWheel_Timer_t *timer)
+{
+    TimerWheel_Timer_t *next;
+
+    while (timer != NULL)
+    {
+        next = timer->Next;
+        TimerWheel_Place(wheel, timer);
+        wheel->Stats.Cascaded++;
+        timer = next;
+    }
+}
+
+/**
+ * @brief Get the next tick in which a timer expires or moves down a level,
+ * the earliest start of an occupied slot of any level.  Occupied slots are
+ * always ahead of the current tick, so each level takes a single bitmap scan.
+ *
+ * @param[in] wheel Wheel to check
+ *
+ * @return Next tick the wheel needs to run, UINT64_MAX if no timers are armed
+ ******************************************************************************/
+static uint64_t TimerWheel_GetNextTick(const TimerWheel_t *const wheel)
+{
+    uint64_t nextTick = UINT64_MAX;
+    uint64_t slotTick;
+    uint32_t shift;
+
+    for (uint32_t level = 0U; level < TIMERWHEEL_LEVELS; level++)
+    {
+        if (wheel->Occupied[level] != 0U)
+        {
+            shift = level * TIMERWHEEL_SLOT_BITS;
+            slotTick = ((wheel->Tick >> (shift + TIMERWHEEL_SLOT_BITS)) << (shift + TIMERWHEEL_SLOT_BITS)) + ((uint64_t)__builtin_ctzll(wheel->Occupied[level]) << shift);
+            if (slotTick < nextTick)
+            {
+                nextTick = slotTick;
+            }
+        }
+    }
+
+    /* The overflow list is sorted into the wheel when the highest level wraps around */
+    if (wheel->Overflow != NULL)
+    {
+        slotTick = ((wheel->Tick >> TIMERWHEEL_SPAN_BITS) + 1U) << TIMERWHEEL_SPAN_BITS;
+        if (slotTick < nextTick)
+        {
+            nextTick = slotTick;
+        }
+    }
+
+    return nextTick;
+}
+
+/**
+ * @brief Run the current tick.  Moves down the timers of every slot starting
+ * in the tick, highest level first so a timer can fall through several levels
+ * at once, then expires the timers due in the tick.
+ *
+ * @param[in,out] wheel Wheel to run
+ *
+ * @return Number of timers expired
+ ******************************************************************************/
+static uint32_t TimerWheel_RunTick(TimerWheel_t *const wheel)
+{
+    TimerWheel_Timer_t *timer;
+    uint32_t shift;
+    uint32_t slot;
+    uint32_t expired = 0U;
+
+    if ((wheel->Tick & ((1ULL << TIMERWHEEL_SPAN_BITS) - 1U)) == 0U)
+    {
+        timer = wheel->Overflow;
+        wheel->Overflow = NULL;
+        TimerWheel_Replace(wheel, timer);
+    }
+
+    for (uint32_t level = TIMERWHEEL_LEVELS - 1U; level > 0U; level--)
+    {
+        shift = level * TIMERWHEEL_SLOT_BITS;
+        if ((wheel->Tick & ((1ULL << shift) - 1U)) == 0U)
+        {
+            slot = (uint32_t)(wheel->Tick >> shift) & TIMERWHEEL_SLOT_MASK;
+            timer = wheel->Slots[level][slot];
+            wheel->Slots[level][slot] = NULL;
+            wheel->Occupied[level] &= ~(1ULL << slot);
+            TimerWheel_Replace(wheel, timer);
+        }
+    }
+
+    /* Callbacks arming timers put them in later ticks, so the slot drains */
+    slot = (uint32_t)wheel->Tick & TIMERWHEEL_SLOT_MASK;
+    while (wheel->Slots[0U][slot] != NULL)
+    {
+        timer = wheel->Slots[0U][slot];
+        TimerWheel_Unlink(wheel, timer);
+        timer->Armed = false;
+        wheel->Count--;
+        wheel->Stats.Expired++;
+        expired++;
+
+        if (timer->Callback != NULL)
+        {
+            timer->Callback(timer->Context);
+        }
+    }
+
+    return expired;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file TimerWheel.h
+ *
+ * @brief Hierarchical timing wheel for game deadlines and effect timers.
+ * Arming and cancelling a timer are O(1) no matter how many timers are armed,
+ * and advancing the wheel costs O(1) per expired timer plus a few bitmap scans
+ * per level, however long the wheel was left idle.
+ *
+ * Time is counted in ticks of a width chosen at initialization.  Each of the
+ * levels has 64 slots, each slot of a level spanning 64 times the ticks of a
+ * slot of the level below.  A timer is kept in the slot of the highest level
+ * in which its expiry differs from the current tick, and is moved down a level
+ * when the wheel reaches the start of its slot, until it expires from the
+ * lowest level in the tick it is due.  Timers further out than the wheel spans
+ * wait in an overflow list, which is sorted into the wheel every time the
+ * highest level wraps around.
+ *
+ * Timers are intrusive, the client owns their storage, so the wheel never
+ * allocates.  A timer never expires before its expiry time, and expires in
+ * the first call to TimerWheel_Advance reaching the tick it is due.  Timers
+ * expiring in the same tick expire in no particular order.  Expiry callbacks
+ * may arm and cancel any timer, including the one expiring.
+ *
+ * A wheel is not thread safe.  Clients arming timers from a different task
+ * than the one advancing the wheel must hold a lock around each call.
+ *
+ ******************************************************************************/
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define TIMERWHEEL_LEVELS 4U        /* Number of levels of the wheel */
+#define TIMERWHEEL_SLOT_BITS 6U     /* Number of bits of a tick selecting the slot of a level */
+#define TIMERWHEEL_SLOTS 64U        /* Number of slots of each level, one per bit of a level's bitmap */
+#define TIMERWHEEL_NEVER UINT64_MAX /* Expiry of a wheel with no timers armed */
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef uint64_t TimerWheel_TimeUs_t; /* Time in microseconds from a monotonic clock */
+
+typedef struct TimerWheel_Timer_s TimerWheel_Timer_t;
+
+/* Timer armed in a wheel */
+struct TimerWheel_Timer_s
+{
+    TimerWheel_Timer_t *Next;              /* Next timer in the same slot */
+    TimerWheel_Timer_t *Previous;          /* Previous timer in the same slot, NULL if first */
+    void (*Callback)(void *const context); /* Called when the timer expires */
+    void *Context;                         /* Context passed to Callback */
+    uint64_t ExpiryTick;                   /* Tick in which the timer expires */
+    uint8_t Level;                         /* Level of the slot the timer is in, TIMERWHEEL_LEVELS for the overflow list */
+    uint8_t Slot;                          /* Slot of the level the timer is in */
+    bool Armed;                            /* Whether the timer is armed or not */
+};
+
+/* Timers armed, cancelled and expired */
+typedef struct
+{
+    uint32_t Armed;     /* Number of times a timer was armed */
+    uint32_t Cancelled; /* Number of armed timers cancelled, including by arming them again */
+    uint32_t Expired;   /* Number of timers expired */
+    uint32_t Cascaded;  /* Number of times a timer was moved down a level or out of the overflow list */
+} TimerWheel_Stats_t;
+
+/* Hierarchical timing wheel */
+typedef struct
+{
+    TimerWheel_Timer_t *Slots[TIMERWHEEL_LEVELS][TIMERWHEEL_SLOTS]; /* First timer in each slot of each level */
+    uint64_t Occupied[TIMERWHEEL_LEVELS];                           /* Bitmap of the slots of each level holding timers */
+    TimerWheel_Timer_t *Overflow;                                   /* First timer further out than the wheel spans */
+    uint64_t Tick;                                                  /* Last tick the wheel was advanced through */
+    uint32_t TickUs;                                                /* Width of a tick */
+    uint32_t Count;                                                 /* Number of timers armed */
+    TimerWheel_Stats_t Stats;                                       /* Timers armed, cancelled and expired */
+} TimerWheel_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+bool TimerWheel_Init(TimerWheel_t *const wheel, const uint32_t tickUs, const TimerWheel_TimeUs_t now);
+void TimerWheel_InitTimer(TimerWheel_Timer_t *const timer, void (*const callback)(void *const context), void *const context);
+bool TimerWheel_Arm(TimerWheel_t *const wheel, TimerWheel_Timer_t *const timer, const TimerWheel_TimeUs_t expiry);
+bool TimerWheel_Cancel(TimerWheel_t *const wheel, TimerWheel_Timer_t *const timer);
+uint32_t TimerWheel_Advance(TimerWheel_t *const wheel, const TimerWheel_TimeUs_t now);
+TimerWheel_TimeUs_t TimerWheel_GetNextExpiry(const TimerWheel_t *const wheel);
+
+#endif
@@ -0,0 +1,482 @@
+/**
+ * @file AudioPackBenchmark.c
+ *
+ * @brief Benchmark of streaming clips from an AudioPack image the way the
+ * audio task streams the prompts partition.  Synthesizes clips of random
+ * lengths into an image file, memory maps it and streams every clip in chunks
+ * of random sizes into a WAV file, checking that each chunk points into the
+ * mapping at the expected samples, so no clip is ever copied.  The WAV file
+ * is then read back and compared with the synthesized clips.  Also checks
+ * that corrupted images are rejected when opened.
+ *
+ * Reports the time from requesting a clip to its first chunk and the rate at
+ * which samples are streamed.  Exits with a failure status if a chunk is not
+ * in place, the WAV file differs from the clips or a corrupted image is
+ * opened.
+ *
+ * Usage: AudioPackBenchmark [clips] [seed]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "AudioPack.h"
+#include "Benchmark.h"
+#include "MappedFile.h"
+#include "Prng.h"
+#include "Wav.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define AUDIOPACKBENCHMARK_DEFAULT_CLIPS 64U       /* Number of clips if not specified */
+#define AUDIOPACKBENCHMARK_MAX_CLIPS 1024U         /* Most clips, so the image stays well below 4 GiB */
+#define AUDIOPACKBENCHMARK_DEFAULT_SEED 1U         /* Seed of the clips and chunk sizes if not specified */
+#define AUDIOPACKBENCHMARK_SAMPLE_RATE 16000U      /* Sample rate of the clips in Hz */
+#define AUDIOPACKBENCHMARK_MAX_CLIP_SAMPLES 32000U /* Longest clip, two seconds */
+#define AUDIOPACKBENCHMARK_MAX_CHUNK_SAMPLES 480U  /* Largest chunk streamed, twice the I2S DMA buffer size */
+#define AUDIOPACKBENCHMARK_TONE_STEP_BASE 64U      /* Smallest step of the sawtooth tone of a clip */
+#define AUDIOPACKBENCHMARK_TONE_STEP_RANGE 1024U   /* Range of the steps of the sawtooth tones */
+#define AUDIOPACKBENCHMARK_WAV_SUFFIX ".wav"       /* Suffix of the WAV file, added to the path of the image */
+#define AUDIOPACKBENCHMARK_PATH_SIZE 64U           /* Size of a buffer for the path of a temporary file */
+#define AUDIOPACKBENCHMARK_VERSION_OFFSET 4U       /* Offset of the version in the header */
+#define AUDIOPACKBENCHMARK_SAMPLE_RATE_OFFSET 8U   /* Offset of the sample rate in the header */
+#define AUDIOPACKBENCHMARK_ENTRY_OFFSET_OFFSET 0U  /* Offset of the offset of the samples in an entry */
+#define AUDIOPACKBENCHMARK_ENTRY_COUNT_OFFSET 4U   /* Offset of the number of samples in an entry */
+#define AUDIOPACKBENCHMARK_NS_PER_S 1000000000.0   /* Nanoseconds per second */
+
+/* Template of the path of the temporary image file */
+#define AUDIOPACKBENCHMARK_PACK_TEMPLATE "/tmp/AudioPackBenchmarkXXXXXX"
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Ways of corrupting an image */
+typedef enum
+{
+    AUDIOPACKBENCHMARK_CORRUPT_FLIP,     /* Flip bits of a byte */
+    AUDIOPACKBENCHMARK_CORRUPT_ZERO,     /* Zero a 32 bit field */
+    AUDIOPACKBENCHMARK_CORRUPT_TRUNCATE, /* Cut the image short */
+} AudioPackBenchmark_CorruptionKind_t;
+
+/* Corruption of an image that must be rejected when opened */
+typedef struct
+{
+    const char *Name;                         /* Description of the corruption */
+    AudioPackBenchmark_CorruptionKind_t Kind; /* How the image is corrupted */
+    bool Entry;                               /* Whether Offset is relative to the entry of the last clip, or else to the start of the image or, when truncating, its end */
+    uint32_t Offset;                          /* Offset of the byte or field to change, or where to cut the image */
+    uint8_t Xor;                              /* Bits to flip */
+} AudioPackBenchmark_Corruption_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static uint8_t *AudioPackBenchmark_Synthesize(const uint32_t clipCount, const uint32_t seed, uint32_t *const size);
+static int AudioPackBenchmark_Stream(const char *const packPath, const char *const wavPath, const uint32_t size, const uint32_t seed);
+static int AudioPackBenchmark_Compare(const char *const wavPath, const uint8_t *const image, const uint32_t size);
+static int AudioPackBenchmark_Corrupt(const uint8_t *const image, const uint32_t size);
+static int AudioPackBenchmark_CompareNs(const void *a, const void *b);
+
+/* Globals
+ ******************************************************************************/
+
+/* Corruptions of a valid image, each on its own copy of the image */
+static const AudioPackBenchmark_Corruption_t AudioPackBenchmark_Corruptions[] = {
+    {.Name = "bad magic", .Kind = AUDIOPACKBENCHMARK_CORRUPT_FLIP, .Entry = false, .Offset = 0U, .Xor = 0x01U},
+    {.Name = "bad version", .Kind = AUDIOPACKBENCHMARK_CORRUPT_FLIP, .Entry = false, .Offset = AUDIOPACKBENCHMARK_VERSION_OFFSET, .Xor = 0x02U},
+    {.Name = "zero sample rate", .Kind = AUDIOPACKBENCHMARK_CORRUPT_ZERO, .Entry = false, .Offset = AUDIOPACKBENCHMARK_SAMPLE_RATE_OFFSET, .Xor = 0U},
+    {.Name = "index cut short", .Kind = AUDIOPACKBENCHMARK_CORRUPT_TRUNCATE, .Entry = true, .Offset = AUDIOPACK_ENTRY_SIZE - 1U, .Xor = 0U},
+    {.Name = "samples cut short", .Kind = AUDIOPACKBENCHMARK_CORRUPT_TRUNCATE, .Entry = false, .Offset = 1U, .Xor = 0U},
+    {.Name = "odd offset", .Kind = AUDIOPACKBENCHMARK_CORRUPT_FLIP, .Entry = true, .Offset = AUDIOPACKBENCHMARK_ENTRY_OFFSET_OFFSET, .Xor = 0x01U},
+    {.Name = "offset past end", .Kind = AUDIOPACKBENCHMARK_CORRUPT_FLIP, .Entry = true, .Offset = AUDIOPACKBENCHMARK_ENTRY_OFFSET_OFFSET + 3U, .Xor = 0x80U},
+    {.Name = "offset inside index", .Kind = AUDIOPACKBENCHMARK_CORRUPT_ZERO, .Entry = true, .Offset = AUDIOPACKBENCHMARK_ENTRY_OFFSET_OFFSET, .Xor = 0U},
+    {.Name = "clip past end", .Kind = AUDIOPACKBENCHMARK_CORRUPT_FLIP, .Entry = true, .Offset = AUDIOPACKBENCHMARK_ENTRY_COUNT_OFFSET + 3U, .Xor = 0x10U},
+};
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t clipCount = AUDIOPACKBENCHMARK_DEFAULT_CLIPS;
+    uint32_t seed = AUDIOPACKBENCHMARK_DEFAULT_SEED;
+    char packPath[AUDIOPACKBENCHMARK_PATH_SIZE] = AUDIOPACKBENCHMARK_PACK_TEMPLATE;
+    char wavPath[AUDIOPACKBENCHMARK_PATH_SIZE];
+    uint8_t *image;
+    uint32_t size = 0U;
+    FILE *packFile = NULL;
+    int descriptor;
+    int wavPathLength;
+    int status = EXIT_FAILURE;
+
+    if (argc > 1)
+    {
+        clipCount = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        seed = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (clipCount == 0U || clipCount > AUDIOPACKBENCHMARK_MAX_CLIPS)
+    {
+        clipCount = AUDIOPACKBENCHMARK_DEFAULT_CLIPS;
+    }
+
+    printf("AudioPack benchmark: %" PRIu32 " clips, seed %" PRIu32 "\n", clipCount, seed);
+
+    image = AudioPackBenchmark_Synthesize(clipCount, seed, &size);
+    descriptor = mkstemp(packPath);
+    if (descriptor >= 0)
+    {
+        packFile = fdopen(descriptor, "wb");
+    }
+
+    if (image == NULL || packFile == NULL)
+    {
+        printf("Failed to create the image\n");
+        if (packFile != NULL)
+        {
+            fclose(packFile);
+        }
+    }
+    else if (fwrite(image, size, 1U, packFile) != 1U || fclose(packFile) != 0)
+    {
+        printf("Failed to write the image to %s\n", packPath);
+    }
+    else
+    {
+        printf("  Image: %s, %" PRIu32 " bytes\n", packPath, size);
+        wavPathLength = snprintf(wavPath, sizeof(wavPath), "%s%s", packPath, AUDIOPACKBENCHMARK_WAV_SUFFIX);
+
+        if (wavPathLength < 0 || (size_t)wavPathLength >= sizeof(wavPath))
+        {
+            printf("Failed to name the WAV output after %s, the path is too long\n", packPath);
+        }
+        else
+        {
+            status = EXIT_SUCCESS;
+            if (AudioPackBenchmark_Stream(packPath, wavPath, size, seed) != EXIT_SUCCESS)
+            {
+                status = EXIT_FAILURE;
+            }
+            if (AudioPackBenchmark_Compare(wavPath, image, size) != EXIT_SUCCESS)
+            {
+                status = EXIT_FAILURE;
+            }
+            if (AudioPackBenchmark_Corrupt(image, size) != EXIT_SUCCESS)
+            {
+                status = EXIT_FAILURE;
+            }
+
+            remove(wavPath);
+        }
+    }
+
+    if (descriptor >= 0)
+    {
+        remove(packPath);
+    }
+    free(image);
+
+    return status;
+}
+
+/**
+ * @brief Synthesize an image of clips of random lengths, each a sawtooth tone
+ * of its own pitch.
+ *
+ * @param[in]  clipCount Number of clips
+ * @param[in]  seed      Seed of the lengths and pitches of the clips
+ * @param[out] size      Size of the image in bytes
+ *
+ * @return Image allocated with malloc, NULL if it could not be allocated
+ ******************************************************************************/
+static uint8_t *AudioPackBenchmark_Synthesize(const uint32_t clipCount, const uint32_t seed, uint32_t *const size)
+{
+    Prng_t prng;
+    uint32_t *sampleCounts = malloc(clipCount * sizeof(uint32_t));
+    uint32_t indexSize = AUDIOPACK_HEADER_SIZE + (clipCount * AUDIOPACK_ENTRY_SIZE);
+    uint8_t *image = NULL;
+    int16_t *samples;
+    uint32_t step;
+
+    Prng_Seed(&prng, seed, 0U);
+
+    if (sampleCounts != NULL)
+    {
+        for (uint32_t clip = 0U; clip < clipCount; clip++)
+        {
+            sampleCounts[clip] = Prng_Bounded(&prng, AUDIOPACKBENCHMARK_MAX_CLIP_SAMPLES + 1U);
+        }
+
+        /* The samples follow the index, so the image is sized before the index is written into it */
+        *size = indexSize;
+        for (uint32_t clip = 0U; clip < clipCount; clip++)
+        {
+            *size += sampleCounts[clip] * (uint32_t)sizeof(int16_t);
+        }
+        image = malloc(*size);
+    }
+
+    if (image != NULL && AudioPack_WriteIndex(image, AUDIOPACKBENCHMARK_SAMPLE_RATE, clipCount, sampleCounts) == *size)
+    {
+        samples = (int16_t *)(void *)&image[indexSize];
+        for (uint32_t clip = 0U; clip < clipCount; clip++)
+        {
+            step = AUDIOPACKBENCHMARK_TONE_STEP_BASE + Prng_Bounded(&prng, AUDIOPACKBENCHMARK_TONE_STEP_RANGE);
+            for (uint32_t sample = 0U; sample < sampleCounts[clip]; sample++)
+            {
+                samples[sample] = (int16_t)(uint16_t)(sample * step);
+            }
+            samples += sampleCounts[clip];
+        }
+    }
+    else
+    {
+        free(image);
+        image = NULL;
+    }
+
+    free(sampleCounts);
+
+    return image;
+}
+
+/**
+ * @brief Map the image file and stream every clip in chunks of random sizes
+ * into a WAV file, checking that each chunk is in place in the mapping.
+ * Reports the time from requesting a clip to its first chunk and the rate at
+ * which samples are streamed.
+ *
+ * @param[in] packPath Path of the image file
+ * @param[in] wavPath  Path of the WAV file to write
+ * @param[in] size     Size of the image in bytes
+ * @param[in] seed     Seed of the chunk sizes
+ *
+ * @return EXIT_SUCCESS if every chunk was in place and written, EXIT_FAILURE
+ * otherwise
+ ******************************************************************************/
+static int AudioPackBenchmark_Stream(const char *const packPath, const char *const wavPath, const uint32_t size, const uint32_t seed)
+{
+    MappedFile_t packFile;
+    AudioPack_t pack;
+    AudioPack_Clip_t clip;
+    AudioPack_Stream_t stream;
+    Wav_Writer_t writer;
+    Prng_t prng;
+    const int16_t *samples;
+    const uint8_t *expected;
+    uint32_t sampleCount;
+    uint32_t misplaced = 0U;
+    uint64_t totalSamples = 0U;
+    Benchmark_TimeNs_t *firstChunkNs;
+    Benchmark_TimeNs_t startNs;
+    Benchmark_TimeNs_t requestNs;
+    Benchmark_TimeNs_t totalNs;
+    int status = EXIT_FAILURE;
+
+    Prng_Seed(&prng, seed, 1U);
+
+    if (!MappedFile_Open(&packFile, packPath) || packFile.Size != size || !AudioPack_Open(&pack, packFile.Data, size))
+    {
+        printf("  Failed to map and open %s\n", packPath);
+        return EXIT_FAILURE;
+    }
+
+    firstChunkNs = malloc(pack.ClipCount * sizeof(Benchmark_TimeNs_t));
+    if (firstChunkNs == NULL || !Wav_Create(&writer, wavPath, pack.SampleRate))
+    {
+        printf("  Failed to create %s\n", wavPath);
+        free(firstChunkNs);
+        MappedFile_Close(&packFile);
+        return EXIT_FAILURE;
+    }
+
+    status = EXIT_SUCCESS;
+    startNs = Benchmark_GetTimeNs();
+    for (uint32_t clipIndex = 0U; clipIndex < pack.ClipCount; clipIndex++)
+    {
+        requestNs = Benchmark_GetTimeNs();
+        firstChunkNs[clipIndex] = 0U;
+        (void)AudioPack_GetClip(&pack, clipIndex, &clip);
+        AudioPack_StreamStart(&stream, &clip);
+        expected = (const uint8_t *)clip.Samples;
+
+        while ((sampleCount = AudioPack_StreamNext(&stream, 1U + Prng_Bounded(&prng, AUDIOPACKBENCHMARK_MAX_CHUNK_SAMPLES), &samples)) > 0U)
+        {
+            if ((const uint8_t *)samples != expected || (const uint8_t *)&samples[sampleCount] > (const uint8_t *)packFile.Data + size)
+            {
+                misplaced++;
+            }
+            if (!Wav_Write(&writer, samples, sampleCount))
+            {
+                status = EXIT_FAILURE;
+            }
+            if (firstChunkNs[clipIndex] == 0U)
+            {
+                firstChunkNs[clipIndex] = Benchmark_GetTimeNs() - requestNs;
+            }
+
+            expected += sampleCount * sizeof(int16_t);
+            totalSamples += sampleCount;
+        }
+    }
+    totalNs = Benchmark_GetTimeNs() - startNs;
+
+    if (!Wav_Close(&writer))
+    {
+        status = EXIT_FAILURE;
+    }
+
+    qsort(firstChunkNs, pack.ClipCount, sizeof(Benchmark_TimeNs_t), AudioPackBenchmark_CompareNs);
+    printf("  Request to first chunk: median %" PRIu64 " ns, max %" PRIu64 " ns (first touch of each clip's pages, no copy)\n", firstChunkNs[pack.ClipCount / 2U], firstChunkNs[pack.ClipCount - 1U]);
+    printf("  Streamed %" PRIu64 " samples in %.3f ms, %.1f Msamples/s, %.0fx real time\n", totalSamples, (double)totalNs / 1e6, (double)totalSamples * 1e3 / (double)totalNs,
+           ((double)totalSamples / AUDIOPACKBENCHMARK_SAMPLE_RATE) / ((double)totalNs / AUDIOPACKBENCHMARK_NS_PER_S));
+
+    if (misplaced > 0U)
+    {
+        printf("  FAIL: %" PRIu32 " chunks not in place in the mapping\n", misplaced);
+        status = EXIT_FAILURE;
+    }
+    if (status != EXIT_SUCCESS)
+    {
+        printf("  FAIL: streaming into %s failed\n", wavPath);
+    }
+
+    free(firstChunkNs);
+    MappedFile_Close(&packFile);
+
+    return status;
+}
+
+/**
+ * @brief Read back the WAV file streamed from the image and compare it with
+ * the samples of every clip, which follow the index one after another.
+ *
+ * @param[in] wavPath Path of the WAV file
+ * @param[in] image   Image the clips were streamed from
+ * @param[in] size    Size of the image in bytes
+ *
+ * @return EXIT_SUCCESS if the WAV file holds exactly the clips, EXIT_FAILURE
+ * otherwise
+ ******************************************************************************/
+static int AudioPackBenchmark_Compare(const char *const wavPath, const uint8_t *const image, const uint32_t size)
+{
+    AudioPack_t pack;
+    int16_t *samples = NULL;
+    uint32_t sampleCount = 0U;
+    uint32_t sampleRate = 0U;
+    uint32_t indexSize;
+    int status = EXIT_FAILURE;
+
+    if (!AudioPack_Open(&pack, image, size) || !Wav_Read(wavPath, &samples, &sampleCount, &sampleRate))
+    {
+        printf("  FAIL: could not read back %s\n", wavPath);
+    }
+    else
+    {
+        indexSize = AUDIOPACK_HEADER_SIZE + (pack.ClipCount * AUDIOPACK_ENTRY_SIZE);
+        if (sampleRate != pack.SampleRate || ((uint64_t)sampleCount * sizeof(int16_t)) != (size - indexSize) || memcmp(samples, &image[indexSize], size - indexSize) != 0)
+        {
+            printf("  FAIL: %s differs from the clips, %" PRIu32 " samples at %" PRIu32 " Hz\n", wavPath, sampleCount, sampleRate);
+        }
+        else
+        {
+            printf("  WAV output matches the clips, %" PRIu32 " samples\n", sampleCount);
+            status = EXIT_SUCCESS;
+        }
+    }
+
+    free(samples);
+
+    return status;
+}
+
+/**
+ * @brief Apply each corruption to a copy of a valid image and check that it
+ * is rejected when opened.
+ *
+ * @param[in] image Valid image with at least one clip
+ * @param[in] size  Size of the image in bytes
+ *
+ * @return EXIT_SUCCESS if every corrupted image was rejected, EXIT_FAILURE
+ * otherwise
+ ******************************************************************************/
+static int AudioPackBenchmark_Corrupt(const uint8_t *const image, const uint32_t size)
+{
+    const AudioPackBenchmark_Corruption_t *corruption;
+    AudioPack_t pack;
+    uint8_t *copy = malloc(size);
+    uint32_t lastEntry;
+    uint32_t offset;
+    uint32_t copySize;
+    uint32_t rejected = 0U;
+    uint32_t corruptionCount = sizeof(AudioPackBenchmark_Corruptions) / sizeof(AudioPackBenchmark_Corruptions[0U]);
+    int status = EXIT_FAILURE;
+
+    if (copy != NULL && AudioPack_Open(&pack, image, size))
+    {
+        lastEntry = AUDIOPACK_HEADER_SIZE + ((pack.ClipCount - 1U) * AUDIOPACK_ENTRY_SIZE);
+
+        for (uint32_t corruptionIndex = 0U; corruptionIndex < corruptionCount; corruptionIndex++)
+        {
+            corruption = &AudioPackBenchmark_Corruptions[corruptionIndex];
+            memcpy(copy, image, size);
+            copySize = size;
+            offset = corruption->Offset + (corruption->Entry ? lastEntry : 0U);
+
+            switch (corruption->Kind)
+            {
+            case AUDIOPACKBENCHMARK_CORRUPT_FLIP:
+                copy[offset] ^= corruption->Xor;
+                break;
+            case AUDIOPACKBENCHMARK_CORRUPT_ZERO:
+                memset(&copy[offset], 0, sizeof(uint32_t));
+                break;
+            case AUDIOPACKBENCHMARK_CORRUPT_TRUNCATE:
+                copySize = corruption->Entry ? offset : (size - corruption->Offset);
+                break;
+            default:
+                break;
+            }
+
+            if (AudioPack_Open(&pack, copy, copySize))
+            {
+                printf("  FAIL: image with %s was opened\n", corruption->Name);
+            }
+            else
+            {
+                rejected++;
+            }
+        }
+
+        printf("  Corrupted images rejected: %" PRIu32 "/%" PRIu32 "\n", rejected, corruptionCount);
+        status = (rejected == corruptionCount) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    free(copy);
+
+    return status;
+}
+
+/**
+ * @brief Compare two times for sorting in ascending order.
+ *
+ * @param[in] a First time
+ * @param[in] b Second time
+ *
+ * @return Negative if a is less than b, positive if greater, 0 if equal
+ ******************************************************************************/
+static int AudioPackBenchmark_CompareNs(const void *a, const void *b)
+{
+    const Benchmark_TimeNs_t timeA = *(const Benchmark_TimeNs_t *)a;
+    const Benchmark_TimeNs_t timeB = *(const Benchmark_TimeNs_t *)b;
+
+    return (timeA > timeB) - (timeA < timeB);
+}
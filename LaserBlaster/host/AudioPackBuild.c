@@ -0,0 +1,115 @@
+/**
+ * @file AudioPackBuild.c
+ *
+ * @brief Packs WAV files into an AudioPack image to be written to the prompts
+ * partition.  Clips are numbered in the order the files are given, and every
+ * file must be signed 16 bit mono PCM at the same sample rate.
+ *
+ * Exits with a failure status if a file cannot be read or the clips do not
+ * share a sample rate.
+ *
+ * Usage: AudioPackBuild <pack file> <wav file>...
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "AudioPack.h"
+#include "Wav.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define AUDIOPACKBUILD_FIRST_WAV_ARG 2 /* Index of the first WAV file in the arguments */
+#define AUDIOPACKBUILD_SAMPLE_SIZE 2U  /* Size of a sample in bytes */
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t clipCount;
+    int16_t **clips;
+    uint32_t *sampleCounts;
+    uint8_t *index;
+    uint32_t sampleRate = 0U;
+    uint32_t clipRate;
+    uint32_t size = 0U;
+    uint32_t loaded = 0U;
+    FILE *packFile;
+    int status = EXIT_FAILURE;
+
+    if (argc <= AUDIOPACKBUILD_FIRST_WAV_ARG)
+    {
+        printf("Usage: %s <pack file> <wav file>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    clipCount = (uint32_t)(argc - AUDIOPACKBUILD_FIRST_WAV_ARG);
+    if (clipCount > AUDIOPACK_MAX_CLIPS)
+    {
+        printf("At most %u clips can be packed\n", AUDIOPACK_MAX_CLIPS);
+        return EXIT_FAILURE;
+    }
+
+    clips = calloc(clipCount, sizeof(*clips));
+    sampleCounts = calloc(clipCount, sizeof(*sampleCounts));
+    index = malloc(AUDIOPACK_HEADER_SIZE + (clipCount * AUDIOPACK_ENTRY_SIZE));
+    if (clips == NULL || sampleCounts == NULL || index == NULL)
+    {
+        printf("Failed to allocate %" PRIu32 " clips\n", clipCount);
+        return EXIT_FAILURE;
+    }
+
+    while (loaded < clipCount && Wav_Read(argv[AUDIOPACKBUILD_FIRST_WAV_ARG + (int)loaded], &clips[loaded], &sampleCounts[loaded], &clipRate) && (loaded == 0U || clipRate == sampleRate))
+    {
+        sampleRate = clipRate;
+        printf("Clip %" PRIu32 ": %s, %" PRIu32 " samples\n", loaded, argv[AUDIOPACKBUILD_FIRST_WAV_ARG + (int)loaded], sampleCounts[loaded]);
+        loaded++;
+    }
+
+    if (loaded < clipCount)
+    {
+        printf("Failed to read %s, or its sample rate differs from %" PRIu32 " Hz\n", argv[AUDIOPACKBUILD_FIRST_WAV_ARG + (int)loaded], sampleRate);
+    }
+    else
+    {
+        size = AudioPack_WriteIndex(index, sampleRate, clipCount, sampleCounts);
+    }
+
+    packFile = (size > 0U) ? fopen(argv[1], "wb") : NULL;
+    if (packFile != NULL)
+    {
+        status = (fwrite(index, AUDIOPACK_HEADER_SIZE + (clipCount * AUDIOPACK_ENTRY_SIZE), 1U, packFile) == 1U) ? EXIT_SUCCESS : EXIT_FAILURE;
+        for (uint32_t clip = 0U; clip < clipCount; clip++)
+        {
+            if (fwrite(clips[clip], AUDIOPACKBUILD_SAMPLE_SIZE, sampleCounts[clip], packFile) != sampleCounts[clip])
+            {
+                status = EXIT_FAILURE;
+            }
+        }
+        if (fclose(packFile) != 0)
+        {
+            status = EXIT_FAILURE;
+        }
+
+        printf("Packed %" PRIu32 " clips at %" PRIu32 " Hz into %s, %" PRIu32 " bytes\n", clipCount, sampleRate, argv[1], size);
+    }
+    else if (size > 0U)
+    {
+        printf("Failed to create %s\n", argv[1]);
+    }
+
+    for (uint32_t clip = 0U; clip < clipCount; clip++)
+    {
+        free(clips[clip]);
+    }
+    free(clips);
+    free(sampleCounts);
+    free(index);
+
+    return status;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file AudioPackPlay.c
+ *
+ * @brief Plays clips of an AudioPack image into a WAV file the way the audio
+ * task streams them to I2S.  The image is memory mapped and opened in place,
+ * and each clip is written in chunks of the I2S DMA buffer size straight from
+ * the mapping.  Reports the time from requesting each clip to its first chunk
+ * being written.
+ *
+ * Plays every clip one after another unless a clip is given.  Exits with a
+ * failure status if the image is not valid or the WAV file cannot be written.
+ *
+ * Usage: AudioPackPlay <pack file> <wav file> [clip]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "AudioPack.h"
+#include "Benchmark.h"
+#include "MappedFile.h"
+#include "Wav.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define AUDIOPACKPLAY_CHUNK_SAMPLES 240U /* Samples per chunk, the I2S DMA buffer size of the audio task */
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    MappedFile_t packFile;
+    AudioPack_t pack;
+    AudioPack_Clip_t clip;
+    AudioPack_Stream_t stream;
+    Wav_Writer_t writer;
+    const int16_t *samples;
+    uint32_t sampleCount;
+    uint32_t firstClip = 0U;
+    uint32_t lastClip;
+    Benchmark_TimeNs_t requestNs;
+    bool written = true;
+    int status = EXIT_SUCCESS;
+
+    if (argc < 3)
+    {
+        printf("Usage: %s <pack file> <wav file> [clip]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!MappedFile_Open(&packFile, argv[1]))
+    {
+        printf("Failed to map %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    if (packFile.Size > UINT32_MAX || !AudioPack_Open(&pack, packFile.Data, (uint32_t)packFile.Size) || pack.ClipCount == 0U)
+    {
+        printf("%s is not a valid pack\n", argv[1]);
+        MappedFile_Close(&packFile);
+        return EXIT_FAILURE;
+    }
+
+    lastClip = pack.ClipCount - 1U;
+    if (argc > 3)
+    {
+        firstClip = (uint32_t)strtoul(argv[3], NULL, 0);
+        lastClip = firstClip;
+    }
+
+    if (!Wav_Create(&writer, argv[2], pack.SampleRate))
+    {
+        printf("Failed to create %s\n", argv[2]);
+        MappedFile_Close(&packFile);
+        return EXIT_FAILURE;
+    }
+
+    printf("%s: %" PRIu32 " clips at %" PRIu32 " Hz\n", argv[1], pack.ClipCount, pack.SampleRate);
+
+    for (uint32_t clipIndex = firstClip; clipIndex <= lastClip && status == EXIT_SUCCESS; clipIndex++)
+    {
+        requestNs = Benchmark_GetTimeNs();
+        if (AudioPack_GetClip(&pack, clipIndex, &clip))
+        {
+            AudioPack_StreamStart(&stream, &clip);
+            sampleCount = AudioPack_StreamNext(&stream, AUDIOPACKPLAY_CHUNK_SAMPLES, &samples);
+            if (sampleCount > 0U)
+            {
+                written = Wav_Write(&writer, samples, sampleCount) && written;
+                printf("Clip %" PRIu32 ": %" PRIu32 " samples, first chunk after %" PRIu64 " ns\n", clipIndex, clip.SampleCount, Benchmark_GetTimeNs() - requestNs);
+            }
+            else
+            {
+                printf("Clip %" PRIu32 ": empty\n", clipIndex);
+            }
+
+            while ((sampleCount = AudioPack_StreamNext(&stream, AUDIOPACKPLAY_CHUNK_SAMPLES, &samples)) > 0U)
+            {
+                written = Wav_Write(&writer, samples, sampleCount) && written;
+            }
+        }
+        else
+        {
+            printf("No clip %" PRIu32 "\n", clipIndex);
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if (!Wav_Close(&writer) || !written)
+    {
+        printf("Failed to write %s\n", argv[2]);
+        status = EXIT_FAILURE;
+    }
+
+    MappedFile_Close(&packFile);
+
+    return status;
+}
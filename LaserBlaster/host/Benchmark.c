@@ -0,0 +1,141 @@
+/**
+ * @file Benchmark.c
+ *
+ * @brief Timing and allocation counting helpers for host benchmarks.
+ *
+ * Allocations are counted by wrapping the allocator with the linker, i.e.
+ * linking with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free.
+ * Only calls made from objects linked into the benchmark are counted, which
+ * covers the components under benchmark but not the C library itself.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include <stddef.h>
+#include <time.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define BENCHMARK_NS_PER_S 1000000000ULL    /* Nanoseconds per second */
+#define BENCHMARK_OVERHEAD_SAMPLES 1000000U /* Number of samples used to measure timer overhead */
+
+/* Globals
+ ******************************************************************************/
+
+static Benchmark_Allocations_t Benchmark_AllocationCount = {0}; /* Allocations counted by the allocator wrappers */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+void __real_free(void *pointer);
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t count, size_t size);
+void *__wrap_realloc(void *pointer, size_t size);
+void __wrap_free(void *pointer);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Get the current time of a monotonic clock.
+ *
+ * @return Current time in nanoseconds
+ ******************************************************************************/
+Benchmark_TimeNs_t Benchmark_GetTimeNs(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return ((Benchmark_TimeNs_t)time.tv_sec * BENCHMARK_NS_PER_S) + (Benchmark_TimeNs_t)time.tv_nsec;
+}
+
+/**
+ * @brief Measure the average cost of a call to Benchmark_GetTimeNs.  Can be
+ * subtracted from measurements of very short operations.
+ *
+ * @return Average timer overhead in nanoseconds
+ ******************************************************************************/
+Benchmark_TimeNs_t Benchmark_GetTimerOverheadNs(void)
+{
+    Benchmark_TimeNs_t start = Benchmark_GetTimeNs();
+
+    for (uint32_t sample = 0U; sample < BENCHMARK_OVERHEAD_SAMPLES; sample++)
+    {
+        (void)Benchmark_GetTimeNs();
+    }
+
+    return (Benchmark_GetTimeNs() - start) / BENCHMARK_OVERHEAD_SAMPLES;
+}
+
+/**
+ * @brief Reset the allocation counters.
+ ******************************************************************************/
+void Benchmark_ResetAllocations(void)
+{
+    Benchmark_AllocationCount.Allocations = 0U;
+    Benchmark_AllocationCount.Frees = 0U;
+    Benchmark_AllocationCount.Bytes = 0U;
+}
+
+/**
+ * @brief Get the allocations counted since the last reset.
+ *
+ * @return Allocation counters
+ ******************************************************************************/
+Benchmark_Allocations_t Benchmark_GetAllocations(void)
+{
+    return Benchmark_AllocationCount;
+}
+
+/**
+ * @brief Counting wrapper for malloc.
+ ******************************************************************************/
+void *__wrap_malloc(size_t size)
+{
+    Benchmark_AllocationCount.Allocations++;
+    Benchmark_AllocationCount.Bytes += size;
+
+    return __real_malloc(size);
+}
+
+/**
+ * @brief Counting wrapper for calloc.
+ ******************************************************************************/
+void *__wrap_calloc(size_t count, size_t size)
+{
+    Benchmark_AllocationCount.Allocations++;
+    Benchmark_AllocationCount.Bytes += count * size;
+
+    return __real_calloc(count, size);
+}
+
+/**
+ * @brief Counting wrapper for realloc.
+ ******************************************************************************/
+void *__wrap_realloc(void *pointer, size_t size)
+{
+    Benchmark_AllocationCount.Allocations++;
+    Benchmark_AllocationCount.Bytes += size;
+
+    return __real_realloc(pointer, size);
+}
+
+/**
+ * @brief Counting wrapper for free.
+ ******************************************************************************/
+void __wrap_free(void *pointer)
+{
+    if (pointer != NULL)
+    {
+        Benchmark_AllocationCount.Frees++;
+    }
+
+    __real_free(pointer);
+}
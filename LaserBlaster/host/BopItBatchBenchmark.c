@@ -0,0 +1,559 @@
+/**
+ * @file BopItBatchBenchmark.c
+ *
+ * @brief Benchmark of running many BopIt games at once.  Each game has its own
+ * seed and a simulated player hooked up through its context.  The games are
+ * advanced in lockstep on a shared virtual clock, like a simulation or a
+ * device hosting many players, first by calling BopIt_Run on every context
+ * each tick and then by a single call to BopIt_RunBatch each tick with a list
+ * of the games still running, so games that have ended are never touched
+ * again.  The batch is also split across threads, each advancing its own part
+ * of the list on a clock of its own.  For reference the same games are played
+ * one at a time, each to its end before the next starts.  Games per second
+ * are reported for each way of playing, the fastest of several runs taking
+ * turns.  The threaded run is skipped with a single thread, which defaults to
+ * one per online core, as it would only repeat the batch.
+ *
+ * Exits with a failure status if any game's score, lives, number of reaction
+ * times or generator state differs between the ways of playing, which would
+ * mean games interfere with each other.
+ *
+ * Usage: BopItBatchBenchmark [games] [threads]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "BopIt.h"
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define BOPITBATCHBENCHMARK_DEFAULT_GAMES 4096U          /* Number of games played if not specified */
+#define BOPITBATCHBENCHMARK_MAX_THREADS 64U              /* Maximum number of threads */
+#define BOPITBATCHBENCHMARK_RUNS 15U                     /* Number of times each way of playing is timed */
+#define BOPITBATCHBENCHMARK_COMMAND_COUNT 3U             /* Number of commands, matches the firmware */
+#define BOPITBATCHBENCHMARK_RUN_DELAY_US 10000U          /* Virtual time between calls to BopIt_Run */
+#define BOPITBATCHBENCHMARK_CORRECT_PERCENT 90U          /* Chance the simulated player presses the correct input */
+#define BOPITBATCHBENCHMARK_WRONG_PERCENT 5U             /* Chance the simulated player presses a wrong input */
+#define BOPITBATCHBENCHMARK_MIN_REACTION_TIME_US 150000U /* Fastest simulated reaction time */
+#define BOPITBATCHBENCHMARK_MAX_REACTION_TIME_US 900000U /* Slowest simulated reaction time */
+#define BOPITBATCHBENCHMARK_PLAYER_SEED 0x9E3779B9U      /* Mixed with the game index to seed each player */
+#define BOPITBATCHBENCHMARK_NS_PER_S 1000000000.0        /* Nanoseconds per second */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Simulated player and environment of a single game */
+typedef struct
+{
+    uint32_t PlayerRandomState;  /* State of the player's random number generator */
+    const BopIt_TimeUs_t *Clock; /* Virtual clock the game is played on */
+    BopIt_TimeUs_t WaitStart;    /* Start of the wait the player last reacted to */
+    BopIt_Inputs_t Pressed;      /* Inputs the player will press */
+    BopIt_TimeUs_t PressTime;    /* Virtual time at which the player presses */
+} BopItBatchBenchmark_Player_t;
+
+/* Result of a single game, compared between the ways of playing */
+typedef struct
+{
+    uint8_t Score;         /* Final score */
+    uint8_t Lives;         /* Remaining lives */
+    uint8_t ReactionCount; /* Number of reaction times measured */
+    Prng_t Prng;           /* State of the generator for selecting commands */
+} BopItBatchBenchmark_Result_t;
+
+/* Way of playing all games */
+typedef enum
+{
+    BOPITBATCHBENCHMARK_MODE_ONE_AT_A_TIME, /* Each game is played to its end before the next one */
+    BOPITBATCHBENCHMARK_MODE_RUN_EACH,      /* Games are advanced in lockstep by calling BopIt_Run on every context */
+    BOPITBATCHBENCHMARK_MODE_BATCH,         /* Games are advanced in lockstep by BopIt_RunBatch over the games still running */
+    BOPITBATCHBENCHMARK_MODE_THREADS,       /* Games are split across threads that each advance their part with BopIt_RunBatch */
+    BOPITBATCHBENCHMARK_MODE_COUNT,         /* Number of ways of playing */
+} BopItBatchBenchmark_Mode_t;
+
+/* Part of the games advanced by a single thread */
+typedef struct
+{
+    uint32_t First; /* Index of the first game of the part */
+    uint32_t Count; /* Number of games in the part */
+} BopItBatchBenchmark_Slice_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static Benchmark_TimeNs_t BopItBatchBenchmark_Play(const BopItBatchBenchmark_Mode_t mode, const uint32_t games, const uint32_t threads);
+static void BopItBatchBenchmark_InitGames(const uint32_t games);
+static void BopItBatchBenchmark_PlayOne(const uint32_t game);
+static void BopItBatchBenchmark_RunEach(const uint32_t first, const uint32_t count);
+static void BopItBatchBenchmark_RunBatch(const uint32_t first, const uint32_t count);
+static void *BopItBatchBenchmark_Thread(void *arg);
+static uint32_t BopItBatchBenchmark_SaveResults(BopItBatchBenchmark_Result_t *const results, const uint32_t games, const bool compare);
+static uint32_t BopItBatchBenchmark_Xorshift(uint32_t *const state);
+static BopIt_TimeUs_t BopItBatchBenchmark_Time(const BopIt_GameContext_t *const gameContext);
+static void BopItBatchBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message);
+static BopIt_Inputs_t BopItBatchBenchmark_GetInputs(BopIt_GameContext_t *const gameContext, BopIt_TimeUs_t *const inputTime);
+static bool BopItBatchBenchmark_GetInput(BopIt_TimeUs_t *const inputTime);
+static void BopItBatchBenchmark_Command(void);
+
+/* Globals
+ ******************************************************************************/
+
+static BopIt_Command_t BopItBatchBenchmark_Commands[BOPITBATCHBENCHMARK_COMMAND_COUNT] = {
+    {"Command 0", BopItBatchBenchmark_Command, BopItBatchBenchmark_Command, BopItBatchBenchmark_Command, BopItBatchBenchmark_GetInput, NULL, 0U},
+    {"Command 1", BopItBatchBenchmark_Command, BopItBatchBenchmark_Command, BopItBatchBenchmark_Command, BopItBatchBenchmark_GetInput, NULL, 0U},
+    {"Command 2", BopItBatchBenchmark_Command, BopItBatchBenchmark_Command, BopItBatchBenchmark_Command, BopItBatchBenchmark_GetInput, NULL, 0U},
+};
+static BopIt_Command_t *BopItBatchBenchmark_CommandList[BOPITBATCHBENCHMARK_COMMAND_COUNT] = {&BopItBatchBenchmark_Commands[0], &BopItBatchBenchmark_Commands[1], &BopItBatchBenchmark_Commands[2]};
+
+static const char *BopItBatchBenchmark_ModeNames[BOPITBATCHBENCHMARK_MODE_COUNT] = {"One at a time:", "BopIt_Run each:", "BopIt_RunBatch:", "Batch threads:"};
+
+static BopIt_GameContext_t *BopItBatchBenchmark_GameContexts = NULL;     /* Contiguous array of contexts for all games */
+static BopItBatchBenchmark_Player_t *BopItBatchBenchmark_Players = NULL; /* Simulated player of each game */
+static uint32_t *BopItBatchBenchmark_Running = NULL;                     /* Indexes of the games still running, each thread owns the part of its games */
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t games = BOPITBATCHBENCHMARK_DEFAULT_GAMES;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t threads = (cores > 0L && cores < (long)BOPITBATCHBENCHMARK_MAX_THREADS) ? (uint32_t)cores : BOPITBATCHBENCHMARK_MAX_THREADS;
+    Benchmark_TimeNs_t times[BOPITBATCHBENCHMARK_MODE_COUNT];
+    Benchmark_TimeNs_t time;
+    uint32_t mismatches = 0U;
+    int status = EXIT_SUCCESS;
+
+    if (argc > 1)
+    {
+        games = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        threads = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (games == 0U)
+    {
+        games = BOPITBATCHBENCHMARK_DEFAULT_GAMES;
+    }
+    if (threads == 0U || threads > BOPITBATCHBENCHMARK_MAX_THREADS)
+    {
+        threads = 1U;
+    }
+
+    BopItBatchBenchmark_GameContexts = calloc(games, sizeof(BopIt_GameContext_t));
+    BopItBatchBenchmark_Players = calloc(games, sizeof(BopItBatchBenchmark_Player_t));
+    BopItBatchBenchmark_Running = calloc(games, sizeof(uint32_t));
+    BopItBatchBenchmark_Result_t *results = calloc(games, sizeof(BopItBatchBenchmark_Result_t));
+
+    /* Ways of playing take turns so a noisy host slows them alike, and games played one at a time on the first run are the reference for every other run */
+    memset(times, 0, sizeof(times));
+    for (uint32_t run = 0U; run < BOPITBATCHBENCHMARK_RUNS; run++)
+    {
+        for (uint32_t mode = 0U; mode < BOPITBATCHBENCHMARK_MODE_COUNT && (mode != BOPITBATCHBENCHMARK_MODE_THREADS || threads > 1U); mode++)
+        {
+            time = BopItBatchBenchmark_Play((BopItBatchBenchmark_Mode_t)mode, games, threads);
+            if (times[mode] == 0U || time < times[mode])
+            {
+                times[mode] = time;
+            }
+            mismatches += BopItBatchBenchmark_SaveResults(results, games, mode != BOPITBATCHBENCHMARK_MODE_ONE_AT_A_TIME || run > 0U);
+        }
+    }
+
+    printf("BopIt batch benchmark: %" PRIu32 " games, %zu bytes per context, fastest of %u runs\n", games, sizeof(BopIt_GameContext_t), BOPITBATCHBENCHMARK_RUNS);
+    for (uint32_t mode = 0U; mode < BOPITBATCHBENCHMARK_MODE_COUNT; mode++)
+    {
+        if (times[mode] > 0U)
+        {
+            printf("  %-16s %10.3f ms %12.0f games/sec\n", BopItBatchBenchmark_ModeNames[mode], (double)times[mode] / 1e6, (double)games * BOPITBATCHBENCHMARK_NS_PER_S / (double)times[mode]);
+        }
+        else
+        {
+            printf("  %-16s skipped with a single thread\n", BopItBatchBenchmark_ModeNames[mode]);
+        }
+    }
+    printf("  Threads:          %" PRIu32 " on %ld online cores\n", threads, cores);
+    printf("  Batch speedup:    %.2fx over BopIt_Run on every game, %.2fx over one at a time\n",
+           (times[BOPITBATCHBENCHMARK_MODE_BATCH] > 0U) ? ((double)times[BOPITBATCHBENCHMARK_MODE_RUN_EACH] / (double)times[BOPITBATCHBENCHMARK_MODE_BATCH]) : 0.0,
+           (times[BOPITBATCHBENCHMARK_MODE_BATCH] > 0U) ? ((double)times[BOPITBATCHBENCHMARK_MODE_ONE_AT_A_TIME] / (double)times[BOPITBATCHBENCHMARK_MODE_BATCH]) : 0.0);
+
+    if (mismatches > 0U)
+    {
+        printf("FAIL: %" PRIu32 " games had different results when run together\n", mismatches);
+        status = EXIT_FAILURE;
+    }
+
+    free(results);
+    free(BopItBatchBenchmark_Running);
+    free(BopItBatchBenchmark_Players);
+    free(BopItBatchBenchmark_GameContexts);
+
+    return status;
+}
+
+/**
+ * @brief Play all games from their starting state in one way.
+ *
+ * @param[in] mode    Way of playing the games
+ * @param[in] games   Number of games
+ * @param[in] threads Number of threads for BOPITBATCHBENCHMARK_MODE_THREADS
+ *
+ * @return Time taken to play all games
+ ******************************************************************************/
+static Benchmark_TimeNs_t BopItBatchBenchmark_Play(const BopItBatchBenchmark_Mode_t mode, const uint32_t games, const uint32_t threads)
+{
+    pthread_t threadHandles[BOPITBATCHBENCHMARK_MAX_THREADS];
+    BopItBatchBenchmark_Slice_t slices[BOPITBATCHBENCHMARK_MAX_THREADS];
+    Benchmark_TimeNs_t start;
+
+    BopItBatchBenchmark_InitGames(games);
+    start = Benchmark_GetTimeNs();
+
+    switch (mode)
+    {
+    case BOPITBATCHBENCHMARK_MODE_ONE_AT_A_TIME:
+        for (uint32_t game = 0U; game < games; game++)
+        {
+            BopItBatchBenchmark_PlayOne(game);
+        }
+        break;
+    case BOPITBATCHBENCHMARK_MODE_RUN_EACH:
+        BopItBatchBenchmark_RunEach(0U, games);
+        break;
+    case BOPITBATCHBENCHMARK_MODE_BATCH:
+        BopItBatchBenchmark_RunBatch(0U, games);
+        break;
+    case BOPITBATCHBENCHMARK_MODE_THREADS:
+        for (uint32_t thread = 0U; thread < threads; thread++)
+        {
+            slices[thread].First = (uint32_t)(((uint64_t)games * thread) / threads);
+            slices[thread].Count = (uint32_t)(((uint64_t)games * (thread + 1U)) / threads) - slices[thread].First;
+            pthread_create(&threadHandles[thread], NULL, BopItBatchBenchmark_Thread, &slices[thread]);
+        }
+        for (uint32_t thread = 0U; thread < threads; thread++)
+        {
+            pthread_join(threadHandles[thread], NULL);
+        }
+        break;
+    default:
+        break;
+    }
+
+    return Benchmark_GetTimeNs() - start;
+}
+
+/**
+ * @brief Initialize all games and their players to the same starting state.
+ *
+ * @param[in] games Number of games
+ ******************************************************************************/
+static void BopItBatchBenchmark_InitGames(const uint32_t games)
+{
+    for (uint32_t game = 0U; game < games; game++)
+    {
+        BopIt_GameContext_t *gameContext = &BopItBatchBenchmark_GameContexts[game];
+        BopItBatchBenchmark_Player_t *player = &BopItBatchBenchmark_Players[game];
+
+        memset(player, 0, sizeof(*player));
+        player->PlayerRandomState = (game + 1U) * BOPITBATCHBENCHMARK_PLAYER_SEED;
+        player->WaitStart = UINT32_MAX;
+
+        gameContext->Commands = BopItBatchBenchmark_CommandList;
+        gameContext->CommandCount = BOPITBATCHBENCHMARK_COMMAND_COUNT;
+        gameContext->GetInputs = BopItBatchBenchmark_GetInputs;
+        gameContext->Time = BopItBatchBenchmark_Time;
+        gameContext->Selection = BOPIT_SELECTION_UNIFORM;
+        gameContext->Curve = BOPIT_CURVE_LINEAR;
+        gameContext->CommandWeights = NULL;
+        gameContext->Logger = BopItBatchBenchmark_Logger;
+        gameContext->LogRing = NULL;
+        gameContext->TraceRing = NULL;
+        gameContext->Reactions = NULL;
+        gameContext->UserData = player;
+        gameContext->OnGameStart = NULL;
+        gameContext->OnGameEnd = NULL;
+
+        BopIt_Init(gameContext);
+        BopIt_Seed(gameContext, game);
+    }
+}
+
+/**
+ * @brief Play a single game to its end on a virtual clock of its own, started
+ * when the game is.  The end state is handled at the time the game ends, as
+ * BopIt_RunBatch does.
+ *
+ * @param[in] game Index of the game
+ ******************************************************************************/
+static void BopItBatchBenchmark_PlayOne(const uint32_t game)
+{
+    BopIt_GameContext_t *const gameContext = &BopItBatchBenchmark_GameContexts[game];
+    BopIt_TimeUs_t clock = 0U;
+
+    BopItBatchBenchmark_Players[game].Clock = &clock;
+
+    while (gameContext->GameState != BOPIT_GAMESTATE_END)
+    {
+        BopIt_Run(gameContext);
+
+        if (gameContext->GameState == BOPIT_GAMESTATE_END)
+        {
+            BopIt_Run(gameContext);
+        }
+        else
+        {
+            clock += BOPITBATCHBENCHMARK_RUN_DELAY_US;
+        }
+    }
+}
+
+/**
+ * @brief Advance a range of games in lockstep on a shared virtual clock by
+ * calling BopIt_Run on every context each tick, checking the state of games
+ * that have already ended as a client without a list of running games must.
+ *
+ * @param[in] first Index of the first game
+ * @param[in] count Number of games
+ ******************************************************************************/
+static void BopItBatchBenchmark_RunEach(const uint32_t first, const uint32_t count)
+{
+    BopIt_GameContext_t *gameContext;
+    BopIt_TimeUs_t clock = 0U;
+    uint32_t running = count;
+
+    for (uint32_t game = first; game < first + count; game++)
+    {
+        BopItBatchBenchmark_Players[game].Clock = &clock;
+    }
+
+    while (running > 0U)
+    {
+        running = 0U;
+        for (uint32_t game = first; game < first + count; game++)
+        {
+            gameContext = &BopItBatchBenchmark_GameContexts[game];
+
+            if (gameContext->GameState != BOPIT_GAMESTATE_END)
+            {
+                BopIt_Run(gameContext);
+
+                if (gameContext->GameState == BOPIT_GAMESTATE_END)
+                {
+                    BopIt_Run(gameContext);
+                }
+                else
+                {
+                    running++;
+                }
+            }
+        }
+
+        if (running > 0U)
+        {
+            clock += BOPITBATCHBENCHMARK_RUN_DELAY_US;
+        }
+    }
+}
+
+/**
+ * @brief Advance a range of games in lockstep on a shared virtual clock with
+ * a single call to BopIt_RunBatch each tick.  The range's part of the list of
+ * running games starts with every game of the range, and only the games still
+ * running are passed to the next call.
+ *
+ * @param[in] first Index of the first game
+ * @param[in] count Number of games
+ ******************************************************************************/
+static void BopItBatchBenchmark_RunBatch(const uint32_t first, const uint32_t count)
+{
+    uint32_t *const running = &BopItBatchBenchmark_Running[first];
+    BopIt_TimeUs_t clock = 0U;
+    uint32_t runningCount = count;
+
+    for (uint32_t game = 0U; game < count; game++)
+    {
+        BopItBatchBenchmark_Players[first + game].Clock = &clock;
+        running[game] = first + game;
+    }
+
+    while ((runningCount = BopIt_RunBatch(BopItBatchBenchmark_GameContexts, running, runningCount)) > 0U)
+    {
+        clock += BOPITBATCHBENCHMARK_RUN_DELAY_US;
+    }
+}
+
+/**
+ * @brief Thread advancing its part of the games with BopIt_RunBatch.
+ *
+ * @param[in] arg Part of the games to advance
+ *
+ * @return NULL
+ ******************************************************************************/
+static void *BopItBatchBenchmark_Thread(void *arg)
+{
+    BopItBatchBenchmark_Slice_t *slice = (BopItBatchBenchmark_Slice_t *)arg;
+
+    BopItBatchBenchmark_RunBatch(slice->First, slice->Count);
+
+    return NULL;
+}
+
+/**
+ * @brief Save the result of every game, or compare it against the saved
+ * result.
+ *
+ * @param[in,out] results Result of each game
+ * @param[in]     games   Number of games
+ * @param[in]     compare Whether to compare against the results instead of
+ * saving them
+ *
+ * @return Number of games with a different result
+ ******************************************************************************/
+static uint32_t BopItBatchBenchmark_SaveResults(BopItBatchBenchmark_Result_t *const results, const uint32_t games, const bool compare)
+{
+    const BopIt_GameContext_t *gameContext;
+    BopItBatchBenchmark_Result_t *result;
+    uint32_t mismatches = 0U;
+
+    for (uint32_t game = 0U; game < games; game++)
+    {
+        gameContext = &BopItBatchBenchmark_GameContexts[game];
+        result = &results[game];
+
+        if (!compare)
+        {
+            result->Score = gameContext->Score;
+            result->Lives = gameContext->Lives;
+            result->ReactionCount = gameContext->ReactionCount;
+            result->Prng = gameContext->Prng;
+        }
+        else if (result->Score != gameContext->Score || result->Lives != gameContext->Lives || result->ReactionCount != gameContext->ReactionCount || result->Prng.State != gameContext->Prng.State ||
+                 result->Prng.Increment != gameContext->Prng.Increment)
+        {
+            mismatches++;
+        }
+    }
+
+    return mismatches;
+}
+
+/**
+ * @brief Get a pseudo random number from a xorshift32 state.
+ *
+ * @param[in,out] state State of the generator
+ *
+ * @return Pseudo random number
+ ******************************************************************************/
+static uint32_t BopItBatchBenchmark_Xorshift(uint32_t *const state)
+{
+    *state ^= *state << 13U;
+    *state ^= *state >> 17U;
+    *state ^= *state << 5U;
+
+    return *state;
+}
+
+/**
+ * @brief Get the virtual time of a game.
+ *
+ * @param[in] gameContext Context for the game
+ *
+ * @return Virtual time of the game in microseconds
+ ******************************************************************************/
+static BopIt_TimeUs_t BopItBatchBenchmark_Time(const BopIt_GameContext_t *const gameContext)
+{
+    return *((const BopItBatchBenchmark_Player_t *)gameContext->UserData)->Clock;
+}
+
+/**
+ * @brief Discard a game's log messages so that formatting is measured without
+ * the cost of printing.
+ *
+ * @param[in] gameContext Unused
+ * @param[in] message     Unused
+ ******************************************************************************/
+static void BopItBatchBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message)
+{
+    (void)gameContext;
+    (void)message;
+}
+
+/**
+ * @brief Get the inputs a game's simulated player pressed.  The first time it
+ * is called for a command, the player decides to press the correct input, a
+ * wrong input or nothing after a random reaction time.
+ *
+ * @param[in]  gameContext Context for the game
+ * @param[out] inputTime   Virtual time at which the inputs were pressed
+ *
+ * @return Bitmask of the inputs pressed
+ ******************************************************************************/
+static BopIt_Inputs_t BopItBatchBenchmark_GetInputs(BopIt_GameContext_t *const gameContext, BopIt_TimeUs_t *const inputTime)
+{
+    BopItBatchBenchmark_Player_t *player = (BopItBatchBenchmark_Player_t *)gameContext->UserData;
+    BopIt_Inputs_t inputs = 0U;
+    uint32_t roll;
+
+    if (player->WaitStart != gameContext->WaitStart)
+    {
+        /* React to a newly issued command */
+        player->WaitStart = gameContext->WaitStart;
+        roll = BopItBatchBenchmark_Xorshift(&player->PlayerRandomState) % 100U;
+        if (roll < BOPITBATCHBENCHMARK_CORRECT_PERCENT)
+        {
+            player->Pressed = (BopIt_Inputs_t)1U << gameContext->CurrentCommandIndex;
+        }
+        else if (roll < (BOPITBATCHBENCHMARK_CORRECT_PERCENT + BOPITBATCHBENCHMARK_WRONG_PERCENT))
+        {
+            player->Pressed = (BopIt_Inputs_t)1U << ((gameContext->CurrentCommandIndex + 1U) % BOPITBATCHBENCHMARK_COMMAND_COUNT);
+        }
+        else
+        {
+            player->Pressed = 0U;
+        }
+        player->PressTime = gameContext->WaitStart + BOPITBATCHBENCHMARK_MIN_REACTION_TIME_US +
+                            (BopItBatchBenchmark_Xorshift(&player->PlayerRandomState) % (BOPITBATCHBENCHMARK_MAX_REACTION_TIME_US - BOPITBATCHBENCHMARK_MIN_REACTION_TIME_US));
+    }
+
+    if (*player->Clock >= player->PressTime)
+    {
+        inputs = player->Pressed;
+        *inputTime = player->PressTime;
+        player->Pressed = 0U;
+    }
+
+    return inputs;
+}
+
+/**
+ * @brief Input of a single command, never used since every game has an input
+ * provider.
+ *
+ * @param[out] inputTime Unused
+ *
+ * @return false
+ ******************************************************************************/
+static bool BopItBatchBenchmark_GetInput(BopIt_TimeUs_t *const inputTime)
+{
+    (void)inputTime;
+
+    return false;
+}
+
+/**
+ * @brief Command callbacks, do nothing since the player reacts through the
+ * input provider.
+ ******************************************************************************/
+static void BopItBatchBenchmark_Command(void)
+{
+}
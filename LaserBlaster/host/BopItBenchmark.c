@@ -0,0 +1,385 @@
+/**
+ * @file BopItBenchmark.c
+ *
+ * @brief Throughput benchmark for the BopIt engine.  Plays games against a
+ * simulated player on a virtual clock and reports state transitions per
+ * second, the cost of each call to BopIt_Run per game state and heap
+ * allocations made by the engine.  Also checks that the reaction times
+ * measured by the engine are the exact times the simulated player pressed,
+ * independent of how often BopIt_Run is called.
+ *
+ * If a log file is given, the engine logs deferred binary records to a log
+ * ring instead of formatting messages, and the records are saved to the log
+ * file for decoding with LogDecode.  If a trace file is given, the engine's
+ * trace records are saved to the trace file for replaying with TraceReplay.
+ *
+ * Exits with a failure status if any measured reaction time is wrong.
+ *
+ * Usage: BopItBenchmark [games] [seed] [log file] [trace file]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "BopIt.h"
+#include "LogRing.h"
+#include "VirtualClock.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define BOPITBENCHMARK_DEFAULT_GAMES 10000U         /* Number of games played if not specified */
+#define BOPITBENCHMARK_DEFAULT_SEED 1U              /* Seed for the simulated player and command selection if not specified */
+#define BOPITBENCHMARK_COMMAND_COUNT 3U             /* Number of commands, matches the firmware */
+#define BOPITBENCHMARK_RUN_DELAY_US 10000U          /* Virtual time between calls to BopIt_Run, matches the firmware */
+#define BOPITBENCHMARK_STATE_COUNT 6U               /* Number of BopIt game states */
+#define BOPITBENCHMARK_CORRECT_PERCENT 90U          /* Chance the simulated player presses the correct input */
+#define BOPITBENCHMARK_WRONG_PERCENT 5U             /* Chance the simulated player presses a wrong input */
+#define BOPITBENCHMARK_MIN_REACTION_TIME_US 150000U /* Fastest simulated reaction time */
+#define BOPITBENCHMARK_MAX_REACTION_TIME_US 900000U /* Slowest simulated reaction time */
+#define BOPITBENCHMARK_NS_PER_S 1000000000.0        /* Nanoseconds per second */
+#define BOPITBENCHMARK_LOG_RING_SIZE 64U            /* Number of records the log ring can hold, drained after every call to BopIt_Run */
+
+/* Define a GetInput function for a command at a given index */
+#define BOPITBENCHMARK_DEFINE_GET_INPUT(index)          \
+    static bool BopItBenchmark_GetInput##index(BopIt_TimeUs_t *const inputTime) \
+    {                                                                            \
+        return BopItBenchmark_GetInput(index, inputTime);                        \
+    }
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Cost of calls to BopIt_Run for a single game state */
+typedef struct
+{
+    uint64_t Calls;          /* Number of calls to BopIt_Run made in this state */
+    Benchmark_TimeNs_t Time; /* Total time spent in BopIt_Run for this state */
+} BopItBenchmark_StateCost_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static uint32_t BopItBenchmark_Random(void);
+static void BopItBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message);
+static uint64_t BopItBenchmark_Drain(LogRing_t *const ring, FILE *const file);
+static bool BopItBenchmark_GetInput(const uint32_t commandIndex, BopIt_TimeUs_t *const inputTime);
+static void BopItBenchmark_IssueCommand(void);
+static void BopItBenchmark_Feedback(void);
+static void BopItBenchmark_OnGameEnd(BopIt_GameContext_t *const gameContext);
+
+/* Globals
+ ******************************************************************************/
+
+static const char *BopItBenchmark_StateNames[BOPITBENCHMARK_STATE_COUNT] = {"START", "COMMAND", "WAIT", "SUCCESS", "FAIL", "END"};
+
+static uint32_t BopItBenchmark_RandomState = BOPITBENCHMARK_DEFAULT_SEED; /* State of the simulated player's random number generator */
+static uint32_t BopItBenchmark_PressIndex = BOPITBENCHMARK_COMMAND_COUNT; /* Index of the command the player will press, none if out of range */
+static BopIt_TimeUs_t BopItBenchmark_PressTime = 0U;                      /* Virtual time at which the player presses */
+static BopIt_TimeUs_t BopItBenchmark_ReactionTimes[BOPIT_MAX_SCORE];      /* Reaction times of the player's correct presses in the current game */
+static uint32_t BopItBenchmark_ReactionCount = 0U;                        /* Number of correct presses in the current game */
+static uint64_t BopItBenchmark_ReactionErrors = 0U;                       /* Number of reaction times measured wrong by the engine */
+static BopIt_Reaction_t BopItBenchmark_Reactions[BOPIT_MAX_SCORE];        /* Reaction times kept by the engine in the current game */
+
+BOPITBENCHMARK_DEFINE_GET_INPUT(0)
+BOPITBENCHMARK_DEFINE_GET_INPUT(1)
+BOPITBENCHMARK_DEFINE_GET_INPUT(2)
+
+static BopIt_Command_t BopItBenchmark_Commands[BOPITBENCHMARK_COMMAND_COUNT] = {
+    {"Command 0", BopItBenchmark_IssueCommand, BopItBenchmark_Feedback, BopItBenchmark_Feedback, BopItBenchmark_GetInput0, NULL, 0U},
+    {"Command 1", BopItBenchmark_IssueCommand, BopItBenchmark_Feedback, BopItBenchmark_Feedback, BopItBenchmark_GetInput1, NULL, 0U},
+    {"Command 2", BopItBenchmark_IssueCommand, BopItBenchmark_Feedback, BopItBenchmark_Feedback, BopItBenchmark_GetInput2, NULL, 0U},
+};
+static BopIt_Command_t *BopItBenchmark_CommandList[BOPITBENCHMARK_COMMAND_COUNT] = {&BopItBenchmark_Commands[0], &BopItBenchmark_Commands[1], &BopItBenchmark_Commands[2]};
+
+static LogRing_Record_t BopItBenchmark_LogRecords[BOPITBENCHMARK_LOG_RING_SIZE];   /* Storage for the log ring */
+static LogRing_t BopItBenchmark_LogRing;                                           /* Ring the engine writes deferred log records to */
+static FILE *BopItBenchmark_LogFile = NULL;                                        /* File deferred log records are saved to, NULL if not logging */
+static uint64_t BopItBenchmark_LogRecordCount = 0U;                                /* Number of deferred log records saved */
+static LogRing_Record_t BopItBenchmark_TraceRecords[BOPITBENCHMARK_LOG_RING_SIZE]; /* Storage for the trace ring */
+static LogRing_t BopItBenchmark_TraceRing;                                         /* Ring the engine writes trace records to */
+static FILE *BopItBenchmark_TraceFile = NULL;                                      /* File trace records are saved to, NULL if not tracing */
+static uint64_t BopItBenchmark_TraceRecordCount = 0U;                              /* Number of trace records saved */
+
+static BopIt_GameContext_t BopItBenchmark_GameContext = {
+    .Commands = BopItBenchmark_CommandList,
+    .CommandCount = BOPITBENCHMARK_COMMAND_COUNT,
+    .Time = VirtualClock_GetGameTime,
+    .Selection = BOPIT_SELECTION_UNIFORM,
+    .Curve = BOPIT_CURVE_LINEAR,
+    .CommandWeights = NULL,
+    .Logger = BopItBenchmark_Logger,
+    .LogRing = NULL,
+    .TraceRing = NULL,
+    .Reactions = BopItBenchmark_Reactions,
+    .UserData = NULL,
+    .OnGameStart = NULL,
+    .OnGameEnd = BopItBenchmark_OnGameEnd,
+};
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t games = BOPITBENCHMARK_DEFAULT_GAMES;
+    uint32_t seed = BOPITBENCHMARK_DEFAULT_SEED;
+    BopItBenchmark_StateCost_t stateCosts[BOPITBENCHMARK_STATE_COUNT] = {0};
+    uint64_t transitions = 0U;
+    uint64_t calls = 0U;
+    uint64_t score = 0U;
+    Benchmark_TimeNs_t engineTime = 0U;
+    static char logFileBuffer[BUFSIZ];   /* Static so saving records does not count as allocations */
+    static char traceFileBuffer[BUFSIZ]; /* Static so saving records does not count as allocations */
+
+    if (argc > 1)
+    {
+        games = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        seed = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3)
+    {
+        BopItBenchmark_LogFile = fopen(argv[3], "wb");
+        if (BopItBenchmark_LogFile == NULL)
+        {
+            printf("Failed to open log file %s\n", argv[3]);
+            return EXIT_FAILURE;
+        }
+        setvbuf(BopItBenchmark_LogFile, logFileBuffer, _IOFBF, sizeof(logFileBuffer));
+        LogRing_Init(&BopItBenchmark_LogRing, BopItBenchmark_LogRecords, BOPITBENCHMARK_LOG_RING_SIZE);
+        BopItBenchmark_GameContext.LogRing = &BopItBenchmark_LogRing;
+    }
+    if (argc > 4)
+    {
+        BopItBenchmark_TraceFile = fopen(argv[4], "wb");
+        if (BopItBenchmark_TraceFile == NULL)
+        {
+            printf("Failed to open trace file %s\n", argv[4]);
+            return EXIT_FAILURE;
+        }
+        setvbuf(BopItBenchmark_TraceFile, traceFileBuffer, _IOFBF, sizeof(traceFileBuffer));
+        LogRing_Init(&BopItBenchmark_TraceRing, BopItBenchmark_TraceRecords, BOPITBENCHMARK_LOG_RING_SIZE);
+        BopItBenchmark_GameContext.TraceRing = &BopItBenchmark_TraceRing;
+    }
+
+    BopItBenchmark_RandomState = (seed == 0U) ? BOPITBENCHMARK_DEFAULT_SEED : seed;
+
+    Benchmark_TimeNs_t timerOverhead = Benchmark_GetTimerOverheadNs();
+    Benchmark_ResetAllocations();
+
+    for (uint32_t game = 0U; game < games; game++)
+    {
+        BopIt_Init(&BopItBenchmark_GameContext);
+        BopItBenchmark_ReactionCount = 0U;
+        BopIt_Seed(&BopItBenchmark_GameContext, seed + game);
+
+        BopIt_GameState_t state;
+
+        /* Run until the end state has been handled, like the firmware does */
+        do
+        {
+            state = BopItBenchmark_GameContext.GameState;
+
+            Benchmark_TimeNs_t start = Benchmark_GetTimeNs();
+            BopIt_Run(&BopItBenchmark_GameContext);
+            Benchmark_TimeNs_t time = Benchmark_GetTimeNs() - start;
+
+            time = (time > timerOverhead) ? (time - timerOverhead) : 0U;
+            stateCosts[state].Calls++;
+            stateCosts[state].Time += time;
+            engineTime += time;
+            calls++;
+
+            if (BopItBenchmark_GameContext.GameState != state)
+            {
+                transitions++;
+            }
+
+            BopItBenchmark_LogRecordCount += BopItBenchmark_Drain(&BopItBenchmark_LogRing, BopItBenchmark_LogFile);
+            BopItBenchmark_TraceRecordCount += BopItBenchmark_Drain(&BopItBenchmark_TraceRing, BopItBenchmark_TraceFile);
+
+            VirtualClock_Advance(BOPITBENCHMARK_RUN_DELAY_US);
+        } while (state != BOPIT_GAMESTATE_END);
+
+        score += BopItBenchmark_GameContext.Score;
+    }
+
+    Benchmark_Allocations_t allocations = Benchmark_GetAllocations();
+
+    printf("BopIt benchmark: %" PRIu32 " games, seed %" PRIu32 "\n", games, seed);
+    printf("  BopIt_Run calls:     %" PRIu64 "\n", calls);
+    printf("  State transitions:   %" PRIu64 "\n", transitions);
+    printf("  Mean score:          %.2f\n", (games > 0U) ? ((double)score / games) : 0.0);
+    printf("  Engine time:         %.3f ms (timer overhead %" PRIu64 " ns/call subtracted)\n", (double)engineTime / 1e6, timerOverhead);
+    printf("  Transitions/sec:     %.0f\n", (engineTime > 0U) ? ((double)transitions * BOPITBENCHMARK_NS_PER_S / (double)engineTime) : 0.0);
+    printf("  ns per BopIt_Run call by state:\n");
+    for (uint32_t state = 0U; state < BOPITBENCHMARK_STATE_COUNT; state++)
+    {
+        double mean = (stateCosts[state].Calls > 0U) ? ((double)stateCosts[state].Time / (double)stateCosts[state].Calls) : 0.0;
+        printf("    %-8s %12" PRIu64 " calls %10.1f ns\n", BopItBenchmark_StateNames[state], stateCosts[state].Calls, mean);
+    }
+    printf("  Allocations:         %" PRIu64 " (%" PRIu64 " bytes, %" PRIu64 " frees)\n", allocations.Allocations, allocations.Bytes, allocations.Frees);
+    printf("  Reaction time errors: %" PRIu64 "\n", BopItBenchmark_ReactionErrors);
+    if (BopItBenchmark_LogFile != NULL)
+    {
+        printf("  Log records saved:   %" PRIu64 " (%" PRIu32 " dropped, peak %" PRIu32 ")\n", BopItBenchmark_LogRecordCount, LogRing_GetDropped(&BopItBenchmark_LogRing), LogRing_GetHighWater(&BopItBenchmark_LogRing));
+        fclose(BopItBenchmark_LogFile);
+    }
+    if (BopItBenchmark_TraceFile != NULL)
+    {
+        printf("  Trace records saved: %" PRIu64 " (%" PRIu32 " dropped, peak %" PRIu32 ")\n", BopItBenchmark_TraceRecordCount, LogRing_GetDropped(&BopItBenchmark_TraceRing), LogRing_GetHighWater(&BopItBenchmark_TraceRing));
+        fclose(BopItBenchmark_TraceFile);
+    }
+
+    if (BopItBenchmark_ReactionErrors > 0U)
+    {
+        printf("FAIL: measured reaction times do not match the player's presses\n");
+    }
+
+    return (BopItBenchmark_ReactionErrors == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Get a pseudo random number for the simulated player.  Uses xorshift32
+ * so the player behaves the same on every host.
+ *
+ * @return Pseudo random number
+ ******************************************************************************/
+static uint32_t BopItBenchmark_Random(void)
+{
+    BopItBenchmark_RandomState ^= BopItBenchmark_RandomState << 13U;
+    BopItBenchmark_RandomState ^= BopItBenchmark_RandomState >> 17U;
+    BopItBenchmark_RandomState ^= BopItBenchmark_RandomState << 5U;
+
+    return BopItBenchmark_RandomState;
+}
+
+/**
+ * @brief Discard log messages so output does not dominate the measurement.
+ *
+ * @param[in] gameContext Context for the game logging the message, unused
+ * @param[in] message     Message to log
+ ******************************************************************************/
+static void BopItBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message)
+{
+    (void)gameContext;
+    (void)message;
+}
+
+/**
+ * @brief Save records written by the engine to a ring to a file.  Does
+ * nothing if not saving to a file.
+ *
+ * @param[in,out] ring Ring to drain
+ * @param[in]     file File to save records to, NULL if not saving
+ *
+ * @return Number of records saved
+ ******************************************************************************/
+static uint64_t BopItBenchmark_Drain(LogRing_t *const ring, FILE *const file)
+{
+    LogRing_Record_t record;
+    uint64_t count = 0U;
+
+    if (file != NULL)
+    {
+        while (LogRing_Read(ring, &record))
+        {
+            fwrite(&record, sizeof(record), 1U, file);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Check if the simulated player pressed the input for a command.
+ *
+ * @param[in]  commandIndex Index of the command to check
+ * @param[out] inputTime    Virtual time at which the input was pressed
+ *
+ * @return Whether the input for the command was pressed or not
+ ******************************************************************************/
+static bool BopItBenchmark_GetInput(const uint32_t commandIndex, BopIt_TimeUs_t *const inputTime)
+{
+    bool input = false;
+
+    if (commandIndex == BopItBenchmark_PressIndex && VirtualClock_GetTime() >= BopItBenchmark_PressTime)
+    {
+        input = true;
+        *inputTime = BopItBenchmark_PressTime;
+        BopItBenchmark_PressIndex = BOPITBENCHMARK_COMMAND_COUNT;
+
+        /* Remember the reaction time the engine should measure for a correct press made in time */
+        BopIt_TimeUs_t reactionTime = BopItBenchmark_PressTime - BopItBenchmark_GameContext.WaitStart;
+        if (BopItBenchmark_GameContext.CurrentCommand == &BopItBenchmark_Commands[commandIndex] && reactionTime < BopItBenchmark_GameContext.WaitTime && BopItBenchmark_ReactionCount < BOPIT_MAX_SCORE)
+        {
+            BopItBenchmark_ReactionTimes[BopItBenchmark_ReactionCount] = reactionTime;
+            BopItBenchmark_ReactionCount++;
+        }
+    }
+
+    return input;
+}
+
+/**
+ * @brief Have the simulated player react to the command just issued.  The
+ * player either presses the correct input, presses a wrong input or does not
+ * press anything, after a random reaction time.
+ ******************************************************************************/
+static void BopItBenchmark_IssueCommand(void)
+{
+    uint32_t commandIndex = (uint32_t)(BopItBenchmark_GameContext.CurrentCommand - BopItBenchmark_Commands);
+    uint32_t roll = BopItBenchmark_Random() % 100U;
+
+    if (roll < BOPITBENCHMARK_CORRECT_PERCENT)
+    {
+        BopItBenchmark_PressIndex = commandIndex;
+    }
+    else if (roll < (BOPITBENCHMARK_CORRECT_PERCENT + BOPITBENCHMARK_WRONG_PERCENT))
+    {
+        BopItBenchmark_PressIndex = (commandIndex + 1U) % BOPITBENCHMARK_COMMAND_COUNT;
+    }
+    else
+    {
+        BopItBenchmark_PressIndex = BOPITBENCHMARK_COMMAND_COUNT;
+    }
+
+    BopItBenchmark_PressTime = VirtualClock_GetTime() + BOPITBENCHMARK_MIN_REACTION_TIME_US + (BopItBenchmark_Random() % (BOPITBENCHMARK_MAX_REACTION_TIME_US - BOPITBENCHMARK_MIN_REACTION_TIME_US));
+}
+
+/**
+ * @brief Feedback for the simulated player, does nothing.
+ ******************************************************************************/
+static void BopItBenchmark_Feedback(void)
+{
+}
+
+/**
+ * @brief Check the reaction times measured by the engine against the times
+ * the simulated player pressed the correct inputs.
+ *
+ * @param[in] gameContext Context for the game that ended
+ ******************************************************************************/
+static void BopItBenchmark_OnGameEnd(BopIt_GameContext_t *const gameContext)
+{
+    if (gameContext->ReactionCount != BopItBenchmark_ReactionCount)
+    {
+        BopItBenchmark_ReactionErrors++;
+    }
+
+    for (uint32_t reaction = 0U; reaction < gameContext->ReactionCount && reaction < BopItBenchmark_ReactionCount; reaction++)
+    {
+        if (gameContext->Reactions[reaction].Time != BopItBenchmark_ReactionTimes[reaction])
+        {
+            BopItBenchmark_ReactionErrors++;
+        }
+    }
+}
@@ -0,0 +1,394 @@
+/**
+ * @file BopItCurveBenchmark.c
+ *
+ * @brief Benchmark and bounds check of the BopIt difficulty curves.  Checks
+ * that every curve starts at the maximum time to complete a command, never
+ * increases and stays within the minimum and maximum times.  Then plays games
+ * on each curve against a simulated player on an event driven virtual clock,
+ * checking the time to complete every command, and reports the cost of a
+ * successful round at low and high scores to show the cost of updating the
+ * curve does not grow with the score.
+ *
+ * Exits with a failure status if any curve leaves its bounds.
+ *
+ * Usage: BopItCurveBenchmark [games] [seed]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "BopIt.h"
+#include "Prng.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define BOPITCURVEBENCHMARK_DEFAULT_GAMES 10000U         /* Number of games played on each curve if not specified */
+#define BOPITCURVEBENCHMARK_DEFAULT_SEED 1U              /* Seed for the simulated player and command selection if not specified */
+#define BOPITCURVEBENCHMARK_COMMAND_COUNT 3U             /* Number of commands, matches the firmware */
+#define BOPITCURVEBENCHMARK_MIN_REACTION_TIME_US 150000U /* Fastest simulated reaction time */
+#define BOPITCURVEBENCHMARK_REACTION_RANGE_US 400000U    /* Range of simulated reaction times */
+#define BOPITCURVEBENCHMARK_BANDS 4U                     /* Number of bands of scores the cost of rounds is reported for */
+#define BOPITCURVEBENCHMARK_BAND_WIDTH 25U               /* Number of scores in each band */
+#define BOPITCURVEBENCHMARK_PLAYER_SEQUENCE 1U           /* Sequence of the player's generator, distinct from the game's */
+#define BOPITCURVEBENCHMARK_US_PER_MS 1000U              /* Microseconds per millisecond, curve times are printed in milliseconds */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Simulated player */
+typedef struct
+{
+    Prng_t Prng;              /* Player's generator */
+    BopIt_TimeUs_t Time;      /* Virtual time of the game */
+    BopIt_TimeUs_t WaitStart; /* Start of the wait the player last reacted to */
+    bool Pressing;            /* Whether the player will press the correct input */
+    BopIt_TimeUs_t PressTime; /* Virtual time at which the player presses */
+} BopItCurveBenchmark_Player_t;
+
+/* Result of playing games on a curve */
+typedef struct
+{
+    uint64_t Rounds[BOPITCURVEBENCHMARK_BANDS];         /* Number of successful rounds in each band of scores */
+    Benchmark_TimeNs_t Time[BOPITCURVEBENCHMARK_BANDS]; /* Total time of successful rounds in each band of scores */
+    uint64_t Score;                                     /* Sum of final scores */
+    uint64_t Errors;                                    /* Number of times the time to complete a command was wrong */
+} BopItCurveBenchmark_Result_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static uint32_t BopItCurveBenchmark_CheckTable(const BopIt_Curve_t curve);
+static void BopItCurveBenchmark_Play(const BopIt_Curve_t curve, const uint32_t games, const uint32_t seed, BopItCurveBenchmark_Result_t *const result);
+static bool BopItCurveBenchmark_CheckWaitTime(const BopIt_GameContext_t *const gameContext);
+static BopIt_TimeUs_t BopItCurveBenchmark_Time(const BopIt_GameContext_t *const gameContext);
+static BopIt_Inputs_t BopItCurveBenchmark_GetInputs(BopIt_GameContext_t *const gameContext, BopIt_TimeUs_t *const inputTime);
+static void BopItCurveBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message);
+static bool BopItCurveBenchmark_GetInput(BopIt_TimeUs_t *const inputTime);
+static void BopItCurveBenchmark_Command(void);
+
+/* Globals
+ ******************************************************************************/
+
+static const char *BopItCurveBenchmark_CurveNames[BOPIT_CURVE_COUNT] = {"Linear", "Exponential", "Stepped", "Adaptive"};
+
+static BopIt_Command_t BopItCurveBenchmark_Commands[BOPITCURVEBENCHMARK_COMMAND_COUNT] = {
+    {"Command 0", BopItCurveBenchmark_Command, BopItCurveBenchmark_Command, BopItCurveBenchmark_Command, BopItCurveBenchmark_GetInput, NULL, 0U},
+    {"Command 1", BopItCurveBenchmark_Command, BopItCurveBenchmark_Command, BopItCurveBenchmark_Command, BopItCurveBenchmark_GetInput, NULL, 0U},
+    {"Command 2", BopItCurveBenchmark_Command, BopItCurveBenchmark_Command, BopItCurveBenchmark_Command, BopItCurveBenchmark_GetInput, NULL, 0U},
+};
+static BopIt_Command_t *BopItCurveBenchmark_CommandList[BOPITCURVEBENCHMARK_COMMAND_COUNT] = {&BopItCurveBenchmark_Commands[0], &BopItCurveBenchmark_Commands[1], &BopItCurveBenchmark_Commands[2]};
+
+static BopItCurveBenchmark_Player_t BopItCurveBenchmark_Player;
+
+static BopIt_GameContext_t BopItCurveBenchmark_GameContext = {
+    .Commands = BopItCurveBenchmark_CommandList,
+    .CommandCount = BOPITCURVEBENCHMARK_COMMAND_COUNT,
+    .GetInputs = BopItCurveBenchmark_GetInputs,
+    .Time = BopItCurveBenchmark_Time,
+    .Selection = BOPIT_SELECTION_UNIFORM,
+    .Curve = BOPIT_CURVE_LINEAR,
+    .CommandWeights = NULL,
+    .Logger = BopItCurveBenchmark_Logger,
+    .LogRing = NULL,
+    .TraceRing = NULL,
+    .Reactions = NULL,
+    .UserData = &BopItCurveBenchmark_Player,
+    .OnGameStart = NULL,
+    .OnGameEnd = NULL,
+};
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t games = BOPITCURVEBENCHMARK_DEFAULT_GAMES;
+    uint32_t seed = BOPITCURVEBENCHMARK_DEFAULT_SEED;
+    BopItCurveBenchmark_Result_t results[BOPIT_CURVE_COUNT] = {0};
+    Benchmark_TimeNs_t timerOverhead = Benchmark_GetTimerOverheadNs();
+    uint32_t tableErrors;
+    int status = EXIT_SUCCESS;
+
+    if (argc > 1)
+    {
+        games = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        seed = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (games == 0U)
+    {
+        games = BOPITCURVEBENCHMARK_DEFAULT_GAMES;
+    }
+
+    printf("BopIt curve benchmark: %" PRIu32 " games per curve, seed %" PRIu32 ", %" PRIu64 " ns timer overhead subtracted\n", games, seed, timerOverhead);
+    printf("  %-12s %8s %8s %8s %8s %10s", "Curve", "Score 0", "Score 25", "Score 50", "Score 98", "Mean score");
+    for (uint32_t band = 0U; band < BOPITCURVEBENCHMARK_BANDS; band++)
+    {
+        printf("   ns/round %2" PRIu32 "-%2" PRIu32, band * BOPITCURVEBENCHMARK_BAND_WIDTH, ((band + 1U) * BOPITCURVEBENCHMARK_BAND_WIDTH) - 1U);
+    }
+    printf("\n");
+
+    for (uint32_t curve = 0U; curve < BOPIT_CURVE_COUNT; curve++)
+    {
+        tableErrors = BopItCurveBenchmark_CheckTable((BopIt_Curve_t)curve);
+        BopItCurveBenchmark_Play((BopIt_Curve_t)curve, games, seed, &results[curve]);
+
+        printf("  %-12s %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %10.2f", BopItCurveBenchmark_CurveNames[curve], (uint32_t)(BopIt_GetCurveWaitTime((BopIt_Curve_t)curve, 0U) / BOPITCURVEBENCHMARK_US_PER_MS),
+               (uint32_t)(BopIt_GetCurveWaitTime((BopIt_Curve_t)curve, 25U) / BOPITCURVEBENCHMARK_US_PER_MS), (uint32_t)(BopIt_GetCurveWaitTime((BopIt_Curve_t)curve, 50U) / BOPITCURVEBENCHMARK_US_PER_MS),
+               (uint32_t)(BopIt_GetCurveWaitTime((BopIt_Curve_t)curve, BOPIT_MAX_SCORE - 1U) / BOPITCURVEBENCHMARK_US_PER_MS), (double)results[curve].Score / games);
+        for (uint32_t band = 0U; band < BOPITCURVEBENCHMARK_BANDS; band++)
+        {
+            if (results[curve].Rounds[band] > 0U)
+            {
+                Benchmark_TimeNs_t overhead = timerOverhead * results[curve].Rounds[band];
+                Benchmark_TimeNs_t time = (results[curve].Time[band] > overhead) ? (results[curve].Time[band] - overhead) : 0U;
+                printf(" %17.2f", (double)time / results[curve].Rounds[band]);
+            }
+            else
+            {
+                printf(" %17s", "-");
+            }
+        }
+        printf("\n");
+
+        if (tableErrors > 0U)
+        {
+            printf("FAIL: %s curve is out of bounds or increases at %" PRIu32 " scores\n", BopItCurveBenchmark_CurveNames[curve], tableErrors);
+            status = EXIT_FAILURE;
+        }
+        if (results[curve].Errors > 0U)
+        {
+            printf("FAIL: %s curve gave a wrong time to complete a command %" PRIu64 " times\n", BopItCurveBenchmark_CurveNames[curve], results[curve].Errors);
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if (BopIt_GetCurveWaitTime(BOPIT_CURVE_COUNT, 50U) != BopIt_GetCurveWaitTime(BOPIT_CURVE_LINEAR, 50U))
+    {
+        printf("FAIL: an invalid curve is not linear\n");
+        status = EXIT_FAILURE;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Check the table of a curve.  Every curve starts at the maximum time,
+ * never increases and stays within the minimum and maximum times.  The linear
+ * and stepped curves reach the minimum time on the last command of a game.
+ *
+ * @param[in] curve Curve to check
+ *
+ * @return Number of scores at which the curve is wrong
+ ******************************************************************************/
+static uint32_t BopItCurveBenchmark_CheckTable(const BopIt_Curve_t curve)
+{
+    BopIt_TimeUs_t previous = BOPIT_MAX_WAIT_TIME_US;
+    BopIt_TimeUs_t waitTime;
+    uint32_t errors = 0U;
+
+    if (BopIt_GetCurveWaitTime(curve, 0U) != BOPIT_MAX_WAIT_TIME_US)
+    {
+        errors++;
+    }
+
+    for (uint32_t score = 0U; score <= BOPIT_MAX_SCORE; score++)
+    {
+        waitTime = BopIt_GetCurveWaitTime(curve, (uint8_t)score);
+        if (waitTime < BOPIT_MIN_WAIT_TIME_US || waitTime > previous)
+        {
+            errors++;
+        }
+        previous = waitTime;
+    }
+
+    if ((curve == BOPIT_CURVE_LINEAR || curve == BOPIT_CURVE_STEPPED) && BopIt_GetCurveWaitTime(curve, BOPIT_MAX_SCORE - 1U) != BOPIT_MIN_WAIT_TIME_US)
+    {
+        errors++;
+    }
+
+    return errors;
+}
+
+/**
+ * @brief Play games on a curve, timing every call to BopIt_Run that handles a
+ * successful round and checking the time to complete every command.
+ *
+ * @param[in]  curve  Curve to play on
+ * @param[in]  games  Number of games to play
+ * @param[in]  seed   Seed for the player and command selection
+ * @param[out] result Result of the games
+ ******************************************************************************/
+static void BopItCurveBenchmark_Play(const BopIt_Curve_t curve, const uint32_t games, const uint32_t seed, BopItCurveBenchmark_Result_t *const result)
+{
+    BopIt_GameContext_t *gameContext = &BopItCurveBenchmark_GameContext;
+    BopItCurveBenchmark_Player_t *player = &BopItCurveBenchmark_Player;
+    BopIt_GameState_t state;
+    BopIt_TimeUs_t delay;
+    BopIt_TimeUs_t nextTime;
+    uint32_t band;
+
+    gameContext->Curve = curve;
+    Prng_Seed(&player->Prng, seed, BOPITCURVEBENCHMARK_PLAYER_SEQUENCE);
+
+    for (uint32_t game = 0U; game < games; game++)
+    {
+        player->Time = 0U;
+        player->WaitStart = UINT64_MAX;
+        player->Pressing = false;
+
+        BopIt_Init(gameContext);
+        BopIt_Seed(gameContext, (uint64_t)seed + game);
+
+        do
+        {
+            state = gameContext->GameState;
+            if (state == BOPIT_GAMESTATE_SUCCESS)
+            {
+                band = gameContext->Score / BOPITCURVEBENCHMARK_BAND_WIDTH;
+                Benchmark_TimeNs_t start = Benchmark_GetTimeNs();
+                BopIt_Run(gameContext);
+                result->Time[band] += Benchmark_GetTimeNs() - start;
+                result->Rounds[band]++;
+            }
+            else
+            {
+                BopIt_Run(gameContext);
+            }
+
+            if (!BopItCurveBenchmark_CheckWaitTime(gameContext))
+            {
+                result->Errors++;
+            }
+
+            /* Jump the clock straight to the next press or deadline */
+            delay = BopIt_GetRunDelay(gameContext);
+            if (delay > 0U && delay != BOPIT_RUN_DELAY_INFINITE)
+            {
+                nextTime = player->Time + delay;
+                if (player->Pressing && player->PressTime < nextTime)
+                {
+                    nextTime = player->PressTime;
+                }
+                player->Time = nextTime;
+            }
+        } while (state != BOPIT_GAMESTATE_END);
+
+        result->Score += gameContext->Score;
+    }
+}
+
+/**
+ * @brief Check the time to complete the current command of a game.  It must be
+ * within the minimum and maximum times, on the table of the game's curve, or
+ * no longer than the linear curve for the adaptive curve.
+ *
+ * @param[in] gameContext Context for the game
+ *
+ * @return Whether the time to complete the current command is right
+ ******************************************************************************/
+static bool BopItCurveBenchmark_CheckWaitTime(const BopIt_GameContext_t *const gameContext)
+{
+    BopIt_TimeUs_t expected = BopIt_GetCurveWaitTime(gameContext->Curve, gameContext->Score);
+    bool correct = (gameContext->WaitTime >= BOPIT_MIN_WAIT_TIME_US && gameContext->WaitTime <= BOPIT_MAX_WAIT_TIME_US);
+
+    if (gameContext->GameState == BOPIT_GAMESTATE_COMMAND || gameContext->GameState == BOPIT_GAMESTATE_WAIT)
+    {
+        if (gameContext->Curve == BOPIT_CURVE_ADAPTIVE)
+        {
+            correct = correct && (gameContext->WaitTime <= expected);
+        }
+        else
+        {
+            correct = correct && (gameContext->WaitTime == expected);
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Get the virtual time of the game.
+ *
+ * @param[in] gameContext Context for the game
+ *
+ * @return Virtual time of the game in milliseconds
+ ******************************************************************************/
+static BopIt_TimeUs_t BopItCurveBenchmark_Time(const BopIt_GameContext_t *const gameContext)
+{
+    return ((const BopItCurveBenchmark_Player_t *)gameContext->UserData)->Time;
+}
+
+/**
+ * @brief Get the inputs the simulated player pressed.  The player always
+ * presses the correct input, after a reaction time drawn uniformly the first
+ * time it is called for a command.
+ *
+ * @param[in]  gameContext Context for the game
+ * @param[out] inputTime   Virtual time at which the input was pressed
+ *
+ * @return Bitmask of the inputs pressed
+ ******************************************************************************/
+static BopIt_Inputs_t BopItCurveBenchmark_GetInputs(BopIt_GameContext_t *const gameContext, BopIt_TimeUs_t *const inputTime)
+{
+    BopItCurveBenchmark_Player_t *player = (BopItCurveBenchmark_Player_t *)gameContext->UserData;
+    BopIt_Inputs_t inputs = 0U;
+
+    if (player->WaitStart != gameContext->WaitStart)
+    {
+        player->WaitStart = gameContext->WaitStart;
+        player->Pressing = true;
+        player->PressTime = gameContext->WaitStart + BOPITCURVEBENCHMARK_MIN_REACTION_TIME_US + Prng_Bounded(&player->Prng, BOPITCURVEBENCHMARK_REACTION_RANGE_US);
+    }
+
+    if (player->Pressing && player->Time >= player->PressTime)
+    {
+        inputs = (BopIt_Inputs_t)1U << gameContext->CurrentCommandIndex;
+        *inputTime = player->PressTime;
+        player->Pressing = false;
+    }
+
+    return inputs;
+}
+
+/**
+ * @brief Discard log messages of benchmarked games.
+ *
+ * @param[in] gameContext Unused
+ * @param[in] message     Unused
+ ******************************************************************************/
+static void BopItCurveBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message)
+{
+    (void)gameContext;
+    (void)message;
+}
+
+/**
+ * @brief Input of a single command, never used since the game has an input
+ * provider.
+ *
+ * @param[out] inputTime Unused
+ *
+ * @return false
+ ******************************************************************************/
+static bool BopItCurveBenchmark_GetInput(BopIt_TimeUs_t *const inputTime)
+{
+    (void)inputTime;
+
+    return false;
+}
+
+/**
+ * @brief Command callbacks, do nothing since the player reacts through the
+ * input provider.
+ ******************************************************************************/
+static void BopItCurveBenchmark_Command(void)
+{
+}
@@ -0,0 +1,332 @@
+/**
+ * @file BopItInputBenchmark.c
+ *
+ * @brief Benchmark of checking inputs in the wait state.  Plays the same games
+ * with many synthetic commands twice, first calling GetInput of every command
+ * and then calling the game's input provider once, and reports the cost of
+ * each call to BopIt_Run in the wait state for both.
+ *
+ * Exits with a failure status if the games played differ between the two.
+ *
+ * Usage: BopItInputBenchmark [games] [seed]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "BopIt.h"
+#include "VirtualClock.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define BOPITINPUTBENCHMARK_DEFAULT_GAMES 2000U          /* Number of games played if not specified */
+#define BOPITINPUTBENCHMARK_DEFAULT_SEED 1U              /* Seed for the simulated player and command selection if not specified */
+#define BOPITINPUTBENCHMARK_COMMAND_COUNT 64U            /* Number of synthetic commands */
+#define BOPITINPUTBENCHMARK_RUN_DELAY_US 10000U          /* Virtual time between calls to BopIt_Run */
+#define BOPITINPUTBENCHMARK_CORRECT_PERCENT 90U          /* Chance the simulated player presses the correct input */
+#define BOPITINPUTBENCHMARK_WRONG_PERCENT 5U             /* Chance the simulated player presses a wrong input */
+#define BOPITINPUTBENCHMARK_MIN_REACTION_TIME_US 150000U /* Fastest simulated reaction time */
+#define BOPITINPUTBENCHMARK_MAX_REACTION_TIME_US 900000U /* Slowest simulated reaction time */
+
+/* Define a GetInput function for the command at an offset in a group of eight commands */
+#define BOPITINPUTBENCHMARK_DEFINE_GET_INPUT(group, offset)                                    \
+    static bool BopItInputBenchmark_GetInput##group##offset(BopIt_TimeUs_t *const inputTime) \
+    {                                                                                          \
+        return BopItInputBenchmark_GetInput((group * 8U) + offset, inputTime);                 \
+    }
+
+/* Define GetInput functions for a group of eight commands */
+#define BOPITINPUTBENCHMARK_DEFINE_GET_INPUTS(group)  \
+    BOPITINPUTBENCHMARK_DEFINE_GET_INPUT(group, 0U)   \
+    BOPITINPUTBENCHMARK_DEFINE_GET_INPUT(group, 1U)   \
+    BOPITINPUTBENCHMARK_DEFINE_GET_INPUT(group, 2U)   \
+    BOPITINPUTBENCHMARK_DEFINE_GET_INPUT(group, 3U)   \
+    BOPITINPUTBENCHMARK_DEFINE_GET_INPUT(group, 4U)   \
+    BOPITINPUTBENCHMARK_DEFINE_GET_INPUT(group, 5U)   \
+    BOPITINPUTBENCHMARK_DEFINE_GET_INPUT(group, 6U)   \
+    BOPITINPUTBENCHMARK_DEFINE_GET_INPUT(group, 7U)
+
+/* GetInput functions of a group of eight commands */
+#define BOPITINPUTBENCHMARK_GET_INPUTS(group)                                                                                       \
+    BopItInputBenchmark_GetInput##group##0U, BopItInputBenchmark_GetInput##group##1U, BopItInputBenchmark_GetInput##group##2U,     \
+        BopItInputBenchmark_GetInput##group##3U, BopItInputBenchmark_GetInput##group##4U, BopItInputBenchmark_GetInput##group##5U, \
+        BopItInputBenchmark_GetInput##group##6U, BopItInputBenchmark_GetInput##group##7U
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Results of playing games with one way of checking inputs */
+typedef struct
+{
+    uint64_t Score;          /* Total score of all games */
+    uint64_t Transitions;    /* Number of state transitions */
+    uint64_t WaitCalls;      /* Number of calls to BopIt_Run in the wait state */
+    Benchmark_TimeNs_t Time; /* Total time spent in BopIt_Run in the wait state */
+} BopItInputBenchmark_Result_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static BopItInputBenchmark_Result_t BopItInputBenchmark_Play(const uint32_t games, const uint32_t seed, const bool useInputProvider);
+static uint32_t BopItInputBenchmark_Random(void);
+static void BopItInputBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message);
+static bool BopItInputBenchmark_GetInput(const uint32_t commandIndex, BopIt_TimeUs_t *const inputTime);
+static BopIt_Inputs_t BopItInputBenchmark_GetInputs(BopIt_GameContext_t *const gameContext, BopIt_TimeUs_t *const inputTime);
+static void BopItInputBenchmark_IssueCommand(void);
+static void BopItInputBenchmark_Feedback(void);
+
+/* Globals
+ ******************************************************************************/
+
+static uint32_t BopItInputBenchmark_RandomState = BOPITINPUTBENCHMARK_DEFAULT_SEED; /* State of the simulated player's random number generator */
+static BopIt_Inputs_t BopItInputBenchmark_Pressed = 0U;                             /* Inputs the player will press */
+static BopIt_TimeUs_t BopItInputBenchmark_PressTime = 0U;                           /* Virtual time at which the player presses */
+
+BOPITINPUTBENCHMARK_DEFINE_GET_INPUTS(0U)
+BOPITINPUTBENCHMARK_DEFINE_GET_INPUTS(1U)
+BOPITINPUTBENCHMARK_DEFINE_GET_INPUTS(2U)
+BOPITINPUTBENCHMARK_DEFINE_GET_INPUTS(3U)
+BOPITINPUTBENCHMARK_DEFINE_GET_INPUTS(4U)
+BOPITINPUTBENCHMARK_DEFINE_GET_INPUTS(5U)
+BOPITINPUTBENCHMARK_DEFINE_GET_INPUTS(6U)
+BOPITINPUTBENCHMARK_DEFINE_GET_INPUTS(7U)
+
+static bool (*const BopItInputBenchmark_GetInputFunctions[BOPITINPUTBENCHMARK_COMMAND_COUNT])(BopIt_TimeUs_t *const inputTime) = {
+    BOPITINPUTBENCHMARK_GET_INPUTS(0U), BOPITINPUTBENCHMARK_GET_INPUTS(1U), BOPITINPUTBENCHMARK_GET_INPUTS(2U), BOPITINPUTBENCHMARK_GET_INPUTS(3U),
+    BOPITINPUTBENCHMARK_GET_INPUTS(4U), BOPITINPUTBENCHMARK_GET_INPUTS(5U), BOPITINPUTBENCHMARK_GET_INPUTS(6U), BOPITINPUTBENCHMARK_GET_INPUTS(7U),
+};
+
+static BopIt_Command_t BopItInputBenchmark_Commands[BOPITINPUTBENCHMARK_COMMAND_COUNT];
+static BopIt_Command_t *BopItInputBenchmark_CommandList[BOPITINPUTBENCHMARK_COMMAND_COUNT];
+
+static BopIt_GameContext_t BopItInputBenchmark_GameContext = {
+    .Commands = BopItInputBenchmark_CommandList,
+    .CommandCount = BOPITINPUTBENCHMARK_COMMAND_COUNT,
+    .GetInputs = NULL,
+    .Time = VirtualClock_GetGameTime,
+    .Selection = BOPIT_SELECTION_UNIFORM,
+    .Curve = BOPIT_CURVE_LINEAR,
+    .CommandWeights = NULL,
+    .Logger = BopItInputBenchmark_Logger,
+    .LogRing = NULL,
+    .TraceRing = NULL,
+    .Reactions = NULL,
+    .UserData = NULL,
+    .OnGameStart = NULL,
+    .OnGameEnd = NULL,
+};
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t games = BOPITINPUTBENCHMARK_DEFAULT_GAMES;
+    uint32_t seed = BOPITINPUTBENCHMARK_DEFAULT_SEED;
+    int status = EXIT_SUCCESS;
+
+    if (argc > 1)
+    {
+        games = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        seed = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+
+    for (uint32_t commandIndex = 0U; commandIndex < BOPITINPUTBENCHMARK_COMMAND_COUNT; commandIndex++)
+    {
+        BopItInputBenchmark_Commands[commandIndex].Name = "Command";
+        BopItInputBenchmark_Commands[commandIndex].IssueCommand = BopItInputBenchmark_IssueCommand;
+        BopItInputBenchmark_Commands[commandIndex].SuccessFeedback = BopItInputBenchmark_Feedback;
+        BopItInputBenchmark_Commands[commandIndex].FailFeedback = BopItInputBenchmark_Feedback;
+        BopItInputBenchmark_Commands[commandIndex].GetInput = BopItInputBenchmark_GetInputFunctions[commandIndex];
+        BopItInputBenchmark_CommandList[commandIndex] = &BopItInputBenchmark_Commands[commandIndex];
+    }
+
+
+    BopItInputBenchmark_Result_t perCommand = BopItInputBenchmark_Play(games, seed, false);
+    BopItInputBenchmark_Result_t provider = BopItInputBenchmark_Play(games, seed, true);
+
+    double perCommandNs = (perCommand.WaitCalls > 0U) ? ((double)perCommand.Time / (double)perCommand.WaitCalls) : 0.0;
+    double providerNs = (provider.WaitCalls > 0U) ? ((double)provider.Time / (double)provider.WaitCalls) : 0.0;
+
+    printf("BopIt input benchmark: %" PRIu32 " games, %" PRIu32 " commands, seed %" PRIu32 "\n", games, BOPITINPUTBENCHMARK_COMMAND_COUNT, seed);
+    printf("  Per command GetInput: %12" PRIu64 " wait calls %10.1f ns\n", perCommand.WaitCalls, perCommandNs);
+    printf("  Input provider:       %12" PRIu64 " wait calls %10.1f ns\n", provider.WaitCalls, providerNs);
+    printf("  Speedup:              %.1fx\n", (providerNs > 0.0) ? (perCommandNs / providerNs) : 0.0);
+
+    if (perCommand.Score != provider.Score || perCommand.Transitions != provider.Transitions || perCommand.WaitCalls != provider.WaitCalls)
+    {
+        printf("FAIL: games played with the input provider differ from games played with GetInput\n");
+        status = EXIT_FAILURE;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Play games against the simulated player.
+ *
+ * @param[in] games            Number of games to play
+ * @param[in] seed             Seed for the simulated player and command
+ * selection
+ * @param[in] useInputProvider Whether to check inputs with the game's input
+ * provider or with GetInput of each command
+ *
+ * @return Results of the games played
+ ******************************************************************************/
+static BopItInputBenchmark_Result_t BopItInputBenchmark_Play(const uint32_t games, const uint32_t seed, const bool useInputProvider)
+{
+    BopItInputBenchmark_Result_t result = {0};
+    Benchmark_TimeNs_t timerOverhead = Benchmark_GetTimerOverheadNs();
+
+    BopItInputBenchmark_GameContext.GetInputs = useInputProvider ? BopItInputBenchmark_GetInputs : NULL;
+    BopItInputBenchmark_RandomState = (seed == 0U) ? BOPITINPUTBENCHMARK_DEFAULT_SEED : seed;
+    VirtualClock_Set(0U);
+
+    for (uint32_t game = 0U; game < games; game++)
+    {
+        BopIt_Init(&BopItInputBenchmark_GameContext);
+        BopIt_Seed(&BopItInputBenchmark_GameContext, seed + game);
+
+        BopIt_GameState_t state;
+
+        do
+        {
+            state = BopItInputBenchmark_GameContext.GameState;
+
+            Benchmark_TimeNs_t start = Benchmark_GetTimeNs();
+            BopIt_Run(&BopItInputBenchmark_GameContext);
+            Benchmark_TimeNs_t time = Benchmark_GetTimeNs() - start;
+
+            if (state == BOPIT_GAMESTATE_WAIT)
+            {
+                result.WaitCalls++;
+                result.Time += (time > timerOverhead) ? (time - timerOverhead) : 0U;
+            }
+            if (BopItInputBenchmark_GameContext.GameState != state)
+            {
+                result.Transitions++;
+            }
+
+            VirtualClock_Advance(BOPITINPUTBENCHMARK_RUN_DELAY_US);
+        } while (state != BOPIT_GAMESTATE_END);
+
+        result.Score += BopItInputBenchmark_GameContext.Score;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Get a pseudo random number for the simulated player.  Uses xorshift32
+ * so the player behaves the same on every host.
+ *
+ * @return Pseudo random number
+ ******************************************************************************/
+static uint32_t BopItInputBenchmark_Random(void)
+{
+    BopItInputBenchmark_RandomState ^= BopItInputBenchmark_RandomState << 13U;
+    BopItInputBenchmark_RandomState ^= BopItInputBenchmark_RandomState >> 17U;
+    BopItInputBenchmark_RandomState ^= BopItInputBenchmark_RandomState << 5U;
+
+    return BopItInputBenchmark_RandomState;
+}
+
+/**
+ * @brief Discard log messages so output does not dominate the measurement.
+ *
+ * @param[in] gameContext Context for the game logging the message, unused
+ * @param[in] message     Message to log
+ ******************************************************************************/
+static void BopItInputBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message)
+{
+    (void)gameContext;
+    (void)message;
+}
+
+/**
+ * @brief Check if the simulated player pressed the input for a command.
+ *
+ * @param[in]  commandIndex Index of the command to check
+ * @param[out] inputTime    Virtual time at which the input was pressed
+ *
+ * @return Whether the input for the command was pressed or not
+ ******************************************************************************/
+static bool BopItInputBenchmark_GetInput(const uint32_t commandIndex, BopIt_TimeUs_t *const inputTime)
+{
+    BopIt_Inputs_t input = (BopIt_Inputs_t)1U << commandIndex;
+    bool pressed = false;
+
+    if ((BopItInputBenchmark_Pressed & input) != 0U && VirtualClock_GetTime() >= BopItInputBenchmark_PressTime)
+    {
+        pressed = true;
+        *inputTime = BopItInputBenchmark_PressTime;
+        BopItInputBenchmark_Pressed &= ~input;
+    }
+
+    return pressed;
+}
+
+/**
+ * @brief Get all inputs the simulated player pressed.
+ *
+ * @param[in]  gameContext Context for the game, unused
+ * @param[out] inputTime   Virtual time at which the inputs were pressed
+ *
+ * @return Bitmask of the inputs pressed
+ ******************************************************************************/
+static BopIt_Inputs_t BopItInputBenchmark_GetInputs(BopIt_GameContext_t *const gameContext, BopIt_TimeUs_t *const inputTime)
+{
+    BopIt_Inputs_t inputs = 0U;
+
+    (void)gameContext;
+
+    if (VirtualClock_GetTime() >= BopItInputBenchmark_PressTime)
+    {
+        inputs = BopItInputBenchmark_Pressed;
+        *inputTime = BopItInputBenchmark_PressTime;
+        BopItInputBenchmark_Pressed = 0U;
+    }
+
+    return inputs;
+}
+
+/**
+ * @brief Have the simulated player react to the command just issued.  The
+ * player either presses the correct input, presses a wrong input or does not
+ * press anything, after a random reaction time.
+ ******************************************************************************/
+static void BopItInputBenchmark_IssueCommand(void)
+{
+    uint32_t commandIndex = BopItInputBenchmark_GameContext.CurrentCommandIndex;
+    uint32_t roll = BopItInputBenchmark_Random() % 100U;
+
+    if (roll < BOPITINPUTBENCHMARK_CORRECT_PERCENT)
+    {
+        BopItInputBenchmark_Pressed = (BopIt_Inputs_t)1U << commandIndex;
+    }
+    else if (roll < (BOPITINPUTBENCHMARK_CORRECT_PERCENT + BOPITINPUTBENCHMARK_WRONG_PERCENT))
+    {
+        BopItInputBenchmark_Pressed = (BopIt_Inputs_t)1U << ((commandIndex + 1U) % BOPITINPUTBENCHMARK_COMMAND_COUNT);
+    }
+    else
+    {
+        BopItInputBenchmark_Pressed = 0U;
+    }
+
+    BopItInputBenchmark_PressTime = VirtualClock_GetTime() + BOPITINPUTBENCHMARK_MIN_REACTION_TIME_US + (BopItInputBenchmark_Random() % (BOPITINPUTBENCHMARK_MAX_REACTION_TIME_US - BOPITINPUTBENCHMARK_MIN_REACTION_TIME_US));
+}
+
+/**
+ * @brief Feedback for the simulated player, does nothing.
+ ******************************************************************************/
+static void BopItInputBenchmark_Feedback(void)
+{
+}
@@ -0,0 +1,535 @@
+/**
+ * @file BopItSimulator.c
+ *
+ * @brief Monte Carlo simulator for tuning the BopIt difficulty curve.  Plays
+ * many games through the real BopIt engine on a pool of worker threads, each
+ * game against a simulated player whose reaction times follow an ex-Gaussian
+ * distribution, a normal distribution plus an exponential tail, and who
+ * presses a wrong input or misses a command at configurable rates.
+ *
+ * Games run on an event driven virtual clock that jumps straight to the next
+ * press or deadline, so a game costs only a few calls to BopIt_Run.  Each game
+ * is seeded from its index, so results do not depend on the number of threads
+ * and the printed checksum can be compared between runs.
+ *
+ * Prints the distributions of final scores, remaining lives and game lengths.
+ * The difficulty curve is one of linear, exponential, stepped or adaptive.
+ *
+ * Usage: BopItSimulator [games] [threads] [mean ms] [deviation ms] [tail ms] [wrong %] [miss %] [seed] [curve]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "BopIt.h"
+#include "Prng.h"
+#include "WorkPool.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define BOPITSIMULATOR_DEFAULT_GAMES 1000000U             /* Number of games played if not specified */
+#define BOPITSIMULATOR_DEFAULT_MEAN_MS 350.0              /* Mean of the normal part of reaction times if not specified */
+#define BOPITSIMULATOR_DEFAULT_DEVIATION_MS 60.0          /* Standard deviation of the normal part of reaction times if not specified */
+#define BOPITSIMULATOR_DEFAULT_TAIL_MS 150.0              /* Mean of the exponential part of reaction times if not specified */
+#define BOPITSIMULATOR_DEFAULT_WRONG_PERCENT 3.0          /* Chance of pressing a wrong input if not specified */
+#define BOPITSIMULATOR_DEFAULT_MISS_PERCENT 2.0           /* Chance of not pressing anything if not specified */
+#define BOPITSIMULATOR_DEFAULT_SEED 1U                    /* Seed of the simulation if not specified */
+#define BOPITSIMULATOR_MIN_REACTION_TIME_MS 100.0         /* Fastest possible reaction time */
+#define BOPITSIMULATOR_COMMAND_COUNT 3U                   /* Number of commands, matches the firmware */
+#define BOPITSIMULATOR_CHUNK 256U                         /* Number of games a worker takes at a time */
+#define BOPITSIMULATOR_SCORE_BINS 10U                     /* Number of bins of the score histogram */
+#define BOPITSIMULATOR_LIVES_BINS 4U                      /* Number of bins of the remaining lives histogram, the last one counts any more lives */
+#define BOPITSIMULATOR_LENGTH_BIN_S 30U                   /* Width of the bins of the game length histogram in seconds */
+#define BOPITSIMULATOR_LENGTH_BINS 12U                    /* Number of bins of the game length histogram, the last one counts any longer games */
+#define BOPITSIMULATOR_BAR_WIDTH 50U                      /* Width of the longest histogram bar in characters */
+#define BOPITSIMULATOR_PLAYER_SEQUENCE 1U                 /* Sequence of the players' generators, distinct from the games' */
+#define BOPITSIMULATOR_SEED_MIX 0x9E3779B97F4A7C15ULL     /* Mixed with the game index to seed each game */
+#define BOPITSIMULATOR_US_PER_S 1000000U                  /* Microseconds per second */
+#define BOPITSIMULATOR_US_PER_MS 1000.0                   /* Microseconds per millisecond */
+#define BOPITSIMULATOR_NS_PER_S 1000000000.0              /* Nanoseconds per second */
+#define BOPITSIMULATOR_TWO_PI 6.283185307179586           /* Two pi */
+#define BOPITSIMULATOR_UNIFORM_SCALE (1.0 / 4294967296.0) /* Scales a 32-bit number to [0, 1) */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Simulated player */
+typedef struct
+{
+    double MeanMs;       /* Mean of the normal part of reaction times */
+    double DeviationMs;  /* Standard deviation of the normal part of reaction times */
+    double TailMs;       /* Mean of the exponential part of reaction times */
+    double WrongPercent; /* Chance of pressing a wrong input */
+    double MissPercent;  /* Chance of not pressing anything */
+} BopItSimulator_PlayerConfig_t;
+
+/* State of the simulated player of a single game */
+typedef struct
+{
+    Prng_t Prng;              /* Player's generator */
+    BopIt_TimeUs_t Time;      /* Virtual time of the game */
+    BopIt_TimeUs_t WaitStart; /* Start of the wait the player last reacted to */
+    BopIt_Inputs_t Pressed;   /* Inputs the player will press */
+    BopIt_TimeUs_t PressTime; /* Virtual time at which the player presses */
+} BopItSimulator_Player_t;
+
+/* Results accumulated by a single worker */
+typedef struct
+{
+    _Alignas(64) uint64_t Scores[BOPIT_MAX_SCORE + 1U]; /* Number of games ending with each score */
+    uint64_t Lives[BOPITSIMULATOR_LIVES_BINS];          /* Number of games ending with each number of lives */
+    uint64_t Lengths[BOPITSIMULATOR_LENGTH_BINS];       /* Number of games of each length */
+    uint64_t Reactions;                                 /* Number of reaction times measured */
+    uint64_t ReactionTimeUs;                            /* Sum of reaction times measured */
+    uint64_t Checksum;                                  /* Sum of a hash of each game's result, independent of the order games are played in */
+    BopIt_GameContext_t GameContext;                    /* Context reused for every game played by the worker */
+    BopIt_Reaction_t ReactionBuffer[BOPIT_MAX_SCORE];   /* Reaction times kept by the engine in the game being played by the worker */
+    BopItSimulator_Player_t Player;                     /* Player reused for every game played by the worker */
+} BopItSimulator_Worker_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void BopItSimulator_Play(void *const context, const uint32_t worker, const uint32_t begin, const uint32_t end);
+static double BopItSimulator_Uniform(Prng_t *const prng);
+static BopIt_TimeUs_t BopItSimulator_ReactionTime(Prng_t *const prng);
+static void BopItSimulator_PrintHistogram(const char *const title, const uint64_t *const counts, const uint32_t bins, const uint32_t binWidth, const bool lastIsOpen);
+static BopIt_TimeUs_t BopItSimulator_Time(const BopIt_GameContext_t *const gameContext);
+static BopIt_Inputs_t BopItSimulator_GetInputs(BopIt_GameContext_t *const gameContext, BopIt_TimeUs_t *const inputTime);
+static void BopItSimulator_Logger(const BopIt_GameContext_t *const gameContext, const char *const message);
+static bool BopItSimulator_GetInput(BopIt_TimeUs_t *const inputTime);
+static void BopItSimulator_Command(void);
+
+/* Globals
+ ******************************************************************************/
+
+static BopIt_Command_t BopItSimulator_Commands[BOPITSIMULATOR_COMMAND_COUNT] = {
+    {"Command 0", BopItSimulator_Command, BopItSimulator_Command, BopItSimulator_Command, BopItSimulator_GetInput, NULL, 0U},
+    {"Command 1", BopItSimulator_Command, BopItSimulator_Command, BopItSimulator_Command, BopItSimulator_GetInput, NULL, 0U},
+    {"Command 2", BopItSimulator_Command, BopItSimulator_Command, BopItSimulator_Command, BopItSimulator_GetInput, NULL, 0U},
+};
+static BopIt_Command_t *BopItSimulator_CommandList[BOPITSIMULATOR_COMMAND_COUNT] = {&BopItSimulator_Commands[0], &BopItSimulator_Commands[1], &BopItSimulator_Commands[2]};
+
+static BopItSimulator_PlayerConfig_t BopItSimulator_PlayerConfig = {
+    .MeanMs = BOPITSIMULATOR_DEFAULT_MEAN_MS,
+    .DeviationMs = BOPITSIMULATOR_DEFAULT_DEVIATION_MS,
+    .TailMs = BOPITSIMULATOR_DEFAULT_TAIL_MS,
+    .WrongPercent = BOPITSIMULATOR_DEFAULT_WRONG_PERCENT,
+    .MissPercent = BOPITSIMULATOR_DEFAULT_MISS_PERCENT,
+};
+static uint64_t BopItSimulator_Seed = BOPITSIMULATOR_DEFAULT_SEED; /* Seed of the simulation */
+static BopIt_Curve_t BopItSimulator_Curve = BOPIT_CURVE_LINEAR;    /* Difficulty curve of every game */
+static const char *BopItSimulator_CurveNames[BOPIT_CURVE_COUNT] = {"linear", "exponential", "stepped", "adaptive"};
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t games = BOPITSIMULATOR_DEFAULT_GAMES;
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t threads = (processors > 0) ? (uint32_t)processors : 1U;
+    BopItSimulator_Worker_t *workers;
+    WorkPool_Stats_t stats[WORKPOOL_MAX_WORKERS];
+    BopItSimulator_Worker_t total;
+    uint64_t played = 0U;
+    uint64_t cumulative = 0U;
+    uint32_t percentiles[3U] = {0U};
+    const uint32_t percentileTargets[3U] = {5U, 50U, 95U};
+    uint32_t percentile = 0U;
+    double scoreSum = 0.0;
+
+    if (argc > 1)
+    {
+        games = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        threads = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3)
+    {
+        BopItSimulator_PlayerConfig.MeanMs = strtod(argv[3], NULL);
+    }
+    if (argc > 4)
+    {
+        BopItSimulator_PlayerConfig.DeviationMs = strtod(argv[4], NULL);
+    }
+    if (argc > 5)
+    {
+        BopItSimulator_PlayerConfig.TailMs = strtod(argv[5], NULL);
+    }
+    if (argc > 6)
+    {
+        BopItSimulator_PlayerConfig.WrongPercent = strtod(argv[6], NULL);
+    }
+    if (argc > 7)
+    {
+        BopItSimulator_PlayerConfig.MissPercent = strtod(argv[7], NULL);
+    }
+    if (argc > 8)
+    {
+        BopItSimulator_Seed = strtoull(argv[8], NULL, 0);
+    }
+    if (argc > 9)
+    {
+        BopItSimulator_Curve = BOPIT_CURVE_COUNT;
+        for (uint32_t curve = 0U; curve < BOPIT_CURVE_COUNT; curve++)
+        {
+            if (strcmp(argv[9], BopItSimulator_CurveNames[curve]) == 0)
+            {
+                BopItSimulator_Curve = (BopIt_Curve_t)curve;
+            }
+        }
+        if (BopItSimulator_Curve == BOPIT_CURVE_COUNT)
+        {
+            printf("Unknown curve %s\n", argv[9]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (games == 0U)
+    {
+        games = BOPITSIMULATOR_DEFAULT_GAMES;
+    }
+    if (threads == 0U || threads > WORKPOOL_MAX_WORKERS)
+    {
+        threads = (threads == 0U) ? 1U : WORKPOOL_MAX_WORKERS;
+    }
+
+    workers = aligned_alloc(_Alignof(BopItSimulator_Worker_t), threads * sizeof(BopItSimulator_Worker_t));
+    if (workers == NULL)
+    {
+        printf("Failed to allocate workers\n");
+        return EXIT_FAILURE;
+    }
+    memset(workers, 0, threads * sizeof(BopItSimulator_Worker_t));
+
+    Benchmark_TimeNs_t start = Benchmark_GetTimeNs();
+    bool completed = WorkPool_Run(threads, games, BOPITSIMULATOR_CHUNK, BopItSimulator_Play, workers, stats);
+    Benchmark_TimeNs_t simulationTime = Benchmark_GetTimeNs() - start;
+
+    /* Merge the results of all workers */
+    memset(&total, 0, sizeof(total));
+    for (uint32_t worker = 0U; worker < threads; worker++)
+    {
+        for (uint32_t score = 0U; score <= BOPIT_MAX_SCORE; score++)
+        {
+            total.Scores[score] += workers[worker].Scores[score];
+        }
+        for (uint32_t lives = 0U; lives < BOPITSIMULATOR_LIVES_BINS; lives++)
+        {
+            total.Lives[lives] += workers[worker].Lives[lives];
+        }
+        for (uint32_t length = 0U; length < BOPITSIMULATOR_LENGTH_BINS; length++)
+        {
+            total.Lengths[length] += workers[worker].Lengths[length];
+        }
+        total.Reactions += workers[worker].Reactions;
+        total.ReactionTimeUs += workers[worker].ReactionTimeUs;
+        total.Checksum += workers[worker].Checksum;
+    }
+
+    for (uint32_t score = 0U; score <= BOPIT_MAX_SCORE; score++)
+    {
+        played += total.Scores[score];
+        scoreSum += (double)score * (double)total.Scores[score];
+    }
+    for (uint32_t score = 0U; score <= BOPIT_MAX_SCORE && percentile < 3U; score++)
+    {
+        cumulative += total.Scores[score];
+        while (percentile < 3U && (cumulative * 100U) >= ((uint64_t)percentileTargets[percentile] * played))
+        {
+            percentiles[percentile] = score;
+            percentile++;
+        }
+    }
+
+    printf("BopIt simulator: %" PRIu64 " games on %" PRIu32 " threads, seed %" PRIu64 ", %s curve\n", played, threads, BopItSimulator_Seed, BopItSimulator_CurveNames[BopItSimulator_Curve]);
+    printf("  Player: reaction %.0f ms +/- %.0f ms + %.0f ms tail, %.1f%% wrong, %.1f%% missed\n", BopItSimulator_PlayerConfig.MeanMs, BopItSimulator_PlayerConfig.DeviationMs, BopItSimulator_PlayerConfig.TailMs, BopItSimulator_PlayerConfig.WrongPercent, BopItSimulator_PlayerConfig.MissPercent);
+    printf("  Simulation time:     %.3f ms\n", (double)simulationTime / 1e6);
+    printf("  Games/sec:           %.0f\n", (simulationTime > 0U) ? ((double)played * BOPITSIMULATOR_NS_PER_S / (double)simulationTime) : 0.0);
+    for (uint32_t worker = 0U; worker < threads; worker++)
+    {
+        printf("    Worker %2" PRIu32 ": %10" PRIu64 " games, %6" PRIu64 " steals\n", worker, stats[worker].Items, stats[worker].Steals);
+    }
+    printf("  Checksum:            %016" PRIx64 "\n", total.Checksum);
+    printf("  Score:               mean %.2f, p5 %" PRIu32 ", p50 %" PRIu32 ", p95 %" PRIu32 ", %.3f%% reach %" PRIu32 "\n", (played > 0U) ? (scoreSum / (double)played) : 0.0, percentiles[0U], percentiles[1U], percentiles[2U],
+           (played > 0U) ? (100.0 * (double)total.Scores[BOPIT_MAX_SCORE] / (double)played) : 0.0, BOPIT_MAX_SCORE);
+    printf("  Mean reaction time:  %.1f ms\n", (total.Reactions > 0U) ? ((double)total.ReactionTimeUs / BOPITSIMULATOR_US_PER_MS / (double)total.Reactions) : 0.0);
+
+    /* Fold scores into bins of equal width for printing */
+    uint64_t scoreBins[BOPITSIMULATOR_SCORE_BINS] = {0U};
+    uint32_t scoreBinWidth = (BOPIT_MAX_SCORE + BOPITSIMULATOR_SCORE_BINS) / BOPITSIMULATOR_SCORE_BINS;
+    for (uint32_t score = 0U; score <= BOPIT_MAX_SCORE; score++)
+    {
+        scoreBins[score / scoreBinWidth] += total.Scores[score];
+    }
+
+    BopItSimulator_PrintHistogram("Score", scoreBins, BOPITSIMULATOR_SCORE_BINS, scoreBinWidth, false);
+    BopItSimulator_PrintHistogram("Lives remaining", total.Lives, BOPITSIMULATOR_LIVES_BINS, 1U, true);
+    BopItSimulator_PrintHistogram("Game length (s)", total.Lengths, BOPITSIMULATOR_LENGTH_BINS, BOPITSIMULATOR_LENGTH_BIN_S, true);
+
+    free(workers);
+
+    return completed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Play a range of games on a worker.  Each game is seeded from the
+ * simulation seed and its index.
+ *
+ * @param[in,out] context Array of workers
+ * @param[in]     worker  Index of the worker playing the games
+ * @param[in]     begin   Index of the first game
+ * @param[in]     end     One past the index of the last game
+ ******************************************************************************/
+static void BopItSimulator_Play(void *const context, const uint32_t worker, const uint32_t begin, const uint32_t end)
+{
+    BopItSimulator_Worker_t *results = &((BopItSimulator_Worker_t *)context)[worker];
+    BopIt_GameContext_t *gameContext = &results->GameContext;
+    BopItSimulator_Player_t *player = &results->Player;
+    BopIt_GameState_t state;
+    BopIt_TimeUs_t delay;
+    BopIt_TimeUs_t nextTime;
+    uint64_t seed;
+    uint32_t lengthBin;
+
+    gameContext->Commands = BopItSimulator_CommandList;
+    gameContext->CommandCount = BOPITSIMULATOR_COMMAND_COUNT;
+    gameContext->GetInputs = BopItSimulator_GetInputs;
+    gameContext->Time = BopItSimulator_Time;
+    gameContext->Selection = BOPIT_SELECTION_UNIFORM;
+    gameContext->Curve = BopItSimulator_Curve;
+    gameContext->CommandWeights = NULL;
+    gameContext->Logger = BopItSimulator_Logger;
+    gameContext->LogRing = NULL;
+    gameContext->TraceRing = NULL;
+    gameContext->Reactions = results->ReactionBuffer;
+    gameContext->UserData = player;
+    gameContext->OnGameStart = NULL;
+    gameContext->OnGameEnd = NULL;
+
+    for (uint32_t game = begin; game < end; game++)
+    {
+        seed = BopItSimulator_Seed + ((uint64_t)game * BOPITSIMULATOR_SEED_MIX);
+        Prng_Seed(&player->Prng, seed, BOPITSIMULATOR_PLAYER_SEQUENCE);
+        player->Time = 0U;
+        player->WaitStart = UINT64_MAX;
+        player->Pressed = 0U;
+
+        BopIt_Init(gameContext);
+        BopIt_Seed(gameContext, seed);
+
+        /* Jump the clock straight to the next press or deadline */
+        do
+        {
+            state = gameContext->GameState;
+            BopIt_Run(gameContext);
+
+            delay = BopIt_GetRunDelay(gameContext);
+            if (delay > 0U && delay != BOPIT_RUN_DELAY_INFINITE)
+            {
+                nextTime = player->Time + delay;
+                if (player->Pressed != 0U && player->PressTime < nextTime)
+                {
+                    nextTime = player->PressTime;
+                }
+                player->Time = nextTime;
+            }
+        } while (state != BOPIT_GAMESTATE_END);
+
+        results->Scores[gameContext->Score]++;
+        results->Lives[(gameContext->Lives < BOPITSIMULATOR_LIVES_BINS) ? gameContext->Lives : (BOPITSIMULATOR_LIVES_BINS - 1U)]++;
+        lengthBin = player->Time / (BOPITSIMULATOR_LENGTH_BIN_S * BOPITSIMULATOR_US_PER_S);
+        results->Lengths[(lengthBin < BOPITSIMULATOR_LENGTH_BINS) ? lengthBin : (BOPITSIMULATOR_LENGTH_BINS - 1U)]++;
+        for (uint32_t reaction = 0U; reaction < gameContext->ReactionCount; reaction++)
+        {
+            results->ReactionTimeUs += gameContext->Reactions[reaction].Time;
+        }
+        results->Reactions += gameContext->ReactionCount;
+        results->Checksum += (((uint64_t)game << 32U) | ((uint64_t)gameContext->Score << 16U) | player->Time) * BOPITSIMULATOR_SEED_MIX;
+    }
+}
+
+/**
+ * @brief Get a uniformly distributed number in (0, 1).
+ *
+ * @param[in,out] prng Generator
+ *
+ * @return Uniformly distributed number, never 0
+ ******************************************************************************/
+static double BopItSimulator_Uniform(Prng_t *const prng)
+{
+    return ((double)Prng_Next(prng) + 0.5) * BOPITSIMULATOR_UNIFORM_SCALE;
+}
+
+/**
+ * @brief Draw a reaction time of the simulated player from an ex-Gaussian
+ * distribution, the sum of a normally and an exponentially distributed time.
+ *
+ * @param[in,out] prng Player's generator
+ *
+ * @return Reaction time in microseconds
+ ******************************************************************************/
+static BopIt_TimeUs_t BopItSimulator_ReactionTime(Prng_t *const prng)
+{
+    /* Box-Muller transform for the normal part */
+    double normal = sqrt(-2.0 * log(BopItSimulator_Uniform(prng))) * cos(BOPITSIMULATOR_TWO_PI * BopItSimulator_Uniform(prng));
+    double reactionTime = BopItSimulator_PlayerConfig.MeanMs + (BopItSimulator_PlayerConfig.DeviationMs * normal) - (BopItSimulator_PlayerConfig.TailMs * log(BopItSimulator_Uniform(prng)));
+
+    if (reactionTime < BOPITSIMULATOR_MIN_REACTION_TIME_MS)
+    {
+        reactionTime = BOPITSIMULATOR_MIN_REACTION_TIME_MS;
+    }
+
+    return (BopIt_TimeUs_t)(reactionTime * BOPITSIMULATOR_US_PER_MS);
+}
+
+/**
+ * @brief Print a histogram with a bar for each bin.
+ *
+ * @param[in] title      Title of the histogram
+ * @param[in] counts     Count of each bin
+ * @param[in] bins       Number of bins
+ * @param[in] binWidth   Width of each bin
+ * @param[in] lastIsOpen Whether the last bin counts everything above it
+ ******************************************************************************/
+static void BopItSimulator_PrintHistogram(const char *const title, const uint64_t *const counts, const uint32_t bins, const uint32_t binWidth, const bool lastIsOpen)
+{
+    uint64_t maxCount = 0U;
+    uint64_t totalCount = 0U;
+    uint32_t barLength;
+    char label[32U];
+
+    for (uint32_t bin = 0U; bin < bins; bin++)
+    {
+        maxCount = (counts[bin] > maxCount) ? counts[bin] : maxCount;
+        totalCount += counts[bin];
+    }
+
+    printf("  %s:\n", title);
+    for (uint32_t bin = 0U; bin < bins; bin++)
+    {
+        if (lastIsOpen && bin == (bins - 1U))
+        {
+            snprintf(label, sizeof(label), "%" PRIu32 "+", bin * binWidth);
+        }
+        else if (binWidth == 1U)
+        {
+            snprintf(label, sizeof(label), "%" PRIu32, bin);
+        }
+        else
+        {
+            snprintf(label, sizeof(label), "%" PRIu32 "-%" PRIu32, bin * binWidth, ((bin + 1U) * binWidth) - 1U);
+        }
+
+        barLength = (maxCount > 0U) ? (uint32_t)((counts[bin] * BOPITSIMULATOR_BAR_WIDTH) / maxCount) : 0U;
+        printf("    %8s %6.2f%% |", label, (totalCount > 0U) ? (100.0 * (double)counts[bin] / (double)totalCount) : 0.0);
+        for (uint32_t bar = 0U; bar < barLength; bar++)
+        {
+            putchar('#');
+        }
+        putchar('\n');
+    }
+}
+
+/**
+ * @brief Get the virtual time of a game.
+ *
+ * @param[in] gameContext Context for the game
+ *
+ * @return Virtual time of the game in milliseconds
+ ******************************************************************************/
+static BopIt_TimeUs_t BopItSimulator_Time(const BopIt_GameContext_t *const gameContext)
+{
+    return ((const BopItSimulator_Player_t *)gameContext->UserData)->Time;
+}
+
+/**
+ * @brief Get the inputs the simulated player pressed.  The first time it is
+ * called for a command, the player decides to press the correct input, a
+ * wrong input or nothing, and draws a reaction time.
+ *
+ * @param[in]  gameContext Context for the game
+ * @param[out] inputTime   Virtual time at which the inputs were pressed
+ *
+ * @return Bitmask of the inputs pressed
+ ******************************************************************************/
+static BopIt_Inputs_t BopItSimulator_GetInputs(BopIt_GameContext_t *const gameContext, BopIt_TimeUs_t *const inputTime)
+{
+    BopItSimulator_Player_t *player = (BopItSimulator_Player_t *)gameContext->UserData;
+    BopIt_Inputs_t inputs = 0U;
+    double roll;
+
+    if (player->WaitStart != gameContext->WaitStart)
+    {
+        /* React to a newly issued command */
+        player->WaitStart = gameContext->WaitStart;
+        roll = 100.0 * BopItSimulator_Uniform(&player->Prng);
+        if (roll < BopItSimulator_PlayerConfig.MissPercent)
+        {
+            player->Pressed = 0U;
+        }
+        else if (roll < (BopItSimulator_PlayerConfig.MissPercent + BopItSimulator_PlayerConfig.WrongPercent))
+        {
+            player->Pressed = (BopIt_Inputs_t)1U << ((gameContext->CurrentCommandIndex + 1U + Prng_Bounded(&player->Prng, BOPITSIMULATOR_COMMAND_COUNT - 1U)) % BOPITSIMULATOR_COMMAND_COUNT);
+        }
+        else
+        {
+            player->Pressed = (BopIt_Inputs_t)1U << gameContext->CurrentCommandIndex;
+        }
+        player->PressTime = gameContext->WaitStart + BopItSimulator_ReactionTime(&player->Prng);
+    }
+
+    if (player->Pressed != 0U && player->Time >= player->PressTime)
+    {
+        inputs = player->Pressed;
+        *inputTime = player->PressTime;
+        player->Pressed = 0U;
+    }
+
+    return inputs;
+}
+
+/**
+ * @brief Discard log messages of simulated games.
+ *
+ * @param[in] gameContext Unused
+ * @param[in] message     Unused
+ ******************************************************************************/
+static void BopItSimulator_Logger(const BopIt_GameContext_t *const gameContext, const char *const message)
+{
+    (void)gameContext;
+    (void)message;
+}
+
+/**
+ * @brief Input of a single command, never used since every game has an input
+ * provider.
+ *
+ * @param[out] inputTime Unused
+ *
+ * @return false
+ ******************************************************************************/
+static bool BopItSimulator_GetInput(BopIt_TimeUs_t *const inputTime)
+{
+    (void)inputTime;
+
+    return false;
+}
+
+/**
+ * @brief Command callbacks, do nothing since the player reacts through the
+ * input provider.
+ ******************************************************************************/
+static void BopItSimulator_Command(void)
+{
+}
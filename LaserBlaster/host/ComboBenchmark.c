@@ -0,0 +1,790 @@
+/**
+ * @file ComboBenchmark.c
+ *
+ * @brief Benchmark of the Combo pattern matcher behind BopIt's combo
+ * commands.  First matches scripted event sequences against sequences,
+ * chords, holds and deadlines, checking each is matched or failed at exactly
+ * the expected time, and checks malformed patterns are rejected.  Then
+ * matches random patterns of increasing length against a simulated player who
+ * completes them, reporting the cost of matching an event for each length,
+ * which should not grow with the length of the pattern, and the heap
+ * allocations made while matching.  Finally plays BopIt games of combo
+ * commands against the simulated player on a virtual clock, one completing
+ * every command and one fumbling every few, checking every command is judged
+ * as played at the time its pattern was completed.
+ *
+ * If a trace file is given, the games' trace records are saved to it for
+ * replaying with TraceReplay.
+ *
+ * Exits with a failure status if any pattern is matched or failed wrongly or
+ * at the wrong time, the matcher allocates, or a game is judged wrongly.
+ *
+ * Usage: ComboBenchmark [seed] [trace file]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "BopIt.h"
+#include "Combo.h"
+#include "LogRing.h"
+#include "Prng.h"
+#include "VirtualClock.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define COMBOBENCHMARK_DEFAULT_SEED 1U                                              /* Seed of the random patterns and command selection if not specified */
+#define COMBOBENCHMARK_MAX_STEPS 256U                                               /* Most steps of a random pattern */
+#define COMBOBENCHMARK_STEP_SIZE 15U                                                /* Most bytes of a random step, a WITHIN and the largest chord */
+#define COMBOBENCHMARK_MAX_EVENTS 4096U                                             /* Most events played for a pattern, a press and a release per input of every step */
+#define COMBOBENCHMARK_LENGTH_COUNT 5U                                              /* Number of pattern lengths benchmarked */
+#define COMBOBENCHMARK_EVENTS_TIMED 2000000U                                        /* Number of events matched for each pattern length */
+#define COMBOBENCHMARK_INPUT_COUNT 8U                                               /* Number of inputs random patterns use */
+#define COMBOBENCHMARK_WITHIN_PERCENT 50U                                           /* Chance of a random step having a deadline */
+#define COMBOBENCHMARK_PERCENT 100U                                                 /* Scale of a percentage */
+#define COMBOBENCHMARK_WITHIN_MS 500U                                               /* Deadline of random steps, longer than any step takes to play */
+#define COMBOBENCHMARK_CHORD_WINDOW_MS 100U                                         /* Window of random chords, longer than any chord takes to play */
+#define COMBOBENCHMARK_MIN_HOLD_MS 100U                                             /* Shortest random hold */
+#define COMBOBENCHMARK_HOLD_RANGE_MS 200U                                           /* Range of the random part of a hold */
+#define COMBOBENCHMARK_REACTION_US 150000U                                          /* Time from the start of a pattern to the player's first press */
+#define COMBOBENCHMARK_CHORD_PRESS_US 5000U                                         /* Time between presses of a chord */
+#define COMBOBENCHMARK_RELEASE_US 20000U                                            /* Time from completing a step to releasing its inputs */
+#define COMBOBENCHMARK_STEP_GAP_US 30000U                                           /* Time from completing a step to the first press of the next */
+#define COMBOBENCHMARK_COMMAND_COUNT 3U                                             /* Number of commands of the games */
+#define COMBOBENCHMARK_FUMBLE_EVERY 5U                                              /* The fumbling player presses a wrong input instead of every fifth command */
+#define COMBOBENCHMARK_FUMBLE_INPUT 7U                                              /* Input no command's pattern uses, pressed when fumbling */
+#define COMBOBENCHMARK_QUEUE_SIZE 64U                                               /* Number of events the player's queue can hold */
+#define COMBOBENCHMARK_TRACE_RING_SIZE 64U                                          /* Number of records the trace ring can hold, drained after every call to BopIt_Run */
+#define COMBOBENCHMARK_US_PER_MS 1000U                                              /* Microseconds per millisecond */
+#define COMBOBENCHMARK_MS(time) ((Combo_TimeUs_t)(time) * COMBOBENCHMARK_US_PER_MS) /* Time in microseconds of a time in milliseconds */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Scripted event sequence and the expected outcome of matching it */
+typedef struct
+{
+    const char *Name;            /* Name of the case */
+    const uint8_t *Pattern;      /* Pattern matched, started at time 0 */
+    uint32_t PatternSize;        /* Size of the pattern in bytes */
+    const Combo_Event_t *Events; /* Events fed */
+    uint32_t EventCount;         /* Number of events fed */
+    Combo_TimeUs_t PollTime;     /* Time the matcher is polled at after the events */
+    Combo_Result_t Result;       /* Expected result */
+    Combo_TimeUs_t EndTime;      /* Expected time the pattern was matched or failed */
+} ComboBenchmark_Case_t;
+
+/* Malformed pattern */
+typedef struct
+{
+    const char *Name;       /* Name of the case */
+    const uint8_t *Pattern; /* Pattern, must be rejected */
+    uint32_t PatternSize;   /* Size of the pattern in bytes */
+} ComboBenchmark_Malformed_t;
+
+/* Outcome of a game */
+typedef struct
+{
+    uint32_t Successes;       /* Number of commands judged completed */
+    uint32_t Failures;        /* Number of commands judged failed */
+    uint32_t WrongJudgements; /* Number of commands judged otherwise than played */
+    uint32_t WrongReactions;  /* Number of reaction times differing from when the pattern was completed */
+    uint8_t Score;            /* Final score */
+} ComboBenchmark_Game_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static uint32_t ComboBenchmark_RunCases(void);
+static uint32_t ComboBenchmark_RunLengths(const uint32_t seed);
+static uint32_t ComboBenchmark_Generate(uint8_t *const pattern, const uint32_t steps);
+static uint32_t ComboBenchmark_Play(const uint8_t *const pattern, const Combo_TimeUs_t start, Combo_Event_t *const events, const uint32_t maxEvents, Combo_TimeUs_t *const endTime);
+static bool ComboBenchmark_AddEvent(Combo_Event_t *const events, uint32_t *const count, const uint32_t maxEvents, const Combo_TimeUs_t time, const uint8_t input, const bool released);
+static ComboBenchmark_Game_t ComboBenchmark_PlayGame(const uint32_t seed, const uint32_t fumbleEvery);
+static bool ComboBenchmark_GetEvent(BopIt_GameContext_t *const gameContext, Combo_Event_t *const event);
+static void ComboBenchmark_IssueCommand(void);
+static void ComboBenchmark_SuccessFeedback(void);
+static void ComboBenchmark_FailFeedback(void);
+static bool ComboBenchmark_GetInput(BopIt_TimeUs_t *const inputTime);
+static void ComboBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message);
+static void ComboBenchmark_Drain(void);
+
+/* Globals
+ ******************************************************************************/
+
+/* Input 0 then input 2 within 300 ms */
+static const uint8_t ComboBenchmark_SequencePattern[] = {COMBO_PRESS(0U), COMBO_WITHIN(300U), COMBO_PRESS(2U), COMBO_END};
+
+/* Inputs 0, 1 and 2 within 50 ms of each other */
+static const uint8_t ComboBenchmark_ChordPattern[] = {COMBO_CHORD(50U, 3U), 0U, 1U, 2U, COMBO_END};
+
+/* Input 1 held for 500 ms */
+static const uint8_t ComboBenchmark_HoldPattern[] = {COMBO_HOLD(1U, 500U), COMBO_END};
+
+/* Input 1 held for 500 ms, within 400 ms of the start */
+static const uint8_t ComboBenchmark_ShortHoldPattern[] = {COMBO_WITHIN(400U), COMBO_HOLD(1U, 500U), COMBO_END};
+
+/* Input 0, input 1 held for 300 ms within 500 ms, then inputs 2 and 3 within 100 ms of each other within 200 ms */
+static const uint8_t ComboBenchmark_MixedPattern[] = {COMBO_PRESS(0U), COMBO_WITHIN(500U), COMBO_HOLD(1U, 300U), COMBO_WITHIN(200U), COMBO_CHORD(100U, 2U), 2U, 3U, COMBO_END};
+
+static const Combo_Event_t ComboBenchmark_SequenceEvents[] = {
+    {COMBOBENCHMARK_MS(100U), 0U, false},
+    {COMBOBENCHMARK_MS(150U), 0U, true},
+    {COMBOBENCHMARK_MS(350U), 2U, false},
+};
+static const Combo_Event_t ComboBenchmark_SequenceLateEvents[] = {
+    {COMBOBENCHMARK_MS(100U), 0U, false},
+    {COMBOBENCHMARK_MS(450U), 2U, false},
+};
+static const Combo_Event_t ComboBenchmark_SequenceWrongEvents[] = {
+    {COMBOBENCHMARK_MS(100U), 0U, false},
+    {COMBOBENCHMARK_MS(200U), 1U, false},
+};
+static const Combo_Event_t ComboBenchmark_ChordEvents[] = {
+    {COMBOBENCHMARK_MS(10U), 2U, false},
+    {COMBOBENCHMARK_MS(30U), 0U, false},
+    {COMBOBENCHMARK_MS(35U), 0U, true},
+    {COMBOBENCHMARK_MS(55U), 1U, false},
+};
+static const Combo_Event_t ComboBenchmark_ChordSlowEvents[] = {
+    {COMBOBENCHMARK_MS(10U), 2U, false},
+    {COMBOBENCHMARK_MS(30U), 0U, false},
+    {COMBOBENCHMARK_MS(70U), 1U, false},
+};
+static const Combo_Event_t ComboBenchmark_HoldEvents[] = {
+    {COMBOBENCHMARK_MS(100U), 1U, false},
+    {COMBOBENCHMARK_MS(700U), 1U, true},
+};
+static const Combo_Event_t ComboBenchmark_HoldEarlyEvents[] = {
+    {COMBOBENCHMARK_MS(100U), 1U, false},
+    {COMBOBENCHMARK_MS(400U), 1U, true},
+};
+static const Combo_Event_t ComboBenchmark_HoldPressEvents[] = {
+    {COMBOBENCHMARK_MS(100U), 1U, false},
+};
+static const Combo_Event_t ComboBenchmark_MixedEvents[] = {
+    {COMBOBENCHMARK_MS(50U), 0U, false},
+    {COMBOBENCHMARK_MS(80U), 0U, true},
+    {COMBOBENCHMARK_MS(200U), 1U, false},
+    {COMBOBENCHMARK_MS(650U), 3U, false},
+    {COMBOBENCHMARK_MS(660U), 1U, true},
+    {COMBOBENCHMARK_MS(690U), 2U, false},
+};
+static const Combo_Event_t ComboBenchmark_MixedLateEvents[] = {
+    {COMBOBENCHMARK_MS(50U), 0U, false},
+    {COMBOBENCHMARK_MS(300U), 1U, false},
+};
+
+static const ComboBenchmark_Case_t ComboBenchmark_Cases[] = {
+    {"Sequence", ComboBenchmark_SequencePattern, sizeof(ComboBenchmark_SequencePattern), ComboBenchmark_SequenceEvents, 3U, COMBOBENCHMARK_MS(350U), COMBO_RESULT_MATCHED, COMBOBENCHMARK_MS(350U)},
+    {"Sequence late", ComboBenchmark_SequencePattern, sizeof(ComboBenchmark_SequencePattern), ComboBenchmark_SequenceLateEvents, 2U, COMBOBENCHMARK_MS(450U), COMBO_RESULT_FAILED, COMBOBENCHMARK_MS(400U)},
+    {"Sequence wrong input", ComboBenchmark_SequencePattern, sizeof(ComboBenchmark_SequencePattern), ComboBenchmark_SequenceWrongEvents, 2U, COMBOBENCHMARK_MS(200U), COMBO_RESULT_FAILED, COMBOBENCHMARK_MS(200U)},
+    {"Sequence unfinished", ComboBenchmark_SequencePattern, sizeof(ComboBenchmark_SequencePattern), ComboBenchmark_SequenceEvents, 1U, COMBOBENCHMARK_MS(399U), COMBO_RESULT_PENDING, 0U},
+    {"Chord", ComboBenchmark_ChordPattern, sizeof(ComboBenchmark_ChordPattern), ComboBenchmark_ChordEvents, 4U, COMBOBENCHMARK_MS(55U), COMBO_RESULT_MATCHED, COMBOBENCHMARK_MS(55U)},
+    {"Chord too slow", ComboBenchmark_ChordPattern, sizeof(ComboBenchmark_ChordPattern), ComboBenchmark_ChordSlowEvents, 3U, COMBOBENCHMARK_MS(70U), COMBO_RESULT_FAILED, COMBOBENCHMARK_MS(60U)},
+    {"Hold", ComboBenchmark_HoldPattern, sizeof(ComboBenchmark_HoldPattern), ComboBenchmark_HoldEvents, 2U, COMBOBENCHMARK_MS(700U), COMBO_RESULT_MATCHED, COMBOBENCHMARK_MS(600U)},
+    {"Hold polled", ComboBenchmark_HoldPattern, sizeof(ComboBenchmark_HoldPattern), ComboBenchmark_HoldPressEvents, 1U, COMBOBENCHMARK_MS(600U), COMBO_RESULT_MATCHED, COMBOBENCHMARK_MS(600U)},
+    {"Hold released early", ComboBenchmark_HoldPattern, sizeof(ComboBenchmark_HoldPattern), ComboBenchmark_HoldEarlyEvents, 2U, COMBOBENCHMARK_MS(400U), COMBO_RESULT_FAILED, COMBOBENCHMARK_MS(400U)},
+    {"Hold past deadline", ComboBenchmark_ShortHoldPattern, sizeof(ComboBenchmark_ShortHoldPattern), ComboBenchmark_HoldPressEvents, 1U, COMBOBENCHMARK_MS(1000U), COMBO_RESULT_FAILED, COMBOBENCHMARK_MS(400U)},
+    {"Mixed", ComboBenchmark_MixedPattern, sizeof(ComboBenchmark_MixedPattern), ComboBenchmark_MixedEvents, 6U, COMBOBENCHMARK_MS(690U), COMBO_RESULT_MATCHED, COMBOBENCHMARK_MS(690U)},
+    {"Mixed chord late", ComboBenchmark_MixedPattern, sizeof(ComboBenchmark_MixedPattern), ComboBenchmark_MixedEvents, 4U, COMBOBENCHMARK_MS(1000U), COMBO_RESULT_FAILED, COMBOBENCHMARK_MS(700U)},
+    {"Mixed hold late", ComboBenchmark_MixedPattern, sizeof(ComboBenchmark_MixedPattern), ComboBenchmark_MixedLateEvents, 2U, COMBOBENCHMARK_MS(1000U), COMBO_RESULT_FAILED, COMBOBENCHMARK_MS(550U)},
+};
+
+static const uint8_t ComboBenchmark_NoEnd[] = {COMBO_PRESS(0U)};
+static const uint8_t ComboBenchmark_PastEnd[] = {COMBO_PRESS(0U), COMBO_END, COMBO_PRESS(1U)};
+static const uint8_t ComboBenchmark_Truncated[] = {COMBO_OP_HOLD, 1U, 0U};
+static const uint8_t ComboBenchmark_EmptyChord[] = {COMBO_CHORD(50U, 0U), COMBO_END};
+static const uint8_t ComboBenchmark_LargeChord[] = {COMBO_CHORD(50U, 9U), 0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, COMBO_END};
+static const uint8_t ComboBenchmark_BadInput[] = {COMBO_PRESS(COMBO_MAX_INPUTS), COMBO_END};
+static const uint8_t ComboBenchmark_WithinEnd[] = {COMBO_PRESS(0U), COMBO_WITHIN(100U), COMBO_END};
+static const uint8_t ComboBenchmark_WithinTwice[] = {COMBO_WITHIN(100U), COMBO_WITHIN(100U), COMBO_PRESS(0U), COMBO_END};
+static const uint8_t ComboBenchmark_BadOp[] = {COMBO_OP_COUNT, COMBO_END};
+
+static const ComboBenchmark_Malformed_t ComboBenchmark_Malformed[] = {
+    {"No end", ComboBenchmark_NoEnd, sizeof(ComboBenchmark_NoEnd)},
+    {"Bytes past end", ComboBenchmark_PastEnd, sizeof(ComboBenchmark_PastEnd)},
+    {"Truncated hold", ComboBenchmark_Truncated, sizeof(ComboBenchmark_Truncated)},
+    {"Empty chord", ComboBenchmark_EmptyChord, sizeof(ComboBenchmark_EmptyChord)},
+    {"Chord too large", ComboBenchmark_LargeChord, sizeof(ComboBenchmark_LargeChord)},
+    {"Input out of range", ComboBenchmark_BadInput, sizeof(ComboBenchmark_BadInput)},
+    {"Deadline before end", ComboBenchmark_WithinEnd, sizeof(ComboBenchmark_WithinEnd)},
+    {"Two deadlines", ComboBenchmark_WithinTwice, sizeof(ComboBenchmark_WithinTwice)},
+    {"Unknown instruction", ComboBenchmark_BadOp, sizeof(ComboBenchmark_BadOp)},
+};
+
+static const uint32_t ComboBenchmark_Lengths[COMBOBENCHMARK_LENGTH_COUNT] = {1U, 4U, 16U, 64U, COMBOBENCHMARK_MAX_STEPS};
+
+/* Patterns of the game's commands, completable within the shortest time to complete a command */
+static const uint8_t ComboBenchmark_GameSequence[] = {COMBO_PRESS(0U), COMBO_WITHIN(300U), COMBO_PRESS(2U), COMBO_END};
+static const uint8_t ComboBenchmark_GameChord[] = {COMBO_WITHIN(400U), COMBO_CHORD(100U, 2U), 1U, 3U, COMBO_END};
+static const uint8_t ComboBenchmark_GameHold[] = {COMBO_HOLD(2U, 250U), COMBO_END};
+
+static BopIt_Command_t ComboBenchmark_Commands[COMBOBENCHMARK_COMMAND_COUNT] = {
+    {"Sequence", ComboBenchmark_IssueCommand, ComboBenchmark_SuccessFeedback, ComboBenchmark_FailFeedback, ComboBenchmark_GetInput, ComboBenchmark_GameSequence, sizeof(ComboBenchmark_GameSequence)},
+    {"Chord", ComboBenchmark_IssueCommand, ComboBenchmark_SuccessFeedback, ComboBenchmark_FailFeedback, ComboBenchmark_GetInput, ComboBenchmark_GameChord, sizeof(ComboBenchmark_GameChord)},
+    {"Hold", ComboBenchmark_IssueCommand, ComboBenchmark_SuccessFeedback, ComboBenchmark_FailFeedback, ComboBenchmark_GetInput, ComboBenchmark_GameHold, sizeof(ComboBenchmark_GameHold)},
+};
+static BopIt_Command_t *ComboBenchmark_CommandList[COMBOBENCHMARK_COMMAND_COUNT] = {&ComboBenchmark_Commands[0], &ComboBenchmark_Commands[1], &ComboBenchmark_Commands[2]};
+
+static BopIt_Reaction_t ComboBenchmark_Reactions[BOPIT_MAX_SCORE]; /* Reaction times kept by the engine in the current game */
+
+static BopIt_GameContext_t ComboBenchmark_GameContext = {
+    .Commands = ComboBenchmark_CommandList,
+    .CommandCount = COMBOBENCHMARK_COMMAND_COUNT,
+    .GetInputs = NULL,
+    .GetEvent = ComboBenchmark_GetEvent,
+    .Time = VirtualClock_GetGameTime,
+    .Selection = BOPIT_SELECTION_UNIFORM,
+    .Curve = BOPIT_CURVE_LINEAR,
+    .CommandWeights = NULL,
+    .Logger = ComboBenchmark_Logger,
+    .LogRing = NULL,
+    .TraceRing = NULL,
+    .Reactions = ComboBenchmark_Reactions,
+    .UserData = NULL,
+    .OnGameStart = NULL,
+    .OnGameEnd = NULL,
+};
+
+static Prng_t ComboBenchmark_Prng;                                                               /* Generator of the random patterns */
+static uint8_t ComboBenchmark_Pattern[COMBOBENCHMARK_MAX_STEPS * COMBOBENCHMARK_STEP_SIZE + 1U]; /* Random pattern being benchmarked */
+static Combo_Event_t ComboBenchmark_Events[COMBOBENCHMARK_MAX_EVENTS];                           /* Events playing the random pattern */
+static Combo_Event_t ComboBenchmark_Queue[COMBOBENCHMARK_QUEUE_SIZE];                            /* Events the player made that the game has not taken yet */
+static uint32_t ComboBenchmark_QueueHead = 0U;                                                   /* Index of the next event the game takes */
+static uint32_t ComboBenchmark_QueueTail = 0U;                                                   /* Index after the last event the player made */
+static bool ComboBenchmark_Issued = false;                                                       /* Whether a command was issued since the player last played */
+static bool ComboBenchmark_Fumbled = false;                                                      /* Whether the player fumbled the command issued */
+static Combo_TimeUs_t ComboBenchmark_ExpectedReaction = 0U;                                      /* Time from issuing the command to the player completing its pattern */
+static ComboBenchmark_Game_t ComboBenchmark_Game;                                                /* Outcome of the game being played */
+static LogRing_Record_t ComboBenchmark_TraceRecords[COMBOBENCHMARK_TRACE_RING_SIZE];             /* Storage for the trace ring */
+static LogRing_t ComboBenchmark_TraceRing;                                                       /* Ring the games write trace records to */
+static FILE *ComboBenchmark_TraceFile = NULL;                                                    /* File trace records are saved to, NULL if not tracing */
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t seed = COMBOBENCHMARK_DEFAULT_SEED;
+    uint32_t errors = 0U;
+    ComboBenchmark_Game_t game;
+    uint32_t fumbles;
+
+    if (argc > 1)
+    {
+        seed = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        ComboBenchmark_TraceFile = fopen(argv[2], "wb");
+        if (ComboBenchmark_TraceFile == NULL)
+        {
+            printf("Failed to open trace file %s\n", argv[2]);
+            return EXIT_FAILURE;
+        }
+        LogRing_Init(&ComboBenchmark_TraceRing, ComboBenchmark_TraceRecords, COMBOBENCHMARK_TRACE_RING_SIZE);
+        ComboBenchmark_GameContext.TraceRing = &ComboBenchmark_TraceRing;
+    }
+
+    printf("Combo benchmark: seed %" PRIu32 ", %u bytes per matcher\n", seed, (unsigned int)sizeof(Combo_Matcher_t));
+
+    errors += ComboBenchmark_RunCases();
+    errors += ComboBenchmark_RunLengths(seed);
+
+    /* A player completing every command reaches the maximum score */
+    game = ComboBenchmark_PlayGame(seed, 0U);
+    printf("  Game, every command completed:   score %u, %" PRIu32 " completed, %" PRIu32 " failed\n", game.Score, game.Successes, game.Failures);
+    if (game.WrongJudgements > 0U || game.WrongReactions > 0U || game.Failures > 0U || game.Score != BOPIT_MAX_SCORE)
+    {
+        printf("    FAILED: %" PRIu32 " wrong judgements, %" PRIu32 " wrong reaction times\n", game.WrongJudgements, game.WrongReactions);
+        errors++;
+    }
+
+    /* A player fumbling every few commands loses a life for each, and every command in between is completed */
+    game = ComboBenchmark_PlayGame(seed + 1U, COMBOBENCHMARK_FUMBLE_EVERY);
+    fumbles = game.Successes / (COMBOBENCHMARK_FUMBLE_EVERY - 1U);
+    printf("  Game, every %uth command fumbled: score %u, %" PRIu32 " completed, %" PRIu32 " failed\n", COMBOBENCHMARK_FUMBLE_EVERY, game.Score, game.Successes, game.Failures);
+    if (game.WrongJudgements > 0U || game.WrongReactions > 0U || game.Failures != fumbles || game.Score != game.Successes)
+    {
+        printf("    FAILED: %" PRIu32 " wrong judgements, %" PRIu32 " wrong reaction times\n", game.WrongJudgements, game.WrongReactions);
+        errors++;
+    }
+
+    if (ComboBenchmark_TraceFile != NULL)
+    {
+        fclose(ComboBenchmark_TraceFile);
+    }
+
+    if (errors > 0U)
+    {
+        printf("  FAILED: %" PRIu32 " errors\n", errors);
+    }
+
+    return (errors > 0U) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * @brief Match every scripted case and check every malformed pattern is
+ * rejected.
+ *
+ * @return Number of cases with the wrong outcome
+ ******************************************************************************/
+static uint32_t ComboBenchmark_RunCases(void)
+{
+    const ComboBenchmark_Case_t *testCase;
+    Combo_Matcher_t matcher;
+    Combo_Result_t result;
+    bool correct;
+    uint32_t errors = 0U;
+
+    for (uint32_t index = 0U; index < sizeof(ComboBenchmark_Cases) / sizeof(ComboBenchmark_Cases[0U]); index++)
+    {
+        testCase = &ComboBenchmark_Cases[index];
+        result = COMBO_RESULT_FAILED;
+
+        if (Combo_Start(&matcher, testCase->Pattern, testCase->PatternSize, 0U))
+        {
+            for (uint32_t event = 0U; event < testCase->EventCount; event++)
+            {
+                (void)Combo_Feed(&matcher, &testCase->Events[event]);
+            }
+            result = Combo_Poll(&matcher, testCase->PollTime);
+        }
+
+        correct = (result == testCase->Result) && (result == COMBO_RESULT_PENDING || matcher.EndTime == testCase->EndTime);
+        if (!correct)
+        {
+            printf("  Case %-22s FAILED: result %d at %" PRIu64 " us, expected %d at %" PRIu64 " us\n", testCase->Name, (int)result, matcher.EndTime, (int)testCase->Result, testCase->EndTime);
+            errors++;
+        }
+    }
+
+    for (uint32_t index = 0U; index < sizeof(ComboBenchmark_Malformed) / sizeof(ComboBenchmark_Malformed[0U]); index++)
+    {
+        if (Combo_Start(&matcher, ComboBenchmark_Malformed[index].Pattern, ComboBenchmark_Malformed[index].PatternSize, 0U))
+        {
+            printf("  Malformed %-17s FAILED: pattern accepted\n", ComboBenchmark_Malformed[index].Name);
+            errors++;
+        }
+    }
+
+    printf("  Scripted cases:                  %u matched, %u malformed patterns, %" PRIu32 " wrong\n", (unsigned int)(sizeof(ComboBenchmark_Cases) / sizeof(ComboBenchmark_Cases[0U])),
+           (unsigned int)(sizeof(ComboBenchmark_Malformed) / sizeof(ComboBenchmark_Malformed[0U])), errors);
+
+    return errors;
+}
+
+/**
+ * @brief Match random patterns of each length against the player completing
+ * them, timing Combo_Feed and counting heap allocations.
+ *
+ * @param[in] seed Seed of the random patterns
+ *
+ * @return Number of patterns matched wrongly, and 1 if the matcher allocated
+ ******************************************************************************/
+static uint32_t ComboBenchmark_RunLengths(const uint32_t seed)
+{
+    Combo_Matcher_t matcher;
+    Combo_TimeUs_t endTime;
+    Benchmark_TimeNs_t overheadNs = Benchmark_GetTimerOverheadNs();
+    Benchmark_TimeNs_t startNs;
+    Benchmark_TimeNs_t elapsedNs;
+    Benchmark_TimeNs_t totalNs;
+    Benchmark_Allocations_t allocations;
+    uint32_t size;
+    uint32_t eventCount;
+    uint32_t repeats;
+    uint32_t wrong;
+    uint32_t errors = 0U;
+
+    Prng_Seed(&ComboBenchmark_Prng, seed, 0U);
+
+    for (uint32_t length = 0U; length < COMBOBENCHMARK_LENGTH_COUNT; length++)
+    {
+        size = ComboBenchmark_Generate(ComboBenchmark_Pattern, ComboBenchmark_Lengths[length]);
+        eventCount = ComboBenchmark_Play(ComboBenchmark_Pattern, 0U, ComboBenchmark_Events, COMBOBENCHMARK_MAX_EVENTS, &endTime);
+        repeats = COMBOBENCHMARK_EVENTS_TIMED / eventCount + 1U;
+        totalNs = 0U;
+        wrong = 0U;
+
+        Benchmark_ResetAllocations();
+        for (uint32_t repeat = 0U; repeat < repeats; repeat++)
+        {
+            (void)Combo_Start(&matcher, ComboBenchmark_Pattern, size, 0U);
+
+            startNs = Benchmark_GetTimeNs();
+            for (uint32_t event = 0U; event < eventCount; event++)
+            {
+                (void)Combo_Feed(&matcher, &ComboBenchmark_Events[event]);
+            }
+            elapsedNs = Benchmark_GetTimeNs() - startNs;
+            totalNs += (elapsedNs > overheadNs) ? (elapsedNs - overheadNs) : 0U;
+
+            if (Combo_Poll(&matcher, ComboBenchmark_Events[eventCount - 1U].Time) != COMBO_RESULT_MATCHED || matcher.EndTime != endTime)
+            {
+                wrong++;
+            }
+        }
+        allocations = Benchmark_GetAllocations();
+
+        printf("  %3" PRIu32 " steps, %4" PRIu32 " bytes:        %.2f ns per event over %" PRIu64 " events, %" PRIu64 " allocations\n", ComboBenchmark_Lengths[length], size,
+               (double)totalNs / ((double)repeats * eventCount), (uint64_t)repeats * eventCount, allocations.Allocations);
+        if (wrong > 0U || allocations.Allocations > 0U)
+        {
+            printf("    FAILED: %" PRIu32 " of %" PRIu32 " matches wrong\n", wrong, repeats);
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+/**
+ * @brief Generate a random pattern of presses, chords and holds of random
+ * inputs, some steps with deadlines.
+ *
+ * @param[out] pattern Pattern generated, COMBOBENCHMARK_STEP_SIZE bytes per
+ *                     step plus one
+ * @param[in]  steps   Number of steps of the pattern
+ *
+ * @return Size of the pattern in bytes
+ ******************************************************************************/
+static uint32_t ComboBenchmark_Generate(uint8_t *const pattern, const uint32_t steps)
+{
+    uint32_t size = 0U;
+    uint32_t count;
+    uint32_t first;
+    uint16_t holdMs;
+
+    for (uint32_t step = 0U; step < steps; step++)
+    {
+        if (Prng_Bounded(&ComboBenchmark_Prng, COMBOBENCHMARK_PERCENT) < COMBOBENCHMARK_WITHIN_PERCENT)
+        {
+            pattern[size++] = COMBO_OP_WITHIN;
+            pattern[size++] = (uint8_t)(COMBOBENCHMARK_WITHIN_MS & 0xFFU);
+            pattern[size++] = (uint8_t)(COMBOBENCHMARK_WITHIN_MS >> 8U);
+        }
+
+        /* Steps are the instructions from PRESS to HOLD */
+        switch (Prng_Bounded(&ComboBenchmark_Prng, COMBO_OP_WITHIN - COMBO_OP_PRESS) + COMBO_OP_PRESS)
+        {
+        case COMBO_OP_PRESS:
+            pattern[size++] = COMBO_OP_PRESS;
+            pattern[size++] = (uint8_t)Prng_Bounded(&ComboBenchmark_Prng, COMBOBENCHMARK_INPUT_COUNT);
+            break;
+        case COMBO_OP_CHORD:
+            /* Distinct inputs, consecutive from a random first */
+            count = Prng_Bounded(&ComboBenchmark_Prng, COMBO_MAX_CHORD) + 1U;
+            first = Prng_Bounded(&ComboBenchmark_Prng, COMBOBENCHMARK_INPUT_COUNT);
+            pattern[size++] = COMBO_OP_CHORD;
+            pattern[size++] = (uint8_t)(COMBOBENCHMARK_CHORD_WINDOW_MS & 0xFFU);
+            pattern[size++] = (uint8_t)(COMBOBENCHMARK_CHORD_WINDOW_MS >> 8U);
+            pattern[size++] = (uint8_t)count;
+            for (uint32_t input = 0U; input < count; input++)
+            {
+                pattern[size++] = (uint8_t)((first + input) % COMBOBENCHMARK_INPUT_COUNT);
+            }
+            break;
+        default:
+            holdMs = (uint16_t)(COMBOBENCHMARK_MIN_HOLD_MS + Prng_Bounded(&ComboBenchmark_Prng, COMBOBENCHMARK_HOLD_RANGE_MS));
+            pattern[size++] = COMBO_OP_HOLD;
+            pattern[size++] = (uint8_t)Prng_Bounded(&ComboBenchmark_Prng, COMBOBENCHMARK_INPUT_COUNT);
+            pattern[size++] = (uint8_t)(holdMs & 0xFFU);
+            pattern[size++] = (uint8_t)(holdMs >> 8U);
+            break;
+        }
+    }
+    pattern[size++] = COMBO_END;
+
+    return size;
+}
+
+/**
+ * @brief Play the events of a player completing a well formed pattern: each
+ * step started a gap after the previous one was completed, or a reaction time
+ * after the start, and its inputs released shortly after it was completed.
+ * Deadlines are not read, every step takes less than the shortest one used.
+ *
+ * @param[in]  pattern   Pattern to play
+ * @param[in]  start     Time the pattern starts
+ * @param[out] events    Events played, in order of time
+ * @param[in]  maxEvents Number of events that fit in events
+ * @param[out] endTime   Time the pattern is completed
+ *
+ * @return Number of events played
+ ******************************************************************************/
+static uint32_t ComboBenchmark_Play(const uint8_t *const pattern, const Combo_TimeUs_t start, Combo_Event_t *const events, const uint32_t maxEvents, Combo_TimeUs_t *const endTime)
+{
+    uint32_t offset = 0U;
+    uint32_t count = 0U;
+    uint8_t inputs;
+    Combo_TimeUs_t time = start + COMBOBENCHMARK_REACTION_US;
+    Combo_TimeUs_t completed = start;
+    bool played = true;
+
+    while (played && pattern[offset] != COMBO_OP_END)
+    {
+        switch (pattern[offset])
+        {
+        case COMBO_OP_WITHIN:
+            offset += 3U;
+            break;
+        case COMBO_OP_PRESS:
+            completed = time;
+            played = ComboBenchmark_AddEvent(events, &count, maxEvents, time, pattern[offset + 1U], false) &&
+                     ComboBenchmark_AddEvent(events, &count, maxEvents, completed + COMBOBENCHMARK_RELEASE_US, pattern[offset + 1U], true);
+            time = completed + COMBOBENCHMARK_STEP_GAP_US;
+            offset += 2U;
+            break;
+        case COMBO_OP_CHORD:
+            inputs = pattern[offset + 3U];
+            completed = time + (Combo_TimeUs_t)(inputs - 1U) * COMBOBENCHMARK_CHORD_PRESS_US;
+            for (uint8_t input = 0U; played && input < inputs; input++)
+            {
+                played = ComboBenchmark_AddEvent(events, &count, maxEvents, time + (Combo_TimeUs_t)input * COMBOBENCHMARK_CHORD_PRESS_US, pattern[offset + 4U + input], false);
+            }
+            for (uint8_t input = 0U; played && input < inputs; input++)
+            {
+                played = ComboBenchmark_AddEvent(events, &count, maxEvents, completed + COMBOBENCHMARK_RELEASE_US, pattern[offset + 4U + input], true);
+            }
+            time = completed + COMBOBENCHMARK_STEP_GAP_US;
+            offset += 4U + (uint32_t)inputs;
+            break;
+        default:
+            completed = time + COMBOBENCHMARK_MS((uint32_t)pattern[offset + 2U] | ((uint32_t)pattern[offset + 3U] << 8U));
+            played = ComboBenchmark_AddEvent(events, &count, maxEvents, time, pattern[offset + 1U], false) &&
+                     ComboBenchmark_AddEvent(events, &count, maxEvents, completed + COMBOBENCHMARK_RELEASE_US, pattern[offset + 1U], true);
+            time = completed + COMBOBENCHMARK_STEP_GAP_US;
+            offset += 4U;
+            break;
+        }
+    }
+
+    *endTime = completed;
+
+    return count;
+}
+
+/**
+ * @brief Add an event to a list of events if there is room.
+ *
+ * @param[out]    events    List of events
+ * @param[in,out] count     Number of events in the list
+ * @param[in]     maxEvents Number of events that fit in the list
+ * @param[in]     time      Time of the event
+ * @param[in]     input     Input of the event
+ * @param[in]     released  Whether the input was released
+ *
+ * @return Whether the event was added or not
+ ******************************************************************************/
+static bool ComboBenchmark_AddEvent(Combo_Event_t *const events, uint32_t *const count, const uint32_t maxEvents, const Combo_TimeUs_t time, const uint8_t input, const bool released)
+{
+    bool added = false;
+
+    if (*count < maxEvents)
+    {
+        events[*count].Time = time;
+        events[*count].Input = input;
+        events[*count].Released = released;
+        (*count)++;
+        added = true;
+    }
+
+    return added;
+}
+
+/**
+ * @brief Play a game of combo commands on the virtual clock, sleeping until
+ * the next event or the time BopIt_GetRunDelay reports, like the firmware's
+ * game loop.  The player completes the pattern of every command issued, or
+ * presses a wrong input instead of every few commands if fumbling.
+ *
+ * @param[in] seed        Seed of the game
+ * @param[in] fumbleEvery Number of commands per fumbled command, 0 to
+ *                        complete every command
+ *
+ * @return Outcome of the game
+ ******************************************************************************/
+static ComboBenchmark_Game_t ComboBenchmark_PlayGame(const uint32_t seed, const uint32_t fumbleEvery)
+{
+    BopIt_GameContext_t *const gameContext = &ComboBenchmark_GameContext;
+    Combo_Event_t *event;
+    Combo_TimeUs_t endTime;
+    BopIt_TimeUs_t wakeTime;
+    BopIt_TimeUs_t delay;
+    BopIt_GameState_t state;
+    uint32_t commands = 0U;
+
+    ComboBenchmark_Game = (ComboBenchmark_Game_t){0};
+    ComboBenchmark_QueueHead = 0U;
+    ComboBenchmark_QueueTail = 0U;
+    VirtualClock_Set(0U);
+    BopIt_Init(gameContext);
+    BopIt_Seed(gameContext, seed);
+
+    /* Run until the end state has been handled, like the firmware does */
+    do
+    {
+        state = gameContext->GameState;
+        BopIt_Run(gameContext);
+        ComboBenchmark_Drain();
+
+        if (ComboBenchmark_Issued)
+        {
+            ComboBenchmark_Issued = false;
+            commands++;
+
+            /* Events of the previous command the game has not taken yet, like releases after its pattern was matched, are kept */
+            for (uint32_t index = ComboBenchmark_QueueHead; index < ComboBenchmark_QueueTail; index++)
+            {
+                ComboBenchmark_Queue[index - ComboBenchmark_QueueHead] = ComboBenchmark_Queue[index];
+            }
+            ComboBenchmark_QueueTail -= ComboBenchmark_QueueHead;
+            ComboBenchmark_QueueHead = 0U;
+
+            ComboBenchmark_Fumbled = (fumbleEvery > 0U) && (commands % fumbleEvery == 0U);
+            if (ComboBenchmark_Fumbled)
+            {
+                event = &ComboBenchmark_Queue[ComboBenchmark_QueueTail++];
+                event->Time = gameContext->WaitStart + COMBOBENCHMARK_REACTION_US;
+                event->Input = COMBOBENCHMARK_FUMBLE_INPUT;
+                event->Released = false;
+            }
+            else
+            {
+                ComboBenchmark_QueueTail += ComboBenchmark_Play(gameContext->CurrentCommand->Pattern, gameContext->WaitStart, &ComboBenchmark_Queue[ComboBenchmark_QueueTail],
+                                                                COMBOBENCHMARK_QUEUE_SIZE - ComboBenchmark_QueueTail, &endTime);
+                ComboBenchmark_ExpectedReaction = endTime - gameContext->WaitStart;
+            }
+        }
+
+        /* Sleep until BopIt_Run must be called again or the player makes the next event */
+        delay = BopIt_GetRunDelay(gameContext);
+        wakeTime = (delay == BOPIT_RUN_DELAY_INFINITE) ? BOPIT_RUN_DELAY_INFINITE : VirtualClock_GetTime() + delay;
+        if (ComboBenchmark_QueueHead < ComboBenchmark_QueueTail && ComboBenchmark_Queue[ComboBenchmark_QueueHead].Time < wakeTime)
+        {
+            wakeTime = ComboBenchmark_Queue[ComboBenchmark_QueueHead].Time;
+        }
+        if (wakeTime != BOPIT_RUN_DELAY_INFINITE && wakeTime > VirtualClock_GetTime())
+        {
+            VirtualClock_Set(wakeTime);
+        }
+    } while (state != BOPIT_GAMESTATE_END);
+
+    ComboBenchmark_Game.Score = gameContext->Score;
+
+    return ComboBenchmark_Game;
+}
+
+/**
+ * @brief Event source of the game.  Takes the player's next event if it has
+ * been made by the current time.
+ *
+ * @param[in]  gameContext Context for the game
+ * @param[out] event       Event taken
+ *
+ * @return Whether an event was taken or not
+ ******************************************************************************/
+static bool ComboBenchmark_GetEvent(BopIt_GameContext_t *const gameContext, Combo_Event_t *const event)
+{
+    bool taken = false;
+
+    (void)gameContext;
+
+    if (ComboBenchmark_QueueHead < ComboBenchmark_QueueTail && ComboBenchmark_Queue[ComboBenchmark_QueueHead].Time <= VirtualClock_GetTime())
+    {
+        *event = ComboBenchmark_Queue[ComboBenchmark_QueueHead++];
+        taken = true;
+    }
+
+    return taken;
+}
+
+/**
+ * @brief Command callback.  Has the player play the command.
+ ******************************************************************************/
+static void ComboBenchmark_IssueCommand(void)
+{
+    ComboBenchmark_Issued = true;
+}
+
+/**
+ * @brief Success feedback.  Checks the command was completed, at the time its
+ * pattern was.
+ ******************************************************************************/
+static void ComboBenchmark_SuccessFeedback(void)
+{
+    const BopIt_GameContext_t *const gameContext = &ComboBenchmark_GameContext;
+
+    ComboBenchmark_Game.Successes++;
+    if (ComboBenchmark_Fumbled)
+    {
+        ComboBenchmark_Game.WrongJudgements++;
+    }
+    else if (gameContext->ReactionCount == 0U || gameContext->Reactions[gameContext->ReactionCount - 1U].Time != ComboBenchmark_ExpectedReaction)
+    {
+        ComboBenchmark_Game.WrongReactions++;
+    }
+}
+
+/**
+ * @brief Fail feedback.  Checks the command was fumbled.
+ ******************************************************************************/
+static void ComboBenchmark_FailFeedback(void)
+{
+    ComboBenchmark_Game.Failures++;
+    if (!ComboBenchmark_Fumbled)
+    {
+        ComboBenchmark_Game.WrongJudgements++;
+    }
+}
+
+/**
+ * @brief Input of every command, never made since commands are matched from
+ * events.
+ *
+ * @param[out] inputTime Unused
+ *
+ * @return false
+ ******************************************************************************/
+static bool ComboBenchmark_GetInput(BopIt_TimeUs_t *const inputTime)
+{
+    (void)inputTime;
+
+    return false;
+}
+
+/**
+ * @brief Logger that discards messages so the benchmark measures the matcher,
+ * not printf.
+ *
+ * @param[in] gameContext Unused
+ * @param[in] message     Unused
+ ******************************************************************************/
+static void ComboBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message)
+{
+    (void)gameContext;
+    (void)message;
+}
+
+/**
+ * @brief Save the records in the trace ring to the trace file, if tracing.
+ ******************************************************************************/
+static void ComboBenchmark_Drain(void)
+{
+    LogRing_Record_t record;
+
+    if (ComboBenchmark_TraceFile != NULL)
+    {
+        while (LogRing_Read(&ComboBenchmark_TraceRing, &record))
+        {
+            fwrite(&record, sizeof(record), 1U, ComboBenchmark_TraceFile);
+        }
+    }
+}
@@ -0,0 +1,292 @@
+/**
+ * @file DebounceBenchmark.c
+ *
+ * @brief Benchmark of debouncing button edges with Debounce, the state machine
+ * the GPIO ISR runs for every button edge.  Generates a synthetic waveform of
+ * presses and releases, each followed by a burst of contact bounces with edges
+ * as close as a microsecond apart, and reads the level of every edge after an
+ * ISR latency, so edges closer than the latency are read at the same level
+ * like they would be on hardware.  Reports nanoseconds per edge and checks
+ * that exactly the generated presses and releases are accepted, each press
+ * while its contacts are still bouncing, and reports how late presses are
+ * accepted after their first edge.
+ *
+ * A recorded waveform can be debounced instead, given as a text file with a
+ * line per edge of the time in microseconds and the level of the pin after the
+ * edge, 0 when pressed since buttons pull the pin low.
+ *
+ * Exits with a failure status if a synthetic waveform is debounced wrong.
+ *
+ * Usage: DebounceBenchmark [presses] [seed] [lockout us] [waveform file]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "Debounce.h"
+#include "Prng.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define DEBOUNCEBENCHMARK_DEFAULT_PRESSES 100000U                                     /* Number of presses generated if not specified */
+#define DEBOUNCEBENCHMARK_DEFAULT_SEED 1U                                             /* Seed of the waveform if not specified */
+#define DEBOUNCEBENCHMARK_DEFAULT_LOCKOUT_US 10000                                    /* Lockout window after presses and releases if not specified, matches the firmware */
+#define DEBOUNCEBENCHMARK_MAX_BOUNCES 20U                                             /* Maximum number of bounces after an edge, each bounce is two edges */
+#define DEBOUNCEBENCHMARK_MAX_BOUNCE_US 5000U                                         /* Maximum time contacts bounce for */
+#define DEBOUNCEBENCHMARK_MIN_HOLD_US 30000U                                          /* Shortest time a button is held */
+#define DEBOUNCEBENCHMARK_HOLD_RANGE_US 270000U                                       /* Range of times a button is held */
+#define DEBOUNCEBENCHMARK_MIN_GAP_US 20000U                                           /* Shortest time between a release and the next press */
+#define DEBOUNCEBENCHMARK_GAP_RANGE_US 480000U                                        /* Range of times between a release and the next press */
+#define DEBOUNCEBENCHMARK_ISR_LATENCY_US 2                                            /* Time from an edge to the ISR reading the level of the pin */
+#define DEBOUNCEBENCHMARK_EDGES_PER_PRESS (4U * (DEBOUNCEBENCHMARK_MAX_BOUNCES + 1U)) /* Maximum number of edges of a press and its release */
+#define DEBOUNCEBENCHMARK_PRESSED_LEVEL 0                                             /* Level of a pressed button in a recorded waveform */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Edge of a button as seen by the ISR */
+typedef struct
+{
+    Debounce_TimeUs_t TimeUs; /* Time of the edge */
+    bool Level;               /* Whether the button is pressed after the edge */
+    bool Pressed;             /* Whether the ISR reads the button as pressed */
+} DebounceBenchmark_Edge_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static uint32_t DebounceBenchmark_Generate(DebounceBenchmark_Edge_t *const edges, Debounce_TimeUs_t *const pressTimes, const uint32_t presses, const uint32_t seed);
+static uint32_t DebounceBenchmark_AddEdge(DebounceBenchmark_Edge_t *const edges, uint32_t edgeCount, Prng_t *const prng, Debounce_TimeUs_t *const timeUs, const bool level);
+static int DebounceBenchmark_Recorded(const char *const fileName, const Debounce_Config_t *const config);
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t presses = DEBOUNCEBENCHMARK_DEFAULT_PRESSES;
+    uint32_t seed = DEBOUNCEBENCHMARK_DEFAULT_SEED;
+    Debounce_Config_t config = {
+        .PressLockoutUs = DEBOUNCEBENCHMARK_DEFAULT_LOCKOUT_US,
+        .ReleaseLockoutUs = DEBOUNCEBENCHMARK_DEFAULT_LOCKOUT_US,
+    };
+    DebounceBenchmark_Edge_t *edges;
+    Debounce_TimeUs_t *pressTimes;
+    Debounce_Input_t input;
+    Debounce_Stats_t stats;
+    Debounce_Event_t event;
+    uint32_t edgeCount;
+    uint32_t pressIndex = 0U;
+    uint32_t latePresses = 0U;
+    uint64_t pressDelayUs = 0U;
+    int status = EXIT_SUCCESS;
+
+    if (argc > 1)
+    {
+        presses = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        seed = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3)
+    {
+        config.PressLockoutUs = strtoll(argv[3], NULL, 0);
+        config.ReleaseLockoutUs = config.PressLockoutUs;
+    }
+    if (argc > 4)
+    {
+        return DebounceBenchmark_Recorded(argv[4], &config);
+    }
+    if (presses == 0U)
+    {
+        presses = DEBOUNCEBENCHMARK_DEFAULT_PRESSES;
+    }
+
+    edges = malloc((size_t)presses * DEBOUNCEBENCHMARK_EDGES_PER_PRESS * sizeof(DebounceBenchmark_Edge_t));
+    pressTimes = malloc((size_t)presses * sizeof(Debounce_TimeUs_t));
+    if (edges == NULL || pressTimes == NULL)
+    {
+        printf("Failed to allocate waveform\n");
+        free(edges);
+        free(pressTimes);
+        return EXIT_FAILURE;
+    }
+
+    edgeCount = DebounceBenchmark_Generate(edges, pressTimes, presses, seed);
+
+    /* Debounce every edge like the ISR does */
+    Debounce_Init(&input);
+    Benchmark_TimeNs_t start = Benchmark_GetTimeNs();
+    for (uint32_t edgeIndex = 0U; edgeIndex < edgeCount; edgeIndex++)
+    {
+        event = Debounce_Edge(&input, &config, edges[edgeIndex].Pressed, edges[edgeIndex].TimeUs);
+        if (event == DEBOUNCE_EVENT_PRESS)
+        {
+            if (pressIndex >= presses || (edges[edgeIndex].TimeUs - pressTimes[pressIndex]) > DEBOUNCEBENCHMARK_MAX_BOUNCE_US)
+            {
+                latePresses++;
+            }
+            else
+            {
+                pressDelayUs += (uint64_t)(edges[edgeIndex].TimeUs - pressTimes[pressIndex]);
+            }
+            pressIndex++;
+        }
+    }
+    Benchmark_TimeNs_t debounceTime = Benchmark_GetTimeNs() - start;
+
+    Debounce_GetStats(&input, &stats);
+
+    printf("Debounce benchmark: %" PRIu32 " presses, seed %" PRIu32 ", lockout %" PRId64 " us\n", presses, seed, config.PressLockoutUs);
+    printf("  Edges:               %" PRIu32 " (%.1f per press)\n", edgeCount, (double)edgeCount / presses);
+    printf("  Debounce time:       %.3f ms\n", (double)debounceTime / 1e6);
+    printf("  ns/edge:             %.2f\n", (double)debounceTime / edgeCount);
+    printf("  Presses accepted:    %" PRIu32 "\n", stats.Presses);
+    printf("  Releases accepted:   %" PRIu32 "\n", stats.Releases);
+    printf("  Bounces rejected:    %" PRIu32 "\n", stats.Bounces);
+    printf("  Mean press delay:    %.3f us\n", (pressIndex > latePresses) ? ((double)pressDelayUs / (pressIndex - latePresses)) : 0.0);
+
+    if (stats.Presses != presses || stats.Releases != presses)
+    {
+        printf("FAIL: accepted %" PRIu32 " presses and %" PRIu32 " releases of %" PRIu32 "\n", stats.Presses, stats.Releases, presses);
+        status = EXIT_FAILURE;
+    }
+    if (latePresses > 0U)
+    {
+        printf("FAIL: %" PRIu32 " presses were not accepted while bouncing\n", latePresses);
+        status = EXIT_FAILURE;
+    }
+
+    free(edges);
+    free(pressTimes);
+
+    return status;
+}
+
+/**
+ * @brief Generate a waveform of presses and releases with contact bounces,
+ * and the level the ISR reads for each edge.
+ *
+ * @param[out] edges      Edges of the waveform, room for
+ * DEBOUNCEBENCHMARK_EDGES_PER_PRESS edges per press
+ * @param[out] pressTimes Time of the first edge of each press
+ * @param[in]  presses    Number of presses
+ * @param[in]  seed       Seed of the waveform
+ *
+ * @return Number of edges generated
+ ******************************************************************************/
+static uint32_t DebounceBenchmark_Generate(DebounceBenchmark_Edge_t *const edges, Debounce_TimeUs_t *const pressTimes, const uint32_t presses, const uint32_t seed)
+{
+    Prng_t prng;
+    Debounce_TimeUs_t timeUs = 0;
+    uint32_t edgeCount = 0U;
+    uint32_t readIndex = 0U;
+
+    Prng_Seed(&prng, seed, 0U);
+
+    for (uint32_t press = 0U; press < presses; press++)
+    {
+        timeUs += DEBOUNCEBENCHMARK_MIN_GAP_US + Prng_Bounded(&prng, DEBOUNCEBENCHMARK_GAP_RANGE_US);
+        pressTimes[press] = timeUs;
+        edgeCount = DebounceBenchmark_AddEdge(edges, edgeCount, &prng, &timeUs, true);
+
+        timeUs += DEBOUNCEBENCHMARK_MIN_HOLD_US + Prng_Bounded(&prng, DEBOUNCEBENCHMARK_HOLD_RANGE_US);
+        edgeCount = DebounceBenchmark_AddEdge(edges, edgeCount, &prng, &timeUs, false);
+    }
+
+    /* The ISR reads the level of the last edge before it runs */
+    for (uint32_t edgeIndex = 0U; edgeIndex < edgeCount; edgeIndex++)
+    {
+        while ((readIndex + 1U) < edgeCount && edges[readIndex + 1U].TimeUs <= (edges[edgeIndex].TimeUs + DEBOUNCEBENCHMARK_ISR_LATENCY_US))
+        {
+            readIndex++;
+        }
+        edges[edgeIndex].Pressed = edges[readIndex].Level;
+    }
+
+    return edgeCount;
+}
+
+/**
+ * @brief Add an edge to a waveform followed by a random number of bounces,
+ * ending at the level of the edge.
+ *
+ * @param[out]    edges     Edges of the waveform
+ * @param[in]     edgeCount Number of edges in the waveform
+ * @param[in,out] prng      Generator of the waveform
+ * @param[in,out] timeUs    Time of the edge, set to the time of the last bounce
+ * @param[in]     level     Whether the button is pressed after the edge
+ *
+ * @return Number of edges in the waveform after adding the edge
+ ******************************************************************************/
+static uint32_t DebounceBenchmark_AddEdge(DebounceBenchmark_Edge_t *const edges, uint32_t edgeCount, Prng_t *const prng, Debounce_TimeUs_t *const timeUs, const bool level)
+{
+    uint32_t bounces = Prng_Bounded(prng, DEBOUNCEBENCHMARK_MAX_BOUNCES + 1U);
+    uint32_t bounceUs = (bounces > 0U) ? (1U + Prng_Bounded(prng, DEBOUNCEBENCHMARK_MAX_BOUNCE_US / (2U * bounces))) : 0U;
+
+    edges[edgeCount].TimeUs = *timeUs;
+    edges[edgeCount].Level = level;
+    edgeCount++;
+
+    for (uint32_t bounce = 0U; bounce < (2U * bounces); bounce++)
+    {
+        *timeUs += 1U + Prng_Bounded(prng, bounceUs);
+        edges[edgeCount].TimeUs = *timeUs;
+        edges[edgeCount].Level = ((bounce % 2U) == 0U) ? !level : level;
+        edgeCount++;
+    }
+
+    return edgeCount;
+}
+
+/**
+ * @brief Debounce a recorded waveform and print the presses and releases
+ * accepted.
+ *
+ * @param[in] fileName Name of the file of the recorded waveform
+ * @param[in] config   Lockout windows
+ *
+ * @return Exit status
+ ******************************************************************************/
+static int DebounceBenchmark_Recorded(const char *const fileName, const Debounce_Config_t *const config)
+{
+    FILE *file = fopen(fileName, "r");
+    Debounce_Input_t input;
+    Debounce_Stats_t stats;
+    Debounce_Event_t event;
+    int64_t timeUs;
+    int level;
+    uint32_t edgeCount = 0U;
+    int status = EXIT_FAILURE;
+
+    if (file == NULL)
+    {
+        printf("Failed to open %s\n", fileName);
+    }
+    else
+    {
+        Debounce_Init(&input);
+        while (fscanf(file, "%" SCNd64 " %d", &timeUs, &level) == 2)
+        {
+            event = Debounce_Edge(&input, config, level == DEBOUNCEBENCHMARK_PRESSED_LEVEL, timeUs);
+            if (event != DEBOUNCE_EVENT_NONE)
+            {
+                printf("  %12" PRId64 " us %s\n", timeUs, (event == DEBOUNCE_EVENT_PRESS) ? "press" : "release");
+            }
+            edgeCount++;
+        }
+        fclose(file);
+
+        Debounce_GetStats(&input, &stats);
+        printf("Debounced %" PRIu32 " edges of %s, lockout %" PRId64 " us: %" PRIu32 " presses, %" PRIu32 " releases, %" PRIu32 " bounces\n", edgeCount, fileName, config->PressLockoutUs, stats.Presses, stats.Releases, stats.Bounces);
+        status = EXIT_SUCCESS;
+    }
+
+    return status;
+}
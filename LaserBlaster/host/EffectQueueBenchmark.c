@@ -0,0 +1,458 @@
+/**
+ * @file EffectQueueBenchmark.c
+ *
+ * @brief Benchmark of the EffectQueue feedback effects are posted to.  Plays
+ * out a scripted sequence of effects on a virtual clock the way the feedback
+ * task does and checks when each effect starts and whether it is cut short.
+ * Then posts and takes random effects, checking every result against a simple
+ * reference model, and measures the cost of posting an effect, which is the
+ * cost a feedback callback adds to the game loop.
+ *
+ * Exits with a failure status if an effect is played at the wrong time or the
+ * queue differs from the reference model.
+ *
+ * Usage: EffectQueueBenchmark [operations] [seed]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "EffectQueue.h"
+#include "Prng.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define EFFECTQUEUEBENCHMARK_DEFAULT_OPERATIONS 1000000U /* Number of random operations if not specified */
+#define EFFECTQUEUEBENCHMARK_DEFAULT_SEED 1U             /* Seed of the random operations if not specified */
+#define EFFECTQUEUEBENCHMARK_MAX_PRIORITY 4U             /* Highest priority of a random effect */
+#define EFFECTQUEUEBENCHMARK_TAKE_PERCENT 45U            /* Chance of a random operation being a take, below half so the queue is mostly full */
+#define EFFECTQUEUEBENCHMARK_PERCENT 100U                /* Scale of a percentage */
+#define EFFECTQUEUEBENCHMARK_PLAYOUT_MS 2000U            /* Length of the scripted playout */
+#define EFFECTQUEUEBENCHMARK_EXPECTED_PREEMPTED 1U       /* Number of effects cut short during the scripted playout */
+#define EFFECTQUEUEBENCHMARK_P99_PERMILLE 990U           /* Permille of the 99th percentile */
+#define EFFECTQUEUEBENCHMARK_PERMILLE 1000U              /* Scale of a permille */
+
+/* Number of effects posted during the scripted playout */
+#define EFFECTQUEUEBENCHMARK_SCRIPT_POSTS (sizeof(EffectQueueBenchmark_Script) / sizeof(EffectQueueBenchmark_Script[0U]))
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Effect posted at a time during the scripted playout */
+typedef struct
+{
+    uint32_t TimeMs;             /* Time at which the effect is posted */
+    EffectQueue_Effect_t Effect; /* Effect posted, with its index in the script as its parameter */
+} EffectQueueBenchmark_Post_t;
+
+/* Expected start of an effect during the scripted playout */
+typedef struct
+{
+    uint32_t TimeMs; /* Time at which the effect starts */
+    uint32_t Param;  /* Index of the effect in the script */
+} EffectQueueBenchmark_Start_t;
+
+/* Reference model of a queue, an unordered array searched on every operation */
+typedef struct
+{
+    EffectQueue_Entry_t Entries[EFFECTQUEUE_CAPACITY]; /* Queued effects */
+    uint32_t Count;                                    /* Number of effects queued */
+    uint32_t NextSequence;                             /* Sequence of the next effect posted */
+} EffectQueueBenchmark_Reference_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static int EffectQueueBenchmark_Playout(void);
+static int EffectQueueBenchmark_Random(const uint32_t operations, const uint32_t seed);
+static void EffectQueueBenchmark_Cost(const uint32_t operations, const uint32_t seed);
+static bool EffectQueueBenchmark_ReferencePost(EffectQueueBenchmark_Reference_t *const reference, const EffectQueue_Effect_t *const effect);
+static bool EffectQueueBenchmark_ReferenceTake(EffectQueueBenchmark_Reference_t *const reference, EffectQueue_Effect_t *const effect);
+static bool EffectQueueBenchmark_IsBefore(const EffectQueue_Entry_t *const a, const EffectQueue_Entry_t *const b);
+static EffectQueue_Effect_t EffectQueueBenchmark_RandomEffect(Prng_t *const prng, const uint32_t param);
+static int EffectQueueBenchmark_CompareNs(const void *a, const void *b);
+
+/* Globals
+ ******************************************************************************/
+
+/* Scripted effects, a fail cuts short a success, and effects that do not outrank the one playing wait their turn in order of priority and then of posting */
+static const EffectQueueBenchmark_Post_t EffectQueueBenchmark_Script[] = {
+    {.TimeMs = 0U, .Effect = {.Id = 0U, .Priority = 1U, .DurationMs = 300U, .Param = 0U}},
+    {.TimeMs = 100U, .Effect = {.Id = 0U, .Priority = 3U, .DurationMs = 600U, .Param = 1U}},
+    {.TimeMs = 150U, .Effect = {.Id = 0U, .Priority = 2U, .DurationMs = 200U, .Param = 2U}},
+    {.TimeMs = 150U, .Effect = {.Id = 0U, .Priority = 1U, .DurationMs = 300U, .Param = 3U}},
+    {.TimeMs = 1000U, .Effect = {.Id = 0U, .Priority = 1U, .DurationMs = 200U, .Param = 4U}},
+    {.TimeMs = 1000U, .Effect = {.Id = 0U, .Priority = 1U, .DurationMs = 200U, .Param = 5U}},
+};
+
+/* Expected starts of the scripted effects */
+static const EffectQueueBenchmark_Start_t EffectQueueBenchmark_ExpectedStarts[] = {
+    {.TimeMs = 0U, .Param = 0U},
+    {.TimeMs = 100U, .Param = 1U},
+    {.TimeMs = 700U, .Param = 2U},
+    {.TimeMs = 900U, .Param = 3U},
+    {.TimeMs = 1200U, .Param = 4U},
+    {.TimeMs = 1400U, .Param = 5U},
+};
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t operations = EFFECTQUEUEBENCHMARK_DEFAULT_OPERATIONS;
+    uint32_t seed = EFFECTQUEUEBENCHMARK_DEFAULT_SEED;
+    int status = EXIT_SUCCESS;
+
+    if (argc > 1)
+    {
+        operations = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        seed = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (operations == 0U)
+    {
+        operations = EFFECTQUEUEBENCHMARK_DEFAULT_OPERATIONS;
+    }
+
+    printf("EffectQueue benchmark: %" PRIu32 " operations, seed %" PRIu32 ", capacity %u\n", operations, seed, EFFECTQUEUE_CAPACITY);
+
+    if (EffectQueueBenchmark_Playout() != EXIT_SUCCESS)
+    {
+        status = EXIT_FAILURE;
+    }
+    if (EffectQueueBenchmark_Random(operations, seed) != EXIT_SUCCESS)
+    {
+        status = EXIT_FAILURE;
+    }
+    EffectQueueBenchmark_Cost(operations, seed);
+
+    return status;
+}
+
+/**
+ * @brief Play out the scripted effects on a virtual clock with one
+ * millisecond ticks, following the feedback task: stop the effect playing
+ * when it ends, and start the next effect if nothing is playing or it
+ * outranks the effect playing.
+ *
+ * @return EXIT_SUCCESS if every effect started at its expected time and only
+ * the expected effects were cut short, EXIT_FAILURE otherwise
+ ******************************************************************************/
+static int EffectQueueBenchmark_Playout(void)
+{
+    EffectQueue_t queue;
+    EffectQueue_Effect_t playing = {0};
+    EffectQueue_Effect_t next;
+    bool isPlaying = false;
+    uint32_t endMs = 0U;
+    uint32_t postIndex = 0U;
+    uint32_t startCount = 0U;
+    uint32_t preempted = 0U;
+    uint32_t mismatches = 0U;
+    int status = EXIT_SUCCESS;
+
+    EffectQueue_Init(&queue);
+
+    for (uint32_t timeMs = 0U; timeMs < EFFECTQUEUEBENCHMARK_PLAYOUT_MS; timeMs++)
+    {
+        while (postIndex < EFFECTQUEUEBENCHMARK_SCRIPT_POSTS && EffectQueueBenchmark_Script[postIndex].TimeMs == timeMs)
+        {
+            (void)EffectQueue_Post(&queue, &EffectQueueBenchmark_Script[postIndex].Effect);
+            postIndex++;
+        }
+
+        if (isPlaying && timeMs >= endMs)
+        {
+            isPlaying = false;
+        }
+
+        if (EffectQueue_Take(&queue, isPlaying ? playing.Priority : EFFECTQUEUE_PRIORITY_NONE, &next))
+        {
+            if (isPlaying)
+            {
+                preempted++;
+            }
+
+            if (startCount >= EFFECTQUEUEBENCHMARK_SCRIPT_POSTS || EffectQueueBenchmark_ExpectedStarts[startCount].TimeMs != timeMs || EffectQueueBenchmark_ExpectedStarts[startCount].Param != next.Param)
+            {
+                printf("  Playout: effect %" PRIu32 " started at %" PRIu32 " ms unexpectedly\n", next.Param, timeMs);
+                mismatches++;
+            }
+
+            startCount++;
+            playing = next;
+            isPlaying = true;
+            endMs = timeMs + next.DurationMs;
+        }
+    }
+
+    printf("  Playout: %" PRIu32 " effects started, %" PRIu32 " cut short\n", startCount, preempted);
+
+    if (mismatches > 0U || startCount != EFFECTQUEUEBENCHMARK_SCRIPT_POSTS || preempted != EFFECTQUEUEBENCHMARK_EXPECTED_PREEMPTED)
+    {
+        printf("  FAILED: playout does not match the expected order of effects\n");
+        status = EXIT_FAILURE;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Post and take random effects, checking the result of every
+ * operation against the reference model.  Takes pass random priorities to
+ * exercise taking only effects that outrank the one playing.
+ *
+ * @param[in] operations Number of operations
+ * @param[in] seed       Seed of the operations
+ *
+ * @return EXIT_SUCCESS if the queue matched the reference model, EXIT_FAILURE
+ * otherwise
+ ******************************************************************************/
+static int EffectQueueBenchmark_Random(const uint32_t operations, const uint32_t seed)
+{
+    EffectQueue_t queue;
+    EffectQueueBenchmark_Reference_t reference = {.Count = 0U, .NextSequence = 0U};
+    EffectQueue_Effect_t effect;
+    EffectQueue_Effect_t taken;
+    EffectQueue_Effect_t referenceTaken;
+    Prng_t prng;
+    uint8_t abovePriority;
+    bool result;
+    bool referenceResult;
+    uint32_t mismatches = 0U;
+    int status = EXIT_SUCCESS;
+
+    EffectQueue_Init(&queue);
+    Prng_Seed(&prng, seed, 0U);
+
+    for (uint32_t operation = 0U; operation < operations; operation++)
+    {
+        if (Prng_Bounded(&prng, EFFECTQUEUEBENCHMARK_PERCENT) < EFFECTQUEUEBENCHMARK_TAKE_PERCENT)
+        {
+            abovePriority = (uint8_t)Prng_Bounded(&prng, EFFECTQUEUEBENCHMARK_MAX_PRIORITY);
+            result = EffectQueue_Take(&queue, abovePriority, &taken);
+            referenceResult = EffectQueueBenchmark_ReferenceTake(&reference, &referenceTaken);
+
+            /* The reference always takes, put back what the queue would not take */
+            if (referenceResult && referenceTaken.Priority <= abovePriority)
+            {
+                reference.Count++;
+                referenceResult = false;
+            }
+            if (result != referenceResult || (result && taken.Param != referenceTaken.Param))
+            {
+                mismatches++;
+            }
+        }
+        else
+        {
+            effect = EffectQueueBenchmark_RandomEffect(&prng, operation);
+            if (EffectQueue_Post(&queue, &effect) != EffectQueueBenchmark_ReferencePost(&reference, &effect))
+            {
+                mismatches++;
+            }
+        }
+
+        if (queue.Count != reference.Count)
+        {
+            mismatches++;
+        }
+    }
+
+    printf("  Random: %" PRIu32 " posted, %" PRIu32 " dropped, %" PRIu32 " taken, %" PRIu32 " mismatches\n", queue.Stats.Posted, queue.Stats.Dropped, queue.Stats.Taken, mismatches);
+
+    if (mismatches > 0U)
+    {
+        printf("  FAILED: queue differs from the reference model\n");
+        status = EXIT_FAILURE;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Measure the cost of posting an effect with the queue mostly full,
+ * timing every post so the worst case is reported alongside the mean.
+ *
+ * @param[in] operations Number of posts
+ * @param[in] seed       Seed of the effects
+ ******************************************************************************/
+static void EffectQueueBenchmark_Cost(const uint32_t operations, const uint32_t seed)
+{
+    Benchmark_TimeNs_t *postNs = malloc((size_t)operations * sizeof(Benchmark_TimeNs_t));
+    Benchmark_TimeNs_t overheadNs = Benchmark_GetTimerOverheadNs();
+    Benchmark_TimeNs_t startNs;
+    Benchmark_TimeNs_t elapsedNs;
+    Benchmark_TimeNs_t totalNs = 0U;
+    EffectQueue_t queue;
+    EffectQueue_Effect_t effect;
+    Prng_t prng;
+
+    if (postNs == NULL)
+    {
+        printf("Failed to allocate post times\n");
+        return;
+    }
+
+    EffectQueue_Init(&queue);
+    Prng_Seed(&prng, seed, 1U);
+
+    for (uint32_t operation = 0U; operation < operations; operation++)
+    {
+        effect = EffectQueueBenchmark_RandomEffect(&prng, operation);
+
+        startNs = Benchmark_GetTimeNs();
+        (void)EffectQueue_Post(&queue, &effect);
+        elapsedNs = Benchmark_GetTimeNs() - startNs;
+
+        postNs[operation] = (elapsedNs > overheadNs) ? (elapsedNs - overheadNs) : 0U;
+        totalNs += postNs[operation];
+
+        /* Take about every other post, like a player keeping up with the game */
+        if ((operation & 1U) != 0U)
+        {
+            (void)EffectQueue_Take(&queue, EFFECTQUEUE_PRIORITY_NONE, &effect);
+        }
+    }
+
+    qsort(postNs, operations, sizeof(Benchmark_TimeNs_t), EffectQueueBenchmark_CompareNs);
+
+    printf("  Post cost: mean %.1f ns, p99 %" PRIu64 " ns, max %" PRIu64 " ns (timer overhead %" PRIu64 " ns/call subtracted)\n", (double)totalNs / operations,
+           postNs[((uint64_t)operations * EFFECTQUEUEBENCHMARK_P99_PERMILLE) / EFFECTQUEUEBENCHMARK_PERMILLE], postNs[operations - 1U], overheadNs);
+
+    free(postNs);
+}
+
+/**
+ * @brief Post an effect to the reference model, following the rules of
+ * EffectQueue_Post.
+ *
+ * @param[in,out] reference Reference model to post to
+ * @param[in]     effect    Effect to post
+ *
+ * @return Whether the effect was queued or not
+ ******************************************************************************/
+static bool EffectQueueBenchmark_ReferencePost(EffectQueueBenchmark_Reference_t *const reference, const EffectQueue_Effect_t *const effect)
+{
+    EffectQueue_Entry_t entry = {.Effect = *effect, .Sequence = reference->NextSequence++};
+    uint32_t lastIndex = 0U;
+    bool posted = true;
+
+    if (reference->Count < EFFECTQUEUE_CAPACITY)
+    {
+        reference->Entries[reference->Count++] = entry;
+    }
+    else
+    {
+        for (uint32_t index = 1U; index < reference->Count; index++)
+        {
+            if (EffectQueueBenchmark_IsBefore(&reference->Entries[lastIndex], &reference->Entries[index]))
+            {
+                lastIndex = index;
+            }
+        }
+
+        posted = EffectQueueBenchmark_IsBefore(&entry, &reference->Entries[lastIndex]);
+        if (posted)
+        {
+            reference->Entries[lastIndex] = entry;
+        }
+    }
+
+    return posted;
+}
+
+/**
+ * @brief Take the first effect from the reference model.  Leaves the taken
+ * entry just past the end of the array, so incrementing Count puts it back.
+ *
+ * @param[in,out] reference Reference model to take from
+ * @param[out]    effect    Effect taken
+ *
+ * @return Whether an effect was taken or not
+ ******************************************************************************/
+static bool EffectQueueBenchmark_ReferenceTake(EffectQueueBenchmark_Reference_t *const reference, EffectQueue_Effect_t *const effect)
+{
+    EffectQueue_Entry_t first;
+    uint32_t firstIndex = 0U;
+    bool taken = false;
+
+    if (reference->Count > 0U)
+    {
+        for (uint32_t index = 1U; index < reference->Count; index++)
+        {
+            if (EffectQueueBenchmark_IsBefore(&reference->Entries[index], &reference->Entries[firstIndex]))
+            {
+                firstIndex = index;
+            }
+        }
+
+        first = reference->Entries[firstIndex];
+        reference->Count--;
+        reference->Entries[firstIndex] = reference->Entries[reference->Count];
+        reference->Entries[reference->Count] = first;
+        *effect = first.Effect;
+        taken = true;
+    }
+
+    return taken;
+}
+
+/**
+ * @brief Check if an entry is to be taken before another, by priority and
+ * then by the order in which they were posted.
+ *
+ * @param[in] a Entry to check
+ * @param[in] b Entry to check against
+ *
+ * @return Whether a is taken before b or not
+ ******************************************************************************/
+static bool EffectQueueBenchmark_IsBefore(const EffectQueue_Entry_t *const a, const EffectQueue_Entry_t *const b)
+{
+    return (a->Effect.Priority > b->Effect.Priority) || (a->Effect.Priority == b->Effect.Priority && a->Sequence < b->Sequence);
+}
+
+/**
+ * @brief Draw a random effect.
+ *
+ * @param[in,out] prng  Generator to draw the effect from
+ * @param[in]     param Parameter of the effect, identifies it when taken
+ *
+ * @return Random effect with a priority above EFFECTQUEUE_PRIORITY_NONE
+ ******************************************************************************/
+static EffectQueue_Effect_t EffectQueueBenchmark_RandomEffect(Prng_t *const prng, const uint32_t param)
+{
+    EffectQueue_Effect_t effect = {
+        .Id = 0U,
+        .Priority = (uint8_t)(1U + Prng_Bounded(prng, EFFECTQUEUEBENCHMARK_MAX_PRIORITY)),
+        .DurationMs = 0U,
+        .Param = param,
+    };
+
+    return effect;
+}
+
+/**
+ * @brief Compare two times for qsort.
+ *
+ * @param[in] a First time
+ * @param[in] b Second time
+ *
+ * @return Negative, zero or positive if a is less than, equal to or greater
+ * than b
+ ******************************************************************************/
+static int EffectQueueBenchmark_CompareNs(const void *a, const void *b)
+{
+    const Benchmark_TimeNs_t timeA = *(const Benchmark_TimeNs_t *)a;
+    const Benchmark_TimeNs_t timeB = *(const Benchmark_TimeNs_t *)b;
+
+    return (timeA > timeB) - (timeA < timeB);
+}
@@ -0,0 +1,245 @@
+/**
+ * @file EventBusBenchmark.c
+ *
+ * @brief Throughput benchmark for the event bus.  A publisher thread standing
+ * in for the GPIO ISR publishes button events in bursts of half a ring to 1, 4
+ * and then 16 subscribers, each received from by a thread of its own standing
+ * in for a subscribing task, yielding between bursts like an ISR returning.
+ * The cost of publishing is timed over the bursts alone, and the rate of
+ * events delivered over the whole run.  Every event carries its sequence
+ * number, and a payload derived from it, so subscribers can check they receive
+ * events in order, each at most once and intact.  Events that do not fit in a
+ * slow subscriber's ring are dropped for it and counted, and never block the
+ * publisher.
+ *
+ * Exits with a failure status if any subscriber receives an event out of
+ * order, twice or corrupted, if the events received and dropped by a
+ * subscriber do not add up to the events published, or if publishing
+ * allocates.
+ *
+ * Usage: EventBusBenchmark [events per run]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "EventBus.h"
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define EVENTBUSBENCHMARK_DEFAULT_EVENTS 2000000U         /* Events published in each run if not specified */
+#define EVENTBUSBENCHMARK_BURST (EVENTBUS_RING_SIZE / 2U) /* Events published between yields */
+#define EVENTBUSBENCHMARK_RUNS 3U                         /* Number of runs, one per number of subscribers */
+#define EVENTBUSBENCHMARK_PAYLOAD_MULTIPLIER 2654435761U  /* Multiplier deriving the payload of an event from its sequence number */
+#define EVENTBUSBENCHMARK_NS_PER_S 1000000000.0           /* Nanoseconds per second */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Counters for a single subscriber */
+typedef struct
+{
+    uint64_t Received;  /* Events received */
+    uint64_t Reordered; /* Events received out of order or more than once */
+    uint64_t Corrupted; /* Events received with a payload not matching their sequence number */
+} EventBusBenchmark_Counters_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static bool EventBusBenchmark_Run(const uint32_t subscriberCount);
+static void *EventBusBenchmark_Subscriber(void *arg);
+
+/* Globals
+ ******************************************************************************/
+
+static const uint32_t EventBusBenchmark_SubscriberCounts[EVENTBUSBENCHMARK_RUNS] = {1U, 4U, 16U}; /* Number of subscribers of each run */
+
+static EventBus_t EventBusBenchmark_Bus;                                                  /* Bus under test */
+static EventBus_Subscriber_t EventBusBenchmark_Subscribers[EVENTBUS_MAX_SUBSCRIBERS];     /* Subscribers to button events */
+static EventBusBenchmark_Counters_t EventBusBenchmark_Counters[EVENTBUS_MAX_SUBSCRIBERS]; /* Counters for each subscriber */
+static uint32_t EventBusBenchmark_Events = EVENTBUSBENCHMARK_DEFAULT_EVENTS;              /* Events published in each run */
+static atomic_bool EventBusBenchmark_PublisherDone;                                       /* Whether the publisher finished publishing */
+static pthread_barrier_t EventBusBenchmark_StartBarrier;                                  /* Starts all threads at the same time */
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    int status = EXIT_SUCCESS;
+
+    if (argc > 1)
+    {
+        EventBusBenchmark_Events = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+
+    printf("Event bus benchmark: %" PRIu32 " events per run, rings of %u events\n", EventBusBenchmark_Events, EVENTBUS_RING_SIZE);
+    for (uint32_t run = 0U; run < EVENTBUSBENCHMARK_RUNS; run++)
+    {
+        if (!EventBusBenchmark_Run(EventBusBenchmark_SubscriberCounts[run]))
+        {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief Publish events to a number of subscribers from this thread and report
+ * the throughput and what each subscriber received.
+ *
+ * @param[in] subscriberCount Number of subscribers, at most
+ * EVENTBUS_MAX_SUBSCRIBERS
+ *
+ * @return Whether every subscriber received and dropped the events correctly
+ * and publishing did not allocate
+ ******************************************************************************/
+static bool EventBusBenchmark_Run(const uint32_t subscriberCount)
+{
+    pthread_t subscribers[EVENTBUS_MAX_SUBSCRIBERS];
+    EventBus_Event_t event = {.Type = EVENTBUS_TYPE_BUTTON};
+    Benchmark_Allocations_t allocations;
+    uint64_t delivered = 0U;
+    uint64_t received = 0U;
+    uint64_t dropped = 0U;
+    uint64_t drops;
+    Benchmark_TimeNs_t publishTime = 0U;
+    Benchmark_TimeNs_t burstStart;
+    bool passed = true;
+
+    EventBus_Init(&EventBusBenchmark_Bus);
+    atomic_init(&EventBusBenchmark_PublisherDone, false);
+    pthread_barrier_init(&EventBusBenchmark_StartBarrier, NULL, subscriberCount + 1U);
+
+    for (uintptr_t subscriber = 0U; subscriber < subscriberCount; subscriber++)
+    {
+        EventBusBenchmark_Counters[subscriber] = (EventBusBenchmark_Counters_t){0};
+        (void)EventBus_Subscribe(&EventBusBenchmark_Bus, EVENTBUS_TYPE_BUTTON, &EventBusBenchmark_Subscribers[subscriber], NULL, NULL);
+        pthread_create(&subscribers[subscriber], NULL, EventBusBenchmark_Subscriber, (void *)subscriber);
+    }
+
+    pthread_barrier_wait(&EventBusBenchmark_StartBarrier);
+    Benchmark_ResetAllocations();
+    Benchmark_TimeNs_t start = Benchmark_GetTimeNs();
+
+    for (uint32_t burst = 0U; burst < EventBusBenchmark_Events; burst += EVENTBUSBENCHMARK_BURST)
+    {
+        burstStart = Benchmark_GetTimeNs();
+        for (uint32_t sequence = burst + 1U; sequence <= burst + EVENTBUSBENCHMARK_BURST && sequence <= EventBusBenchmark_Events; sequence++)
+        {
+            event.TimeUs = (EventBus_TimeUs_t)sequence;
+            event.Button.GpioNum = sequence * EVENTBUSBENCHMARK_PAYLOAD_MULTIPLIER;
+            delivered += EventBus_Publish(&EventBusBenchmark_Bus, &event);
+        }
+        publishTime += Benchmark_GetTimeNs() - burstStart;
+
+        /* Let subscribers drain their rings between bursts, even on a single core */
+        sched_yield();
+    }
+
+    allocations = Benchmark_GetAllocations();
+    atomic_store(&EventBusBenchmark_PublisherDone, true);
+
+    for (uint32_t subscriber = 0U; subscriber < subscriberCount; subscriber++)
+    {
+        pthread_join(subscribers[subscriber], NULL);
+    }
+
+    Benchmark_TimeNs_t time = Benchmark_GetTimeNs() - start;
+
+    printf("  %2" PRIu32 " subscribers:\n", subscriberCount);
+    for (uint32_t subscriber = 0U; subscriber < subscriberCount; subscriber++)
+    {
+        EventBusBenchmark_Counters_t *counters = &EventBusBenchmark_Counters[subscriber];
+
+        drops = EventBus_GetDrops(&EventBusBenchmark_Subscribers[subscriber]);
+        printf("    Subscriber %2" PRIu32 ": received %10" PRIu64 ", dropped %10" PRIu64 ", out of order %" PRIu64 ", corrupted %" PRIu64 "\n", subscriber, counters->Received, drops, counters->Reordered, counters->Corrupted);
+        received += counters->Received;
+        dropped += drops;
+        if (counters->Received + drops != EventBusBenchmark_Events || counters->Reordered != 0U || counters->Corrupted != 0U)
+        {
+            passed = false;
+        }
+    }
+    if (delivered != received)
+    {
+        passed = false;
+    }
+
+    printf("    Events/sec:     %.0f published, %.0f received by all subscribers\n", (publishTime > 0U) ? ((double)EventBusBenchmark_Events * EVENTBUSBENCHMARK_NS_PER_S / (double)publishTime) : 0.0,
+           (time > 0U) ? ((double)received * EVENTBUSBENCHMARK_NS_PER_S / (double)time) : 0.0);
+    printf("    Publish:        %.1f ns per event, %.1f ns per subscriber\n", (EventBusBenchmark_Events > 0U) ? ((double)publishTime / (double)EventBusBenchmark_Events) : 0.0,
+           (EventBusBenchmark_Events > 0U) ? ((double)publishTime / (double)EventBusBenchmark_Events / (double)subscriberCount) : 0.0);
+    printf("    Dropped:        %" PRIu64 " of %" PRIu64 " deliveries (%.2f%%)\n", dropped, (uint64_t)EventBusBenchmark_Events * subscriberCount,
+           (EventBusBenchmark_Events > 0U) ? (100.0 * (double)dropped / ((double)EventBusBenchmark_Events * subscriberCount)) : 0.0);
+    printf("    Allocations:    %" PRIu64 "\n", allocations.Allocations);
+    if (allocations.Allocations != 0U)
+    {
+        passed = false;
+    }
+    if (!passed)
+    {
+        printf("FAIL: events were lost, reordered, duplicated or corrupted, or publishing allocated\n");
+    }
+
+    pthread_barrier_destroy(&EventBusBenchmark_StartBarrier);
+
+    return passed;
+}
+
+/**
+ * @brief Subscriber thread.  Receives events like a subscribing task drains
+ * its ring, checking each follows the last one received and is intact, until
+ * the publisher is done and the ring is empty.
+ *
+ * @param[in] arg Index of the subscriber
+ *
+ * @return NULL
+ ******************************************************************************/
+static void *EventBusBenchmark_Subscriber(void *arg)
+{
+    uint32_t subscriber = (uint32_t)(uintptr_t)arg;
+    EventBus_Subscriber_t *const ring = &EventBusBenchmark_Subscribers[subscriber];
+    EventBusBenchmark_Counters_t counters = {0};
+    EventBus_Event_t event;
+    EventBus_TimeUs_t last = 0;
+    bool done = false;
+
+    pthread_barrier_wait(&EventBusBenchmark_StartBarrier);
+
+    while (!done)
+    {
+        /* Read the flag before draining, so events published before it was set are all received */
+        done = atomic_load(&EventBusBenchmark_PublisherDone);
+
+        while (EventBus_Receive(ring, &event))
+        {
+            counters.Received++;
+            if (event.TimeUs <= last)
+            {
+                counters.Reordered++;
+            }
+            if (event.Type != EVENTBUS_TYPE_BUTTON || event.Button.GpioNum != (uint32_t)event.TimeUs * EVENTBUSBENCHMARK_PAYLOAD_MULTIPLIER)
+            {
+                counters.Corrupted++;
+            }
+            last = event.TimeUs;
+        }
+
+        sched_yield();
+    }
+
+    EventBusBenchmark_Counters[subscriber] = counters;
+
+    return NULL;
+}
@@ -0,0 +1,598 @@
+/**
+ * @file GameLinkBenchmark.c
+ *
+ * @brief Benchmark of the GameLink protocol with many blasters in one process.
+ * Each blaster has its own clock, with a random offset and drift, and plays a
+ * simulated game, sending its state, the commands it issues and their results
+ * to every other blaster.
+ *
+ * Over the in-process channel, frames take a random delay like a radio and
+ * time is simulated, so the run is deterministic and as fast as the host
+ * allows.  The run is repeated without batching to show how many frames
+ * batching saves.  Over UDP, blasters exchange real datagrams on the loopback
+ * interface in real time.
+ *
+ * Reports the message and frame rates, the error of every blaster's estimate
+ * of every other blaster's clock offset and the error of command issue times
+ * converted to the receiver's clock.  Exits with a failure status if a game
+ * message is lost, a pair of blasters never synchronizes or a sync error is
+ * beyond what the delay jitter and drift can explain.
+ *
+ * Usage: GameLinkBenchmark [blasters] [seconds] [channel|udp] [seed]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "GameLink.h"
+#include "LinkChannel.h"
+#include "LinkUdp.h"
+#include "Prng.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define GAMELINKBENCHMARK_DEFAULT_BLASTERS 8U             /* Number of blasters if not specified */
+#define GAMELINKBENCHMARK_DEFAULT_CHANNEL_SECONDS 60U     /* Simulated length of a run over the channel if not specified */
+#define GAMELINKBENCHMARK_DEFAULT_UDP_SECONDS 10U         /* Length of a run over UDP if not specified */
+#define GAMELINKBENCHMARK_DEFAULT_SEED 1U                 /* Seed of the clocks, games and delays if not specified */
+#define GAMELINKBENCHMARK_TICK_US 100U                    /* Step of simulated time over the channel */
+#define GAMELINKBENCHMARK_BASE_DELAY_US 1000U             /* Shortest delay of a frame over the channel */
+#define GAMELINKBENCHMARK_JITTER_US 2000U                 /* Range of the random delay added to each frame over the channel */
+#define GAMELINKBENCHMARK_UDP_JITTER_US 2000U             /* Allowance for scheduling delays of reading datagrams over UDP */
+#define GAMELINKBENCHMARK_UDP_BASE_PORT 47000U            /* Loopback port of the first blaster over UDP */
+#define GAMELINKBENCHMARK_UDP_SLEEP_NS 100000L            /* Time slept between polls over UDP */
+#define GAMELINKBENCHMARK_BATCH_WINDOW_US 10000U          /* Longest time a message waits to be batched */
+#define GAMELINKBENCHMARK_SYNC_PERIOD_US 250000U          /* Time between asking peers for their time */
+#define GAMELINKBENCHMARK_MAX_DRIFT_PPM 20U               /* Largest drift of a blaster's clock, in parts per million */
+#define GAMELINKBENCHMARK_PPM 1000000                     /* Scale of a part per million */
+#define GAMELINKBENCHMARK_MEASURE_PERIOD_US 100000U       /* Time between measurements of the sync error */
+#define GAMELINKBENCHMARK_WARMUP_MARGIN_US 500000U        /* Time allowed after every peer was asked for its time before the sync error is measured */
+#define GAMELINKBENCHMARK_DRAIN_US 1000000U               /* Time after the games end for the last frames to arrive */
+#define GAMELINKBENCHMARK_US_PER_S 1000000U               /* Microseconds per second */
+#define GAMELINKBENCHMARK_NS_PER_US 1000U                 /* Nanoseconds per microsecond */
+#define GAMELINKBENCHMARK_WAIT_MS 2000U                   /* Time the simulated players have to complete a command */
+#define GAMELINKBENCHMARK_US_PER_MS 1000U                 /* Microseconds per millisecond */
+#define GAMELINKBENCHMARK_MIN_REACTION_US 200000U         /* Fastest reaction of a simulated player */
+#define GAMELINKBENCHMARK_REACTION_RANGE_US 2200000U      /* Range of reactions, some slower than the time to complete a command */
+#define GAMELINKBENCHMARK_PAUSE_US 300000U                /* Time between a result and the next command */
+#define GAMELINKBENCHMARK_FIRST_COMMAND_RANGE_US 1000000U /* Range of the time of the first command of each game */
+#define GAMELINKBENCHMARK_STATE_PERIOD_US 5000000U        /* Time between state messages */
+#define GAMELINKBENCHMARK_LIVES 3U                        /* Lives at the start of a game */
+#define GAMELINKBENCHMARK_ISSUE_TIMES 256U                /* Number of issue times kept, one per value of a command index */
+#define GAMELINKBENCHMARK_STATE_WAIT 1U                   /* Game state sent while playing */
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef struct GameLinkBenchmark_Sim GameLinkBenchmark_Sim_t; /* Blasters playing together */
+
+/* Simulated blaster */
+typedef struct
+{
+    GameLink_t Link;                                 /* Link to the other blasters */
+    GameLinkBenchmark_Sim_t *Sim;                    /* Blasters playing together */
+    LinkUdp_t Udp;                                   /* Endpoint over UDP */
+    uint32_t ClockOffsetUs;                          /* Offset of the blaster's clock from simulated time */
+    int32_t DriftPpm;                                /* Drift of the blaster's clock */
+    Prng_t Prng;                                     /* Generator of the player's reactions */
+    uint64_t NextEventUs;                            /* Time of the next command or result */
+    uint64_t NextStateUs;                            /* Time of the next state message */
+    bool Waiting;                                    /* Whether a command is waiting for its result */
+    uint8_t CommandIndex;                            /* Index of the last command issued, counting up */
+    uint8_t Score;                                   /* Score of the player */
+    uint8_t Lives;                                   /* Remaining lives of the player */
+    uint64_t IssueUs[GAMELINKBENCHMARK_ISSUE_TIMES]; /* Simulated time each recent command was issued, by command index */
+    uint32_t MessagesSent;                           /* Number of game messages sent */
+    uint32_t MessagesReceived;                       /* Number of game messages received */
+    uint64_t CommandErrorSumUs;                      /* Sum of the errors of command issue times converted to the local clock */
+    uint32_t CommandErrorMaxUs;                      /* Largest error of a command issue time converted to the local clock */
+    uint32_t CommandErrorCount;                      /* Number of command issue times converted */
+} GameLinkBenchmark_Blaster_t;
+
+struct GameLinkBenchmark_Sim
+{
+    GameLinkBenchmark_Blaster_t Blasters[LINKCHANNEL_MAX_ENDPOINTS]; /* Blasters, whose IDs are their indexes */
+    uint32_t BlasterCount;                                           /* Number of blasters */
+    LinkChannel_t Channel;                                           /* Channel between the blasters if not over UDP */
+    uint64_t SyncErrorSumUs;                                         /* Sum of the errors of clock offset estimates */
+    uint32_t SyncErrorMaxUs;                                         /* Largest error of a clock offset estimate */
+    uint64_t SyncErrorCount;                                         /* Number of clock offset estimates measured */
+    uint32_t Unsynced;                                               /* Number of measurements of a pair of blasters without an estimate */
+};
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static int GameLinkBenchmark_Run(GameLinkBenchmark_Sim_t *const sim, const uint32_t blasters, const uint32_t seconds, const bool udp, const GameLink_TimeUs_t batchWindowUs, const uint32_t seed);
+static bool GameLinkBenchmark_Init(GameLinkBenchmark_Sim_t *const sim, const uint32_t blasters, const bool udp, const GameLink_TimeUs_t batchWindowUs, const uint32_t seed);
+static void GameLinkBenchmark_Step(GameLinkBenchmark_Blaster_t *const blaster, const uint64_t timeUs);
+static void GameLinkBenchmark_Send(GameLinkBenchmark_Blaster_t *const blaster, GameLink_Message_t *const message, const uint64_t timeUs);
+static void GameLinkBenchmark_OnMessage(void *const context, const GameLink_Message_t *const message);
+static void GameLinkBenchmark_Deliver(void *const context, const uint32_t endpoint, const uint8_t *const frame, const uint32_t size, const uint64_t timeUs);
+static void GameLinkBenchmark_MeasureSync(GameLinkBenchmark_Sim_t *const sim, const uint64_t timeUs);
+static GameLink_TimeUs_t GameLinkBenchmark_LocalTime(const GameLinkBenchmark_Blaster_t *const blaster, const uint64_t timeUs);
+static uint32_t GameLinkBenchmark_AbsDiff(const GameLink_TimeUs_t a, const GameLink_TimeUs_t b);
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    GameLinkBenchmark_Sim_t *sim = malloc(sizeof(GameLinkBenchmark_Sim_t));
+    uint32_t blasters = GAMELINKBENCHMARK_DEFAULT_BLASTERS;
+    uint32_t seconds = 0U;
+    uint32_t seed = GAMELINKBENCHMARK_DEFAULT_SEED;
+    bool udp = false;
+    int status = EXIT_SUCCESS;
+
+    if (argc > 1)
+    {
+        blasters = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        seconds = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3)
+    {
+        udp = strcmp(argv[3], "udp") == 0;
+    }
+    if (argc > 4)
+    {
+        seed = (uint32_t)strtoul(argv[4], NULL, 0);
+    }
+    if (blasters < 2U || blasters > LINKCHANNEL_MAX_ENDPOINTS || blasters > (GAMELINK_MAX_PEERS + 1U))
+    {
+        blasters = GAMELINKBENCHMARK_DEFAULT_BLASTERS;
+    }
+    if (seconds == 0U)
+    {
+        seconds = udp ? GAMELINKBENCHMARK_DEFAULT_UDP_SECONDS : GAMELINKBENCHMARK_DEFAULT_CHANNEL_SECONDS;
+    }
+
+    if (sim == NULL)
+    {
+        printf("Failed to allocate the simulation\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("GameLink benchmark: %" PRIu32 " blasters, %" PRIu32 " s over %s, seed %" PRIu32 "\n", blasters, seconds, udp ? "UDP loopback" : "in-process channel", seed);
+
+    if (GameLinkBenchmark_Run(sim, blasters, seconds, udp, GAMELINKBENCHMARK_BATCH_WINDOW_US, seed) != EXIT_SUCCESS)
+    {
+        status = EXIT_FAILURE;
+    }
+    if (!udp && GameLinkBenchmark_Run(sim, blasters, seconds, udp, 0U, seed) != EXIT_SUCCESS)
+    {
+        status = EXIT_FAILURE;
+    }
+
+    free(sim);
+
+    return status;
+}
+
+/**
+ * @brief Play simulated games on every blaster for a time, then let the last
+ * frames arrive, measuring the sync error as the games are played.
+ *
+ * @param[out] sim           Blasters playing together
+ * @param[in]  blasters      Number of blasters
+ * @param[in]  seconds       Length of the games, extended if too short for
+ * every pair of blasters to synchronize
+ * @param[in]  udp           Whether blasters exchange frames over UDP in real
+ * time or over the channel in simulated time
+ * @param[in]  batchWindowUs Longest time a message waits to be batched
+ * @param[in]  seed          Seed of the clocks, games and delays
+ *
+ * @return EXIT_SUCCESS if every game message arrived and every pair of
+ * blasters synchronized within the expected error, EXIT_FAILURE otherwise
+ ******************************************************************************/
+static int GameLinkBenchmark_Run(GameLinkBenchmark_Sim_t *const sim, const uint32_t blasters, const uint32_t seconds, const bool udp, const GameLink_TimeUs_t batchWindowUs, const uint32_t seed)
+{
+    struct timespec sleep = {.tv_sec = 0, .tv_nsec = GAMELINKBENCHMARK_UDP_SLEEP_NS};
+    uint8_t frame[GAMELINK_MAX_FRAME_SIZE];
+    GameLinkBenchmark_Blaster_t *blaster;
+    GameLink_Stats_t total = {0U};
+    uint64_t endUs = (uint64_t)seconds * GAMELINKBENCHMARK_US_PER_S;
+    uint64_t warmupUs = ((uint64_t)blasters * GAMELINKBENCHMARK_SYNC_PERIOD_US) + GAMELINKBENCHMARK_WARMUP_MARGIN_US;
+    uint64_t nextMeasureUs = warmupUs;
+    uint64_t timeUs = 0U;
+    uint64_t received = 0U;
+    uint64_t expected = 0U;
+    uint64_t gameMessages = 0U;
+    uint64_t commandErrorSumUs = 0U;
+    uint32_t commandErrorMaxUs = 0U;
+    uint64_t commandErrorCount = 0U;
+    uint32_t framesLost = 0U;
+    uint32_t size;
+    uint32_t boundUs;
+    Benchmark_TimeNs_t startNs;
+    Benchmark_TimeNs_t elapsedNs;
+    int status = EXIT_SUCCESS;
+
+    /* Every blaster asks every peer for its time once before the sync error is measured */
+    if (endUs <= warmupUs)
+    {
+        endUs = warmupUs + GAMELINKBENCHMARK_US_PER_S;
+    }
+
+    if (!GameLinkBenchmark_Init(sim, blasters, udp, batchWindowUs, seed))
+    {
+        printf("  Failed to set up %" PRIu32 " blasters\n", blasters);
+        return EXIT_FAILURE;
+    }
+
+    startNs = Benchmark_GetTimeNs();
+    while (timeUs < (endUs + GAMELINKBENCHMARK_DRAIN_US))
+    {
+        if (udp)
+        {
+            for (uint32_t index = 0U; index < blasters; index++)
+            {
+                blaster = &sim->Blasters[index];
+                while ((size = LinkUdp_Receive(&blaster->Udp, frame, sizeof(frame))) > 0U)
+                {
+                    timeUs = (Benchmark_GetTimeNs() - startNs) / GAMELINKBENCHMARK_NS_PER_US;
+                    GameLink_Receive(&blaster->Link, frame, size, GameLinkBenchmark_LocalTime(blaster, timeUs));
+                }
+            }
+            timeUs = (Benchmark_GetTimeNs() - startNs) / GAMELINKBENCHMARK_NS_PER_US;
+        }
+        else
+        {
+            (void)LinkChannel_Deliver(&sim->Channel, timeUs, GameLinkBenchmark_Deliver, sim);
+            sim->Channel.TimeUs = timeUs;
+        }
+
+        for (uint32_t index = 0U; index < blasters; index++)
+        {
+            blaster = &sim->Blasters[index];
+            if (timeUs < endUs)
+            {
+                GameLinkBenchmark_Step(blaster, timeUs);
+            }
+            GameLink_Poll(&blaster->Link, GameLinkBenchmark_LocalTime(blaster, timeUs));
+        }
+
+        if (timeUs >= nextMeasureUs && timeUs < endUs)
+        {
+            GameLinkBenchmark_MeasureSync(sim, timeUs);
+            nextMeasureUs += GAMELINKBENCHMARK_MEASURE_PERIOD_US;
+        }
+
+        if (udp)
+        {
+            nanosleep(&sleep, NULL);
+        }
+        else
+        {
+            timeUs += GAMELINKBENCHMARK_TICK_US;
+        }
+    }
+    elapsedNs = Benchmark_GetTimeNs() - startNs;
+
+    for (uint32_t index = 0U; index < blasters; index++)
+    {
+        blaster = &sim->Blasters[index];
+        total.FramesSent += blaster->Link.Stats.FramesSent;
+        total.MessagesSent += blaster->Link.Stats.MessagesSent;
+        total.SendFailures += blaster->Link.Stats.SendFailures;
+        total.FramesReceived += blaster->Link.Stats.FramesReceived;
+        total.MessagesReceived += blaster->Link.Stats.MessagesReceived;
+        total.FramesInvalid += blaster->Link.Stats.FramesInvalid;
+        gameMessages += blaster->MessagesSent;
+        received += blaster->MessagesReceived;
+        expected += (uint64_t)blaster->MessagesSent * (blasters - 1U);
+        commandErrorSumUs += blaster->CommandErrorSumUs;
+        commandErrorCount += blaster->CommandErrorCount;
+        if (blaster->CommandErrorMaxUs > commandErrorMaxUs)
+        {
+            commandErrorMaxUs = blaster->CommandErrorMaxUs;
+        }
+        for (uint32_t peerIndex = 0U; peerIndex < GAMELINK_MAX_PEERS; peerIndex++)
+        {
+            framesLost += blaster->Link.Peers[peerIndex].FramesLost;
+        }
+        if (udp)
+        {
+            LinkUdp_Close(&blaster->Udp);
+        }
+    }
+
+    /* An offset estimate is off by half the difference between the delays each way, plus the drift since the exchange it was taken from */
+    boundUs = ((udp ? GAMELINKBENCHMARK_UDP_JITTER_US : GAMELINKBENCHMARK_JITTER_US) / 2U) +
+              (uint32_t)(((uint64_t)2U * GAMELINKBENCHMARK_MAX_DRIFT_PPM * GAMELINK_SYNC_SAMPLES * blasters * GAMELINKBENCHMARK_SYNC_PERIOD_US) / GAMELINKBENCHMARK_PPM);
+
+    printf("  %s: %" PRIu32 " messages (%" PRIu64 " game) in %" PRIu32 " frames, %.2f messages/frame, %.1f messages/s, %.1f frames/s\n", (batchWindowUs > 0U) ? "Batched" : "Unbatched", total.MessagesSent, gameMessages,
+           total.FramesSent, (total.FramesSent > 0U) ? (double)total.MessagesSent / total.FramesSent : 0.0, ((double)total.MessagesSent * GAMELINKBENCHMARK_US_PER_S) / endUs, ((double)total.FramesSent * GAMELINKBENCHMARK_US_PER_S) / endUs);
+    printf("    Delivered %" PRIu64 "/%" PRIu64 " game messages, %" PRIu32 " frames lost, %" PRIu32 " invalid, %" PRIu32 " send failures", received, expected, framesLost, total.FramesInvalid, total.SendFailures);
+    if (!udp)
+    {
+        printf(", %.0f ns of host time per message received", (total.MessagesReceived > 0U) ? (double)elapsedNs / total.MessagesReceived : 0.0);
+    }
+    printf("\n");
+    printf("    Clock offset error: mean %.1f us, max %" PRIu32 " us over %" PRIu64 " estimates (bound %" PRIu32 " us)\n", (sim->SyncErrorCount > 0U) ? (double)sim->SyncErrorSumUs / sim->SyncErrorCount : 0.0, sim->SyncErrorMaxUs,
+           sim->SyncErrorCount, boundUs);
+    printf("    Command issue time error on receivers' clocks: mean %.1f us, max %" PRIu32 " us over %" PRIu64 " commands\n", (commandErrorCount > 0U) ? (double)commandErrorSumUs / commandErrorCount : 0.0, commandErrorMaxUs,
+           commandErrorCount);
+
+    if (received != expected || (!udp && sim->Channel.Overflows > 0U))
+    {
+        printf("    FAIL: %" PRIu64 " game messages lost\n", expected - received);
+        status = EXIT_FAILURE;
+    }
+    if (sim->Unsynced > 0U || sim->SyncErrorCount == 0U)
+    {
+        printf("    FAIL: %" PRIu32 " measurements of a pair of blasters without an offset estimate\n", sim->Unsynced);
+        status = EXIT_FAILURE;
+    }
+    if (sim->SyncErrorMaxUs > boundUs)
+    {
+        printf("    FAIL: clock offset error beyond %" PRIu32 " us\n", boundUs);
+        status = EXIT_FAILURE;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Set up blasters with random clocks and their links.
+ *
+ * @param[out] sim           Blasters playing together
+ * @param[in]  blasters      Number of blasters
+ * @param[in]  udp           Whether blasters exchange frames over UDP
+ * @param[in]  batchWindowUs Longest time a message waits to be batched
+ * @param[in]  seed          Seed of the clocks, games and delays
+ *
+ * @return Whether every blaster was set up or not
+ ******************************************************************************/
+static bool GameLinkBenchmark_Init(GameLinkBenchmark_Sim_t *const sim, const uint32_t blasters, const bool udp, const GameLink_TimeUs_t batchWindowUs, const uint32_t seed)
+{
+    GameLinkBenchmark_Blaster_t *blaster;
+    GameLink_Config_t config = {
+        .Transport = {.Send = udp ? LinkUdp_Send : LinkChannel_Send},
+        .OnMessage = GameLinkBenchmark_OnMessage,
+        .BatchWindowUs = batchWindowUs,
+        .SyncPeriodUs = GAMELINKBENCHMARK_SYNC_PERIOD_US,
+    };
+    Prng_t prng;
+    bool initialized = true;
+
+    memset(sim, 0, sizeof(*sim));
+    sim->BlasterCount = blasters;
+    Prng_Seed(&prng, seed, 0U);
+    (void)LinkChannel_Init(&sim->Channel, blasters, GAMELINKBENCHMARK_BASE_DELAY_US, GAMELINKBENCHMARK_JITTER_US, seed);
+
+    for (uint32_t index = 0U; index < blasters && initialized; index++)
+    {
+        blaster = &sim->Blasters[index];
+        blaster->Sim = sim;
+        blaster->ClockOffsetUs = Prng_Next(&prng);
+        blaster->DriftPpm = (int32_t)Prng_Bounded(&prng, (2U * GAMELINKBENCHMARK_MAX_DRIFT_PPM) + 1U) - (int32_t)GAMELINKBENCHMARK_MAX_DRIFT_PPM;
+        blaster->NextEventUs = Prng_Bounded(&prng, GAMELINKBENCHMARK_FIRST_COMMAND_RANGE_US);
+        blaster->Lives = GAMELINKBENCHMARK_LIVES;
+        Prng_Seed(&blaster->Prng, seed, index + 1U);
+
+        config.Id = (uint8_t)index;
+        config.Transport.Context = udp ? (void *)&blaster->Udp : (void *)&sim->Channel.Endpoints[index];
+        config.Context = blaster;
+
+        initialized = (!udp || LinkUdp_Open(&blaster->Udp, GAMELINKBENCHMARK_UDP_BASE_PORT, blasters, index)) && GameLink_Init(&blaster->Link, &config, GameLinkBenchmark_LocalTime(blaster, 0U));
+    }
+
+    return initialized;
+}
+
+/**
+ * @brief Advance a blaster's simulated game, sending its state periodically,
+ * issuing a command when the last result was sent and sending the result
+ * once the player reacts.
+ *
+ * @param[in,out] blaster Blaster to advance
+ * @param[in]     timeUs  Simulated time
+ ******************************************************************************/
+static void GameLinkBenchmark_Step(GameLinkBenchmark_Blaster_t *const blaster, const uint64_t timeUs)
+{
+    GameLink_Message_t message;
+    uint64_t reactionUs;
+    bool success;
+
+    if (timeUs >= blaster->NextStateUs)
+    {
+        message.Type = GAMELINK_MESSAGE_STATE;
+        message.State.GameState = GAMELINKBENCHMARK_STATE_WAIT;
+        message.State.Score = blaster->Score;
+        message.State.Lives = blaster->Lives;
+        GameLinkBenchmark_Send(blaster, &message, timeUs);
+        blaster->NextStateUs += GAMELINKBENCHMARK_STATE_PERIOD_US;
+    }
+
+    if (timeUs >= blaster->NextEventUs && !blaster->Waiting)
+    {
+        blaster->CommandIndex++;
+        blaster->IssueUs[blaster->CommandIndex] = timeUs;
+        message.Type = GAMELINK_MESSAGE_COMMAND;
+        message.Command.CommandIndex = blaster->CommandIndex;
+        message.Command.WaitTimeMs = GAMELINKBENCHMARK_WAIT_MS;
+        message.Command.IssueTime = GameLinkBenchmark_LocalTime(blaster, timeUs);
+        GameLinkBenchmark_Send(blaster, &message, timeUs);
+
+        blaster->NextEventUs = timeUs + GAMELINKBENCHMARK_MIN_REACTION_US + Prng_Bounded(&blaster->Prng, GAMELINKBENCHMARK_REACTION_RANGE_US);
+        blaster->Waiting = true;
+    }
+    else if (timeUs >= blaster->NextEventUs)
+    {
+        reactionUs = timeUs - blaster->IssueUs[blaster->CommandIndex];
+        success = reactionUs <= ((uint64_t)GAMELINKBENCHMARK_WAIT_MS * GAMELINKBENCHMARK_US_PER_MS);
+        if (success)
+        {
+            blaster->Score++;
+        }
+        else if (blaster->Lives > 1U)
+        {
+            blaster->Lives--;
+        }
+        else
+        {
+            /* Game over, the next command starts a new game */
+            blaster->Score = 0U;
+            blaster->Lives = GAMELINKBENCHMARK_LIVES;
+        }
+
+        message.Type = GAMELINK_MESSAGE_RESULT;
+        message.Result.CommandIndex = blaster->CommandIndex;
+        message.Result.Success = success;
+        message.Result.Score = blaster->Score;
+        message.Result.Lives = blaster->Lives;
+        GameLinkBenchmark_Send(blaster, &message, timeUs);
+
+        blaster->NextEventUs = timeUs + GAMELINKBENCHMARK_PAUSE_US;
+        blaster->Waiting = false;
+    }
+}
+
+/**
+ * @brief Send a game message from a blaster.
+ *
+ * @param[in,out] blaster Blaster sending the message
+ * @param[in]     message Message to send
+ * @param[in]     timeUs  Simulated time
+ ******************************************************************************/
+static void GameLinkBenchmark_Send(GameLinkBenchmark_Blaster_t *const blaster, GameLink_Message_t *const message, const uint64_t timeUs)
+{
+    if (GameLink_Send(&blaster->Link, message, GameLinkBenchmark_LocalTime(blaster, timeUs)))
+    {
+        blaster->MessagesSent++;
+    }
+}
+
+/**
+ * @brief Count a game message received by a blaster, and for a command,
+ * measure the error of its issue time converted to the blaster's clock.
+ *
+ * @param[in] context Blaster receiving the message
+ * @param[in] message Message received
+ ******************************************************************************/
+static void GameLinkBenchmark_OnMessage(void *const context, const GameLink_Message_t *const message)
+{
+    GameLinkBenchmark_Blaster_t *blaster = (GameLinkBenchmark_Blaster_t *)context;
+    const GameLinkBenchmark_Blaster_t *sender;
+    GameLink_TimeUs_t issueTime;
+    uint32_t errorUs;
+
+    blaster->MessagesReceived++;
+
+    if (message->Type == GAMELINK_MESSAGE_COMMAND && message->Sender < blaster->Sim->BlasterCount && GameLink_ToLocalTime(&blaster->Link, message->Sender, message->Command.IssueTime, &issueTime))
+    {
+        sender = &blaster->Sim->Blasters[message->Sender];
+        errorUs = GameLinkBenchmark_AbsDiff(issueTime, GameLinkBenchmark_LocalTime(blaster, sender->IssueUs[message->Command.CommandIndex]));
+        blaster->CommandErrorSumUs += errorUs;
+        blaster->CommandErrorCount++;
+        if (errorUs > blaster->CommandErrorMaxUs)
+        {
+            blaster->CommandErrorMaxUs = errorUs;
+        }
+    }
+}
+
+/**
+ * @brief Hand a frame delivered by the channel to the link of its blaster,
+ * stamped with the time it arrived on the blaster's clock.
+ *
+ * @param[in] context  Blasters playing together
+ * @param[in] endpoint Index of the blaster the frame was delivered to
+ * @param[in] frame    Frame delivered
+ * @param[in] size     Size of the frame in bytes
+ * @param[in] timeUs   Simulated time the frame arrived
+ ******************************************************************************/
+static void GameLinkBenchmark_Deliver(void *const context, const uint32_t endpoint, const uint8_t *const frame, const uint32_t size, const uint64_t timeUs)
+{
+    GameLinkBenchmark_Sim_t *sim = (GameLinkBenchmark_Sim_t *)context;
+    GameLinkBenchmark_Blaster_t *blaster = &sim->Blasters[endpoint];
+
+    /* Frames sent in response leave at the time the frame arrived */
+    sim->Channel.TimeUs = timeUs;
+    GameLink_Receive(&blaster->Link, frame, size, GameLinkBenchmark_LocalTime(blaster, timeUs));
+}
+
+/**
+ * @brief Measure the error of every blaster's estimate of the offset of every
+ * other blaster's clock.
+ *
+ * @param[in,out] sim    Blasters playing together
+ * @param[in]     timeUs Simulated time
+ ******************************************************************************/
+static void GameLinkBenchmark_MeasureSync(GameLinkBenchmark_Sim_t *const sim, const uint64_t timeUs)
+{
+    const GameLinkBenchmark_Blaster_t *blaster;
+    const GameLinkBenchmark_Blaster_t *other;
+    const GameLink_Peer_t *peer;
+    GameLink_TimeUs_t offsetUs;
+    uint32_t errorUs;
+
+    for (uint32_t index = 0U; index < sim->BlasterCount; index++)
+    {
+        blaster = &sim->Blasters[index];
+        for (uint32_t otherIndex = 0U; otherIndex < sim->BlasterCount; otherIndex++)
+        {
+            other = &sim->Blasters[otherIndex];
+            peer = GameLink_GetPeer(&blaster->Link, (uint8_t)otherIndex);
+
+            if (otherIndex == index)
+            {
+                /* A blaster has no offset from itself */
+            }
+            else if (peer == NULL || peer->SampleCount == 0U)
+            {
+                sim->Unsynced++;
+            }
+            else
+            {
+                offsetUs = GameLinkBenchmark_LocalTime(other, timeUs) - GameLinkBenchmark_LocalTime(blaster, timeUs);
+                errorUs = GameLinkBenchmark_AbsDiff((GameLink_TimeUs_t)peer->OffsetUs, offsetUs);
+                sim->SyncErrorSumUs += errorUs;
+                sim->SyncErrorCount++;
+                if (errorUs > sim->SyncErrorMaxUs)
+                {
+                    sim->SyncErrorMaxUs = errorUs;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Get the time on a blaster's clock.
+ *
+ * @param[in] blaster Blaster
+ * @param[in] timeUs  Simulated time
+ *
+ * @return Time on the blaster's clock
+ ******************************************************************************/
+static GameLink_TimeUs_t GameLinkBenchmark_LocalTime(const GameLinkBenchmark_Blaster_t *const blaster, const uint64_t timeUs)
+{
+    return (GameLink_TimeUs_t)(timeUs + blaster->ClockOffsetUs + (uint64_t)(((int64_t)timeUs * blaster->DriftPpm) / GAMELINKBENCHMARK_PPM));
+}
+
+/**
+ * @brief Get the distance between two times that may wrap around.
+ *
+ * @param[in] a First time
+ * @param[in] b Second time
+ *
+ * @return Distance between the times
+ ******************************************************************************/
+static uint32_t GameLinkBenchmark_AbsDiff(const GameLink_TimeUs_t a, const GameLink_TimeUs_t b)
+{
+    int32_t difference = (int32_t)(a - b);
+
+    return (difference < 0) ? (uint32_t)(-(int64_t)difference) : (uint32_t)difference;
+}
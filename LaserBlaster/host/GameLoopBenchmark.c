@@ -0,0 +1,301 @@
+/**
+ * @file GameLoopBenchmark.c
+ *
+ * @brief Timing benchmark for the event driven game loop.  Runs GameLoop and
+ * the BopIt engine on the FreeRTOS POSIX port against a simulated player that
+ * completes a number of commands and then stops responding.  Reports how far
+ * after its deadline each timeout was detected and how many times the game
+ * task was woken up compared to polling every 10 ms.
+ *
+ * Exits with a failure status if a timeout is detected early, 1 ms or more
+ * late, or if the game task wakes up more than twice per issued command.
+ *
+ * Usage: GameLoopBenchmark [games]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "BopIt.h"
+#include "Deadline.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "GameLoop.h"
+#include "InputLatch.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define GAMELOOPBENCHMARK_DEFAULT_GAMES 2U                                 /* Number of games played if not specified */
+#define GAMELOOPBENCHMARK_COMMAND_COUNT 3U                                 /* Number of commands, matches the firmware */
+#define GAMELOOPBENCHMARK_SUCCESS_ROUNDS 90U                               /* Player stops responding after reaching this score */
+#define GAMELOOPBENCHMARK_REACTION_TIME_MS 20U                             /* Simulated player reaction time */
+#define GAMELOOPBENCHMARK_POLL_PERIOD_MS 10LL                              /* Period of a fixed rate poll, for comparison */
+#define GAMELOOPBENCHMARK_MAX_TIMEOUT_ERROR_US 1000LL                      /* Timeouts must be detected within this many microseconds */
+#define GAMELOOPBENCHMARK_MAX_WAKEUPS_PER_COMMAND 2U                       /* One wakeup for the input or deadline and one spurious wakeup */
+#define GAMELOOPBENCHMARK_TASK_STACK_DEPTH (configMINIMAL_STACK_SIZE * 4U) /* Stack depth for benchmark tasks */
+#define GAMELOOPBENCHMARK_GAME_TASK_PRIORITY 5U                            /* Priority for the game task */
+#define GAMELOOPBENCHMARK_PLAYER_TASK_PRIORITY 10U                         /* Priority for the player task, matches GPIO tasks */
+#define GAMELOOPBENCHMARK_US_PER_MS 1000LL                                 /* Microseconds per millisecond */
+
+/* Define the callbacks for a command at a given index */
+#define GAMELOOPBENCHMARK_DEFINE_COMMAND(index)                                    \
+    static void GameLoopBenchmark_IssueCommand##index(void)                        \
+    {                                                                              \
+        GameLoopBenchmark_IssueCommand(index);                                     \
+    }                                                                              \
+    static bool GameLoopBenchmark_GetInput##index(BopIt_TimeUs_t *const inputTime) \
+    {                                                                              \
+        return GameLoopBenchmark_GetInput(index, inputTime);                       \
+    }
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void GameLoopBenchmark_GameTask(void *arg);
+static void GameLoopBenchmark_PlayerTask(void *arg);
+static void GameLoopBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message);
+static BopIt_TimeUs_t GameLoopBenchmark_Time(const BopIt_GameContext_t *const gameContext);
+static void GameLoopBenchmark_IssueCommand(const uint32_t commandIndex);
+static bool GameLoopBenchmark_GetInput(const uint32_t commandIndex, BopIt_TimeUs_t *const inputTime);
+static void GameLoopBenchmark_SuccessFeedback(void);
+static void GameLoopBenchmark_FailFeedback(void);
+static void GameLoopBenchmark_RecordWait(void);
+
+/* Globals
+ ******************************************************************************/
+
+static uint32_t GameLoopBenchmark_Games = GAMELOOPBENCHMARK_DEFAULT_GAMES; /* Number of games to play */
+static TaskHandle_t GameLoopBenchmark_PlayerTaskHandle = NULL;             /* Handle of the simulated player task */
+static InputLatch_t GameLoopBenchmark_InputLatch;                          /* Inputs set by the simulated player, like the button event handlers */
+
+static uint32_t GameLoopBenchmark_CommandsIssued = 0U;  /* Number of commands issued */
+static uint32_t GameLoopBenchmark_Timeouts = 0U;        /* Number of timeouts detected */
+static int64_t GameLoopBenchmark_MinTimeoutError = 0;   /* Earliest timeout detection relative to the deadline */
+static int64_t GameLoopBenchmark_MaxTimeoutError = 0;   /* Latest timeout detection relative to the deadline */
+static int64_t GameLoopBenchmark_TotalTimeoutError = 0; /* Sum of timeout detection errors */
+static int64_t GameLoopBenchmark_TotalWaitTime = 0;     /* Total time spent waiting for the player in microseconds */
+
+GAMELOOPBENCHMARK_DEFINE_COMMAND(0)
+GAMELOOPBENCHMARK_DEFINE_COMMAND(1)
+GAMELOOPBENCHMARK_DEFINE_COMMAND(2)
+
+static BopIt_Command_t GameLoopBenchmark_Commands[GAMELOOPBENCHMARK_COMMAND_COUNT] = {
+    {"Command 0", GameLoopBenchmark_IssueCommand0, GameLoopBenchmark_SuccessFeedback, GameLoopBenchmark_FailFeedback, GameLoopBenchmark_GetInput0, NULL, 0U},
+    {"Command 1", GameLoopBenchmark_IssueCommand1, GameLoopBenchmark_SuccessFeedback, GameLoopBenchmark_FailFeedback, GameLoopBenchmark_GetInput1, NULL, 0U},
+    {"Command 2", GameLoopBenchmark_IssueCommand2, GameLoopBenchmark_SuccessFeedback, GameLoopBenchmark_FailFeedback, GameLoopBenchmark_GetInput2, NULL, 0U},
+};
+static BopIt_Command_t *GameLoopBenchmark_CommandList[GAMELOOPBENCHMARK_COMMAND_COUNT] = {&GameLoopBenchmark_Commands[0], &GameLoopBenchmark_Commands[1], &GameLoopBenchmark_Commands[2]};
+
+static BopIt_GameContext_t GameLoopBenchmark_GameContext = {
+    .Commands = GameLoopBenchmark_CommandList,
+    .CommandCount = GAMELOOPBENCHMARK_COMMAND_COUNT,
+    .Time = GameLoopBenchmark_Time,
+    .Selection = BOPIT_SELECTION_UNIFORM,
+    .Curve = BOPIT_CURVE_LINEAR,
+    .CommandWeights = NULL,
+    .Logger = GameLoopBenchmark_Logger,
+    .LogRing = NULL,
+    .TraceRing = NULL,
+    .Reactions = NULL,
+    .UserData = NULL,
+    .OnGameStart = NULL,
+    .OnGameEnd = NULL,
+};
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        GameLoopBenchmark_Games = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+
+    xTaskCreate(GameLoopBenchmark_PlayerTask, "PlayerTask", GAMELOOPBENCHMARK_TASK_STACK_DEPTH, NULL, GAMELOOPBENCHMARK_PLAYER_TASK_PRIORITY, &GameLoopBenchmark_PlayerTaskHandle);
+    xTaskCreate(GameLoopBenchmark_GameTask, "GameTask", GAMELOOPBENCHMARK_TASK_STACK_DEPTH, NULL, GAMELOOPBENCHMARK_GAME_TASK_PRIORITY, NULL);
+    vTaskStartScheduler();
+
+    return EXIT_FAILURE;
+}
+
+/**
+ * @brief Task running the games.  Prints results and exits the process when
+ * all games are over.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void GameLoopBenchmark_GameTask(void *arg)
+{
+    int status = EXIT_SUCCESS;
+
+    (void)arg;
+
+    Deadline_Init();
+    GameLoop_Init();
+    InputLatch_Init(&GameLoopBenchmark_InputLatch);
+
+    for (uint32_t game = 0U; game < GameLoopBenchmark_Games; game++)
+    {
+        BopIt_Init(&GameLoopBenchmark_GameContext);
+        GameLoop_Run(&GameLoopBenchmark_GameContext);
+    }
+
+    uint32_t wakeups = GameLoop_GetWakeupCount();
+    int64_t polls = GameLoopBenchmark_TotalWaitTime / (GAMELOOPBENCHMARK_POLL_PERIOD_MS * GAMELOOPBENCHMARK_US_PER_MS);
+
+    printf("Game loop benchmark: %" PRIu32 " games\n", GameLoopBenchmark_Games);
+    printf("  Commands issued:     %" PRIu32 "\n", GameLoopBenchmark_CommandsIssued);
+    printf("  Timeouts:            %" PRIu32 "\n", GameLoopBenchmark_Timeouts);
+    printf("  Timeout error:       min %" PRId64 " us, mean %.1f us, max %" PRId64 " us\n", GameLoopBenchmark_MinTimeoutError,
+           (GameLoopBenchmark_Timeouts > 0U) ? ((double)GameLoopBenchmark_TotalTimeoutError / GameLoopBenchmark_Timeouts) : 0.0, GameLoopBenchmark_MaxTimeoutError);
+    printf("  Wakeups:             %" PRIu32 " (%" PRId64 " with a %lld ms poll)\n", wakeups, polls, GAMELOOPBENCHMARK_POLL_PERIOD_MS);
+
+    if (GameLoopBenchmark_Timeouts == 0U || GameLoopBenchmark_MinTimeoutError < 0 || GameLoopBenchmark_MaxTimeoutError >= GAMELOOPBENCHMARK_MAX_TIMEOUT_ERROR_US)
+    {
+        printf("FAIL: timeouts not detected within %lld us of their deadline\n", GAMELOOPBENCHMARK_MAX_TIMEOUT_ERROR_US);
+        status = EXIT_FAILURE;
+    }
+    if (wakeups > (GameLoopBenchmark_CommandsIssued * GAMELOOPBENCHMARK_MAX_WAKEUPS_PER_COMMAND))
+    {
+        printf("FAIL: more than %u wakeups per issued command\n", GAMELOOPBENCHMARK_MAX_WAKEUPS_PER_COMMAND);
+        status = EXIT_FAILURE;
+    }
+
+    exit(status);
+}
+
+/**
+ * @brief Task simulating the player.  Presses the input for the command it is
+ * notified of after a fixed reaction time, like the GPIO event handler task.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void GameLoopBenchmark_PlayerTask(void *arg)
+{
+    uint32_t commandIndex;
+
+    (void)arg;
+
+    for (;;)
+    {
+        if (xTaskNotifyWait(0U, UINT32_MAX, &commandIndex, portMAX_DELAY) == pdTRUE && commandIndex < GAMELOOPBENCHMARK_COMMAND_COUNT)
+        {
+            vTaskDelay(pdMS_TO_TICKS(GAMELOOPBENCHMARK_REACTION_TIME_MS));
+            (void)InputLatch_SetAt(&GameLoopBenchmark_InputLatch, commandIndex, (InputLatch_Time_t)GameLoopBenchmark_Time(NULL));
+            GameLoop_Notify();
+        }
+    }
+}
+
+/**
+ * @brief Discard log messages so output does not affect timing.
+ *
+ * @param[in] gameContext Context for the game logging the message, unused
+ * @param[in] message     Message to log
+ ******************************************************************************/
+static void GameLoopBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message)
+{
+    (void)gameContext;
+    (void)message;
+}
+
+/**
+ * @brief Get the current time in microseconds, like the firmware.
+ *
+ * @param[in] gameContext Context for a BopIt game, unused
+ *
+ * @return Current time in microseconds
+ ******************************************************************************/
+static BopIt_TimeUs_t GameLoopBenchmark_Time(const BopIt_GameContext_t *const gameContext)
+{
+    (void)gameContext;
+
+    return (BopIt_TimeUs_t)esp_timer_get_time();
+}
+
+/**
+ * @brief Issue a command.  Notifies the player task to press the command's
+ * input until the player reaches the score at which it stops responding.
+ *
+ * @param[in] commandIndex Index of the command issued
+ ******************************************************************************/
+static void GameLoopBenchmark_IssueCommand(const uint32_t commandIndex)
+{
+    (void)InputLatch_TakeAll(&GameLoopBenchmark_InputLatch);
+
+    GameLoopBenchmark_CommandsIssued++;
+    if (GameLoopBenchmark_GameContext.Score < GAMELOOPBENCHMARK_SUCCESS_ROUNDS)
+    {
+        xTaskNotify(GameLoopBenchmark_PlayerTaskHandle, commandIndex, eSetValueWithOverwrite);
+    }
+}
+
+/**
+ * @brief Check if the simulated player pressed the input for a command.
+ *
+ * @param[in]  commandIndex Index of the command to check
+ * @param[out] inputTime    Time at which the input was pressed
+ *
+ * @return Whether the input for the command was pressed or not
+ ******************************************************************************/
+static bool GameLoopBenchmark_GetInput(const uint32_t commandIndex, BopIt_TimeUs_t *const inputTime)
+{
+    BopIt_TimeUs_t now = GameLoopBenchmark_Time(NULL);
+    InputLatch_Time_t latchedTime;
+    bool taken = InputLatch_TakeAt(&GameLoopBenchmark_InputLatch, commandIndex, &latchedTime);
+
+    /* The latch holds the low 32 bits of the time, the input was pressed less
+       than 2^32 microseconds ago */
+    if (taken)
+    {
+        *inputTime = now - (uint32_t)((uint32_t)now - latchedTime);
+    }
+
+    return taken;
+}
+
+/**
+ * @brief Record the time spent waiting for a successful input.
+ ******************************************************************************/
+static void GameLoopBenchmark_SuccessFeedback(void)
+{
+    GameLoopBenchmark_RecordWait();
+}
+
+/**
+ * @brief Record how far from its deadline a timeout was detected.  The player
+ * never presses a wrong input, so every fail is a timeout.
+ ******************************************************************************/
+static void GameLoopBenchmark_FailFeedback(void)
+{
+    int64_t deadline = (int64_t)GameLoopBenchmark_GameContext.WaitStart + (int64_t)GameLoopBenchmark_GameContext.WaitTime;
+    int64_t error = esp_timer_get_time() - deadline;
+
+    if (GameLoopBenchmark_Timeouts == 0U || error < GameLoopBenchmark_MinTimeoutError)
+    {
+        GameLoopBenchmark_MinTimeoutError = error;
+    }
+    if (GameLoopBenchmark_Timeouts == 0U || error > GameLoopBenchmark_MaxTimeoutError)
+    {
+        GameLoopBenchmark_MaxTimeoutError = error;
+    }
+    GameLoopBenchmark_TotalTimeoutError += error;
+    GameLoopBenchmark_Timeouts++;
+
+    GameLoopBenchmark_RecordWait();
+}
+
+/**
+ * @brief Accumulate the time spent waiting for the player on the current
+ * command.
+ ******************************************************************************/
+static void GameLoopBenchmark_RecordWait(void)
+{
+    GameLoopBenchmark_TotalWaitTime += esp_timer_get_time() - (int64_t)GameLoopBenchmark_GameContext.WaitStart;
+}
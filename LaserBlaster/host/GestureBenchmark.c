@@ -0,0 +1,598 @@
+/**
+ * @file GestureBenchmark.c
+ *
+ * @brief Benchmark of the Gesture pipeline behind BopIt's gesture commands.
+ * Synthesizes a labelled session of IMU samples at 1 kHz, a blaster held by a
+ * player with a slight tremor who twists it, pulls it, shakes it and makes
+ * other motions that are not gestures, a few seconds apart.  The session is
+ * encoded as the sensor's FIFO would be and fed through Gesture_UnpackFifo and
+ * Gesture_Process in bursts of random size, like the IMU task reads them.
+ * Checks every gesture is recognized once as the right gesture and nothing
+ * else is, then reports the cost per sample, the share of a CPU that
+ * processing 1 kHz takes and the heap allocations made.
+ *
+ * If a trace file of samples recorded from the sensor's FIFO at 1 kHz is
+ * given, it is also processed and every gesture recognized in it is printed.
+ *
+ * Exits with a failure status if a gesture is missed, recognized as another
+ * or recognized where there is none, or the pipeline allocates.
+ *
+ * Usage: GestureBenchmark [seconds] [seed] [trace file]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "Gesture.h"
+#include "MappedFile.h"
+#include "Prng.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define GESTUREBENCHMARK_DEFAULT_SECONDS 300U                              /* Length of the session if not specified */
+#define GESTUREBENCHMARK_DEFAULT_SEED 1U                                   /* Seed of the session if not specified */
+#define GESTUREBENCHMARK_SAMPLE_PERIOD_US 1000U                            /* Time between samples, 1 kHz */
+#define GESTUREBENCHMARK_ACCEL_LSB_PER_G 4096U                             /* Accelerometer counts per g at a range of 8 g */
+#define GESTUREBENCHMARK_GYRO_LSB_PER_KDPS 16400U                          /* Gyroscope counts per 1000 degrees per second at a range of 2000 degrees per second */
+#define GESTUREBENCHMARK_MAX_BURST 85U                                     /* Most samples read from the FIFO at once, as many as the IMU task reads */
+#define GESTUREBENCHMARK_MAX_DETECTIONS 4U                                 /* Most gestures reported by a burst */
+#define GESTUREBENCHMARK_SAMPLES_TIMED 20000000U                           /* Least number of samples processed while timing */
+#define GESTUREBENCHMARK_REST_MS 1000U                                     /* Time the blaster is held still at the start of the session */
+#define GESTUREBENCHMARK_MIN_GAP_MS 1500U                                  /* Shortest time between motions */
+#define GESTUREBENCHMARK_GAP_RANGE_MS 1500U                                /* Range of the random part of the time between motions */
+#define GESTUREBENCHMARK_LATENCY_MS 600U                                   /* Longest time from the start of a gesture to it being recognized */
+#define GESTUREBENCHMARK_MAX_MOTIONS 4096U                                 /* Most motions of a session */
+#define GESTUREBENCHMARK_TWIST_MS 250U                                     /* Time to twist the blaster */
+#define GESTUREBENCHMARK_TWIST_HOLD_MS 500U                                /* Time the blaster is held twisted */
+#define GESTUREBENCHMARK_TWIST_RETURN_MS 1000U                             /* Time to slowly turn the blaster back */
+#define GESTUREBENCHMARK_PULL_MS 150U                                      /* Time to jerk the blaster towards the player */
+#define GESTUREBENCHMARK_PULL_STOP_MS 200U                                 /* Time to stop the blaster after a pull */
+#define GESTUREBENCHMARK_SHAKE_MS 400U                                     /* Time the blaster is shaken */
+#define GESTUREBENCHMARK_OTHER_MS 400U                                     /* Time of a motion that is not a gesture */
+#define GESTUREBENCHMARK_ACCEL_NOISE_G 0.01f                               /* Amplitude of the accelerometer's noise */
+#define GESTUREBENCHMARK_GYRO_NOISE_DPS 0.5f                               /* Amplitude of the gyroscope's noise */
+#define GESTUREBENCHMARK_TREMOR_DPS 3.0f                                   /* Amplitude of the player's tremor */
+#define GESTUREBENCHMARK_TREMOR_HZ 8.0f                                    /* Frequency of the player's tremor */
+#define GESTUREBENCHMARK_PI 3.14159265f                                    /* Pi */
+#define GESTUREBENCHMARK_RADIANS_PER_DEGREE (GESTUREBENCHMARK_PI / 180.0f) /* Radians per degree */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Motion of the session */
+typedef struct
+{
+    Gesture_Gesture_t Gesture; /* Gesture made, GESTURE_NONE for a motion that is not a gesture */
+    uint32_t Start;            /* Index of the first sample of the motion */
+    uint32_t Length;           /* Number of samples of the motion */
+    float Magnitude;           /* Angle in degrees of a twist, peak acceleration in g of a pull or a shake */
+    float Direction;           /* 1 or -1 */
+    float Frequency;           /* Frequency in Hz of a shake */
+    uint32_t Recognized;       /* Number of times the gesture was recognized */
+} GestureBenchmark_Motion_t;
+
+/* Outcome of processing a session */
+typedef struct
+{
+    uint32_t Correct;        /* Number of gestures recognized as the right gesture */
+    uint32_t Wrong;          /* Number of gestures recognized as another */
+    uint32_t Missed;         /* Number of gestures not recognized */
+    uint32_t Repeated;       /* Number of gestures recognized again */
+    uint32_t FalsePositives; /* Number of gestures recognized where there was none */
+} GestureBenchmark_Outcome_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static uint32_t GestureBenchmark_Plan(const uint32_t sampleCount);
+static void GestureBenchmark_Synthesize(uint8_t *const fifo, const uint32_t sampleCount);
+static void GestureBenchmark_Encode(uint8_t *const bytes, const float *const accel, const float *const gyro);
+static int16_t GestureBenchmark_Saturate(const float value);
+static float GestureBenchmark_Noise(const float amplitude);
+static uint32_t GestureBenchmark_Run(const uint8_t *const fifo, const uint32_t sampleCount, Gesture_Pipeline_t *const pipeline, Gesture_Detection_t *const detections, const uint32_t maxDetections);
+static GestureBenchmark_Outcome_t GestureBenchmark_Check(const Gesture_Detection_t *const detections, const uint32_t detectionCount);
+static uint32_t GestureBenchmark_Replay(const char *const path);
+
+/* Globals
+ ******************************************************************************/
+
+static const Gesture_Config_t GestureBenchmark_Config = {
+    .SamplePeriodUs = GESTUREBENCHMARK_SAMPLE_PERIOD_US,
+    .AccelLsbPerG = GESTUREBENCHMARK_ACCEL_LSB_PER_G,
+    .GyroLsbPerKdps = GESTUREBENCHMARK_GYRO_LSB_PER_KDPS,
+};
+
+static Prng_t GestureBenchmark_Prng;                                                     /* Generator of the session and the burst sizes */
+static GestureBenchmark_Motion_t GestureBenchmark_Motions[GESTUREBENCHMARK_MAX_MOTIONS]; /* Motions of the session, in order of time */
+static uint32_t GestureBenchmark_MotionCount = 0U;                                       /* Number of motions of the session */
+static Gesture_Detection_t GestureBenchmark_Detections[GESTUREBENCHMARK_MAX_MOTIONS];    /* Gestures recognized in the session */
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t seconds = GESTUREBENCHMARK_DEFAULT_SECONDS;
+    uint32_t seed = GESTUREBENCHMARK_DEFAULT_SEED;
+    uint32_t sampleCount;
+    uint32_t detectionCount;
+    uint32_t repeats;
+    uint32_t errors = 0U;
+    uint8_t *fifo;
+    Gesture_Pipeline_t pipeline;
+    GestureBenchmark_Outcome_t outcome;
+    Benchmark_TimeNs_t startNs;
+    Benchmark_TimeNs_t elapsedNs;
+    Benchmark_Allocations_t allocations;
+    double nsPerSample;
+
+    if (argc > 1)
+    {
+        seconds = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        seed = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (seconds == 0U)
+    {
+        printf("Session must last at least a second\n");
+        return EXIT_FAILURE;
+    }
+
+    sampleCount = seconds * (1000000U / GESTUREBENCHMARK_SAMPLE_PERIOD_US);
+    fifo = malloc((size_t)sampleCount * GESTURE_FIFO_SAMPLE_SIZE);
+    if (fifo == NULL)
+    {
+        printf("Failed to allocate a session of %" PRIu32 " samples\n", sampleCount);
+        return EXIT_FAILURE;
+    }
+
+    printf("Gesture benchmark: %" PRIu32 " s at 1 kHz, seed %" PRIu32 ", %u bytes per pipeline\n", seconds, seed, (unsigned int)sizeof(Gesture_Pipeline_t));
+
+    Prng_Seed(&GestureBenchmark_Prng, seed, 0U);
+    GestureBenchmark_MotionCount = GestureBenchmark_Plan(sampleCount);
+    GestureBenchmark_Synthesize(fifo, sampleCount);
+
+    /* Recognition */
+    detectionCount = GestureBenchmark_Run(fifo, sampleCount, &pipeline, GestureBenchmark_Detections, GESTUREBENCHMARK_MAX_MOTIONS);
+    outcome = GestureBenchmark_Check(GestureBenchmark_Detections, detectionCount);
+    printf("  Motions:        %" PRIu32 ", recognized %" PRIu32 " twists, %" PRIu32 " pulls and %" PRIu32 " shakes in %" PRIu32 " blocks\n", GestureBenchmark_MotionCount,
+           pipeline.Stats.Gestures[GESTURE_TWIST], pipeline.Stats.Gestures[GESTURE_PULL], pipeline.Stats.Gestures[GESTURE_SHAKE], pipeline.Stats.Blocks);
+    printf("  Recognition:    %" PRIu32 " correct, %" PRIu32 " wrong, %" PRIu32 " missed, %" PRIu32 " repeated, %" PRIu32 " false positives\n", outcome.Correct, outcome.Wrong, outcome.Missed,
+           outcome.Repeated, outcome.FalsePositives);
+    if (outcome.Wrong > 0U || outcome.Missed > 0U || outcome.Repeated > 0U || outcome.FalsePositives > 0U || pipeline.Stats.Dropped > 0U)
+    {
+        printf("    FAILED\n");
+        errors++;
+    }
+
+    /* Throughput */
+    repeats = GESTUREBENCHMARK_SAMPLES_TIMED / sampleCount + 1U;
+    Benchmark_ResetAllocations();
+    startNs = Benchmark_GetTimeNs();
+    for (uint32_t repeat = 0U; repeat < repeats; repeat++)
+    {
+        (void)GestureBenchmark_Run(fifo, sampleCount, &pipeline, NULL, 0U);
+    }
+    elapsedNs = Benchmark_GetTimeNs() - startNs;
+    allocations = Benchmark_GetAllocations();
+
+    nsPerSample = (double)elapsedNs / ((double)repeats * sampleCount);
+    printf("  Throughput:     %.2f ns per sample over %" PRIu64 " samples, %.1f M samples/s, %.4f%% of a CPU at 1 kHz, %" PRIu64 " allocations\n", nsPerSample, (uint64_t)repeats * sampleCount,
+           1000.0 / nsPerSample, nsPerSample * 100.0 / (double)(GESTUREBENCHMARK_SAMPLE_PERIOD_US * 1000U), allocations.Allocations);
+    if (allocations.Allocations > 0U)
+    {
+        printf("    FAILED: pipeline allocated\n");
+        errors++;
+    }
+
+    free(fifo);
+
+    if (argc > 3)
+    {
+        errors += GestureBenchmark_Replay(argv[3]);
+    }
+
+    if (errors > 0U)
+    {
+        printf("  FAILED: %" PRIu32 " errors\n", errors);
+    }
+
+    return (errors > 0U) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * @brief Plan the motions of a session: a rest to start, then a gesture or a
+ * motion that is not a gesture every few seconds, each of random size and
+ * direction.
+ *
+ * @param[in] sampleCount Number of samples of the session
+ *
+ * @return Number of motions planned
+ ******************************************************************************/
+static uint32_t GestureBenchmark_Plan(const uint32_t sampleCount)
+{
+    uint32_t count = 0U;
+    uint32_t start = GESTUREBENCHMARK_REST_MS;
+    GestureBenchmark_Motion_t *motion;
+
+    while (count < GESTUREBENCHMARK_MAX_MOTIONS)
+    {
+        motion = &GestureBenchmark_Motions[count];
+        motion->Gesture = (Gesture_Gesture_t)Prng_Bounded(&GestureBenchmark_Prng, GESTURE_COUNT);
+        motion->Start = start;
+        motion->Direction = (Prng_Bounded(&GestureBenchmark_Prng, 2U) == 0U) ? 1.0f : -1.0f;
+        motion->Frequency = 0.0f;
+        motion->Recognized = 0U;
+
+        switch (motion->Gesture)
+        {
+        case GESTURE_TWIST:
+            motion->Length = GESTUREBENCHMARK_TWIST_MS + GESTUREBENCHMARK_TWIST_HOLD_MS + GESTUREBENCHMARK_TWIST_RETURN_MS;
+            motion->Magnitude = 60.0f + (float)Prng_Bounded(&GestureBenchmark_Prng, 61U);
+            break;
+        case GESTURE_PULL:
+            motion->Length = GESTUREBENCHMARK_PULL_MS + GESTUREBENCHMARK_PULL_STOP_MS;
+            motion->Magnitude = 1.2f + (float)Prng_Bounded(&GestureBenchmark_Prng, 9U) / 10.0f;
+            break;
+        case GESTURE_SHAKE:
+            motion->Length = GESTUREBENCHMARK_SHAKE_MS;
+            motion->Magnitude = 2.0f + (float)Prng_Bounded(&GestureBenchmark_Prng, 11U) / 10.0f;
+            motion->Frequency = 5.0f + (float)Prng_Bounded(&GestureBenchmark_Prng, 3U);
+            break;
+        default:
+            motion->Length = GESTUREBENCHMARK_OTHER_MS;
+            motion->Magnitude = 0.1f + (float)Prng_Bounded(&GestureBenchmark_Prng, 3U) / 10.0f;
+            break;
+        }
+
+        if (start + motion->Length >= sampleCount)
+        {
+            break;
+        }
+        start += motion->Length + GESTUREBENCHMARK_MIN_GAP_MS + Prng_Bounded(&GestureBenchmark_Prng, GESTUREBENCHMARK_GAP_RANGE_MS);
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Synthesize the samples of the planned session, as the sensor's FIFO
+ * holds them.  The blaster starts level with gravity along +Z, a twist rolls
+ * gravity towards Y, a pull jerks the blaster along -X and stops it, a shake
+ * swings it along Y, and other motions are small bumps and wobbles.
+ *
+ * @param[out] fifo        Samples, GESTURE_FIFO_SAMPLE_SIZE bytes each
+ * @param[in]  sampleCount Number of samples
+ ******************************************************************************/
+static void GestureBenchmark_Synthesize(uint8_t *const fifo, const uint32_t sampleCount)
+{
+    const float dt = (float)GESTUREBENCHMARK_SAMPLE_PERIOD_US / 1000000.0f;
+    const GestureBenchmark_Motion_t *motion = NULL;
+    uint32_t next = 0U;
+    float roll = 0.0f;
+    float accel[GESTURE_AXES];
+    float gyro[GESTURE_AXES];
+    float time;
+    float phase;
+    float peakRate;
+    float linear;
+
+    for (uint32_t sample = 0U; sample < sampleCount; sample++)
+    {
+        if (motion != NULL && sample >= motion->Start + motion->Length)
+        {
+            motion = NULL;
+        }
+        if (motion == NULL && next < GestureBenchmark_MotionCount && sample == GestureBenchmark_Motions[next].Start)
+        {
+            motion = &GestureBenchmark_Motions[next];
+            next++;
+        }
+
+        time = (float)sample * dt;
+        for (uint32_t axis = 0U; axis < GESTURE_AXES; axis++)
+        {
+            accel[axis] = 0.0f;
+            gyro[axis] = GESTUREBENCHMARK_TREMOR_DPS * sinf(2.0f * GESTUREBENCHMARK_PI * GESTUREBENCHMARK_TREMOR_HZ * time + (float)axis);
+        }
+
+        if (motion != NULL)
+        {
+            phase = (float)(sample - motion->Start);
+            switch (motion->Gesture)
+            {
+            case GESTURE_TWIST:
+                /* The integral of a half sine of peak rate r over T ms is 2rT / pi */
+                peakRate = motion->Magnitude * GESTUREBENCHMARK_PI * 1000.0f / (2.0f * (float)GESTUREBENCHMARK_TWIST_MS);
+                if (phase < (float)GESTUREBENCHMARK_TWIST_MS)
+                {
+                    gyro[0U] += motion->Direction * peakRate * sinf(GESTUREBENCHMARK_PI * phase / (float)GESTUREBENCHMARK_TWIST_MS);
+                }
+                else if (phase >= (float)(GESTUREBENCHMARK_TWIST_MS + GESTUREBENCHMARK_TWIST_HOLD_MS))
+                {
+                    gyro[0U] -= motion->Direction * motion->Magnitude * 1000.0f / (float)GESTUREBENCHMARK_TWIST_RETURN_MS;
+                }
+                break;
+            case GESTURE_PULL:
+                if (phase < (float)GESTUREBENCHMARK_PULL_MS)
+                {
+                    linear = -motion->Magnitude * sinf(GESTUREBENCHMARK_PI * phase / (float)GESTUREBENCHMARK_PULL_MS);
+                }
+                else
+                {
+                    linear = motion->Magnitude * ((float)GESTUREBENCHMARK_PULL_MS / (float)GESTUREBENCHMARK_PULL_STOP_MS) *
+                             sinf(GESTUREBENCHMARK_PI * (phase - (float)GESTUREBENCHMARK_PULL_MS) / (float)GESTUREBENCHMARK_PULL_STOP_MS);
+                }
+                accel[0U] += linear;
+                accel[2U] += 0.2f * linear;
+                gyro[1U] += 40.0f * linear;
+                break;
+            case GESTURE_SHAKE:
+                linear = motion->Magnitude * sinf(2.0f * GESTUREBENCHMARK_PI * motion->Frequency * phase / 1000.0f);
+                accel[1U] += motion->Direction * linear;
+                accel[0U] += 0.1f * linear;
+                gyro[2U] += 20.0f * linear;
+                break;
+            default:
+                /* A bump along every axis and a wobble about every axis that comes back to where it started */
+                linear = motion->Magnitude * sinf(GESTUREBENCHMARK_PI * phase / (float)GESTUREBENCHMARK_OTHER_MS);
+                for (uint32_t axis = 0U; axis < GESTURE_AXES; axis++)
+                {
+                    accel[axis] += motion->Direction * linear;
+                }
+                linear = 100.0f * motion->Magnitude * sinf(2.0f * GESTUREBENCHMARK_PI * phase / (float)GESTUREBENCHMARK_OTHER_MS);
+                for (uint32_t axis = 0U; axis < GESTURE_AXES; axis++)
+                {
+                    gyro[axis] += motion->Direction * linear;
+                }
+                break;
+            }
+        }
+
+        /* Gravity rolls about X with the blaster */
+        roll += gyro[0U] * dt * GESTUREBENCHMARK_RADIANS_PER_DEGREE;
+        accel[1U] += sinf(roll);
+        accel[2U] += cosf(roll);
+
+        for (uint32_t axis = 0U; axis < GESTURE_AXES; axis++)
+        {
+            accel[axis] += GestureBenchmark_Noise(GESTUREBENCHMARK_ACCEL_NOISE_G);
+            gyro[axis] += GestureBenchmark_Noise(GESTUREBENCHMARK_GYRO_NOISE_DPS);
+        }
+
+        GestureBenchmark_Encode(&fifo[(size_t)sample * GESTURE_FIFO_SAMPLE_SIZE], accel, gyro);
+    }
+}
+
+/**
+ * @brief Encode a sample as the sensor's FIFO holds it.
+ *
+ * @param[out] bytes Sample, GESTURE_FIFO_SAMPLE_SIZE bytes
+ * @param[in]  accel Acceleration on each axis in g
+ * @param[in]  gyro  Angular rate about each axis in degrees per second
+ ******************************************************************************/
+static void GestureBenchmark_Encode(uint8_t *const bytes, const float *const accel, const float *const gyro)
+{
+    int16_t value;
+
+    for (uint32_t axis = 0U; axis < GESTURE_AXES; axis++)
+    {
+        value = GestureBenchmark_Saturate(accel[axis] * (float)GESTUREBENCHMARK_ACCEL_LSB_PER_G);
+        bytes[2U * axis] = (uint8_t)((uint16_t)value >> 8U);
+        bytes[2U * axis + 1U] = (uint8_t)value;
+
+        value = GestureBenchmark_Saturate(gyro[axis] * (float)GESTUREBENCHMARK_GYRO_LSB_PER_KDPS / 1000.0f);
+        bytes[2U * (axis + GESTURE_AXES)] = (uint8_t)((uint16_t)value >> 8U);
+        bytes[2U * (axis + GESTURE_AXES) + 1U] = (uint8_t)value;
+    }
+}
+
+/**
+ * @brief Convert a value to a sensor count, saturating at the sensor's range.
+ *
+ * @param[in] value Value in counts
+ *
+ * @return Nearest count the sensor can report
+ ******************************************************************************/
+static int16_t GestureBenchmark_Saturate(const float value)
+{
+    float rounded = roundf(value);
+
+    if (rounded > (float)INT16_MAX)
+    {
+        rounded = (float)INT16_MAX;
+    }
+    else if (rounded < (float)INT16_MIN)
+    {
+        rounded = (float)INT16_MIN;
+    }
+
+    return (int16_t)rounded;
+}
+
+/**
+ * @brief Draw noise, roughly normal from the sum of uniform draws.
+ *
+ * @param[in] amplitude Standard deviation of the noise
+ *
+ * @return Noise
+ ******************************************************************************/
+static float GestureBenchmark_Noise(const float amplitude)
+{
+    float sum = 0.0f;
+
+    /* The sum of 12 uniform draws on [0, 1) less 6 has a standard deviation of 1 */
+    for (uint32_t draw = 0U; draw < 12U; draw++)
+    {
+        sum += (float)Prng_Next(&GestureBenchmark_Prng) / 4294967296.0f;
+    }
+
+    return amplitude * (sum - 6.0f);
+}
+
+/**
+ * @brief Process samples from the sensor's FIFO in bursts of random size,
+ * like the IMU task reads them.
+ *
+ * @param[in]  fifo          Samples, GESTURE_FIFO_SAMPLE_SIZE bytes each, one
+ *                           every GESTUREBENCHMARK_SAMPLE_PERIOD_US
+ * @param[in]  sampleCount   Number of samples
+ * @param[out] pipeline      Pipeline the samples are processed with
+ * @param[out] detections    Gestures recognized, NULL to only count them
+ * @param[in]  maxDetections Number of gestures that fit in detections
+ *
+ * @return Number of gestures written to detections
+ ******************************************************************************/
+static uint32_t GestureBenchmark_Run(const uint8_t *const fifo, const uint32_t sampleCount, Gesture_Pipeline_t *const pipeline, Gesture_Detection_t *const detections, const uint32_t maxDetections)
+{
+    Gesture_Sample_t samples[GESTUREBENCHMARK_MAX_BURST];
+    Gesture_Detection_t burstDetections[GESTUREBENCHMARK_MAX_DETECTIONS];
+    uint32_t detectionCount = 0U;
+    uint32_t processed = 0U;
+    uint32_t burst;
+    uint32_t count;
+
+    (void)Gesture_Init(pipeline, &GestureBenchmark_Config, NULL);
+
+    while (processed < sampleCount)
+    {
+        burst = 1U + Prng_Bounded(&GestureBenchmark_Prng, GESTUREBENCHMARK_MAX_BURST);
+        if (burst > sampleCount - processed)
+        {
+            burst = sampleCount - processed;
+        }
+
+        count = Gesture_UnpackFifo(&fifo[(size_t)processed * GESTURE_FIFO_SAMPLE_SIZE], burst * GESTURE_FIFO_SAMPLE_SIZE, samples);
+        processed += count;
+        count = Gesture_Process(pipeline, samples, count, (Gesture_TimeUs_t)(processed - 1U) * GESTUREBENCHMARK_SAMPLE_PERIOD_US, burstDetections, GESTUREBENCHMARK_MAX_DETECTIONS);
+
+        for (uint32_t index = 0U; detections != NULL && index < count && detectionCount < maxDetections; index++)
+        {
+            detections[detectionCount] = burstDetections[index];
+            detectionCount++;
+        }
+    }
+
+    return detectionCount;
+}
+
+/**
+ * @brief Match gestures recognized to the motions of the session.  A gesture
+ * recognized belongs to the motion it was recognized during or shortly after.
+ *
+ * @param[in] detections     Gestures recognized, in order of time
+ * @param[in] detectionCount Number of gestures recognized
+ *
+ * @return How many gestures were recognized rightly and wrongly
+ ******************************************************************************/
+static GestureBenchmark_Outcome_t GestureBenchmark_Check(const Gesture_Detection_t *const detections, const uint32_t detectionCount)
+{
+    GestureBenchmark_Outcome_t outcome = {0};
+    GestureBenchmark_Motion_t *motion;
+    uint32_t next = 0U;
+
+    for (uint32_t index = 0U; index < detectionCount; index++)
+    {
+        /* The motion a gesture belongs to is the last one started before it */
+        while (next < GestureBenchmark_MotionCount && detections[index].Time >= (uint64_t)GestureBenchmark_Motions[next].Start * 1000U)
+        {
+            next++;
+        }
+        motion = (next > 0U) ? &GestureBenchmark_Motions[next - 1U] : NULL;
+
+        if (motion == NULL || motion->Gesture == GESTURE_NONE || detections[index].Time >= (uint64_t)(motion->Start + GESTUREBENCHMARK_LATENCY_MS) * 1000U)
+        {
+            printf("    False positive: %s at %.3f s\n", Gesture_GetName(detections[index].Gesture), (double)detections[index].Time / 1000000.0);
+            outcome.FalsePositives++;
+        }
+        else if (motion->Recognized > 0U)
+        {
+            printf("    Repeated: %s at %.3f s\n", Gesture_GetName(detections[index].Gesture), (double)detections[index].Time / 1000000.0);
+            outcome.Repeated++;
+        }
+        else if (detections[index].Gesture != motion->Gesture)
+        {
+            printf("    Wrong: %s at %.3f s was a %s\n", Gesture_GetName(detections[index].Gesture), (double)detections[index].Time / 1000000.0, Gesture_GetName(motion->Gesture));
+            motion->Recognized++;
+            outcome.Wrong++;
+        }
+        else
+        {
+            motion->Recognized++;
+            outcome.Correct++;
+        }
+    }
+
+    for (uint32_t index = 0U; index < GestureBenchmark_MotionCount; index++)
+    {
+        if (GestureBenchmark_Motions[index].Gesture != GESTURE_NONE && GestureBenchmark_Motions[index].Recognized == 0U)
+        {
+            printf("    Missed: %s at %.3f s\n", Gesture_GetName(GestureBenchmark_Motions[index].Gesture), (double)GestureBenchmark_Motions[index].Start / 1000.0);
+            outcome.Missed++;
+        }
+    }
+
+    return outcome;
+}
+
+/**
+ * @brief Process samples recorded from the sensor's FIFO at 1 kHz and print
+ * every gesture recognized.
+ *
+ * @param[in] path Path of the recording
+ *
+ * @return 1 if the recording could not be read or the pipeline allocated, 0
+ * otherwise
+ ******************************************************************************/
+static uint32_t GestureBenchmark_Replay(const char *const path)
+{
+    MappedFile_t file;
+    Gesture_Pipeline_t pipeline;
+    Benchmark_TimeNs_t startNs;
+    Benchmark_TimeNs_t elapsedNs;
+    Benchmark_Allocations_t allocations;
+    uint32_t sampleCount;
+    uint32_t detectionCount;
+    uint32_t errors = 0U;
+
+    if (!MappedFile_Open(&file, path))
+    {
+        printf("  Failed to open trace file %s\n", path);
+        errors++;
+    }
+    else
+    {
+        sampleCount = (uint32_t)(file.Size / GESTURE_FIFO_SAMPLE_SIZE);
+
+        Benchmark_ResetAllocations();
+        startNs = Benchmark_GetTimeNs();
+        detectionCount = GestureBenchmark_Run(file.Data, sampleCount, &pipeline, GestureBenchmark_Detections, GESTUREBENCHMARK_MAX_MOTIONS);
+        elapsedNs = Benchmark_GetTimeNs() - startNs;
+        allocations = Benchmark_GetAllocations();
+
+        printf("  Trace %s: %" PRIu32 " samples, %" PRIu32 " gestures in %.3f ms, %" PRIu64 " allocations\n", path, sampleCount, detectionCount, (double)elapsedNs / 1000000.0, allocations.Allocations);
+        for (uint32_t index = 0U; index < detectionCount; index++)
+        {
+            printf("    %-5s at %10.3f s, score %" PRId32 "\n", Gesture_GetName(GestureBenchmark_Detections[index].Gesture), (double)GestureBenchmark_Detections[index].Time / 1000000.0,
+                   GestureBenchmark_Detections[index].Score);
+        }
+        if (allocations.Allocations > 0U)
+        {
+            printf("    FAILED: pipeline allocated\n");
+            errors++;
+        }
+
+        MappedFile_Close(&file);
+    }
+
+    return errors;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file InputLatchBenchmark.c
+ *
+ * @brief Stress benchmark for the input latch.  Producer threads standing in
+ * for GPIO ISRs press their own input as fast as possible while a consumer
+ * thread takes inputs the same way the BopIt commands do, one input at a time
+ * with an occasional reset of all inputs.  Every press that was newly latched
+ * must be taken exactly once; presses made while the same input was still
+ * latched are coalesced, like repeated presses between two polls.
+ *
+ * Exits with a failure status if any latched press is lost.
+ *
+ * Usage: InputLatchBenchmark [presses per producer] [producers]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "InputLatch.h"
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define INPUTLATCHBENCHMARK_DEFAULT_PRESSES 200000U /* Presses made by each producer if not specified */
+#define INPUTLATCHBENCHMARK_DEFAULT_PRODUCERS 3U    /* Number of producers if not specified, one per firmware button */
+#define INPUTLATCHBENCHMARK_MAX_PRODUCERS 32U       /* One producer per input latch bit */
+#define INPUTLATCHBENCHMARK_RESET_PERIOD 64U        /* Consumer resets all inputs once every this many polls */
+#define INPUTLATCHBENCHMARK_NS_PER_S 1000000000.0   /* Nanoseconds per second */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Counters for a single producer */
+typedef struct
+{
+    uint64_t Latched;   /* Presses that were newly latched */
+    uint64_t Coalesced; /* Presses made while the input was still latched */
+    uint64_t Taken;     /* Presses taken by the consumer */
+} InputLatchBenchmark_Counters_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void *InputLatchBenchmark_Producer(void *arg);
+static void *InputLatchBenchmark_Consumer(void *arg);
+static void InputLatchBenchmark_CountTaken(const InputLatch_Inputs_t inputs);
+
+/* Globals
+ ******************************************************************************/
+
+static InputLatch_t InputLatchBenchmark_Latch;                                                         /* Latch under test */
+static InputLatchBenchmark_Counters_t InputLatchBenchmark_Counters[INPUTLATCHBENCHMARK_MAX_PRODUCERS]; /* Counters for each producer */
+static uint32_t InputLatchBenchmark_Presses = INPUTLATCHBENCHMARK_DEFAULT_PRESSES;                     /* Presses made by each producer */
+static uint32_t InputLatchBenchmark_Producers = INPUTLATCHBENCHMARK_DEFAULT_PRODUCERS;                 /* Number of producers */
+static atomic_uint InputLatchBenchmark_ProducersDone;                                                  /* Number of producers that finished pressing */
+static pthread_barrier_t InputLatchBenchmark_StartBarrier;                                             /* Starts all threads at the same time */
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    pthread_t producers[INPUTLATCHBENCHMARK_MAX_PRODUCERS];
+    pthread_t consumer;
+    uint64_t latched = 0U;
+    uint64_t coalesced = 0U;
+    uint64_t taken = 0U;
+    int status = EXIT_SUCCESS;
+
+    if (argc > 1)
+    {
+        InputLatchBenchmark_Presses = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        InputLatchBenchmark_Producers = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (InputLatchBenchmark_Producers == 0U || InputLatchBenchmark_Producers > INPUTLATCHBENCHMARK_MAX_PRODUCERS)
+    {
+        InputLatchBenchmark_Producers = INPUTLATCHBENCHMARK_DEFAULT_PRODUCERS;
+    }
+
+    InputLatch_Init(&InputLatchBenchmark_Latch);
+    atomic_init(&InputLatchBenchmark_ProducersDone, 0U);
+    pthread_barrier_init(&InputLatchBenchmark_StartBarrier, NULL, InputLatchBenchmark_Producers + 2U);
+
+    pthread_create(&consumer, NULL, InputLatchBenchmark_Consumer, NULL);
+    for (uintptr_t producer = 0U; producer < InputLatchBenchmark_Producers; producer++)
+    {
+        pthread_create(&producers[producer], NULL, InputLatchBenchmark_Producer, (void *)producer);
+    }
+
+    pthread_barrier_wait(&InputLatchBenchmark_StartBarrier);
+    Benchmark_TimeNs_t start = Benchmark_GetTimeNs();
+
+    for (uint32_t producer = 0U; producer < InputLatchBenchmark_Producers; producer++)
+    {
+        pthread_join(producers[producer], NULL);
+    }
+    pthread_join(consumer, NULL);
+
+    Benchmark_TimeNs_t time = Benchmark_GetTimeNs() - start;
+
+    printf("Input latch benchmark: %" PRIu32 " producers, %" PRIu32 " presses each\n", InputLatchBenchmark_Producers, InputLatchBenchmark_Presses);
+    for (uint32_t producer = 0U; producer < InputLatchBenchmark_Producers; producer++)
+    {
+        InputLatchBenchmark_Counters_t *counters = &InputLatchBenchmark_Counters[producer];
+
+        printf("  Input %2" PRIu32 ": latched %10" PRIu64 ", coalesced %10" PRIu64 ", taken %10" PRIu64 ", lost %" PRId64 "\n", producer, counters->Latched, counters->Coalesced, counters->Taken,
+               (int64_t)(counters->Latched - counters->Taken));
+        latched += counters->Latched;
+        coalesced += counters->Coalesced;
+        taken += counters->Taken;
+        if (counters->Latched != counters->Taken)
+        {
+            status = EXIT_FAILURE;
+        }
+    }
+    printf("  Total:    latched %10" PRIu64 ", coalesced %10" PRIu64 ", taken %10" PRIu64 "\n", latched, coalesced, taken);
+    printf("  Presses/sec: %.0f\n", (time > 0U) ? ((double)(latched + coalesced) * INPUTLATCHBENCHMARK_NS_PER_S / (double)time) : 0.0);
+    if (status != EXIT_SUCCESS)
+    {
+        printf("FAIL: latched presses were lost\n");
+    }
+
+    pthread_barrier_destroy(&InputLatchBenchmark_StartBarrier);
+
+    return status;
+}
+
+/**
+ * @brief Producer thread.  Presses a single input repeatedly, like a GPIO ISR
+ * for one button.
+ *
+ * @param[in] arg Index of the producer, which is also its input bit
+ *
+ * @return NULL
+ ******************************************************************************/
+static void *InputLatchBenchmark_Producer(void *arg)
+{
+    uint32_t producer = (uint32_t)(uintptr_t)arg;
+    InputLatch_Inputs_t input = (InputLatch_Inputs_t)1U << producer;
+    uint64_t latched = 0U;
+    uint64_t coalesced = 0U;
+
+    pthread_barrier_wait(&InputLatchBenchmark_StartBarrier);
+
+    for (uint32_t press = 0U; press < InputLatchBenchmark_Presses; press++)
+    {
+        if (InputLatch_Set(&InputLatchBenchmark_Latch, input))
+        {
+            latched++;
+        }
+        else
+        {
+            coalesced++;
+        }
+
+        /* Let other threads run between presses so they interleave even on a single core */
+        sched_yield();
+    }
+
+    InputLatchBenchmark_Counters[producer].Latched = latched;
+    InputLatchBenchmark_Counters[producer].Coalesced = coalesced;
+    atomic_fetch_add(&InputLatchBenchmark_ProducersDone, 1U);
+
+    return NULL;
+}
+
+/**
+ * @brief Consumer thread.  Polls each input in turn like BopIt_HandleWait
+ * calling each command's GetInput, and periodically resets all inputs like
+ * issuing a new command.  Drains the latch once all producers are done.
+ *
+ * @param[in] arg Unused
+ *
+ * @return NULL
+ ******************************************************************************/
+static void *InputLatchBenchmark_Consumer(void *arg)
+{
+    uint64_t poll = 0U;
+
+    (void)arg;
+
+    pthread_barrier_wait(&InputLatchBenchmark_StartBarrier);
+
+    while (atomic_load(&InputLatchBenchmark_ProducersDone) < InputLatchBenchmark_Producers)
+    {
+        if ((poll % INPUTLATCHBENCHMARK_RESET_PERIOD) == 0U)
+        {
+            InputLatchBenchmark_CountTaken(InputLatch_TakeAll(&InputLatchBenchmark_Latch));
+        }
+        else
+        {
+            for (uint32_t producer = 0U; producer < InputLatchBenchmark_Producers; producer++)
+            {
+                InputLatchBenchmark_CountTaken(InputLatch_Take(&InputLatchBenchmark_Latch, (InputLatch_Inputs_t)1U << producer));
+            }
+        }
+
+        poll++;
+        sched_yield();
+    }
+
+    InputLatchBenchmark_CountTaken(InputLatch_TakeAll(&InputLatchBenchmark_Latch));
+
+    return NULL;
+}
+
+/**
+ * @brief Count inputs taken by the consumer.
+ *
+ * @param[in] inputs Inputs taken from the latch
+ ******************************************************************************/
+static void InputLatchBenchmark_CountTaken(const InputLatch_Inputs_t inputs)
+{
+    for (uint32_t producer = 0U; producer < InputLatchBenchmark_Producers; producer++)
+    {
+        if ((inputs & ((InputLatch_Inputs_t)1U << producer)) != 0U)
+        {
+            InputLatchBenchmark_Counters[producer].Taken++;
+        }
+    }
+}
@@ -0,0 +1,435 @@
+/**
+ * @file InputPathBenchmark.c
+ *
+ * @brief End-to-end latency benchmark for the button input path.  Runs the
+ * firmware's Gpio, EventHandlers, BopItCommands, InputStats, GameLoop and
+ * Deadline modules with the BopIt engine on the FreeRTOS POSIX port, with the
+ * pins simulated by GpioDriver.  A simulated player presses the button of
+ * every command issued, driving the button's pin with a burst of contact
+ * bounces on each press and release from a task at the highest priority,
+ * which stands in for the GPIO interrupt.  Each press then takes the same path
+ * as on the blaster: the button ISR debounces it and publishes it on the event
+ * bus, waking the game task, and the game takes it straight from its ring
+ * and completes the command.
+ *
+ * The player watches the game through the commands and results it posts to
+ * the other blasters, so the latency of a press is measured from its first
+ * edge to the game posting the command's result, the moment BopIt reaches its
+ * success state.  Feedback, audio, IR and the link are not part of the path
+ * and are replaced by stubs.  Edges, bounces and reaction times are drawn
+ * from a seeded generator, so runs with the same seed can be compared.
+ *
+ * Exits with a failure status if any press does not complete its command or
+ * the 99th percentile latency is 1 ms or more.
+ *
+ * Usage: InputPathBenchmark [games] [seed]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Audio.h"
+#include "BopIt.h"
+#include "BopItCommands.h"
+#include "Deadline.h"
+#include "esp_timer.h"
+#include "EventBus.h"
+#include "EventHandlers.h"
+#include "Feedback.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "GameLoop.h"
+#include "Gpio.h"
+#include "GpioDriver.h"
+#include "InputStats.h"
+#include "Link.h"
+#include "Prng.h"
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define INPUTPATHBENCHMARK_DEFAULT_GAMES 2U                                    /* Number of games played if not specified */
+#define INPUTPATHBENCHMARK_DEFAULT_SEED 1U                                     /* Seed of the player if not specified */
+#define INPUTPATHBENCHMARK_MAX_PRESSES 100000U                                 /* Most presses latencies are kept for */
+#define INPUTPATHBENCHMARK_MIN_REACTION_MS 2U                                  /* Shortest time from a command to the press */
+#define INPUTPATHBENCHMARK_REACTION_RANGE_MS 18U                               /* Range of reaction times above the shortest */
+#define INPUTPATHBENCHMARK_MIN_HOLD_MS 12U                                     /* Shortest time a button is held, longer than the press lockout */
+#define INPUTPATHBENCHMARK_HOLD_RANGE_MS 18U                                   /* Range of hold times above the shortest */
+#define INPUTPATHBENCHMARK_MAX_BOUNCES 4U                                      /* Most bounces after an edge */
+#define INPUTPATHBENCHMARK_MIN_BOUNCE_US 20U                                   /* Shortest time between the edges of a bounce */
+#define INPUTPATHBENCHMARK_BOUNCE_RANGE_US 480U                                /* Range of times between the edges of a bounce above the shortest */
+#define INPUTPATHBENCHMARK_MAX_P99_US 1000U                                    /* The 99th percentile latency must be below this many microseconds */
+#define INPUTPATHBENCHMARK_PERCENT 100U                                        /* Scale of a percentage */
+#define INPUTPATHBENCHMARK_P50 50U                                             /* Percentile of the median */
+#define INPUTPATHBENCHMARK_P99 99U                                             /* Percentile of the tail */
+#define INPUTPATHBENCHMARK_TASK_STACK_DEPTH (configMINIMAL_STACK_SIZE * 4U)    /* Stack depth for benchmark tasks */
+#define INPUTPATHBENCHMARK_GAME_TASK_PRIORITY (tskIDLE_PRIORITY + 3U)          /* Priority for the game task, matches the firmware's task layout */
+#define INPUTPATHBENCHMARK_INTERRUPT_TASK_PRIORITY (configMAX_PRIORITIES - 1U) /* Priority for the task standing in for the GPIO interrupt */
+#define INPUTPATHBENCHMARK_BUTTON_PRESSED_LEVEL 0U                             /* Level of a pressed button, buttons pull the input low */
+#define INPUTPATHBENCHMARK_BUTTON_RELEASED_LEVEL 1U                            /* Level of a released button */
+
+/* Globals
+ ******************************************************************************/
+
+static uint32_t InputPathBenchmark_Games = INPUTPATHBENCHMARK_DEFAULT_GAMES; /* Number of games to play */
+static uint64_t InputPathBenchmark_Seed = INPUTPATHBENCHMARK_DEFAULT_SEED;   /* Seed of the player */
+static TaskHandle_t InputPathBenchmark_InterruptTaskHandle = NULL;           /* Handle of the task pressing buttons */
+static EventBus_t InputPathBenchmark_EventBus;                               /* Bus button presses are published on */
+static Prng_t InputPathBenchmark_Prng;                                       /* Generator of reaction times, hold times and bounces, only used by the interrupt task */
+
+static _Atomic int64_t InputPathBenchmark_PressTimeUs = 0; /* Time of the first edge of the last press */
+static uint32_t InputPathBenchmark_Presses = 0U;           /* Number of presses, only modified by the interrupt task */
+static uint32_t InputPathBenchmark_Bounces = 0U;           /* Number of bounces added to presses and releases, only modified by the interrupt task */
+static uint32_t InputPathBenchmark_Commands = 0U;          /* Number of commands issued, only modified by the game task */
+static uint32_t InputPathBenchmark_Successes = 0U;         /* Number of commands completed, only modified by the game task */
+static uint32_t InputPathBenchmark_Fails = 0U;             /* Number of commands failed, only modified by the game task */
+
+static uint32_t InputPathBenchmark_Latencies[INPUTPATHBENCHMARK_MAX_PRESSES]; /* Microseconds from the first edge of each press to the command's result, only modified by the game task */
+
+/* Buttons are the first commands, the rest are not driven by the GPIO ISR */
+static BopIt_GameContext_t InputPathBenchmark_GameContext = {
+    .Commands = BopItCommands_Commands,
+    .CommandCount = BOPITCOMMANDS_INPUT_HIT,
+    .GetInputs = BopItCommands_GetInputs,
+    .GetEvent = NULL,
+    .Time = NULL,
+    .Selection = BOPIT_SELECTION_UNIFORM,
+    .Curve = BOPIT_CURVE_LINEAR,
+    .CommandWeights = NULL,
+    .Logger = NULL,
+    .LogRing = NULL,
+    .TraceRing = NULL,
+    .Reactions = NULL,
+    .UserData = NULL,
+    .OnGameStart = NULL,
+    .OnGameEnd = NULL,
+};
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void InputPathBenchmark_GameTask(void *arg);
+static void InputPathBenchmark_InterruptTask(void *arg);
+static void InputPathBenchmark_DriveEdge(const gpio_num_t gpioNum, const uint32_t level);
+static void InputPathBenchmark_Spin(const uint32_t us);
+static void InputPathBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message);
+static BopIt_TimeUs_t InputPathBenchmark_Time(const BopIt_GameContext_t *const gameContext);
+static int InputPathBenchmark_CompareLatencies(const void *a, const void *b);
+static uint32_t InputPathBenchmark_GetPercentile(const uint32_t *const sorted, const uint32_t count, const uint32_t percentile);
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        InputPathBenchmark_Games = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        InputPathBenchmark_Seed = strtoull(argv[2], NULL, 0);
+    }
+
+    InputPathBenchmark_GameContext.Time = InputPathBenchmark_Time;
+    InputPathBenchmark_GameContext.Logger = InputPathBenchmark_Logger;
+    Prng_Seed(&InputPathBenchmark_Prng, InputPathBenchmark_Seed, 0U);
+
+    xTaskCreate(InputPathBenchmark_InterruptTask, "InterruptTask", INPUTPATHBENCHMARK_TASK_STACK_DEPTH, NULL, INPUTPATHBENCHMARK_INTERRUPT_TASK_PRIORITY, &InputPathBenchmark_InterruptTaskHandle);
+    xTaskCreate(InputPathBenchmark_GameTask, "GameTask", INPUTPATHBENCHMARK_TASK_STACK_DEPTH, NULL, INPUTPATHBENCHMARK_GAME_TASK_PRIORITY, NULL);
+    vTaskStartScheduler();
+
+    return EXIT_FAILURE;
+}
+
+/**
+ * @brief Task running the games, initialized like the firmware's game task.
+ * Prints results and exits the process when all games are over.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void InputPathBenchmark_GameTask(void *arg)
+{
+    int status = EXIT_SUCCESS;
+    InputStats_t inputStats;
+    GpioDriver_Stats_t gpioStats;
+    Debounce_Stats_t debounceStats = {0};
+    Debounce_Stats_t buttonStats;
+    uint32_t measured;
+    uint32_t dropped;
+    uint32_t p99 = 0U;
+
+    (void)arg;
+
+    Deadline_Init();
+    InputStats_Init();
+    EventBus_Init(&InputPathBenchmark_EventBus);
+    (void)EventHandlers_Subscribe(&InputPathBenchmark_EventBus);
+    Gpio_Init(&InputPathBenchmark_EventBus);
+    GameLoop_Init();
+    BopItCommands_Init(&InputPathBenchmark_GameContext);
+    BopIt_Seed(&InputPathBenchmark_GameContext, InputPathBenchmark_Seed);
+
+    for (uint32_t game = 0U; game < InputPathBenchmark_Games; game++)
+    {
+        BopIt_Init(&InputPathBenchmark_GameContext);
+        GameLoop_Run(&InputPathBenchmark_GameContext);
+    }
+
+    InputStats_Get(&inputStats);
+    GpioDriver_GetStats(&gpioStats);
+    for (uint32_t commandIndex = 0U; commandIndex < InputPathBenchmark_GameContext.CommandCount; commandIndex++)
+    {
+        if (Gpio_GetDebounceStats(BopItCommands_InputToGpio((BopItCommands_Input_t)commandIndex), &buttonStats))
+        {
+            debounceStats.Presses += buttonStats.Presses;
+            debounceStats.Releases += buttonStats.Releases;
+            debounceStats.Bounces += buttonStats.Bounces;
+        }
+    }
+
+    measured = (InputPathBenchmark_Successes < INPUTPATHBENCHMARK_MAX_PRESSES) ? InputPathBenchmark_Successes : INPUTPATHBENCHMARK_MAX_PRESSES;
+    dropped = (InputPathBenchmark_Presses > InputPathBenchmark_Successes) ? (InputPathBenchmark_Presses - InputPathBenchmark_Successes) : 0U;
+    qsort(InputPathBenchmark_Latencies, measured, sizeof(uint32_t), InputPathBenchmark_CompareLatencies);
+
+    printf("Input path benchmark: %" PRIu32 " games, seed %" PRIu64 "\n", InputPathBenchmark_Games, InputPathBenchmark_Seed);
+    printf("  Commands issued:     %" PRIu32 "\n", InputPathBenchmark_Commands);
+    printf("  Presses:             %" PRIu32 " (%" PRIu32 " bounces, %" PRIu32 " edges, %" PRIu32 " interrupts)\n", InputPathBenchmark_Presses, InputPathBenchmark_Bounces, gpioStats.Edges, gpioStats.Interrupts);
+    printf("  Debounced:           %" PRIu32 " presses, %" PRIu32 " releases, %" PRIu32 " bounces rejected\n", debounceStats.Presses, debounceStats.Releases, debounceStats.Bounces);
+    printf("  Latched:             %" PRIu32 " (coalesced %" PRIu32 ", notify failures %" PRIu32 ", taken %" PRIu32 ")\n", inputStats.Latched, inputStats.Coalesced, inputStats.NotifyFailures, inputStats.Taken);
+    printf("  Events dropped:      %" PRIu32 "\n", EventHandlers_GetDrops());
+    printf("  Completed:           %" PRIu32 " (failed %" PRIu32 ", dropped %" PRIu32 ")\n", InputPathBenchmark_Successes, InputPathBenchmark_Fails, dropped);
+    if (measured > 0U)
+    {
+        p99 = InputPathBenchmark_GetPercentile(InputPathBenchmark_Latencies, measured, INPUTPATHBENCHMARK_P99);
+        printf("  Edge to success:     p50 %" PRIu32 " us, p99 %" PRIu32 " us, max %" PRIu32 " us\n", InputPathBenchmark_GetPercentile(InputPathBenchmark_Latencies, measured, INPUTPATHBENCHMARK_P50), p99,
+               InputPathBenchmark_Latencies[measured - 1U]);
+    }
+    InputStats_Dump();
+
+    if (InputPathBenchmark_Presses == 0U || dropped > 0U || InputPathBenchmark_Fails > 0U)
+    {
+        printf("FAIL: %" PRIu32 " presses did not complete their command\n", dropped);
+        status = EXIT_FAILURE;
+    }
+    if (p99 >= INPUTPATHBENCHMARK_MAX_P99_US)
+    {
+        printf("FAIL: 99th percentile latency not below %u us\n", INPUTPATHBENCHMARK_MAX_P99_US);
+        status = EXIT_FAILURE;
+    }
+
+    exit(status);
+}
+
+/**
+ * @brief Task standing in for the GPIO interrupt and the player.  Waits for a
+ * command, then after a reaction time presses its button with a burst of
+ * bounces, holds it and releases it with another burst.  At the highest
+ * priority, the ISR runs as soon as each edge is driven.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void InputPathBenchmark_InterruptTask(void *arg)
+{
+    uint32_t commandIndex;
+    gpio_num_t gpioNum;
+
+    (void)arg;
+
+    for (;;)
+    {
+        if (xTaskNotifyWait(0U, UINT32_MAX, &commandIndex, portMAX_DELAY) == pdTRUE && commandIndex < InputPathBenchmark_GameContext.CommandCount)
+        {
+            gpioNum = (gpio_num_t)BopItCommands_InputToGpio((BopItCommands_Input_t)commandIndex);
+
+            vTaskDelay(pdMS_TO_TICKS(INPUTPATHBENCHMARK_MIN_REACTION_MS + Prng_Bounded(&InputPathBenchmark_Prng, INPUTPATHBENCHMARK_REACTION_RANGE_MS)));
+
+            atomic_store_explicit(&InputPathBenchmark_PressTimeUs, esp_timer_get_time(), memory_order_relaxed);
+            InputPathBenchmark_Presses++;
+            InputPathBenchmark_DriveEdge(gpioNum, INPUTPATHBENCHMARK_BUTTON_PRESSED_LEVEL);
+
+            vTaskDelay(pdMS_TO_TICKS(INPUTPATHBENCHMARK_MIN_HOLD_MS + Prng_Bounded(&InputPathBenchmark_Prng, INPUTPATHBENCHMARK_HOLD_RANGE_MS)));
+
+            InputPathBenchmark_DriveEdge(gpioNum, INPUTPATHBENCHMARK_BUTTON_RELEASED_LEVEL);
+        }
+    }
+}
+
+/**
+ * @brief Drive a pin to a level, followed by a random number of bounces back
+ * and forth, each edge a random time apart.  Bounces end at the level.
+ *
+ * @param[in] gpioNum GPIO number of the pin
+ * @param[in] level   Level the pin settles at
+ ******************************************************************************/
+static void InputPathBenchmark_DriveEdge(const gpio_num_t gpioNum, const uint32_t level)
+{
+    uint32_t bounces = Prng_Bounded(&InputPathBenchmark_Prng, INPUTPATHBENCHMARK_MAX_BOUNCES + 1U);
+
+    GpioDriver_SetLevel(gpioNum, level);
+    for (uint32_t bounce = 0U; bounce < bounces; bounce++)
+    {
+        InputPathBenchmark_Spin(INPUTPATHBENCHMARK_MIN_BOUNCE_US + Prng_Bounded(&InputPathBenchmark_Prng, INPUTPATHBENCHMARK_BOUNCE_RANGE_US));
+        GpioDriver_SetLevel(gpioNum, level ^ 1U);
+        InputPathBenchmark_Spin(INPUTPATHBENCHMARK_MIN_BOUNCE_US + Prng_Bounded(&InputPathBenchmark_Prng, INPUTPATHBENCHMARK_BOUNCE_RANGE_US));
+        GpioDriver_SetLevel(gpioNum, level);
+    }
+    InputPathBenchmark_Bounces += bounces;
+}
+
+/**
+ * @brief Wait without blocking, for times shorter than a tick.
+ *
+ * @param[in] us Time to wait in microseconds
+ ******************************************************************************/
+static void InputPathBenchmark_Spin(const uint32_t us)
+{
+    int64_t endUs = esp_timer_get_time() + us;
+
+    while (esp_timer_get_time() < endUs)
+    {
+    }
+}
+
+/**
+ * @brief Discard log messages so output does not affect timing.
+ *
+ * @param[in] gameContext Context for the game logging the message, unused
+ * @param[in] message     Message to log, unused
+ ******************************************************************************/
+static void InputPathBenchmark_Logger(const BopIt_GameContext_t *const gameContext, const char *const message)
+{
+    (void)gameContext;
+    (void)message;
+}
+
+/**
+ * @brief Get the current time in microseconds, like the firmware.
+ *
+ * @param[in] gameContext Context for a BopIt game, unused
+ *
+ * @return Current time in microseconds
+ ******************************************************************************/
+static BopIt_TimeUs_t InputPathBenchmark_Time(const BopIt_GameContext_t *const gameContext)
+{
+    (void)gameContext;
+
+    return (BopIt_TimeUs_t)esp_timer_get_time();
+}
+
+/**
+ * @brief Order latencies for qsort.
+ *
+ * @param[in] a First latency
+ * @param[in] b Second latency
+ *
+ * @return Negative, zero or positive as a is less than, equal to or greater
+ * than b
+ ******************************************************************************/
+static int InputPathBenchmark_CompareLatencies(const void *a, const void *b)
+{
+    uint32_t latencyA = *(const uint32_t *)a;
+    uint32_t latencyB = *(const uint32_t *)b;
+
+    return (latencyA > latencyB) - (latencyA < latencyB);
+}
+
+/**
+ * @brief Get a percentile of sorted latencies, the nearest rank.
+ *
+ * @param[in] sorted     Latencies in ascending order
+ * @param[in] count      Number of latencies, at least one
+ * @param[in] percentile Percentile to get
+ *
+ * @return Latency at the percentile
+ ******************************************************************************/
+static uint32_t InputPathBenchmark_GetPercentile(const uint32_t *const sorted, const uint32_t count, const uint32_t percentile)
+{
+    uint32_t rank = (uint32_t)(((uint64_t)count * percentile + INPUTPATHBENCHMARK_PERCENT - 1U) / INPUTPATHBENCHMARK_PERCENT);
+
+    return sorted[(rank > 0U) ? (rank - 1U) : 0U];
+}
+
+/* Stubs of the firmware modules outside the input path
+ ******************************************************************************/
+
+/**
+ * @brief Observe the game through the messages it posts to the other blasters.
+ * A command wakes the player to press its button, and the result of a command
+ * completes the press's latency, as the result of a completed command is
+ * posted the moment BopIt reaches its success state.
+ *
+ * @note Called from the game task.
+ *
+ * @param[in] message Message posted by the game
+ *
+ * @return Always true
+ ******************************************************************************/
+bool Link_Post(const GameLink_Message_t *const message)
+{
+    int64_t nowUs = esp_timer_get_time();
+
+    if (message->Type == GAMELINK_MESSAGE_COMMAND)
+    {
+        InputPathBenchmark_Commands++;
+        xTaskNotify(InputPathBenchmark_InterruptTaskHandle, message->Command.CommandIndex, eSetValueWithOverwrite);
+    }
+    else if (message->Type == GAMELINK_MESSAGE_RESULT && message->Result.Success)
+    {
+        if (InputPathBenchmark_Successes < INPUTPATHBENCHMARK_MAX_PRESSES)
+        {
+            InputPathBenchmark_Latencies[InputPathBenchmark_Successes] = (uint32_t)(nowUs - atomic_load_explicit(&InputPathBenchmark_PressTimeUs, memory_order_relaxed));
+        }
+        InputPathBenchmark_Successes++;
+    }
+    else if (message->Type == GAMELINK_MESSAGE_RESULT)
+    {
+        InputPathBenchmark_Fails++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Discard feedback effects.
+ *
+ * @param[in] player Unused
+ ******************************************************************************/
+void Feedback_Init(const Feedback_Player_t *const player)
+{
+    (void)player;
+}
+
+/**
+ * @brief Discard a feedback effect.
+ *
+ * @param[in] effect Unused
+ *
+ * @return Always true
+ ******************************************************************************/
+bool Feedback_Post(const EffectQueue_Effect_t *const effect)
+{
+    (void)effect;
+
+    return true;
+}
+
+/**
+ * @brief Discard a request to play a clip.
+ *
+ * @param[in] clip          Unused
+ * @param[in] requestTimeUs Unused
+ *
+ * @return Always false
+ ******************************************************************************/
+bool Audio_Play(const uint32_t clip, const uint32_t requestTimeUs)
+{
+    (void)clip;
+    (void)requestTimeUs;
+
+    return false;
+}
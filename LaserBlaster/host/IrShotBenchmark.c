@@ -0,0 +1,471 @@
+/**
+ * @file IrShotBenchmark.c
+ *
+ * @brief Benchmark of the IrShot decoder.  Encodes random shots into a stream
+ * of pulses and decodes it in buffers of random sizes, like the RMT receiver
+ * hands them over, reporting decode throughput and checking every shot is
+ * decoded exactly.  Then decodes the shots with timing jitter and glitches
+ * added to each pulse, reporting the fraction of shots decoded at each level
+ * of noise, and decodes random pulses, reporting how many shots are decoded
+ * from noise alone.  Finally two blasters with different player IDs fire at
+ * each other, each also receiving its own shot reflected back.
+ *
+ * Exits with a failure status if a clean stream or a stream with jitter within
+ * the decoder's tolerance is not decoded exactly, if any shot is decoded
+ * wrong, or if either blaster does not register exactly the other's shot as a
+ * hit.
+ *
+ * Usage: IrShotBenchmark [shots] [seed]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "IrShot.h"
+#include "Prng.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define IRSHOTBENCHMARK_DEFAULT_SHOTS 100000U                                     /* Number of shots encoded if not specified */
+#define IRSHOTBENCHMARK_DEFAULT_SEED 1U                                           /* Seed of the shots and noise if not specified */
+#define IRSHOTBENCHMARK_GAP_US 20000U                                             /* Space between frames */
+#define IRSHOTBENCHMARK_MAX_BUFFER_PULSES 64U                                     /* Largest buffer of pulses handed to the decoder at a time */
+#define IRSHOTBENCHMARK_MAX_GLITCH_US 150U                                        /* Longest glitch splitting a pulse */
+#define IRSHOTBENCHMARK_MIN_GLITCH_US 20U                                         /* Shortest glitch splitting a pulse */
+#define IRSHOTBENCHMARK_FRAME_PULSES (IRSHOT_FRAME_PULSES + 1U)                   /* Number of pulses of a frame and the gap after it */
+#define IRSHOTBENCHMARK_MAX_NOISY_PULSES (3U * IRSHOTBENCHMARK_FRAME_PULSES)      /* Number of pulses of a frame if every pulse is split by a glitch */
+#define IRSHOTBENCHMARK_NOISE_PULSES 10000000U                                    /* Number of random pulses decoded */
+#define IRSHOTBENCHMARK_MIN_NOISE_US 50U                                          /* Shortest random pulse */
+#define IRSHOTBENCHMARK_NOISE_RANGE_US 3000U                                      /* Range of random pulse durations */
+#define IRSHOTBENCHMARK_PPM 1000000U                                              /* Parts per million */
+#define IRSHOTBENCHMARK_SHOTS_PER_BUFFER (IRSHOTBENCHMARK_MAX_BUFFER_PULSES / 2U) /* Room for shots decoded from a single buffer */
+#define IRSHOTBENCHMARK_BLASTERS 2U                                               /* Number of blasters firing at each other */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Noise added to every pulse of a frame */
+typedef struct
+{
+    uint32_t JitterPercent; /* Maximum change in duration of each pulse, as a percentage of its duration */
+    uint32_t GlitchPpm;     /* Probability of each pulse being split by a glitch of the opposite level, in parts per million */
+    bool MustDecode;        /* Whether every shot must be decoded at this level of noise */
+} IrShotBenchmark_Noise_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static IrShot_Shot_t IrShotBenchmark_RandomShot(Prng_t *const prng);
+static bool IrShotBenchmark_ShotsEqual(const IrShot_Shot_t *const a, const IrShot_Shot_t *const b);
+static int IrShotBenchmark_Throughput(const IrShot_Shot_t *const shots, const uint32_t shotCount, const uint32_t seed);
+static int IrShotBenchmark_Noise(const IrShot_Shot_t *const shots, const uint32_t shotCount, const uint32_t seed, const IrShotBenchmark_Noise_t *const noise);
+static uint32_t IrShotBenchmark_AddNoise(Prng_t *const prng, const IrShot_Pulse_t *const pulses, const uint32_t pulseCount, const IrShotBenchmark_Noise_t *const noise, IrShot_Pulse_t *const noisyPulses);
+static void IrShotBenchmark_RandomPulses(const uint32_t seed);
+static int IrShotBenchmark_TwoBlasters(const uint32_t seed);
+
+/* Globals
+ ******************************************************************************/
+
+/* Levels of noise, jitter up to the decoder's tolerance must always be decoded */
+static const IrShotBenchmark_Noise_t IrShotBenchmark_Noises[] = {
+    {.JitterPercent = 0U, .GlitchPpm = 0U, .MustDecode = true},
+    {.JitterPercent = 10U, .GlitchPpm = 0U, .MustDecode = true},
+    {.JitterPercent = IRSHOT_TOLERANCE_PERCENT - 1U, .GlitchPpm = 0U, .MustDecode = true},
+    {.JitterPercent = 30U, .GlitchPpm = 0U, .MustDecode = false},
+    {.JitterPercent = 40U, .GlitchPpm = 0U, .MustDecode = false},
+    {.JitterPercent = 10U, .GlitchPpm = 1000U, .MustDecode = false},
+    {.JitterPercent = 10U, .GlitchPpm = 10000U, .MustDecode = false},
+    {.JitterPercent = 10U, .GlitchPpm = 50000U, .MustDecode = false},
+};
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t shotCount = IRSHOTBENCHMARK_DEFAULT_SHOTS;
+    uint32_t seed = IRSHOTBENCHMARK_DEFAULT_SEED;
+    IrShot_Shot_t *shots;
+    Prng_t prng;
+    int status = EXIT_SUCCESS;
+
+    if (argc > 1)
+    {
+        shotCount = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        seed = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (shotCount == 0U)
+    {
+        shotCount = IRSHOTBENCHMARK_DEFAULT_SHOTS;
+    }
+
+    shots = malloc((size_t)shotCount * sizeof(IrShot_Shot_t));
+    if (shots == NULL)
+    {
+        printf("Failed to allocate shots\n");
+        return EXIT_FAILURE;
+    }
+
+    Prng_Seed(&prng, seed, 0U);
+    for (uint32_t shotIndex = 0U; shotIndex < shotCount; shotIndex++)
+    {
+        shots[shotIndex] = IrShotBenchmark_RandomShot(&prng);
+    }
+
+    printf("IrShot benchmark: %" PRIu32 " shots, seed %" PRIu32 "\n", shotCount, seed);
+
+    if (IrShotBenchmark_Throughput(shots, shotCount, seed) != EXIT_SUCCESS)
+    {
+        status = EXIT_FAILURE;
+    }
+
+    printf("  Jitter  Glitches  Decoded   Checksum errors  Framing errors\n");
+    for (uint32_t noiseIndex = 0U; noiseIndex < (sizeof(IrShotBenchmark_Noises) / sizeof(IrShotBenchmark_Noises[0U])); noiseIndex++)
+    {
+        if (IrShotBenchmark_Noise(shots, shotCount, seed, &IrShotBenchmark_Noises[noiseIndex]) != EXIT_SUCCESS)
+        {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    IrShotBenchmark_RandomPulses(seed);
+
+    if (IrShotBenchmark_TwoBlasters(seed) != EXIT_SUCCESS)
+    {
+        status = EXIT_FAILURE;
+    }
+
+    free(shots);
+
+    return status;
+}
+
+/**
+ * @brief Draw a random shot with every field in range.
+ *
+ * @param[in,out] prng Generator to draw the shot from
+ *
+ * @return Random shot
+ ******************************************************************************/
+static IrShot_Shot_t IrShotBenchmark_RandomShot(Prng_t *const prng)
+{
+    IrShot_Shot_t shot = {
+        .PlayerId = (uint8_t)Prng_Bounded(prng, IRSHOT_MAX_PLAYER_ID + 1U),
+        .Team = (uint8_t)Prng_Bounded(prng, IRSHOT_MAX_TEAM + 1U),
+        .Damage = (uint8_t)Prng_Bounded(prng, IRSHOT_MAX_DAMAGE + 1U),
+    };
+
+    return shot;
+}
+
+/**
+ * @brief Check whether two shots are the same.
+ *
+ * @param[in] a First shot
+ * @param[in] b Second shot
+ *
+ * @return Whether every field of the shots is equal or not
+ ******************************************************************************/
+static bool IrShotBenchmark_ShotsEqual(const IrShot_Shot_t *const a, const IrShot_Shot_t *const b)
+{
+    return a->PlayerId == b->PlayerId && a->Team == b->Team && a->Damage == b->Damage;
+}
+
+/**
+ * @brief Encode all shots into a single stream of pulses and decode it in
+ * buffers of random sizes, so frames are split across buffers.  Reports decode
+ * throughput and checks every shot is decoded in order.
+ *
+ * @param[in] shots     Shots to encode
+ * @param[in] shotCount Number of shots
+ * @param[in] seed      Seed of the buffer sizes
+ *
+ * @return EXIT_SUCCESS if every shot was decoded exactly, EXIT_FAILURE
+ * otherwise
+ ******************************************************************************/
+static int IrShotBenchmark_Throughput(const IrShot_Shot_t *const shots, const uint32_t shotCount, const uint32_t seed)
+{
+    IrShot_Pulse_t *pulses = malloc((size_t)shotCount * IRSHOTBENCHMARK_FRAME_PULSES * sizeof(IrShot_Pulse_t));
+    IrShot_Shot_t *decoded = malloc((size_t)shotCount * sizeof(IrShot_Shot_t));
+    IrShot_Decoder_t decoder;
+    Prng_t prng;
+    uint32_t pulseCount = 0U;
+    uint32_t decodedCount = 0U;
+    uint32_t bufferPulses;
+    uint32_t mismatches = 0U;
+    int status = EXIT_SUCCESS;
+
+    if (pulses == NULL || decoded == NULL)
+    {
+        printf("Failed to allocate pulses\n");
+        free(pulses);
+        free(decoded);
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t shotIndex = 0U; shotIndex < shotCount; shotIndex++)
+    {
+        pulseCount += IrShot_Encode(&shots[shotIndex], &pulses[pulseCount], IRSHOT_FRAME_PULSES);
+        pulses[pulseCount - 1U].DurationUs = IRSHOTBENCHMARK_GAP_US; /* Stretch the trailing space into the gap */
+    }
+
+    /* Hand the stream to the decoder in buffers of up to the size of the RMT receive buffer */
+    Prng_Seed(&prng, seed, 1U);
+    IrShot_DecoderInit(&decoder);
+    Benchmark_TimeNs_t start = Benchmark_GetTimeNs();
+    for (uint32_t pulseIndex = 0U; pulseIndex < pulseCount; pulseIndex += bufferPulses)
+    {
+        bufferPulses = 1U + Prng_Bounded(&prng, IRSHOTBENCHMARK_MAX_BUFFER_PULSES);
+        if (bufferPulses > (pulseCount - pulseIndex))
+        {
+            bufferPulses = pulseCount - pulseIndex;
+        }
+        decodedCount += IrShot_Decode(&decoder, &pulses[pulseIndex], bufferPulses, &decoded[decodedCount], shotCount - decodedCount);
+    }
+    Benchmark_TimeNs_t decodeTime = Benchmark_GetTimeNs() - start;
+
+    for (uint32_t shotIndex = 0U; shotIndex < decodedCount; shotIndex++)
+    {
+        if (!IrShotBenchmark_ShotsEqual(&shots[shotIndex], &decoded[shotIndex]))
+        {
+            mismatches++;
+        }
+    }
+
+    printf("  Pulses:              %" PRIu32 "\n", pulseCount);
+    printf("  Decode time:         %.3f ms\n", (double)decodeTime / 1e6);
+    printf("  ns/pulse:            %.2f\n", (double)decodeTime / pulseCount);
+    printf("  ns/shot:             %.2f\n", (double)decodeTime / shotCount);
+    printf("  Shots/s:             %.0f\n", (double)shotCount * 1e9 / (double)decodeTime);
+    printf("  Shots decoded:       %" PRIu32 "\n", decodedCount);
+
+    if (decodedCount != shotCount || mismatches > 0U || decoder.Stats.ChecksumErrors > 0U || decoder.Stats.FramingErrors > 0U)
+    {
+        printf("FAIL: decoded %" PRIu32 " of %" PRIu32 " shots, %" PRIu32 " wrong, %" PRIu32 " checksum errors, %" PRIu32 " framing errors\n", decodedCount, shotCount, mismatches, decoder.Stats.ChecksumErrors, decoder.Stats.FramingErrors);
+        status = EXIT_FAILURE;
+    }
+
+    free(pulses);
+    free(decoded);
+
+    return status;
+}
+
+/**
+ * @brief Decode every shot with noise added to its pulses.  Each frame is
+ * handed to the decoder on its own, so every shot decoded can be checked
+ * against the shot that was sent.
+ *
+ * @param[in] shots     Shots to encode
+ * @param[in] shotCount Number of shots
+ * @param[in] seed      Seed of the noise
+ * @param[in] noise     Noise added to every pulse
+ *
+ * @return EXIT_SUCCESS if no shot was decoded wrong and, if required at this
+ * level of noise, every shot was decoded, EXIT_FAILURE otherwise
+ ******************************************************************************/
+static int IrShotBenchmark_Noise(const IrShot_Shot_t *const shots, const uint32_t shotCount, const uint32_t seed, const IrShotBenchmark_Noise_t *const noise)
+{
+    IrShot_Pulse_t pulses[IRSHOTBENCHMARK_FRAME_PULSES];
+    IrShot_Pulse_t noisyPulses[IRSHOTBENCHMARK_MAX_NOISY_PULSES];
+    IrShot_Shot_t decoded[IRSHOTBENCHMARK_SHOTS_PER_BUFFER];
+    IrShot_Decoder_t decoder;
+    Prng_t prng;
+    uint32_t pulseCount;
+    uint32_t noisyPulseCount;
+    uint32_t decodedCount;
+    uint32_t received = 0U;
+    uint32_t wrong = 0U;
+    int status = EXIT_SUCCESS;
+
+    Prng_Seed(&prng, seed, 2U);
+    IrShot_DecoderInit(&decoder);
+    for (uint32_t shotIndex = 0U; shotIndex < shotCount; shotIndex++)
+    {
+        pulseCount = IrShot_Encode(&shots[shotIndex], pulses, IRSHOT_FRAME_PULSES);
+        pulses[pulseCount - 1U].DurationUs = IRSHOTBENCHMARK_GAP_US;
+
+        noisyPulseCount = IrShotBenchmark_AddNoise(&prng, pulses, pulseCount, noise, noisyPulses);
+        decodedCount = IrShot_Decode(&decoder, noisyPulses, noisyPulseCount, decoded, IRSHOTBENCHMARK_SHOTS_PER_BUFFER);
+
+        for (uint32_t decodedIndex = 0U; decodedIndex < decodedCount; decodedIndex++)
+        {
+            if (IrShotBenchmark_ShotsEqual(&shots[shotIndex], &decoded[decodedIndex]) && decodedIndex == 0U)
+            {
+                received++;
+            }
+            else
+            {
+                wrong++;
+            }
+        }
+    }
+
+    printf("  %4" PRIu32 "%%  %7.1f%%  %7.3f%%  %15" PRIu32 "  %14" PRIu32 "\n", noise->JitterPercent, (double)noise->GlitchPpm * 100.0 / IRSHOTBENCHMARK_PPM, (double)received * 100.0 / shotCount, decoder.Stats.ChecksumErrors, decoder.Stats.FramingErrors);
+
+    if (wrong > 0U)
+    {
+        printf("FAIL: %" PRIu32 " shots decoded wrong\n", wrong);
+        status = EXIT_FAILURE;
+    }
+    if (noise->MustDecode && received != shotCount)
+    {
+        printf("FAIL: decoded %" PRIu32 " of %" PRIu32 " shots with jitter within tolerance\n", received, shotCount);
+        status = EXIT_FAILURE;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Add timing jitter to every pulse of a frame and split pulses by
+ * glitches of the opposite level.
+ *
+ * @param[in,out] prng        Generator to draw the noise from
+ * @param[in]     pulses      Pulses of the frame
+ * @param[in]     pulseCount  Number of pulses of the frame
+ * @param[in]     noise       Noise to add
+ * @param[out]    noisyPulses Pulses with noise, room for three times
+ * pulseCount pulses
+ *
+ * @return Number of pulses with noise
+ ******************************************************************************/
+static uint32_t IrShotBenchmark_AddNoise(Prng_t *const prng, const IrShot_Pulse_t *const pulses, const uint32_t pulseCount, const IrShotBenchmark_Noise_t *const noise, IrShot_Pulse_t *const noisyPulses)
+{
+    uint32_t noisyPulseCount = 0U;
+    uint32_t duration;
+    uint32_t jitter;
+    uint32_t glitch;
+    uint32_t before;
+
+    for (uint32_t pulseIndex = 0U; pulseIndex < pulseCount; pulseIndex++)
+    {
+        duration = pulses[pulseIndex].DurationUs;
+        jitter = (duration * noise->JitterPercent) / 100U;
+        duration = duration - jitter + Prng_Bounded(prng, (2U * jitter) + 1U);
+
+        glitch = IRSHOTBENCHMARK_MIN_GLITCH_US + Prng_Bounded(prng, IRSHOTBENCHMARK_MAX_GLITCH_US - IRSHOTBENCHMARK_MIN_GLITCH_US + 1U);
+        if (Prng_Bounded(prng, IRSHOTBENCHMARK_PPM) < noise->GlitchPpm && duration > (glitch + 2U))
+        {
+            before = 1U + Prng_Bounded(prng, duration - glitch - 1U);
+            noisyPulses[noisyPulseCount++] = (IrShot_Pulse_t){.DurationUs = (uint16_t)before, .Mark = pulses[pulseIndex].Mark};
+            noisyPulses[noisyPulseCount++] = (IrShot_Pulse_t){.DurationUs = (uint16_t)glitch, .Mark = !pulses[pulseIndex].Mark};
+            noisyPulses[noisyPulseCount++] = (IrShot_Pulse_t){.DurationUs = (uint16_t)(duration - glitch - before), .Mark = pulses[pulseIndex].Mark};
+        }
+        else
+        {
+            noisyPulses[noisyPulseCount++] = (IrShot_Pulse_t){.DurationUs = (uint16_t)duration, .Mark = pulses[pulseIndex].Mark};
+        }
+    }
+
+    return noisyPulseCount;
+}
+
+/**
+ * @brief Decode alternating marks and spaces of random durations and report
+ * how often noise alone is decoded as a shot.
+ *
+ * @param[in] seed Seed of the pulses
+ ******************************************************************************/
+static void IrShotBenchmark_RandomPulses(const uint32_t seed)
+{
+    IrShot_Pulse_t pulses[IRSHOTBENCHMARK_MAX_BUFFER_PULSES];
+    IrShot_Shot_t decoded[IRSHOTBENCHMARK_SHOTS_PER_BUFFER];
+    IrShot_Decoder_t decoder;
+    Prng_t prng;
+    uint32_t falseShots = 0U;
+    bool mark = true;
+
+    Prng_Seed(&prng, seed, 3U);
+    IrShot_DecoderInit(&decoder);
+    for (uint32_t pulseIndex = 0U; pulseIndex < IRSHOTBENCHMARK_NOISE_PULSES; pulseIndex += IRSHOTBENCHMARK_MAX_BUFFER_PULSES)
+    {
+        for (uint32_t bufferIndex = 0U; bufferIndex < IRSHOTBENCHMARK_MAX_BUFFER_PULSES; bufferIndex++)
+        {
+            pulses[bufferIndex] = (IrShot_Pulse_t){.DurationUs = (uint16_t)(IRSHOTBENCHMARK_MIN_NOISE_US + Prng_Bounded(&prng, IRSHOTBENCHMARK_NOISE_RANGE_US)), .Mark = mark};
+            mark = !mark;
+        }
+        falseShots += IrShot_Decode(&decoder, pulses, IRSHOTBENCHMARK_MAX_BUFFER_PULSES, decoded, IRSHOTBENCHMARK_SHOTS_PER_BUFFER);
+    }
+
+    printf("  Random pulses:       %u, %" PRIu32 " headers started a frame, %" PRIu32 " checksum errors, %" PRIu32 " shots decoded\n", IRSHOTBENCHMARK_NOISE_PULSES, decoder.Stats.FramingErrors + decoder.Stats.ChecksumErrors + decoder.Stats.Shots,
+           decoder.Stats.ChecksumErrors, falseShots);
+}
+
+/**
+ * @brief Fire a shot from each of two blasters with different player IDs, the
+ * last bytes of two MAC addresses on the blasters.  Each blaster receives the
+ * other's shot and its own shot reflected back, and must register the other's
+ * shot alone as a hit.
+ *
+ * @param[in] seed Seed of the player IDs and shots
+ *
+ * @return EXIT_SUCCESS if each blaster registered exactly the other's shot as
+ * a hit, EXIT_FAILURE otherwise
+ ******************************************************************************/
+static int IrShotBenchmark_TwoBlasters(const uint32_t seed)
+{
+    IrShot_Shot_t fired[IRSHOTBENCHMARK_BLASTERS];
+    IrShot_Pulse_t pulses[IRSHOTBENCHMARK_BLASTERS * IRSHOT_FRAME_PULSES];
+    IrShot_Shot_t decoded[IRSHOTBENCHMARK_BLASTERS];
+    IrShot_Decoder_t decoder;
+    Prng_t prng;
+    uint32_t pulseCount;
+    uint32_t decodedCount;
+    uint32_t hits[IRSHOTBENCHMARK_BLASTERS] = {0U};
+    uint32_t other;
+    int status = EXIT_SUCCESS;
+
+    Prng_Seed(&prng, seed, 4U);
+    fired[0U] = IrShotBenchmark_RandomShot(&prng);
+    fired[1U] = IrShotBenchmark_RandomShot(&prng);
+
+    /* Offset the second ID by 1 to IRSHOT_MAX_PLAYER_ID so the IDs always differ */
+    fired[1U].PlayerId = (uint8_t)(fired[0U].PlayerId + 1U + Prng_Bounded(&prng, IRSHOT_MAX_PLAYER_ID));
+
+    for (uint32_t blaster = 0U; blaster < IRSHOTBENCHMARK_BLASTERS; blaster++)
+    {
+        other = (blaster + 1U) % IRSHOTBENCHMARK_BLASTERS;
+
+        /* Own shot reflected back first, then the other blaster's shot */
+        pulseCount = IrShot_Encode(&fired[blaster], pulses, IRSHOT_FRAME_PULSES);
+        pulses[pulseCount - 1U].DurationUs = IRSHOTBENCHMARK_GAP_US;
+        pulseCount += IrShot_Encode(&fired[other], &pulses[pulseCount], IRSHOT_FRAME_PULSES);
+
+        IrShot_DecoderInit(&decoder);
+        decodedCount = IrShot_Decode(&decoder, pulses, pulseCount, decoded, IRSHOTBENCHMARK_BLASTERS);
+
+        for (uint32_t decodedIndex = 0U; decodedIndex < decodedCount; decodedIndex++)
+        {
+            if (IrShot_IsHit(&decoded[decodedIndex], fired[blaster].PlayerId))
+            {
+                hits[blaster]++;
+                if (!IrShotBenchmark_ShotsEqual(&decoded[decodedIndex], &fired[other]))
+                {
+                    status = EXIT_FAILURE;
+                }
+            }
+        }
+
+        if (decodedCount != IRSHOTBENCHMARK_BLASTERS || hits[blaster] != 1U)
+        {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    printf("  Two blasters: players %u and %u, hits %" PRIu32 " and %" PRIu32 "\n", fired[0U].PlayerId, fired[1U].PlayerId, hits[0U], hits[1U]);
+    if (status != EXIT_SUCCESS)
+    {
+        printf("FAIL: blasters did not each register exactly the other's shot as a hit\n");
+    }
+
+    return status;
+}
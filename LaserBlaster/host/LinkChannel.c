@@ -0,0 +1,155 @@
+/**
+ * @file LinkChannel.c
+ *
+ * @brief In-process broadcast channel with simulated delays.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "LinkChannel.h"
+#include <stddef.h>
+#include <string.h>
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize a channel with no frames in flight.
+ *
+ * @param[out] channel       Channel to initialize
+ * @param[in]  endpointCount Number of endpoints
+ * @param[in]  baseDelayUs   Shortest delay of a frame
+ * @param[in]  jitterUs      Range of the random delay added to each frame
+ * @param[in]  seed          Seed of the delays
+ *
+ * @return Whether the channel was initialized or not
+ ******************************************************************************/
+bool LinkChannel_Init(LinkChannel_t *const channel, const uint32_t endpointCount, const uint32_t baseDelayUs, const uint32_t jitterUs, const uint64_t seed)
+{
+    bool initialized = false;
+
+    if (channel != NULL && endpointCount <= LINKCHANNEL_MAX_ENDPOINTS)
+    {
+        memset(channel, 0, sizeof(*channel));
+        channel->EndpointCount = endpointCount;
+        channel->BaseDelayUs = baseDelayUs;
+        channel->JitterUs = jitterUs;
+        Prng_Seed(&channel->Prng, seed, 0U);
+
+        for (uint32_t endpoint = 0U; endpoint < endpointCount; endpoint++)
+        {
+            channel->Endpoints[endpoint].Channel = channel;
+            channel->Endpoints[endpoint].Index = endpoint;
+        }
+
+        initialized = true;
+    }
+
+    return initialized;
+}
+
+/**
+ * @brief Broadcast a frame from an endpoint to every other endpoint, each
+ * with its own random delay from the channel's current time.
+ *
+ * @param[in] context Endpoint sending the frame
+ * @param[in] frame   Frame to send
+ * @param[in] size    Size of the frame in bytes
+ *
+ * @return Whether the frame was sent to every other endpoint or not
+ ******************************************************************************/
+bool LinkChannel_Send(void *const context, const uint8_t *const frame, const uint32_t size)
+{
+    const LinkChannel_Endpoint_t *sender = (const LinkChannel_Endpoint_t *)context;
+    LinkChannel_t *channel;
+    LinkChannel_Frame_t *inFlight;
+    uint64_t deliverUs;
+    bool sent = false;
+
+    if (sender != NULL && frame != NULL && size <= LINKCHANNEL_MAX_FRAME_SIZE)
+    {
+        channel = sender->Channel;
+        sent = true;
+
+        for (uint32_t endpoint = 0U; endpoint < channel->EndpointCount; endpoint++)
+        {
+            if (endpoint == sender->Index)
+            {
+                /* Broadcasts are not looped back */
+            }
+            else if (channel->FrameCount == LINKCHANNEL_CAPACITY)
+            {
+                channel->Overflows++;
+                sent = false;
+            }
+            else
+            {
+                /* A frame never overtakes an earlier frame between the same endpoints */
+                deliverUs = channel->TimeUs + channel->BaseDelayUs + Prng_Bounded(&channel->Prng, channel->JitterUs + 1U);
+                if (deliverUs < channel->LastDeliverUs[sender->Index][endpoint])
+                {
+                    deliverUs = channel->LastDeliverUs[sender->Index][endpoint];
+                }
+                channel->LastDeliverUs[sender->Index][endpoint] = deliverUs;
+
+                inFlight = &channel->Frames[channel->FrameCount];
+                inFlight->Endpoint = endpoint;
+                inFlight->DeliverUs = deliverUs;
+                inFlight->Size = size;
+                memcpy(inFlight->Data, frame, size);
+                channel->FrameCount++;
+            }
+        }
+    }
+
+    return sent;
+}
+
+/**
+ * @brief Deliver every frame due by a time, earliest first.
+ *
+ * @param[in,out] channel Channel to deliver frames of
+ * @param[in]     untilUs Time up to which frames are delivered
+ * @param[in]     receive Called for every frame delivered with the time it
+ * arrives, may send frames
+ * @param[in]     context Context passed to receive
+ *
+ * @return Number of frames delivered
+ ******************************************************************************/
+uint32_t LinkChannel_Deliver(LinkChannel_t *const channel, const uint64_t untilUs, const LinkChannel_Receive_t receive, void *const context)
+{
+    LinkChannel_Frame_t frame;
+    uint32_t earliest = 0U;
+    uint32_t delivered = 0U;
+    bool due = true;
+
+    if (channel != NULL && receive != NULL)
+    {
+        while (due)
+        {
+            for (uint32_t frameIndex = 1U; frameIndex < channel->FrameCount; frameIndex++)
+            {
+                if (channel->Frames[frameIndex].DeliverUs < channel->Frames[earliest].DeliverUs)
+                {
+                    earliest = frameIndex;
+                }
+            }
+
+            due = channel->FrameCount > 0U && channel->Frames[earliest].DeliverUs <= untilUs;
+            if (due)
+            {
+                /* Taken out of the channel before delivery, as receiving may send more frames, keeping frames due at the same time in the order sent */
+                frame = channel->Frames[earliest];
+                channel->FrameCount--;
+                memmove(&channel->Frames[earliest], &channel->Frames[earliest + 1U], (channel->FrameCount - earliest) * sizeof(LinkChannel_Frame_t));
+                receive(context, frame.Endpoint, frame.Data, frame.Size, frame.DeliverUs);
+                delivered++;
+            }
+
+            earliest = 0U;
+        }
+    }
+
+    return delivered;
+}
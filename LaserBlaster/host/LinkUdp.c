@@ -0,0 +1,147 @@
+/**
+ * @file LinkUdp.c
+ *
+ * @brief UDP loopback transport for GameLink on a host.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "LinkUdp.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static struct sockaddr_in LinkUdp_Address(const uint16_t port);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Bind an endpoint's port on the loopback interface.
+ *
+ * @param[out] udp           Endpoint to open
+ * @param[in]  basePort      Port of the first endpoint
+ * @param[in]  endpointCount Number of endpoints
+ * @param[in]  index         Index of this endpoint, bound to basePort + index
+ *
+ * @return Whether the port was bound or not
+ ******************************************************************************/
+bool LinkUdp_Open(LinkUdp_t *const udp, const uint16_t basePort, const uint32_t endpointCount, const uint32_t index)
+{
+    struct sockaddr_in address;
+    bool opened = false;
+
+    if (udp != NULL && index < endpointCount && ((uint32_t)basePort + endpointCount) <= UINT16_MAX)
+    {
+        udp->BasePort = basePort;
+        udp->EndpointCount = endpointCount;
+        udp->Index = index;
+        udp->Socket = socket(AF_INET, SOCK_DGRAM, 0);
+
+        if (udp->Socket >= 0)
+        {
+            address = LinkUdp_Address((uint16_t)(basePort + index));
+            opened = bind(udp->Socket, (const struct sockaddr *)&address, sizeof(address)) == 0 && fcntl(udp->Socket, F_SETFL, O_NONBLOCK) == 0;
+            if (!opened)
+            {
+                close(udp->Socket);
+                udp->Socket = -1;
+            }
+        }
+    }
+
+    return opened;
+}
+
+/**
+ * @brief Send a frame to every other endpoint.
+ *
+ * @param[in] context Endpoint sending the frame
+ * @param[in] frame   Frame to send
+ * @param[in] size    Size of the frame in bytes
+ *
+ * @return Whether the frame was sent to every other endpoint or not
+ ******************************************************************************/
+bool LinkUdp_Send(void *const context, const uint8_t *const frame, const uint32_t size)
+{
+    const LinkUdp_t *udp = (const LinkUdp_t *)context;
+    struct sockaddr_in address;
+    bool sent = false;
+
+    if (udp != NULL && udp->Socket >= 0 && frame != NULL)
+    {
+        sent = true;
+        for (uint32_t endpoint = 0U; endpoint < udp->EndpointCount; endpoint++)
+        {
+            address = LinkUdp_Address((uint16_t)(udp->BasePort + endpoint));
+            if (endpoint != udp->Index && sendto(udp->Socket, frame, size, 0, (const struct sockaddr *)&address, sizeof(address)) != (ssize_t)size)
+            {
+                sent = false;
+            }
+        }
+    }
+
+    return sent;
+}
+
+/**
+ * @brief Receive a frame if one is waiting, without blocking.
+ *
+ * @param[in,out] udp    Endpoint to receive on
+ * @param[out]    buffer Buffer for the frame
+ * @param[in]     size   Size of the buffer in bytes
+ *
+ * @return Size of the frame received, 0 if none was waiting
+ ******************************************************************************/
+uint32_t LinkUdp_Receive(LinkUdp_t *const udp, uint8_t *const buffer, const uint32_t size)
+{
+    ssize_t received = 0;
+
+    if (udp != NULL && udp->Socket >= 0 && buffer != NULL)
+    {
+        received = recv(udp->Socket, buffer, size, 0);
+    }
+
+    return (received > 0) ? (uint32_t)received : 0U;
+}
+
+/**
+ * @brief Close an endpoint.
+ *
+ * @param[in,out] udp Endpoint to close
+ ******************************************************************************/
+void LinkUdp_Close(LinkUdp_t *const udp)
+{
+    if (udp != NULL && udp->Socket >= 0)
+    {
+        close(udp->Socket);
+        udp->Socket = -1;
+    }
+}
+
+/**
+ * @brief Get the address of a port on the loopback interface.
+ *
+ * @param[in] port Port
+ *
+ * @return Address of the port
+ ******************************************************************************/
+static struct sockaddr_in LinkUdp_Address(const uint16_t port)
+{
+    struct sockaddr_in address;
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    return address;
+}
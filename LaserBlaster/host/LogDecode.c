@@ -0,0 +1,80 @@
+/**
+ * @file LogDecode.c
+ *
+ * @brief Decoder for captured BopIt deferred log records.  Reads a sequence of
+ * LogRing_Record_t from a file, or standard input if no file is given, and
+ * prints each record as text using the BopIt log format strings.
+ *
+ * Exits with a failure status if the capture ends in a partial record or
+ * contains a record with an unknown format ID.
+ *
+ * Usage: LogDecode [log file]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "BopIt.h"
+#include "LogRing.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define LOGDECODE_BUFFER_SIZE 256U /* Size of buffer for formatting a record */
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    FILE *logFile = stdin;
+    LogRing_Record_t record;
+    char buffer[LOGDECODE_BUFFER_SIZE];
+    const char *format;
+    size_t read;
+    uint64_t records = 0U;
+    int status = EXIT_SUCCESS;
+
+    if (argc > 1)
+    {
+        logFile = fopen(argv[1], "rb");
+        if (logFile == NULL)
+        {
+            printf("Failed to open log file %s\n", argv[1]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    while ((read = fread(&record, 1U, sizeof(record), logFile)) == sizeof(record))
+    {
+        format = BopIt_GetLogFormat(record.FormatId);
+
+        if (format == NULL || record.ArgCount > LOGRING_MAX_ARGS)
+        {
+            printf("[%" PRIu32 " us] Unknown record, format ID %" PRIu16 "\n", record.Time, record.FormatId);
+            status = EXIT_FAILURE;
+        }
+        else if (LogRing_Format(&record, format, buffer, sizeof(buffer)) >= 0)
+        {
+            printf("[%" PRIu32 " us] %s\n", record.Time, buffer);
+        }
+
+        records++;
+    }
+
+    if (read != 0U)
+    {
+        printf("Log ends in a partial record after %" PRIu64 " records\n", records);
+        status = EXIT_FAILURE;
+    }
+
+    if (logFile != stdin)
+    {
+        fclose(logFile);
+    }
+
+    return status;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file MappedFile.c
+ *
+ * @brief Read-only memory mapped files.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Map a whole file into memory, read-only.  Pages are read from the
+ * file as they are first touched, like flash through the cache on the target.
+ *
+ * @param[out] file File to map
+ * @param[in]  path Path of the file
+ *
+ * @return Whether the file was mapped or not, empty files cannot be mapped
+ ******************************************************************************/
+bool MappedFile_Open(MappedFile_t *const file, const char *const path)
+{
+    struct stat status;
+    void *data;
+    int descriptor;
+    bool opened = false;
+
+    if (file != NULL && path != NULL)
+    {
+        descriptor = open(path, O_RDONLY);
+        if (descriptor >= 0)
+        {
+            if (fstat(descriptor, &status) == 0 && status.st_size > 0)
+            {
+                data = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+                if (data != MAP_FAILED)
+                {
+                    file->Data = data;
+                    file->Size = (size_t)status.st_size;
+                    opened = true;
+                }
+            }
+
+            /* The mapping stays valid after the file is closed */
+            close(descriptor);
+        }
+    }
+
+    return opened;
+}
+
+/**
+ * @brief Unmap a file.
+ *
+ * @param[in,out] file File to unmap
+ ******************************************************************************/
+void MappedFile_Close(MappedFile_t *const file)
+{
+    if (file != NULL && file->Data != NULL)
+    {
+        munmap((void *)file->Data, file->Size);
+        file->Data = NULL;
+        file->Size = 0U;
+    }
+}
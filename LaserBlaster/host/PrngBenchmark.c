@@ -0,0 +1,220 @@
+/**
+ * @file PrngBenchmark.c
+ *
+ * @brief Benchmark of selecting commands with Prng against rand.  Reports
+ * nanoseconds per draw of rand() % count, Prng_Bounded, drawing without
+ * immediate repeats, and drawing from an alias table of weights.
+ *
+ * Exits with a failure status if a generator does not reproduce its sequence
+ * from its seed, if a draw without immediate repeats repeats, or if the counts
+ * of drawn indices are too far from the expected distribution.
+ *
+ * Usage: PrngBenchmark [draws] [seed]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "Prng.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define PRNGBENCHMARK_DEFAULT_DRAWS 10000000U /* Number of draws of each kind if not specified */
+#define PRNGBENCHMARK_DEFAULT_SEED 1U         /* Seed of the generators if not specified */
+#define PRNGBENCHMARK_COUNT 8U                /* Number of indices drawn from */
+#define PRNGBENCHMARK_MAX_CHI_SQUARED 30.0    /* About 6 standard deviations above the mean of a chi-squared distribution with 7 degrees of freedom */
+#define PRNGBENCHMARK_REPRODUCE_DRAWS 1000U   /* Number of numbers compared between generators with the same seed */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Result of a kind of draw */
+typedef struct
+{
+    const char *Name;                     /* Name of the kind of draw */
+    Benchmark_TimeNs_t Time;              /* Total time of all draws */
+    uint64_t Counts[PRNGBENCHMARK_COUNT]; /* Number of times each index was drawn */
+    uint64_t Repeats;                     /* Number of times an index was drawn twice in a row */
+} PrngBenchmark_Result_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static double PrngBenchmark_ChiSquared(const PrngBenchmark_Result_t *const result, const uint32_t *const weights, const uint32_t draws);
+static void PrngBenchmark_Print(const PrngBenchmark_Result_t *const result, const uint32_t draws, const double chiSquared);
+
+/* Globals
+ ******************************************************************************/
+
+static const uint32_t PrngBenchmark_UniformWeights[PRNGBENCHMARK_COUNT] = {1U, 1U, 1U, 1U, 1U, 1U, 1U, 1U};
+static const uint32_t PrngBenchmark_Weights[PRNGBENCHMARK_COUNT] = {1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U};
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t draws = PRNGBENCHMARK_DEFAULT_DRAWS;
+    uint32_t seed = PRNGBENCHMARK_DEFAULT_SEED;
+    PrngBenchmark_Result_t randResult = {.Name = "rand() % count"};
+    PrngBenchmark_Result_t boundedResult = {.Name = "Prng_Bounded"};
+    PrngBenchmark_Result_t noRepeatResult = {.Name = "No repeat"};
+    PrngBenchmark_Result_t aliasResult = {.Name = "Prng_AliasDraw"};
+    Prng_AliasEntry_t aliasEntries[PRNGBENCHMARK_COUNT];
+    Prng_AliasTable_t aliasTable;
+    Prng_t prng;
+    Prng_t reference;
+    uint32_t index;
+    uint32_t previous = 0U;
+    uint32_t mismatches = 0U;
+    int status = EXIT_SUCCESS;
+
+    if (argc > 1)
+    {
+        draws = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        seed = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (draws == 0U)
+    {
+        draws = PRNGBENCHMARK_DEFAULT_DRAWS;
+    }
+
+    /* Same seed, same sequence */
+    Prng_Seed(&prng, seed, 0U);
+    Prng_Seed(&reference, seed, 0U);
+    for (uint32_t draw = 0U; draw < PRNGBENCHMARK_REPRODUCE_DRAWS; draw++)
+    {
+        if (Prng_Next(&prng) != Prng_Next(&reference))
+        {
+            mismatches++;
+        }
+    }
+
+    srand(seed);
+    Benchmark_TimeNs_t start = Benchmark_GetTimeNs();
+    for (uint32_t draw = 0U; draw < draws; draw++)
+    {
+        randResult.Counts[(uint32_t)rand() % PRNGBENCHMARK_COUNT]++;
+    }
+    randResult.Time = Benchmark_GetTimeNs() - start;
+
+    Prng_Seed(&prng, seed, 0U);
+    start = Benchmark_GetTimeNs();
+    for (uint32_t draw = 0U; draw < draws; draw++)
+    {
+        boundedResult.Counts[Prng_Bounded(&prng, PRNGBENCHMARK_COUNT)]++;
+    }
+    boundedResult.Time = Benchmark_GetTimeNs() - start;
+
+    /* Same method as BopIt uses for BOPIT_SELECTION_NO_REPEAT */
+    Prng_Seed(&prng, seed, 0U);
+    start = Benchmark_GetTimeNs();
+    for (uint32_t draw = 0U; draw < draws; draw++)
+    {
+        index = Prng_Bounded(&prng, PRNGBENCHMARK_COUNT - 1U);
+        if (index >= previous)
+        {
+            index++;
+        }
+        noRepeatResult.Counts[index]++;
+        noRepeatResult.Repeats += (index == previous) ? 1U : 0U;
+        previous = index;
+    }
+    noRepeatResult.Time = Benchmark_GetTimeNs() - start;
+
+    Prng_AliasInit(&aliasTable, aliasEntries, PrngBenchmark_Weights, PRNGBENCHMARK_COUNT);
+    Prng_Seed(&prng, seed, 0U);
+    start = Benchmark_GetTimeNs();
+    for (uint32_t draw = 0U; draw < draws; draw++)
+    {
+        aliasResult.Counts[Prng_AliasDraw(&prng, &aliasTable)]++;
+    }
+    aliasResult.Time = Benchmark_GetTimeNs() - start;
+
+    double randChiSquared = PrngBenchmark_ChiSquared(&randResult, PrngBenchmark_UniformWeights, draws);
+    double boundedChiSquared = PrngBenchmark_ChiSquared(&boundedResult, PrngBenchmark_UniformWeights, draws);
+    double noRepeatChiSquared = PrngBenchmark_ChiSquared(&noRepeatResult, PrngBenchmark_UniformWeights, draws);
+    double aliasChiSquared = PrngBenchmark_ChiSquared(&aliasResult, PrngBenchmark_Weights, draws);
+
+    printf("PRNG benchmark: %" PRIu32 " draws from %" PRIu32 " indices, seed %" PRIu32 ", %zu bytes of generator state\n", draws, PRNGBENCHMARK_COUNT, seed, sizeof(Prng_t));
+    PrngBenchmark_Print(&randResult, draws, randChiSquared);
+    PrngBenchmark_Print(&boundedResult, draws, boundedChiSquared);
+    PrngBenchmark_Print(&noRepeatResult, draws, noRepeatChiSquared);
+    PrngBenchmark_Print(&aliasResult, draws, aliasChiSquared);
+
+    if (mismatches > 0U)
+    {
+        printf("FAIL: generators with the same seed differed %" PRIu32 " times\n", mismatches);
+        status = EXIT_FAILURE;
+    }
+    if (noRepeatResult.Repeats > 0U)
+    {
+        printf("FAIL: %" PRIu64 " immediate repeats drawing without repeats\n", noRepeatResult.Repeats);
+        status = EXIT_FAILURE;
+    }
+    if (boundedChiSquared > PRNGBENCHMARK_MAX_CHI_SQUARED || noRepeatChiSquared > PRNGBENCHMARK_MAX_CHI_SQUARED || aliasChiSquared > PRNGBENCHMARK_MAX_CHI_SQUARED)
+    {
+        printf("FAIL: drawn indices do not follow the expected distribution\n");
+        status = EXIT_FAILURE;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Get Pearson's chi-squared statistic of the counts of drawn indices
+ * against the counts expected from the weights of the indices.
+ *
+ * @param[in] result  Result of a kind of draw
+ * @param[in] weights Weight of each index
+ * @param[in] draws   Number of draws
+ *
+ * @return Chi-squared statistic, larger is further from the expected
+ * distribution
+ ******************************************************************************/
+static double PrngBenchmark_ChiSquared(const PrngBenchmark_Result_t *const result, const uint32_t *const weights, const uint32_t draws)
+{
+    double chiSquared = 0.0;
+    double expected;
+    double difference;
+    uint32_t totalWeight = 0U;
+
+    for (uint32_t index = 0U; index < PRNGBENCHMARK_COUNT; index++)
+    {
+        totalWeight += weights[index];
+    }
+
+    for (uint32_t index = 0U; index < PRNGBENCHMARK_COUNT; index++)
+    {
+        expected = ((double)draws * weights[index]) / totalWeight;
+        difference = (double)result->Counts[index] - expected;
+        chiSquared += (difference * difference) / expected;
+    }
+
+    return chiSquared;
+}
+
+/**
+ * @brief Print the result of a kind of draw.
+ *
+ * @param[in] result     Result of a kind of draw
+ * @param[in] draws      Number of draws
+ * @param[in] chiSquared Chi-squared statistic of the result
+ ******************************************************************************/
+static void PrngBenchmark_Print(const PrngBenchmark_Result_t *const result, const uint32_t draws, const double chiSquared)
+{
+    printf("  %-16s %8.2f ns/draw  chi-squared %8.2f  counts", result->Name, (double)result->Time / draws, chiSquared);
+    for (uint32_t index = 0U; index < PRNGBENCHMARK_COUNT; index++)
+    {
+        printf(" %" PRIu64, result->Counts[index]);
+    }
+    printf("\n");
+}
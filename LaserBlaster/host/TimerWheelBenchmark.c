@@ -0,0 +1,358 @@
+/**
+ * @file TimerWheelBenchmark.c
+ *
+ * @brief Benchmark of the TimerWheel game deadlines and effect timers are
+ * armed in.  Keeps thousands of timers armed on a virtual clock, moving and
+ * cancelling random timers between advances of the wheel and arming every
+ * timer again from its callback when it expires.  Most timers are due within
+ * a second, like game deadlines and effects, some within minutes and a few
+ * further out than the wheel spans.  The wheel is then drained by jumping
+ * straight to every time TimerWheel_GetNextExpiry reports.
+ *
+ * Every timer is checked to expire in exactly the tick its expiry rounds up
+ * to, which no timer expiring early, late or twice, or being lost, can pass.
+ * Reports the cost of arming and cancelling a timer and of advancing the wheel
+ * per timer expired.
+ *
+ * Exits with a failure status if a timer expires in the wrong tick, a cancel
+ * disagrees with whether the timer was armed or timers are left armed.
+ *
+ * Usage: TimerWheelBenchmark [timers] [seconds] [seed]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "Prng.h"
+#include "TimerWheel.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define TIMERWHEELBENCHMARK_DEFAULT_TIMERS 10000U  /* Number of timers kept armed if not specified */
+#define TIMERWHEELBENCHMARK_DEFAULT_SECONDS 60U    /* Length of the run in virtual time if not specified */
+#define TIMERWHEELBENCHMARK_DEFAULT_SEED 1U        /* Seed of the timers and operations if not specified */
+#define TIMERWHEELBENCHMARK_TICK_US 100U           /* Width of a tick of the wheel, that of the firmware's deadlines */
+#define TIMERWHEELBENCHMARK_MIN_STEP_US 500U       /* Shortest step of the virtual clock between advances */
+#define TIMERWHEELBENCHMARK_STEP_RANGE_US 1000U    /* Range of the random part of a step of the virtual clock */
+#define TIMERWHEELBENCHMARK_OPERATIONS_PER_STEP 8U /* Number of random timers moved or cancelled between advances */
+#define TIMERWHEELBENCHMARK_SHORT_US 1000000ULL    /* Range of the expiries of most timers, like game deadlines and effects */
+#define TIMERWHEELBENCHMARK_MEDIUM_US 600000000ULL /* Range of the expiries of some timers, within the span of the wheel */
+#define TIMERWHEELBENCHMARK_LONG_US 7200000000ULL  /* Range of the expiries of a few timers, beyond the span of the wheel */
+#define TIMERWHEELBENCHMARK_MEDIUM_PERMILLE 90U    /* Permille of timers armed within the medium range */
+#define TIMERWHEELBENCHMARK_LONG_PERMILLE 5U       /* Permille of timers armed within the long range */
+#define TIMERWHEELBENCHMARK_CANCEL_PERCENT 50U     /* Chance of a random operation cancelling a timer before arming it again */
+#define TIMERWHEELBENCHMARK_PERCENT 100U           /* Scale of a percentage */
+#define TIMERWHEELBENCHMARK_PERMILLE 1000U         /* Scale of a permille */
+#define TIMERWHEELBENCHMARK_P99_PERMILLE 990U      /* Permille of the 99th percentile */
+#define TIMERWHEELBENCHMARK_US_PER_S 1000000ULL    /* Microseconds per second */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Timer of the benchmark and the reference model of it */
+typedef struct
+{
+    TimerWheel_Timer_t Timer; /* Timer armed in the wheel */
+    bool Armed;               /* Whether the timer is armed in the reference model */
+    uint64_t ExpectedTick;    /* Tick the timer must expire in */
+} TimerWheelBenchmark_Timer_t;
+
+/* Costs of the operations measured */
+typedef struct
+{
+    Benchmark_TimeNs_t *ArmNs;    /* Cost of every arm of a random operation */
+    Benchmark_TimeNs_t *CancelNs; /* Cost of every cancel of a random operation */
+    uint32_t Arms;                /* Number of arms timed */
+    uint32_t Cancels;             /* Number of cancels timed */
+    Benchmark_TimeNs_t AdvanceNs; /* Total time spent advancing the wheel, including callbacks */
+    uint64_t Expired;             /* Number of timers expired while advancing was timed */
+} TimerWheelBenchmark_Costs_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static TimerWheel_TimeUs_t TimerWheelBenchmark_Expect(TimerWheelBenchmark_Timer_t *const timer);
+static void TimerWheelBenchmark_Expire(void *const context);
+static TimerWheel_TimeUs_t TimerWheelBenchmark_RandomDelay(void);
+static void TimerWheelBenchmark_PrintCost(const char *const name, Benchmark_TimeNs_t *const costsNs, const uint32_t count);
+static int TimerWheelBenchmark_CompareNs(const void *a, const void *b);
+
+/* Globals
+ ******************************************************************************/
+
+static TimerWheel_t TimerWheelBenchmark_Wheel;           /* Wheel under benchmark */
+static Prng_t TimerWheelBenchmark_Prng;                  /* Generator of the expiries and operations */
+static TimerWheel_TimeUs_t TimerWheelBenchmark_Now = 0U; /* Virtual time */
+static bool TimerWheelBenchmark_Rearm = true;            /* Whether expired timers are armed again */
+static uint32_t TimerWheelBenchmark_WrongTicks = 0U;     /* Number of timers expired in another tick than expected */
+static uint32_t TimerWheelBenchmark_Unexpected = 0U;     /* Number of timers expired while not armed in the reference model */
+static uint32_t TimerWheelBenchmark_WrongCancels = 0U;   /* Number of cancels disagreeing with the reference model */
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t timerCount = TIMERWHEELBENCHMARK_DEFAULT_TIMERS;
+    uint32_t seconds = TIMERWHEELBENCHMARK_DEFAULT_SECONDS;
+    uint32_t seed = TIMERWHEELBENCHMARK_DEFAULT_SEED;
+    TimerWheelBenchmark_Timer_t *timers;
+    TimerWheelBenchmark_Costs_t costs = {0};
+    TimerWheelBenchmark_Timer_t *timer;
+    TimerWheel_TimeUs_t end;
+    TimerWheel_TimeUs_t next;
+    Benchmark_TimeNs_t overheadNs = Benchmark_GetTimerOverheadNs();
+    Benchmark_TimeNs_t startNs;
+    Benchmark_TimeNs_t elapsedNs;
+    TimerWheel_TimeUs_t expiry;
+    uint32_t maxOperations;
+    uint32_t expired;
+    bool cancelled;
+    uint32_t drainSteps = 0U;
+    uint32_t leftArmed = 0U;
+    int status = EXIT_SUCCESS;
+
+    if (argc > 1)
+    {
+        timerCount = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        seconds = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3)
+    {
+        seed = (uint32_t)strtoul(argv[3], NULL, 0);
+    }
+    if (timerCount == 0U)
+    {
+        timerCount = TIMERWHEELBENCHMARK_DEFAULT_TIMERS;
+    }
+    if (seconds == 0U)
+    {
+        seconds = TIMERWHEELBENCHMARK_DEFAULT_SECONDS;
+    }
+
+    /* The shortest step bounds the number of operations */
+    end = (TimerWheel_TimeUs_t)seconds * TIMERWHEELBENCHMARK_US_PER_S;
+    maxOperations = (uint32_t)((end / TIMERWHEELBENCHMARK_MIN_STEP_US + 1U) * TIMERWHEELBENCHMARK_OPERATIONS_PER_STEP);
+
+    timers = malloc((size_t)timerCount * sizeof(TimerWheelBenchmark_Timer_t));
+    costs.ArmNs = malloc((size_t)maxOperations * sizeof(Benchmark_TimeNs_t));
+    costs.CancelNs = malloc((size_t)maxOperations * sizeof(Benchmark_TimeNs_t));
+    if (timers == NULL || costs.ArmNs == NULL || costs.CancelNs == NULL)
+    {
+        printf("Failed to allocate timers\n");
+        free(timers);
+        free(costs.ArmNs);
+        free(costs.CancelNs);
+        return EXIT_FAILURE;
+    }
+
+    printf("TimerWheel benchmark: %" PRIu32 " timers, %" PRIu32 " s, seed %" PRIu32 ", %u us ticks, %u levels of %u slots\n", timerCount, seconds, seed, TIMERWHEELBENCHMARK_TICK_US, TIMERWHEEL_LEVELS,
+           TIMERWHEEL_SLOTS);
+
+    Prng_Seed(&TimerWheelBenchmark_Prng, seed, 0U);
+    (void)TimerWheel_Init(&TimerWheelBenchmark_Wheel, TIMERWHEELBENCHMARK_TICK_US, TimerWheelBenchmark_Now);
+    for (uint32_t index = 0U; index < timerCount; index++)
+    {
+        TimerWheel_InitTimer(&timers[index].Timer, TimerWheelBenchmark_Expire, &timers[index]);
+        (void)TimerWheel_Arm(&TimerWheelBenchmark_Wheel, &timers[index].Timer, TimerWheelBenchmark_Expect(&timers[index]));
+    }
+
+    /* Run with every timer armed, expired timers are armed again by their callbacks */
+    while (TimerWheelBenchmark_Now < end)
+    {
+        for (uint32_t operation = 0U; operation < TIMERWHEELBENCHMARK_OPERATIONS_PER_STEP; operation++)
+        {
+            timer = &timers[Prng_Bounded(&TimerWheelBenchmark_Prng, timerCount)];
+
+            if (Prng_Bounded(&TimerWheelBenchmark_Prng, TIMERWHEELBENCHMARK_PERCENT) < TIMERWHEELBENCHMARK_CANCEL_PERCENT)
+            {
+                startNs = Benchmark_GetTimeNs();
+                cancelled = TimerWheel_Cancel(&TimerWheelBenchmark_Wheel, &timer->Timer);
+                elapsedNs = Benchmark_GetTimeNs() - startNs;
+                costs.CancelNs[costs.Cancels++] = (elapsedNs > overheadNs) ? (elapsedNs - overheadNs) : 0U;
+
+                if (cancelled != timer->Armed)
+                {
+                    TimerWheelBenchmark_WrongCancels++;
+                }
+                timer->Armed = false;
+            }
+
+            expiry = TimerWheelBenchmark_Expect(timer);
+            startNs = Benchmark_GetTimeNs();
+            (void)TimerWheel_Arm(&TimerWheelBenchmark_Wheel, &timer->Timer, expiry);
+            elapsedNs = Benchmark_GetTimeNs() - startNs;
+            costs.ArmNs[costs.Arms++] = (elapsedNs > overheadNs) ? (elapsedNs - overheadNs) : 0U;
+        }
+
+        TimerWheelBenchmark_Now += TIMERWHEELBENCHMARK_MIN_STEP_US + Prng_Bounded(&TimerWheelBenchmark_Prng, TIMERWHEELBENCHMARK_STEP_RANGE_US);
+
+        startNs = Benchmark_GetTimeNs();
+        expired = TimerWheel_Advance(&TimerWheelBenchmark_Wheel, TimerWheelBenchmark_Now);
+        costs.AdvanceNs += Benchmark_GetTimeNs() - startNs;
+        costs.Expired += expired;
+    }
+
+    /* Drain, sleeping until each time the wheel reports it needs to be advanced */
+    TimerWheelBenchmark_Rearm = false;
+    next = TimerWheel_GetNextExpiry(&TimerWheelBenchmark_Wheel);
+    while (next != TIMERWHEEL_NEVER)
+    {
+        TimerWheelBenchmark_Now = next;
+        (void)TimerWheel_Advance(&TimerWheelBenchmark_Wheel, TimerWheelBenchmark_Now);
+        next = TimerWheel_GetNextExpiry(&TimerWheelBenchmark_Wheel);
+        drainSteps++;
+    }
+
+    for (uint32_t index = 0U; index < timerCount; index++)
+    {
+        if (timers[index].Armed || timers[index].Timer.Armed)
+        {
+            leftArmed++;
+        }
+    }
+
+    printf("  Timers:              %" PRIu32 " armed, %" PRIu32 " cancelled, %" PRIu32 " expired, %" PRIu32 " moved down a level\n", TimerWheelBenchmark_Wheel.Stats.Armed,
+           TimerWheelBenchmark_Wheel.Stats.Cancelled, TimerWheelBenchmark_Wheel.Stats.Expired, TimerWheelBenchmark_Wheel.Stats.Cascaded);
+    printf("  Drain:               %" PRIu32 " advances to %.1f s\n", drainSteps, (double)TimerWheelBenchmark_Now / TIMERWHEELBENCHMARK_US_PER_S);
+    TimerWheelBenchmark_PrintCost("Arm", costs.ArmNs, costs.Arms);
+    TimerWheelBenchmark_PrintCost("Cancel", costs.CancelNs, costs.Cancels);
+    printf("  Advance cost:        %.1f ns per timer expired, including arming it again (%" PRIu64 " expired)\n", (costs.Expired > 0U) ? ((double)costs.AdvanceNs / costs.Expired) : 0.0, costs.Expired);
+    printf("  Errors:              %" PRIu32 " wrong ticks, %" PRIu32 " unexpected, %" PRIu32 " wrong cancels, %" PRIu32 " left armed\n", TimerWheelBenchmark_WrongTicks, TimerWheelBenchmark_Unexpected,
+           TimerWheelBenchmark_WrongCancels, leftArmed);
+
+    if (TimerWheelBenchmark_WrongTicks > 0U || TimerWheelBenchmark_Unexpected > 0U || TimerWheelBenchmark_WrongCancels > 0U || leftArmed > 0U || TimerWheelBenchmark_Wheel.Count != 0U)
+    {
+        printf("  FAILED: timers differ from the reference model\n");
+        status = EXIT_FAILURE;
+    }
+
+    free(timers);
+    free(costs.ArmNs);
+    free(costs.CancelNs);
+
+    return status;
+}
+
+/**
+ * @brief Draw a random expiry of a timer about to be armed and record the tick
+ * it must expire in: its expiry rounded up to a tick, or the next tick if the
+ * wheel has already run the tick its expiry rounds up to.
+ *
+ * @param[in,out] timer Timer about to be armed
+ *
+ * @return Expiry to arm the timer at
+ ******************************************************************************/
+static TimerWheel_TimeUs_t TimerWheelBenchmark_Expect(TimerWheelBenchmark_Timer_t *const timer)
+{
+    TimerWheel_TimeUs_t expiry = TimerWheelBenchmark_Now + TimerWheelBenchmark_RandomDelay();
+
+    timer->ExpectedTick = (expiry + TIMERWHEELBENCHMARK_TICK_US - 1U) / TIMERWHEELBENCHMARK_TICK_US;
+    if (timer->ExpectedTick <= TimerWheelBenchmark_Wheel.Tick)
+    {
+        timer->ExpectedTick = TimerWheelBenchmark_Wheel.Tick + 1U;
+    }
+    timer->Armed = true;
+
+    return expiry;
+}
+
+/**
+ * @brief Timer callback.  Checks the timer expired in the expected tick and
+ * arms it again while the run lasts.
+ *
+ * @param[in] context Timer expired
+ ******************************************************************************/
+static void TimerWheelBenchmark_Expire(void *const context)
+{
+    TimerWheelBenchmark_Timer_t *timer = (TimerWheelBenchmark_Timer_t *)context;
+
+    if (!timer->Armed)
+    {
+        TimerWheelBenchmark_Unexpected++;
+    }
+    else if (TimerWheelBenchmark_Wheel.Tick != timer->ExpectedTick)
+    {
+        TimerWheelBenchmark_WrongTicks++;
+    }
+    timer->Armed = false;
+
+    if (TimerWheelBenchmark_Rearm)
+    {
+        (void)TimerWheel_Arm(&TimerWheelBenchmark_Wheel, &timer->Timer, TimerWheelBenchmark_Expect(timer));
+    }
+}
+
+/**
+ * @brief Draw a random delay of a timer, mostly short, sometimes within the
+ * span of the wheel and rarely beyond it.
+ *
+ * @return Random delay
+ ******************************************************************************/
+static TimerWheel_TimeUs_t TimerWheelBenchmark_RandomDelay(void)
+{
+    uint32_t permille = Prng_Bounded(&TimerWheelBenchmark_Prng, TIMERWHEELBENCHMARK_PERMILLE);
+    uint64_t range = TIMERWHEELBENCHMARK_SHORT_US;
+    uint64_t random = ((uint64_t)Prng_Next(&TimerWheelBenchmark_Prng) << 32U) | Prng_Next(&TimerWheelBenchmark_Prng);
+
+    if (permille < TIMERWHEELBENCHMARK_LONG_PERMILLE)
+    {
+        range = TIMERWHEELBENCHMARK_LONG_US;
+    }
+    else if (permille < TIMERWHEELBENCHMARK_LONG_PERMILLE + TIMERWHEELBENCHMARK_MEDIUM_PERMILLE)
+    {
+        range = TIMERWHEELBENCHMARK_MEDIUM_US;
+    }
+
+    return random % range;
+}
+
+/**
+ * @brief Print the mean, 99th percentile and worst cost of an operation.
+ * Sorts the costs.
+ *
+ * @param[in]     name    Name of the operation
+ * @param[in,out] costsNs Cost of every call of the operation
+ * @param[in]     count   Number of calls
+ ******************************************************************************/
+static void TimerWheelBenchmark_PrintCost(const char *const name, Benchmark_TimeNs_t *const costsNs, const uint32_t count)
+{
+    Benchmark_TimeNs_t totalNs = 0U;
+
+    if (count > 0U)
+    {
+        for (uint32_t index = 0U; index < count; index++)
+        {
+            totalNs += costsNs[index];
+        }
+        qsort(costsNs, count, sizeof(Benchmark_TimeNs_t), TimerWheelBenchmark_CompareNs);
+
+        printf("  %-6s cost:         mean %.1f ns, p99 %" PRIu64 " ns, max %" PRIu64 " ns over %" PRIu32 " calls\n", name, (double)totalNs / count,
+               costsNs[((uint64_t)count * TIMERWHEELBENCHMARK_P99_PERMILLE) / TIMERWHEELBENCHMARK_PERMILLE], costsNs[count - 1U], count);
+    }
+}
+
+/**
+ * @brief Compare two times for qsort.
+ *
+ * @param[in] a First time
+ * @param[in] b Second time
+ *
+ * @return Negative, zero or positive if a is less than, equal to or greater
+ * than b
+ ******************************************************************************/
+static int TimerWheelBenchmark_CompareNs(const void *a, const void *b)
+{
+    const Benchmark_TimeNs_t timeA = *(const Benchmark_TimeNs_t *)a;
+    const Benchmark_TimeNs_t timeB = *(const Benchmark_TimeNs_t *)b;
+
+    return (timeA > timeB) - (timeA < timeB);
+}
@@ -0,0 +1,411 @@
+/**
+ * @file TraceReplay.c
+ *
+ * @brief Deterministic replay of recorded BopIt games.  Reads a trace, a
+ * sequence of LogRing_Record_t written by the engine to a game's trace ring,
+ * and replays each game in it through BopIt_Run as fast as possible.  The
+ * replayed game's clock and inputs are driven from the trace, and the trace
+ * records written by the replayed game are compared against the recording, so
+ * every command issued, state change, score and lives must match.
+ *
+ * Games using BOPIT_SELECTION_WEIGHTED cannot be replayed since the trace does
+ * not include the command weights.
+ *
+ * Exits with a failure status if the trace contains no games, any game cannot
+ * be replayed, or any replayed game differs from the recording.
+ *
+ * Usage: TraceReplay <trace file> [repeats]
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "BopIt.h"
+#include "LogRing.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define TRACEREPLAY_DEFAULT_REPEATS 1U     /* Number of times the trace is replayed if not specified */
+#define TRACEREPLAY_RING_SIZE 16U          /* Number of records the replayed game's trace ring can hold, drained after every call to BopIt_Run */
+#define TRACEREPLAY_PRNG_INCREMENT 1U      /* Increment of every game's generator, BopIt seeds all games with the same sequence */
+#define TRACEREPLAY_NS_PER_S 1000000000.0  /* Nanoseconds per second */
+#define TRACEREPLAY_HALF_WORD_MASK 0xFFFFU /* Mask of the selection mode in the low half word of the last argument of a game start record */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Recorded trace and the replay's position in it */
+typedef struct
+{
+    const LogRing_Record_t *Records; /* Recorded trace records */
+    uint32_t Count;                  /* Number of recorded trace records */
+    uint32_t Next;                   /* Index of the next record to compare against */
+    BopIt_TimeUs_t Time;             /* Time returned to the replayed game */
+    BopIt_Inputs_t Inputs;           /* Inputs returned to the replayed game by its next check for inputs */
+    BopIt_TimeUs_t InputTime;        /* Time of the inputs returned to the replayed game */
+} TraceReplay_Trace_t;
+
+/* Result of replaying a game */
+typedef enum
+{
+    TRACEREPLAY_RESULT_MATCH,       /* Replayed game matches the recording */
+    TRACEREPLAY_RESULT_MISMATCH,    /* Replayed game differs from the recording */
+    TRACEREPLAY_RESULT_UNSUPPORTED, /* Game cannot be replayed */
+} TraceReplay_Result_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static TraceReplay_Result_t TraceReplay_Game(TraceReplay_Trace_t *const trace);
+static bool TraceReplay_Compare(TraceReplay_Trace_t *const trace);
+static BopIt_TimeUs_t TraceReplay_WidenTime(const BopIt_TimeUs_t previousTime, const uint32_t recordedTime);
+static BopIt_TimeUs_t TraceReplay_Time(const BopIt_GameContext_t *const gameContext);
+static BopIt_Inputs_t TraceReplay_GetInputs(BopIt_GameContext_t *const gameContext, BopIt_TimeUs_t *const inputTime);
+static void TraceReplay_Logger(const BopIt_GameContext_t *const gameContext, const char *const message);
+static bool TraceReplay_GetInput(BopIt_TimeUs_t *const inputTime);
+static void TraceReplay_Command(void);
+
+/* Globals
+ ******************************************************************************/
+
+static BopIt_Command_t TraceReplay_ReplayedCommand = {"Replayed command", TraceReplay_Command, TraceReplay_Command, TraceReplay_Command, TraceReplay_GetInput, NULL, 0U};
+static BopIt_Command_t *TraceReplay_Commands[BOPIT_MAX_INPUTS];
+
+static LogRing_Record_t TraceReplay_Records[TRACEREPLAY_RING_SIZE]; /* Storage for the replayed game's trace ring */
+static LogRing_t TraceReplay_Ring;                                  /* Ring the replayed game writes trace records to */
+
+static BopIt_GameContext_t TraceReplay_GameContext = {
+    .Commands = TraceReplay_Commands,
+    .CommandCount = 0U,
+    .GetInputs = TraceReplay_GetInputs,
+    .Time = TraceReplay_Time,
+    .Selection = BOPIT_SELECTION_UNIFORM,
+    .Curve = BOPIT_CURVE_LINEAR,
+    .CommandWeights = NULL,
+    .Logger = TraceReplay_Logger,
+    .LogRing = NULL,
+    .TraceRing = &TraceReplay_Ring,
+    .Reactions = NULL,
+    .UserData = NULL,
+    .OnGameStart = NULL,
+    .OnGameEnd = NULL,
+};
+
+/* Function Definitions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    TraceReplay_Trace_t trace = {0};
+    LogRing_Record_t *records = NULL;
+    uint32_t repeats = TRACEREPLAY_DEFAULT_REPEATS;
+    uint64_t games = 0U;
+    uint64_t mismatches = 0U;
+    uint64_t unsupported = 0U;
+    uint64_t skipped = 0U;
+    long size;
+    int status = EXIT_SUCCESS;
+
+    if (argc < 2)
+    {
+        printf("Usage: TraceReplay <trace file> [repeats]\n");
+        return EXIT_FAILURE;
+    }
+    if (argc > 2)
+    {
+        repeats = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (repeats == 0U)
+    {
+        repeats = TRACEREPLAY_DEFAULT_REPEATS;
+    }
+
+    FILE *traceFile = fopen(argv[1], "rb");
+    if (traceFile == NULL)
+    {
+        printf("Failed to open trace file %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    /* Load the whole trace so reading the file is not part of the measurement */
+    fseek(traceFile, 0, SEEK_END);
+    size = ftell(traceFile);
+    fseek(traceFile, 0, SEEK_SET);
+    if (size > 0)
+    {
+        records = malloc((size_t)size);
+    }
+    if (records == NULL || fread(records, 1U, (size_t)size, traceFile) != (size_t)size)
+    {
+        printf("Failed to read trace file %s\n", argv[1]);
+        fclose(traceFile);
+        free(records);
+        return EXIT_FAILURE;
+    }
+    fclose(traceFile);
+
+    if (((size_t)size % sizeof(LogRing_Record_t)) != 0U)
+    {
+        printf("Trace ends in a partial record, ignoring it\n");
+    }
+
+    for (uint32_t command = 0U; command < BOPIT_MAX_INPUTS; command++)
+    {
+        TraceReplay_Commands[command] = &TraceReplay_ReplayedCommand;
+    }
+    LogRing_Init(&TraceReplay_Ring, TraceReplay_Records, TRACEREPLAY_RING_SIZE);
+    TraceReplay_GameContext.UserData = &trace;
+    trace.Records = records;
+    trace.Count = (uint32_t)((size_t)size / sizeof(LogRing_Record_t));
+
+    Benchmark_TimeNs_t start = Benchmark_GetTimeNs();
+    for (uint32_t repeat = 0U; repeat < repeats; repeat++)
+    {
+        trace.Next = 0U;
+
+        while (trace.Next < trace.Count)
+        {
+            if (trace.Records[trace.Next].FormatId != BOPIT_TRACEID_GAME_START)
+            {
+                /* Records of a game whose start was not recorded */
+                trace.Next++;
+                skipped++;
+                continue;
+            }
+
+            switch (TraceReplay_Game(&trace))
+            {
+            case TRACEREPLAY_RESULT_MATCH:
+                break;
+            case TRACEREPLAY_RESULT_MISMATCH:
+                if (mismatches == 0U)
+                {
+                    printf("First mismatch at record %" PRIu32 "\n", trace.Next);
+                }
+                mismatches++;
+                break;
+            default:
+                unsupported++;
+                break;
+            }
+            games++;
+        }
+    }
+    Benchmark_TimeNs_t replayTime = Benchmark_GetTimeNs() - start;
+
+    printf("BopIt trace replay: %" PRIu32 " records, %" PRIu32 " repeats\n", trace.Count, repeats);
+    printf("  Games replayed:      %" PRIu64 "\n", games);
+    printf("  Mismatched games:    %" PRIu64 "\n", mismatches);
+    printf("  Unsupported games:   %" PRIu64 "\n", unsupported);
+    printf("  Records skipped:     %" PRIu64 "\n", skipped);
+    printf("  Replay time:         %.3f ms\n", (double)replayTime / 1e6);
+    printf("  Games/sec:           %.0f\n", (replayTime > 0U) ? ((double)games * TRACEREPLAY_NS_PER_S / (double)replayTime) : 0.0);
+
+    if (games == 0U || mismatches > 0U || unsupported > 0U)
+    {
+        printf("FAIL: trace could not be replayed exactly\n");
+        status = EXIT_FAILURE;
+    }
+
+    free(records);
+
+    return status;
+}
+
+/**
+ * @brief Replay the game starting at the next record of a trace.  The clock
+ * and inputs of the replayed game are set from the recorded records the engine
+ * writes when reading them, and each record the replayed game writes is
+ * compared against the recording.  Stops at the first difference.
+ *
+ * @param[in,out] trace Recorded trace, positioned at the start of a game
+ *
+ * @return Result of replaying the game
+ ******************************************************************************/
+static TraceReplay_Result_t TraceReplay_Game(TraceReplay_Trace_t *const trace)
+{
+    BopIt_GameContext_t *gameContext = &TraceReplay_GameContext;
+    const LogRing_Record_t *start = &trace->Records[trace->Next];
+    const LogRing_Record_t *next;
+    TraceReplay_Result_t result = TRACEREPLAY_RESULT_MATCH;
+    BopIt_GameState_t state;
+
+    if (start->Args[2U] > BOPIT_MAX_INPUTS || (start->Args[3U] & TRACEREPLAY_HALF_WORD_MASK) == BOPIT_SELECTION_WEIGHTED)
+    {
+        trace->Next++;
+        result = TRACEREPLAY_RESULT_UNSUPPORTED;
+    }
+    else
+    {
+        BopIt_Init(gameContext);
+        gameContext->CommandCount = start->Args[2U];
+        gameContext->Selection = (BopIt_Selection_t)(start->Args[3U] & TRACEREPLAY_HALF_WORD_MASK);
+        gameContext->Curve = (BopIt_Curve_t)(start->Args[3U] >> 16U);
+        gameContext->Prng.State = (uint64_t)start->Args[0U] | ((uint64_t)start->Args[1U] << 32U);
+        gameContext->Prng.Increment = TRACEREPLAY_PRNG_INCREMENT;
+        trace->Time = 0U;
+        trace->Inputs = 0U;
+
+        do
+        {
+            state = gameContext->GameState;
+
+            /* Time and inputs matter only in the states that read them, and only
+               the check that ended a wait was recorded */
+            next = (trace->Next < trace->Count) ? &trace->Records[trace->Next] : NULL;
+            if (state == BOPIT_GAMESTATE_COMMAND && next != NULL && next->FormatId == BOPIT_TRACEID_COMMAND)
+            {
+                trace->Time = TraceReplay_WidenTime(trace->Time, next->Time);
+            }
+            else if (state == BOPIT_GAMESTATE_WAIT && next != NULL && next->FormatId == BOPIT_TRACEID_WAIT_END)
+            {
+                trace->Time = TraceReplay_WidenTime(trace->Time, next->Time);
+                trace->Inputs = (BopIt_Inputs_t)next->Args[0U] | ((BopIt_Inputs_t)next->Args[1U] << 32U);
+                trace->InputTime = trace->Time - (uint32_t)((uint32_t)trace->Time - next->Args[2U]);
+            }
+            else if (state == BOPIT_GAMESTATE_COMMAND || state == BOPIT_GAMESTATE_WAIT)
+            {
+                result = TRACEREPLAY_RESULT_MISMATCH;
+            }
+
+            if (result == TRACEREPLAY_RESULT_MATCH)
+            {
+                BopIt_Run(gameContext);
+
+                if (!TraceReplay_Compare(trace))
+                {
+                    result = TRACEREPLAY_RESULT_MISMATCH;
+                }
+            }
+        } while (state != BOPIT_GAMESTATE_END && result == TRACEREPLAY_RESULT_MATCH);
+
+        if (result == TRACEREPLAY_RESULT_MISMATCH)
+        {
+            /* Resynchronize at the next game */
+            while (trace->Next < trace->Count && trace->Records[trace->Next].FormatId != BOPIT_TRACEID_GAME_START)
+            {
+                trace->Next++;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Compare the records written by the replayed game since the last
+ * comparison against the next records of the recording.
+ *
+ * @param[in,out] trace Recorded trace
+ *
+ * @return Whether all records matched or not
+ ******************************************************************************/
+static bool TraceReplay_Compare(TraceReplay_Trace_t *const trace)
+{
+    LogRing_Record_t record;
+    bool match = true;
+
+    while (LogRing_Read(&TraceReplay_Ring, &record))
+    {
+        if (match && trace->Next < trace->Count && memcmp(&record, &trace->Records[trace->Next], sizeof(record)) == 0)
+        {
+            trace->Next++;
+        }
+        else
+        {
+            match = false;
+        }
+    }
+
+    return match;
+}
+
+/**
+ * @brief Widen a recorded time, the low 32 bits of the game's time, to the
+ * full time.  Records are in time order and never more than 32 bits of
+ * microseconds apart, so the time is the first after the previous one with the
+ * recorded low bits.
+ *
+ * @param[in] previousTime Full time of the previous record
+ * @param[in] recordedTime Recorded low bits of the time
+ *
+ * @return Full time of the record
+ ******************************************************************************/
+static BopIt_TimeUs_t TraceReplay_WidenTime(const BopIt_TimeUs_t previousTime, const uint32_t recordedTime)
+{
+    return previousTime + (uint32_t)(recordedTime - (uint32_t)previousTime);
+}
+
+/**
+ * @brief Get the time of the replayed game, set from the recording.
+ *
+ * @param[in] gameContext Context for the replayed game
+ *
+ * @return Recorded time in microseconds
+ ******************************************************************************/
+static BopIt_TimeUs_t TraceReplay_Time(const BopIt_GameContext_t *const gameContext)
+{
+    return ((const TraceReplay_Trace_t *)gameContext->UserData)->Time;
+}
+
+/**
+ * @brief Get the recorded inputs that ended the replayed game's wait.
+ *
+ * @param[in]  gameContext Context for the replayed game
+ * @param[out] inputTime   Recorded time of the inputs
+ *
+ * @return Bitmask of the recorded inputs
+ ******************************************************************************/
+static BopIt_Inputs_t TraceReplay_GetInputs(BopIt_GameContext_t *const gameContext, BopIt_TimeUs_t *const inputTime)
+{
+    TraceReplay_Trace_t *trace = (TraceReplay_Trace_t *)gameContext->UserData;
+    BopIt_Inputs_t inputs = trace->Inputs;
+
+    if (inputs != 0U)
+    {
+        *inputTime = trace->InputTime;
+        trace->Inputs = 0U;
+    }
+
+    return inputs;
+}
+
+/**
+ * @brief Discard log messages of the replayed game.
+ *
+ * @param[in] gameContext Unused
+ * @param[in] message     Unused
+ ******************************************************************************/
+static void TraceReplay_Logger(const BopIt_GameContext_t *const gameContext, const char *const message)
+{
+    (void)gameContext;
+    (void)message;
+}
+
+/**
+ * @brief Input of a single command, never used since the replayed game has an
+ * input provider.
+ *
+ * @param[out] inputTime Unused
+ *
+ * @return false
+ ******************************************************************************/
+static bool TraceReplay_GetInput(BopIt_TimeUs_t *const inputTime)
+{
+    (void)inputTime;
+
+    return false;
+}
+
+/**
+ * @brief Command callbacks of the replayed game, do nothing.
+ ******************************************************************************/
+static void TraceReplay_Command(void)
+{
+}
@@ -0,0 +1,65 @@
+/**
+ * @file VirtualClock.c
+ *
+ * @brief Deterministic virtual clock for running BopIt games on a host.  Time
+ * only moves when explicitly advanced, so games run as fast as the host allows
+ * and produce the same results on every run.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "VirtualClock.h"
+
+/* Globals
+ ******************************************************************************/
+
+static BopIt_TimeUs_t VirtualClock_Time = 0U; /* Current virtual time in microseconds */
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Set the current virtual time.
+ *
+ * @param[in] time Virtual time in microseconds
+ ******************************************************************************/
+void VirtualClock_Set(const BopIt_TimeUs_t time)
+{
+    VirtualClock_Time = time;
+}
+
+/**
+ * @brief Advance the virtual time.
+ *
+ * @param[in] time Number of microseconds to advance the virtual time by
+ ******************************************************************************/
+void VirtualClock_Advance(const BopIt_TimeUs_t time)
+{
+    VirtualClock_Time += time;
+}
+
+/**
+ * @brief Get the current virtual time.
+ *
+ * @return Current virtual time in microseconds
+ ******************************************************************************/
+BopIt_TimeUs_t VirtualClock_GetTime(void)
+{
+    return VirtualClock_Time;
+}
+
+/**
+ * @brief Get the current virtual time for a game.  Can be used as the time
+ * function of a game context.
+ *
+ * @param[in] gameContext Context for a BopIt game, unused
+ *
+ * @return Current virtual time in microseconds
+ ******************************************************************************/
+BopIt_TimeUs_t VirtualClock_GetGameTime(const BopIt_GameContext_t *const gameContext)
+{
+    (void)gameContext;
+
+    return VirtualClock_Time;
+}
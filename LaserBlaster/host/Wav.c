@@ -0,0 +1,266 @@
+/**
+ * @file Wav.c
+ *
+ * @brief Reading and writing of signed 16 bit mono PCM WAV files.  Samples
+ * are read and written in host byte order, which must be little-endian like
+ * the WAV format.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Wav.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define WAV_RIFF_HEADER_SIZE 12U /* Size of the RIFF header, "RIFF", size and "WAVE" */
+#define WAV_CHUNK_HEADER_SIZE 8U /* Size of a chunk header, its ID and size */
+#define WAV_FMT_SIZE 16U         /* Size of a PCM fmt chunk */
+#define WAV_HEADER_SIZE 44U      /* Size of everything before the samples of a written file */
+#define WAV_FORMAT_PCM 1U        /* Format of integer PCM samples */
+#define WAV_CHANNELS 1U          /* Number of channels */
+#define WAV_BITS_PER_SAMPLE 16U  /* Bits per sample */
+#define WAV_SAMPLE_SIZE 2U       /* Size of a sample in bytes */
+#define WAV_RIFF_SIZE_OFFSET 4U  /* Offset of the size of the RIFF chunk */
+#define WAV_DATA_SIZE_OFFSET 40U /* Offset of the size of the data chunk of a written file */
+#define WAV_ID_SIZE 4U           /* Size of a chunk ID */
+#define WAV_BITS_PER_BYTE 8U     /* Number of bits in a byte */
+#define WAV_BYTE_MASK 0xFFU      /* Mask of a byte */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void Wav_PutU16(uint8_t *const bytes, const uint32_t value);
+static void Wav_PutU32(uint8_t *const bytes, const uint32_t value);
+static uint32_t Wav_GetU16(const uint8_t *const bytes);
+static uint32_t Wav_GetU32(const uint8_t *const bytes);
+static bool Wav_PatchU32(FILE *const file, const long offset, const uint32_t value);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Read all samples of a WAV file.  Only signed 16 bit mono PCM files
+ * are supported.
+ *
+ * @param[in]  path        Path of the file
+ * @param[out] samples     Samples of the file, allocated with malloc and to be
+ * freed by the caller, only written if the file was read
+ * @param[out] sampleCount Number of samples
+ * @param[out] sampleRate  Sample rate in Hz
+ *
+ * @return Whether the file was read or not
+ ******************************************************************************/
+bool Wav_Read(const char *const path, int16_t **const samples, uint32_t *const sampleCount, uint32_t *const sampleRate)
+{
+    FILE *file = NULL;
+    uint8_t header[WAV_RIFF_HEADER_SIZE];
+    uint8_t fmt[WAV_FMT_SIZE];
+    int16_t *buffer;
+    uint32_t chunkSize;
+    uint32_t rate = 0U;
+    bool formatValid = false;
+    bool dataFound = false;
+    bool read = false;
+
+    if (path != NULL && samples != NULL && sampleCount != NULL && sampleRate != NULL)
+    {
+        file = fopen(path, "rb");
+    }
+
+    if (file != NULL)
+    {
+        if (fread(header, sizeof(header), 1U, file) == 1U && memcmp(header, "RIFF", WAV_ID_SIZE) == 0 && memcmp(&header[2U * WAV_ID_SIZE], "WAVE", WAV_ID_SIZE) == 0)
+        {
+            /* Chunks are padded to an even size */
+            while (!dataFound && fread(header, WAV_CHUNK_HEADER_SIZE, 1U, file) == 1U)
+            {
+                chunkSize = Wav_GetU32(&header[WAV_ID_SIZE]);
+
+                if (memcmp(header, "fmt ", WAV_ID_SIZE) == 0 && chunkSize >= WAV_FMT_SIZE && fread(fmt, sizeof(fmt), 1U, file) == 1U)
+                {
+                    formatValid = Wav_GetU16(&fmt[0U]) == WAV_FORMAT_PCM && Wav_GetU16(&fmt[2U]) == WAV_CHANNELS && Wav_GetU16(&fmt[14U]) == WAV_BITS_PER_SAMPLE;
+                    rate = Wav_GetU32(&fmt[4U]);
+                    fseek(file, (long)((chunkSize - WAV_FMT_SIZE) + (chunkSize & 1U)), SEEK_CUR);
+                }
+                else if (memcmp(header, "data", WAV_ID_SIZE) == 0 && formatValid)
+                {
+                    dataFound = true;
+                    buffer = malloc((chunkSize > 0U) ? chunkSize : 1U);
+                    if (buffer != NULL && fread(buffer, WAV_SAMPLE_SIZE, chunkSize / WAV_SAMPLE_SIZE, file) == (chunkSize / WAV_SAMPLE_SIZE))
+                    {
+                        *samples = buffer;
+                        *sampleCount = chunkSize / WAV_SAMPLE_SIZE;
+                        *sampleRate = rate;
+                        read = true;
+                    }
+                    else
+                    {
+                        free(buffer);
+                    }
+                }
+                else
+                {
+                    fseek(file, (long)(chunkSize + (chunkSize & 1U)), SEEK_CUR);
+                }
+            }
+        }
+
+        fclose(file);
+    }
+
+    return read;
+}
+
+/**
+ * @brief Create a WAV file to write samples to.  Sizes in the header are
+ * filled in when the file is closed.
+ *
+ * @param[out] writer     Writer of the file
+ * @param[in]  path       Path of the file
+ * @param[in]  sampleRate Sample rate in Hz
+ *
+ * @return Whether the file was created or not
+ ******************************************************************************/
+bool Wav_Create(Wav_Writer_t *const writer, const char *const path, const uint32_t sampleRate)
+{
+    uint8_t header[WAV_HEADER_SIZE];
+    bool created = false;
+
+    if (writer != NULL && path != NULL)
+    {
+        memcpy(&header[0U], "RIFF", WAV_ID_SIZE);
+        Wav_PutU32(&header[4U], 0U);
+        memcpy(&header[8U], "WAVE", WAV_ID_SIZE);
+        memcpy(&header[12U], "fmt ", WAV_ID_SIZE);
+        Wav_PutU32(&header[16U], WAV_FMT_SIZE);
+        Wav_PutU16(&header[20U], WAV_FORMAT_PCM);
+        Wav_PutU16(&header[22U], WAV_CHANNELS);
+        Wav_PutU32(&header[24U], sampleRate);
+        Wav_PutU32(&header[28U], sampleRate * WAV_CHANNELS * WAV_SAMPLE_SIZE);
+        Wav_PutU16(&header[32U], WAV_CHANNELS * WAV_SAMPLE_SIZE);
+        Wav_PutU16(&header[34U], WAV_BITS_PER_SAMPLE);
+        memcpy(&header[36U], "data", WAV_ID_SIZE);
+        Wav_PutU32(&header[40U], 0U);
+
+        writer->File = fopen(path, "wb");
+        writer->SampleCount = 0U;
+        created = writer->File != NULL && fwrite(header, sizeof(header), 1U, writer->File) == 1U;
+    }
+
+    return created;
+}
+
+/**
+ * @brief Append samples to a WAV file.
+ *
+ * @param[in,out] writer      Writer of the file
+ * @param[in]     samples     Samples to append
+ * @param[in]     sampleCount Number of samples
+ *
+ * @return Whether the samples were written or not
+ ******************************************************************************/
+bool Wav_Write(Wav_Writer_t *const writer, const int16_t *const samples, const uint32_t sampleCount)
+{
+    bool written = false;
+
+    if (writer != NULL && writer->File != NULL && (samples != NULL || sampleCount == 0U))
+    {
+        written = fwrite(samples, WAV_SAMPLE_SIZE, sampleCount, writer->File) == sampleCount;
+        writer->SampleCount += sampleCount;
+    }
+
+    return written;
+}
+
+/**
+ * @brief Fill in the sizes in the header of a WAV file and close it.
+ *
+ * @param[in,out] writer Writer of the file
+ *
+ * @return Whether the file was completed or not
+ ******************************************************************************/
+bool Wav_Close(Wav_Writer_t *const writer)
+{
+    uint32_t dataSize;
+    bool closed = false;
+
+    if (writer != NULL && writer->File != NULL)
+    {
+        dataSize = writer->SampleCount * WAV_SAMPLE_SIZE;
+        closed = Wav_PatchU32(writer->File, WAV_RIFF_SIZE_OFFSET, (WAV_HEADER_SIZE - WAV_CHUNK_HEADER_SIZE) + dataSize) && Wav_PatchU32(writer->File, WAV_DATA_SIZE_OFFSET, dataSize);
+        closed = (fclose(writer->File) == 0) && closed;
+        writer->File = NULL;
+    }
+
+    return closed;
+}
+
+/**
+ * @brief Store a little-endian 16 bit field.
+ *
+ * @param[out] bytes First byte of the field
+ * @param[in]  value Value of the field, truncated to 16 bits
+ ******************************************************************************/
+static void Wav_PutU16(uint8_t *const bytes, const uint32_t value)
+{
+    bytes[0U] = (uint8_t)(value & WAV_BYTE_MASK);
+    bytes[1U] = (uint8_t)((value >> WAV_BITS_PER_BYTE) & WAV_BYTE_MASK);
+}
+
+/**
+ * @brief Store a little-endian 32 bit field.
+ *
+ * @param[out] bytes First byte of the field
+ * @param[in]  value Value of the field
+ ******************************************************************************/
+static void Wav_PutU32(uint8_t *const bytes, const uint32_t value)
+{
+    Wav_PutU16(bytes, value);
+    Wav_PutU16(&bytes[2U], value >> (2U * WAV_BITS_PER_BYTE));
+}
+
+/**
+ * @brief Load a little-endian 16 bit field.
+ *
+ * @param[in] bytes First byte of the field
+ *
+ * @return Value of the field
+ ******************************************************************************/
+static uint32_t Wav_GetU16(const uint8_t *const bytes)
+{
+    return (uint32_t)bytes[0U] | ((uint32_t)bytes[1U] << WAV_BITS_PER_BYTE);
+}
+
+/**
+ * @brief Load a little-endian 32 bit field.
+ *
+ * @param[in] bytes First byte of the field
+ *
+ * @return Value of the field
+ ******************************************************************************/
+static uint32_t Wav_GetU32(const uint8_t *const bytes)
+{
+    return Wav_GetU16(bytes) | (Wav_GetU16(&bytes[2U]) << (2U * WAV_BITS_PER_BYTE));
+}
+
+/**
+ * @brief Overwrite a little-endian 32 bit field of a file.
+ *
+ * @param[in,out] file   File to write to
+ * @param[in]     offset Offset of the field
+ * @param[in]     value  Value of the field
+ *
+ * @return Whether the field was written or not
+ ******************************************************************************/
+static bool Wav_PatchU32(FILE *const file, const long offset, const uint32_t value)
+{
+    uint8_t bytes[sizeof(uint32_t)];
+
+    Wav_PutU32(bytes, value);
+
+    return fseek(file, offset, SEEK_SET) == 0 && fwrite(bytes, sizeof(bytes), 1U, file) == 1U;
+}
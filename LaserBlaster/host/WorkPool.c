@@ -0,0 +1,237 @@
+/**
+ * @file WorkPool.c
+ *
+ * @brief Work stealing thread pool for host simulations.
+ *
+ * The range of items left to each worker is packed into a single atomic 64-bit
+ * word, begin in the low half and end in the high half.  The owner advances
+ * begin and thieves lower end, both with a compare and swap of the whole word,
+ * so no item is ever processed twice or lost.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "WorkPool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define WORKPOOL_PACK(begin, end) (((uint64_t)(end) << 32U) | (uint64_t)(begin)) /* Pack a range into a word */
+#define WORKPOOL_BEGIN(range) ((uint32_t)(range))                                /* Get the begin of a packed range */
+#define WORKPOOL_END(range) ((uint32_t)((range) >> 32U))                          /* Get the end of a packed range */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Pool shared by all workers */
+typedef struct WorkPool_Pool WorkPool_Pool_t;
+
+/* State of a single worker */
+typedef struct
+{
+    _Alignas(64) _Atomic uint64_t Range; /* Packed range of items left to the worker, on its own cache line */
+    WorkPool_Pool_t *Pool;               /* Pool the worker belongs to */
+    uint32_t Index;                      /* Index of the worker */
+    WorkPool_Stats_t Stats;              /* Statistics of the worker */
+} WorkPool_Worker_t;
+
+struct WorkPool_Pool
+{
+    WorkPool_Worker_t Workers[WORKPOOL_MAX_WORKERS]; /* State of each worker */
+    uint32_t WorkerCount;                            /* Number of workers */
+    uint32_t Chunk;                                  /* Number of items a worker takes from its own range at a time */
+    WorkPool_Function_t Function;                    /* Function processing items */
+    void *Context;                                   /* Context passed to the function */
+};
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void *WorkPool_Thread(void *arg);
+static bool WorkPool_Take(WorkPool_Worker_t *const worker, uint32_t *const begin, uint32_t *const end);
+static bool WorkPool_Steal(WorkPool_Worker_t *const worker);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Process a range of work items on a pool of worker threads and wait
+ * for all of them to be processed.  The function is called with disjoint
+ * ranges of items covering [0, items) exactly once, and with the index of the
+ * worker calling it so results can be accumulated per worker without locks.
+ *
+ * @param[in]  workers  Number of worker threads
+ * @param[in]  items    Number of work items
+ * @param[in]  chunk    Number of items a worker takes from its own range at a
+ *                      time, 1 if 0
+ * @param[in]  function Function processing items
+ * @param[in]  context  Context passed to the function
+ * @param[out] stats    Optional statistics of each worker, an array of
+ *                      workers entries
+ *
+ * @return Whether the items were processed or not
+ *
+ * @retval true All items were processed
+ * @retval false The number of workers was not valid, function was NULL, or a
+ * thread could not be created
+ ******************************************************************************/
+bool WorkPool_Run(const uint32_t workers, const uint32_t items, const uint32_t chunk, const WorkPool_Function_t function, void *const context, WorkPool_Stats_t *const stats)
+{
+    WorkPool_Pool_t pool;
+    pthread_t threads[WORKPOOL_MAX_WORKERS];
+    uint32_t started = 0U;
+    bool processed = false;
+
+    if (workers > 0U && workers <= WORKPOOL_MAX_WORKERS && function != NULL)
+    {
+        pool.WorkerCount = workers;
+        pool.Chunk = (chunk > 0U) ? chunk : 1U;
+        pool.Function = function;
+        pool.Context = context;
+
+        for (uint32_t worker = 0U; worker < workers; worker++)
+        {
+            uint32_t begin = (uint32_t)(((uint64_t)items * worker) / workers);
+            uint32_t end = (uint32_t)(((uint64_t)items * (worker + 1U)) / workers);
+
+            atomic_init(&pool.Workers[worker].Range, WORKPOOL_PACK(begin, end));
+            pool.Workers[worker].Pool = &pool;
+            pool.Workers[worker].Index = worker;
+            pool.Workers[worker].Stats = (WorkPool_Stats_t){0};
+        }
+
+        while (started < workers && pthread_create(&threads[started], NULL, WorkPool_Thread, &pool.Workers[started]) == 0)
+        {
+            started++;
+        }
+
+        /* Items of workers that failed to start are stolen by the others */
+        for (uint32_t worker = 0U; worker < started; worker++)
+        {
+            pthread_join(threads[worker], NULL);
+        }
+
+        if (stats != NULL)
+        {
+            for (uint32_t worker = 0U; worker < workers; worker++)
+            {
+                stats[worker] = pool.Workers[worker].Stats;
+            }
+        }
+
+        processed = (started == workers);
+    }
+
+    return processed;
+}
+
+/**
+ * @brief Worker thread.  Processes chunks of its own range, then steals from
+ * other workers until no work is left anywhere.
+ *
+ * @param[in] arg Worker
+ *
+ * @return NULL
+ ******************************************************************************/
+static void *WorkPool_Thread(void *arg)
+{
+    WorkPool_Worker_t *worker = (WorkPool_Worker_t *)arg;
+    WorkPool_Pool_t *pool = worker->Pool;
+    uint32_t begin;
+    uint32_t end;
+
+    do
+    {
+        while (WorkPool_Take(worker, &begin, &end))
+        {
+            (*pool->Function)(pool->Context, worker->Index, begin, end);
+            worker->Stats.Items += end - begin;
+        }
+    } while (WorkPool_Steal(worker));
+
+    return NULL;
+}
+
+/**
+ * @brief Take a chunk of items from the front of a worker's own range.
+ *
+ * @param[in,out] worker Worker taking items
+ * @param[out]    begin  First item taken
+ * @param[out]    end    One past the last item taken
+ *
+ * @return Whether any items were taken or not
+ ******************************************************************************/
+static bool WorkPool_Take(WorkPool_Worker_t *const worker, uint32_t *const begin, uint32_t *const end)
+{
+    uint64_t range = atomic_load_explicit(&worker->Range, memory_order_acquire);
+    uint32_t rangeBegin;
+    uint32_t rangeEnd;
+    bool taken = false;
+
+    do
+    {
+        rangeBegin = WORKPOOL_BEGIN(range);
+        rangeEnd = WORKPOOL_END(range);
+        if (rangeBegin >= rangeEnd)
+        {
+            break;
+        }
+
+        *begin = rangeBegin;
+        *end = ((rangeEnd - rangeBegin) > worker->Pool->Chunk) ? (rangeBegin + worker->Pool->Chunk) : rangeEnd;
+        taken = atomic_compare_exchange_weak_explicit(&worker->Range, &range, WORKPOOL_PACK(*end, rangeEnd), memory_order_acq_rel, memory_order_acquire);
+    } while (!taken);
+
+    return taken;
+}
+
+/**
+ * @brief Steal the back half of another worker's range into a worker's own,
+ * empty range.  Victims are tried in turn starting after the thief.
+ *
+ * @param[in,out] worker Worker stealing items
+ *
+ * @return Whether any items were stolen or not, false if no work is left
+ ******************************************************************************/
+static bool WorkPool_Steal(WorkPool_Worker_t *const worker)
+{
+    WorkPool_Pool_t *pool = worker->Pool;
+    WorkPool_Worker_t *victim;
+    uint64_t range;
+    uint32_t rangeBegin;
+    uint32_t rangeEnd;
+    uint32_t middle;
+    bool stolen = false;
+
+    for (uint32_t offset = 1U; offset < pool->WorkerCount && !stolen; offset++)
+    {
+        victim = &pool->Workers[(worker->Index + offset) % pool->WorkerCount];
+        range = atomic_load_explicit(&victim->Range, memory_order_acquire);
+
+        do
+        {
+            rangeBegin = WORKPOOL_BEGIN(range);
+            rangeEnd = WORKPOOL_END(range);
+            if (rangeBegin >= rangeEnd)
+            {
+                break;
+            }
+
+            /* Leave the front half, which the victim is about to work on */
+            middle = rangeBegin + ((rangeEnd - rangeBegin) / 2U);
+            stolen = atomic_compare_exchange_weak_explicit(&victim->Range, &range, WORKPOOL_PACK(rangeBegin, middle), memory_order_acq_rel, memory_order_acquire);
+        } while (!stolen);
+
+        if (stolen)
+        {
+            atomic_store_explicit(&worker->Range, WORKPOOL_PACK(middle, rangeEnd), memory_order_release);
+            worker->Stats.Steals++;
+        }
+    }
+
+    return stolen;
+}
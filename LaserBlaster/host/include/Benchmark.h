@@ -0,0 +1,36 @@
+/**
+ * @file Benchmark.h
+ *
+ * @brief Timing and allocation counting helpers for host benchmarks.
+ *
+ ******************************************************************************/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef uint64_t Benchmark_TimeNs_t; /* Time in nanoseconds */
+
+/* Allocations counted since the last call to Benchmark_ResetAllocations */
+typedef struct
+{
+    uint64_t Allocations; /* Number of calls to malloc, calloc and realloc */
+    uint64_t Frees;       /* Number of calls to free with a non-NULL pointer */
+    uint64_t Bytes;       /* Total number of bytes requested */
+} Benchmark_Allocations_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+Benchmark_TimeNs_t Benchmark_GetTimeNs(void);
+Benchmark_TimeNs_t Benchmark_GetTimerOverheadNs(void);
+void Benchmark_ResetAllocations(void);
+Benchmark_Allocations_t Benchmark_GetAllocations(void);
+
+#endif
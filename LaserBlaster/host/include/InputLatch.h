@@ -0,0 +1,212 @@
+/**
+ * @file InputLatch.h
+ *
+ * @brief Lock-free latch for passing inputs from ISRs to a consumer.  Each
+ * input is a bit in a bitmask that producers set and the consumer clears with
+ * a single atomic operation, so inputs are never lost to lock contention.
+ * Only used by the host benchmarks, the firmware passes inputs to the game
+ * through the event bus.
+ *
+ * Each input can also carry the time at which it was made, so the consumer can
+ * judge inputs by when they happened rather than when they were taken.
+ *
+ * Functions are inline so they can be called from ISRs placed in IRAM.
+ *
+ ******************************************************************************/
+
+#ifndef INPUT_LATCH_H
+#define INPUT_LATCH_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define INPUTLATCH_MAX_INPUTS 32U /* Number of inputs a latch can hold, one per bit of InputLatch_Inputs_t */
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef uint32_t InputLatch_Inputs_t; /* Bitmask of inputs, one bit per input */
+typedef uint32_t InputLatch_Time_t;   /* Time at which an input was made, in units chosen by the client */
+
+/* Latch storing inputs that have not been consumed yet */
+typedef struct
+{
+    _Atomic InputLatch_Inputs_t Inputs;                     /* Inputs set and not yet taken */
+    _Atomic InputLatch_Time_t Times[INPUTLATCH_MAX_INPUTS]; /* Time at which each input was first set since it was last taken */
+} InputLatch_t;
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize a latch with no inputs set.
+ *
+ * @param[out] latch Latch to initialize
+ ******************************************************************************/
+static inline void InputLatch_Init(InputLatch_t *const latch)
+{
+    atomic_init(&latch->Inputs, 0U);
+
+    for (uint32_t inputIndex = 0U; inputIndex < INPUTLATCH_MAX_INPUTS; inputIndex++)
+    {
+        atomic_init(&latch->Times[inputIndex], 0U);
+    }
+}
+
+/**
+ * @brief Set inputs in a latch.  Safe to call from an ISR.
+ *
+ * @param[in,out] latch  Latch to set the inputs in
+ * @param[in]     inputs Inputs to set
+ *
+ * @return Whether the inputs were newly set or not
+ *
+ * @retval true None of the inputs were already set
+ * @retval false At least one of the inputs was already set and had not been
+ * taken, so it was coalesced with the previous input
+ ******************************************************************************/
+static inline bool InputLatch_Set(InputLatch_t *const latch, const InputLatch_Inputs_t inputs)
+{
+    return (atomic_fetch_or(&latch->Inputs, inputs) & inputs) == 0U;
+}
+
+/**
+ * @brief Set a single input in a latch along with the time it was made.  If
+ * the input is already set, the time of the earlier input is kept.  Safe to
+ * call from an ISR, but only one producer may set a given input.
+ *
+ * @note An input made while the consumer is taking the same input may be
+ * reported with the time of the input being taken.
+ *
+ * @param[in,out] latch      Latch to set the input in
+ * @param[in]     inputIndex Index of the input to set, less than
+ * INPUTLATCH_MAX_INPUTS
+ * @param[in]     time       Time at which the input was made
+ *
+ * @return Whether the input was newly set or not
+ *
+ * @retval true The input was not already set
+ * @retval false The input was already set and had not been taken, so it was
+ * coalesced with the previous input
+ ******************************************************************************/
+static inline bool InputLatch_SetAt(InputLatch_t *const latch, const uint32_t inputIndex, const InputLatch_Time_t time)
+{
+    InputLatch_Inputs_t input = (InputLatch_Inputs_t)1U << inputIndex;
+
+    /* Publish the time before the input so the consumer never sees the input without its time */
+    if ((atomic_load(&latch->Inputs) & input) == 0U)
+    {
+        atomic_store(&latch->Times[inputIndex], time);
+    }
+
+    return InputLatch_Set(latch, input);
+}
+
+/**
+ * @brief Get the inputs set in a latch without taking them.  Safe to call from
+ * an ISR.
+ *
+ * @param[in] latch Latch to get the inputs of
+ *
+ * @return Inputs set and not yet taken
+ ******************************************************************************/
+static inline InputLatch_Inputs_t InputLatch_GetPending(InputLatch_t *const latch)
+{
+    return atomic_load(&latch->Inputs);
+}
+
+/**
+ * @brief Take inputs from a latch.  Clears the given inputs and returns the
+ * ones that were set.
+ *
+ * @param[in,out] latch  Latch to take the inputs from
+ * @param[in]     inputs Inputs to take
+ *
+ * @return Inputs that were set
+ ******************************************************************************/
+static inline InputLatch_Inputs_t InputLatch_Take(InputLatch_t *const latch, const InputLatch_Inputs_t inputs)
+{
+    return atomic_fetch_and(&latch->Inputs, ~inputs) & inputs;
+}
+
+/**
+ * @brief Take a single input from a latch along with the time it was made.
+ *
+ * @param[in,out] latch      Latch to take the input from
+ * @param[in]     inputIndex Index of the input to take, less than
+ * INPUTLATCH_MAX_INPUTS
+ * @param[out]    time       Time at which the input was made, only written if
+ * the input was set
+ *
+ * @return Whether the input was set or not
+ ******************************************************************************/
+static inline bool InputLatch_TakeAt(InputLatch_t *const latch, const uint32_t inputIndex, InputLatch_Time_t *const time)
+{
+    bool input = InputLatch_Take(latch, (InputLatch_Inputs_t)1U << inputIndex) != 0U;
+
+    if (input)
+    {
+        *time = atomic_load(&latch->Times[inputIndex]);
+    }
+
+    return input;
+}
+
+/**
+ * @brief Take all inputs from a latch.
+ *
+ * @param[in,out] latch Latch to take the inputs from
+ *
+ * @return Inputs that were set
+ ******************************************************************************/
+static inline InputLatch_Inputs_t InputLatch_TakeAll(InputLatch_t *const latch)
+{
+    return atomic_exchange(&latch->Inputs, 0U);
+}
+
+/**
+ * @brief Take all inputs from a latch along with the time the earliest of them
+ * was made.
+ *
+ * @param[in,out] latch Latch to take the inputs from
+ * @param[out]    time  Time at which the earliest input was made, only written
+ * if any inputs were set
+ *
+ * @return Inputs that were set
+ ******************************************************************************/
+static inline InputLatch_Inputs_t InputLatch_TakeAllAt(InputLatch_t *const latch, InputLatch_Time_t *const time)
+{
+    InputLatch_Inputs_t inputs = InputLatch_TakeAll(latch);
+    InputLatch_Inputs_t remaining = inputs;
+    InputLatch_Time_t inputTime;
+    uint32_t inputIndex = 0U;
+    bool first = true;
+
+    while (remaining != 0U)
+    {
+        if ((remaining & 1U) != 0U)
+        {
+            inputTime = atomic_load(&latch->Times[inputIndex]);
+
+            /* Compare by difference so times that wrap around are ordered correctly */
+            if (first || (int32_t)(inputTime - *time) < 0)
+            {
+                *time = inputTime;
+                first = false;
+            }
+        }
+
+        remaining >>= 1U;
+        inputIndex++;
+    }
+
+    return inputs;
+}
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * @file LinkChannel.h
+ *
+ * @brief In-process broadcast channel for running many blasters' GameLinks in
+ * one host process.  Frames sent by an endpoint are delivered to every other
+ * endpoint after a random delay on a simulated clock, like a radio.  Frames
+ * from one endpoint to another are delivered in the order they were sent, as
+ * a single radio's transmit queue does.
+ *
+ ******************************************************************************/
+
+#ifndef LINK_CHANNEL_H
+#define LINK_CHANNEL_H
+
+/* Includes
+ ******************************************************************************/
+#include "Prng.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define LINKCHANNEL_MAX_ENDPOINTS 16U   /* Most endpoints on a channel */
+#define LINKCHANNEL_MAX_FRAME_SIZE 250U /* Largest frame */
+#define LINKCHANNEL_CAPACITY 1024U      /* Most frames in flight */
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef struct LinkChannel LinkChannel_t; /* Broadcast channel */
+
+/* Endpoint of a channel, the context of LinkChannel_Send */
+typedef struct
+{
+    LinkChannel_t *Channel; /* Channel the endpoint is on */
+    uint32_t Index;         /* Index of the endpoint */
+} LinkChannel_Endpoint_t;
+
+/* Frame in flight to an endpoint */
+typedef struct
+{
+    uint32_t Endpoint;                        /* Index of the endpoint the frame is delivered to */
+    uint64_t DeliverUs;                       /* Time the frame is delivered */
+    uint32_t Size;                            /* Size of the frame in bytes */
+    uint8_t Data[LINKCHANNEL_MAX_FRAME_SIZE]; /* Frame */
+} LinkChannel_Frame_t;
+
+/* Called for every frame delivered */
+typedef void (*LinkChannel_Receive_t)(void *const context, const uint32_t endpoint, const uint8_t *const frame, const uint32_t size, const uint64_t timeUs);
+
+struct LinkChannel
+{
+    LinkChannel_Endpoint_t Endpoints[LINKCHANNEL_MAX_ENDPOINTS];                  /* Endpoints on the channel */
+    uint32_t EndpointCount;                                                       /* Number of endpoints */
+    uint64_t TimeUs;                                                              /* Current simulated time, set by the client before sending */
+    uint32_t BaseDelayUs;                                                         /* Shortest delay of a frame */
+    uint32_t JitterUs;                                                            /* Range of the random delay added to each frame */
+    Prng_t Prng;                                                                  /* Generator of the delays */
+    uint64_t LastDeliverUs[LINKCHANNEL_MAX_ENDPOINTS][LINKCHANNEL_MAX_ENDPOINTS]; /* Delivery time of the last frame from each endpoint to each other endpoint */
+    LinkChannel_Frame_t Frames[LINKCHANNEL_CAPACITY];                             /* Frames in flight, unordered */
+    uint32_t FrameCount;                                                          /* Number of frames in flight */
+    uint32_t Overflows;                                                           /* Number of frames dropped because too many were in flight */
+};
+
+/* Function Prototypes
+ ******************************************************************************/
+
+bool LinkChannel_Init(LinkChannel_t *const channel, const uint32_t endpointCount, const uint32_t baseDelayUs, const uint32_t jitterUs, const uint64_t seed);
+bool LinkChannel_Send(void *const context, const uint8_t *const frame, const uint32_t size);
+uint32_t LinkChannel_Deliver(LinkChannel_t *const channel, const uint64_t untilUs, const LinkChannel_Receive_t receive, void *const context);
+
+#endif
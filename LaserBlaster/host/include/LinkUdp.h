@@ -0,0 +1,38 @@
+/**
+ * @file LinkUdp.h
+ *
+ * @brief UDP loopback transport for GameLink on a host.  Each endpoint binds a
+ * port on 127.0.0.1, and a broadcast is sent to the ports of every other
+ * endpoint, so blasters can run in one process or in several.
+ *
+ ******************************************************************************/
+
+#ifndef LINK_UDP_H
+#define LINK_UDP_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Endpoint bound to a loopback port, the context of LinkUdp_Send */
+typedef struct
+{
+    int Socket;             /* Non-blocking socket bound to the endpoint's port */
+    uint16_t BasePort;      /* Port of the first endpoint, endpoints use consecutive ports */
+    uint32_t EndpointCount; /* Number of endpoints */
+    uint32_t Index;         /* Index of this endpoint */
+} LinkUdp_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+bool LinkUdp_Open(LinkUdp_t *const udp, const uint16_t basePort, const uint32_t endpointCount, const uint32_t index);
+bool LinkUdp_Send(void *const context, const uint8_t *const frame, const uint32_t size);
+uint32_t LinkUdp_Receive(LinkUdp_t *const udp, uint8_t *const buffer, const uint32_t size);
+void LinkUdp_Close(LinkUdp_t *const udp);
+
+#endif
@@ -0,0 +1,33 @@
+/**
+ * @file MappedFile.h
+ *
+ * @brief Read-only memory mapped files, standing in on the host for flash
+ * partitions mapped with esp_partition_mmap.
+ *
+ ******************************************************************************/
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+/* File mapped into memory */
+typedef struct
+{
+    const void *Data; /* Contents of the file */
+    size_t Size;      /* Size of the file in bytes */
+} MappedFile_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+bool MappedFile_Open(MappedFile_t *const file, const char *const path);
+void MappedFile_Close(MappedFile_t *const file);
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * @file VirtualClock.h
+ *
+ * @brief Deterministic virtual clock for running BopIt games on a host.
+ *
+ ******************************************************************************/
+
+#ifndef VIRTUAL_CLOCK_H
+#define VIRTUAL_CLOCK_H
+
+/* Includes
+ ******************************************************************************/
+#include "BopIt.h"
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void VirtualClock_Set(const BopIt_TimeUs_t time);
+void VirtualClock_Advance(const BopIt_TimeUs_t time);
+BopIt_TimeUs_t VirtualClock_GetTime(void);
+BopIt_TimeUs_t VirtualClock_GetGameTime(const BopIt_GameContext_t *const gameContext);
+
+#endif
@@ -0,0 +1,35 @@
+/**
+ * @file Wav.h
+ *
+ * @brief Reading and writing of signed 16 bit mono PCM WAV files.
+ *
+ ******************************************************************************/
+
+#ifndef WAV_H
+#define WAV_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+/* WAV file being written */
+typedef struct
+{
+    FILE *File;           /* File being written */
+    uint32_t SampleCount; /* Number of samples written so far */
+} Wav_Writer_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+bool Wav_Read(const char *const path, int16_t **const samples, uint32_t *const sampleCount, uint32_t *const sampleRate);
+bool Wav_Create(Wav_Writer_t *const writer, const char *const path, const uint32_t sampleRate);
+bool Wav_Write(Wav_Writer_t *const writer, const int16_t *const samples, const uint32_t sampleCount);
+bool Wav_Close(Wav_Writer_t *const writer);
+
+#endif
@@ -0,0 +1,43 @@
+/**
+ * @file WorkPool.h
+ *
+ * @brief Work stealing thread pool for host simulations.  Splits a range of
+ * independent work items evenly across worker threads.  Each worker takes
+ * chunks from the front of its own range, and a worker that runs out steals
+ * the back half of another worker's range, so workers stay busy even if items
+ * take very different amounts of time.
+ *
+ ******************************************************************************/
+
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define WORKPOOL_MAX_WORKERS 64U /* Maximum number of worker threads */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Function processing the work items in [begin, end) on a worker */
+typedef void (*WorkPool_Function_t)(void *const context, const uint32_t worker, const uint32_t begin, const uint32_t end);
+
+/* Statistics of a single worker */
+typedef struct
+{
+    uint64_t Items;  /* Number of work items processed by the worker */
+    uint64_t Steals; /* Number of times the worker stole work from another worker */
+} WorkPool_Stats_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+bool WorkPool_Run(const uint32_t workers, const uint32_t items, const uint32_t chunk, const WorkPool_Function_t function, void *const context, WorkPool_Stats_t *const stats);
+
+#endif
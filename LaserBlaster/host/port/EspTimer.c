@@ -0,0 +1,281 @@
+/**
+ * @file EspTimer.c
+ *
+ * @brief Host implementation of the subset of the ESP-IDF high resolution
+ * timer API used by the firmware, on top of the FreeRTOS POSIX port.
+ *
+ * Timers are serviced by a task at the highest priority.  The task blocks on
+ * the FreeRTOS tick until the earliest deadline is less than two ticks away,
+ * then spins on the monotonic clock so callbacks run with sub-tick accuracy,
+ * similar to the hardware timer on the target.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stddef.h>
+#include <time.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define ESPTIMER_MAX_TIMERS 16U                                       /* Maximum number of timers that can be created */
+#define ESPTIMER_TASK_STACK_DEPTH (configMINIMAL_STACK_SIZE * 2U)     /* Stack depth for the timer task */
+#define ESPTIMER_TASK_PRIORITY (configMAX_PRIORITIES - 1U)            /* Priority for the timer task */
+#define ESPTIMER_US_PER_S 1000000LL                                   /* Microseconds per second */
+#define ESPTIMER_NS_PER_US 1000LL                                     /* Nanoseconds per microsecond */
+#define ESPTIMER_US_PER_TICK (ESPTIMER_US_PER_S / configTICK_RATE_HZ) /* Microseconds per FreeRTOS tick */
+#define ESPTIMER_SPIN_TICKS 2LL                                       /* Spin instead of block when the deadline is this many ticks away */
+
+/* Typedefs
+ ******************************************************************************/
+
+struct esp_timer
+{
+    esp_timer_cb_t Callback; /* Function to call when the timer expires */
+    void *Arg;               /* Argument to pass to the callback */
+    int64_t Deadline;        /* Time in microseconds at which the timer expires */
+    int64_t Period;          /* Period in microseconds of a periodic timer, 0 for a one-shot timer */
+    bool Armed;              /* Whether the timer is running */
+};
+
+/* Globals
+ ******************************************************************************/
+
+static struct esp_timer EspTimer_Timers[ESPTIMER_MAX_TIMERS]; /* Storage for timers */
+static uint32_t EspTimer_TimerCount = 0U;                     /* Number of timers created */
+static TaskHandle_t EspTimer_TaskHandle = NULL;               /* Handle of the task servicing timers */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void EspTimer_Task(void *arg);
+static struct esp_timer *EspTimer_GetNextTimer(void);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Create a timer.  Starts the timer task when the first timer is
+ * created.
+ *
+ * @param[in]  create_args Timer configuration
+ * @param[out] out_handle  Handle of the created timer
+ *
+ * @return ESP_OK on success, error code otherwise
+ ******************************************************************************/
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    esp_err_t error = ESP_ERR_INVALID_ARG;
+
+    if (create_args != NULL && create_args->callback != NULL && out_handle != NULL)
+    {
+        error = ESP_ERR_NO_MEM;
+
+        taskENTER_CRITICAL();
+        if (EspTimer_TimerCount < ESPTIMER_MAX_TIMERS)
+        {
+            *out_handle = &EspTimer_Timers[EspTimer_TimerCount];
+            (*out_handle)->Callback = create_args->callback;
+            (*out_handle)->Arg = create_args->arg;
+            (*out_handle)->Armed = false;
+            EspTimer_TimerCount++;
+            error = ESP_OK;
+        }
+        taskEXIT_CRITICAL();
+
+        if (error == ESP_OK && EspTimer_TaskHandle == NULL)
+        {
+            xTaskCreate(EspTimer_Task, "EspTimer_Task", ESPTIMER_TASK_STACK_DEPTH, NULL, ESPTIMER_TASK_PRIORITY, &EspTimer_TaskHandle);
+        }
+    }
+
+    return error;
+}
+
+/**
+ * @brief Start a one-shot timer.
+ *
+ * @param[in] timer      Handle of the timer to start
+ * @param[in] timeout_us Time in microseconds until the timer expires
+ *
+ * @return ESP_OK on success, error code otherwise
+ ******************************************************************************/
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    esp_err_t error = ESP_ERR_INVALID_ARG;
+
+    if (timer != NULL)
+    {
+        error = ESP_ERR_INVALID_STATE;
+
+        taskENTER_CRITICAL();
+        if (!timer->Armed)
+        {
+            timer->Deadline = esp_timer_get_time() + (int64_t)timeout_us;
+            timer->Period = 0;
+            timer->Armed = true;
+            error = ESP_OK;
+        }
+        taskEXIT_CRITICAL();
+
+        if (error == ESP_OK)
+        {
+            xTaskNotifyGive(EspTimer_TaskHandle);
+        }
+    }
+
+    return error;
+}
+
+/**
+ * @brief Start a periodic timer.  The first expiry is one period from now.
+ *
+ * @param[in] timer  Handle of the timer to start
+ * @param[in] period Period of the timer in microseconds
+ *
+ * @return ESP_OK on success, error code otherwise
+ ******************************************************************************/
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    esp_err_t error = ESP_ERR_INVALID_ARG;
+
+    if (timer != NULL && period > 0U)
+    {
+        error = ESP_ERR_INVALID_STATE;
+
+        taskENTER_CRITICAL();
+        if (!timer->Armed)
+        {
+            timer->Deadline = esp_timer_get_time() + (int64_t)period;
+            timer->Period = (int64_t)period;
+            timer->Armed = true;
+            error = ESP_OK;
+        }
+        taskEXIT_CRITICAL();
+
+        if (error == ESP_OK)
+        {
+            xTaskNotifyGive(EspTimer_TaskHandle);
+        }
+    }
+
+    return error;
+}
+
+/**
+ * @brief Stop a timer.
+ *
+ * @param[in] timer Handle of the timer to stop
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the timer is not running
+ ******************************************************************************/
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    esp_err_t error = ESP_ERR_INVALID_ARG;
+
+    if (timer != NULL)
+    {
+        taskENTER_CRITICAL();
+        error = timer->Armed ? ESP_OK : ESP_ERR_INVALID_STATE;
+        timer->Armed = false;
+        taskEXIT_CRITICAL();
+    }
+
+    return error;
+}
+
+/**
+ * @brief Get the time since the host booted.
+ *
+ * @return Time in microseconds
+ ******************************************************************************/
+int64_t esp_timer_get_time(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return ((int64_t)time.tv_sec * ESPTIMER_US_PER_S) + ((int64_t)time.tv_nsec / ESPTIMER_NS_PER_US);
+}
+
+/**
+ * @brief Task servicing timers.  Calls the callback of each timer when it
+ * expires.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void EspTimer_Task(void *arg)
+{
+    struct esp_timer *timer;
+    esp_timer_cb_t callback;
+    void *callbackArg;
+    int64_t remaining;
+
+    (void)arg;
+
+    for (;;)
+    {
+        callback = NULL;
+        callbackArg = NULL;
+        remaining = 0;
+
+        taskENTER_CRITICAL();
+        timer = EspTimer_GetNextTimer();
+        if (timer != NULL)
+        {
+            remaining = timer->Deadline - esp_timer_get_time();
+            if (remaining <= 0)
+            {
+                /* Periodic timers are rearmed from their deadline so they do not drift */
+                timer->Deadline += timer->Period;
+                timer->Armed = (timer->Period > 0);
+                callback = timer->Callback;
+                callbackArg = timer->Arg;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if (callback != NULL)
+        {
+            (*callback)(callbackArg);
+        }
+        else if (timer == NULL)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        else if (remaining > (ESPTIMER_SPIN_TICKS * ESPTIMER_US_PER_TICK))
+        {
+            ulTaskNotifyTake(pdTRUE, (TickType_t)((remaining / ESPTIMER_US_PER_TICK) - ESPTIMER_SPIN_TICKS + 1LL));
+        }
+        else
+        {
+            /* Deadline is less than two ticks away, spin for sub-tick accuracy */
+        }
+    }
+}
+
+/**
+ * @brief Get the running timer with the earliest deadline.  Must be called
+ * from a critical section.
+ *
+ * @return Running timer with the earliest deadline, NULL if no timer is
+ * running
+ ******************************************************************************/
+static struct esp_timer *EspTimer_GetNextTimer(void)
+{
+    struct esp_timer *nextTimer = NULL;
+
+    for (uint32_t timerIndex = 0U; timerIndex < EspTimer_TimerCount; timerIndex++)
+    {
+        if (EspTimer_Timers[timerIndex].Armed && (nextTimer == NULL || EspTimer_Timers[timerIndex].Deadline < nextTimer->Deadline))
+        {
+            nextTimer = &EspTimer_Timers[timerIndex];
+        }
+    }
+
+    return nextTimer;
+}
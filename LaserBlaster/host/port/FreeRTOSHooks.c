@@ -0,0 +1,60 @@
+/**
+ * @file FreeRTOSHooks.c
+ *
+ * @brief Application hooks required by the FreeRTOS kernel in the host build.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Called when a configASSERT fails.  Aborts the host process.
+ *
+ * @param[in] file File containing the failed assertion
+ * @param[in] line Line of the failed assertion
+ ******************************************************************************/
+void FreeRTOSHooks_AssertCalled(const char *const file, const unsigned long line)
+{
+    fprintf(stderr, "FreeRTOS assertion failed: %s:%lu\n", file, line);
+    abort();
+}
+
+#if (tskKERNEL_VERSION_MAJOR < 11)
+
+/**
+ * @brief Provide memory for the idle task.  Only needed by kernels that do
+ * not provide static memory for their own tasks.
+ ******************************************************************************/
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize)
+{
+    static StaticTask_t idleTaskTcb;
+    static StackType_t idleTaskStack[configMINIMAL_STACK_SIZE];
+
+    *ppxIdleTaskTCBBuffer = &idleTaskTcb;
+    *ppxIdleTaskStackBuffer = idleTaskStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+/**
+ * @brief Provide memory for the timer service task.  Only needed by kernels
+ * that do not provide static memory for their own tasks.
+ ******************************************************************************/
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize)
+{
+    static StaticTask_t timerTaskTcb;
+    static StackType_t timerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+    *ppxTimerTaskTCBBuffer = &timerTaskTcb;
+    *ppxTimerTaskStackBuffer = timerTaskStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
+#endif
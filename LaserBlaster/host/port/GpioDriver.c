@@ -0,0 +1,176 @@
+/**
+ * @file GpioDriver.c
+ *
+ * @brief Host implementation of the subset of the ESP-IDF GPIO driver used by
+ * the firmware, with simulated pins.
+ *
+ * ISR handlers are called from the task setting the level of a pin, which
+ * stands in for the interrupt.  That task should run at the highest priority,
+ * like the timer task, so handlers run as soon as an edge is simulated and are
+ * not preempted by the tasks they wake.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "GpioDriver.h"
+#include "hal/gpio_ll.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Simulated pin */
+typedef struct
+{
+    gpio_int_type_t IntrType; /* Edges the pin interrupts on */
+    gpio_isr_t Handler;       /* ISR handler added for the pin */
+    void *Arg;                /* Argument passed to the ISR handler */
+} GpioDriver_Pin_t;
+
+/* Globals
+ ******************************************************************************/
+
+gpio_dev_t GPIO; /* Levels of the simulated pins, read by gpio_ll_get_level */
+
+static GpioDriver_Pin_t GpioDriver_Pins[GPIO_NUM_MAX]; /* Configuration of each pin */
+static bool GpioDriver_IsrServiceInstalled = false;    /* Whether ISR handlers are called */
+static _Atomic uint32_t GpioDriver_Edges = 0U;         /* Number of level changes */
+static _Atomic uint32_t GpioDriver_Interrupts = 0U;    /* Number of ISR handlers called */
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Configure pins.  Pulled up pins idle high.
+ *
+ * @param[in] pGPIOConfig Pin configuration
+ *
+ * @return ESP_OK on success, error code otherwise
+ ******************************************************************************/
+esp_err_t gpio_config(const gpio_config_t *pGPIOConfig)
+{
+    esp_err_t error = ESP_ERR_INVALID_ARG;
+
+    if (pGPIOConfig != NULL)
+    {
+        for (uint32_t gpioNum = 0U; gpioNum < GPIO_NUM_MAX; gpioNum++)
+        {
+            if ((pGPIOConfig->pin_bit_mask & (1ULL << gpioNum)) != 0U)
+            {
+                GpioDriver_Pins[gpioNum].IntrType = pGPIOConfig->intr_type;
+                if (pGPIOConfig->pull_up_en == GPIO_PULLUP_ENABLE)
+                {
+                    atomic_fetch_or_explicit(&GPIO.Levels, 1ULL << gpioNum, memory_order_relaxed);
+                }
+                else
+                {
+                    atomic_fetch_and_explicit(&GPIO.Levels, ~(1ULL << gpioNum), memory_order_relaxed);
+                }
+            }
+        }
+        error = ESP_OK;
+    }
+
+    return error;
+}
+
+/**
+ * @brief Install the service calling the ISR handlers of pins.
+ *
+ * @param[in] intr_alloc_flags Unused on the host
+ *
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if already installed
+ ******************************************************************************/
+esp_err_t gpio_install_isr_service(int intr_alloc_flags)
+{
+    esp_err_t error = ESP_ERR_INVALID_STATE;
+
+    (void)intr_alloc_flags;
+
+    if (!GpioDriver_IsrServiceInstalled)
+    {
+        GpioDriver_IsrServiceInstalled = true;
+        error = ESP_OK;
+    }
+
+    return error;
+}
+
+/**
+ * @brief Add the ISR handler of a pin.
+ *
+ * @param[in] gpio_num    GPIO number of the pin
+ * @param[in] isr_handler Handler called on each edge the pin interrupts on
+ * @param[in] args        Argument passed to the handler
+ *
+ * @return ESP_OK on success, error code otherwise
+ ******************************************************************************/
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+{
+    esp_err_t error = ESP_ERR_INVALID_ARG;
+
+    if (!GpioDriver_IsrServiceInstalled)
+    {
+        error = ESP_ERR_INVALID_STATE;
+    }
+    else if (gpio_num >= 0 && gpio_num < GPIO_NUM_MAX && isr_handler != NULL)
+    {
+        GpioDriver_Pins[gpio_num].Arg = args;
+        GpioDriver_Pins[gpio_num].Handler = isr_handler;
+        error = ESP_OK;
+    }
+
+    return error;
+}
+
+/**
+ * @brief Set the level of a pin, as the outside world driving it.  Calls the
+ * pin's ISR handler if the change is an edge the pin interrupts on.
+ *
+ * @param[in] gpioNum GPIO number of the pin
+ * @param[in] level   Level of the pin, 0 or non-zero for 1
+ ******************************************************************************/
+void GpioDriver_SetLevel(const gpio_num_t gpioNum, const uint32_t level)
+{
+    uint64_t mask;
+    uint64_t levels;
+    bool rising;
+    GpioDriver_Pin_t *pin;
+
+    if (gpioNum >= 0 && gpioNum < GPIO_NUM_MAX)
+    {
+        mask = 1ULL << gpioNum;
+        levels = (level != 0U) ? atomic_fetch_or_explicit(&GPIO.Levels, mask, memory_order_relaxed) : atomic_fetch_and_explicit(&GPIO.Levels, ~mask, memory_order_relaxed);
+        pin = &GpioDriver_Pins[gpioNum];
+
+        if (((levels & mask) != 0U) != (level != 0U))
+        {
+            rising = level != 0U;
+            atomic_fetch_add_explicit(&GpioDriver_Edges, 1U, memory_order_relaxed);
+
+            if (GpioDriver_IsrServiceInstalled && pin->Handler != NULL &&
+                (pin->IntrType == GPIO_INTR_ANYEDGE || (pin->IntrType == GPIO_INTR_POSEDGE && rising) || (pin->IntrType == GPIO_INTR_NEGEDGE && !rising)))
+            {
+                atomic_fetch_add_explicit(&GpioDriver_Interrupts, 1U, memory_order_relaxed);
+                pin->Handler(pin->Arg);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Get the number of edges simulated and interrupts raised.
+ *
+ * @param[out] stats Edges and interrupts
+ ******************************************************************************/
+void GpioDriver_GetStats(GpioDriver_Stats_t *const stats)
+{
+    if (stats != NULL)
+    {
+        stats->Edges = atomic_load_explicit(&GpioDriver_Edges, memory_order_relaxed);
+        stats->Interrupts = atomic_load_explicit(&GpioDriver_Interrupts, memory_order_relaxed);
+    }
+}
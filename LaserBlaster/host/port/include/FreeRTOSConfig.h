@@ -0,0 +1,74 @@
+/**
+ * @file FreeRTOSConfig.h
+ *
+ * @brief FreeRTOS configuration for the host build using the FreeRTOS POSIX
+ * port.  Matches the ESP-IDF defaults the firmware relies on where possible,
+ * with a 1 kHz tick.
+ *
+ ******************************************************************************/
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* Includes
+ ******************************************************************************/
+#include <limits.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define configUSE_PREEMPTION 1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#define configUSE_IDLE_HOOK 0
+#define configUSE_TICK_HOOK 0
+#define configUSE_DAEMON_TASK_STARTUP_HOOK 0
+#define configTICK_RATE_HZ ((TickType_t)1000)
+#define configMAX_PRIORITIES 25
+#define configMINIMAL_STACK_SIZE ((unsigned short)PTHREAD_STACK_MIN)
+#define configSTACK_DEPTH_TYPE uint32_t
+#define configTOTAL_HEAP_SIZE ((size_t)(256U * 1024U))
+#define configMAX_TASK_NAME_LEN 32
+#define configUSE_TRACE_FACILITY 1
+#define configUSE_16_BIT_TICKS 0
+#define configIDLE_SHOULD_YIELD 1
+#define configUSE_MUTEXES 1
+#define configUSE_RECURSIVE_MUTEXES 1
+#define configUSE_COUNTING_SEMAPHORES 1
+#define configUSE_TASK_NOTIFICATIONS 1
+#define configQUEUE_REGISTRY_SIZE 0
+#define configCHECK_FOR_STACK_OVERFLOW 0
+#define configUSE_MALLOC_FAILED_HOOK 0
+#define configUSE_APPLICATION_TASK_TAG 0
+#define configGENERATE_RUN_TIME_STATS 0
+#define configSUPPORT_STATIC_ALLOCATION 1
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+#define configKERNEL_PROVIDED_STATIC_MEMORY 1
+
+#define configUSE_TIMERS 1
+#define configTIMER_TASK_PRIORITY (configMAX_PRIORITIES - 1)
+#define configTIMER_QUEUE_LENGTH 20
+#define configTIMER_TASK_STACK_DEPTH (configMINIMAL_STACK_SIZE * 2)
+
+#define INCLUDE_vTaskPrioritySet 1
+#define INCLUDE_uxTaskPriorityGet 1
+#define INCLUDE_vTaskDelete 1
+#define INCLUDE_vTaskSuspend 1
+#define INCLUDE_vTaskDelay 1
+#define INCLUDE_xTaskDelayUntil 1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
+#define INCLUDE_xTaskGetSchedulerState 1
+#define INCLUDE_uxTaskGetStackHighWaterMark 1
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void FreeRTOSHooks_AssertCalled(const char *const file, const unsigned long line);
+
+#define configASSERT(x)                                    \
+    if ((x) == 0)                                          \
+    {                                                      \
+        FreeRTOSHooks_AssertCalled(__FILE__, __LINE__);    \
+    }
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * @file GpioDriver.h
+ *
+ * @brief Simulated GPIO pins for the host build.  Stands in for the pins and
+ * the GPIO interrupt of the ESP32: setting the level of a pin calls the ISR
+ * handler added for it when the change is an edge it interrupts on.
+ *
+ ******************************************************************************/
+
+#ifndef GPIO_DRIVER_H
+#define GPIO_DRIVER_H
+
+/* Includes
+ ******************************************************************************/
+#include "driver/gpio.h"
+#include <stdint.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Edges seen by the simulated pins */
+typedef struct
+{
+    uint32_t Edges;      /* Number of level changes */
+    uint32_t Interrupts; /* Number of ISR handlers called */
+} GpioDriver_Stats_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void GpioDriver_SetLevel(const gpio_num_t gpioNum, const uint32_t level);
+void GpioDriver_GetStats(GpioDriver_Stats_t *const stats);
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * @file gpio.h
+ *
+ * @brief Subset of the ESP-IDF GPIO driver used by the firmware, for the host
+ * build.  Pins are simulated by GpioDriver, which calls the ISR handlers
+ * added for a pin when its level is changed with GpioDriver_SetLevel.
+ *
+ ******************************************************************************/
+
+#ifndef HOST_DRIVER_GPIO_H
+#define HOST_DRIVER_GPIO_H
+
+/* Includes
+ ******************************************************************************/
+#include "esp_err.h"
+#include <stdint.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+/* GPIO numbers used by the firmware */
+typedef enum
+{
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_4 = 4,
+    GPIO_NUM_18 = 18,
+    GPIO_NUM_19 = 19,
+    GPIO_NUM_21 = 21,
+    GPIO_NUM_22 = 22,
+    GPIO_NUM_23 = 23,
+    GPIO_NUM_25 = 25,
+    GPIO_NUM_26 = 26,
+    GPIO_NUM_27 = 27,
+    GPIO_NUM_32 = 32,
+    GPIO_NUM_33 = 33,
+    GPIO_NUM_MAX = 40, /* Number of GPIOs of the ESP32 */
+} gpio_num_t;
+
+typedef enum
+{
+    GPIO_MODE_DISABLE,
+    GPIO_MODE_INPUT,
+    GPIO_MODE_OUTPUT,
+} gpio_mode_t;
+
+typedef enum
+{
+    GPIO_PULLUP_DISABLE,
+    GPIO_PULLUP_ENABLE,
+} gpio_pullup_t;
+
+typedef enum
+{
+    GPIO_PULLDOWN_DISABLE,
+    GPIO_PULLDOWN_ENABLE,
+} gpio_pulldown_t;
+
+typedef enum
+{
+    GPIO_INTR_DISABLE,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+    GPIO_INTR_LOW_LEVEL,
+    GPIO_INTR_HIGH_LEVEL,
+} gpio_int_type_t;
+
+/* Pin configuration */
+typedef struct
+{
+    uint64_t pin_bit_mask;        /* Pins to configure */
+    gpio_mode_t mode;             /* Direction of the pins */
+    gpio_pullup_t pull_up_en;     /* Whether the pins are pulled up, idling high */
+    gpio_pulldown_t pull_down_en; /* Whether the pins are pulled down */
+    gpio_int_type_t intr_type;    /* Edges or levels interrupting, only edges are simulated */
+} gpio_config_t;
+
+typedef void (*gpio_isr_t)(void *arg); /* ISR handler of a pin */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+esp_err_t gpio_config(const gpio_config_t *pGPIOConfig);
+esp_err_t gpio_install_isr_service(int intr_alloc_flags);
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args);
+
+#endif
@@ -0,0 +1,18 @@
+/**
+ * @file esp_attr.h
+ *
+ * @brief Subset of the ESP-IDF memory placement attributes used by the
+ * firmware, for the host build.  Placement has no meaning on the host.
+ *
+ ******************************************************************************/
+
+#ifndef HOST_ESP_ATTR_H
+#define HOST_ESP_ATTR_H
+
+/* Defines
+ ******************************************************************************/
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif
@@ -0,0 +1,30 @@
+/**
+ * @file esp_err.h
+ *
+ * @brief Subset of the ESP-IDF error codes used by the firmware, for the host
+ * build.
+ *
+ ******************************************************************************/
+
+#ifndef HOST_ESP_ERR_H
+#define HOST_ESP_ERR_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef int esp_err_t;
+
+#endif
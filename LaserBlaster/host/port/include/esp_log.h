@@ -0,0 +1,25 @@
+/**
+ * @file esp_log.h
+ *
+ * @brief Subset of the ESP-IDF logging library used by the firmware, for the
+ * host build.  Prints to stdout.
+ *
+ ******************************************************************************/
+
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdio.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define ESP_LOGE(tag, format, ...) printf("E (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) printf("W (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) printf("I (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ((void)(tag))
+#define ESP_LOGV(tag, format, ...) ((void)(tag))
+
+#endif
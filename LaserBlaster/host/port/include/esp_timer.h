@@ -0,0 +1,49 @@
+/**
+ * @file esp_timer.h
+ *
+ * @brief Subset of the ESP-IDF high resolution timer API used by the
+ * firmware, for the host build.  Callbacks are dispatched from a FreeRTOS task
+ * like ESP_TIMER_TASK dispatch on the target.
+ *
+ ******************************************************************************/
+
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+/* Includes
+ ******************************************************************************/
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef struct esp_timer *esp_timer_handle_t; /* Handle of a timer */
+typedef void (*esp_timer_cb_t)(void *arg);    /* Timer callback */
+
+typedef enum
+{
+    ESP_TIMER_TASK, /* Callback is called from the timer task */
+} esp_timer_dispatch_t;
+
+/* Timer configuration */
+typedef struct
+{
+    esp_timer_cb_t callback;              /* Function to call when timer expires */
+    void *arg;                            /* Argument to pass to the callback */
+    esp_timer_dispatch_t dispatch_method; /* Call the callback from task or from ISR */
+    const char *name;                     /* Timer name */
+    bool skip_unhandled_events;           /* Unused on the host */
+} esp_timer_create_args_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+int64_t esp_timer_get_time(void);
+
+#endif
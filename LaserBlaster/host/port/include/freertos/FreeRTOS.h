@@ -0,0 +1,16 @@
+/**
+ * @file FreeRTOS.h
+ *
+ * @brief Maps the ESP-IDF FreeRTOS include path to the FreeRTOS kernel used
+ * by the host build.
+ *
+ ******************************************************************************/
+
+#ifndef HOST_FREERTOS_FREERTOS_H
+#define HOST_FREERTOS_FREERTOS_H
+
+/* Includes
+ ******************************************************************************/
+#include <FreeRTOS.h>
+
+#endif
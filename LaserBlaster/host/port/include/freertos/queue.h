@@ -0,0 +1,17 @@
+/**
+ * @file queue.h
+ *
+ * @brief Maps the ESP-IDF FreeRTOS include path to the FreeRTOS kernel used
+ * by the host build.
+ *
+ ******************************************************************************/
+
+#ifndef HOST_FREERTOS_QUEUE_H
+#define HOST_FREERTOS_QUEUE_H
+
+/* Includes
+ ******************************************************************************/
+#include <FreeRTOS.h>
+#include <queue.h>
+
+#endif
@@ -0,0 +1,17 @@
+/**
+ * @file semphr.h
+ *
+ * @brief Maps the ESP-IDF FreeRTOS include path to the FreeRTOS kernel used
+ * by the host build.
+ *
+ ******************************************************************************/
+
+#ifndef HOST_FREERTOS_SEMPHR_H
+#define HOST_FREERTOS_SEMPHR_H
+
+/* Includes
+ ******************************************************************************/
+#include <FreeRTOS.h>
+#include <semphr.h>
+
+#endif
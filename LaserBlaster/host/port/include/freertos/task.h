@@ -0,0 +1,17 @@
+/**
+ * @file task.h
+ *
+ * @brief Maps the ESP-IDF FreeRTOS include path to the FreeRTOS kernel used
+ * by the host build.
+ *
+ ******************************************************************************/
+
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+/* Includes
+ ******************************************************************************/
+#include <FreeRTOS.h>
+#include <task.h>
+
+#endif
@@ -0,0 +1,17 @@
+/**
+ * @file timers.h
+ *
+ * @brief Maps the ESP-IDF FreeRTOS include path to the FreeRTOS kernel used
+ * by the host build.
+ *
+ ******************************************************************************/
+
+#ifndef HOST_FREERTOS_TIMERS_H
+#define HOST_FREERTOS_TIMERS_H
+
+/* Includes
+ ******************************************************************************/
+#include <FreeRTOS.h>
+#include <timers.h>
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ * @file gpio_ll.h
+ *
+ * @brief Subset of the ESP-IDF GPIO low level HAL used by the firmware, for
+ * the host build.  Reads the levels of the pins simulated by GpioDriver.
+ *
+ ******************************************************************************/
+
+#ifndef HOST_HAL_GPIO_LL_H
+#define HOST_HAL_GPIO_LL_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdatomic.h>
+#include <stdint.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+/* GPIO peripheral */
+typedef struct
+{
+    _Atomic uint64_t Levels; /* Level of each pin, one bit per GPIO number */
+} gpio_dev_t;
+
+/* Globals
+ ******************************************************************************/
+
+extern gpio_dev_t GPIO;
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Get the level of a pin.
+ *
+ * @param[in] hw       GPIO peripheral
+ * @param[in] gpio_num GPIO number of the pin
+ *
+ * @return Level of the pin, 0 or 1
+ ******************************************************************************/
+static inline int gpio_ll_get_level(gpio_dev_t *hw, uint32_t gpio_num)
+{
+    return (int)((atomic_load_explicit(&hw->Levels, memory_order_relaxed) >> gpio_num) & 1U);
+}
+
+#endif
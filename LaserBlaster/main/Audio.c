@@ -0,0 +1,260 @@
+/**
+ * @file Audio.c
+ *
+ * @brief Audio clips streamed to an I2S amplifier from the "prompts" flash
+ * partition.  The whole partition is mapped into the data address space with
+ * esp_partition_mmap and opened as an AudioPack, so clips are read in place
+ * through the flash cache and never copied into a RAM buffer of their own.
+ * The audio task hands chunks of a clip straight from the mapping to
+ * i2s_channel_write, whose only copy is into the I2S DMA descriptors, as the
+ * DMA cannot read from flash.
+ *
+ * A clip requested while another plays cuts it short at the next chunk.  The
+ * latency from each request to its first samples being queued for DMA is
+ * measured.  They are heard once the DMA buffers queued ahead of them, at
+ * most AUDIO_DMA_DESCRIPTORS buffers of AUDIO_CHUNK_SAMPLES, have played.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Audio.h"
+#include "AudioPack.h"
+#include "driver/i2s_std.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "Gpio.h"
+#include "TaskLayout.h"
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define AUDIO_PARTITION_LABEL "prompts"   /* Label of the partition holding the clips */
+#define AUDIO_DMA_DESCRIPTORS 4U          /* Number of I2S DMA buffers */
+#define AUDIO_CHUNK_SAMPLES 240U          /* Samples per I2S DMA buffer and per chunk handed to the driver */
+#define AUDIO_SAMPLE_SIZE sizeof(int16_t) /* Size of a sample in bytes */
+#define AUDIO_NO_REQUEST 0U               /* Value of the pending request when no clip was requested */
+
+/* Globals
+ ******************************************************************************/
+
+static const char *Audio_EspLogTag = "Audio"; /* Tag for logging from Audio module */
+
+static AudioPack_t Audio_Pack;                                       /* Clips in the mapped partition */
+static esp_partition_mmap_handle_t Audio_MmapHandle;                 /* Handle of the mapping of the partition, kept mapped for the lifetime of the program */
+static i2s_chan_handle_t Audio_TxChannel = NULL;                     /* I2S channel to the amplifier */
+static TaskHandle_t Audio_TaskHandle = NULL;                         /* Handle of the audio task */
+static _Atomic uint32_t Audio_Request = AUDIO_NO_REQUEST;            /* Clip requested plus one, taken by the audio task */
+static _Atomic uint32_t Audio_RequestTimeUs = 0U;                    /* Time of the last request, low 32 bits of esp_timer_get_time */
+static Audio_Stats_t Audio_Stats = {0U, 0U, 0U, UINT32_MAX, 0U, 0U}; /* Clips played, only modified by the audio task */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static bool Audio_InitChannel(const uint32_t sampleRate);
+static void Audio_Task(void *arg);
+static void Audio_StreamClip(const uint32_t clip, const uint32_t requestTimeUs);
+static void Audio_RecordLatency(const uint32_t latencyUs);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Map the prompts partition, open its clips and start the I2S channel
+ * and the audio task.  Clips cannot be played if the partition is missing or
+ * does not hold a valid image.
+ ******************************************************************************/
+void Audio_Init(void)
+{
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, AUDIO_PARTITION_LABEL);
+    const void *mapped = NULL;
+
+    if (partition == NULL || esp_partition_mmap(partition, 0U, partition->size, ESP_PARTITION_MMAP_DATA, &mapped, &Audio_MmapHandle) != ESP_OK)
+    {
+        ESP_LOGW(Audio_EspLogTag, "No %s partition, audio disabled", AUDIO_PARTITION_LABEL);
+    }
+    else if (!AudioPack_Open(&Audio_Pack, mapped, partition->size))
+    {
+        ESP_LOGW(Audio_EspLogTag, "No valid clips in %s partition, audio disabled", AUDIO_PARTITION_LABEL);
+    }
+    else if (Audio_InitChannel(Audio_Pack.SampleRate) && TaskLayout_Create(TASKLAYOUT_TASK_AUDIO, Audio_Task, NULL, &Audio_TaskHandle))
+    {
+        ESP_LOGI(Audio_EspLogTag, "%" PRIu32 " clips at %" PRIu32 " Hz", Audio_Pack.ClipCount, Audio_Pack.SampleRate);
+    }
+    else
+    {
+        ESP_LOGW(Audio_EspLogTag, "Failed to start I2S, audio disabled");
+    }
+}
+
+/**
+ * @brief Request a clip to be played, cutting short the clip playing.  Returns
+ * without waiting for the clip to start.
+ *
+ * @param[in] clip          Index of the clip in the prompts partition
+ * @param[in] requestTimeUs Time the clip was asked for, low 32 bits of
+ * esp_timer_get_time, from which the latency to its first samples is measured
+ *
+ * @return Whether the clip was requested or not
+ *
+ * @retval true The clip was requested
+ * @retval false Audio is disabled or the clip does not exist
+ ******************************************************************************/
+bool Audio_Play(const uint32_t clip, const uint32_t requestTimeUs)
+{
+    bool requested = false;
+
+    if (Audio_TaskHandle != NULL && clip < Audio_Pack.ClipCount)
+    {
+        /* Time is published before the request so the task never pairs a request with an older time */
+        atomic_store_explicit(&Audio_RequestTimeUs, requestTimeUs, memory_order_relaxed);
+        atomic_store_explicit(&Audio_Request, clip + 1U, memory_order_release);
+        xTaskNotifyGive(Audio_TaskHandle);
+        requested = true;
+    }
+
+    return requested;
+}
+
+/**
+ * @brief Get the number of clips played and the latency of their requests.
+ *
+ * @param[out] stats Clips played
+ ******************************************************************************/
+void Audio_GetStats(Audio_Stats_t *const stats)
+{
+    if (stats != NULL)
+    {
+        *stats = Audio_Stats;
+    }
+}
+
+/**
+ * @brief Create and enable a mono 16 bit I2S channel to the amplifier.  Silence
+ * is sent whenever no clip is playing.
+ *
+ * @param[in] sampleRate Sample rate of the clips in Hz
+ *
+ * @return Whether the channel was enabled or not
+ ******************************************************************************/
+static bool Audio_InitChannel(const uint32_t sampleRate)
+{
+    i2s_chan_config_t channelConfig = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_AUTO, I2S_ROLE_MASTER);
+    i2s_std_config_t stdConfig = {
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(sampleRate),
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO),
+        .gpio_cfg = {
+            .mclk = I2S_GPIO_UNUSED,
+            .bclk = GPIO_AUDIO_BCLK,
+            .ws = GPIO_AUDIO_WS,
+            .dout = GPIO_AUDIO_DOUT,
+            .din = I2S_GPIO_UNUSED,
+            .invert_flags = {0},
+        },
+    };
+
+    channelConfig.dma_desc_num = AUDIO_DMA_DESCRIPTORS;
+    channelConfig.dma_frame_num = AUDIO_CHUNK_SAMPLES;
+    channelConfig.auto_clear = true;
+
+    return i2s_new_channel(&channelConfig, &Audio_TxChannel, NULL) == ESP_OK && i2s_channel_init_std_mode(Audio_TxChannel, &stdConfig) == ESP_OK && i2s_channel_enable(Audio_TxChannel) == ESP_OK;
+}
+
+/**
+ * @brief Task streaming requested clips to the I2S channel.  Plays each
+ * request in turn until no request is pending.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void Audio_Task(void *arg)
+{
+    uint32_t request;
+
+    (void)arg;
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        request = atomic_exchange_explicit(&Audio_Request, AUDIO_NO_REQUEST, memory_order_acquire);
+        while (request != AUDIO_NO_REQUEST)
+        {
+            Audio_StreamClip(request - 1U, atomic_load_explicit(&Audio_RequestTimeUs, memory_order_relaxed));
+            request = atomic_exchange_explicit(&Audio_Request, AUDIO_NO_REQUEST, memory_order_acquire);
+        }
+    }
+}
+
+/**
+ * @brief Stream a clip to the I2S channel in chunks read in place from the
+ * mapped partition.  Returns when the whole clip is queued for DMA or another
+ * clip was requested.
+ *
+ * @param[in] clip          Index of the clip
+ * @param[in] requestTimeUs Time the clip was requested
+ ******************************************************************************/
+static void Audio_StreamClip(const uint32_t clip, const uint32_t requestTimeUs)
+{
+    AudioPack_Clip_t packClip;
+    AudioPack_Stream_t stream;
+    const int16_t *samples = NULL;
+    uint32_t sampleCount;
+    size_t written;
+    bool first = true;
+    bool preempted = false;
+
+    if (AudioPack_GetClip(&Audio_Pack, clip, &packClip))
+    {
+        AudioPack_StreamStart(&stream, &packClip);
+        sampleCount = AudioPack_StreamNext(&stream, AUDIO_CHUNK_SAMPLES, &samples);
+
+        while (sampleCount > 0U && !preempted)
+        {
+            /* Blocks while the DMA buffers are full, which paces the stream */
+            i2s_channel_write(Audio_TxChannel, samples, sampleCount * AUDIO_SAMPLE_SIZE, &written, portMAX_DELAY);
+            if (first)
+            {
+                Audio_RecordLatency((uint32_t)esp_timer_get_time() - requestTimeUs);
+                first = false;
+            }
+
+            sampleCount = AudioPack_StreamNext(&stream, AUDIO_CHUNK_SAMPLES, &samples);
+            preempted = sampleCount > 0U && atomic_load_explicit(&Audio_Request, memory_order_relaxed) != AUDIO_NO_REQUEST;
+        }
+
+        if (preempted)
+        {
+            Audio_Stats.Preempted++;
+        }
+        else
+        {
+            Audio_Stats.Played++;
+        }
+    }
+}
+
+/**
+ * @brief Record the latency from a request to its first samples being queued
+ * for DMA.
+ *
+ * @param[in] latencyUs Latency in microseconds
+ ******************************************************************************/
+static void Audio_RecordLatency(const uint32_t latencyUs)
+{
+    Audio_Stats.LatencyCount++;
+    Audio_Stats.LatencySumUs += latencyUs;
+    if (latencyUs < Audio_Stats.LatencyMinUs)
+    {
+        Audio_Stats.LatencyMinUs = latencyUs;
+    }
+    if (latencyUs > Audio_Stats.LatencyMaxUs)
+    {
+        Audio_Stats.LatencyMaxUs = latencyUs;
+    }
+}
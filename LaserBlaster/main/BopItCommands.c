@@ -3,245 +3,364 @@
  *
  * @brief Commands for BopIt game.
  *
+ * Commands share a single set of callbacks that act on the game's current
+ * command, so code size does not grow with the number of commands.  Commands
+ * have no GetInput, as the game always takes their inputs together through
+ * BopItCommands_GetInputs, or the events of a command with a combo pattern
+ * through BopItCommands_GetEvent.
+ *
+ * Prompts and feedback are posted as effects to Feedback and played by its
+ * task, so the game task never waits for them.  A failure cuts short any
+ * effect playing, and a prompt cuts short the feedback for the last command.
+ * Each effect plays a clip from the prompts partition through Audio: the
+ * prompt of each command in the order of BOPITCOMMANDS_TABLE and then
+ * BOPITCOMMANDS_GESTURE_TABLE, then the success clip and then the fail clip.
+ *
+ * Every command issued and its result are also posted to the other blasters
+ * through Link.
+ *
  ******************************************************************************/
 
 /* Includes
  ******************************************************************************/
 #include "BopItCommands.h"
+#include "Audio.h"
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "EventHandlers.h"
+#include "Feedback.h"
+#include "InputStats.h"
+#include "Link.h"
 #include <stddef.h>
 
 /* Defines
  ******************************************************************************/
 
-#define BOPITCOMMANDS_SEMPHR_BLOCK_TIME 0U /* Do not wait if mutex cannot be taken */
+/* Generates a command with the shared callbacks */
+#define BOPITCOMMANDS_COMMAND(id, gpioNum, name, prompt)  \
+    {                                                     \
+        .Name = name,                                     \
+        .IssueCommand = BopItCommands_IssueCommand,       \
+        .SuccessFeedback = BopItCommands_SuccessFeedback, \
+        .FailFeedback = BopItCommands_FailFeedback,       \
+        .GetInput = NULL,                                 \
+    },
+
+#define BOPITCOMMANDS_COMMAND_POINTER(id, gpioNum, name, prompt) &BopItCommands_CommandList[BOPITCOMMANDS_INPUT_##id], /* Generates a command's entry in the game's list of commands */
+#define BOPITCOMMANDS_PROMPT(id, gpioNum, name, prompt) prompt,                                                        /* Generates a command's prompt */
+#define BOPITCOMMANDS_GPIO_NUM(id, gpioNum, name, prompt) gpioNum,                                                     /* Generates a command's GPIO number */
+#define BOPITCOMMANDS_GPIO_INPUT(id, gpioNum, name, prompt) [gpioNum] = BOPITCOMMANDS_INPUT_##id + 1U,                 /* Generates a GPIO's entry in the GPIO to input map */
+#define BOPITCOMMANDS_NO_GPIO_NUM(id, gesture, name, prompt) (Gpio_GpioNum_t)GPIO_NUM_MAX,                             /* Generates a gesture command's GPIO number, which it has none of */
+#define BOPITCOMMANDS_GESTURE_INPUT(id, gesture, name, prompt) [gesture] = BOPITCOMMANDS_INPUT_##id + 1U,              /* Generates a gesture's entry in the gesture to input map */
+
+#define BOPITCOMMANDS_PROMPT_MS 200U                             /* Time a prompt plays for */
+#define BOPITCOMMANDS_SUCCESS_MS 300U                            /* Time success feedback plays for */
+#define BOPITCOMMANDS_FAIL_MS 600U                               /* Time fail feedback plays for */
+#define BOPITCOMMANDS_SUCCESS_PRIORITY 1U                        /* Priority of success feedback, lowest as the next prompt follows it */
+#define BOPITCOMMANDS_PROMPT_PRIORITY 2U                         /* Priority of a prompt, cuts short success feedback */
+#define BOPITCOMMANDS_FAIL_PRIORITY 3U                           /* Priority of fail feedback, cuts short any effect */
+#define BOPITCOMMANDS_SUCCESS_CLIP BOPITCOMMANDS_INPUT_COUNT     /* Clip of success feedback, after the prompts */
+#define BOPITCOMMANDS_FAIL_CLIP (BOPITCOMMANDS_INPUT_COUNT + 1U) /* Clip of fail feedback */
+#define BOPITCOMMANDS_US_PER_MS 1000U                            /* Microseconds per millisecond */
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef enum
+{
+    BOPITCOMMANDS_EFFECT_PROMPT,  /* Prompt to complete a command */
+    BOPITCOMMANDS_EFFECT_SUCCESS, /* Feedback for completing a command */
+    BOPITCOMMANDS_EFFECT_FAIL,    /* Feedback for failing to complete a command */
+} BopItCommands_Effect_t;         /* Effects of commands, with the index of the command as their parameter */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void BopItCommands_IssueCommand(void);
+static void BopItCommands_SuccessFeedback(void);
+static void BopItCommands_FailFeedback(void);
+static void BopItCommands_PostEffect(const BopItCommands_Effect_t effect, const uint8_t priority, const uint16_t durationMs);
+static void BopItCommands_StartEffect(const EffectQueue_Effect_t *const effect);
+static void BopItCommands_ResetInputFlags(void);
+static void BopItCommands_PostCommand(void);
+static void BopItCommands_PostResult(const bool success);
 
 /* Globals
  ******************************************************************************/
 
+_Static_assert(BOPITCOMMANDS_INPUT_COUNT <= INPUTSTATS_MAX_INPUTS, "Every command needs an input in the input statistics");
+_Static_assert(BOPITCOMMANDS_INPUT_COUNT <= BOPIT_MAX_INPUTS, "Commands have no GetInput, so BopItCommands_GetInputs must report every command");
+
 static const char *BopItCommands_EspLogTag = "BopItCommands"; /* Tag for logging from BopItCommands module */
 
-bool BopItCommands_Button0InputFlag = false;                  /* Indicates if Button 0 was pressed */
-SemaphoreHandle_t BopItCommands_Button0InputFlagMutex = NULL; /* Mutex for Button 0 flag */
-StaticSemaphore_t BopItCommands_Button0InputFlagMutexBuffer;  /* Buffer to store mutex for Button 0 flag */
-
-/* BopIt command for Button 0 */
-BopIt_Command_t BopItCommands_Button0 = {
-    .Name = "Button 0 Command",
-    .IssueCommand = BopItCommands_Button0IssueCommand,
-    .SuccessFeedback = BopItCommands_Button0SuccessFeedback,
-    .FailFeedback = BopItCommands_Button0FailFeedback,
-    .GetInput = BopItCommands_Button0GetInput,
-};
+static const BopIt_GameContext_t *BopItCommands_GameContext = NULL; /* Game the commands are issued by */
 
-bool BopItCommands_Button1InputFlag = false;                  /* Indicates if Button 1 was pressed */
-SemaphoreHandle_t BopItCommands_Button1InputFlagMutex = NULL; /* Mutex for Button 1 flag */
-StaticSemaphore_t BopItCommands_Button1InputFlagMutexBuffer;  /* Buffer to store mutex for Button 1 flag */
-
-/* BopIt command for Button 1 */
-BopIt_Command_t BopItCommands_Button1 = {
-    .Name = "Button 1 Command",
-    .IssueCommand = BopItCommands_Button1IssueCommand,
-    .SuccessFeedback = BopItCommands_Button1SuccessFeedback,
-    .FailFeedback = BopItCommands_Button1FailFeedback,
-    .GetInput = BopItCommands_Button1GetInput,
-};
+/* Commands, in the order of the tables */
+static BopIt_Command_t BopItCommands_CommandList[BOPITCOMMANDS_INPUT_COUNT] = {BOPITCOMMANDS_TABLE(BOPITCOMMANDS_COMMAND) BOPITCOMMANDS_GESTURE_TABLE(BOPITCOMMANDS_COMMAND)};
 
-bool BopItCommands_Button2InputFlag = false;                  /* Indicates if Button 2 was pressed */
-SemaphoreHandle_t BopItCommands_Button2InputFlagMutex = NULL; /* Mutex for Button 2 flag */
-StaticSemaphore_t BopItCommands_Button2InputFlagMutexBuffer;  /* Buffer to store mutex for Button 2 flag */
-
-/* BopIt command for Button 2 */
-BopIt_Command_t BopItCommands_Button2 = {
-    .Name = "Button 2 Command",
-    .IssueCommand = BopItCommands_Button2IssueCommand,
-    .SuccessFeedback = BopItCommands_Button2SuccessFeedback,
-    .FailFeedback = BopItCommands_Button2FailFeedback,
-    .GetInput = BopItCommands_Button2GetInput,
-};
+/* List of commands for the game */
+BopIt_Command_t *BopItCommands_Commands[BOPITCOMMANDS_INPUT_COUNT] = {BOPITCOMMANDS_TABLE(BOPITCOMMANDS_COMMAND_POINTER) BOPITCOMMANDS_GESTURE_TABLE(BOPITCOMMANDS_COMMAND_POINTER)};
 
-/* Function Prototypes
- ******************************************************************************/
+/* Prompt of each command */
+static const char *const BopItCommands_Prompts[BOPITCOMMANDS_INPUT_COUNT] = {BOPITCOMMANDS_TABLE(BOPITCOMMANDS_PROMPT) BOPITCOMMANDS_GESTURE_TABLE(BOPITCOMMANDS_PROMPT)};
 
-static void BopItCommands_ResetInputFlags(void);
+/* GPIO number of each command, GPIO_NUM_MAX for gesture commands */
+static const Gpio_GpioNum_t BopItCommands_GpioNums[BOPITCOMMANDS_INPUT_COUNT] = {BOPITCOMMANDS_TABLE(BOPITCOMMANDS_GPIO_NUM) BOPITCOMMANDS_GESTURE_TABLE(BOPITCOMMANDS_NO_GPIO_NUM)};
+
+/* Input of each GPIO plus one, 0 if the GPIO has no command.  Read from the GPIO ISR, so it is kept in DRAM */
+static const DRAM_ATTR uint8_t BopItCommands_GpioInputs[GPIO_NUM_MAX] = {BOPITCOMMANDS_TABLE(BOPITCOMMANDS_GPIO_INPUT)};
+
+/* Input of each gesture plus one, 0 if the gesture has no command */
+static const uint8_t BopItCommands_GestureInputs[GESTURE_COUNT] = {BOPITCOMMANDS_GESTURE_TABLE(BOPITCOMMANDS_GESTURE_INPUT)};
+
+/* Player of the effects of commands */
+static const Feedback_Player_t BopItCommands_Player = {
+    .Start = BopItCommands_StartEffect,
+    .Stop = NULL,
+};
 
 /* Function Definitions
  ******************************************************************************/
 
 /**
  * @brief Perform initialization needed for BopIt commands.  Must be called
- * before calling any other functions in module.  Creates mutexes for button
- * event flags.
+ * before calling any other functions in module.  Starts playing feedback.
+ *
+ * @param[in] gameContext Context for the BopIt game issuing the commands
  ******************************************************************************/
-void BopItCommands_Init(void)
+void BopItCommands_Init(const BopIt_GameContext_t *const gameContext)
 {
-    BopItCommands_Button0InputFlagMutex = xSemaphoreCreateMutexStatic(&BopItCommands_Button0InputFlagMutexBuffer);
-    BopItCommands_Button1InputFlagMutex = xSemaphoreCreateMutexStatic(&BopItCommands_Button1InputFlagMutexBuffer);
-    BopItCommands_Button2InputFlagMutex = xSemaphoreCreateMutexStatic(&BopItCommands_Button2InputFlagMutexBuffer);
+    BopItCommands_GameContext = gameContext;
+    Feedback_Init(&BopItCommands_Player);
 }
 
 /**
- * @brief Issue command to press Button 0.
+ * @brief Get the inputs of all commands from the events received since the
+ * last call.  Input indexes match the indexes of the commands in the game's
+ * list of commands.
+ *
+ * @param[in]  gameContext Context for a BopIt game, unused
+ * @param[out] inputTime   Time at which the earliest input was made, only
+ * written if any input was made
+ *
+ * @return Bitmask of the inputs made since the last call
  ******************************************************************************/
-void BopItCommands_Button0IssueCommand(void)
+BopIt_Inputs_t BopItCommands_GetInputs(BopIt_GameContext_t *const gameContext, BopIt_TimeUs_t *const inputTime)
 {
-    BopItCommands_ResetInputFlags();
-    ESP_LOGI(BopItCommands_EspLogTag, "Press Button 0");
-}
+    BopIt_Inputs_t inputs;
 
-/**
- * @brief Provide feedback to indicate Button 0 was successfully pressed.
- ******************************************************************************/
-void BopItCommands_Button0SuccessFeedback(void)
-{
-    ESP_LOGI(BopItCommands_EspLogTag, "Successfully pressed Button 0");
-}
+    (void)gameContext;
 
-/**
- * @brief Provide feedback to indicate failure to press Button 0.
- ******************************************************************************/
-void BopItCommands_Button0FailFeedback(void)
-{
-    ESP_LOGI(BopItCommands_EspLogTag, "Failed to pressed Button 0");
+    inputs = EventHandlers_TakeInputs(inputTime);
+    INPUTSTATS_RECORD_TAKE((uint32_t)inputs);
+
+    return inputs;
 }
 
 /**
- * @brief Check if Button 0 was pressed.
+ * @brief Get the oldest input event received since the last call, for
+ * matching the pattern of a combo command.  Input indexes match the indexes of
+ * the commands in the game's list of commands.
  *
- * @return Whether Button 0 was pressed or not
+ * @param[in]  gameContext Context for a BopIt game, unused
+ * @param[out] event       Event taken, only written if there was one
  *
- * @retval true Button 0 was pressed
- * @retval false Button 0 was not pressed
+ * @return Whether an event was taken or not
  ******************************************************************************/
-bool BopItCommands_Button0GetInput(void)
+bool BopItCommands_GetEvent(BopIt_GameContext_t *const gameContext, Combo_Event_t *const event)
 {
-    bool input = false;
+    bool taken;
 
-    if (xSemaphoreTake(BopItCommands_Button0InputFlagMutex, BOPITCOMMANDS_SEMPHR_BLOCK_TIME) == pdTRUE)
+    (void)gameContext;
+
+    taken = EventHandlers_TakeEvent(event);
+    if (taken)
     {
-        input = BopItCommands_Button0InputFlag;
-        BopItCommands_Button0InputFlag = false;
-        xSemaphoreGive(BopItCommands_Button0InputFlagMutex);
+        INPUTSTATS_RECORD_TAKE((uint32_t)1U << event->Input);
     }
 
-    return input;
+    return taken;
 }
 
 /**
- * @brief Issue command to press Button 1.
+ * @brief Get the input of the command for a GPIO in constant time.
+ *
+ * @note Safe to call from an ISR.
+ *
+ * @param[in] gpioNum GPIO number
+ *
+ * @return Input of the command for the GPIO, BOPITCOMMANDS_INPUT_COUNT if the
+ * GPIO has no command
  ******************************************************************************/
-void BopItCommands_Button1IssueCommand(void)
+BopItCommands_Input_t IRAM_ATTR BopItCommands_GpioToInput(const Gpio_GpioNum_t gpioNum)
 {
-    BopItCommands_ResetInputFlags();
-    ESP_LOGI(BopItCommands_EspLogTag, "Press Button 1");
-}
+    BopItCommands_Input_t input = BOPITCOMMANDS_INPUT_COUNT;
 
-/**
- * @brief Provide feedback to indicate Button 1 was successfully pressed.
- ******************************************************************************/
-void BopItCommands_Button1SuccessFeedback(void)
-{
-    ESP_LOGI(BopItCommands_EspLogTag, "Successfully pressed Button 1");
+    if (gpioNum < GPIO_NUM_MAX && BopItCommands_GpioInputs[gpioNum] != 0U)
+    {
+        input = (BopItCommands_Input_t)(BopItCommands_GpioInputs[gpioNum] - 1U);
+    }
+
+    return input;
 }
 
 /**
- * @brief Provide feedback to indicate failure to press Button 1.
+ * @brief Get the GPIO of a command.
+ *
+ * @param[in] input Input of the command
+ *
+ * @return GPIO number of the command, GPIO_NUM_MAX if input is not valid
  ******************************************************************************/
-void BopItCommands_Button1FailFeedback(void)
+Gpio_GpioNum_t BopItCommands_InputToGpio(const BopItCommands_Input_t input)
 {
-    ESP_LOGI(BopItCommands_EspLogTag, "Failed to pressed Button 1");
+    return (input < BOPITCOMMANDS_INPUT_COUNT) ? BopItCommands_GpioNums[input] : (Gpio_GpioNum_t)GPIO_NUM_MAX;
 }
 
 /**
- * @brief Check if Button 1 was pressed.
+ * @brief Get the input of the command for a gesture in constant time.
  *
- * @return Whether Button 1 was pressed or not
+ * @param[in] gesture Gesture recognized
  *
- * @retval true Button 1 was pressed
- * @retval false Button 1 was not pressed
+ * @return Input of the command for the gesture, BOPITCOMMANDS_INPUT_COUNT if
+ * the gesture has no command
  ******************************************************************************/
-bool BopItCommands_Button1GetInput(void)
+BopItCommands_Input_t BopItCommands_GestureToInput(const Gesture_Gesture_t gesture)
 {
-    bool input = false;
+    BopItCommands_Input_t input = BOPITCOMMANDS_INPUT_COUNT;
 
-    if (xSemaphoreTake(BopItCommands_Button1InputFlagMutex, BOPITCOMMANDS_SEMPHR_BLOCK_TIME) == pdTRUE)
+    if (gesture < GESTURE_COUNT && BopItCommands_GestureInputs[gesture] != 0U)
     {
-        input = BopItCommands_Button1InputFlag;
-        BopItCommands_Button1InputFlag = false;
-        xSemaphoreGive(BopItCommands_Button1InputFlagMutex);
+        input = (BopItCommands_Input_t)(BopItCommands_GestureInputs[gesture] - 1U);
     }
 
     return input;
 }
 
 /**
- * @brief Issue command to press Button 2.
+ * @brief Issue the game's current command.
  ******************************************************************************/
-void BopItCommands_Button2IssueCommand(void)
+static void BopItCommands_IssueCommand(void)
 {
     BopItCommands_ResetInputFlags();
-    ESP_LOGI(BopItCommands_EspLogTag, "Press Button 2");
+    BopItCommands_PostEffect(BOPITCOMMANDS_EFFECT_PROMPT, BOPITCOMMANDS_PROMPT_PRIORITY, BOPITCOMMANDS_PROMPT_MS);
+    BopItCommands_PostCommand();
 }
 
 /**
- * @brief Provide feedback to indicate Button 2 was successfully pressed.
+ * @brief Provide feedback to indicate the game's current command was
+ * successfully completed.
  ******************************************************************************/
-void BopItCommands_Button2SuccessFeedback(void)
+static void BopItCommands_SuccessFeedback(void)
 {
-    ESP_LOGI(BopItCommands_EspLogTag, "Successfully pressed Button 2");
+    BopItCommands_PostEffect(BOPITCOMMANDS_EFFECT_SUCCESS, BOPITCOMMANDS_SUCCESS_PRIORITY, BOPITCOMMANDS_SUCCESS_MS);
+    BopItCommands_PostResult(true);
 }
 
 /**
- * @brief Provide feedback to indicate failure to press Button 2.
+ * @brief Provide feedback to indicate failure to complete the game's current
+ * command.
  ******************************************************************************/
-void BopItCommands_Button2FailFeedback(void)
+static void BopItCommands_FailFeedback(void)
 {
-    ESP_LOGI(BopItCommands_EspLogTag, "Failed to pressed Button 2");
+    BopItCommands_PostEffect(BOPITCOMMANDS_EFFECT_FAIL, BOPITCOMMANDS_FAIL_PRIORITY, BOPITCOMMANDS_FAIL_MS);
+    BopItCommands_PostResult(false);
 }
 
 /**
- * @brief Check if Button 2 was pressed.
- *
- * @return Whether Button 2 was pressed or not
+ * @brief Post an effect for the game's current command.
  *
- * @retval true Button 2 was pressed
- * @retval false Button 2 was not pressed
+ * @param[in] effect     Effect to post
+ * @param[in] priority   Priority of the effect
+ * @param[in] durationMs Time the effect plays for
+ ******************************************************************************/
+static void BopItCommands_PostEffect(const BopItCommands_Effect_t effect, const uint8_t priority, const uint16_t durationMs)
+{
+    EffectQueue_Effect_t queuedEffect = {
+        .Id = (uint8_t)effect,
+        .Priority = priority,
+        .DurationMs = durationMs,
+        .Param = (BopItCommands_GameContext != NULL) ? BopItCommands_GameContext->CurrentCommandIndex : BOPITCOMMANDS_INPUT_COUNT,
+        .PostTime = (uint32_t)esp_timer_get_time(),
+    };
+
+    (void)Feedback_Post(&queuedEffect);
+}
+
+/**
+ * @brief Post the game's current command to the other blasters.
  ******************************************************************************/
-bool BopItCommands_Button2GetInput(void)
+static void BopItCommands_PostCommand(void)
 {
-    bool input = false;
+    GameLink_Message_t message = {.Type = GAMELINK_MESSAGE_COMMAND};
 
-    if (xSemaphoreTake(BopItCommands_Button2InputFlagMutex, BOPITCOMMANDS_SEMPHR_BLOCK_TIME) == pdTRUE)
+    if (BopItCommands_GameContext != NULL)
     {
-        input = BopItCommands_Button2InputFlag;
-        BopItCommands_Button2InputFlag = false;
-        xSemaphoreGive(BopItCommands_Button2InputFlagMutex);
+        message.Command.CommandIndex = (uint8_t)BopItCommands_GameContext->CurrentCommandIndex;
+        message.Command.WaitTimeMs = (uint16_t)(BopItCommands_GameContext->WaitTime / BOPITCOMMANDS_US_PER_MS);
+        message.Command.IssueTime = (GameLink_TimeUs_t)esp_timer_get_time();
+        (void)Link_Post(&message);
     }
-
-    return input;
 }
 
 /**
- * @brief Reset flags for all inputs.  Flags will indicate all inputs were not
- * triggered after reset.
+ * @brief Post the result of the game's current command to the other blasters.
+ * Feedback is given before the game updates the score and lives, so the
+ * result carries them as they will be after the command.
+ *
+ * @param[in] success Whether the command was completed or not
  ******************************************************************************/
-static void BopItCommands_ResetInputFlags(void)
+static void BopItCommands_PostResult(const bool success)
 {
-    if (xSemaphoreTake(BopItCommands_Button0InputFlagMutex, portMAX_DELAY) == pdTRUE)
-    {
-        BopItCommands_Button0InputFlag = false;
-        xSemaphoreGive(BopItCommands_Button0InputFlagMutex);
-    }
+    GameLink_Message_t message = {.Type = GAMELINK_MESSAGE_RESULT};
 
-    if (xSemaphoreTake(BopItCommands_Button1InputFlagMutex, portMAX_DELAY) == pdTRUE)
+    if (BopItCommands_GameContext != NULL)
     {
-        BopItCommands_Button1InputFlag = false;
-        xSemaphoreGive(BopItCommands_Button1InputFlagMutex);
+        message.Result.CommandIndex = (uint8_t)BopItCommands_GameContext->CurrentCommandIndex;
+        message.Result.Success = success;
+        message.Result.Score = success ? (uint8_t)(BopItCommands_GameContext->Score + 1U) : BopItCommands_GameContext->Score;
+        message.Result.Lives = success ? BopItCommands_GameContext->Lives : (uint8_t)(BopItCommands_GameContext->Lives - 1U);
+        (void)Link_Post(&message);
     }
+}
 
-    if (xSemaphoreTake(BopItCommands_Button2InputFlagMutex, portMAX_DELAY) == pdTRUE)
+/**
+ * @brief Start playing an effect of a command.  Called from the feedback task.
+ * The latency of the clip is measured from when the effect was posted.
+ *
+ * @param[in] effect Effect to play
+ ******************************************************************************/
+static void BopItCommands_StartEffect(const EffectQueue_Effect_t *const effect)
+{
+    const char *prompt = (effect->Param < BOPITCOMMANDS_INPUT_COUNT) ? BopItCommands_Prompts[effect->Param] : "";
+
+    switch ((BopItCommands_Effect_t)effect->Id)
     {
-        BopItCommands_Button2InputFlag = false;
-        xSemaphoreGive(BopItCommands_Button2InputFlagMutex);
+    case BOPITCOMMANDS_EFFECT_PROMPT:
+        (void)Audio_Play(effect->Param, effect->PostTime);
+        ESP_LOGI(BopItCommands_EspLogTag, "%s", prompt);
+        break;
+    case BOPITCOMMANDS_EFFECT_SUCCESS:
+        (void)Audio_Play(BOPITCOMMANDS_SUCCESS_CLIP, effect->PostTime);
+        ESP_LOGI(BopItCommands_EspLogTag, "Successfully completed: %s", prompt);
+        break;
+    case BOPITCOMMANDS_EFFECT_FAIL:
+        (void)Audio_Play(BOPITCOMMANDS_FAIL_CLIP, effect->PostTime);
+        ESP_LOGI(BopItCommands_EspLogTag, "Failed to complete: %s", prompt);
+        break;
+    default:
+        break;
     }
 }
+
+/**
+ * @brief Reset flags for all inputs.  Flags will indicate all inputs were not
+ * triggered after reset.  Discards the events received since inputs were last
+ * taken.
+ ******************************************************************************/
+static void BopItCommands_ResetInputFlags(void)
+{
+    BopIt_TimeUs_t inputTime;
+
+    (void)EventHandlers_TakeInputs(&inputTime);
+}
@@ -0,0 +1,168 @@
+/**
+ * @file Deadline.c
+ *
+ * @brief Deadline service for game deadlines and effect timers.  Timer
+ * callbacks run on the esp_timer task with the wheel's lock held, and may arm
+ * and cancel timers, so they must be short and must not block.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Deadline.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define DEADLINE_TICK_US 100U /* Width of a tick of the wheel, the resolution of deadlines */
+
+/* Globals
+ ******************************************************************************/
+
+static const char *Deadline_EspLogTag = "Deadline"; /* Tag for logging from Deadline module */
+
+static TimerWheel_t Deadline_Wheel;                                   /* Wheel every timer is armed in, guarded by Deadline_Lock */
+static SemaphoreHandle_t Deadline_Lock = NULL;                        /* Recursive lock for the wheel, so callbacks can arm timers */
+static esp_timer_handle_t Deadline_Timer = NULL;                      /* One-shot timer for advancing the wheel when the next timer is due */
+static TimerWheel_TimeUs_t Deadline_ScheduledTime = TIMERWHEEL_NEVER; /* Time Deadline_Timer was started for, guarded by Deadline_Lock */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static bool Deadline_Schedule(void);
+static void Deadline_TimerCallback(void *arg);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize the deadline service.  Must be called before any timers
+ * are armed.  If the service cannot be started, every timer fails to arm, so
+ * clients must not rely on their timers expiring.
+ ******************************************************************************/
+void Deadline_Init(void)
+{
+    esp_timer_create_args_t timerArgs = {
+        .callback = Deadline_TimerCallback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "Deadline_Timer",
+    };
+
+    (void)TimerWheel_Init(&Deadline_Wheel, DEADLINE_TICK_US, (TimerWheel_TimeUs_t)esp_timer_get_time());
+    Deadline_Lock = xSemaphoreCreateRecursiveMutex();
+    if (Deadline_Lock == NULL)
+    {
+        ESP_LOGE(Deadline_EspLogTag, "Failed to create lock, deadlines disabled");
+    }
+    else if (esp_timer_create(&timerArgs, &Deadline_Timer) != ESP_OK)
+    {
+        Deadline_Timer = NULL;
+        ESP_LOGE(Deadline_EspLogTag, "Failed to create timer, deadlines disabled");
+    }
+}
+
+/**
+ * @brief Arm a timer to expire at a time on the esp_timer clock, or move it
+ * if it is already armed.  Its callback is called from the esp_timer task no
+ * earlier than the time, and at most a tick of the wheel later.
+ *
+ * @param[in,out] timer  Timer initialized with TimerWheel_InitTimer, must stay
+ *                       valid until it expires or is cancelled
+ * @param[in]     expiry Time at which the timer expires
+ *
+ * @return Whether the timer was armed and the esp_timer started for it or not,
+ * false if the service is not running
+ ******************************************************************************/
+bool Deadline_Arm(TimerWheel_Timer_t *const timer, const TimerWheel_TimeUs_t expiry)
+{
+    bool armed = false;
+
+    if (Deadline_Lock != NULL && Deadline_Timer != NULL)
+    {
+        xSemaphoreTakeRecursive(Deadline_Lock, portMAX_DELAY);
+        armed = TimerWheel_Arm(&Deadline_Wheel, timer, expiry);
+        armed = Deadline_Schedule() && armed;
+        xSemaphoreGiveRecursive(Deadline_Lock);
+    }
+
+    return armed;
+}
+
+/**
+ * @brief Cancel a timer so it does not expire.
+ *
+ * @param[in,out] timer Timer to cancel
+ *
+ * @return Whether the timer was armed or not
+ ******************************************************************************/
+bool Deadline_Cancel(TimerWheel_Timer_t *const timer)
+{
+    bool cancelled = false;
+
+    if (Deadline_Lock != NULL && Deadline_Timer != NULL)
+    {
+        xSemaphoreTakeRecursive(Deadline_Lock, portMAX_DELAY);
+        cancelled = TimerWheel_Cancel(&Deadline_Wheel, timer);
+        (void)Deadline_Schedule();
+        xSemaphoreGiveRecursive(Deadline_Lock);
+    }
+
+    return cancelled;
+}
+
+/**
+ * @brief Start the esp_timer for the next time the wheel needs to be
+ * advanced, if it is not already started for it, or stop it if no timers are
+ * armed.  Must be called with the lock held.  If the timer cannot be started,
+ * it is started again on the next call.
+ *
+ * @return Whether the esp_timer is started for the next timer or not
+ ******************************************************************************/
+static bool Deadline_Schedule(void)
+{
+    TimerWheel_TimeUs_t next = TimerWheel_GetNextExpiry(&Deadline_Wheel);
+    TimerWheel_TimeUs_t now;
+    bool scheduled = true;
+
+    if (next != Deadline_ScheduledTime)
+    {
+        (void)esp_timer_stop(Deadline_Timer); /* Fails if the timer is not running, which is expected */
+        Deadline_ScheduledTime = next;
+
+        if (next != TIMERWHEEL_NEVER)
+        {
+            now = (TimerWheel_TimeUs_t)esp_timer_get_time();
+            if (esp_timer_start_once(Deadline_Timer, (next > now) ? (next - now) : 0U) != ESP_OK)
+            {
+                Deadline_ScheduledTime = TIMERWHEEL_NEVER;
+                scheduled = false;
+                ESP_LOGE(Deadline_EspLogTag, "Failed to start timer");
+            }
+        }
+    }
+
+    return scheduled;
+}
+
+/**
+ * @brief Deadline timer callback.  Advances the wheel, calling the callbacks
+ * of the timers due, and starts the timer again for the next timer.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void Deadline_TimerCallback(void *arg)
+{
+    (void)arg;
+
+    xSemaphoreTakeRecursive(Deadline_Lock, portMAX_DELAY);
+    Deadline_ScheduledTime = TIMERWHEEL_NEVER;
+    (void)TimerWheel_Advance(&Deadline_Wheel, (TimerWheel_TimeUs_t)esp_timer_get_time());
+    (void)Deadline_Schedule();
+    xSemaphoreGiveRecursive(Deadline_Lock);
+}
@@ -1,91 +1,241 @@
 /**
  * @file EventHandlers.c
  *
- * @brief Collection of handlers for various events.
+ * @brief Collection of handlers for various events.  The game subscribes to
+ * button, hit and gesture events on the event bus, but not to trigger events,
+ * which fire shots.  Publishers wake the game loop as they add each event to
+ * the game's rings, and the game task takes the inputs of the BopIt commands
+ * straight from the rings, which are the game's only input path.  Commands
+ * with a combo pattern take the events one at a time instead, in order of
+ * time across the rings, so the pattern is matched against every press.
  *
  ******************************************************************************/
 
 /* Includes
  ******************************************************************************/
 #include "EventHandlers.h"
+#include "esp_attr.h"
+#include "GameLoop.h"
+#include "InputStats.h"
 
-/* Defines
+/* Function Prototypes
  ******************************************************************************/
 
-#define EVENTHANDLERS_SEMPHR_BLOCK_TIME (1U / portTICK_PERIOD_MS) /* Wait for up to 1ms when taking mutex */
+static void EventHandlers_NotifyFromIsr(void *const context);
+static void EventHandlers_Notify(void *const context);
+static BopItCommands_Input_t EventHandlers_EventToInput(const EventBus_Event_t *const event);
 
-/* Function Prototypes
+/* Globals
  ******************************************************************************/
 
-void EventHandlers_Button0EventHandler(void);
-void EventHandlers_Button1EventHandler(void);
-void EventHandlers_Button2EventHandler(void);
+static EventBus_Subscriber_t EventHandlers_Subscribers[EVENTBUS_TYPE_COUNT]; /* Game's subscriber to each type of event, only received from by the game task */
+
+/* Function waking the game for each type of event, from the context it is published from, NULL for types the game does not subscribe to */
+static const EventBus_Notify_t EventHandlers_Notifiers[EVENTBUS_TYPE_COUNT] = {
+    [EVENTBUS_TYPE_BUTTON] = EventHandlers_NotifyFromIsr,
+    [EVENTBUS_TYPE_HIT] = EventHandlers_Notify,
+    [EVENTBUS_TYPE_GESTURE] = EventHandlers_Notify,
+};
 
 /* Function Definitions
  ******************************************************************************/
 
 /**
- * @brief Handle a button event.  Calls event handler corresponding to button
- * that produced the event.
+ * @brief Subscribe the game to every type of event with an input on a bus.
+ *
+ * @param[in,out] bus Bus to subscribe to
  *
- * @param[in] gpioNum GPIO number of the button that produced the event
+ * @return Whether the game subscribed to every type of event with an input or
+ * not
  ******************************************************************************/
-void EventHandlers_ButtonEventHandler(const Gpio_GpioNum_t gpioNum)
+bool EventHandlers_Subscribe(EventBus_t *const bus)
 {
-    switch (gpioNum)
+    bool subscribed = true;
+
+    for (uint32_t type = 0U; type < EVENTBUS_TYPE_COUNT; type++)
     {
-    case GPIO_BUTTON_0:
-        EventHandlers_Button0EventHandler();
-        break;
-    case GPIO_BUTTON_1:
-        EventHandlers_Button1EventHandler();
-        break;
-    case GPIO_BUTTON_2:
-        EventHandlers_Button2EventHandler();
-        break;
-    default:
-        break;
+        if (EventHandlers_Notifiers[type] != NULL)
+        {
+            subscribed = EventBus_Subscribe(bus, (EventBus_Type_t)type, &EventHandlers_Subscribers[type], EventHandlers_Notifiers[type], NULL) && subscribed;
+        }
+    }
+
+    return subscribed;
+}
+
+/**
+ * @brief Take the input of the command for every event received by the game
+ * since the last call.  Several events for the same input are coalesced into
+ * one, made at the time of the earliest.  Records each input in the input
+ * statistics.
+ *
+ * @note Called from the game task, the only task receiving from the rings.
+ *
+ * @param[out] inputTime Time at which the earliest input was made, only
+ * written if any input was made
+ *
+ * @return Bitmask of the inputs made, indexed like the game's list of commands
+ ******************************************************************************/
+BopIt_Inputs_t EventHandlers_TakeInputs(BopIt_TimeUs_t *const inputTime)
+{
+    EventBus_Event_t event;
+    BopItCommands_Input_t input;
+    BopIt_Inputs_t inputs = 0U;
+    BopIt_Inputs_t inputBit;
+    bool first;
+
+    for (uint32_t type = 0U; type < EVENTBUS_TYPE_COUNT; type++)
+    {
+        while (EventBus_Receive(&EventHandlers_Subscribers[type], &event))
+        {
+            input = EventHandlers_EventToInput(&event);
+            if (input < BOPITCOMMANDS_INPUT_COUNT)
+            {
+                inputBit = (BopIt_Inputs_t)1U << input;
+                first = (inputs & inputBit) == 0U;
+
+                /* Each ring is in order, but the rings are received one after another, so compare every event */
+                if (inputs == 0U || (BopIt_TimeUs_t)event.TimeUs < *inputTime)
+                {
+                    *inputTime = (BopIt_TimeUs_t)event.TimeUs;
+                }
+                inputs |= inputBit;
+
+                (void)first; /* Only used by input statistics */
+                INPUTSTATS_RECORD_LATCH(input, first, (uint32_t)inputs, event.TimeUs);
+            }
+        }
+    }
+
+    return inputs;
+}
+
+/**
+ * @brief Take the oldest event with an input received by the game, for
+ * matching combo patterns.  Events are taken in order of time across the
+ * rings, and events without an input are dropped.  The bus only has presses,
+ * so every event is a press.  Records the input in the input statistics.
+ *
+ * @note Called from the game task, the only task receiving from the rings.
+ *
+ * @param[out] event Event taken, only written if there was one
+ *
+ * @return Whether an event was taken or not
+ ******************************************************************************/
+bool EventHandlers_TakeEvent(Combo_Event_t *const event)
+{
+    EventBus_Event_t busEvent;
+    EventBus_Subscriber_t *oldest;
+    EventBus_TimeUs_t oldestTime = 0;
+    BopItCommands_Input_t input = BOPITCOMMANDS_INPUT_COUNT;
+    bool taken = false;
+
+    do
+    {
+        oldest = NULL;
+        for (uint32_t type = 0U; type < EVENTBUS_TYPE_COUNT; type++)
+        {
+            if (EventBus_Peek(&EventHandlers_Subscribers[type], &busEvent) && (oldest == NULL || busEvent.TimeUs < oldestTime))
+            {
+                oldest = &EventHandlers_Subscribers[type];
+                oldestTime = busEvent.TimeUs;
+            }
+        }
+
+        if (oldest != NULL)
+        {
+            (void)EventBus_Receive(oldest, &busEvent);
+            input = EventHandlers_EventToInput(&busEvent);
+        }
+    } while (oldest != NULL && input >= BOPITCOMMANDS_INPUT_COUNT);
+
+    if (oldest != NULL)
+    {
+        event->Time = (Combo_TimeUs_t)busEvent.TimeUs;
+        event->Input = (uint8_t)input;
+        event->Released = false;
+        INPUTSTATS_RECORD_LATCH(input, true, (uint32_t)1U << input, busEvent.TimeUs);
+        taken = true;
     }
+
+    return taken;
 }
 
 /**
- * @brief Update Button 0 input flag to indicate Button 0 was pressed.
+ * @brief Get the number of events dropped for the game because it did not
+ * drain them in time.
  *
- * @note BopItCommands must have been initialized to create the mutex.
+ * @return Number of events dropped
  ******************************************************************************/
-void EventHandlers_Button0EventHandler(void)
+uint32_t EventHandlers_GetDrops(void)
 {
-    if (xSemaphoreTake(BopItCommands_Button0InputFlagMutex, EVENTHANDLERS_SEMPHR_BLOCK_TIME) == pdTRUE)
+    uint32_t drops = 0U;
+
+    for (uint32_t type = 0U; type < EVENTBUS_TYPE_COUNT; type++)
     {
-        BopItCommands_Button0InputFlag = true;
-        xSemaphoreGive(BopItCommands_Button0InputFlagMutex);
+        drops += EventBus_GetDrops(&EventHandlers_Subscribers[type]);
     }
+
+    return drops;
 }
 
 /**
- * @brief Update Button 1 input flag to indicate Button 1 was pressed.
+ * @brief Wake up the game loop to handle a button event.
  *
- * @note BopItCommands must have been initialized to create the mutex.
+ * @note Called from the GPIO ISR.
+ *
+ * @param[in] context Unused
  ******************************************************************************/
-void EventHandlers_Button1EventHandler(void)
+static void IRAM_ATTR EventHandlers_NotifyFromIsr(void *const context)
 {
-    if (xSemaphoreTake(BopItCommands_Button1InputFlagMutex, EVENTHANDLERS_SEMPHR_BLOCK_TIME) == pdTRUE)
+    (void)context;
+
+    if (!GameLoop_NotifyFromIsr())
     {
-        BopItCommands_Button1InputFlag = true;
-        xSemaphoreGive(BopItCommands_Button1InputFlagMutex);
+        INPUTSTATS_RECORD_NOTIFY_FAILURE();
     }
 }
 
 /**
- * @brief Update Button 2 input flag to indicate Button 2 was pressed.
+ * @brief Wake up the game loop to handle a hit or gesture event.
+ *
+ * @note Called from the IR receive task or the IMU task.
+ *
+ * @param[in] context Unused
+ ******************************************************************************/
+static void EventHandlers_Notify(void *const context)
+{
+    (void)context;
+
+    GameLoop_Notify();
+}
+
+/**
+ * @brief Get the input of the command for an event.
+ *
+ * @param[in] event Event received
  *
- * @note BopItCommands must have been initialized to create the mutex.
+ * @return Input of the command, BOPITCOMMANDS_INPUT_COUNT if none
  ******************************************************************************/
-void EventHandlers_Button2EventHandler(void)
+static BopItCommands_Input_t EventHandlers_EventToInput(const EventBus_Event_t *const event)
 {
-    if (xSemaphoreTake(BopItCommands_Button2InputFlagMutex, EVENTHANDLERS_SEMPHR_BLOCK_TIME) == pdTRUE)
+    BopItCommands_Input_t input;
+
+    switch (event->Type)
     {
-        BopItCommands_Button2InputFlag = true;
-        xSemaphoreGive(BopItCommands_Button2InputFlagMutex);
+    case EVENTBUS_TYPE_BUTTON:
+        input = BopItCommands_GpioToInput(event->Button.GpioNum);
+        break;
+    case EVENTBUS_TYPE_HIT:
+        input = BopItCommands_GpioToInput(event->Hit.GpioNum);
+        break;
+    case EVENTBUS_TYPE_GESTURE:
+        input = BopItCommands_GestureToInput((Gesture_Gesture_t)event->Gesture.Gesture);
+        break;
+    default:
+        input = BOPITCOMMANDS_INPUT_COUNT;
+        break;
     }
+
+    return input;
 }
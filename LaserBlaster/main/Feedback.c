@@ -0,0 +1,199 @@
+/**
+ * @file Feedback.c
+ *
+ * @brief Asynchronous feedback effects.  Posting an effect only takes a short
+ * critical section around EffectQueue_Post and a task notification, so the
+ * cost of a feedback callback on the game task is bounded no matter how long
+ * the effect plays.  The feedback task sleeps until the effect playing ends
+ * or a new effect is posted, and then starts the next effect.  The end of the
+ * effect playing is a timer armed with the deadline service, so it is not
+ * rounded up to FreeRTOS ticks.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Feedback.h"
+#include "Deadline.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "TaskLayout.h"
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define FEEDBACK_US_PER_MS 1000 /* Microseconds per millisecond */
+
+/* Globals
+ ******************************************************************************/
+
+static EffectQueue_t Feedback_Queue;                                   /* Effects waiting to be played, guarded by Feedback_QueueLock */
+static portMUX_TYPE Feedback_QueueLock = portMUX_INITIALIZER_UNLOCKED; /* Lock for the queue, shared by the game and feedback tasks */
+static Feedback_Player_t Feedback_Player = {NULL, NULL};               /* Player of effects */
+static TaskHandle_t Feedback_TaskHandle = NULL;                        /* Handle of the feedback task */
+static TimerWheel_Timer_t Feedback_EndTimer;                           /* Timer for waking the feedback task when the effect playing ends */
+static uint32_t Feedback_Played = 0U;                                  /* Number of effects played to the end, only modified by the feedback task */
+static uint32_t Feedback_Preempted = 0U;                               /* Number of effects cut short, only modified by the feedback task */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void Feedback_Task(void *arg);
+static bool Feedback_TakeEffect(const uint8_t abovePriority, EffectQueue_Effect_t *const effect);
+static void Feedback_EndCallback(void *const context);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Start the task playing effects.  Must be called after Deadline_Init
+ * and before posting effects.
+ *
+ * @param[in] player Player of effects, its Start function is required
+ ******************************************************************************/
+void Feedback_Init(const Feedback_Player_t *const player)
+{
+    if (player != NULL && player->Start != NULL)
+    {
+        Feedback_Player = *player;
+        EffectQueue_Init(&Feedback_Queue);
+        TimerWheel_InitTimer(&Feedback_EndTimer, Feedback_EndCallback, NULL);
+
+        (void)TaskLayout_Create(TASKLAYOUT_TASK_FEEDBACK, Feedback_Task, NULL, &Feedback_TaskHandle);
+    }
+}
+
+/**
+ * @brief Post an effect to be played by the feedback task.  Returns without
+ * waiting for the effect to be played.
+ *
+ * @param[in] effect Effect to post
+ *
+ * @return Whether the effect was queued or not
+ *
+ * @retval true The effect was queued
+ * @retval false The effect was dropped because the queue was full of effects
+ * of equal or higher priority, or the feedback task is not running
+ ******************************************************************************/
+bool Feedback_Post(const EffectQueue_Effect_t *const effect)
+{
+    bool posted = false;
+
+    if (Feedback_TaskHandle != NULL)
+    {
+        taskENTER_CRITICAL(&Feedback_QueueLock);
+        posted = EffectQueue_Post(&Feedback_Queue, effect);
+        taskEXIT_CRITICAL(&Feedback_QueueLock);
+
+        if (posted)
+        {
+            xTaskNotifyGive(Feedback_TaskHandle);
+        }
+    }
+
+    return posted;
+}
+
+/**
+ * @brief Get the number of effects posted and played.
+ *
+ * @param[out] stats Effects posted and played
+ ******************************************************************************/
+void Feedback_GetStats(Feedback_Stats_t *const stats)
+{
+    if (stats != NULL)
+    {
+        taskENTER_CRITICAL(&Feedback_QueueLock);
+        stats->Queue = Feedback_Queue.Stats;
+        taskEXIT_CRITICAL(&Feedback_QueueLock);
+        stats->Played = Feedback_Played;
+        stats->Preempted = Feedback_Preempted;
+    }
+}
+
+/**
+ * @brief Task playing effects.  Waits for the effect playing to end or for an
+ * effect to be posted, stops the effect playing if it ended or is outranked
+ * by the next effect, and starts the next effect.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void Feedback_Task(void *arg)
+{
+    EffectQueue_Effect_t playing = {0};
+    EffectQueue_Effect_t next;
+    bool isPlaying = false;
+    int64_t endUs = 0;
+    int64_t nowUs;
+
+    (void)arg;
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        nowUs = esp_timer_get_time();
+
+        if (isPlaying && nowUs >= endUs)
+        {
+            if (Feedback_Player.Stop != NULL)
+            {
+                Feedback_Player.Stop(&playing, false);
+            }
+            isPlaying = false;
+            Feedback_Played++;
+        }
+
+        /* Only the first effect queued can outrank the one playing */
+        if (Feedback_TakeEffect(isPlaying ? playing.Priority : EFFECTQUEUE_PRIORITY_NONE, &next))
+        {
+            if (isPlaying)
+            {
+                if (Feedback_Player.Stop != NULL)
+                {
+                    Feedback_Player.Stop(&playing, true);
+                }
+                Feedback_Preempted++;
+            }
+
+            Feedback_Player.Start(&next);
+            playing = next;
+            isPlaying = true;
+            endUs = nowUs + ((int64_t)next.DurationMs * FEEDBACK_US_PER_MS);
+            (void)Deadline_Arm(&Feedback_EndTimer, (TimerWheel_TimeUs_t)endUs);
+        }
+    }
+}
+
+/**
+ * @brief Take the next effect from the queue if it outranks a priority.
+ *
+ * @param[in]  abovePriority Priority the effect must be above to be taken
+ * @param[out] effect        Effect taken, only written if one was taken
+ *
+ * @return Whether an effect was taken or not
+ ******************************************************************************/
+static bool Feedback_TakeEffect(const uint8_t abovePriority, EffectQueue_Effect_t *const effect)
+{
+    bool taken;
+
+    taskENTER_CRITICAL(&Feedback_QueueLock);
+    taken = EffectQueue_Take(&Feedback_Queue, abovePriority, effect);
+    taskEXIT_CRITICAL(&Feedback_QueueLock);
+
+    return taken;
+}
+
+/**
+ * @brief End timer callback.  Wakes up the feedback task when the effect
+ * playing ends.
+ *
+ * @param[in] context Unused
+ ******************************************************************************/
+static void Feedback_EndCallback(void *const context)
+{
+    (void)context;
+
+    xTaskNotifyGive(Feedback_TaskHandle);
+}
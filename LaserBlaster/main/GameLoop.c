@@ -0,0 +1,153 @@
+/**
+ * @file GameLoop.c
+ *
+ * @brief Event driven loop for running a BopIt game.  The game task blocks
+ * until either an input arrives or the next game deadline expires instead of
+ * polling the game at a fixed rate.  Deadlines are armed with the deadline
+ * service, so they share its single esp_timer with effect timers.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "GameLoop.h"
+#include "Deadline.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define GAMELOOP_US_PER_S 1000000ULL /* Microseconds per second */
+
+/* Globals
+ ******************************************************************************/
+
+static TaskHandle_t GameLoop_TaskHandle = NULL;   /* Handle of the task running the game */
+static TimerWheel_Timer_t GameLoop_DeadlineTimer; /* Timer for waking the game task at the next deadline */
+static uint32_t GameLoop_WakeupCount = 0U;        /* Number of times the game task was woken up */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void GameLoop_DeadlineCallback(void *const context);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize the game loop.  Must be called from the task that will
+ * run the game, after Deadline_Init, and before any other functions in the
+ * module are called.
+ ******************************************************************************/
+void GameLoop_Init(void)
+{
+    GameLoop_TaskHandle = xTaskGetCurrentTaskHandle();
+    TimerWheel_InitTimer(&GameLoop_DeadlineTimer, GameLoop_DeadlineCallback, NULL);
+}
+
+/**
+ * @brief Run a BopIt game until it is over.  Between calls to BopIt_Run, the
+ * calling task blocks until it is notified of an input or the deadline
+ * reported by BopIt_GetRunDelay expires.
+ *
+ * If the deadline cannot be armed, the task polls instead, blocking for the
+ * delay rounded up to whole ticks, so the game never waits forever.
+ *
+ * @note Assumes the game's time function is derived from
+ * esp_timer_get_time.
+ *
+ * @param[in,out] gameContext Context for a BopIt game
+ ******************************************************************************/
+void GameLoop_Run(BopIt_GameContext_t *const gameContext)
+{
+    BopIt_TimeUs_t delay;
+    TickType_t ticks;
+
+    if (gameContext != NULL)
+    {
+        while (gameContext->GameState != BOPIT_GAMESTATE_END)
+        {
+            BopIt_Run(gameContext);
+
+            delay = BopIt_GetRunDelay(gameContext);
+            if (delay > 0U && delay != BOPIT_RUN_DELAY_INFINITE)
+            {
+                if (Deadline_Arm(&GameLoop_DeadlineTimer, (TimerWheel_TimeUs_t)esp_timer_get_time() + delay))
+                {
+                    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                }
+                else
+                {
+                    ticks = (TickType_t)((delay * configTICK_RATE_HZ + GAMELOOP_US_PER_S - 1U) / GAMELOOP_US_PER_S);
+                    ulTaskNotifyTake(pdTRUE, ticks);
+                }
+                (void)Deadline_Cancel(&GameLoop_DeadlineTimer);
+                GameLoop_WakeupCount++;
+            }
+        }
+
+        BopIt_Run(gameContext);
+    }
+}
+
+/**
+ * @brief Notify the game loop that an input was made.  Wakes up the game task
+ * to handle the input.  Must not be called from an ISR.
+ ******************************************************************************/
+void GameLoop_Notify(void)
+{
+    if (GameLoop_TaskHandle != NULL)
+    {
+        xTaskNotifyGive(GameLoop_TaskHandle);
+    }
+}
+
+/**
+ * @brief Notify the game loop that an input was made from an ISR.  Wakes up
+ * the game task to handle the input, yielding to it on ISR exit if it has a
+ * higher priority than the interrupted task.
+ *
+ * @return Whether the game task was notified or not, false if the game loop
+ * was not initialized
+ ******************************************************************************/
+bool IRAM_ATTR GameLoop_NotifyFromIsr(void)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    bool notified = false;
+
+    if (GameLoop_TaskHandle != NULL)
+    {
+        vTaskNotifyGiveFromISR(GameLoop_TaskHandle, &higherPriorityTaskWoken);
+        portYIELD_FROM_ISR(higherPriorityTaskWoken);
+        notified = true;
+    }
+
+    return notified;
+}
+
+/**
+ * @brief Get the number of times the game task was woken up while waiting.
+ *
+ * @return Number of wakeups
+ ******************************************************************************/
+uint32_t GameLoop_GetWakeupCount(void)
+{
+    return GameLoop_WakeupCount;
+}
+
+/**
+ * @brief Deadline timer callback.  Wakes up the game task when the deadline
+ * expires.
+ *
+ * @param[in] context Unused
+ ******************************************************************************/
+static void GameLoop_DeadlineCallback(void *const context)
+{
+    (void)context;
+
+    GameLoop_Notify();
+}
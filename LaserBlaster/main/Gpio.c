@@ -3,133 +3,149 @@
  *
  * @brief Manage GPIO peripherals.
  *
+ * Button and trigger edges are debounced in the GPIO ISR, which publishes each
+ * press of a button as an EVENTBUS_TYPE_BUTTON event and each pull of the
+ * trigger as an EVENTBUS_TYPE_TRIGGER event.  Bounces and releases are not
+ * published.
+ *
  ******************************************************************************/
 
 /* Includes
  ******************************************************************************/
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/queue.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
 #include "Gpio.h"
+#include "hal/gpio_ll.h"
+#include <stddef.h>
 
 /* Defines
  ******************************************************************************/
 
-#define GPIO_EVENT_QUEUE_SIZE 10U     /* Size of event queues */
 #define GPIO_ESP_INTR_FLAG_DEFAULT 0U /* Default to allocating a non-shared interrupt of level 1, 2 or 3 */
-#define GPIO_TASK_STACK_DEPTH 2048U   /* Stack depth for GPIO RTOS tasks */
-#define GPIO_TASK_PRIORITY 10U        /* Priority for GPIO RTOS tasks */
+#define GPIO_BUTTON_COUNT 4U          /* Number of buttons, including the trigger */
+#define GPIO_BUTTON_PRESSED_LEVEL 0U  /* Level of a pressed button, buttons pull the input low */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Button input */
+typedef struct
+{
+    Gpio_GpioNum_t GpioNum;    /* GPIO number of the button */
+    EventBus_Type_t EventType; /* Type of the event published for each press */
+    Debounce_Input_t Debounce; /* Debounce state of the button, only updated by the GPIO ISR */
+} Gpio_Button_t;
 
 /* Globals
  ******************************************************************************/
 
-static StaticQueue_t Gpio_ButtonEventQueue;                                          /* Queue for storing button interrupt events */
-uint8_t Gpio_ButtonEventQueueBuffer[GPIO_EVENT_QUEUE_SIZE * sizeof(Gpio_GpioNum_t)]; /* Statically allocated buffer for button interrupt event queue's storage area */
-static QueueHandle_t Gpio_ButtonEventQueueHandle = NULL;                             /* Handle for queue storing button interrupt events */
-static Gpio_EventHandler_t Gpio_ButtonEventHandler = NULL;                           /* Button event handler registered by client, not be called directly */
+static EventBus_t *Gpio_EventBus = NULL; /* Bus button presses are published on, set before the GPIO ISR is installed */
+static Gpio_Button_t Gpio_Buttons[GPIO_BUTTON_COUNT] = {
+    {.GpioNum = GPIO_BUTTON_0, .EventType = EVENTBUS_TYPE_BUTTON},
+    {.GpioNum = GPIO_BUTTON_1, .EventType = EVENTBUS_TYPE_BUTTON},
+    {.GpioNum = GPIO_BUTTON_2, .EventType = EVENTBUS_TYPE_BUTTON},
+    {.GpioNum = GPIO_TRIGGER, .EventType = EVENTBUS_TYPE_TRIGGER},
+};
+static const Debounce_Config_t Gpio_ButtonDebounceConfig = {
+    .PressLockoutUs = GPIO_BUTTON_PRESS_LOCKOUT_US,
+    .ReleaseLockoutUs = GPIO_BUTTON_RELEASE_LOCKOUT_US,
+};
 
 /* Function Prototypes
  ******************************************************************************/
 
 static void Gpio_ButtonIsrHandler(void *arg);
-static void Gpio_ButtonEventHandlerTask(void *arg);
-static void Gpio_RegisterButtonEventHandler(Gpio_EventHandler_t eventHandler);
 
 /* Function Definitions
  ******************************************************************************/
 
 /**
- * @brief Initialize all GPIO required.
+ * @brief Initialize all GPIO required and start publishing button presses and
+ * trigger pulls on an event bus.  Subscribers may be added to the bus at any
+ * time.
+ *
+ * @param[in] bus Bus to publish events on
  ******************************************************************************/
-void Gpio_Init(void)
+void Gpio_Init(EventBus_t *const bus)
 {
-    /* Initialize button inputs with interrupt on falling edge */
+    /* Initialize pulled up button inputs with interrupt on both edges, so releases can be debounced as well as presses */
     gpio_config_t buttons = {
         .pin_bit_mask = GPIO_BUTTON_PIN_SEL,
         .mode = GPIO_MODE_INPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_NEGEDGE,
+        .intr_type = GPIO_INTR_ANYEDGE,
     };
+
+    for (uint32_t buttonIndex = 0U; buttonIndex < GPIO_BUTTON_COUNT; buttonIndex++)
+    {
+        Debounce_Init(&Gpio_Buttons[buttonIndex].Debounce);
+    }
+
     gpio_config(&buttons);
-}
 
-/**
- * @brief Register handlers for different types of GPIO events.
- *
- * @param[in] gpioType     Type of GPIO to register a handler for
- * @param[in] eventHandler Handler for GPIO event
- ******************************************************************************/
-void Gpio_RegisterEventHandler(const Gpio_Type_t gpioType, Gpio_EventHandler_t eventHandler)
-{
-    if (eventHandler != NULL)
+    if (bus != NULL)
     {
-        switch (gpioType)
+        Gpio_EventBus = bus;
+
+        /* Install GPIO ISR service */
+        gpio_install_isr_service(GPIO_ESP_INTR_FLAG_DEFAULT);
+
+        /* Hook ISR handlers for specific GPIO pins */
+        for (uint32_t buttonIndex = 0U; buttonIndex < GPIO_BUTTON_COUNT; buttonIndex++)
         {
-        case GPIO_TYPE_BUTTON:
-            Gpio_RegisterButtonEventHandler(eventHandler);
-            break;
-        default:
-            break;
+            gpio_isr_handler_add(Gpio_Buttons[buttonIndex].GpioNum, Gpio_ButtonIsrHandler, &Gpio_Buttons[buttonIndex]);
         }
     }
 }
 
 /**
- * @brief GPIO button ISR.  Adds button interrupt event to the button event
- * queue.
+ * @brief Get the debounce statistics of a button.
  *
- * @param[in] arg GPIO number
- ******************************************************************************/
-static void IRAM_ATTR Gpio_ButtonIsrHandler(void *arg)
-{
-    Gpio_GpioNum_t gpioNum = (Gpio_GpioNum_t)arg;
-
-    xQueueSendFromISR(Gpio_ButtonEventQueueHandle, &gpioNum, NULL);
-}
-
-/**
- * @brief Task to handle events in the button event queue.
+ * @param[in]  gpioNum GPIO number of the button
+ * @param[out] stats   Number of presses and releases accepted and bounces
+ * rejected
  *
- * @param[in] arg GPIO number
+ * @return Whether the GPIO is a button or not
  ******************************************************************************/
-static void Gpio_ButtonEventHandlerTask(void *arg)
+bool Gpio_GetDebounceStats(const Gpio_GpioNum_t gpioNum, Debounce_Stats_t *const stats)
 {
-    Gpio_GpioNum_t gpioNum;
+    bool found = false;
 
-    for (;;)
+    if (stats != NULL)
     {
-        if (xQueueReceive(Gpio_ButtonEventQueueHandle, &gpioNum, portMAX_DELAY))
+        for (uint32_t buttonIndex = 0U; buttonIndex < GPIO_BUTTON_COUNT && !found; buttonIndex++)
         {
-            (*Gpio_ButtonEventHandler)(gpioNum); /* Assumes Gpio_RegisterButtonEventHandler checked for NULL pointer */
+            if (Gpio_Buttons[buttonIndex].GpioNum == gpioNum)
+            {
+                Debounce_GetStats(&Gpio_Buttons[buttonIndex].Debounce, stats);
+                found = true;
+            }
         }
     }
+
+    return found;
 }
 
 /**
- * @brief Register a GPIO handler for button events.
+ * @brief GPIO button ISR.  Timestamps the button edge, debounces it and
+ * publishes accepted presses to every subscriber to the button's type of
+ * event.  Bounces and releases are not published.
  *
- * @param[in] eventHandler Handler for GPIO button events
+ * @param[in] arg Button
  ******************************************************************************/
-static void Gpio_RegisterButtonEventHandler(Gpio_EventHandler_t eventHandler)
+static void IRAM_ATTR Gpio_ButtonIsrHandler(void *arg)
 {
-    if (eventHandler != NULL)
-    {
-        /* Assign event handler */
-        Gpio_ButtonEventHandler = eventHandler;
-
-        /* Create a queue to handle GPIO event from ISR */
-        Gpio_ButtonEventQueueHandle = xQueueCreateStatic(GPIO_EVENT_QUEUE_SIZE, sizeof(Gpio_GpioNum_t), Gpio_ButtonEventQueueBuffer, &Gpio_ButtonEventQueue);
+    Gpio_TimeUs_t timeUs = esp_timer_get_time(); /* Timestamp first so the event time does not include ISR latency */
+    Gpio_Button_t *button = (Gpio_Button_t *)arg;
+    bool pressed = gpio_ll_get_level(&GPIO, button->GpioNum) == GPIO_BUTTON_PRESSED_LEVEL;
+    EventBus_Event_t event;
 
-        /* Start task to handle events in the queue */
-        xTaskCreate(Gpio_ButtonEventHandlerTask, "Gpio_ButtonEventHandlerTask", GPIO_TASK_STACK_DEPTH, NULL, GPIO_TASK_PRIORITY, NULL);
-
-        /* Install GPIO ISR service */
-        gpio_install_isr_service(GPIO_ESP_INTR_FLAG_DEFAULT);
-
-        /* Hook ISR handlers for specific GPIO pins */
-        gpio_isr_handler_add(GPIO_BUTTON_0, Gpio_ButtonIsrHandler, (void *)GPIO_BUTTON_0);
-        gpio_isr_handler_add(GPIO_BUTTON_1, Gpio_ButtonIsrHandler, (void *)GPIO_BUTTON_1);
-        gpio_isr_handler_add(GPIO_BUTTON_2, Gpio_ButtonIsrHandler, (void *)GPIO_BUTTON_2);
+    if (Debounce_Edge(&button->Debounce, &Gpio_ButtonDebounceConfig, pressed, timeUs) == DEBOUNCE_EVENT_PRESS)
+    {
+        event.Type = button->EventType;
+        event.TimeUs = timeUs;
+        event.Button.GpioNum = button->GpioNum;
+        (void)EventBus_Publish(Gpio_EventBus, &event); /* Assumes Gpio_Init checked for NULL pointer before installing the ISR */
     }
 }
@@ -0,0 +1,328 @@
+/**
+ * @file Imu.c
+ *
+ * @brief Accelerometer and gyroscope on the I2C bus.
+ *
+ * The sensor, an MPU-6050 or compatible, samples both at 1 kHz into its FIFO.
+ * A task wakes up every IMU_READ_PERIOD_MS, reads every complete sample in the
+ * FIFO in a single burst, and feeds them to the Gesture pipeline, publishing
+ * each gesture recognized on the event bus.  The FIFO holds
+ * 85 samples, so a read can be late by more than a whole period before any
+ * sample is lost.  If it overflows anyway, it is reset and the pipeline
+ * restarted, since the samples are no longer consecutive.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Imu.h"
+#include "driver/i2c_master.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "Monitor.h"
+#include "TaskLayout.h"
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define IMU_I2C_ADDRESS 0x68U                                         /* I2C address of the sensor with AD0 low */
+#define IMU_I2C_SPEED_HZ 400000U                                      /* I2C clock, fast mode, enough for 1 kHz of samples in about a third of the bus time */
+#define IMU_I2C_GLITCH_IGNORE_COUNT 7U                                /* Glitches on the bus shorter than this many clock cycles are ignored */
+#define IMU_I2C_TIMEOUT_MS 50                                         /* Longest time a transfer may take, a full FIFO takes about 25 ms at 400 kHz */
+#define IMU_REG_SMPLRT_DIV 0x19U                                      /* Sample rate divider register */
+#define IMU_REG_CONFIG 0x1AU                                          /* Configuration register, digital low pass filter */
+#define IMU_REG_GYRO_CONFIG 0x1BU                                     /* Gyroscope configuration register, full scale range */
+#define IMU_REG_ACCEL_CONFIG 0x1CU                                    /* Accelerometer configuration register, full scale range */
+#define IMU_REG_FIFO_EN 0x23U                                         /* FIFO enable register, which measurements are written to the FIFO */
+#define IMU_REG_INT_STATUS 0x3AU                                      /* Interrupt status register, cleared on read */
+#define IMU_REG_USER_CTRL 0x6AU                                       /* User control register, FIFO enable and reset */
+#define IMU_REG_PWR_MGMT_1 0x6BU                                      /* Power management register, sleep and clock source */
+#define IMU_REG_FIFO_COUNT_H 0x72U                                    /* High byte of the number of bytes in the FIFO, followed by the low byte */
+#define IMU_REG_FIFO_R_W 0x74U                                        /* FIFO data register */
+#define IMU_REG_WHO_AM_I 0x75U                                        /* Identity register */
+#define IMU_WHO_AM_I 0x68U                                            /* Identity of the sensor */
+#define IMU_SMPLRT_DIV_1KHZ 0x00U                                     /* Sample at the 1 kHz output rate of the filtered gyroscope */
+#define IMU_CONFIG_DLPF_188HZ 0x01U                                   /* Low pass filter at 188 Hz, which sets the gyroscope output rate to 1 kHz */
+#define IMU_GYRO_CONFIG_2000DPS 0x18U                                 /* Gyroscope range of 2000 degrees per second */
+#define IMU_ACCEL_CONFIG_8G 0x10U                                     /* Accelerometer range of 8 g */
+#define IMU_FIFO_EN_ACCEL_GYRO 0x78U                                  /* Accelerometer and gyroscope X, Y and Z written to the FIFO, in the order Gesture unpacks them */
+#define IMU_USER_CTRL_FIFO_EN 0x40U                                   /* Enable the FIFO */
+#define IMU_USER_CTRL_FIFO_RESET 0x04U                                /* Empty the FIFO */
+#define IMU_PWR_MGMT_1_CLK_PLL_X 0x01U                                /* Wake up clocked from the gyroscope X PLL */
+#define IMU_INT_STATUS_FIFO_OFLOW 0x10U                               /* FIFO overflowed */
+#define IMU_SAMPLE_PERIOD_US 1000U                                    /* Time between samples */
+#define IMU_ACCEL_LSB_PER_G 4096U                                     /* Accelerometer counts per g at a range of 8 g */
+#define IMU_GYRO_LSB_PER_KDPS 16400U                                  /* Gyroscope counts per 1000 degrees per second at a range of 2000 degrees per second */
+#define IMU_FIFO_SIZE 1024U                                           /* Size of the sensor's FIFO */
+#define IMU_BURST_SAMPLES (IMU_FIFO_SIZE / GESTURE_FIFO_SAMPLE_SIZE)  /* Most samples read at once, a full FIFO */
+#define IMU_BURST_SIZE (IMU_BURST_SAMPLES * GESTURE_FIFO_SAMPLE_SIZE) /* Most bytes read at once */
+#define IMU_MAX_DETECTIONS 4U                                         /* Most gestures recognized in a burst, one per refractory period */
+#define IMU_READ_PERIOD_MS 20U                                        /* Time between reads of the FIFO */
+
+/* Globals
+ ******************************************************************************/
+
+static const char *Imu_EspLogTag = "Imu"; /* Tag for logging from Imu module */
+
+static i2c_master_bus_handle_t Imu_Bus = NULL;          /* I2C bus of the sensor */
+static i2c_master_dev_handle_t Imu_Device = NULL;       /* Sensor on the bus */
+static TaskHandle_t Imu_TaskHandle = NULL;              /* Handle of the task reading the sensor */
+static EventBus_t *Imu_EventBus = NULL;                 /* Bus gestures are published on, only used by the IMU task */
+static uint8_t Imu_Burst[IMU_BURST_SIZE];               /* Bytes of the last burst read from the FIFO */
+static Gesture_Sample_t Imu_Samples[IMU_BURST_SAMPLES]; /* Samples of the last burst */
+static _Atomic uint32_t Imu_BurstHighWater = 0U;        /* Most samples read at once, only modified by the IMU task */
+static Gesture_Pipeline_t Imu_Pipeline;                 /* Gesture recognition pipeline, only used by the IMU task */
+static Imu_Stats_t Imu_Stats = {0};                     /* Samples read and time spent, only modified by the IMU task */
+static int64_t Imu_StartTimeUs = 0;                     /* Time the IMU task started */
+
+/* Pipeline configuration matching the sensor's configuration */
+static const Gesture_Config_t Imu_GestureConfig = {
+    .SamplePeriodUs = IMU_SAMPLE_PERIOD_US,
+    .AccelLsbPerG = IMU_ACCEL_LSB_PER_G,
+    .GyroLsbPerKdps = IMU_GYRO_LSB_PER_KDPS,
+};
+
+/* Register writes configuring the sensor, in order */
+static const uint8_t Imu_ConfigWrites[][2U] = {
+    {IMU_REG_PWR_MGMT_1, IMU_PWR_MGMT_1_CLK_PLL_X},
+    {IMU_REG_SMPLRT_DIV, IMU_SMPLRT_DIV_1KHZ},
+    {IMU_REG_CONFIG, IMU_CONFIG_DLPF_188HZ},
+    {IMU_REG_GYRO_CONFIG, IMU_GYRO_CONFIG_2000DPS},
+    {IMU_REG_ACCEL_CONFIG, IMU_ACCEL_CONFIG_8G},
+    {IMU_REG_FIFO_EN, IMU_FIFO_EN_ACCEL_GYRO},
+};
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static bool Imu_Configure(void);
+static bool Imu_ReadRegisters(const uint8_t reg, uint8_t *const data, const size_t size);
+static bool Imu_WriteRegister(const uint8_t reg, const uint8_t value);
+static bool Imu_ResetFifo(void);
+static void Imu_Task(void *arg);
+static void Imu_ReadFifo(void);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize the I2C bus, configure the sensor and start the task
+ * reading it.  Blasters without the sensor play without gesture commands.
+ * The task publishes each gesture from the IMU task, not an ISR, with the time
+ * of the last sample of the block it was recognized in.
+ *
+ * @param[in] bus Bus to publish gestures on, gestures are not published if
+ * NULL
+ *
+ * @return Whether the sensor is present and gestures are recognized or not
+ ******************************************************************************/
+bool Imu_Init(EventBus_t *const bus)
+{
+    const i2c_master_bus_config_t busConfig = {
+        .i2c_port = -1,
+        .sda_io_num = GPIO_IMU_SDA,
+        .scl_io_num = GPIO_IMU_SCL,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = IMU_I2C_GLITCH_IGNORE_COUNT,
+        .flags.enable_internal_pullup = true,
+    };
+    const i2c_device_config_t deviceConfig = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = IMU_I2C_ADDRESS,
+        .scl_speed_hz = IMU_I2C_SPEED_HZ,
+    };
+    bool present = false;
+
+    Imu_EventBus = bus;
+
+    if (i2c_new_master_bus(&busConfig, &Imu_Bus) != ESP_OK || i2c_master_bus_add_device(Imu_Bus, &deviceConfig, &Imu_Device) != ESP_OK)
+    {
+        ESP_LOGW(Imu_EspLogTag, "Failed to start I2C, gestures disabled");
+    }
+    else if (!Imu_Configure())
+    {
+        ESP_LOGW(Imu_EspLogTag, "No IMU, gestures disabled");
+    }
+    else if (Gesture_Init(&Imu_Pipeline, &Imu_GestureConfig, NULL) && TaskLayout_Create(TASKLAYOUT_TASK_IMU, Imu_Task, NULL, &Imu_TaskHandle))
+    {
+        Monitor_RegisterBuffer("IMU burst", IMU_BURST_SAMPLES, &Imu_BurstHighWater);
+        present = true;
+    }
+    else
+    {
+        ESP_LOGW(Imu_EspLogTag, "Failed to start IMU task, gestures disabled");
+    }
+
+    return present;
+}
+
+/**
+ * @brief Get the statistics of the IMU.  Counters are read while the IMU task
+ * may update them.
+ *
+ * @param[out] stats Samples read, gestures recognized and time spent
+ ******************************************************************************/
+void Imu_GetStats(Imu_Stats_t *const stats)
+{
+    if (stats != NULL)
+    {
+        *stats = Imu_Stats;
+        stats->Gesture = Imu_Pipeline.Stats;
+        stats->ElapsedUs = (Imu_TaskHandle != NULL) ? (uint64_t)(esp_timer_get_time() - Imu_StartTimeUs) : 0U;
+    }
+}
+
+/**
+ * @brief Check the sensor's identity, configure it to sample into its FIFO
+ * at 1 kHz and start the FIFO.
+ *
+ * @return Whether the sensor was found and configured or not
+ ******************************************************************************/
+static bool Imu_Configure(void)
+{
+    uint8_t whoAmI = 0U;
+    bool configured = Imu_ReadRegisters(IMU_REG_WHO_AM_I, &whoAmI, sizeof(whoAmI)) && (whoAmI == IMU_WHO_AM_I);
+
+    for (uint32_t index = 0U; configured && index < sizeof(Imu_ConfigWrites) / sizeof(Imu_ConfigWrites[0U]); index++)
+    {
+        configured = Imu_WriteRegister(Imu_ConfigWrites[index][0U], Imu_ConfigWrites[index][1U]);
+    }
+
+    return configured && Imu_ResetFifo();
+}
+
+/**
+ * @brief Read consecutive registers of the sensor in a single transfer.
+ *
+ * @param[in]  reg  First register
+ * @param[out] data Values of the registers
+ * @param[in]  size Number of registers
+ *
+ * @return Whether the registers were read or not
+ ******************************************************************************/
+static bool Imu_ReadRegisters(const uint8_t reg, uint8_t *const data, const size_t size)
+{
+    return i2c_master_transmit_receive(Imu_Device, &reg, sizeof(reg), data, size, IMU_I2C_TIMEOUT_MS) == ESP_OK;
+}
+
+/**
+ * @brief Write a register of the sensor.
+ *
+ * @param[in] reg   Register
+ * @param[in] value Value to write
+ *
+ * @return Whether the register was written or not
+ ******************************************************************************/
+static bool Imu_WriteRegister(const uint8_t reg, const uint8_t value)
+{
+    const uint8_t write[2U] = {reg, value};
+
+    return i2c_master_transmit(Imu_Device, write, sizeof(write), IMU_I2C_TIMEOUT_MS) == ESP_OK;
+}
+
+/**
+ * @brief Empty the sensor's FIFO and keep it enabled.
+ *
+ * @return Whether the FIFO was reset or not
+ ******************************************************************************/
+static bool Imu_ResetFifo(void)
+{
+    return Imu_WriteRegister(IMU_REG_USER_CTRL, IMU_USER_CTRL_FIFO_EN | IMU_USER_CTRL_FIFO_RESET);
+}
+
+/**
+ * @brief Task reading the sensor's FIFO every IMU_READ_PERIOD_MS.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void Imu_Task(void *arg)
+{
+    TickType_t lastWakeTime = xTaskGetTickCount();
+
+    (void)arg;
+
+    Imu_StartTimeUs = esp_timer_get_time();
+
+    for (;;)
+    {
+        vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(IMU_READ_PERIOD_MS));
+        Imu_ReadFifo();
+    }
+}
+
+/**
+ * @brief Read every complete sample in the sensor's FIFO and recognize
+ * gestures in them.  The last sample read is taken to have been sampled when
+ * the number of bytes in the FIFO was read, which is within a sample period.
+ ******************************************************************************/
+static void Imu_ReadFifo(void)
+{
+    Gesture_Detection_t detections[IMU_MAX_DETECTIONS];
+    uint8_t status = 0U;
+    uint8_t countBytes[2U] = {0U, 0U};
+    uint32_t size;
+    uint32_t sampleCount;
+    uint32_t detectionCount;
+    int64_t readTimeUs = esp_timer_get_time();
+    int64_t processTimeUs;
+    EventBus_Event_t event;
+
+    if (!Imu_ReadRegisters(IMU_REG_INT_STATUS, &status, sizeof(status)) || !Imu_ReadRegisters(IMU_REG_FIFO_COUNT_H, countBytes, sizeof(countBytes)))
+    {
+        Imu_Stats.ReadErrors++;
+    }
+    else if ((status & IMU_INT_STATUS_FIFO_OFLOW) != 0U)
+    {
+        /* Samples were lost, so the window no longer holds consecutive samples */
+        Imu_Stats.Overflows++;
+        (void)Imu_ResetFifo();
+        (void)Gesture_Init(&Imu_Pipeline, &Imu_GestureConfig, NULL);
+        ESP_LOGW(Imu_EspLogTag, "FIFO overflowed");
+    }
+    else
+    {
+        size = ((uint32_t)countBytes[0U] << 8U) | countBytes[1U];
+        size -= size % GESTURE_FIFO_SAMPLE_SIZE;
+        if (size > IMU_BURST_SIZE)
+        {
+            size = IMU_BURST_SIZE;
+        }
+
+        if (size > 0U && !Imu_ReadRegisters(IMU_REG_FIFO_R_W, Imu_Burst, size))
+        {
+            Imu_Stats.ReadErrors++;
+        }
+        else if (size > 0U)
+        {
+            processTimeUs = esp_timer_get_time();
+            Imu_Stats.ReadUs += (uint64_t)(processTimeUs - readTimeUs);
+            Imu_Stats.Bursts++;
+
+            sampleCount = Gesture_UnpackFifo(Imu_Burst, size, Imu_Samples);
+            if (sampleCount > atomic_load_explicit(&Imu_BurstHighWater, memory_order_relaxed))
+            {
+                atomic_store_explicit(&Imu_BurstHighWater, sampleCount, memory_order_relaxed);
+            }
+
+            detectionCount = Gesture_Process(&Imu_Pipeline, Imu_Samples, sampleCount, (Gesture_TimeUs_t)readTimeUs, detections, IMU_MAX_DETECTIONS);
+            Imu_Stats.ProcessUs += (uint64_t)(esp_timer_get_time() - processTimeUs);
+
+            for (uint32_t index = 0U; index < detectionCount; index++)
+            {
+                ESP_LOGI(Imu_EspLogTag, "%s, score %" PRId32, Gesture_GetName(detections[index].Gesture), detections[index].Score);
+                if (Imu_EventBus != NULL)
+                {
+                    event.Type = EVENTBUS_TYPE_GESTURE;
+                    event.TimeUs = (EventBus_TimeUs_t)detections[index].Time;
+                    event.Gesture.Gesture = (uint32_t)detections[index].Gesture;
+                    (void)EventBus_Publish(Imu_EventBus, &event);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,234 @@
+/**
+ * @file InputStats.c
+ *
+ * @brief Instrumentation of the button input pipeline.  Counters are updated
+ * with relaxed atomics from the GPIO ISR and the game task, and dumped to the
+ * log periodically from the esp_timer task.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "InputStats.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define INPUTSTATS_DUMP_PERIOD_US 10000000ULL /* Period at which statistics are dumped if they changed */
+#define INPUTSTATS_BUFFER_SIZE 256U           /* Size of buffer for formatting the latency histogram */
+
+/* Globals
+ ******************************************************************************/
+
+static const char *InputStats_EspLogTag = "InputStats"; /* Tag for logging input statistics */
+
+#if INPUTSTATS_ENABLED
+static _Atomic uint32_t InputStats_Latched = 0U;                        /* Number of presses latched for the game */
+static _Atomic uint32_t InputStats_Coalesced = 0U;                      /* Number of presses coalesced with a press not taken yet */
+static _Atomic uint32_t InputStats_NotifyFailures = 0U;                 /* Number of presses the ISR could not wake the game task for */
+static _Atomic uint32_t InputStats_PendingHighWater = 0U;               /* Most presses latched and not taken at once */
+static _Atomic uint32_t InputStats_Taken = 0U;                          /* Number of presses taken by the game */
+static _Atomic uint32_t InputStats_LatchTimes[INPUTSTATS_MAX_INPUTS];   /* Low 32 bits of the time in microseconds each pending press was latched */
+static _Atomic uint32_t InputStats_Latency[INPUTSTATS_LATENCY_BUCKETS]; /* Log2 histogram of microseconds from the ISR to the game taking a press */
+static esp_timer_handle_t InputStats_DumpTimer = NULL;                  /* Periodic timer dumping statistics */
+static uint32_t InputStats_DumpedLatched = 0U;                          /* Number of presses latched at the last dump */
+#endif
+
+/* Function Prototypes
+ ******************************************************************************/
+
+#if INPUTSTATS_ENABLED
+static void InputStats_DumpCallback(void *arg);
+#endif
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize input statistics and start dumping them periodically.
+ * Does nothing if the input pipeline is not instrumented.
+ ******************************************************************************/
+void InputStats_Init(void)
+{
+#if INPUTSTATS_ENABLED
+    esp_timer_create_args_t dumpTimerArgs = {
+        .callback = InputStats_DumpCallback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "InputStats_DumpTimer",
+    };
+
+    if (esp_timer_create(&dumpTimerArgs, &InputStats_DumpTimer) == ESP_OK)
+    {
+        esp_timer_start_periodic(InputStats_DumpTimer, INPUTSTATS_DUMP_PERIOD_US);
+    }
+#endif
+}
+
+/**
+ * @brief Get the statistics of the input pipeline.  Counters are read one at
+ * a time, so they may be from slightly different moments.
+ *
+ * @param[out] stats Statistics of the input pipeline, all zero if the input
+ * pipeline is not instrumented
+ ******************************************************************************/
+void InputStats_Get(InputStats_t *const stats)
+{
+    if (stats != NULL)
+    {
+        memset(stats, 0, sizeof(InputStats_t));
+
+#if INPUTSTATS_ENABLED
+        stats->Latched = atomic_load_explicit(&InputStats_Latched, memory_order_relaxed);
+        stats->Coalesced = atomic_load_explicit(&InputStats_Coalesced, memory_order_relaxed);
+        stats->NotifyFailures = atomic_load_explicit(&InputStats_NotifyFailures, memory_order_relaxed);
+        stats->PendingHighWater = atomic_load_explicit(&InputStats_PendingHighWater, memory_order_relaxed);
+        stats->Taken = atomic_load_explicit(&InputStats_Taken, memory_order_relaxed);
+        for (uint32_t bucket = 0U; bucket < INPUTSTATS_LATENCY_BUCKETS; bucket++)
+        {
+            stats->Latency[bucket] = atomic_load_explicit(&InputStats_Latency[bucket], memory_order_relaxed);
+        }
+#endif
+    }
+}
+
+/**
+ * @brief Log the statistics of the input pipeline.  The latency histogram is
+ * logged as the upper bound of each non-empty bucket in microseconds and its
+ * count.
+ ******************************************************************************/
+void InputStats_Dump(void)
+{
+    InputStats_t stats;
+    char buffer[INPUTSTATS_BUFFER_SIZE];
+    size_t length = 0U;
+    int written;
+
+    InputStats_Get(&stats);
+
+    ESP_LOGI(InputStats_EspLogTag, "latched %" PRIu32 ", coalesced %" PRIu32 ", notify failures %" PRIu32 ", pending high water %" PRIu32 ", taken %" PRIu32, stats.Latched, stats.Coalesced, stats.NotifyFailures, stats.PendingHighWater,
+             stats.Taken);
+
+    buffer[0U] = '\0';
+    for (uint32_t bucket = 0U; bucket < INPUTSTATS_LATENCY_BUCKETS && length < INPUTSTATS_BUFFER_SIZE; bucket++)
+    {
+        if (stats.Latency[bucket] > 0U)
+        {
+            if (bucket == (INPUTSTATS_LATENCY_BUCKETS - 1U))
+            {
+                written = snprintf(&buffer[length], INPUTSTATS_BUFFER_SIZE - length, " >=%" PRIu32 ":%" PRIu32, (uint32_t)1U << (bucket - 1U), stats.Latency[bucket]);
+            }
+            else
+            {
+                written = snprintf(&buffer[length], INPUTSTATS_BUFFER_SIZE - length, " <%" PRIu32 ":%" PRIu32, (uint32_t)1U << bucket, stats.Latency[bucket]);
+            }
+            length += (written > 0) ? (size_t)written : 0U;
+        }
+    }
+
+    ESP_LOGI(InputStats_EspLogTag, "latency us%s", buffer);
+}
+
+#if INPUTSTATS_ENABLED
+/**
+ * @brief Record a press latched for the game.  The press is timestamped by the
+ * GPIO ISR and latched when the game task drains its button events.
+ *
+ * @note Called from the game task.
+ *
+ * @param[in] inputIndex Index of the input pressed, less than
+ * INPUTSTATS_MAX_INPUTS
+ * @param[in] latched    Whether the press was newly latched, false if it was
+ * coalesced with a press not taken yet
+ * @param[in] pending    Bitmask of presses latched and not taken, including
+ * this one
+ * @param[in] timeUs     Time of the press in microseconds
+ ******************************************************************************/
+void InputStats_RecordLatch(const uint32_t inputIndex, const bool latched, const uint32_t pending, const int64_t timeUs)
+{
+    uint32_t pendingCount = (uint32_t)__builtin_popcount(pending);
+    uint32_t highWater = atomic_load_explicit(&InputStats_PendingHighWater, memory_order_relaxed);
+
+    if (latched)
+    {
+        atomic_store_explicit(&InputStats_LatchTimes[inputIndex], (uint32_t)timeUs, memory_order_relaxed);
+        atomic_fetch_add_explicit(&InputStats_Latched, 1U, memory_order_relaxed);
+    }
+    else
+    {
+        atomic_fetch_add_explicit(&InputStats_Coalesced, 1U, memory_order_relaxed);
+    }
+
+    while (pendingCount > highWater && !atomic_compare_exchange_weak_explicit(&InputStats_PendingHighWater, &highWater, pendingCount, memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+}
+
+/**
+ * @brief Record the GPIO ISR failing to wake the game task for a press.
+ *
+ * @note Called from the GPIO ISR.
+ ******************************************************************************/
+void IRAM_ATTR InputStats_RecordNotifyFailure(void)
+{
+    atomic_fetch_add_explicit(&InputStats_NotifyFailures, 1U, memory_order_relaxed);
+}
+
+/**
+ * @brief Record presses taken by the game and the latency of each from the
+ * GPIO ISR.
+ *
+ * @param[in] inputs Bitmask of the inputs taken
+ ******************************************************************************/
+void InputStats_RecordTake(const uint32_t inputs)
+{
+    uint32_t nowUs = (uint32_t)esp_timer_get_time();
+    uint32_t remaining = inputs;
+    uint32_t inputIndex;
+    uint32_t latencyUs;
+    uint32_t bucket;
+
+    while (remaining != 0U)
+    {
+        inputIndex = (uint32_t)__builtin_ctz(remaining);
+        remaining &= remaining - 1U;
+
+        /* Difference of the low 32 bits is correct across wrap around */
+        latencyUs = nowUs - atomic_load_explicit(&InputStats_LatchTimes[inputIndex], memory_order_relaxed);
+        bucket = (latencyUs == 0U) ? 0U : (32U - (uint32_t)__builtin_clz(latencyUs));
+        if (bucket >= INPUTSTATS_LATENCY_BUCKETS)
+        {
+            bucket = INPUTSTATS_LATENCY_BUCKETS - 1U;
+        }
+
+        atomic_fetch_add_explicit(&InputStats_Latency[bucket], 1U, memory_order_relaxed);
+        atomic_fetch_add_explicit(&InputStats_Taken, 1U, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Dump timer callback.  Dumps the statistics if any presses were
+ * latched since the last dump.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void InputStats_DumpCallback(void *arg)
+{
+    uint32_t latched = atomic_load_explicit(&InputStats_Latched, memory_order_relaxed);
+
+    (void)arg;
+
+    if (latched != InputStats_DumpedLatched)
+    {
+        InputStats_DumpedLatched = latched;
+        InputStats_Dump();
+    }
+}
+#endif
@@ -0,0 +1,399 @@
+/**
+ * @file Ir.c
+ *
+ * @brief Infrared transmitter and receiver for laser tag shots.
+ *
+ * Shots are sent by the RMT transmit channel as symbols copied from an
+ * encoded frame, modulated on the carrier IR receiver modules demodulate.  A
+ * task subscribed to trigger events fires a shot for each pull, so the GPIO
+ * ISR never waits for the previous shot to be sent.  The
+ * RMT receive channel captures the demodulated signal until it is idle for
+ * longer than any pulse of a frame, then a task converts the captured symbols
+ * into pulses, feeds them to the IrShot decoder and publishes each hit on the
+ * event bus.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Ir.h"
+#include "driver/rmt_rx.h"
+#include "driver/rmt_tx.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "Monitor.h"
+#include "TaskLayout.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define IR_RESOLUTION_HZ 1000000U                /* RMT tick rate, one tick per microsecond to match IrShot pulse durations */
+#define IR_CARRIER_FREQUENCY_HZ 38000U           /* Carrier frequency of the IR receiver modules */
+#define IR_CARRIER_DUTY_CYCLE 0.33f              /* Duty cycle of the carrier */
+#define IR_MEM_BLOCK_SYMBOLS 64U                 /* RMT memory reserved for each channel */
+#define IR_TX_QUEUE_DEPTH 1U                     /* Number of transmissions that can be pending */
+#define IR_TX_SYMBOLS (IRSHOT_FRAME_PULSES / 2U) /* Number of RMT symbols of a frame, a mark and a space each */
+#define IR_TX_TIMEOUT_MS 100                     /* Longest time to wait for the previous shot to be sent */
+#define IR_RX_SYMBOLS 64U                        /* Number of RMT symbols that can be captured at once */
+#define IR_RX_PULSES (2U * IR_RX_SYMBOLS)        /* Number of pulses the captured symbols can hold */
+#define IR_RX_MIN_PULSE_NS 1000U                 /* Pulses shorter than this are filtered out as glitches */
+#define IR_RX_IDLE_NS 5000000U                   /* Capture ends when the signal is idle for this long, longer than any pulse of a frame */
+#define IR_RX_MARK_LEVEL 0U                      /* Level of a mark at the output of the IR receiver module, which is active low */
+#define IR_RX_MAX_SHOTS 2U                       /* Number of shots that can be decoded from a single capture */
+#define IR_HIT_VALID 0x01000000UL                /* Set in the packed last hit once a hit was received */
+#define IR_HIT_PLAYER_ID_SHIFT 16U               /* Position of the player ID in the packed last hit */
+#define IR_HIT_TEAM_SHIFT 8U                     /* Position of the team in the packed last hit */
+#define IR_HIT_FIELD_MASK 0xFFU                  /* Mask of a field of the packed last hit */
+#define IR_MAC_SIZE 6U                           /* Size of a MAC address */
+
+/* Globals
+ ******************************************************************************/
+
+static const char *Ir_EspLogTag = "Ir"; /* Tag for logging from Ir module */
+
+static rmt_channel_handle_t Ir_TxChannel = NULL;      /* RMT channel sending shots */
+static rmt_channel_handle_t Ir_RxChannel = NULL;      /* RMT channel capturing shots */
+static rmt_encoder_handle_t Ir_CopyEncoder = NULL;    /* Encoder copying symbols of encoded frames to the RMT */
+static TaskHandle_t Ir_TaskHandle = NULL;             /* Handle of the task decoding captured shots */
+static TaskHandle_t Ir_FireTaskHandle = NULL;         /* Handle of the task firing shots */
+static EventBus_Subscriber_t Ir_TriggerSubscriber;    /* Subscriber to trigger events, only received from by the fire task */
+static EventBus_t *Ir_EventBus = NULL;                /* Bus hits are published on, only used by the receive task */
+static uint8_t Ir_PlayerId = IR_DEFAULT_PLAYER_ID;    /* ID of the player using this blaster, set before the tasks are started */
+static rmt_symbol_word_t Ir_TxSymbols[IR_TX_SYMBOLS]; /* Symbols of the shot being sent, read by the RMT until it is sent */
+static rmt_symbol_word_t Ir_RxSymbols[IR_RX_SYMBOLS]; /* Symbols written by the RMT during a capture */
+static volatile size_t Ir_RxSymbolCount = 0U;         /* Number of symbols of the last capture, set by the receive callback */
+static _Atomic uint32_t Ir_RxSymbolHighWater = 0U;    /* Most symbols captured at once, only modified by the receive task */
+static IrShot_Decoder_t Ir_Decoder;                   /* Decoder of captured shots, only used by the receive task */
+static _Atomic uint32_t Ir_LastHit = 0U;              /* Last hit received, packed into a word so it can be read from any task */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static bool Ir_RxDoneCallback(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *eventData, void *userData);
+static void Ir_Task(void *arg);
+static void Ir_NotifyFromIsr(void *const context);
+static void Ir_FireTask(void *arg);
+static uint32_t Ir_SymbolsToPulses(const rmt_symbol_word_t *const symbols, const size_t symbolCount, IrShot_Pulse_t *const pulses);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Initialize the IR transmitter and receiver and start the tasks firing
+ * shots and decoding captured shots.  A shot is fired for each trigger event
+ * on the bus.  The receive task publishes each hit from the IR receive task,
+ * not an ISR, with GPIO_IR_RX and the time the shot was captured.  The
+ * player ID is read from the MAC address first, so the tasks only ever see
+ * this blaster's ID.
+ *
+ * @param[in] bus Bus to fire shots from and publish hits on, shots are not
+ * fired and hits are not published if NULL
+ ******************************************************************************/
+void Ir_Init(EventBus_t *const bus)
+{
+    rmt_tx_channel_config_t txConfig = {
+        .gpio_num = GPIO_IR_TX,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = IR_RESOLUTION_HZ,
+        .mem_block_symbols = IR_MEM_BLOCK_SYMBOLS,
+        .trans_queue_depth = IR_TX_QUEUE_DEPTH,
+    };
+    rmt_carrier_config_t carrierConfig = {
+        .frequency_hz = IR_CARRIER_FREQUENCY_HZ,
+        .duty_cycle = IR_CARRIER_DUTY_CYCLE,
+    };
+    rmt_copy_encoder_config_t copyEncoderConfig = {0};
+    rmt_rx_channel_config_t rxConfig = {
+        .gpio_num = GPIO_IR_RX,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = IR_RESOLUTION_HZ,
+        .mem_block_symbols = IR_MEM_BLOCK_SYMBOLS,
+    };
+    rmt_rx_event_callbacks_t rxCallbacks = {
+        .on_recv_done = Ir_RxDoneCallback,
+    };
+    uint8_t mac[IR_MAC_SIZE] = {0U};
+
+    if (esp_read_mac(mac, ESP_MAC_WIFI_STA) == ESP_OK)
+    {
+        Ir_PlayerId = mac[IR_MAC_SIZE - 1U];
+        ESP_LOGI(Ir_EspLogTag, "Player %u", Ir_PlayerId);
+    }
+    else
+    {
+        ESP_LOGW(Ir_EspLogTag, "Failed to read MAC address, using player %u", Ir_PlayerId);
+    }
+
+    IrShot_DecoderInit(&Ir_Decoder);
+    Ir_EventBus = bus;
+
+    if (rmt_new_tx_channel(&txConfig, &Ir_TxChannel) == ESP_OK)
+    {
+        rmt_apply_carrier(Ir_TxChannel, &carrierConfig);
+        rmt_new_copy_encoder(&copyEncoderConfig, &Ir_CopyEncoder);
+        rmt_enable(Ir_TxChannel);
+
+        /* Task must exist before the first trigger event notifies it */
+        if (bus != NULL && TaskLayout_Create(TASKLAYOUT_TASK_IR_FIRE, Ir_FireTask, NULL, &Ir_FireTaskHandle) &&
+            !EventBus_Subscribe(bus, EVENTBUS_TYPE_TRIGGER, &Ir_TriggerSubscriber, Ir_NotifyFromIsr, NULL))
+        {
+            ESP_LOGE(Ir_EspLogTag, "Failed to subscribe to trigger events");
+        }
+    }
+
+    if (rmt_new_rx_channel(&rxConfig, &Ir_RxChannel) == ESP_OK)
+    {
+        /* Task must exist before the first capture can complete */
+        (void)TaskLayout_Create(TASKLAYOUT_TASK_IR, Ir_Task, NULL, &Ir_TaskHandle);
+        Monitor_RegisterBuffer("IR symbols", IR_RX_SYMBOLS, &Ir_RxSymbolHighWater);
+        rmt_rx_register_event_callbacks(Ir_RxChannel, &rxCallbacks, NULL);
+        rmt_enable(Ir_RxChannel);
+        xTaskNotifyGive(Ir_TaskHandle);
+    }
+}
+
+/**
+ * @brief Fire a shot from this blaster.  Waits for the previous shot to be
+ * sent first, since the RMT reads the symbols of a shot while sending it.
+ *
+ * @note Called from the fire task, and must not be called from an ISR.
+ *
+ * @return Whether the shot was queued for sending or not
+ ******************************************************************************/
+bool Ir_Fire(void)
+{
+    const IrShot_Shot_t shot = {
+        .PlayerId = Ir_PlayerId,
+        .Team = IR_TEAM,
+        .Damage = IR_DAMAGE,
+    };
+    const rmt_transmit_config_t transmitConfig = {
+        .loop_count = 0,
+    };
+    IrShot_Pulse_t pulses[IRSHOT_FRAME_PULSES];
+    uint32_t pulseCount;
+    bool fired = false;
+
+    if (Ir_TxChannel != NULL && rmt_tx_wait_all_done(Ir_TxChannel, IR_TX_TIMEOUT_MS) == ESP_OK)
+    {
+        pulseCount = IrShot_Encode(&shot, pulses, IRSHOT_FRAME_PULSES);
+
+        /* Frames alternate marks and spaces starting with a mark, so each pair is a symbol */
+        for (uint32_t pulseIndex = 0U; (pulseIndex + 1U) < pulseCount; pulseIndex += 2U)
+        {
+            Ir_TxSymbols[pulseIndex / 2U] = (rmt_symbol_word_t){
+                .duration0 = pulses[pulseIndex].DurationUs,
+                .level0 = 1U,
+                .duration1 = pulses[pulseIndex + 1U].DurationUs,
+                .level1 = 0U,
+            };
+        }
+
+        fired = (rmt_transmit(Ir_TxChannel, Ir_CopyEncoder, Ir_TxSymbols, (pulseCount / 2U) * sizeof(rmt_symbol_word_t), &transmitConfig) == ESP_OK);
+    }
+
+    return fired;
+}
+
+/**
+ * @brief Get the last hit received.
+ *
+ * @param[out] shot Last shot that hit this blaster, only written if a hit was
+ * received
+ *
+ * @return Whether a hit was received since boot or not
+ ******************************************************************************/
+bool Ir_GetLastHit(IrShot_Shot_t *const shot)
+{
+    uint32_t lastHit;
+    bool hit = false;
+
+    if (shot != NULL)
+    {
+        lastHit = atomic_load_explicit(&Ir_LastHit, memory_order_relaxed);
+        if ((lastHit & IR_HIT_VALID) != 0U)
+        {
+            shot->PlayerId = (uint8_t)((lastHit >> IR_HIT_PLAYER_ID_SHIFT) & IR_HIT_FIELD_MASK);
+            shot->Team = (uint8_t)((lastHit >> IR_HIT_TEAM_SHIFT) & IR_HIT_FIELD_MASK);
+            shot->Damage = (uint8_t)(lastHit & IR_HIT_FIELD_MASK);
+            hit = true;
+        }
+    }
+
+    return hit;
+}
+
+/**
+ * @brief Get the statistics of the decoder of captured shots.  Counters are
+ * read while the receive task may update them.
+ *
+ * @param[out] stats Number of shots decoded and frames with errors
+ ******************************************************************************/
+void Ir_GetStats(IrShot_Stats_t *const stats)
+{
+    if (stats != NULL)
+    {
+        *stats = Ir_Decoder.Stats;
+    }
+}
+
+/**
+ * @brief RMT receive done callback.  Wakes up the receive task to decode the
+ * captured symbols.
+ *
+ * @note Called from the RMT ISR.
+ *
+ * @param[in] channel   RMT channel that captured the symbols
+ * @param[in] eventData Captured symbols
+ * @param[in] userData  Unused
+ *
+ * @return Whether a higher priority task was woken or not
+ ******************************************************************************/
+static bool IRAM_ATTR Ir_RxDoneCallback(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *eventData, void *userData)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    (void)channel;
+    (void)userData;
+
+    Ir_RxSymbolCount = eventData->num_symbols;
+    vTaskNotifyGiveFromISR(Ir_TaskHandle, &higherPriorityTaskWoken);
+
+    return higherPriorityTaskWoken == pdTRUE;
+}
+
+/**
+ * @brief Task decoding captured shots.  Starts a capture, waits for it to
+ * complete and decodes it, ignoring shots from this blaster's own player that
+ * were reflected back to it.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void Ir_Task(void *arg)
+{
+    const rmt_receive_config_t receiveConfig = {
+        .signal_range_min_ns = IR_RX_MIN_PULSE_NS,
+        .signal_range_max_ns = IR_RX_IDLE_NS,
+    };
+    IrShot_Pulse_t pulses[IR_RX_PULSES];
+    IrShot_Shot_t shots[IR_RX_MAX_SHOTS];
+    uint32_t pulseCount;
+    uint32_t shotCount;
+    Gpio_TimeUs_t timeUs;
+    EventBus_Event_t event;
+
+    (void)arg;
+
+    /* Wait for the receive channel to be enabled */
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    for (;;)
+    {
+        rmt_receive(Ir_RxChannel, Ir_RxSymbols, sizeof(Ir_RxSymbols), &receiveConfig);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        timeUs = esp_timer_get_time();
+
+        if (Ir_RxSymbolCount > atomic_load_explicit(&Ir_RxSymbolHighWater, memory_order_relaxed))
+        {
+            atomic_store_explicit(&Ir_RxSymbolHighWater, (uint32_t)Ir_RxSymbolCount, memory_order_relaxed);
+        }
+
+        pulseCount = Ir_SymbolsToPulses(Ir_RxSymbols, Ir_RxSymbolCount, pulses);
+        shotCount = IrShot_Decode(&Ir_Decoder, pulses, pulseCount, shots, IR_RX_MAX_SHOTS);
+
+        for (uint32_t shotIndex = 0U; shotIndex < shotCount; shotIndex++)
+        {
+            if (IrShot_IsHit(&shots[shotIndex], Ir_PlayerId))
+            {
+                atomic_store_explicit(&Ir_LastHit, IR_HIT_VALID | ((uint32_t)shots[shotIndex].PlayerId << IR_HIT_PLAYER_ID_SHIFT) | ((uint32_t)shots[shotIndex].Team << IR_HIT_TEAM_SHIFT) | shots[shotIndex].Damage, memory_order_relaxed);
+                ESP_LOGI(Ir_EspLogTag, "Hit by player %u of team %u, damage %u", shots[shotIndex].PlayerId, shots[shotIndex].Team, shots[shotIndex].Damage);
+
+                if (Ir_EventBus != NULL)
+                {
+                    event.Type = EVENTBUS_TYPE_HIT;
+                    event.TimeUs = timeUs;
+                    event.Hit.GpioNum = GPIO_IR_RX;
+                    (void)EventBus_Publish(Ir_EventBus, &event);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Wake up the fire task to fire a shot for a trigger event.
+ *
+ * @note Called from the GPIO ISR.
+ *
+ * @param[in] context Unused
+ ******************************************************************************/
+static void IRAM_ATTR Ir_NotifyFromIsr(void *const context)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    (void)context;
+
+    vTaskNotifyGiveFromISR(Ir_FireTaskHandle, &higherPriorityTaskWoken);
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+/**
+ * @brief Task firing shots.  Fires a shot for each trigger event received, one
+ * after another, so pulls made while a shot is sent are fired once it is.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void Ir_FireTask(void *arg)
+{
+    EventBus_Event_t event;
+
+    (void)arg;
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (EventBus_Receive(&Ir_TriggerSubscriber, &event))
+        {
+            if (!Ir_Fire())
+            {
+                ESP_LOGW(Ir_EspLogTag, "Failed to fire shot");
+            }
+        }
+    }
+}
+
+/**
+ * @brief Convert captured RMT symbols into pulses for the decoder.  Zero
+ * duration halves, which mark the end of a capture, are skipped.
+ *
+ * @param[in]  symbols     Captured symbols
+ * @param[in]  symbolCount Number of captured symbols
+ * @param[out] pulses      Pulses of the capture, room for two per symbol
+ *
+ * @return Number of pulses written
+ ******************************************************************************/
+static uint32_t Ir_SymbolsToPulses(const rmt_symbol_word_t *const symbols, const size_t symbolCount, IrShot_Pulse_t *const pulses)
+{
+    uint32_t pulseCount = 0U;
+
+    for (size_t symbolIndex = 0U; symbolIndex < symbolCount; symbolIndex++)
+    {
+        if (symbols[symbolIndex].duration0 > 0U)
+        {
+            pulses[pulseCount++] = (IrShot_Pulse_t){.DurationUs = symbols[symbolIndex].duration0, .Mark = (symbols[symbolIndex].level0 == IR_RX_MARK_LEVEL)};
+        }
+        if (symbols[symbolIndex].duration1 > 0U)
+        {
+            pulses[pulseCount++] = (IrShot_Pulse_t){.DurationUs = symbols[symbolIndex].duration1, .Mark = (symbols[symbolIndex].level1 == IR_RX_MARK_LEVEL)};
+        }
+    }
+
+    return pulseCount;
+}
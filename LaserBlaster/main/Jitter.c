@@ -0,0 +1,387 @@
+/**
+ * @file Jitter.c
+ *
+ * @brief Scheduling jitter benchmark for comparing task layouts.  Inputs come
+ * from the alarm of a general purpose timer, whose ISR is installed from
+ * app_main and so runs on the input core like the GPIO and RMT ISRs.  The ISR
+ * stamps the time and notifies the probe, as the button ISR stamps a press and
+ * notifies the game.  Its period is prime so inputs drift across the probe's
+ * period.  Deadlines have the deadline service's resolution, so lateness
+ * includes up to a tick of rounding, as the game's does.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Jitter.h"
+#include "Deadline.h"
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "TaskLayout.h"
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define JITTER_PERIOD_US 10000U             /* Period of the probe's deadlines */
+#define JITTER_INPUT_PERIOD_US 7919U        /* Period of the inputs, prime so they drift across the probe's period */
+#define JITTER_TIMER_RESOLUTION_HZ 1000000U /* Resolution of the input timer, one count per microsecond */
+#define JITTER_NOTIFY_START 0x01U           /* Notification bit starting a phase */
+#define JITTER_NOTIFY_STOP 0x02U            /* Notification bit ending a phase */
+#define JITTER_NOTIFY_DEADLINE 0x04U        /* Notification bit of a deadline expiring */
+#define JITTER_NOTIFY_INPUT 0x08U           /* Notification bit of an input */
+#define JITTER_NOTIFY_ALL UINT32_MAX        /* Notification bits cleared on waking */
+#define JITTER_BUSY_US 2000U                /* Duration of each burst of the input load, once per tick */
+#define JITTER_LOG_BURST 16U                /* Number of lines logged in each burst of the log load, once per tick */
+#define JITTER_BUFFER_SIZE 256U             /* Size of buffer for formatting a histogram */
+
+/* Globals
+ ******************************************************************************/
+
+static const char *Jitter_EspLogTag = "Jitter"; /* Tag for logging from Jitter module */
+
+static const char *Jitter_PhaseNames[JITTER_PHASE_COUNT] = {
+    [JITTER_PHASE_IDLE] = "idle",
+    [JITTER_PHASE_LOADED] = "loaded",
+};
+
+static TaskHandle_t Jitter_RunTaskHandle = NULL;           /* Handle of the task running the benchmark, notified when the probe ends a phase */
+static TaskHandle_t Jitter_ProbeTaskHandle = NULL;         /* Handle of the probe task */
+static TaskHandle_t Jitter_InputLoadTaskHandle = NULL;     /* Handle of the task loading the input core with busy bursts */
+static TaskHandle_t Jitter_LogLoadTaskHandle = NULL;       /* Handle of the task loading the input core with logging */
+static gptimer_handle_t Jitter_InputTimer = NULL;          /* Timer raising inputs */
+static TimerWheel_Timer_t Jitter_DeadlineTimer;            /* Timer for waking the probe at its next deadline */
+static _Atomic uint32_t Jitter_InputTimeUs = 0U;           /* Low 32 bits of the time in microseconds of the last input */
+static _Atomic bool Jitter_LoadRunning = false;            /* Whether the load tasks are running */
+static Jitter_Phase_t Jitter_Phase = JITTER_PHASE_IDLE;    /* Phase running, set while the probe is stopped */
+static Jitter_Result_t Jitter_Results[JITTER_PHASE_COUNT]; /* Results of each phase, only modified by the probe task */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void Jitter_ProbeTask(void *arg);
+static void Jitter_InputLoadTask(void *arg);
+static void Jitter_LogLoadTask(void *arg);
+static bool Jitter_StartInputTimer(void);
+static bool Jitter_InputAlarmCallback(gptimer_handle_t timer, const gptimer_alarm_event_data_t *eventData, void *userData);
+static void Jitter_DeadlineCallback(void *const context);
+static void Jitter_Record(Jitter_Histogram_t *const histogram, const uint32_t valueUs);
+static void Jitter_ReportHistogram(const char *const phaseName, const char *const name, const Jitter_Histogram_t *const histogram);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Run the benchmark and log its results.  Must be called from app_main,
+ * after Deadline_Init and before the game task is created, so the input ISR
+ * runs on the input core and the probe has the game core to itself.  Blocks
+ * for JITTER_PHASE_MS for each phase.
+ ******************************************************************************/
+void Jitter_Run(void)
+{
+    Jitter_RunTaskHandle = xTaskGetCurrentTaskHandle();
+    TimerWheel_InitTimer(&Jitter_DeadlineTimer, Jitter_DeadlineCallback, NULL);
+
+    if (!Jitter_StartInputTimer() || !TaskLayout_Create(TASKLAYOUT_TASK_GAME, Jitter_ProbeTask, NULL, &Jitter_ProbeTaskHandle) ||
+        !TaskLayout_Create(TASKLAYOUT_TASK_JITTER_INPUT_LOAD, Jitter_InputLoadTask, NULL, &Jitter_InputLoadTaskHandle) ||
+        !TaskLayout_Create(TASKLAYOUT_TASK_JITTER_LOG_LOAD, Jitter_LogLoadTask, NULL, &Jitter_LogLoadTaskHandle))
+    {
+        ESP_LOGW(Jitter_EspLogTag, "Failed to start jitter benchmark");
+    }
+    else
+    {
+        TaskLayout_Report();
+
+        for (uint32_t phase = 0U; phase < JITTER_PHASE_COUNT; phase++)
+        {
+            ESP_LOGI(Jitter_EspLogTag, "Running %s phase for %" PRIu32 " ms", Jitter_PhaseNames[phase], JITTER_PHASE_MS);
+
+            Jitter_Phase = (Jitter_Phase_t)phase;
+            if (phase == JITTER_PHASE_LOADED)
+            {
+                atomic_store_explicit(&Jitter_LoadRunning, true, memory_order_relaxed);
+                xTaskNotifyGive(Jitter_InputLoadTaskHandle);
+                xTaskNotifyGive(Jitter_LogLoadTaskHandle);
+            }
+
+            xTaskNotify(Jitter_ProbeTaskHandle, JITTER_NOTIFY_START, eSetBits);
+            vTaskDelay(pdMS_TO_TICKS(JITTER_PHASE_MS));
+            xTaskNotify(Jitter_ProbeTaskHandle, JITTER_NOTIFY_STOP, eSetBits);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+            atomic_store_explicit(&Jitter_LoadRunning, false, memory_order_relaxed);
+        }
+
+        (void)gptimer_stop(Jitter_InputTimer);
+
+        for (uint32_t phase = 0U; phase < JITTER_PHASE_COUNT; phase++)
+        {
+            Jitter_ReportHistogram(Jitter_PhaseNames[phase], "period deviation", &Jitter_Results[phase].Period);
+            Jitter_ReportHistogram(Jitter_PhaseNames[phase], "input latency", &Jitter_Results[phase].Input);
+            ESP_LOGI(Jitter_EspLogTag, "%s overruns %" PRIu32, Jitter_PhaseNames[phase], Jitter_Results[phase].Overruns);
+        }
+    }
+}
+
+/**
+ * @brief Task standing in for the game task.  Waits for notifications like the
+ * game loop, and records how late it wakes for each deadline and each input
+ * while a phase is running.  Deadlines are kept on a fixed schedule, so a late
+ * wake does not delay the deadlines after it.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void Jitter_ProbeTask(void *arg)
+{
+    Jitter_Result_t *result = &Jitter_Results[JITTER_PHASE_IDLE];
+    bool running = false;
+    int64_t expiryUs = 0;
+    int64_t nowUs;
+    uint32_t bits;
+
+    (void)arg;
+
+    for (;;)
+    {
+        (void)xTaskNotifyWait(0U, JITTER_NOTIFY_ALL, &bits, portMAX_DELAY);
+        nowUs = esp_timer_get_time();
+
+        if ((bits & JITTER_NOTIFY_START) != 0U)
+        {
+            /* Notifications left over from the last phase are dropped */
+            result = &Jitter_Results[Jitter_Phase];
+            running = true;
+            expiryUs = nowUs + JITTER_PERIOD_US;
+            (void)Deadline_Arm(&Jitter_DeadlineTimer, (TimerWheel_TimeUs_t)expiryUs);
+            bits &= ~(JITTER_NOTIFY_DEADLINE | JITTER_NOTIFY_INPUT);
+        }
+
+        if (running && (bits & JITTER_NOTIFY_DEADLINE) != 0U)
+        {
+            Jitter_Record(&result->Period, (uint32_t)(nowUs - expiryUs));
+            expiryUs += JITTER_PERIOD_US;
+            while (expiryUs <= nowUs)
+            {
+                expiryUs += JITTER_PERIOD_US;
+                result->Overruns++;
+            }
+            (void)Deadline_Arm(&Jitter_DeadlineTimer, (TimerWheel_TimeUs_t)expiryUs);
+        }
+
+        if (running && (bits & JITTER_NOTIFY_INPUT) != 0U)
+        {
+            Jitter_Record(&result->Input, (uint32_t)nowUs - atomic_load_explicit(&Jitter_InputTimeUs, memory_order_relaxed));
+        }
+
+        if ((bits & JITTER_NOTIFY_STOP) != 0U)
+        {
+            running = false;
+            (void)Deadline_Cancel(&Jitter_DeadlineTimer);
+            xTaskNotifyGive(Jitter_RunTaskHandle);
+        }
+    }
+}
+
+/**
+ * @brief Task loading the input core like a burst of IR frames or radio
+ * traffic, busy for JITTER_BUSY_US once per tick while the load is running.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void Jitter_InputLoadTask(void *arg)
+{
+    int64_t endUs;
+
+    (void)arg;
+
+    for (;;)
+    {
+        if (!atomic_load_explicit(&Jitter_LoadRunning, memory_order_relaxed))
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        else
+        {
+            endUs = esp_timer_get_time() + JITTER_BUSY_US;
+            while (esp_timer_get_time() < endUs)
+            {
+            }
+            vTaskDelay(1U);
+        }
+    }
+}
+
+/**
+ * @brief Task loading the input core like the log drain printing a full ring,
+ * logging JITTER_LOG_BURST lines once per tick while the load is running.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void Jitter_LogLoadTask(void *arg)
+{
+    uint32_t burst = 0U;
+
+    (void)arg;
+
+    for (;;)
+    {
+        if (!atomic_load_explicit(&Jitter_LoadRunning, memory_order_relaxed))
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        else
+        {
+            for (uint32_t line = 0U; line < JITTER_LOG_BURST; line++)
+            {
+                ESP_LOGI(Jitter_EspLogTag, "Log load burst %" PRIu32 " line %" PRIu32, burst, line);
+            }
+            burst++;
+            vTaskDelay(1U);
+        }
+    }
+}
+
+/**
+ * @brief Start the timer raising inputs.  Its ISR is installed on the core of
+ * the calling task.
+ *
+ * @return Whether the timer was started or not
+ ******************************************************************************/
+static bool Jitter_StartInputTimer(void)
+{
+    const gptimer_config_t timerConfig = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = JITTER_TIMER_RESOLUTION_HZ,
+    };
+    const gptimer_alarm_config_t alarmConfig = {
+        .alarm_count = JITTER_INPUT_PERIOD_US,
+        .reload_count = 0U,
+        .flags.auto_reload_on_alarm = true,
+    };
+    const gptimer_event_callbacks_t callbacks = {
+        .on_alarm = Jitter_InputAlarmCallback,
+    };
+
+    return gptimer_new_timer(&timerConfig, &Jitter_InputTimer) == ESP_OK && gptimer_set_alarm_action(Jitter_InputTimer, &alarmConfig) == ESP_OK &&
+           gptimer_register_event_callbacks(Jitter_InputTimer, &callbacks, NULL) == ESP_OK && gptimer_enable(Jitter_InputTimer) == ESP_OK && gptimer_start(Jitter_InputTimer) == ESP_OK;
+}
+
+/**
+ * @brief Input timer alarm callback.  Stamps the time of the input and wakes
+ * the probe, once the probe was created.
+ *
+ * @note Called from the timer ISR.
+ *
+ * @param[in] timer     Unused
+ * @param[in] eventData Unused
+ * @param[in] userData  Unused
+ *
+ * @return Whether a higher priority task was woken and a yield is needed
+ ******************************************************************************/
+static bool IRAM_ATTR Jitter_InputAlarmCallback(gptimer_handle_t timer, const gptimer_alarm_event_data_t *eventData, void *userData)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    (void)timer;
+    (void)eventData;
+    (void)userData;
+
+    if (Jitter_ProbeTaskHandle != NULL)
+    {
+        atomic_store_explicit(&Jitter_InputTimeUs, (uint32_t)esp_timer_get_time(), memory_order_relaxed);
+        (void)xTaskNotifyFromISR(Jitter_ProbeTaskHandle, JITTER_NOTIFY_INPUT, eSetBits, &higherPriorityTaskWoken);
+    }
+
+    return higherPriorityTaskWoken == pdTRUE;
+}
+
+/**
+ * @brief Deadline timer callback.  Wakes the probe when its deadline expires.
+ *
+ * @param[in] context Unused
+ ******************************************************************************/
+static void Jitter_DeadlineCallback(void *const context)
+{
+    (void)context;
+
+    xTaskNotify(Jitter_ProbeTaskHandle, JITTER_NOTIFY_DEADLINE, eSetBits);
+}
+
+/**
+ * @brief Record a measurement in a histogram.
+ *
+ * @param[in,out] histogram Histogram to record the measurement in
+ * @param[in]     valueUs   Measurement in microseconds
+ ******************************************************************************/
+static void Jitter_Record(Jitter_Histogram_t *const histogram, const uint32_t valueUs)
+{
+    uint32_t bucket = (valueUs == 0U) ? 0U : (32U - (uint32_t)__builtin_clz(valueUs));
+
+    if (bucket >= JITTER_BUCKETS)
+    {
+        bucket = JITTER_BUCKETS - 1U;
+    }
+
+    if (histogram->Count == 0U || valueUs < histogram->MinUs)
+    {
+        histogram->MinUs = valueUs;
+    }
+    if (valueUs > histogram->MaxUs)
+    {
+        histogram->MaxUs = valueUs;
+    }
+    histogram->Count++;
+    histogram->SumUs += valueUs;
+    histogram->Buckets[bucket]++;
+}
+
+/**
+ * @brief Log a histogram as its minimum, mean and maximum, then the upper
+ * bound of each non-empty bucket in microseconds and its count.
+ *
+ * @param[in] phaseName Name of the phase measured
+ * @param[in] name      Name of the measurement
+ * @param[in] histogram Histogram to log
+ ******************************************************************************/
+static void Jitter_ReportHistogram(const char *const phaseName, const char *const name, const Jitter_Histogram_t *const histogram)
+{
+    char buffer[JITTER_BUFFER_SIZE];
+    size_t length = 0U;
+    int written;
+
+    if (histogram->Count == 0U)
+    {
+        ESP_LOGW(Jitter_EspLogTag, "%s %s: no measurements", phaseName, name);
+    }
+    else
+    {
+        buffer[0U] = '\0';
+        for (uint32_t bucket = 0U; bucket < JITTER_BUCKETS && length < JITTER_BUFFER_SIZE; bucket++)
+        {
+            if (histogram->Buckets[bucket] > 0U)
+            {
+                if (bucket == (JITTER_BUCKETS - 1U))
+                {
+                    written = snprintf(&buffer[length], JITTER_BUFFER_SIZE - length, " >=%" PRIu32 ":%" PRIu32, (uint32_t)1U << (bucket - 1U), histogram->Buckets[bucket]);
+                }
+                else
+                {
+                    written = snprintf(&buffer[length], JITTER_BUFFER_SIZE - length, " <%" PRIu32 ":%" PRIu32, (uint32_t)1U << bucket, histogram->Buckets[bucket]);
+                }
+                length += (written > 0) ? (size_t)written : 0U;
+            }
+        }
+
+        ESP_LOGI(Jitter_EspLogTag, "%s %s: count %" PRIu32 ", min %" PRIu32 " us, mean %" PRIu32 " us, max %" PRIu32 " us,%s", phaseName, name, histogram->Count, histogram->MinUs,
+                 (uint32_t)(histogram->SumUs / histogram->Count), histogram->MaxUs, buffer);
+    }
+}
@@ -1,57 +1,201 @@
+#include "Audio.h"
 #include "BopIt.h"
 #include "BopItCommands.h"
+#include "Deadline.h"
 #include "esp_log.h"
+#include "esp_random.h"
 #include "esp_timer.h"
 #include "EventHandlers.h"
+#include "Feedback.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "GameLoop.h"
 #include "Gpio.h"
+#include "Imu.h"
+#include "InputStats.h"
+#include "Ir.h"
+#include "Jitter.h"
+#include "Link.h"
+#include "LogDrain.h"
+#include "Monitor.h"
+#include "TaskLayout.h"
+#include <inttypes.h>
 #include <stdio.h>
 
-#define BOPIT_COMMAND_COUNT 3U
-#define BOPIT_RUN_DELAY 10U
-#define US_PER_MS 1000ULL
-
 static const char *BopItTag = "BopIt";
 
-static BopIt_Command_t *BopItCommands[BOPIT_COMMAND_COUNT] = {&BopItCommands_Button0, &BopItCommands_Button1, &BopItCommands_Button2};
+static void BopItGameTask(void *arg);
+static void BopItLogger(const BopIt_GameContext_t *const gameContext, const char *const message);
+static BopIt_TimeUs_t BopItTime(const BopIt_GameContext_t *const gameContext);
+static void BopItOnGameStart(BopIt_GameContext_t *const gameContext);
+static void BopItOnGameEnd(BopIt_GameContext_t *const gameContext);
+static void BopItPostState(const BopIt_GameContext_t *const gameContext);
+
+/* Bus of the input events of buttons, the IR receiver and the IMU */
+static EventBus_t BopItEventBus;
+
+/* Reaction times of the current game, summarized when it ends */
+static BopIt_Reaction_t BopItReactions[BOPIT_MAX_SCORE];
 
-static void BopItLogger(const char *const message);
-static BopIt_TimeMs_t BopItTime(void);
+/* Gesture commands come last, so without an IMU they are left out */
+static BopIt_GameContext_t BopItGameContext = {
+    .Commands = BopItCommands_Commands,
+    .CommandCount = BOPITCOMMANDS_GPIO_INPUT_COUNT,
+    .GetInputs = BopItCommands_GetInputs,
+    .GetEvent = BopItCommands_GetEvent,
+    .Time = BopItTime,
+    .Selection = BOPIT_SELECTION_UNIFORM,
+    .Curve = BOPIT_CURVE_LINEAR,
+    .CommandWeights = NULL,
+    .Logger = BopItLogger,
+    .LogRing = NULL,
+    .TraceRing = NULL,
+    .Reactions = BopItReactions,
+    .UserData = NULL,
+    .OnGameStart = BopItOnGameStart,
+    .OnGameEnd = BopItOnGameEnd,
+};
 
+/* Peripherals are initialized here, on the input core, so their interrupts are
+ * handled there, and the game runs in a task of its own on the game core */
 void app_main(void)
 {
-    Gpio_Init();
+    Monitor_Init();
+    Deadline_Init();
+    InputStats_Init();
+    EventBus_Init(&BopItEventBus);
+    if (!EventHandlers_Subscribe(&BopItEventBus))
+    {
+        ESP_LOGE(BopItTag, "Failed to subscribe to input events");
+    }
 
-    Gpio_RegisterEventHandler(GPIO_TYPE_BUTTON, EventHandlers_ButtonEventHandler);
+    Gpio_Init(&BopItEventBus);
+    Ir_Init(&BopItEventBus);
+    if (Imu_Init(&BopItEventBus))
+    {
+        BopItGameContext.CommandCount = BOPITCOMMANDS_INPUT_COUNT;
+    }
 
-    BopIt_GameContext_t bopItGameContext = {
-        .Commands = BopItCommands,
-        .CommandCount = BOPIT_COMMAND_COUNT,
-        .OnGameStart = NULL,
-        .OnGameEnd = NULL,
-    };
+    Audio_Init();
+    Link_Init();
 
-    BopIt_RegisterLogger(BopItLogger);
-    BopIt_RegisterTime(BopItTime);
-    BopIt_Init(&bopItGameContext);
+    JITTER_RUN();
 
-    BopItCommands_Init();
+    if (!TaskLayout_Create(TASKLAYOUT_TASK_GAME, BopItGameTask, &BopItGameContext, NULL))
+    {
+        ESP_LOGE(BopItTag, "Failed to create game task");
+    }
+}
 
-    while (bopItGameContext.GameState != BOPIT_GAMESTATE_END)
+static void BopItGameTask(void *arg)
+{
+    BopIt_GameContext_t *const gameContext = arg;
+
+    GameLoop_Init();
+    LogDrain_Init(gameContext);
+    BopIt_Init(gameContext);
+    BopIt_Seed(gameContext, ((uint64_t)esp_random() << 32U) | esp_random());
+    BopItCommands_Init(gameContext);
+
+    GameLoop_Run(gameContext);
+
+    /* Registered with the monitor, so the task is suspended rather than deleted */
+    for (;;)
     {
-        BopIt_Run(&bopItGameContext);
-        vTaskDelay(BOPIT_RUN_DELAY / portTICK_PERIOD_MS);
+        vTaskSuspend(NULL);
     }
-    BopIt_Run(&bopItGameContext);
 }
 
-static void BopItLogger(const char *const message)
+static void BopItLogger(const BopIt_GameContext_t *const gameContext, const char *const message)
 {
+    (void)gameContext;
+
     ESP_LOGI(BopItTag, "%s", message);
 }
 
-static BopIt_TimeMs_t BopItTime(void)
+static BopIt_TimeUs_t BopItTime(const BopIt_GameContext_t *const gameContext)
+{
+    (void)gameContext;
+
+    return (BopIt_TimeUs_t)esp_timer_get_time();
+}
+
+static void BopItOnGameStart(BopIt_GameContext_t *const gameContext)
+{
+    BopItPostState(gameContext);
+}
+
+static void BopItOnGameEnd(BopIt_GameContext_t *const gameContext)
 {
-    return (BopIt_TimeMs_t)(esp_timer_get_time() / US_PER_MS);
+    BopIt_ReactionTimes_t reactionTimes;
+    Debounce_Stats_t debounceStats;
+    IrShot_Stats_t irStats;
+    IrShot_Shot_t lastHit;
+    Feedback_Stats_t feedbackStats;
+    Audio_Stats_t audioStats;
+    Imu_Stats_t imuStats;
+
+    for (uint32_t commandIndex = 0U; commandIndex < gameContext->CommandCount; commandIndex++)
+    {
+        if (BopIt_GetReactionTimes(gameContext, gameContext->Commands[commandIndex], &reactionTimes))
+        {
+            ESP_LOGI(BopItTag, "%s reaction times: count %" PRIu32 ", min %" PRIu64 " us, mean %" PRIu64 " us, p95 %" PRIu64 " us", gameContext->Commands[commandIndex]->Name, reactionTimes.Count,
+                     reactionTimes.Min, reactionTimes.Mean, reactionTimes.P95);
+        }
+    }
+
+    for (uint32_t commandIndex = 0U; commandIndex < gameContext->CommandCount; commandIndex++)
+    {
+        /* Only buttons are debounced */
+        if (Gpio_GetDebounceStats(BopItCommands_InputToGpio((BopItCommands_Input_t)commandIndex), &debounceStats))
+        {
+            ESP_LOGI(BopItTag, "%s debounce: presses %" PRIu32 ", releases %" PRIu32 ", bounces %" PRIu32, gameContext->Commands[commandIndex]->Name, debounceStats.Presses, debounceStats.Releases, debounceStats.Bounces);
+        }
+    }
+
+    Ir_GetStats(&irStats);
+    ESP_LOGI(BopItTag, "IR: shots %" PRIu32 ", checksum errors %" PRIu32 ", framing errors %" PRIu32, irStats.Shots, irStats.ChecksumErrors, irStats.FramingErrors);
+    if (Ir_GetLastHit(&lastHit))
+    {
+        ESP_LOGI(BopItTag, "IR: last hit by player %u of team %u, damage %u", lastHit.PlayerId, lastHit.Team, lastHit.Damage);
+    }
+    ESP_LOGI(BopItTag, "Events: dropped %" PRIu32, EventHandlers_GetDrops());
+    ESP_LOGI(BopItTag, "Game loop: wakeups %" PRIu32, GameLoop_GetWakeupCount());
+
+    Feedback_GetStats(&feedbackStats);
+    ESP_LOGI(BopItTag, "Feedback: posted %" PRIu32 ", dropped %" PRIu32 ", played %" PRIu32 ", preempted %" PRIu32, feedbackStats.Queue.Posted, feedbackStats.Queue.Dropped, feedbackStats.Played, feedbackStats.Preempted);
+
+    Audio_GetStats(&audioStats);
+    if (audioStats.LatencyCount > 0U)
+    {
+        ESP_LOGI(BopItTag, "Audio: played %" PRIu32 ", preempted %" PRIu32 ", latency min %" PRIu32 " us, mean %" PRIu32 " us, max %" PRIu32 " us", audioStats.Played, audioStats.Preempted, audioStats.LatencyMinUs,
+                 (uint32_t)(audioStats.LatencySumUs / audioStats.LatencyCount), audioStats.LatencyMaxUs);
+    }
+
+    Imu_GetStats(&imuStats);
+    if (imuStats.ElapsedUs > 0U)
+    {
+        ESP_LOGI(BopItTag, "IMU: samples %" PRIu32 ", bursts %" PRIu32 ", overflows %" PRIu32 ", read errors %" PRIu32 ", twists %" PRIu32 ", pulls %" PRIu32 ", shakes %" PRIu32 ", processing %" PRIu64 " ppm of CPU",
+                 imuStats.Gesture.Samples, imuStats.Bursts, imuStats.Overflows, imuStats.ReadErrors, imuStats.Gesture.Gestures[GESTURE_TWIST], imuStats.Gesture.Gestures[GESTURE_PULL],
+                 imuStats.Gesture.Gestures[GESTURE_SHAKE], imuStats.ProcessUs * 1000000U / imuStats.ElapsedUs);
+    }
+
+    BopItPostState(gameContext);
+    Link_Report();
+
+    Monitor_Report();
+}
+
+static void BopItPostState(const BopIt_GameContext_t *const gameContext)
+{
+    GameLink_Message_t message = {
+        .Type = GAMELINK_MESSAGE_STATE,
+        .State = {
+            .GameState = (uint8_t)gameContext->GameState,
+            .Score = gameContext->Score,
+            .Lives = gameContext->Lives,
+        },
+    };
+
+    (void)Link_Post(&message);
 }
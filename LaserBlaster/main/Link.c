@@ -0,0 +1,342 @@
+/**
+ * @file Link.c
+ *
+ * @brief Link to the other blasters in range over ESP-NOW.  Wi-Fi is started in
+ * station mode on a fixed channel without connecting to an access point, and
+ * every frame is sent to the ESP-NOW broadcast address, so blasters need no
+ * pairing.  A blaster's ID in the game link is the last byte of its MAC
+ * address.
+ *
+ * The GameLink is owned by the link task.  Frames received are stamped with
+ * the time they arrived in the ESP-NOW receive callback, as close to the radio
+ * as the driver allows, and queued to the task together with the messages
+ * posted by the game, so neither the Wi-Fi task nor the game ever waits on the
+ * link.  The task blocks on the queue until the link next needs polling.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Link.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_netif.h"
+#include "esp_now.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "nvs_flash.h"
+#include "TaskLayout.h"
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <string.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define LINK_WIFI_CHANNEL 1U        /* Wi-Fi channel every blaster listens on */
+#define LINK_MAC_SIZE 6U            /* Size of a MAC address */
+#define LINK_QUEUE_LENGTH 8U        /* Number of frames and messages waiting for the link task */
+#define LINK_BATCH_WINDOW_US 10000U /* Longest time a message waits to be batched */
+#define LINK_SYNC_PERIOD_US 250000U /* Time between asking peers for their time */
+
+/* Microseconds per FreeRTOS tick */
+#define LINK_US_PER_TICK (portTICK_PERIOD_MS * 1000U)
+
+/* Typedefs
+ ******************************************************************************/
+
+typedef enum
+{
+    LINK_ITEM_FRAME,   /* Frame received from a peer */
+    LINK_ITEM_MESSAGE, /* Message posted by the game */
+} Link_ItemKind_t;     /* Kinds of items queued to the link task */
+
+/* Item queued to the link task */
+typedef struct
+{
+    Link_ItemKind_t Kind;   /* Kind of the item */
+    GameLink_TimeUs_t Time; /* Time a frame arrived */
+    uint32_t Size;          /* Size of a frame in bytes */
+    union
+    {
+        uint8_t Frame[GAMELINK_MAX_FRAME_SIZE]; /* Frame received, for LINK_ITEM_FRAME */
+        GameLink_Message_t Message;             /* Message posted, for LINK_ITEM_MESSAGE */
+    };
+} Link_Item_t;
+
+/* Globals
+ ******************************************************************************/
+
+static const char *Link_EspLogTag = "Link"; /* Tag for logging from Link module */
+
+static const uint8_t Link_BroadcastMac[LINK_MAC_SIZE] = {0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU}; /* ESP-NOW broadcast address */
+
+static GameLink_t Link_GameLink;              /* Link to the other blasters, only modified by the link task */
+static QueueHandle_t Link_Queue = NULL;       /* Frames and messages waiting for the link task */
+static TaskHandle_t Link_TaskHandle = NULL;   /* Handle of the link task */
+static _Atomic uint32_t Link_QueueDrops = 0U; /* Number of frames and messages dropped because the queue was full */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static bool Link_StartEspNow(void);
+static void Link_Task(void *arg);
+static bool Link_Send(void *const context, const uint8_t *const frame, const uint32_t size);
+static void Link_Receive(const esp_now_recv_info_t *info, const uint8_t *data, int dataLen);
+static void Link_OnMessage(void *const context, const GameLink_Message_t *const message);
+static GameLink_TimeUs_t Link_Now(void);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Start Wi-Fi and ESP-NOW and the link task.  Messages cannot be posted
+ * if any of them fails to start.
+ ******************************************************************************/
+void Link_Init(void)
+{
+    uint8_t mac[LINK_MAC_SIZE] = {0U};
+    GameLink_Config_t config = {
+        .Transport = {.Send = Link_Send, .Context = NULL},
+        .OnMessage = Link_OnMessage,
+        .Context = NULL,
+        .BatchWindowUs = LINK_BATCH_WINDOW_US,
+        .SyncPeriodUs = LINK_SYNC_PERIOD_US,
+    };
+
+    Link_Queue = xQueueCreate(LINK_QUEUE_LENGTH, sizeof(Link_Item_t));
+
+    if (Link_Queue == NULL || !Link_StartEspNow() || esp_read_mac(mac, ESP_MAC_WIFI_STA) != ESP_OK)
+    {
+        ESP_LOGW(Link_EspLogTag, "Failed to start ESP-NOW, link disabled");
+    }
+    else
+    {
+        config.Id = mac[LINK_MAC_SIZE - 1U];
+        (void)GameLink_Init(&Link_GameLink, &config, Link_Now());
+
+        if (TaskLayout_Create(TASKLAYOUT_TASK_LINK, Link_Task, NULL, &Link_TaskHandle))
+        {
+            ESP_LOGI(Link_EspLogTag, "Blaster %u on channel %u", config.Id, LINK_WIFI_CHANNEL);
+        }
+        else
+        {
+            ESP_LOGW(Link_EspLogTag, "Failed to create link task, link disabled");
+        }
+    }
+}
+
+/**
+ * @brief Post a game message to be sent to every peer.  Returns without
+ * waiting for the message to be sent.
+ *
+ * @param[in] message Message to send
+ *
+ * @return Whether the message was posted or not
+ *
+ * @retval true The message was posted
+ * @retval false The link is disabled or the queue to the link task is full
+ ******************************************************************************/
+bool Link_Post(const GameLink_Message_t *const message)
+{
+    Link_Item_t item = {.Kind = LINK_ITEM_MESSAGE};
+    bool posted = false;
+
+    if (message != NULL && Link_TaskHandle != NULL)
+    {
+        item.Message = *message;
+        posted = xQueueSend(Link_Queue, &item, 0U) == pdTRUE;
+        if (!posted)
+        {
+            atomic_fetch_add_explicit(&Link_QueueDrops, 1U, memory_order_relaxed);
+        }
+    }
+
+    return posted;
+}
+
+/**
+ * @brief Log the frames sent and received and the estimated clock offset of
+ * every peer.  Read while the link task runs, so counters may be a frame
+ * apart from each other.
+ ******************************************************************************/
+void Link_Report(void)
+{
+    const GameLink_Stats_t *stats = &Link_GameLink.Stats;
+    const GameLink_Peer_t *peer;
+
+    if (Link_TaskHandle != NULL)
+    {
+        ESP_LOGI(Link_EspLogTag, "Sent %" PRIu32 " messages in %" PRIu32 " frames, %" PRIu32 " failed, received %" PRIu32 " messages in %" PRIu32 " frames, %" PRIu32 " invalid, %" PRIu32 " queue drops", stats->MessagesSent, stats->FramesSent,
+                 stats->SendFailures, stats->MessagesReceived, stats->FramesReceived, stats->FramesInvalid, atomic_load_explicit(&Link_QueueDrops, memory_order_relaxed));
+
+        for (uint32_t peerIndex = 0U; peerIndex < GAMELINK_MAX_PEERS; peerIndex++)
+        {
+            peer = &Link_GameLink.Peers[peerIndex];
+            if (peer->Active)
+            {
+                ESP_LOGI(Link_EspLogTag, "Blaster %u: offset %" PRId32 " us, round trip %" PRIu32 " us, %" PRIu32 " exchanges, %" PRIu32 " frames lost", peer->Id, peer->OffsetUs, peer->DelayUs, peer->SampleCount, peer->FramesLost);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Start Wi-Fi in station mode on the link's channel, then ESP-NOW with
+ * the broadcast address as its only peer.
+ *
+ * @return Whether ESP-NOW was started or not
+ ******************************************************************************/
+static bool Link_StartEspNow(void)
+{
+    wifi_init_config_t wifiConfig = WIFI_INIT_CONFIG_DEFAULT();
+    esp_now_peer_info_t broadcastPeer = {
+        .channel = LINK_WIFI_CHANNEL,
+        .ifidx = WIFI_IF_STA,
+        .encrypt = false,
+    };
+    esp_err_t error = nvs_flash_init();
+
+    /* Wi-Fi keeps calibration data in NVS, which is erased if its layout changed */
+    if (error == ESP_ERR_NVS_NO_FREE_PAGES || error == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        error = nvs_flash_erase();
+        if (error == ESP_OK)
+        {
+            error = nvs_flash_init();
+        }
+    }
+
+    memcpy(broadcastPeer.peer_addr, Link_BroadcastMac, LINK_MAC_SIZE);
+
+    return error == ESP_OK && esp_netif_init() == ESP_OK && esp_event_loop_create_default() == ESP_OK && esp_wifi_init(&wifiConfig) == ESP_OK && esp_wifi_set_storage(WIFI_STORAGE_RAM) == ESP_OK &&
+           esp_wifi_set_mode(WIFI_MODE_STA) == ESP_OK && esp_wifi_start() == ESP_OK && esp_wifi_set_channel(LINK_WIFI_CHANNEL, WIFI_SECOND_CHAN_NONE) == ESP_OK && esp_now_init() == ESP_OK &&
+           esp_now_register_recv_cb(Link_Receive) == ESP_OK && esp_now_add_peer(&broadcastPeer) == ESP_OK;
+}
+
+/**
+ * @brief Task owning the game link.  Hands it frames received and messages
+ * posted as they are queued, and polls it whenever it needs to send a frame
+ * being batched or ask a peer for its time.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void Link_Task(void *arg)
+{
+    Link_Item_t item;
+    TickType_t waitTicks;
+
+    (void)arg;
+
+    for (;;)
+    {
+        /* Rounded up so the task never wakes before the link needs polling */
+        waitTicks = (TickType_t)((GameLink_GetPollDelay(&Link_GameLink, Link_Now()) + LINK_US_PER_TICK - 1U) / LINK_US_PER_TICK);
+
+        if (xQueueReceive(Link_Queue, &item, waitTicks) == pdTRUE)
+        {
+            if (item.Kind == LINK_ITEM_FRAME)
+            {
+                GameLink_Receive(&Link_GameLink, item.Frame, item.Size, item.Time);
+            }
+            else
+            {
+                (void)GameLink_Send(&Link_GameLink, &item.Message, Link_Now());
+            }
+        }
+
+        GameLink_Poll(&Link_GameLink, Link_Now());
+    }
+}
+
+/**
+ * @brief Broadcast a frame to every blaster in range.  Transport of the game
+ * link, called from the link task.
+ *
+ * @param[in] context Unused
+ * @param[in] frame   Frame to send
+ * @param[in] size    Size of the frame in bytes
+ *
+ * @return Whether ESP-NOW accepted the frame or not
+ ******************************************************************************/
+static bool Link_Send(void *const context, const uint8_t *const frame, const uint32_t size)
+{
+    (void)context;
+
+    return esp_now_send(Link_BroadcastMac, frame, size) == ESP_OK;
+}
+
+/**
+ * @brief Stamp a frame received with the time it arrived and queue it to the
+ * link task.  ESP-NOW receive callback, called from the Wi-Fi task, so the
+ * frame is dropped rather than waiting if the queue is full.
+ *
+ * @param[in] info    Addresses of the frame, unused
+ * @param[in] data    Frame received
+ * @param[in] dataLen Size of the frame in bytes
+ ******************************************************************************/
+static void Link_Receive(const esp_now_recv_info_t *info, const uint8_t *data, int dataLen)
+{
+    Link_Item_t item = {.Kind = LINK_ITEM_FRAME, .Time = Link_Now()};
+
+    (void)info;
+
+    if (data != NULL && dataLen > 0 && (uint32_t)dataLen <= GAMELINK_MAX_FRAME_SIZE)
+    {
+        item.Size = (uint32_t)dataLen;
+        memcpy(item.Frame, data, item.Size);
+        if (xQueueSend(Link_Queue, &item, 0U) != pdTRUE)
+        {
+            atomic_fetch_add_explicit(&Link_QueueDrops, 1U, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Log a game message from a peer.  Called from the link task.
+ *
+ * @param[in] context Unused
+ * @param[in] message Message received
+ ******************************************************************************/
+static void Link_OnMessage(void *const context, const GameLink_Message_t *const message)
+{
+    GameLink_TimeUs_t issueTime;
+
+    (void)context;
+
+    switch (message->Type)
+    {
+    case GAMELINK_MESSAGE_STATE:
+        ESP_LOGI(Link_EspLogTag, "Blaster %u: state %u, score %u, lives %u", message->Sender, message->State.GameState, message->State.Score, message->State.Lives);
+        break;
+    case GAMELINK_MESSAGE_COMMAND:
+        if (GameLink_ToLocalTime(&Link_GameLink, message->Sender, message->Command.IssueTime, &issueTime))
+        {
+            ESP_LOGI(Link_EspLogTag, "Blaster %u: command %u issued %" PRId32 " us ago, %u ms to complete", message->Sender, message->Command.CommandIndex, (int32_t)(Link_Now() - issueTime), message->Command.WaitTimeMs);
+        }
+        else
+        {
+            ESP_LOGI(Link_EspLogTag, "Blaster %u: command %u, %u ms to complete", message->Sender, message->Command.CommandIndex, message->Command.WaitTimeMs);
+        }
+        break;
+    case GAMELINK_MESSAGE_RESULT:
+        ESP_LOGI(Link_EspLogTag, "Blaster %u: command %u %s, score %u, lives %u", message->Sender, message->Result.CommandIndex, message->Result.Success ? "completed" : "failed", message->Result.Score, message->Result.Lives);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Get the time on this blaster's clock for the game link.
+ *
+ * @return Low 32 bits of esp_timer_get_time
+ ******************************************************************************/
+static GameLink_TimeUs_t Link_Now(void)
+{
+    return (GameLink_TimeUs_t)esp_timer_get_time();
+}
@@ -0,0 +1,151 @@
+/**
+ * @file LogDrain.c
+ *
+ * @brief Deferred logging for the BopIt game.  BopIt writes binary log records
+ * to a lock-free ring instead of formatting and printing messages on the game
+ * task, and a low priority task formats and prints them later so UART speed
+ * is kept off the game loop's critical path.
+ *
+ * The same task prints the game's trace records as lines of hex prefixed with
+ * "TRACE", which can be extracted from a console capture and converted back
+ * into a binary trace for replaying the game on a host, e.g.
+ * grep -o 'TRACE [0-9a-f]*' capture.log | cut -d' ' -f2 | xxd -r -p > game.trace
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "LogDrain.h"
+#include "BopIt.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "LogRing.h"
+#include "Monitor.h"
+#include "TaskLayout.h"
+#include <inttypes.h>
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define LOGDRAIN_RING_SIZE 128U                                        /* Number of records the ring can hold, must be a power of two */
+#define LOGDRAIN_TRACE_RING_SIZE 64U                                   /* Number of records the trace ring can hold, must be a power of two */
+#define LOGDRAIN_TRACE_HEX_SIZE ((2U * sizeof(LogRing_Record_t)) + 1U) /* Size of buffer for a trace record in hex */
+#define LOGDRAIN_BUFFER_SIZE 128U                                      /* Size of buffer for formatting a record */
+#define LOGDRAIN_PERIOD_MS 50U                                         /* Period at which the ring is drained */
+
+/* Globals
+ ******************************************************************************/
+
+static const char *LogDrain_EspLogTag = "BopIt";      /* Tag for logging BopIt messages */
+static const char *LogDrain_TraceEspLogTag = "Trace"; /* Tag for logging trace records */
+
+static LogRing_Record_t LogDrain_Records[LOGDRAIN_RING_SIZE];            /* Storage for the ring */
+static LogRing_t LogDrain_Ring;                                          /* Ring BopIt writes log records to */
+static LogRing_Record_t LogDrain_TraceRecords[LOGDRAIN_TRACE_RING_SIZE]; /* Storage for the trace ring */
+static LogRing_t LogDrain_TraceRing;                                     /* Ring BopIt writes trace records to */
+static TaskHandle_t LogDrain_TaskHandle = NULL;                          /* Handle of the drain task */
+static const BopIt_GameContext_t *LogDrain_GameContext = NULL;           /* Game the records are formatted for, its commands name the commands issued */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void LogDrain_Task(void *arg);
+static void LogDrain_PrintTrace(const LogRing_Record_t *const record);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Set the log and trace rings of a game and start the task draining
+ * them.  Must be called before BopIt_Init so all messages are deferred and
+ * the whole game is traced.
+ *
+ * @param[in,out] gameContext Context for the BopIt game to defer logging of
+ ******************************************************************************/
+void LogDrain_Init(BopIt_GameContext_t *const gameContext)
+{
+    if (gameContext != NULL && LogRing_Init(&LogDrain_Ring, LogDrain_Records, LOGDRAIN_RING_SIZE))
+    {
+        LogDrain_GameContext = gameContext;
+        gameContext->LogRing = &LogDrain_Ring;
+        if (LogRing_Init(&LogDrain_TraceRing, LogDrain_TraceRecords, LOGDRAIN_TRACE_RING_SIZE))
+        {
+            gameContext->TraceRing = &LogDrain_TraceRing;
+            Monitor_RegisterBuffer("trace ring", LOGDRAIN_TRACE_RING_SIZE, &LogDrain_TraceRing.HighWater);
+        }
+        Monitor_RegisterBuffer("log ring", LOGDRAIN_RING_SIZE, &LogDrain_Ring.HighWater);
+        (void)TaskLayout_Create(TASKLAYOUT_TASK_LOGDRAIN, LogDrain_Task, NULL, &LogDrain_TaskHandle);
+    }
+}
+
+/**
+ * @brief Task to format and print log and trace records.  Periodically drains
+ * the rings and reports records dropped because a ring was full.
+ *
+ * @param[in] arg Unused
+ ******************************************************************************/
+static void LogDrain_Task(void *arg)
+{
+    LogRing_Record_t record;
+    char buffer[LOGDRAIN_BUFFER_SIZE];
+    uint32_t dropped = 0U;
+    uint32_t traceDropped = 0U;
+    uint32_t totalDropped;
+
+    (void)arg;
+
+    for (;;)
+    {
+        while (LogRing_Read(&LogDrain_Ring, &record))
+        {
+            if (BopIt_FormatLog(LogDrain_GameContext, &record, buffer, LOGDRAIN_BUFFER_SIZE) >= 0)
+            {
+                ESP_LOGI(LogDrain_EspLogTag, "[%" PRIu32 " us] %s", record.Time, buffer);
+            }
+        }
+
+        totalDropped = LogRing_GetDropped(&LogDrain_Ring);
+        if (totalDropped != dropped)
+        {
+            ESP_LOGW(LogDrain_EspLogTag, "%" PRIu32 " log records dropped", totalDropped - dropped);
+            dropped = totalDropped;
+        }
+
+        while (LogRing_Read(&LogDrain_TraceRing, &record))
+        {
+            LogDrain_PrintTrace(&record);
+        }
+
+        totalDropped = LogRing_GetDropped(&LogDrain_TraceRing);
+        if (totalDropped != traceDropped)
+        {
+            ESP_LOGW(LogDrain_TraceEspLogTag, "%" PRIu32 " trace records dropped, trace cannot be replayed", totalDropped - traceDropped);
+            traceDropped = totalDropped;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(LOGDRAIN_PERIOD_MS));
+    }
+}
+
+/**
+ * @brief Print the raw bytes of a trace record as a line of hex.
+ *
+ * @param[in] record Trace record to print
+ ******************************************************************************/
+static void LogDrain_PrintTrace(const LogRing_Record_t *const record)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    const uint8_t *bytes = (const uint8_t *)record;
+    char hex[LOGDRAIN_TRACE_HEX_SIZE];
+
+    for (size_t byte = 0U; byte < sizeof(LogRing_Record_t); byte++)
+    {
+        hex[2U * byte] = hexDigits[bytes[byte] >> 4U];
+        hex[(2U * byte) + 1U] = hexDigits[bytes[byte] & 0x0FU];
+    }
+    hex[LOGDRAIN_TRACE_HEX_SIZE - 1U] = '\0';
+
+    ESP_LOGI(LogDrain_TraceEspLogTag, "TRACE %s", hex);
+}
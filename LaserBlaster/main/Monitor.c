@@ -0,0 +1,178 @@
+/**
+ * @file Monitor.c
+ *
+ * @brief Stack, heap and static buffer usage monitor.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "Monitor.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define MONITOR_BUFFER_SIZE 256U                /* Size of buffer for formatting a line of the summary */
+#define MONITOR_ESP_TIMER_TASK_NAME "esp_timer" /* Name of the task dispatching esp_timer callbacks */
+#define MONITOR_PERCENT 100U                    /* Scale of a percentage */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Task registered for monitoring */
+typedef struct
+{
+    TaskHandle_t Task;  /* Handle of the task */
+    uint32_t StackSize; /* Size of the task's stack in bytes, as passed to xTaskCreate */
+} Monitor_Task_t;
+
+/* Static buffer registered for monitoring */
+typedef struct
+{
+    const char *Name;                  /* Name of the buffer */
+    uint32_t Size;                     /* Size of the buffer, in units of its choosing */
+    const _Atomic uint32_t *HighWater; /* Most of the buffer used at once, in the same units as its size */
+} Monitor_Buffer_t;
+
+/* Globals
+ ******************************************************************************/
+
+static const char *Monitor_EspLogTag = "Monitor"; /* Tag for logging from Monitor module */
+
+static Monitor_Task_t Monitor_Tasks[MONITOR_MAX_TASKS];       /* Tasks registered for monitoring */
+static uint32_t Monitor_TaskCount = 0U;                       /* Number of tasks registered */
+static Monitor_Buffer_t Monitor_Buffers[MONITOR_MAX_BUFFERS]; /* Static buffers registered for monitoring */
+static uint32_t Monitor_BufferCount = 0U;                     /* Number of static buffers registered */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+static void Monitor_ReportStacks(void);
+static void Monitor_ReportHeap(void);
+static void Monitor_ReportBuffers(void);
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Register the task created by ESP-IDF that the game's deadlines run
+ * on, the esp_timer task.  The main task is not registered as it is deleted
+ * once app_main returns.
+ ******************************************************************************/
+void Monitor_Init(void)
+{
+    TaskHandle_t espTimerTask = xTaskGetHandle(MONITOR_ESP_TIMER_TASK_NAME);
+
+    if (espTimerTask != NULL)
+    {
+        Monitor_RegisterTask(espTimerTask, CONFIG_ESP_TIMER_TASK_STACK_SIZE);
+    }
+}
+
+/**
+ * @brief Register a task to report the peak usage of its stack.  Tasks must
+ * be registered before Monitor_Report is called and must not be deleted.
+ *
+ * @param[in] task      Handle of the task
+ * @param[in] stackSize Size of the task's stack in bytes
+ ******************************************************************************/
+void Monitor_RegisterTask(const TaskHandle_t task, const uint32_t stackSize)
+{
+    if (task != NULL && Monitor_TaskCount < MONITOR_MAX_TASKS)
+    {
+        Monitor_Tasks[Monitor_TaskCount].Task = task;
+        Monitor_Tasks[Monitor_TaskCount].StackSize = stackSize;
+        Monitor_TaskCount++;
+    }
+}
+
+/**
+ * @brief Register a static buffer to report its peak usage.  Buffers must be
+ * registered before Monitor_Report is called.
+ *
+ * @param[in] name      Name of the buffer, must outlive the monitor
+ * @param[in] size      Size of the buffer
+ * @param[in] highWater Most of the buffer used at once, maintained by the
+ * buffer's owner in the same units as size
+ ******************************************************************************/
+void Monitor_RegisterBuffer(const char *const name, const uint32_t size, const _Atomic uint32_t *const highWater)
+{
+    if (name != NULL && highWater != NULL && Monitor_BufferCount < MONITOR_MAX_BUFFERS)
+    {
+        Monitor_Buffers[Monitor_BufferCount].Name = name;
+        Monitor_Buffers[Monitor_BufferCount].Size = size;
+        Monitor_Buffers[Monitor_BufferCount].HighWater = highWater;
+        Monitor_BufferCount++;
+    }
+}
+
+/**
+ * @brief Log a summary of the peak stack usage of each registered task, the
+ * heap and the peak usage of each registered static buffer.
+ ******************************************************************************/
+void Monitor_Report(void)
+{
+    Monitor_ReportStacks();
+    Monitor_ReportHeap();
+    Monitor_ReportBuffers();
+}
+
+/**
+ * @brief Log the peak stack usage of each registered task as used/size in
+ * bytes and as a percentage of its stack.
+ ******************************************************************************/
+static void Monitor_ReportStacks(void)
+{
+    char buffer[MONITOR_BUFFER_SIZE];
+    size_t length = 0U;
+    uint32_t used;
+    int written;
+
+    buffer[0U] = '\0';
+    for (uint32_t taskIndex = 0U; taskIndex < Monitor_TaskCount && length < MONITOR_BUFFER_SIZE; taskIndex++)
+    {
+        /* High water mark is the least free stack ever, in bytes on ESP-IDF */
+        used = Monitor_Tasks[taskIndex].StackSize - (uint32_t)uxTaskGetStackHighWaterMark(Monitor_Tasks[taskIndex].Task);
+        written = snprintf(&buffer[length], MONITOR_BUFFER_SIZE - length, " %s %" PRIu32 "/%" PRIu32 " %" PRIu32 "%%", pcTaskGetName(Monitor_Tasks[taskIndex].Task), used, Monitor_Tasks[taskIndex].StackSize,
+                           (Monitor_Tasks[taskIndex].StackSize > 0U) ? ((used * MONITOR_PERCENT) / Monitor_Tasks[taskIndex].StackSize) : 0U);
+        length += (written > 0) ? (size_t)written : 0U;
+    }
+
+    ESP_LOGI(Monitor_EspLogTag, "stack peak:%s", buffer);
+}
+
+/**
+ * @brief Log the current and minimum free internal heap and the largest free
+ * block, which bounds the largest allocation that can succeed.
+ ******************************************************************************/
+static void Monitor_ReportHeap(void)
+{
+    ESP_LOGI(Monitor_EspLogTag, "heap: free %u of %u, min free %u, largest block %u", (unsigned int)heap_caps_get_free_size(MALLOC_CAP_INTERNAL), (unsigned int)heap_caps_get_total_size(MALLOC_CAP_INTERNAL),
+             (unsigned int)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL), (unsigned int)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+}
+
+/**
+ * @brief Log the peak usage of each registered static buffer as used/size.
+ ******************************************************************************/
+static void Monitor_ReportBuffers(void)
+{
+    char buffer[MONITOR_BUFFER_SIZE];
+    size_t length = 0U;
+    int written;
+
+    buffer[0U] = '\0';
+    for (uint32_t bufferIndex = 0U; bufferIndex < Monitor_BufferCount && length < MONITOR_BUFFER_SIZE; bufferIndex++)
+    {
+        written = snprintf(&buffer[length], MONITOR_BUFFER_SIZE - length, " %s %" PRIu32 "/%" PRIu32, Monitor_Buffers[bufferIndex].Name, atomic_load_explicit(Monitor_Buffers[bufferIndex].HighWater, memory_order_relaxed),
+                           Monitor_Buffers[bufferIndex].Size);
+        length += (written > 0) ? (size_t)written : 0U;
+    }
+
+    ESP_LOGI(Monitor_EspLogTag, "buffer peak:%s", buffer);
+}
@@ -0,0 +1,98 @@
+/**
+ * @file TaskLayout.c
+ *
+ * @brief Placement of the blaster's tasks on the two cores.
+ *
+ ******************************************************************************/
+
+/* Includes
+ ******************************************************************************/
+#include "TaskLayout.h"
+#include "esp_log.h"
+#include "Monitor.h"
+#include <stddef.h>
+
+/* Defines
+ ******************************************************************************/
+
+/* Generates the placement of a task */
+#define TASKLAYOUT_CONFIG(id, name, core, priority, stackDepth) \
+    [TASKLAYOUT_TASK_##id] = {                                   \
+        .Name = name,                                            \
+        .Core = core,                                            \
+        .Priority = priority,                                    \
+        .StackDepth = stackDepth,                                \
+    },
+
+/* Globals
+ ******************************************************************************/
+
+static const char *TaskLayout_EspLogTag = "TaskLayout"; /* Tag for logging from TaskLayout module */
+
+static const TaskLayout_Config_t TaskLayout_Configs[TASKLAYOUT_TASK_COUNT] = {TASKLAYOUT_TABLE(TASKLAYOUT_CONFIG)}; /* Placement of each task */
+
+/* Function Definitions
+ ******************************************************************************/
+
+/**
+ * @brief Create a task pinned to its core with its priority and stack depth
+ * from TASKLAYOUT_TABLE, and register it with the monitor.  Tasks created must
+ * not be deleted.
+ *
+ * @param[in]  task       Task to create
+ * @param[in]  function   Function the task runs
+ * @param[in]  arg        Argument passed to the function
+ * @param[out] taskHandle Handle of the task created, may be NULL
+ *
+ * @return Whether the task was created or not
+ ******************************************************************************/
+bool TaskLayout_Create(const TaskLayout_Task_t task, TaskFunction_t function, void *const arg, TaskHandle_t *const taskHandle)
+{
+    const TaskLayout_Config_t *config = TaskLayout_GetConfig(task);
+    TaskHandle_t handle = NULL;
+    bool created = false;
+
+    if (config != NULL && function != NULL && xTaskCreatePinnedToCore(function, config->Name, config->StackDepth, arg, config->Priority, &handle, config->Core) == pdPASS)
+    {
+        Monitor_RegisterTask(handle, config->StackDepth);
+        if (taskHandle != NULL)
+        {
+            *taskHandle = handle;
+        }
+        created = true;
+    }
+
+    return created;
+}
+
+/**
+ * @brief Get the placement of a task.
+ *
+ * @param[in] task Task to get the placement of
+ *
+ * @return Placement of the task, NULL if the task is invalid
+ ******************************************************************************/
+const TaskLayout_Config_t *TaskLayout_GetConfig(const TaskLayout_Task_t task)
+{
+    const TaskLayout_Config_t *config = NULL;
+
+    if (task < TASKLAYOUT_TASK_COUNT)
+    {
+        config = &TaskLayout_Configs[task];
+    }
+
+    return config;
+}
+
+/**
+ * @brief Log the core and priority of every task, so results measured with
+ * different layouts can be told apart.
+ ******************************************************************************/
+void TaskLayout_Report(void)
+{
+    ESP_LOGI(TaskLayout_EspLogTag, "Input core %d, game core %d", TASKLAYOUT_INPUT_CORE, TASKLAYOUT_GAME_CORE);
+    for (uint32_t taskIndex = 0U; taskIndex < TASKLAYOUT_TASK_COUNT; taskIndex++)
+    {
+        ESP_LOGI(TaskLayout_EspLogTag, "%s: core %d, priority %u", TaskLayout_Configs[taskIndex].Name, (int)TaskLayout_Configs[taskIndex].Core, (unsigned int)TaskLayout_Configs[taskIndex].Priority);
+    }
+}
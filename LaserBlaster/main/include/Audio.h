@@ -0,0 +1,38 @@
+/**
+ * @file Audio.h
+ *
+ * @brief Audio clips streamed to an I2S amplifier from the "prompts" flash
+ * partition, which holds an AudioPack image.
+ *
+ ******************************************************************************/
+
+#ifndef AUDIO_H
+#define AUDIO_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Clips played and the latency from request to first sample */
+typedef struct
+{
+    uint32_t Played;       /* Number of clips played to the end */
+    uint32_t Preempted;    /* Number of clips cut short by another clip */
+    uint32_t LatencyCount; /* Number of clips whose latency was measured */
+    uint32_t LatencyMinUs; /* Shortest time from request to the first samples queued for DMA */
+    uint32_t LatencyMaxUs; /* Longest time from request to the first samples queued for DMA */
+    uint64_t LatencySumUs; /* Sum of the times from request to the first samples queued for DMA */
+} Audio_Stats_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void Audio_Init(void);
+bool Audio_Play(const uint32_t clip, const uint32_t requestTimeUs);
+void Audio_GetStats(Audio_Stats_t *const stats);
+
+#endif
@@ -1,7 +1,10 @@
 /**
  * @file BopItCommands.h
  *
- * @brief Commands for BopIt game.
+ * @brief Commands for BopIt game.  Every command is described by a single line
+ * of BOPITCOMMANDS_TABLE or BOPITCOMMANDS_GESTURE_TABLE, which generates the
+ * command, its input index and the mapping from its GPIO or gesture to its
+ * input.
  *
  ******************************************************************************/
 
@@ -11,45 +14,57 @@
 /* Includes
  ******************************************************************************/
 #include "BopIt.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
+#include "Gesture.h"
+#include "Gpio.h"
 
-/* Globals
+/* Defines
  ******************************************************************************/
 
-extern bool BopItCommands_Button0InputFlag;
-extern SemaphoreHandle_t BopItCommands_Button0InputFlagMutex;
-extern StaticSemaphore_t BopItCommands_Button0InputFlagMutexBuffer;
-extern BopIt_Command_t BopItCommands_Button0;
+/* Commands of the game, X(Id, GpioNum, Name, Prompt) for each.  The order sets
+ * the index of each command in the game's list of commands, which is also the
+ * index of its input in the game's bitmask of inputs. */
+#define BOPITCOMMANDS_TABLE(X)                                      \
+    X(BUTTON0, GPIO_BUTTON_0, "Button 0 Command", "Press Button 0") \
+    X(BUTTON1, GPIO_BUTTON_1, "Button 1 Command", "Press Button 1") \
+    X(BUTTON2, GPIO_BUTTON_2, "Button 2 Command", "Press Button 2") \
+    X(HIT, GPIO_IR_RX, "Hit Command", "Get hit")
 
-extern bool BopItCommands_Button1InputFlag;
-extern SemaphoreHandle_t BopItCommands_Button1InputFlagMutex;
-extern StaticSemaphore_t BopItCommands_Button1InputFlagMutexBuffer;
-extern BopIt_Command_t BopItCommands_Button1;
+/* Gesture commands of the game, X(Id, Gesture, Name, Prompt) for each.  They
+ * follow the commands of BOPITCOMMANDS_TABLE, so a game without an IMU plays
+ * only the first BOPITCOMMANDS_GPIO_INPUT_COUNT commands. */
+#define BOPITCOMMANDS_GESTURE_TABLE(X)                        \
+    X(TWIST, GESTURE_TWIST, "Twist Command", "Twist it")      \
+    X(PULL, GESTURE_PULL, "Pull Command", "Pull it")          \
+    X(SHAKE, GESTURE_SHAKE, "Shake Command", "Shake it")
 
-extern bool BopItCommands_Button2InputFlag;
-extern SemaphoreHandle_t BopItCommands_Button2InputFlagMutex;
-extern StaticSemaphore_t BopItCommands_Button2InputFlagMutexBuffer;
-extern BopIt_Command_t BopItCommands_Button2;
+#define BOPITCOMMANDS_INPUT_ENUM(id, source, name, prompt) BOPITCOMMANDS_INPUT_##id, /* Generates the input index of a command */
+#define BOPITCOMMANDS_COUNT(id, source, name, prompt) +1U                            /* Generates a command's share of the number of commands */
 
-/* Function Prototypes
+#define BOPITCOMMANDS_GPIO_INPUT_COUNT (0U BOPITCOMMANDS_TABLE(BOPITCOMMANDS_COUNT)) /* Number of commands with a GPIO, the first commands */
+
+/* Typedefs
  ******************************************************************************/
 
-void BopItCommands_Init(void);
+typedef enum
+{
+    BOPITCOMMANDS_TABLE(BOPITCOMMANDS_INPUT_ENUM)
+    BOPITCOMMANDS_GESTURE_TABLE(BOPITCOMMANDS_INPUT_ENUM)
+    BOPITCOMMANDS_INPUT_COUNT, /* Number of commands */
+} BopItCommands_Input_t;       /* Input index of each command, BOPITCOMMANDS_INPUT_<Id> */
+
+/* Globals
+ ******************************************************************************/
 
-void BopItCommands_Button0IssueCommand(void);
-void BopItCommands_Button0SuccessFeedback(void);
-void BopItCommands_Button0FailFeedback(void);
-bool BopItCommands_Button0GetInput(void);
+extern BopIt_Command_t *BopItCommands_Commands[BOPITCOMMANDS_INPUT_COUNT];
 
-void BopItCommands_Button1IssueCommand(void);
-void BopItCommands_Button1SuccessFeedback(void);
-void BopItCommands_Button1FailFeedback(void);
-bool BopItCommands_Button1GetInput(void);
+/* Function Prototypes
+ ******************************************************************************/
 
-void BopItCommands_Button2IssueCommand(void);
-void BopItCommands_Button2SuccessFeedback(void);
-void BopItCommands_Button2FailFeedback(void);
-bool BopItCommands_Button2GetInput(void);
+void BopItCommands_Init(const BopIt_GameContext_t *const gameContext);
+BopIt_Inputs_t BopItCommands_GetInputs(BopIt_GameContext_t *const gameContext, BopIt_TimeUs_t *const inputTime);
+bool BopItCommands_GetEvent(BopIt_GameContext_t *const gameContext, Combo_Event_t *const event);
+BopItCommands_Input_t BopItCommands_GpioToInput(const Gpio_GpioNum_t gpioNum);
+Gpio_GpioNum_t BopItCommands_InputToGpio(const BopItCommands_Input_t input);
+BopItCommands_Input_t BopItCommands_GestureToInput(const Gesture_Gesture_t gesture);
 
 #endif
@@ -0,0 +1,26 @@
+/**
+ * @file Deadline.h
+ *
+ * @brief Deadline service for game deadlines and effect timers.  Timers are
+ * armed in a single TimerWheel driven by one esp_timer, which is only started
+ * for the next time the wheel needs to be advanced, so any number of armed
+ * timers costs one hardware timer and no periodic wakeups.
+ *
+ ******************************************************************************/
+
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+/* Includes
+ ******************************************************************************/
+#include "TimerWheel.h"
+#include <stdbool.h>
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void Deadline_Init(void);
+bool Deadline_Arm(TimerWheel_Timer_t *const timer, const TimerWheel_TimeUs_t expiry);
+bool Deadline_Cancel(TimerWheel_Timer_t *const timer);
+
+#endif
@@ -11,11 +11,18 @@
 /* Includes
  ******************************************************************************/
 #include "BopItCommands.h"
+#include "EventBus.h"
+#include "Gesture.h"
 #include "Gpio.h"
+#include <stdbool.h>
+#include <stdint.h>
 
 /* Function Prototypes
  ******************************************************************************/
 
-void EventHandlers_ButtonEventHandler(const Gpio_GpioNum_t gpioNum);
+bool EventHandlers_Subscribe(EventBus_t *const bus);
+BopIt_Inputs_t EventHandlers_TakeInputs(BopIt_TimeUs_t *const inputTime);
+bool EventHandlers_TakeEvent(Combo_Event_t *const event);
+uint32_t EventHandlers_GetDrops(void);
 
 #endif
@@ -0,0 +1,45 @@
+/**
+ * @file Feedback.h
+ *
+ * @brief Asynchronous feedback effects.  Effects posted from game callbacks
+ * are queued in an EffectQueue and played out by a dedicated task, so the
+ * game never waits for feedback.  An effect posted while another plays cuts
+ * it short if it has a higher priority and waits for it otherwise.
+ *
+ ******************************************************************************/
+
+#ifndef FEEDBACK_H
+#define FEEDBACK_H
+
+/* Includes
+ ******************************************************************************/
+#include "EffectQueue.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Plays effects, called from the feedback task */
+typedef struct
+{
+    void (*Start)(const EffectQueue_Effect_t *const effect);                      /* Start playing an effect */
+    void (*Stop)(const EffectQueue_Effect_t *const effect, const bool preempted); /* Stop playing an effect, either because it finished or because it was cut short, can be NULL */
+} Feedback_Player_t;
+
+/* Effects posted and played */
+typedef struct
+{
+    EffectQueue_Stats_t Queue; /* Effects posted to the queue */
+    uint32_t Played;           /* Number of effects played to the end */
+    uint32_t Preempted;        /* Number of effects cut short by a higher priority effect */
+} Feedback_Stats_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void Feedback_Init(const Feedback_Player_t *const player);
+bool Feedback_Post(const EffectQueue_Effect_t *const effect);
+void Feedback_GetStats(Feedback_Stats_t *const stats);
+
+#endif
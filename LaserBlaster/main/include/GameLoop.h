@@ -0,0 +1,26 @@
+/**
+ * @file GameLoop.h
+ *
+ * @brief Event driven loop for running a BopIt game.
+ *
+ ******************************************************************************/
+
+#ifndef GAME_LOOP_H
+#define GAME_LOOP_H
+
+/* Includes
+ ******************************************************************************/
+#include "BopIt.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void GameLoop_Init(void);
+void GameLoop_Run(BopIt_GameContext_t *const gameContext);
+void GameLoop_Notify(void);
+bool GameLoop_NotifyFromIsr(void);
+uint32_t GameLoop_GetWakeupCount(void);
+
+#endif
@@ -1,7 +1,9 @@
 /**
  * @file Gpio.h
  *
- * @brief Manage GPIO peripherals.
+ * @brief Manage GPIO peripherals.  Debounced button presses and trigger pulls
+ * are published to the event bus from the GPIO ISR, and hits from the IR
+ * receive task.
  *
  ******************************************************************************/
 
@@ -10,7 +12,10 @@
 
 /* Includes
  ******************************************************************************/
+#include "Debounce.h"
 #include "driver/gpio.h"
+#include "EventBus.h"
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Defines
@@ -19,23 +24,28 @@
 #define GPIO_BUTTON_0 GPIO_NUM_18
 #define GPIO_BUTTON_1 GPIO_NUM_19
 #define GPIO_BUTTON_2 GPIO_NUM_21
-#define GPIO_BUTTON_PIN_SEL ((1UL << GPIO_BUTTON_0) | (1UL << GPIO_BUTTON_1) | (1UL << GPIO_BUTTON_2))
+#define GPIO_TRIGGER GPIO_NUM_4 /* Trigger firing shots, debounced like the buttons */
+#define GPIO_BUTTON_PIN_SEL ((1UL << GPIO_BUTTON_0) | (1UL << GPIO_BUTTON_1) | (1UL << GPIO_BUTTON_2) | (1UL << GPIO_TRIGGER))
+#define GPIO_BUTTON_PRESS_LOCKOUT_US 10000   /* Time after a button press during which its edges are rejected as bounces */
+#define GPIO_BUTTON_RELEASE_LOCKOUT_US 10000 /* Time after a button release during which its edges are rejected as bounces */
+#define GPIO_IR_TX GPIO_NUM_22               /* IR LED, driven by the RMT transmit channel */
+#define GPIO_IR_RX GPIO_NUM_23               /* IR receiver module output, captured by the RMT receive channel */
+#define GPIO_AUDIO_BCLK GPIO_NUM_25          /* I2S bit clock of the audio amplifier */
+#define GPIO_AUDIO_WS GPIO_NUM_26            /* I2S word select of the audio amplifier */
+#define GPIO_AUDIO_DOUT GPIO_NUM_27          /* I2S data to the audio amplifier */
+#define GPIO_IMU_SDA GPIO_NUM_32             /* I2C data of the IMU */
+#define GPIO_IMU_SCL GPIO_NUM_33             /* I2C clock of the IMU */
 
 /* Typedefs
  ******************************************************************************/
 
-typedef uint32_t Gpio_GpioNum_t;                                   /* GPIO number */
-typedef void (*Gpio_EventHandler_t)(const Gpio_GpioNum_t gpioNum); /* GPIO event handler */
-
-typedef enum
-{
-    GPIO_TYPE_BUTTON, /* GPIO input for buttons */
-} Gpio_Type_t;        /* Type of physical device or sensor connected to GPIO */
+typedef uint32_t Gpio_GpioNum_t; /* GPIO number */
+typedef int64_t Gpio_TimeUs_t;   /* Time in microseconds since boot */
 
 /* Function Prototypes
  ******************************************************************************/
 
-void Gpio_Init(void);
-void Gpio_RegisterEventHandler(const Gpio_Type_t gpioType, Gpio_EventHandler_t eventHandler);
+void Gpio_Init(EventBus_t *const bus);
+bool Gpio_GetDebounceStats(const Gpio_GpioNum_t gpioNum, Debounce_Stats_t *const stats);
 
 #endif
@@ -0,0 +1,43 @@
+/**
+ * @file Imu.h
+ *
+ * @brief Accelerometer and gyroscope on the I2C bus, read from the sensor's
+ * FIFO in bursts and run through the Gesture pipeline to recognize twists,
+ * pulls and shakes of the blaster.  Each gesture recognized is published to
+ * the event bus as an EVENTBUS_TYPE_GESTURE event.
+ *
+ ******************************************************************************/
+
+#ifndef IMU_H
+#define IMU_H
+
+/* Includes
+ ******************************************************************************/
+#include "EventBus.h"
+#include "Gesture.h"
+#include "Gpio.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Samples read and the time spent reading and processing them */
+typedef struct
+{
+    uint32_t Bursts;         /* Number of bursts read from the FIFO */
+    uint32_t Overflows;      /* Number of times the FIFO overflowed and samples were lost */
+    uint32_t ReadErrors;     /* Number of failed I2C transfers */
+    uint64_t ReadUs;         /* Time spent waiting on I2C transfers */
+    uint64_t ProcessUs;      /* Time spent unpacking and processing samples */
+    uint64_t ElapsedUs;      /* Time since the IMU task started */
+    Gesture_Stats_t Gesture; /* Samples processed and gestures recognized */
+} Imu_Stats_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+bool Imu_Init(EventBus_t *const bus);
+void Imu_GetStats(Imu_Stats_t *const stats);
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * @file InputStats.h
+ *
+ * @brief Instrumentation of the button input pipeline, from the GPIO ISR
+ * publishing a press to the game taking it.  Counts presses latched, presses
+ * coalesced with a press the game had not taken yet, and failures to wake the
+ * game, tracks the most presses pending at once, and keeps a log2 histogram of
+ * the latency from the ISR to the game taking each press.
+ *
+ * Recording is done through macros so it compiles to nothing when
+ * INPUTSTATS_ENABLED is defined as 0, e.g. with
+ * idf_build_set_property(COMPILE_DEFINITIONS "INPUTSTATS_ENABLED=0" APPEND)
+ * in the project's CMakeLists.txt.
+ *
+ ******************************************************************************/
+
+#ifndef INPUT_STATS_H
+#define INPUT_STATS_H
+
+/* Includes
+ ******************************************************************************/
+#include "esp_attr.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#ifndef INPUTSTATS_ENABLED
+#define INPUTSTATS_ENABLED 1 /* Whether the input pipeline is instrumented */
+#endif
+
+#define INPUTSTATS_MAX_INPUTS 32U      /* Number of inputs tracked, at least the number of commands */
+#define INPUTSTATS_LATENCY_BUCKETS 20U /* Number of buckets of the latency histogram, bucket n counts latencies below 2^n us and at least 2^(n-1) us, the last bucket counts any longer latencies */
+
+#if INPUTSTATS_ENABLED
+#define INPUTSTATS_RECORD_LATCH(inputIndex, latched, pending, timeUs) InputStats_RecordLatch((inputIndex), (latched), (pending), (timeUs)) /* Record a press latched for the game */
+#define INPUTSTATS_RECORD_NOTIFY_FAILURE() InputStats_RecordNotifyFailure()                                                                /* Record the ISR failing to wake the game */
+#define INPUTSTATS_RECORD_TAKE(inputs) InputStats_RecordTake(inputs)                                                                       /* Record presses taken by the game */
+#else
+#define INPUTSTATS_RECORD_LATCH(inputIndex, latched, pending, timeUs) ((void)0)
+#define INPUTSTATS_RECORD_NOTIFY_FAILURE() ((void)0)
+#define INPUTSTATS_RECORD_TAKE(inputs) ((void)0)
+#endif
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Statistics of the input pipeline */
+typedef struct
+{
+    uint32_t Latched;                             /* Number of presses latched for the game */
+    uint32_t Coalesced;                           /* Number of presses dropped because the same input was latched and not taken yet */
+    uint32_t NotifyFailures;                      /* Number of presses the ISR could not wake the game task for */
+    uint32_t PendingHighWater;                    /* Most presses latched and not taken at once */
+    uint32_t Taken;                               /* Number of presses taken by the game */
+    uint32_t Latency[INPUTSTATS_LATENCY_BUCKETS]; /* Log2 histogram of microseconds from the ISR to the game taking a press */
+} InputStats_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void InputStats_Init(void);
+void InputStats_Get(InputStats_t *const stats);
+void InputStats_Dump(void);
+
+#if INPUTSTATS_ENABLED
+void InputStats_RecordLatch(const uint32_t inputIndex, const bool latched, const uint32_t pending, const int64_t timeUs);
+void InputStats_RecordNotifyFailure(void);
+void InputStats_RecordTake(const uint32_t inputs);
+#endif
+
+#endif
@@ -0,0 +1,38 @@
+/**
+ * @file Ir.h
+ *
+ * @brief Infrared transmitter and receiver for laser tag shots.  Shots are
+ * sent and captured with the RMT peripheral and encoded and decoded with
+ * IrShot.  A shot is fired for each EVENTBUS_TYPE_TRIGGER event on the event
+ * bus, and each hit is published to it as an EVENTBUS_TYPE_HIT event.  The
+ * player ID sent with every shot is the last byte of the blaster's MAC
+ * address, like its ID in the game link, so blasters can hit each other.
+ *
+ ******************************************************************************/
+
+#ifndef IR_H
+#define IR_H
+
+/* Includes
+ ******************************************************************************/
+#include "EventBus.h"
+#include "Gpio.h"
+#include "IrShot.h"
+#include <stdbool.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define IR_DEFAULT_PLAYER_ID 0U /* ID of the player using this blaster if its MAC address cannot be read */
+#define IR_TEAM 0U              /* Team of the player using this blaster */
+#define IR_DAMAGE 1U            /* Damage dealt by a shot from this blaster */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void Ir_Init(EventBus_t *const bus);
+bool Ir_Fire(void);
+bool Ir_GetLastHit(IrShot_Shot_t *const shot);
+void Ir_GetStats(IrShot_Stats_t *const stats);
+
+#endif
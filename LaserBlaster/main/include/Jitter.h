@@ -0,0 +1,78 @@
+/**
+ * @file Jitter.h
+ *
+ * @brief Scheduling jitter benchmark for comparing task layouts.  A probe task
+ * takes the game task's place in the layout and waits like the game loop does,
+ * for periodic deadlines armed with the deadline service and for inputs
+ * notified from an ISR on the input core.  It measures how late it wakes for
+ * each deadline, the deviation of the game loop's period, and how long it
+ * takes to wake for each input, the input latency.  Both are measured first
+ * with the blaster idle, then under synthetic load from tasks standing in for
+ * the input tasks and for the log drain, and reported as the minimum, mean and
+ * maximum with a log2 histogram.
+ *
+ * The benchmark runs from app_main before the game starts, blocking it for
+ * JITTER_PHASE_MS for each phase, when JITTER_ENABLED is defined as 1, e.g.
+ * with idf_build_set_property(COMPILE_DEFINITIONS "JITTER_ENABLED=1" APPEND)
+ * in the project's CMakeLists.txt.  Its tasks block for good once it is done.
+ *
+ ******************************************************************************/
+
+#ifndef JITTER_H
+#define JITTER_H
+
+/* Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#ifndef JITTER_ENABLED
+#define JITTER_ENABLED 0 /* Whether the jitter benchmark runs before the game */
+#endif
+
+#define JITTER_PHASE_MS 10000U /* Duration of each phase of the benchmark */
+#define JITTER_BUCKETS 16U     /* Number of buckets of each histogram, bucket n counts values below 2^n us and at least 2^(n-1) us, the last bucket counts any longer values */
+
+#if JITTER_ENABLED
+#define JITTER_RUN() Jitter_Run() /* Run the benchmark */
+#else
+#define JITTER_RUN() ((void)0)
+#endif
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Phases of the benchmark */
+typedef enum
+{
+    JITTER_PHASE_IDLE,   /* No load besides the blaster's own tasks */
+    JITTER_PHASE_LOADED, /* Synthetic load on the input core */
+    JITTER_PHASE_COUNT,  /* Number of phases */
+} Jitter_Phase_t;
+
+/* Distribution of a measurement in microseconds */
+typedef struct
+{
+    uint32_t Count;                   /* Number of measurements */
+    uint32_t MinUs;                   /* Smallest measurement */
+    uint32_t MaxUs;                   /* Largest measurement */
+    uint64_t SumUs;                   /* Sum of the measurements */
+    uint32_t Buckets[JITTER_BUCKETS]; /* Log2 histogram of the measurements */
+} Jitter_Histogram_t;
+
+/* Results of a phase */
+typedef struct
+{
+    Jitter_Histogram_t Period; /* Time from each deadline expiring to the probe waking */
+    Jitter_Histogram_t Input;  /* Time from each input ISR to the probe waking */
+    uint32_t Overruns;         /* Number of deadlines missed entirely because the probe woke a period or more late */
+} Jitter_Result_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void Jitter_Run(void);
+
+#endif
@@ -0,0 +1,25 @@
+/**
+ * @file Link.h
+ *
+ * @brief Link to the other blasters in range over ESP-NOW.  Game messages
+ * posted by the game are batched and broadcast by the link task, which also
+ * keeps every peer's clock synchronized with this blaster's.
+ *
+ ******************************************************************************/
+
+#ifndef LINK_H
+#define LINK_H
+
+/* Includes
+ ******************************************************************************/
+#include "GameLink.h"
+#include <stdbool.h>
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void Link_Init(void);
+bool Link_Post(const GameLink_Message_t *const message);
+void Link_Report(void);
+
+#endif
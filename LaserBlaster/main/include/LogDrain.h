@@ -0,0 +1,20 @@
+/**
+ * @file LogDrain.h
+ *
+ * @brief Deferred logging and tracing for the BopIt game.
+ *
+ ******************************************************************************/
+
+#ifndef LOG_DRAIN_H
+#define LOG_DRAIN_H
+
+/* Includes
+ ******************************************************************************/
+#include "BopIt.h"
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void LogDrain_Init(BopIt_GameContext_t *const gameContext);
+
+#endif
@@ -0,0 +1,35 @@
+/**
+ * @file Monitor.h
+ *
+ * @brief Stack, heap and static buffer usage monitor.  Tasks and static
+ * buffers are registered with their sizes, and a summary of their peak usage
+ * and of the heap is reported on demand so stacks and buffers can be sized
+ * from data.
+ *
+ ******************************************************************************/
+
+#ifndef MONITOR_H
+#define MONITOR_H
+
+/* Includes
+ ******************************************************************************/
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#define MONITOR_MAX_TASKS 12U  /* Maximum number of tasks that can be registered */
+#define MONITOR_MAX_BUFFERS 8U /* Maximum number of static buffers that can be registered */
+
+/* Function Prototypes
+ ******************************************************************************/
+
+void Monitor_Init(void);
+void Monitor_RegisterTask(const TaskHandle_t task, const uint32_t stackSize);
+void Monitor_RegisterBuffer(const char *const name, const uint32_t size, const _Atomic uint32_t *const highWater);
+void Monitor_Report(void);
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * @file TaskLayout.h
+ *
+ * @brief Placement of the blaster's tasks on the two cores.  Interrupts and
+ * the tasks servicing peripherals run on the input core, and the game and the
+ * tasks playing its effects run on the game core, so a burst of IR frames,
+ * radio traffic or logging never delays the game's deadlines.  The core,
+ * priority and stack depth of every task are set in TASKLAYOUT_TABLE, the
+ * single place to change the layout.
+ *
+ * Interrupts are handled on the core their driver was installed from, so
+ * peripherals must be initialized from app_main, which runs on the input core.
+ *
+ * All tasks can be placed on the input core, e.g. to compare layouts with the
+ * jitter benchmark, by defining TASKLAYOUT_SPLIT_CORES as 0, e.g. with
+ * idf_build_set_property(COMPILE_DEFINITIONS "TASKLAYOUT_SPLIT_CORES=0" APPEND)
+ * in the project's CMakeLists.txt.  Single core builds place all tasks on the
+ * input core regardless.
+ *
+ ******************************************************************************/
+
+#ifndef TASK_LAYOUT_H
+#define TASK_LAYOUT_H
+
+/* Includes
+ ******************************************************************************/
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Defines
+ ******************************************************************************/
+
+#ifndef TASKLAYOUT_SPLIT_CORES
+#define TASKLAYOUT_SPLIT_CORES 1 /* Whether the game runs on a core of its own */
+#endif
+
+#define TASKLAYOUT_INPUT_CORE 0 /* Core of interrupts and of the tasks servicing peripherals, also the core of app_main and the esp_timer task */
+#if TASKLAYOUT_SPLIT_CORES && !CONFIG_FREERTOS_UNICORE
+#define TASKLAYOUT_GAME_CORE 1 /* Core of the game and of the tasks playing its effects */
+#else
+#define TASKLAYOUT_GAME_CORE TASKLAYOUT_INPUT_CORE
+#endif
+
+/* Tasks of the blaster, X(Id, Name, Core, Priority, StackDepth) for each.  On
+ * the game core, the audio task is above the game so the DMA buffers never run
+ * dry, and the feedback task is below it so playing effects never delays it.
+ * On the input core, the IR and link tasks are highest so hits are published,
+ * shots fired and link frames stamped promptly, the IMU task is below them as
+ * its FIFO absorbs delays, and the drain task is lowest.  The jitter
+ * benchmark's load tasks stand in for the IR and drain tasks. */
+#define TASKLAYOUT_TABLE(X)                                                                       \
+    X(GAME, "Game_Task", TASKLAYOUT_GAME_CORE, tskIDLE_PRIORITY + 3U, 4096U)                      \
+    X(AUDIO, "Audio_Task", TASKLAYOUT_GAME_CORE, tskIDLE_PRIORITY + 4U, 3072U)                    \
+    X(FEEDBACK, "Feedback_Task", TASKLAYOUT_GAME_CORE, tskIDLE_PRIORITY + 2U, 3072U)              \
+    X(IR, "Ir_Task", TASKLAYOUT_INPUT_CORE, tskIDLE_PRIORITY + 3U, 3072U)                         \
+    X(IR_FIRE, "IrFire_Task", TASKLAYOUT_INPUT_CORE, tskIDLE_PRIORITY + 3U, 2048U)                \
+    X(LINK, "Link_Task", TASKLAYOUT_INPUT_CORE, tskIDLE_PRIORITY + 3U, 3072U)                     \
+    X(IMU, "Imu_Task", TASKLAYOUT_INPUT_CORE, tskIDLE_PRIORITY + 2U, 3072U)                       \
+    X(LOGDRAIN, "LogDrain_Task", TASKLAYOUT_INPUT_CORE, tskIDLE_PRIORITY + 1U, 3072U)             \
+    X(JITTER_INPUT_LOAD, "JitterInput_Task", TASKLAYOUT_INPUT_CORE, tskIDLE_PRIORITY + 3U, 2048U) \
+    X(JITTER_LOG_LOAD, "JitterLog_Task", TASKLAYOUT_INPUT_CORE, tskIDLE_PRIORITY + 1U, 3072U)
+
+#define TASKLAYOUT_TASK_ID(id, name, core, priority, stackDepth) TASKLAYOUT_TASK_##id, /* Generates the ID of a task */
+
+/* Typedefs
+ ******************************************************************************/
+
+/* Tasks of the blaster */
+typedef enum
+{
+    TASKLAYOUT_TABLE(TASKLAYOUT_TASK_ID)
+    TASKLAYOUT_TASK_COUNT, /* Number of tasks */
+} TaskLayout_Task_t;
+
+/* Placement of a task */
+typedef struct
+{
+    const char *Name;     /* Name of the task */
+    BaseType_t Core;      /* Core the task is pinned to */
+    UBaseType_t Priority; /* Priority of the task */
+    uint32_t StackDepth;  /* Stack depth of the task in bytes */
+} TaskLayout_Config_t;
+
+/* Function Prototypes
+ ******************************************************************************/
+
+bool TaskLayout_Create(const TaskLayout_Task_t task, TaskFunction_t function, void *const arg, TaskHandle_t *const taskHandle);
+const TaskLayout_Config_t *TaskLayout_GetConfig(const TaskLayout_Task_t task);
+void TaskLayout_Report(void);
+
+#endif